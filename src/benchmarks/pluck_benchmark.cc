@@ -0,0 +1,134 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <rapidjson/document.h>
+
+#include "src/carnot/funcs/builtins/json_ops.h"
+#include "src/carnot/udf/column_view.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+
+using carnot::builtins::PluckAsFloat64UDF;
+using carnot::builtins::PluckMultiUDF;
+using types::StringValue;
+
+const std::vector<std::string> kQuantileKeys = {"p50", "p90", "p99"};
+
+// Rows like the output of px.quantiles, the most common input of pluck.
+std::shared_ptr<arrow::Array> GenerateQuantileRows(int64_t count) {
+  std::mt19937 gen(123);
+  std::uniform_real_distribution<> dis(0, 1000);
+  std::vector<StringValue> rows;
+  rows.reserve(count);
+  for (int64_t i = 0; i < count; ++i) {
+    rows.emplace_back(absl::Substitute(R"({"p01":$0,"p10":$1,"p50":$2,"p90":$3,"p99":$4})",
+                                       dis(gen), dis(gen), dis(gen), dis(gen), dis(gen)));
+  }
+  return types::ToArrow(rows, arrow::default_memory_pool());
+}
+
+std::shared_ptr<arrow::Array> KeyColumn(const std::string& key, int64_t count) {
+  return types::ToArrow(std::vector<StringValue>(count, key), arrow::default_memory_pool());
+}
+
+// Plucks the keys by parsing every row into a document once per key.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckDocumentPerKey(benchmark::State& state) {
+  int64_t count = state.range(0);
+  auto rows = GenerateQuantileRows(count);
+  auto in = carnot::udf::StringColumnView::FromArrow(rows.get(), count);
+  for (auto _ : state) {
+    for (const auto& key : kQuantileKeys) {
+      arrow::DoubleBuilder builder;
+      auto out = carnot::udf::Float64ColumnWriter::ToArrow(&builder, count);
+      for (int64_t i = 0; i < count; ++i) {
+        rapidjson::Document d;
+        d.Parse(in[i].data(), in[i].size());
+        auto it = d.FindMember(key.c_str());
+        out.Append(it != d.MemberEnd() && it->value.IsDouble() ? it->value.GetDouble() : 0.0);
+      }
+      benchmark::DoNotOptimize(builder.length());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Plucks the keys one at a time with the pluck_float64 batch UDF.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckScanPerKey(benchmark::State& state) {
+  int64_t count = state.range(0);
+  auto rows = GenerateQuantileRows(count);
+  auto in = carnot::udf::StringColumnView::FromArrow(rows.get(), count);
+  std::vector<std::shared_ptr<arrow::Array>> keys;
+  for (const auto& key : kQuantileKeys) {
+    keys.push_back(KeyColumn(key, count));
+  }
+  PluckAsFloat64UDF udf;
+  for (auto _ : state) {
+    for (const auto& key : keys) {
+      arrow::DoubleBuilder builder;
+      auto out = carnot::udf::Float64ColumnWriter::ToArrow(&builder, count);
+      PX_CHECK_OK(udf.ExecBatch(
+          nullptr, in, carnot::udf::StringColumnView::FromArrow(key.get(), count), &out));
+      benchmark::DoNotOptimize(builder.length());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Plucks the keys the way the fused plan does, with one scan of each batch for all of them.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckFusedMultiKey(benchmark::State& state) {
+  int64_t count = state.range(0);
+  std::vector<std::shared_ptr<arrow::Array>> keys;
+  for (const auto& key : kQuantileKeys) {
+    keys.push_back(KeyColumn(key, count));
+  }
+  PluckMultiUDF<types::DataType::FLOAT64> udf;
+  PX_CHECK_OK(udf.Init(nullptr, R"(["p50","p90","p99"])"));
+  for (auto _ : state) {
+    // Every batch is a new column, so each iteration pays for the scan.
+    state.PauseTiming();
+    auto rows = GenerateQuantileRows(count);
+    auto in = carnot::udf::StringColumnView::FromArrow(rows.get(), count);
+    state.ResumeTiming();
+    for (const auto& key : keys) {
+      arrow::DoubleBuilder builder;
+      auto out = carnot::udf::Float64ColumnWriter::ToArrow(&builder, count);
+      PX_CHECK_OK(udf.ExecBatch(
+          nullptr, in, carnot::udf::StringColumnView::FromArrow(key.get(), count), &out));
+      benchmark::DoNotOptimize(builder.length());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_PluckDocumentPerKey)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_PluckScanPerKey)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_PluckFusedMultiKey)->RangeMultiplier(4)->Range(64, 4096);
+
+}  // namespace px
@@ -20,6 +20,7 @@
 #include <google/protobuf/text_format.h>
 
 #include <algorithm>
+#include <limits>
 #include <random>
 #include <vector>
 
@@ -65,6 +66,25 @@ df = df.groupby(['col0', 'col1']).agg(sum=('col2', px.sum))
 px.display(df, '$0')
 )pxl";
 
+constexpr char kMapFilterGroupByOneQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='test_table', select=['col0', 'col1'])
+df.col2 = df.col1 * 3 + 1
+df = df[df.col2 % 7 != 0]
+df = df.groupby('col0').agg(sum=('col2', px.sum))
+px.display(df, '$0')
+)pxl";
+
+// Groups by col0 and then collapses the groups into a single row, so that the cost of the query is
+// dominated by the group-by rather than by sending the groups to the result sink.
+constexpr char kGroupByOneCountGroupsQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='test_table', select=['col0', 'col1'])
+df = df.groupby('col0').agg(sum=('col1', px.sum))
+df = df.agg(num_groups=('sum', px.count))
+px.display(df, '$0')
+)pxl";
+
 std::unique_ptr<Carnot> SetUpCarnot(std::shared_ptr<table_store::TableStore> table_store,
                                     LocalGRPCResultSinkServer* server) {
   auto func_registry = std::make_unique<px::carnot::udf::Registry>("default_registry");
@@ -130,6 +150,61 @@ void BM_Query_Int(benchmark::State& state, std::vector<types::DataType> types,
   BM_Query(state, types, distribution_types, query, num_batches, default_params, default_params);
 }
 
+// Runs the query with the map/filter pipeline in front of the aggregate executed on range(1)
+// workers.
+// NOLINTNEXTLINE : runtime/references.
+void BM_Query_Int_Parallel(benchmark::State& state, std::vector<types::DataType> types,
+                           std::vector<datagen::DistributionType> distribution_types,
+                           const std::string& query, int64_t num_batches) {
+  FLAGS_carnot_exec_parallelism = state.range(1);
+  BM_Query_Int(state, types, distribution_types, query, num_batches);
+  FLAGS_carnot_exec_parallelism = 1;
+  state.counters["parallelism"] = state.range(1);
+}
+
+// Runs a group-by over int64 keys drawn uniformly from [0, range(0)), so the aggregate holds about
+// range(0) groups. The table has two rows per possible group.
+// NOLINTNEXTLINE : runtime/references.
+void BM_Query_GroupCardinality(benchmark::State& state, const std::string& query) {
+  constexpr int64_t kRowsPerBatch = 64 * 1024;
+  int64_t num_groups = state.range(0);
+  int64_t num_rows = 2 * num_groups;
+
+  auto table_store = std::make_shared<table_store::TableStore>();
+  auto server = LocalGRPCResultSinkServer();
+  auto carnot = SetUpCarnot(table_store, &server);
+
+  std::vector<types::DataType> types = {types::DataType::INT64, types::DataType::INT64};
+  auto table = std::make_shared<Table>(
+      "test_table",
+      table_store::schema::Relation(types, table_store::DefaultColumnNames(types.size())),
+      std::numeric_limits<int64_t>::max());
+  for (int64_t written = 0; written < num_rows; written += kRowsPerBatch) {
+    int64_t batch_size = std::min(kRowsPerBatch, num_rows - written);
+    auto rb = table_store::schema::RowBatch(RowDescriptor(types), batch_size);
+    auto keys = datagen::CreateLargeData<types::Int64Value>(batch_size, 0, num_groups - 1);
+    auto values = datagen::CreateLargeData<types::Int64Value>(batch_size);
+    PX_CHECK_OK(rb.AddColumn(types::ToArrow(keys, arrow::default_memory_pool())));
+    PX_CHECK_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+    PX_CHECK_OK(table->WriteRowBatch(rb));
+  }
+  table_store->AddTable("test_table", table);
+
+  int i = 0;
+  for (auto _ : state) {
+    auto queryWithTableName = absl::Substitute(query, "results_" + std::to_string(i));
+    auto res = carnot->ExecuteQuery(queryWithTableName, sole::uuid4(), CurrentTimeNS());
+    if (!res.ok()) {
+      LOG(FATAL) << "Aggregate benchmark query did not execute successfully.";
+    }
+    server.ResetQueryResults();
+    ++i;
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_rows);
+  state.counters["groups"] = num_groups;
+}
+
 const std::unique_ptr<const datagen::DistributionParams> sample_selection_params =
     std::make_unique<const datagen::ZipfianParams>(2, 2, 999);
 const std::unique_ptr<const datagen::DistributionParams> sample_length_params =
@@ -198,6 +273,26 @@ BENCHMARK_CAPTURE(BM_Query_Int, eval_group_by_one_exponential_int,
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
+// Group Cardinality Tests
+BENCHMARK_CAPTURE(BM_Query_GroupCardinality, eval_group_by_one_int_cardinality,
+                  kGroupByOneCountGroupsQuery)
+    ->Arg(1000)
+    ->Arg(100 * 1000)
+    ->Arg(10 * 1000 * 1000)
+    ->Unit(benchmark::kMillisecond);
+
+// Parallel Pipeline Tests
+BENCHMARK_CAPTURE(BM_Query_Int_Parallel, eval_map_filter_group_by_one_uniform_int,
+                  {types::DataType::INT64, types::DataType::INT64},
+                  {datagen::DistributionType::kUniform, datagen::DistributionType::kUniform},
+                  kMapFilterGroupByOneQuery, 64)
+    ->Args({1 << 14, 1})
+    ->Args({1 << 14, 2})
+    ->Args({1 << 14, 4})
+    ->Args({1 << 14, 8})
+    ->Args({1 << 14, 16})
+    ->UseRealTime();
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -22,6 +22,7 @@
 #include <map>
 #include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <pypa/parser/parser.hh>
@@ -141,5 +142,50 @@ TEST_F(JoinTest, self_join) {
   EXPECT_TRUE(rb1.ColumnAt(1)->Equals(types::ToArrow(expected_col2, arrow::default_memory_pool())));
 }
 
+TEST_F(JoinTest, larger_left_input) {
+  // The left table is larger, so the planner makes the right one the build side. The output
+  // columns stay in the order of the script.
+  table_store::schema::Relation rel({types::DataType::FLOAT64, types::DataType::INT64},
+                                    {"col1", "col2"});
+  table_store::schema::RowBatch rb(table_store::schema::RowDescriptor(rel.col_types()), 3);
+  std::vector<types::Float64Value> col1 = {9.1, 9.2, 9.3};
+  std::vector<types::Int64Value> col2 = {7, 8, 9};
+  ASSERT_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+  ASSERT_OK(rb.AddColumn(types::ToArrow(col2, arrow::default_memory_pool())));
+  ASSERT_OK(table_store_->GetTable("left_table")->WriteRowBatch(rb));
+
+  std::string queryString =
+      "import px\n"
+      "src1 = px.DataFrame(table='left_table', select=['col1', 'col2'])\n"
+      "src2 = px.DataFrame(table='right_table', select=['col1', 'col2'])\n"
+      "join = src1.merge(src2, how='inner', left_on=['col1', 'col2'], right_on=['col1', 'col2'], "
+      "suffixes=['', '_x'])\n"
+      "join['left_col1'] = join['col1']\n"
+      "join['right_col2'] = join['col2_x']\n"
+      "df = join[['left_col1', 'right_col2']]\n"
+      "px.display(df, 'joined')";
+
+  auto query_id = sole::uuid4();
+  // No time column, doesn't use a time parameter.
+  ASSERT_OK(carnot_->ExecuteQuery(queryString, query_id, 0));
+
+  EXPECT_THAT(result_server_->output_tables(), ::testing::UnorderedElementsAre("joined"));
+  std::vector<std::pair<double, int64_t>> rows;
+  for (const auto& output_rb : result_server_->query_results("joined")) {
+    ASSERT_EQ(arrow::Type::DOUBLE, output_rb.ColumnAt(0)->type_id());
+    ASSERT_EQ(arrow::Type::INT64, output_rb.ColumnAt(1)->type_id());
+    for (int64_t i = 0; i < output_rb.num_rows(); ++i) {
+      rows.emplace_back(
+          types::GetValueFromArrowArray<types::FLOAT64>(output_rb.ColumnAt(0).get(), i),
+          types::GetValueFromArrowArray<types::INT64>(output_rb.ColumnAt(1).get(), i));
+    }
+  }
+  EXPECT_THAT(rows, ::testing::UnorderedElementsAre(std::pair<double, int64_t>{0.5, 1},
+                                                    std::pair<double, int64_t>{1.2, 2},
+                                                    std::pair<double, int64_t>{5.3, 3},
+                                                    std::pair<double, int64_t>{0.1, 5},
+                                                    std::pair<double, int64_t>{5.1, 6}));
+}
+
 }  // namespace carnot
 }  // namespace px
@@ -124,12 +124,20 @@ class EngineState : public NotCopyable {
     auto rel_map = table_store_->GetRelationMap();
     // Use an empty string for query result address, because the local execution mode should use
     // the Local GRPC result server to send results to.
-    return std::make_unique<planner::CompilerState>(
+    auto compiler_state = std::make_unique<planner::CompilerState>(
         std::move(rel_map), planner::SensitiveColumnMap{}, registry_info_.get(), time_now,
         /* max_output_rows_per_table */ 0,
         /* result address */ "",
         /* ssl target name override*/ "", planner::RedactionOptions{}, nullptr, nullptr,
         planner::DebugInfo{});
+    // The local table store knows the sizes of its tables, so the planner can use them to
+    // choose the build sides of joins.
+    planner::TableSizeEstimateMap table_size_estimates;
+    for (const auto& [table_name, stats] : table_store_->GetTableStatsMap()) {
+      table_size_estimates[table_name] = {stats.num_rows, stats.bytes};
+    }
+    compiler_state->set_table_size_estimates(std::move(table_size_estimates));
+    return compiler_state;
   }
 
   const udf::Registry* func_registry() const { return func_registry_.get(); }
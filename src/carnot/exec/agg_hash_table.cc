@@ -0,0 +1,325 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/agg_hash_table.h"
+
+#include <farmhash.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/hash_utils.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+// Group keys compare by their bits, so float keys are canonicalized first: -0.0 and 0.0 are the
+// same group, and so are NaNs of every bit pattern.
+template <typename T>
+inline T CanonicalKey(T v) {
+  return v;
+}
+inline double CanonicalKey(double v) {
+  if (v == 0) {
+    return 0.0;
+  }
+  if (std::isnan(v)) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  return v;
+}
+
+inline uint64_t FixedValueBits(bool v) { return v; }
+inline uint64_t FixedValueBits(int64_t v) { return static_cast<uint64_t>(v); }
+inline uint64_t FixedValueBits(double v) {
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+inline uint64_t FixedValueBits(absl::uint128 v) {
+  return ::px::HashCombine(absl::Uint128Low64(v), absl::Uint128High64(v));
+}
+
+template <types::DataType DT>
+size_t KeyWidth() {
+  if constexpr (DT == types::DataType::STRING) {
+    // (offset, length) into the string arena.
+    return 2 * sizeof(uint64_t);
+  } else {
+    return sizeof(typename types::DataTypeTraits<DT>::native_type);
+  }
+}
+
+inline uint64_t HashString(std::string_view val) { return ::util::Hash64(val.data(), val.size()); }
+
+template <types::DataType DT>
+void HashColumn(const arrow::Array* col, int64_t num_rows, uint64_t* hashes) {
+  if constexpr (DT == types::DataType::STRING) {
+    if (col->type_id() == arrow::Type::DICTIONARY) {
+      const auto* dict_col = static_cast<const arrow::DictionaryArray*>(col);
+      const auto* dictionary = dict_col->dictionary().get();
+      if (dictionary->length() < num_rows) {
+        // Each distinct value is hashed once, and rows look their hash up by code.
+        std::vector<uint64_t> value_hashes(dictionary->length());
+        for (int64_t code = 0; code < dictionary->length(); ++code) {
+          value_hashes[code] = HashString(types::GetStringViewFromArrowArray(dictionary, code));
+        }
+        for (int64_t i = 0; i < num_rows; ++i) {
+          hashes[i] = ::px::HashCombine(hashes[i],
+                                        value_hashes[types::GetDictionaryCode(dict_col, i)]);
+        }
+        return;
+      }
+    }
+    for (int64_t i = 0; i < num_rows; ++i) {
+      hashes[i] =
+          ::px::HashCombine(hashes[i], HashString(types::GetStringViewFromArrowArray(col, i)));
+    }
+  } else {
+    using ArrowArrayType = typename types::DataTypeTraits<DT>::arrow_array_type;
+    using NativeType = typename types::DataTypeTraits<DT>::native_type;
+    const auto* arr = static_cast<const ArrowArrayType*>(col);
+    for (int64_t i = 0; i < num_rows; ++i) {
+      NativeType val = CanonicalKey(types::GetValue(arr, i));
+      hashes[i] = ::px::HashCombine(hashes[i], FixedValueBits(val));
+    }
+  }
+}
+
+template <types::DataType DT>
+void CopyFixedColumn(const arrow::Array* col, int64_t num_rows, size_t offset, size_t stride,
+                     uint8_t* dst) {
+  if constexpr (DT != types::DataType::STRING) {
+    using ArrowArrayType = typename types::DataTypeTraits<DT>::arrow_array_type;
+    using NativeType = typename types::DataTypeTraits<DT>::native_type;
+    const auto* arr = static_cast<const ArrowArrayType*>(col);
+    for (int64_t i = 0; i < num_rows; ++i) {
+      NativeType val = CanonicalKey(types::GetValue(arr, i));
+      memcpy(dst + i * stride + offset, &val, sizeof(NativeType));
+    }
+  }
+}
+
+template <types::DataType DT>
+Status AppendKeyColumn(arrow::ArrayBuilder* builder, const uint8_t* keys, int64_t num_groups,
+                       const std::vector<int64_t>* group_ids, size_t offset, size_t stride,
+                       const char* string_arena) {
+  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
+  auto* typed_builder = static_cast<ArrowBuilder*>(builder);
+  int64_t num_keys = group_ids == nullptr ? num_groups : static_cast<int64_t>(group_ids->size());
+  PX_RETURN_IF_ERROR(typed_builder->Reserve(num_keys));
+  for (int64_t i = 0; i < num_keys; ++i) {
+    int64_t g = group_ids == nullptr ? i : (*group_ids)[i];
+    const uint8_t* key = keys + g * stride + offset;
+    if constexpr (DT == types::DataType::STRING) {
+      uint64_t slot[2];
+      memcpy(slot, key, sizeof(slot));
+      PX_RETURN_IF_ERROR(typed_builder->Append(string_arena + slot[0], slot[1]));
+    } else {
+      typename types::DataTypeTraits<DT>::native_type val;
+      memcpy(&val, key, sizeof(val));
+      PX_RETURN_IF_ERROR(typed_builder->Append(val));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+void HashKeyColumns(const std::vector<types::DataType>& key_types,
+                    const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                    std::vector<uint64_t>* hashes) {
+  DCHECK_EQ(key_cols.size(), key_types.size());
+  hashes->assign(num_rows, 0);
+  for (size_t i = 0; i < key_types.size(); ++i) {
+#define TYPE_CASE(_dt_) HashColumn<_dt_>(key_cols[i], num_rows, hashes->data());
+    PX_SWITCH_FOREACH_DATATYPE(key_types[i], TYPE_CASE);
+#undef TYPE_CASE
+  }
+}
+
+AggHashTable::AggHashTable(std::vector<types::DataType> key_types)
+    : key_types_(std::move(key_types)) {
+  key_offsets_.resize(key_types_.size());
+  // Lay out the fixed-width columns first, then the string slots.
+  for (const bool strings : {false, true}) {
+    for (size_t i = 0; i < key_types_.size(); ++i) {
+      if ((key_types_[i] == types::DataType::STRING) != strings) {
+        continue;
+      }
+      key_offsets_[i] = key_width_;
+#define TYPE_CASE(_dt_) key_width_ += KeyWidth<_dt_>();
+      PX_SWITCH_FOREACH_DATATYPE(key_types_[i], TYPE_CASE);
+#undef TYPE_CASE
+    }
+    if (!strings) {
+      fixed_width_ = key_width_;
+    }
+  }
+  has_string_keys_ = key_width_ != fixed_width_;
+  Rehash(kInitialNumSlots);
+}
+
+void AggHashTable::HashBatch(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows) {
+  HashKeyColumns(key_types_, key_cols, num_rows, &batch_hashes_);
+  batch_fixed_keys_.assign(num_rows * fixed_width_, 0);
+  for (size_t i = 0; i < key_types_.size(); ++i) {
+#define TYPE_CASE(_dt_)                                                                      \
+  CopyFixedColumn<_dt_>(key_cols[i], num_rows, key_offsets_[i], fixed_width_,                \
+                        batch_fixed_keys_.data());
+    PX_SWITCH_FOREACH_DATATYPE(key_types_[i], TYPE_CASE);
+#undef TYPE_CASE
+  }
+}
+
+bool AggHashTable::KeyEquals(int64_t group_id, const std::vector<const arrow::Array*>& key_cols,
+                             int64_t row) const {
+  const uint8_t* key = keys_.data() + group_id * key_width_;
+  if (memcmp(key, batch_fixed_keys_.data() + row * fixed_width_, fixed_width_) != 0) {
+    return false;
+  }
+  if (!has_string_keys_) {
+    return true;
+  }
+  for (size_t i = 0; i < key_types_.size(); ++i) {
+    if (key_types_[i] != types::DataType::STRING) {
+      continue;
+    }
+    StringSlot slot;
+    memcpy(&slot, key + key_offsets_[i], sizeof(slot));
+    auto val = types::GetStringViewFromArrowArray(key_cols[i], row);
+    if (val.size() != slot.length ||
+        memcmp(string_arena_.data() + slot.offset, val.data(), val.size()) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int64_t AggHashTable::InsertKey(uint64_t hash, const std::vector<const arrow::Array*>& key_cols,
+                                int64_t row) {
+  int64_t group_id = num_groups();
+  size_t key_start = keys_.size();
+  keys_.resize(key_start + key_width_);
+  uint8_t* key = keys_.data() + key_start;
+  memcpy(key, batch_fixed_keys_.data() + row * fixed_width_, fixed_width_);
+  if (has_string_keys_) {
+    for (size_t i = 0; i < key_types_.size(); ++i) {
+      if (key_types_[i] != types::DataType::STRING) {
+        continue;
+      }
+      auto val = types::GetStringViewFromArrowArray(key_cols[i], row);
+      StringSlot slot{string_arena_.size(), val.size()};
+      string_arena_.insert(string_arena_.end(), val.begin(), val.end());
+      memcpy(key + key_offsets_[i], &slot, sizeof(slot));
+    }
+  }
+  group_hashes_.push_back(hash);
+  return group_id;
+}
+
+void AggHashTable::Rehash(size_t num_slots) {
+  slots_.assign(num_slots, kEmptySlot);
+  slot_mask_ = num_slots - 1;
+  for (int64_t group_id = 0; group_id < num_groups(); ++group_id) {
+    uint64_t pos = group_hashes_[group_id] & slot_mask_;
+    while (slots_[pos] != kEmptySlot) {
+      pos = (pos + 1) & slot_mask_;
+    }
+    slots_[pos] = group_id;
+  }
+}
+
+void AggHashTable::FindOrInsertBatch(const std::vector<const arrow::Array*>& key_cols,
+                                     int64_t num_rows, const std::vector<int64_t>* selection,
+                                     std::vector<int64_t>* group_ids) {
+  DCHECK_EQ(key_cols.size(), key_types_.size());
+  int64_t num_selected = selection == nullptr ? num_rows : static_cast<int64_t>(selection->size());
+  group_ids->resize(num_selected);
+  // Hashing is column-at-a-time over the whole batch, which is cheaper than gathering the selected
+  // rows first.
+  HashBatch(key_cols, num_rows);
+
+  for (int64_t i = 0; i < num_selected; ++i) {
+    int64_t row = selection == nullptr ? i : (*selection)[i];
+    uint64_t hash = batch_hashes_[row];
+    uint64_t pos = hash & slot_mask_;
+    int64_t group_id;
+    while (true) {
+      group_id = slots_[pos];
+      if (group_id == kEmptySlot) {
+        group_id = InsertKey(hash, key_cols, row);
+        slots_[pos] = group_id;
+        break;
+      }
+      if (group_hashes_[group_id] == hash && KeyEquals(group_id, key_cols, row)) {
+        break;
+      }
+      pos = (pos + 1) & slot_mask_;
+    }
+    (*group_ids)[i] = group_id;
+
+    // Keep the load factor at or below 1/2.
+    if (static_cast<size_t>(num_groups()) * 2 > slots_.size()) {
+      Rehash(slots_.size() * 2);
+    }
+  }
+}
+
+Status AggHashTable::AppendKeys(const std::vector<arrow::ArrayBuilder*>& builders,
+                                const std::vector<int64_t>* group_ids) const {
+  DCHECK_EQ(builders.size(), key_types_.size());
+  for (size_t i = 0; i < key_types_.size(); ++i) {
+#define TYPE_CASE(_dt_)                                                                        \
+  PX_RETURN_IF_ERROR(AppendKeyColumn<_dt_>(builders[i], keys_.data(), num_groups(), group_ids, \
+                                           key_offsets_[i], key_width_, string_arena_.data()));
+    PX_SWITCH_FOREACH_DATATYPE(key_types_[i], TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return Status::OK();
+}
+
+void AggHashTable::Clear() {
+  // Release the memory rather than just the contents, so that a table that grew large doesn't
+  // keep holding on to it.
+  keys_ = {};
+  group_hashes_ = {};
+  string_arena_ = {};
+  slots_ = {};
+  Rehash(kInitialNumSlots);
+}
+
+int64_t AggHashTable::BytesUsed() const {
+  return static_cast<int64_t>(keys_.capacity() + string_arena_.capacity() +
+                              group_hashes_.capacity() * sizeof(uint64_t) +
+                              slots_.capacity() * sizeof(int64_t));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
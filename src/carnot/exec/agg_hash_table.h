@@ -0,0 +1,162 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/array/builder_base.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * Hashes the key of every row of a batch, a key column at a time. Float keys are canonicalized
+ * first, so -0.0 and 0.0 hash the same, and so do all NaNs. Dictionary encoded STRING keys hash
+ * each distinct value once.
+ * @param key_types The types of the key columns.
+ * @param key_cols The key columns of the batch.
+ * @param num_rows The number of rows in the batch.
+ * @param hashes Output, the hash of the key of every row.
+ */
+void HashKeyColumns(const std::vector<types::DataType>& key_types,
+                    const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                    std::vector<uint64_t>* hashes);
+
+/**
+ * AggHashTable maps the group-by keys of row batches to dense group ids (0, 1, 2, ...).
+ *
+ * Unlike a hash map keyed by RowTuple, keys are never materialized per row:
+ *  - Keys of a batch are hashed a column at a time.
+ *  - The key of each group is stored once, inline in a flat byte array. Fixed-width key columns
+ *    are laid out first so that comparing them is a single memcmp; string key columns store an
+ *    (offset, length) pair into a shared string arena.
+ *  - The table itself is an open-addressing array of group ids, probed linearly, with the hash of
+ *    every group kept alongside the keys to make probing and rehashing cheap.
+ *
+ * Callers keep per-group state in arrays indexed by group id.
+ */
+class AggHashTable : public NotCopyable {
+ public:
+  explicit AggHashTable(std::vector<types::DataType> key_types);
+
+  /**
+   * Finds the group of every row of a batch, creating groups for keys that haven't been seen.
+   * New groups are assigned consecutive ids in order of first appearance.
+   * @param key_cols The key columns of the batch, in the order of the key types.
+   * @param num_rows The number of rows in the batch.
+   * @param group_ids Output, the group id of every row.
+   */
+  void FindOrInsertBatch(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                         std::vector<int64_t>* group_ids) {
+    FindOrInsertBatch(key_cols, num_rows, nullptr, group_ids);
+  }
+
+  /**
+   * Like the above, but only for the rows of the batch in the selection.
+   * @param selection The sorted indices of the rows to look up, or nullptr for all rows.
+   * @param group_ids Output, the group id of every selected row, in selection order.
+   */
+  void FindOrInsertBatch(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                         const std::vector<int64_t>* selection, std::vector<int64_t>* group_ids);
+
+  /**
+   * Appends the key of every group, in group id order, to the given builders.
+   * @param builders One builder per key column, matching the key types.
+   */
+  Status AppendKeys(const std::vector<arrow::ArrayBuilder*>& builders) const {
+    return AppendKeys(builders, nullptr);
+  }
+
+  /**
+   * Like the above, but only for the given groups.
+   * @param group_ids The ids of the groups to append, in order, or nullptr for all groups.
+   */
+  Status AppendKeys(const std::vector<arrow::ArrayBuilder*>& builders,
+                    const std::vector<int64_t>* group_ids) const;
+
+  /**
+   * Removes all groups and releases the memory they held.
+   */
+  void Clear();
+
+  int64_t num_groups() const { return static_cast<int64_t>(group_hashes_.size()); }
+
+  /**
+   * @return The hash of the key of a group, which is the same as HashKeyColumns computes for it.
+   */
+  uint64_t group_hash(int64_t group_id) const { return group_hashes_[group_id]; }
+
+  /**
+   * @return The number of bytes held by the keys and the table.
+   */
+  int64_t BytesUsed() const;
+
+ private:
+  void HashBatch(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows);
+  bool KeyEquals(int64_t group_id, const std::vector<const arrow::Array*>& key_cols,
+                 int64_t row) const;
+  int64_t InsertKey(uint64_t hash, const std::vector<const arrow::Array*>& key_cols, int64_t row);
+  void Rehash(size_t num_slots);
+
+  // The string key slot of a group, pointing into string_arena_.
+  struct StringSlot {
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  static constexpr int64_t kEmptySlot = -1;
+  static constexpr size_t kInitialNumSlots = 1024;
+
+  std::vector<types::DataType> key_types_;
+  // The byte offset of each key column within an inline key.
+  std::vector<size_t> key_offsets_;
+  // The size of the fixed-width prefix of an inline key.
+  size_t fixed_width_ = 0;
+  // The size of an inline key.
+  size_t key_width_ = 0;
+  // Whether any key column is a string.
+  bool has_string_keys_ = false;
+
+  // The keys of all groups, key_width_ bytes per group.
+  std::vector<uint8_t> keys_;
+  // The hash of the key of each group.
+  std::vector<uint64_t> group_hashes_;
+  // The bytes of all string keys.
+  std::vector<char> string_arena_;
+
+  // The open addressing table of group ids. Its size is always a power of 2.
+  std::vector<int64_t> slots_;
+  uint64_t slot_mask_ = 0;
+
+  // The fixed-width key prefixes and the hashes of the rows of the current batch.
+  std::vector<uint8_t> batch_fixed_keys_;
+  std::vector<uint64_t> batch_hashes_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/agg_hash_table.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using ::testing::ElementsAre;
+
+std::vector<const arrow::Array*> RawArrays(const std::vector<std::shared_ptr<arrow::Array>>& cols) {
+  std::vector<const arrow::Array*> raw;
+  for (const auto& col : cols) {
+    raw.push_back(col.get());
+  }
+  return raw;
+}
+
+TEST(AggHashTableTest, single_int_key) {
+  AggHashTable table({types::DataType::INT64});
+  auto col = types::ToArrow(std::vector<types::Int64Value>{5, 1, 5, 7, 1},
+                            arrow::default_memory_pool());
+
+  std::vector<int64_t> group_ids;
+  table.FindOrInsertBatch({col.get()}, col->length(), &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 0, 2, 1));
+  EXPECT_EQ(3, table.num_groups());
+
+  // Groups are remembered across batches.
+  auto col2 =
+      types::ToArrow(std::vector<types::Int64Value>{7, 9, 5}, arrow::default_memory_pool());
+  table.FindOrInsertBatch({col2.get()}, col2->length(), &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(2, 3, 0));
+  EXPECT_EQ(4, table.num_groups());
+
+  arrow::Int64Builder builder;
+  ASSERT_OK(table.AppendKeys({&builder}));
+  std::shared_ptr<arrow::Array> keys;
+  ASSERT_TRUE(builder.Finish(&keys).ok());
+  auto* int_keys = static_cast<arrow::Int64Array*>(keys.get());
+  ASSERT_EQ(4, int_keys->length());
+  EXPECT_EQ(5, int_keys->Value(0));
+  EXPECT_EQ(1, int_keys->Value(1));
+  EXPECT_EQ(7, int_keys->Value(2));
+  EXPECT_EQ(9, int_keys->Value(3));
+}
+
+TEST(AggHashTableTest, float_keys_are_canonicalized) {
+  AggHashTable table({types::DataType::FLOAT64});
+  // A NaN with a different payload and sign than the canonical one.
+  uint64_t nan_bits = 0xfff8000000000123;
+  double other_nan;
+  memcpy(&other_nan, &nan_bits, sizeof(other_nan));
+  auto col = types::ToArrow(
+      std::vector<types::Float64Value>{0.0, -0.0, std::numeric_limits<double>::quiet_NaN(),
+                                       other_nan, 1.5},
+      arrow::default_memory_pool());
+
+  std::vector<int64_t> group_ids;
+  table.FindOrInsertBatch({col.get()}, col->length(), &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 0, 1, 1, 2));
+  EXPECT_EQ(3, table.num_groups());
+}
+
+TEST(AggHashTableTest, subset_of_keys) {
+  AggHashTable table({types::DataType::STRING});
+  auto col = types::ToArrow(std::vector<types::StringValue>{"a", "b", "c", "b"},
+                            arrow::default_memory_pool());
+  std::vector<int64_t> group_ids;
+  table.FindOrInsertBatch({col.get()}, col->length(), &group_ids);
+
+  // Group hashes are the same as the row hashes of their keys.
+  std::vector<uint64_t> hashes;
+  HashKeyColumns({types::DataType::STRING}, {col.get()}, col->length(), &hashes);
+  for (int64_t i = 0; i < col->length(); ++i) {
+    EXPECT_EQ(hashes[i], table.group_hash(group_ids[i]));
+  }
+
+  arrow::StringBuilder builder;
+  std::vector<int64_t> subset{2, 0};
+  ASSERT_OK(table.AppendKeys({&builder}, &subset));
+  std::shared_ptr<arrow::Array> keys;
+  ASSERT_TRUE(builder.Finish(&keys).ok());
+  auto* str_keys = static_cast<arrow::StringArray*>(keys.get());
+  ASSERT_EQ(2, str_keys->length());
+  EXPECT_EQ("c", str_keys->GetString(0));
+  EXPECT_EQ("a", str_keys->GetString(1));
+}
+
+TEST(AggHashTableTest, selected_rows) {
+  AggHashTable table({types::DataType::INT64});
+  auto col = types::ToArrow(std::vector<types::Int64Value>{5, 1, 5, 7, 1},
+                            arrow::default_memory_pool());
+
+  // Rows outside of the selection don't create groups.
+  std::vector<int64_t> selection{1, 3, 4};
+  std::vector<int64_t> group_ids;
+  table.FindOrInsertBatch({col.get()}, col->length(), &selection, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 0));
+  EXPECT_EQ(2, table.num_groups());
+}
+
+TEST(AggHashTableTest, mixed_keys) {
+  AggHashTable table({types::DataType::STRING, types::DataType::INT64, types::DataType::FLOAT64,
+                      types::DataType::BOOLEAN});
+  std::vector<std::shared_ptr<arrow::Array>> cols = {
+      types::ToArrow(std::vector<types::StringValue>{"abc", "abc", "", "abc", "ab"},
+                     arrow::default_memory_pool()),
+      types::ToArrow(std::vector<types::Int64Value>{1, 1, 1, 2, 1}, arrow::default_memory_pool()),
+      types::ToArrow(std::vector<types::Float64Value>{0.5, 0.5, 0.5, 0.5, 0.5},
+                     arrow::default_memory_pool()),
+      types::ToArrow(std::vector<types::BoolValue>{true, true, true, true, false},
+                     arrow::default_memory_pool()),
+  };
+
+  std::vector<int64_t> group_ids;
+  table.FindOrInsertBatch(RawArrays(cols), 5, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 0, 1, 2, 3));
+
+  arrow::StringBuilder str_builder;
+  arrow::Int64Builder int_builder;
+  arrow::DoubleBuilder double_builder;
+  arrow::BooleanBuilder bool_builder;
+  ASSERT_OK(table.AppendKeys({&str_builder, &int_builder, &double_builder, &bool_builder}));
+  std::shared_ptr<arrow::Array> str_keys;
+  ASSERT_TRUE(str_builder.Finish(&str_keys).ok());
+  auto* typed_str_keys = static_cast<arrow::StringArray*>(str_keys.get());
+  ASSERT_EQ(4, typed_str_keys->length());
+  EXPECT_EQ("abc", typed_str_keys->GetString(0));
+  EXPECT_EQ("", typed_str_keys->GetString(1));
+  EXPECT_EQ("abc", typed_str_keys->GetString(2));
+  EXPECT_EQ("ab", typed_str_keys->GetString(3));
+}
+
+TEST(AggHashTableTest, many_groups_rehash) {
+  constexpr int64_t kNumGroups = 100 * 1000;
+  AggHashTable table({types::DataType::INT64, types::DataType::STRING});
+  std::vector<types::Int64Value> ints;
+  std::vector<types::StringValue> strs;
+  for (int64_t i = 0; i < kNumGroups; ++i) {
+    ints.emplace_back(i % 1000);
+    strs.emplace_back(std::to_string(i / 1000));
+  }
+  std::vector<std::shared_ptr<arrow::Array>> cols = {
+      types::ToArrow(ints, arrow::default_memory_pool()),
+      types::ToArrow(strs, arrow::default_memory_pool())};
+
+  std::vector<int64_t> group_ids;
+  table.FindOrInsertBatch(RawArrays(cols), kNumGroups, &group_ids);
+  EXPECT_EQ(kNumGroups, table.num_groups());
+  for (int64_t i = 0; i < kNumGroups; ++i) {
+    EXPECT_EQ(i, group_ids[i]);
+  }
+
+  // Looking up the same keys again must not add groups.
+  table.FindOrInsertBatch(RawArrays(cols), kNumGroups, &group_ids);
+  EXPECT_EQ(kNumGroups, table.num_groups());
+  for (int64_t i = 0; i < kNumGroups; ++i) {
+    EXPECT_EQ(i, group_ids[i]);
+  }
+
+  table.Clear();
+  EXPECT_EQ(0, table.num_groups());
+  table.FindOrInsertBatch(RawArrays(cols), 1, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -23,6 +23,9 @@
 #include <arrow/status.h>
 #include <algorithm>
 #include <cstdint>
+#include <iterator>
+#include <new>
+#include <optional>
 
 #include <magic_enum.hpp>
 
@@ -41,40 +44,49 @@ namespace exec {
 
 using SharedArray = std::shared_ptr<arrow::Array>;
 constexpr int64_t kAggCompactionThreshold = 512;
+// Rough per-value sizes used to estimate the memory held by the groups.
+constexpr int64_t kUDAStateBytesEstimate = 64;
+constexpr int64_t kStagedValueBytesEstimate = 16;
 
 using table_store::schema::RowBatch;
-using table_store::schema::RowDescriptor;
 
-namespace {
-template <types::DataType DT>
-void ExtractIntoGroupArgs(std::vector<GroupArgs>* group_args, arrow::Array* col, int rt_col_idx) {
-  auto num_rows = col->length();
-  for (auto row_idx = 0; row_idx < num_rows; ++row_idx) {
-    ExtractIntoRowTuple<DT>((*group_args)[row_idx].rt, col, rt_col_idx, row_idx);
+UDAStateArray::UDAStateArray(udf::UDADefinition* def) : def_(def) {
+  size_t alignment = def_->uda_alignment();
+  stride_ = (def_->uda_size() + alignment - 1) / alignment * alignment;
+}
+
+udf::UDA* UDAStateArray::Add() {
+  int64_t idx_in_chunk = size() % kUDAsPerChunk;
+  auto chunk_idx = static_cast<size_t>(size() / kUDAsPerChunk);
+  if (chunk_idx == chunks_.size()) {
+    std::align_val_t alignment{def_->uda_alignment()};
+    chunks_.emplace_back(static_cast<char*>(::operator new(stride_ * kUDAsPerChunk, alignment)),
+                         ChunkDeleter{alignment});
   }
+  udas_.push_back(def_->MakeAt(chunks_[chunk_idx].get() + idx_in_chunk * stride_));
+  return udas_.back();
 }
 
-template <types::DataType DT>
-void AppendToBuilder(arrow::ArrayBuilder* builder, RowTuple* rt, size_t rt_idx) {
-  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
-  using ValueType = typename types::DataTypeTraits<DT>::value_type;
-  auto status =
-      static_cast<ArrowBuilder*>(builder)->Append(udf::UnWrap(rt->GetValue<ValueType>(rt_idx)));
-  PX_DCHECK_OK(status);
-  PX_UNUSED(status);
+void UDAStateArray::Clear() {
+  for (udf::UDA* uda : udas_) {
+    uda->~UDA();
+  }
+  udas_.clear();
+  if (chunks_.size() > 1) {
+    chunks_.resize(1);
+  }
 }
+using table_store::schema::RowDescriptor;
 
+namespace {
 template <types::DataType DT>
-void ExtractToColumnWrapper(const std::vector<GroupArgs>& group_args,
-                            const table_store::schema::RowBatch& rb, size_t col_idx,
-                            size_t rb_col_idx) {
-  size_t num_rows = rb.num_rows();
-  DCHECK(num_rows <= group_args.size());
-  for (size_t row_idx = 0; row_idx < num_rows; ++row_idx) {
-    DCHECK(group_args[row_idx].av != nullptr);
-    auto col_wrapper = group_args[row_idx].av->agg_cols[col_idx].get();
-    auto arr = rb.ColumnAt(rb_col_idx).get();
-    types::ExtractValueToColumnWrapper<DT>(col_wrapper, arr, row_idx);
+void ExtractToColumnWrappers(const std::vector<int64_t>& group_ids, const RowBatch& rb,
+                             std::vector<types::SharedColumnWrapper>* group_cols,
+                             arrow::Array* arr) {
+  DCHECK_EQ(static_cast<size_t>(rb.num_selected_rows()), group_ids.size());
+  for (size_t i = 0; i < group_ids.size(); ++i) {
+    auto col_wrapper = (*group_cols)[group_ids[i]].get();
+    types::ExtractValueToColumnWrapper<DT>(col_wrapper, arr, rb.SelectedRow(i));
   }
 }
 
@@ -134,6 +146,14 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     value_data_types_.emplace_back(output_descriptor_->type(values_idx));
   }
 
+  agg_hash_table_ = std::make_unique<AggHashTable>(group_data_types_);
+
+  std::vector<types::DataType> spill_types = group_data_types_;
+  for (size_t i = 0; i < groups_size; ++i) {
+    spill_key_cols_.push_back(i);
+  }
+  spill_types.insert(spill_types.end(), values_size, types::DataType::STRING);
+  spill_descriptor_ = std::make_unique<RowDescriptor>(spill_types);
   return CreateColumnMapping();
 }
 
@@ -145,13 +165,44 @@ Status AggNode::PrepareImpl(ExecState* exec_state) {
 Status AggNode::OpenImpl(ExecState* exec_state) {
   if (HasNoGroups()) {
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
+  } else {
+    uda_states_.reserve(plan_node_->values().size());
+    for (const auto& value : plan_node_->values()) {
+      uda_states_.emplace_back(exec_state->GetUDADefinition(value->uda_id()));
+    }
+    if (plan_node_->partial_agg()) {
+      agg_cols_.resize(stored_cols_data_types_.size());
+    }
+    // Spilled groups are written as serialized UDA states, so only aggregates whose UDAs can all
+    // serialize their state may spill.
+    spillable_ = std::all_of(uda_states_.begin(), uda_states_.end(),
+                             [](const UDAStateArray& states) {
+                               return states.def()->supports_partial();
+                             });
+    if (spillable_) {
+      exec_state->AddSpillableNode();
+      added_spillable_node_ = true;
+    }
   }
-  if (!plan_node_->partial_agg()) {
+  // Spillable aggregates also deserialize the states of the groups they spill.
+  if (!plan_node_->partial_agg() || spillable_) {
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_for_deserialize_, exec_state));
   }
   return Status::OK();
 }
 
+bool AggNode::SupportsSelection() const {
+  // Grouped partial aggregates hash and stage only the selected rows. Other aggregates consume
+  // whole columns, so they are given compacted batches.
+  return !HasNoGroups() && plan_node_->partial_agg();
+}
+
+bool AggNode::SupportsDictionaryColumns() const {
+  // Grouped partial aggregates hash dictionary encoded keys a distinct value at a time, and copy
+  // the values of the rows out of their dictionaries when staging them.
+  return !HasNoGroups() && plan_node_->partial_agg();
+}
+
 Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
   if (HasNoGroups()) {
     return AggregateGroupByNone(exec_state, rb);
@@ -159,11 +210,25 @@ Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_
   return AggregateGroupByClause(exec_state, rb);
 }
 
-Status AggNode::CloseImpl(ExecState*) {
+Status AggNode::CloseImpl(ExecState* exec_state) {
   udas_no_groups_.clear();
-  group_args_chunk_.clear();
-  group_args_pool_.Clear();
-  udas_pool_.Clear();
+  uda_states_.clear();
+  agg_cols_.clear();
+  if (agg_hash_table_ != nullptr) {
+    stats()->AddExtraMetric("hash_table_bytes", agg_hash_table_->BytesUsed());
+    stats()->AddExtraMetric("spills", num_spills_);
+    stats()->AddExtraMetric("spill_bytes", spill_bytes_);
+    stats()->AddExtraMetric("spill_partitions", spill_partitions_used_);
+    agg_hash_table_->Clear();
+    limit_hashes_.clear();
+    spill_partitions_.reset();
+    exec_state->UpdateSpillableBytes(-reported_state_bytes_);
+    reported_state_bytes_ = 0;
+  }
+  if (added_spillable_node_) {
+    exec_state->RemoveSpillableNode();
+    added_spillable_node_ = false;
+  }
 
   return Status::OK();
 }
@@ -176,8 +241,17 @@ Status AggNode::ClearAggState(ExecState* exec_state) {
   if (HasNoGroups()) {
     udas_no_groups_.clear();
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
+    return Status::OK();
+  }
+  agg_hash_table_->Clear();
+  for (auto& uda_state : uda_states_) {
+    uda_state.Clear();
   }
-  agg_hash_map_.clear();
+  for (auto& group_cols : agg_cols_) {
+    group_cols.clear();
+  }
+  staged_rows_ = 0;
+  UpdateGroupStateBytes(exec_state);
   return Status::OK();
 }
 
@@ -219,147 +293,140 @@ Status AggNode::AggregateGroupByNone(ExecState* exec_state, const RowBatch& rb)
   return Status::OK();
 }
 
-Status AggNode::ExtractRowTupleForBatch(const RowBatch& rb) {
-  // Grow the group_args_chunk_ to be the size of the RowBatch.
-  size_t num_rows = rb.num_rows();
-  if (group_args_chunk_.size() < num_rows) {
-    int prev_size = group_args_chunk_.size();
-    group_args_chunk_.reserve(num_rows);
-    for (size_t idx = prev_size; idx < num_rows; ++idx) {
-      group_args_chunk_.emplace_back(CreateGroupArgsRowTuple());
-    }
-  }
-
-  // Scan through all the group args in column order and extract the entire column.
-  for (size_t idx = 0; idx < plan_node_->groups().size(); idx++) {
-    auto grp = plan_node_->groups()[idx];
+Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& input_rb) {
+  std::vector<const arrow::Array*> key_cols;
+  key_cols.reserve(plan_node_->groups().size());
+  for (const auto& grp : plan_node_->groups()) {
     DCHECK(grp.idx < input_descriptor_->size());
-    DCHECK(idx < group_data_types_.size());
-    auto dt = group_data_types_[idx];
-    auto col = rb.ColumnAt(grp.idx).get();
-
-#define TYPE_CASE(_dt_) ExtractIntoGroupArgs<_dt_>(&group_args_chunk_, col, idx);
-    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
+    key_cols.push_back(input_rb.ColumnAt(grp.idx).get());
   }
-  return Status::OK();
-}
 
-Status AggNode::HashRowBatch(ExecState* exec_state, const RowBatch& rb) {
-  PX_UNUSED(exec_state);
-  // Loop through all the row and basically store the values into column chunk based on which
-  // group they belong to.
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto& ga = group_args_chunk_[row_idx];
-    AggHashValue* val = nullptr;
-    // Check to see if in hash
-    // TODO(zasgar): Change this to upsert.
-    auto it = agg_hash_map_.find(ga.rt);
-    // If not in hash then insert
-    if (it == agg_hash_map_.end()) {
-      // Create a val array.
-      val = CreateAggHashValue(exec_state);
-      agg_hash_map_[ga.rt] = val;
-      // We have inserted this, so the stored RowTuple is now in the table.
-      ga.rt = nullptr;
-    } else {
-      val = it->second;
-    }
-    ga.av = val;
+  // With a group limit, the rows of groups that can't make the limit are never added to the table.
+  std::optional<RowBatch> limited_rb;
+  if (group_limit_ > 0) {
+    limited_rb.emplace(input_rb);
+    limited_rb->set_selection(SelectRowsUnderGroupLimit(key_cols, input_rb));
   }
+  const RowBatch& rb = limited_rb.has_value() ? *limited_rb : input_rb;
 
-  // Now extract the values in the agg hash value.
-  for (size_t i = 0; i < stored_cols_data_types_.size(); ++i) {
-    const auto& rb_col_idx = stored_cols_to_plan_idx_[i];
-    const auto& dt = input_descriptor_->type(rb_col_idx);
-
-    // Even if we're not doing a partial agg we want to extract the group values.
-    if (plan_node_->partial_agg() || i < plan_node_->groups().size()) {
-#define TYPE_CASE(_dt_) ExtractToColumnWrapper<_dt_>(group_args_chunk_, rb, i, rb_col_idx);
-
-      PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
+  int64_t prev_num_groups = agg_hash_table_->num_groups();
+  agg_hash_table_->FindOrInsertBatch(key_cols, rb.num_rows(), rb.selection().get(), &group_ids_);
+  for (int64_t i = prev_num_groups; i < agg_hash_table_->num_groups(); ++i) {
+    PX_RETURN_IF_ERROR(AddGroupState(exec_state));
+    if (group_limit_ > 0) {
+      AddGroupLimitHash(agg_hash_table_->group_hash(i));
     }
   }
+
   if (!plan_node_->partial_agg()) {
     // If we're not performing a partial_agg, then we're receiving serialized partial aggs, so we
     // deserialize and merge them here.
-    PX_RETURN_IF_ERROR(DeserializeAndMergeGrouped(group_args_chunk_, rb));
+    return DeserializeAndMergeGrouped(rb);
   }
 
+  // Now extract the values into the columns of their groups.
+  if (!stored_cols_data_types_.empty()) {
+    staged_rows_ += rb.num_selected_rows();
+  }
+  for (size_t i = 0; i < stored_cols_data_types_.size(); ++i) {
+    const auto& rb_col_idx = stored_cols_to_plan_idx_[i];
+    auto* arr = rb.ColumnAt(rb_col_idx).get();
+#define TYPE_CASE(_dt_) ExtractToColumnWrappers<_dt_>(group_ids_, rb, &agg_cols_[i], arr);
+    PX_SWITCH_FOREACH_DATATYPE(stored_cols_data_types_[i], TYPE_CASE);
+#undef TYPE_CASE
+  }
   return Status::OK();
 }
 
 Status AggNode::EvaluatePartialAggregates(ExecState* exec_state, size_t num_records) {
-  PX_UNUSED(exec_state);
-  // TODO(zasgar): This only needs to run for unique groups. We should find
-  // a way to optimize this.
+  if (agg_cols_.empty()) {
+    return Status::OK();
+  }
+  // Only the groups that received rows in this batch can have crossed the threshold.
+  const auto& first_cols = agg_cols_[0];
   for (size_t i = 0; i < num_records; ++i) {
-    DCHECK(i < group_args_chunk_.size());
-    auto& ga = group_args_chunk_[i];
-    DCHECK(ga.av != nullptr);
-    if (ga.av->agg_cols[0]->Size() > kAggCompactionThreshold) {
-      PX_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, ga.av));
+    DCHECK(i < group_ids_.size());
+    if (first_cols[group_ids_[i]]->Size() > kAggCompactionThreshold) {
+      PX_RETURN_IF_ERROR(EvaluateGroup(exec_state, group_ids_[i]));
     }
   }
   return Status::OK();
 }
 
-Status AggNode::ResetGroupArgs() {
-  // Reset the group args. If the row tuple is null it has been consumed, so
-  // we can replace it with a new RowTuple. We also reset the
-  // agg hash value to nullptr.
-  for (size_t i = 0; i < group_args_chunk_.size(); ++i) {
-    group_args_chunk_[i].av = nullptr;
-    if (group_args_chunk_[i].rt == nullptr) {
-      group_args_chunk_[i].rt = CreateGroupArgsRowTuple();
-    } else {
-      group_args_chunk_[i].rt->Reset();
+bool AggNode::HashUnderGroupLimit(uint64_t hash) const {
+  return static_cast<int64_t>(limit_hashes_.size()) < group_limit_ ||
+         hash <= *limit_hashes_.rbegin();
+}
+
+void AggNode::AddGroupLimitHash(uint64_t hash) {
+  limit_hashes_.insert(hash);
+  if (static_cast<int64_t>(limit_hashes_.size()) > group_limit_) {
+    limit_hashes_.erase(std::prev(limit_hashes_.end()));
+  }
+}
+
+std::shared_ptr<const std::vector<int64_t>> AggNode::SelectRowsUnderGroupLimit(
+    const std::vector<const arrow::Array*>& key_cols, const RowBatch& rb) {
+  HashKeyColumns(group_data_types_, key_cols, rb.num_rows(), &row_hashes_);
+  auto selection = std::make_shared<std::vector<int64_t>>();
+  for (int64_t i = 0; i < rb.num_selected_rows(); ++i) {
+    int64_t row = rb.SelectedRow(i);
+    if (HashUnderGroupLimit(row_hashes_[row])) {
+      selection->push_back(row);
     }
   }
-  return Status::OK();
+  return selection;
 }
 
-Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
-  PX_UNUSED(exec_state);
+int64_t AggNode::SelectGroupsToEmit() {
+  int64_t num_groups = agg_hash_table_->num_groups();
+  if (group_limit_ == 0) {
+    return num_groups;
+  }
+  // The hashes of all groups in the table have been added to limit_hashes_, so this keeps at most
+  // group_limit_ groups. Groups that were admitted before the limit tightened are dropped here.
+  emit_group_ids_.clear();
+  for (int64_t group_id = 0; group_id < num_groups; ++group_id) {
+    if (HashUnderGroupLimit(agg_hash_table_->group_hash(group_id))) {
+      emit_group_ids_.push_back(group_id);
+    }
+  }
+  return static_cast<int64_t>(emit_group_ids_.size());
+}
+
+Status AggNode::ConvertAggHashTableToRowBatch(ExecState* exec_state, bool finalize,
+                                              RowBatch* output_rb) {
   DCHECK(output_rb != nullptr);
+  const std::vector<int64_t>* group_ids = group_limit_ > 0 ? &emit_group_ids_ : nullptr;
+  int64_t num_groups = output_rb->num_rows();
+  auto group_id_at = [group_ids](int64_t i) { return group_ids == nullptr ? i : (*group_ids)[i]; };
+
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> group_builders;
+  std::vector<arrow::ArrayBuilder*> raw_group_builders;
   for (const auto& group_dt : group_data_types_) {
     group_builders.push_back(types::MakeArrowBuilder(group_dt, exec_state->exec_mem_pool()));
+    raw_group_builders.push_back(group_builders.back().get());
   }
-  std::vector<std::unique_ptr<arrow::ArrayBuilder>> value_builders;
-  for (const auto& value_data_type : value_data_types_) {
-    value_builders.push_back(types::MakeArrowBuilder(value_data_type, exec_state->exec_mem_pool()));
-  }
-
-  // Agg into agg values and emit!
-  for (const auto& kv : agg_hash_map_) {
-    auto* groups_rt = kv.first;
-    auto* val = kv.second;
+  PX_RETURN_IF_ERROR(agg_hash_table_->AppendKeys(raw_group_builders, group_ids));
 
-    for (size_t i = 0; i < group_data_types_.size(); ++i) {
-      DCHECK(i < group_builders.size());
-
-#define TYPE_CASE(_dt_) AppendToBuilder<_dt_>(group_builders[i].get(), groups_rt, i);
-      PX_SWITCH_FOREACH_DATATYPE(group_data_types_[i], TYPE_CASE);
-#undef TYPE_CASE
-    }
-    if (plan_node_->partial_agg()) {
-      PX_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
+  if (plan_node_->partial_agg()) {
+    for (int64_t i = 0; i < num_groups; ++i) {
+      PX_RETURN_IF_ERROR(EvaluateGroup(exec_state, group_id_at(i)));
     }
+  }
 
-    if (plan_node_->finalize_results()) {
-      // Actually Finalize the UDA based on the column wrapper chunks.
-      for (size_t i = 0; i < val->udas.size(); ++i) {
-        const auto& uda_info = val->udas[i];
-        PX_RETURN_IF_ERROR(uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(),
-                                                       value_builders[i].get()));
-      }
-    } else {
-      for (size_t i = 0; i < val->udas.size(); ++i) {
-        const auto& uda_info = val->udas[i];
-        PX_RETURN_IF_ERROR(uda_info.def->SerializeArrow(uda_info.uda.get(), function_ctx_.get(),
-                                                        value_builders[i].get()));
+  // Emit one aggregate at a time, so each pass walks the adjacent UDA states of one aggregate.
+  std::vector<std::unique_ptr<arrow::ArrayBuilder>> value_builders;
+  for (const auto& [i, uda_state] : Enumerate(uda_states_)) {
+    value_builders.push_back(types::MakeArrowBuilder(
+        finalize ? value_data_types_[i] : types::DataType::STRING, exec_state->exec_mem_pool()));
+    auto* builder = value_builders.back().get();
+    for (int64_t idx = 0; idx < num_groups; ++idx) {
+      auto* uda = uda_state[group_id_at(idx)];
+      if (finalize) {
+        PX_RETURN_IF_ERROR(uda_state.def()->FinalizeArrow(uda, function_ctx_.get(), builder));
+      } else {
+        PX_RETURN_IF_ERROR(uda_state.def()->SerializeArrow(uda, function_ctx_.get(), builder));
       }
     }
   }
@@ -380,23 +447,26 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
 }
 
 Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb) {
-  // Extracts the row tuples (column wise).
-  // TODO(zasgar): PL-455 - Chunk this so we don't create a crazy number of row tuples if the batch
-  // is large. The process is as follows:
-  // 1. Extract each column into the appropriate part of the row tuple.
-  // 2. Hash row batch and update agg values.
-  // 3. If the agg values are large then run aggregate and compact.
-  // 4. Reset state to prepare for next row batch.
-  // 5. If it's the last batch then emit the values.
-  PX_RETURN_IF_ERROR(ExtractRowTupleForBatch(rb));
+  // The process is as follows:
+  // 1. Find the group ids of the rows and update agg values.
+  // 2. If the agg values are large then run aggregate and compact.
+  // 3. If it's the last batch then emit the values.
   PX_RETURN_IF_ERROR(HashRowBatch(exec_state, rb));
   if (plan_node_->partial_agg() && plan_node_->values().size() > 0) {
-    PX_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, rb.num_rows()));
+    PX_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, group_ids_.size()));
+  }
+  UpdateGroupStateBytes(exec_state);
+  if (spillable_ && agg_hash_table_->num_groups() > 0 &&
+      exec_state->ShouldSpill(reported_state_bytes_)) {
+    PX_RETURN_IF_ERROR(SpillGroups(exec_state));
   }
-  PX_RETURN_IF_ERROR(ResetGroupArgs());
   if (ReadyToEmitBatches(rb)) {
-    RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
-    PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
+    if (spill_partitions_ != nullptr) {
+      return EmitSpilledGroups(exec_state, rb);
+    }
+    RowBatch output_rb(*output_descriptor_, SelectGroupsToEmit());
+    PX_RETURN_IF_ERROR(
+        ConvertAggHashTableToRowBatch(exec_state, plan_node_->finalize_results(), &output_rb));
     output_rb.set_eow(rb.eow());
     output_rb.set_eos(rb.eos());
     PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
@@ -405,6 +475,74 @@ Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb
   return Status::OK();
 }
 
+int64_t AggNode::EstimateGroupStateBytes() const {
+  int64_t num_groups = agg_hash_table_->num_groups();
+  return agg_hash_table_->BytesUsed() +
+         num_groups * static_cast<int64_t>(uda_states_.size()) * kUDAStateBytesEstimate +
+         staged_rows_ * static_cast<int64_t>(agg_cols_.size()) * kStagedValueBytesEstimate;
+}
+
+void AggNode::UpdateGroupStateBytes(ExecState* exec_state) {
+  int64_t state_bytes = EstimateGroupStateBytes();
+  exec_state->UpdateSpillableBytes(state_bytes - reported_state_bytes_);
+  reported_state_bytes_ = state_bytes;
+}
+
+Status AggNode::SpillGroups(ExecState* exec_state) {
+  if (spill_partitions_ == nullptr) {
+    spill_partitions_ = std::make_unique<SpillPartitions>(exec_state->spill_dir(),
+                                                         exec_state->exec_mem_pool());
+  }
+  // Groups that are already over the group limit are dropped rather than spilled.
+  RowBatch spill_rb(*spill_descriptor_, SelectGroupsToEmit());
+  PX_RETURN_IF_ERROR(ConvertAggHashTableToRowBatch(exec_state, /*finalize*/ false, &spill_rb));
+  PX_RETURN_IF_ERROR(spill_partitions_->Append(spill_rb, spill_key_cols_));
+  ++num_spills_;
+  return ClearAggState(exec_state);
+}
+
+Status AggNode::MergeSpilledBatch(ExecState* exec_state, const RowBatch& rb) {
+  std::vector<const arrow::Array*> key_cols;
+  for (int64_t col : spill_key_cols_) {
+    key_cols.push_back(rb.ColumnAt(col).get());
+  }
+  int64_t prev_num_groups = agg_hash_table_->num_groups();
+  agg_hash_table_->FindOrInsertBatch(key_cols, rb.num_rows(), &group_ids_);
+  for (int64_t i = prev_num_groups; i < agg_hash_table_->num_groups(); ++i) {
+    PX_RETURN_IF_ERROR(AddGroupState(exec_state));
+  }
+  return DeserializeAndMergeGrouped(rb);
+}
+
+Status AggNode::EmitSpilledGroups(ExecState* exec_state, const RowBatch& rb) {
+  // Spill what's left in memory, so every group is merged back from exactly one partition.
+  if (agg_hash_table_->num_groups() > 0) {
+    PX_RETURN_IF_ERROR(SpillGroups(exec_state));
+  }
+  int64_t num_partitions = spill_partitions_->num_partitions();
+  for (int64_t partition = 0; partition < num_partitions; ++partition) {
+    PX_RETURN_IF_ERROR(
+        spill_partitions_->ForEachBatch(partition, [&](const RowBatch& spilled_rb) {
+          return MergeSpilledBatch(exec_state, spilled_rb);
+        }));
+    bool last_partition = partition == num_partitions - 1;
+    if (agg_hash_table_->num_groups() == 0 && !last_partition) {
+      continue;
+    }
+    ++spill_partitions_used_;
+    RowBatch output_rb(*output_descriptor_, SelectGroupsToEmit());
+    PX_RETURN_IF_ERROR(
+        ConvertAggHashTableToRowBatch(exec_state, plan_node_->finalize_results(), &output_rb));
+    output_rb.set_eow(last_partition && rb.eow());
+    output_rb.set_eos(last_partition && rb.eos());
+    PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+    PX_RETURN_IF_ERROR(ClearAggState(exec_state));
+  }
+  spill_bytes_ += spill_partitions_->bytes_written();
+  spill_partitions_.reset();
+  return Status::OK();
+}
+
 StatusOr<types::DataType> AggNode::GetTypeOfDep(const plan::ScalarExpression& expr) const {
   // Agg exprs can only be of type col, or  const.
   switch (expr.ExpressionType()) {
@@ -462,12 +600,13 @@ Status AggNode::EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UD
   return Status::OK();
 }
 
-Status AggNode::EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val) {
+Status AggNode::EvaluateGroup(ExecState* exec_state, int64_t group_id) {
   size_t values_size = plan_node_->values().size();
   for (size_t i = 0; i < values_size; ++i) {
-    const auto& uda_info = val->udas[i];
+    const auto& uda_state = uda_states_[i];
+    auto* uda = uda_state[group_id];
     const auto& expr = *plan_node_->values()[i];
-    size_t num_records = val->agg_cols[0]->Size();
+    size_t num_records = agg_cols_.empty() ? 0 : agg_cols_[0][group_id]->Size();
     plan::ExpressionWalker<StatusOr<types::SharedColumnWrapper>> walker;
     walker.OnScalarValue([&](const plan::ScalarValue& scalar_val,
                              const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
@@ -480,15 +619,15 @@ Status AggNode::EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val) {
                         const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
                         -> types::SharedColumnWrapper {
       DCHECK_EQ(children.size(), 0ULL);
-      return val->agg_cols[plan_cols_to_stored_map_[col.Index()]];
+      return agg_cols_[plan_cols_to_stored_map_[col.Index()]][group_id];
     });
 
     walker.OnAggregateExpression(
         [&](const plan::AggregateExpression& agg,
             const std::vector<StatusOr<types::SharedColumnWrapper>>& children)
             -> StatusOr<types::SharedColumnWrapper> {
-          DCHECK(agg.name() == uda_info.def->name());
-          DCHECK(children.size() == uda_info.def->update_arguments().size());
+          DCHECK(agg.name() == uda_state.def()->name());
+          DCHECK(children.size() == uda_state.def()->update_arguments().size());
           // collect the arguments.
           std::vector<const types::ColumnWrapper*> raw_children;
           raw_children.reserve(children.size());
@@ -497,16 +636,19 @@ Status AggNode::EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val) {
             raw_children.push_back(child.ValueOrDie().get());
           }
           PX_RETURN_IF_ERROR(
-              uda_info.def->ExecBatchUpdate(uda_info.uda.get(), nullptr /* ctx */, raw_children));
+              uda_state.def()->ExecBatchUpdate(uda, nullptr /* ctx */, raw_children));
           // Blocking aggregates don't produce results until all data is seen.
           return {};
         });
     PX_RETURN_IF_ERROR(walker.Walk(expr));
   }
 
-  for (auto& col : val->agg_cols) {
+  if (!agg_cols_.empty()) {
+    staged_rows_ -= static_cast<int64_t>(agg_cols_[0][group_id]->Size());
+  }
+  for (auto& group_cols : agg_cols_) {
     // Clear the values, so we don't aggregate them twice.
-    col->Clear();
+    group_cols[group_id]->Clear();
   }
   return Status::OK();
 }
@@ -549,13 +691,42 @@ Status AggNode::CreateColumnMapping() {
   return Status::OK();
 }
 
-AggHashValue* AggNode::CreateAggHashValue(ExecState* exec_state) {
-  auto* val = udas_pool_.Add(new AggHashValue);
-  PX_CHECK_OK(CreateUDAInfoValues(&(val->udas), exec_state));
-  for (const auto& dt : stored_cols_data_types_) {
-    val->agg_cols.emplace_back(types::ColumnWrapper::Make(dt, 0));
+Status AggNode::AddGroupState(ExecState*) {
+  for (const auto& [i, value] : Enumerate(plan_node_->values())) {
+    auto& uda_state = uda_states_[i];
+    PX_RETURN_IF_ERROR(InitUDA(uda_state.def(), *value, uda_state.Add()));
+  }
+  // The values of a group are only staged when this node computes the partial aggregates.
+  if (!plan_node_->partial_agg()) {
+    return Status::OK();
   }
-  return val;
+  for (const auto& [i, dt] : Enumerate(stored_cols_data_types_)) {
+    agg_cols_[i].emplace_back(types::ColumnWrapper::Make(dt, 0));
+  }
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<udf::UDA>> AggNode::CreateUDA(udf::UDADefinition* def,
+                                                       const plan::AggregateExpression& value) {
+  auto uda = def->Make();
+  PX_RETURN_IF_ERROR(InitUDA(def, value, uda.get()));
+  return uda;
+}
+
+Status AggNode::InitUDA(udf::UDADefinition* def, const plan::AggregateExpression& value,
+                        udf::UDA* uda) {
+  // We only init the UDAs if we're doing the partial agg ourself. If another node did the partial
+  // agg, then this node will deserialize and merge into these UDAs, so there's no need for init.
+  if (!plan_node_->partial_agg()) {
+    return Status::OK();
+  }
+  std::vector<std::shared_ptr<types::BaseValueType>> init_args;
+  for (const auto& arg : value.init_arguments()) {
+    init_args.push_back(arg.ToBaseValueType());
+  }
+  // We currently don't use FunctionContext in UDAs so continuing that tradition here, but at
+  // some point we probably want to change this.
+  return def->ExecInit(uda, nullptr, init_args);
 }
 
 Status AggNode::CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_state) {
@@ -564,19 +735,7 @@ Status AggNode::CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_s
 
   for (const auto& value : plan_node_->values()) {
     auto def = exec_state->GetUDADefinition(value->uda_id());
-    auto uda = def->Make();
-
-    // We only init the UDAs if we're doing the partial agg ourself. If another node did the partial
-    // agg, then this node will deserialize and merge into these UDAs, so there's no need for init.
-    if (plan_node_->partial_agg()) {
-      std::vector<std::shared_ptr<types::BaseValueType>> init_args;
-      for (const auto& arg : value->init_arguments()) {
-        init_args.push_back(arg.ToBaseValueType());
-      }
-      // We currently don't use FunctionContext in UDAs so continuing that tradition here, but at
-      // some point we probably want to change this.
-      PX_RETURN_IF_ERROR(def->ExecInit(uda.get(), nullptr, init_args));
-    }
+    PX_ASSIGN_OR_RETURN(auto uda, CreateUDA(def, *value));
     val->emplace_back(std::move(uda), def);
   }
   return Status::OK();
@@ -584,37 +743,37 @@ Status AggNode::CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_s
 
 Status AggNode::DeserializeAndMergeNoGroups(const RowBatch& rb) {
   for (int64_t row_idx = 0; row_idx < rb.num_rows(); row_idx++) {
-    PX_RETURN_IF_ERROR(DeserializeAndMergeRow(&udas_no_groups_, rb, row_idx, 0));
+    for (size_t uda_idx = 0; uda_idx < udas_no_groups_.size(); ++uda_idx) {
+      PX_RETURN_IF_ERROR(
+          DeserializeAndMergeValue(uda_idx, udas_no_groups_[uda_idx].uda.get(), rb, row_idx, 0));
+    }
   }
   return Status::OK();
 }
 
-Status AggNode::DeserializeAndMergeGrouped(const std::vector<GroupArgs>& group_args,
-                                           const RowBatch& rb) {
+Status AggNode::DeserializeAndMergeGrouped(const RowBatch& rb) {
   auto groups_size = static_cast<int64_t>(plan_node_->groups().size());
-  for (int64_t row_idx = 0; row_idx < rb.num_rows(); row_idx++) {
-    DCHECK(group_args[row_idx].av != nullptr);
-    PX_RETURN_IF_ERROR(
-        DeserializeAndMergeRow(&group_args[row_idx].av->udas, rb, row_idx, groups_size));
+  for (size_t uda_idx = 0; uda_idx < uda_states_.size(); ++uda_idx) {
+    const auto& udas = uda_states_[uda_idx];
+    for (int64_t i = 0; i < rb.num_selected_rows(); i++) {
+      PX_RETURN_IF_ERROR(DeserializeAndMergeValue(uda_idx, udas[group_ids_[i]], rb,
+                                                  rb.SelectedRow(i), groups_size));
+    }
   }
-
   return Status::OK();
 }
 
-Status AggNode::DeserializeAndMergeRow(std::vector<UDAInfo>* udas, const RowBatch& rb,
-                                       int64_t row_idx, int64_t groups_size) {
-  for (size_t uda_idx = 0; uda_idx < udas->size(); ++uda_idx) {
-    auto& deserial_uda_info = udas_for_deserialize_[uda_idx];
-    auto& merge_uda_info = (*udas)[uda_idx];
-    int64_t col_idx = groups_size + static_cast<int64_t>(uda_idx);
-    DCHECK_EQ(types::STRING, rb.desc().type(col_idx));
-    auto serialized =
-        types::GetValueFromArrowArray<types::STRING>(rb.ColumnAt(col_idx).get(), row_idx);
-    PX_RETURN_IF_ERROR(deserial_uda_info.def->Deserialize(deserial_uda_info.uda.get(),
-                                                          function_ctx_.get(), serialized));
-    PX_RETURN_IF_ERROR(merge_uda_info.def->Merge(merge_uda_info.uda.get(),
-                                                 deserial_uda_info.uda.get(), function_ctx_.get()));
-  }
+Status AggNode::DeserializeAndMergeValue(size_t uda_idx, udf::UDA* merge_uda, const RowBatch& rb,
+                                         int64_t row_idx, int64_t groups_size) {
+  auto& deserial_uda_info = udas_for_deserialize_[uda_idx];
+  int64_t col_idx = groups_size + static_cast<int64_t>(uda_idx);
+  DCHECK_EQ(types::STRING, rb.desc().type(col_idx));
+  auto serialized =
+      types::GetValueFromArrowArray<types::STRING>(rb.ColumnAt(col_idx).get(), row_idx);
+  PX_RETURN_IF_ERROR(deserial_uda_info.def->Deserialize(deserial_uda_info.uda.get(),
+                                                        function_ctx_.get(), serialized));
+  PX_RETURN_IF_ERROR(
+      deserial_uda_info.def->Merge(merge_uda, deserial_uda_info.uda.get(), function_ctx_.get()));
   return Status::OK();
 }
 
@@ -20,21 +20,23 @@
 #include <cstddef>
 #include <map>
 #include <memory>
+#include <new>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "src/carnot/exec/agg_hash_table.h"
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
-#include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/spill.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
 #include "src/carnot/udf/udf.h"
 #include "src/carnot/udf/udf_definition.h"
 #include "src/common/base/base.h"
-#include "src/common/memory/memory.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/hash_utils.h"
 #include "src/shared/types/types.h"
@@ -55,24 +57,66 @@ struct UDAInfo {
   udf::UDADefinition* def = nullptr;
 };
 
-struct AggHashValue {
-  std::vector<UDAInfo> udas;
-  std::vector<types::SharedColumnWrapper> agg_cols;
-};
+/**
+ * The UDA state of one aggregate expression for every group, indexed by group id. The UDAs are
+ * constructed in place, in chunks of kUDAsPerChunk, so adding a group doesn't allocate and the
+ * states of consecutive groups are adjacent in memory.
+ */
+class UDAStateArray {
+ public:
+  explicit UDAStateArray(udf::UDADefinition* def);
+  ~UDAStateArray() { Clear(); }
+
+  UDAStateArray(UDAStateArray&&) = default;
+  UDAStateArray& operator=(UDAStateArray&&) = default;
+
+  udf::UDADefinition* def() const { return def_; }
+  int64_t size() const { return static_cast<int64_t>(udas_.size()); }
+  udf::UDA* operator[](int64_t group_id) const { return udas_[group_id]; }
+
+  /**
+   * Constructs the state of the next group.
+   */
+  udf::UDA* Add();
+
+  /**
+   * Destroys the states of all groups. The first chunk is kept for the next groups.
+   */
+  void Clear();
+
+ private:
+  static constexpr int64_t kUDAsPerChunk = 1024;
 
-struct GroupArgs {
-  explicit GroupArgs(RowTuple* rt) : rt(rt), av(nullptr) {}
-  RowTuple* rt;
-  AggHashValue* av;
+  struct ChunkDeleter {
+    std::align_val_t alignment;
+    void operator()(char* chunk) const { ::operator delete(chunk, alignment); }
+  };
+  using Chunk = std::unique_ptr<char, ChunkDeleter>;
+
+  // Unowned pointer to the definition.
+  udf::UDADefinition* def_;
+  // The bytes between consecutive UDAs of a chunk.
+  size_t stride_;
+  std::vector<Chunk> chunks_;
+  // The UDAs, by group id. They point into chunks_.
+  std::vector<udf::UDA*> udas_;
 };
 
 class AggNode : public ProcessingNode {
-  using AggHashMap = AbslRowTupleHashMap<AggHashValue*>;
-
  public:
   AggNode() = default;
   virtual ~AggNode() = default;
 
+  bool SupportsSelection() const override;
+  bool SupportsDictionaryColumns() const override;
+
+  /**
+   * Limits the output of a grouped, non-windowed aggregate to the group_limit groups with the
+   * smallest key hashes. The execution graph sets this when the aggregate feeds a limit, which may
+   * output any group_limit of the groups.
+   */
+  void set_group_limit(int64_t group_limit) { group_limit_ = group_limit; }
+
  protected:
   Status AggregateGroupByNone(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status AggregateGroupByClause(ExecState* exec_state, const table_store::schema::RowBatch& rb);
@@ -86,7 +130,6 @@ class AggNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
-  AggHashMap agg_hash_map_;
   bool HasNoGroups() const { return plan_node_->groups().empty(); }
   // ReadyToEmitBatches returns true when the input stream has reached a point where output batches
   // can be emitted. In the windowed aggregate case, this happens whenever end of window (eow) is
@@ -98,15 +141,15 @@ class AggNode : public ProcessingNode {
   Status EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UDAInfo& uda_info,
                                           plan::AggregateExpression* expr,
                                           const table_store::schema::RowBatch& rb);
-  Status EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val);
+  Status EvaluateGroup(ExecState* exec_state, int64_t group_id);
   StatusOr<types::DataType> GetTypeOfDep(const plan::ScalarExpression& expr) const;
 
   Status DeserializeAndMergeNoGroups(const RowBatch& rb);
 
-  Status DeserializeAndMergeGrouped(const std::vector<GroupArgs>& group_args, const RowBatch& rb);
+  Status DeserializeAndMergeGrouped(const RowBatch& rb);
 
-  Status DeserializeAndMergeRow(std::vector<UDAInfo>* udas, const RowBatch& rb, int64_t row_idx,
-                                int64_t groups_size);
+  Status DeserializeAndMergeValue(size_t uda_idx, udf::UDA* merge_uda, const RowBatch& rb,
+                                  int64_t row_idx, int64_t groups_size);
 
   // Store information about aggregate node from the query planner.
   std::unique_ptr<plan::AggregateOperator> plan_node_;
@@ -133,32 +176,85 @@ class AggNode : public ProcessingNode {
   // 3. The data type of the stored colums, by the index they are stored at.
   std::vector<types::DataType> stored_cols_data_types_;
 
-  ObjectPool group_args_pool_{"group_args_pool"};
-  ObjectPool udas_pool_{"udas_pool"};
-
   std::vector<types::DataType> group_data_types_;
   std::vector<types::DataType> value_data_types_;
 
-  // We construct row-tuples in a batch, chunked by each column.
-  // This vector holds pointers to the row_tuples which are managed by the group_args_pool_.
+  // Maps the group-by keys to group ids. All per-group state below is indexed by group id.
+  std::unique_ptr<AggHashTable> agg_hash_table_;
+  // The group id of each row of the batch being consumed.
+  std::vector<int64_t> group_ids_;
+  // The UDA states, one array per aggregate expression.
+  std::vector<UDAStateArray> uda_states_;
+  // The values of the stored columns waiting to be aggregated, agg_cols_[stored_col][group_id].
+  // Unlike the UDA states, these are one column wrapper per group, since the UDAs are updated with
+  // a column of values of their group.
+  std::vector<std::vector<types::SharedColumnWrapper>> agg_cols_;
+  // The number of rows staged in agg_cols_.
+  int64_t staged_rows_ = 0;
 
-  std::vector<GroupArgs> group_args_chunk_;
+  // When the node holds too much of the query's memory budget, the groups are serialized and
+  // spilled to disk, partitioned by the group keys. Spilled rows hold the group columns followed by
+  // one serialized UDA state column per aggregate, as described by spill_descriptor_.
+  std::unique_ptr<table_store::schema::RowDescriptor> spill_descriptor_;
+  std::vector<int64_t> spill_key_cols_;
+  std::unique_ptr<SpillPartitions> spill_partitions_;
+  // The bytes of group state this node has reported to the ExecState. The node spills once the
+  // query is over its memory budget and these bytes are over the node's share of the budget.
+  int64_t reported_state_bytes_ = 0;
+  // Whether the groups can be spilled, which requires every UDA to support partial aggregation.
+  // The state of an aggregate that can't spill still counts towards the query's memory budget.
+  bool spillable_ = false;
+  bool added_spillable_node_ = false;
+  int64_t num_spills_ = 0;
+  int64_t spill_bytes_ = 0;
+  int64_t spill_partitions_used_ = 0;
+
+  // Which groups make the group limit only depends on their keys, so the partial aggregates of
+  // different agents agree with the aggregate that merges them, and a row whose key hash is above
+  // the smallest group_limit_ hashes seen so far can be dropped as soon as it arrives. 0 means
+  // there is no limit.
+  int64_t group_limit_ = 0;
+  // The smallest group_limit_ distinct key hashes seen so far.
+  std::set<uint64_t> limit_hashes_;
+  // The key hashes of the rows of the batch being consumed.
+  std::vector<uint64_t> row_hashes_;
+  // The groups chosen by SelectGroupsToEmit when there is a group limit.
+  std::vector<int64_t> emit_group_ids_;
   // END: Variables specific to GroupBy Agg.
 
   // Creates a mapping between plan cols and stored cols (see above comment).
   Status CreateColumnMapping();
 
-  Status ExtractRowTupleForBatch(const table_store::schema::RowBatch& rb);
   Status HashRowBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status EvaluatePartialAggregates(ExecState* exec_state, size_t num_records);
-  Status ResetGroupArgs();
-  Status ConvertAggHashMapToRowBatch(ExecState* exec_state,
-                                     table_store::schema::RowBatch* output_rb);
-
-  AggHashValue* CreateAggHashValue(ExecState* exec_state);
-  RowTuple* CreateGroupArgsRowTuple() {
-    return group_args_pool_.Add(new RowTuple(&group_data_types_));
-  }
+
+  bool HashUnderGroupLimit(uint64_t hash) const;
+  void AddGroupLimitHash(uint64_t hash);
+  // Returns the selected rows of rb whose key hashes are under the group limit.
+  std::shared_ptr<const std::vector<int64_t>> SelectRowsUnderGroupLimit(
+      const std::vector<const arrow::Array*>& key_cols, const table_store::schema::RowBatch& rb);
+  // Chooses the groups to write out, which are all of them unless there is a group limit, and
+  // returns how many there are.
+  int64_t SelectGroupsToEmit();
+  // Writes out the groups chosen by SelectGroupsToEmit and their finalized (or serialized if
+  // finalize is false) aggregates.
+  Status ConvertAggHashTableToRowBatch(ExecState* exec_state, bool finalize,
+                                       table_store::schema::RowBatch* output_rb);
+
+  // Estimates the bytes held by the groups and reports changes to the ExecState.
+  int64_t EstimateGroupStateBytes() const;
+  void UpdateGroupStateBytes(ExecState* exec_state);
+  // Serializes all of the groups to the spill partitions and clears them.
+  Status SpillGroups(ExecState* exec_state);
+  // Merges the spilled partitions back one at a time, and emits the groups of each.
+  Status EmitSpilledGroups(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status MergeSpilledBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+
+  // Creates the UDA states and value columns for a new group.
+  Status AddGroupState(ExecState* exec_state);
+  StatusOr<std::unique_ptr<udf::UDA>> CreateUDA(udf::UDADefinition* def,
+                                                const plan::AggregateExpression& value);
+  Status InitUDA(udf::UDADefinition* def, const plan::AggregateExpression& value, udf::UDA* uda);
 
   Status CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_state);
 };
@@ -19,6 +19,9 @@
 #include "src/carnot/exec/agg_node.h"
 
 #include <algorithm>
+#include <map>
+#include <numeric>
+#include <vector>
 
 #include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
@@ -84,6 +87,21 @@ class MinSumWithInitUDA : public udf::UDA {
   types::Int64Value sum_ = 0;
 };
 
+// Same as MinSumUDA, but without Serialize/Deserialize, so it doesn't support partial aggregation.
+class MinSumNoPartialUDA : public udf::UDA {
+ public:
+  void Update(udf::FunctionContext*, types::Int64Value arg1, types::Int64Value arg2) {
+    sum_ = sum_.val + std::min(arg1.val, arg2.val);
+  }
+  void Merge(udf::FunctionContext*, const MinSumNoPartialUDA& other) {
+    sum_ = sum_.val + other.sum_.val;
+  }
+  types::Int64Value Finalize(udf::FunctionContext*) { return sum_; }
+
+ protected:
+  types::Int64Value sum_ = 0;
+};
+
 constexpr char kBlockingNoGroupAgg[] = R"(
 op_type: AGGREGATE_OPERATOR
 agg_op {
@@ -137,6 +155,35 @@ agg_op {
   finalize_results: true
 })";
 
+constexpr char kBlockingSingleGroupNoPartialAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: false
+  values {
+    name: "minsum_no_partial"
+    args {
+      column {
+        node:0
+        index: 0
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  group_names: "g1"
+  value_names: "value1"
+  partial_agg: true
+  finalize_results: true
+})";
+
 constexpr char kBlockingMultipleGroupAgg[] = R"(
 op_type: AGGREGATE_OPERATOR
 agg_op {
@@ -485,17 +532,37 @@ std::unique_ptr<plan::Operator> PlanNodeFromPbtxt(const std::string& pbtxt) {
   return plan::AggregateOperator::FromProto(op_pb, 1);
 }
 
+// Returns the keys with the n smallest hashes, which are the groups an aggregate grouped by a
+// single int64 column keeps under a group limit of n.
+std::vector<types::Int64Value> SmallestHashKeys(const std::vector<types::Int64Value>& keys,
+                                                int64_t n) {
+  auto arr = types::ToArrow(keys, arrow::default_memory_pool());
+  std::vector<uint64_t> hashes;
+  HashKeyColumns({types::DataType::INT64}, {arr.get()}, arr->length(), &hashes);
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return hashes[a] < hashes[b]; });
+  std::vector<types::Int64Value> smallest;
+  for (int64_t i = 0; i < n; ++i) {
+    smallest.push_back(keys[order[i]]);
+  }
+  return smallest;
+}
+
 class AggNodeTest : public ::testing::Test {
  public:
   AggNodeTest() {
     func_registry_ = std::make_unique<udf::Registry>("test");
     EXPECT_TRUE(func_registry_->Register<MinSumUDA>("minsum").ok());
     EXPECT_TRUE(func_registry_->Register<MinSumWithInitUDA>("minsum_w_init").ok());
+    EXPECT_TRUE(func_registry_->Register<MinSumNoPartialUDA>("minsum_no_partial").ok());
 
     exec_state_ = MakeTestExecState(func_registry_.get());
     EXPECT_OK(exec_state_->AddUDA(0, "minsum",
                                   std::vector<types::DataType>({types::INT64, types::INT64})));
     EXPECT_OK(exec_state_->AddUDA(1, "minsum_w_init", {types::INT64, types::INT64, types::INT64}));
+    EXPECT_OK(exec_state_->AddUDA(2, "minsum_no_partial",
+                                  std::vector<types::DataType>({types::INT64, types::INT64})));
   }
 
  protected:
@@ -616,6 +683,167 @@ TEST_F(AggNodeTest, multiple_groups_blocking) {
       .Close();
 }
 
+TEST_F(AggNodeTest, multiple_groups_blocking_spilled) {
+  // Spill the groups after every batch.
+  exec_state_->set_memory_budget_bytes(1);
+  exec_state_->set_spill_dir(::testing::TempDir());
+
+  auto plan_node = PlanNodeFromPbtxt(kBlockingMultipleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 5, 1, 2})
+                       .AddColumn<types::Int64Value>({2, 1, 3, 1})
+                       .AddColumn<types::Int64Value>({2, 5, 3, 1})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({5, 1, 3, 3})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 3})
+                       .AddColumn<types::Int64Value>({1, 3, 3, 8})
+                       .get(),
+                   0, 0)
+      .ConsumeNextAnyOutput(RowBatchBuilder(input_rd, 2, true, true)
+                                .AddColumn<types::Int64Value>({1, 7})
+                                .AddColumn<types::Int64Value>({2, 7})
+                                .AddColumn<types::Int64Value>({4, 7})
+                                .get(),
+                            0)
+      .ExpectAllRowBatchesData(RowBatchBuilder(output_rd, 6, true, true)
+                                   .AddColumn<types::Int64Value>({1, 1, 2, 5, 3, 7})
+                                   .AddColumn<types::Int64Value>({2, 3, 1, 1, 3, 7})
+                                   .AddColumn<types::Int64Value>({6, 3, 1, 2, 6, 7})
+                                   .get())
+      .Close();
+
+  EXPECT_EQ(0, exec_state_->spillable_bytes());
+}
+
+TEST_F(AggNodeTest, single_group_blocking_no_partial_over_budget) {
+  // The UDA can't serialize its state, so the groups stay in memory even though the query is over
+  // its memory budget.
+  exec_state_->set_memory_budget_bytes(1);
+  exec_state_->set_spill_dir(::testing::TempDir());
+
+  auto plan_node = PlanNodeFromPbtxt(kBlockingSingleGroupNoPartialAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 1, 2, 2})
+                       .AddColumn<types::Int64Value>({2, 3, 3, 1})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, true, true)
+                       .AddColumn<types::Int64Value>({5, 6, 3, 4})
+                       .AddColumn<types::Int64Value>({1, 5, 3, 8})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 6, true, true)
+                          .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6})
+                          .AddColumn<types::Int64Value>({2, 3, 3, 4, 1, 5})
+                          .get(),
+                      false)
+      .Close();
+
+  EXPECT_EQ(0, exec_state_->spillable_bytes());
+}
+
+TEST_F(AggNodeTest, single_group_blocking_group_limit) {
+  auto plan_node = PlanNodeFromPbtxt(kBlockingSingleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  std::map<int64_t, int64_t> all_groups{{1, 2}, {2, 3}, {3, 3}, {4, 4}, {5, 1}, {6, 5}};
+  std::vector<types::Int64Value> keys;
+  std::vector<types::Int64Value> values;
+  for (const auto& key : SmallestHashKeys({1, 2, 3, 4, 5, 6}, 2)) {
+    keys.push_back(key);
+    values.push_back(all_groups[key.val]);
+  }
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  tester.node()->set_group_limit(2);
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 1, 2, 2})
+                       .AddColumn<types::Int64Value>({2, 3, 3, 1})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, true, true)
+                       .AddColumn<types::Int64Value>({5, 6, 3, 4})
+                       .AddColumn<types::Int64Value>({1, 5, 3, 8})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::Int64Value>(keys)
+                          .AddColumn<types::Int64Value>(values)
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, single_group_blocking_group_limit_spilled) {
+  // Spill the groups after every batch.
+  exec_state_->set_memory_budget_bytes(1);
+  exec_state_->set_spill_dir(::testing::TempDir());
+
+  auto plan_node = PlanNodeFromPbtxt(kBlockingSingleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  std::map<int64_t, int64_t> all_groups{{1, 3}, {2, 3}, {3, 3}, {4, 4}, {5, 1}, {6, 5}};
+  std::vector<types::Int64Value> keys;
+  std::vector<types::Int64Value> values;
+  for (const auto& key : SmallestHashKeys({1, 2, 3, 4, 5, 6}, 3)) {
+    keys.push_back(key);
+    values.push_back(all_groups[key.val]);
+  }
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  tester.node()->set_group_limit(3);
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 1, 2, 2})
+                       .AddColumn<types::Int64Value>({2, 3, 3, 1})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({5, 6, 3, 4})
+                       .AddColumn<types::Int64Value>({1, 5, 3, 8})
+                       .get(),
+                   0, 0)
+      .ConsumeNextAnyOutput(RowBatchBuilder(input_rd, 1, true, true)
+                                .AddColumn<types::Int64Value>({1})
+                                .AddColumn<types::Int64Value>({2})
+                                .get(),
+                            0)
+      .ExpectAllRowBatchesData(RowBatchBuilder(output_rd, 3, true, true)
+                                   .AddColumn<types::Int64Value>(keys)
+                                   .AddColumn<types::Int64Value>(values)
+                                   .get())
+      .Close();
+
+  EXPECT_EQ(0, exec_state_->spillable_bytes());
+}
+
 TEST_F(AggNodeTest, multiple_groups_with_string_blocking) {
   auto plan_node = PlanNodeFromPbtxt(kBlockingMultipleGroupAgg);
   RowDescriptor input_rd({types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
@@ -648,6 +876,40 @@ TEST_F(AggNodeTest, multiple_groups_with_string_blocking) {
       .Close();
 }
 
+TEST_F(AggNodeTest, multiple_groups_with_dictionary_blocking) {
+  // The string keys come dictionary encoded, with a different dictionary in each batch.
+  auto plan_node = PlanNodeFromPbtxt(kBlockingMultipleGroupAgg);
+  RowDescriptor input_rd({types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd(
+      {types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  EXPECT_TRUE(tester.node()->SupportsDictionaryColumns());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddDictionaryColumn({"abc", "def", "abc", "fgh"})
+                       .AddColumn<types::Int64Value>({2, 1, 3, 1})
+                       .AddColumn<types::Int64Value>({2, 5, 3, 1})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, true, true)
+                       .AddDictionaryColumn({"ijk", "abc", "abc", "def"})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 3})
+                       .AddColumn<types::Int64Value>({1, 3, 3, 8})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 6, true, true)
+                          .AddColumn<types::StringValue>({"abc", "def", "abc", "fgh", "ijk", "def"})
+                          .AddColumn<types::Int64Value>({2, 1, 3, 1, 1, 3})
+                          .AddColumn<types::Int64Value>({4, 1, 6, 1, 1, 3})
+                          .get(),
+                      false)
+      .Close();
+}
+
 TEST_F(AggNodeTest, no_groups_windowed) {
   auto plan_node = PlanNodeFromPbtxt(kWindowedNoGroupAgg);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
@@ -919,6 +1181,45 @@ TEST_F(AggNodeTest, single_group_partial_finalize) {
       .Close();
 }
 
+TEST_F(AggNodeTest, single_group_partial_finalize_group_limit) {
+  auto plan_node = PlanNodeFromPbtxt(kPartialSingleGroupAggFinalize);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::STRING});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  // The partial states of each group arrive in different batches, and all of them are merged for
+  // the groups that make the limit.
+  std::map<int64_t, int64_t> all_groups{{1, 6}, {2, 4}, {3, 3}, {4, 8}, {5, 1}, {6, 5}};
+  std::vector<types::Int64Value> keys;
+  std::vector<types::Int64Value> values;
+  for (const auto& key : SmallestHashKeys({1, 2, 3, 4, 5, 6}, 2)) {
+    keys.push_back(key);
+    values.push_back(all_groups[key.val]);
+  }
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+  tester.node()->set_group_limit(2);
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 1, 2, 2})
+                       .AddColumn<types::StringValue>({"2", "3", "3", "1"})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 5, true, true)
+                       .AddColumn<types::Int64Value>({5, 6, 3, 4, 1})
+                       .AddColumn<types::StringValue>({"1", "5", "3", "8", "1"})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::Int64Value>(keys)
+                          .AddColumn<types::Int64Value>(values)
+                          .get(),
+                      false)
+      .Close();
+}
+
 TEST_F(AggNodeTest, multiple_groups_partial) {
   auto plan_node = PlanNodeFromPbtxt(kPartialMultipleGroupAgg);
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
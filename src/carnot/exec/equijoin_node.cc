@@ -23,14 +23,16 @@
 #include <arrow/status.h>
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include <absl/strings/str_join.h>
 #include <absl/strings/substitute.h>
 
 #include "src/carnot/planpb/plan.pb.h"
-#include "src/carnot/udf/udf_wrapper.h"
 #include "src/common/base/base.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/type_utils.h"
@@ -68,6 +70,8 @@ Status EquijoinNode::InitImpl(const plan::Operator& plan_node) {
   } else {
     probe_table_ = EquijoinNode::JoinInputTable::kRightTable;
   }
+  // Spilled joins are done one partition at a time, which would break the time order.
+  spillable_ = !plan_node_->order_by_time();
 
   switch (plan_node_->type()) {
     case planpb::JoinOperator::INNER:
@@ -112,150 +116,115 @@ Status EquijoinNode::InitImpl(const plan::Operator& plan_node) {
     selected_spec.output_col_indices.emplace_back(i);
   }
 
+  std::vector<types::DataType> spilled_build_types = key_data_types_;
+  spilled_build_spec_ = build_spec_;
+  spilled_build_spec_.key_indices.clear();
+  spilled_build_spec_.input_col_indices.clear();
+  for (size_t i = 0; i < key_data_types_.size(); ++i) {
+    spilled_build_spec_.key_indices.emplace_back(i);
+  }
+  for (const auto& dt : build_spec_.input_col_types) {
+    spilled_build_spec_.input_col_indices.emplace_back(spilled_build_types.size());
+    spilled_build_types.emplace_back(dt);
+  }
+  spilled_build_descriptor_ = std::make_unique<RowDescriptor>(spilled_build_types);
+  hash_table_ = std::make_unique<JoinHashTable>(key_data_types_);
+
   return Status::OK();
 }
 
-Status EquijoinNode::InitializeColumnBuilders() {
+Status EquijoinNode::InitializeColumnBuilders(ExecState* exec_state) {
   for (size_t i = 0; i < output_descriptor_->size(); ++i) {
     column_builders_[i] =
-        MakeArrowBuilder(output_descriptor_->type(i), arrow::default_memory_pool());
+        MakeArrowBuilder(output_descriptor_->type(i), exec_state->exec_mem_pool());
     PX_RETURN_IF_ERROR(column_builders_[i]->Reserve(output_rows_per_batch_));
   }
   return Status::OK();
 }
 
-Status EquijoinNode::PrepareImpl(ExecState* /*exec_state*/) {
+Status EquijoinNode::PrepareImpl(ExecState* exec_state) {
   column_builders_.resize(output_descriptor_->size());
-  PX_RETURN_IF_ERROR(InitializeColumnBuilders());
-
-  return Status::OK();
-}
+  PX_RETURN_IF_ERROR(InitializeColumnBuilders(exec_state));
 
-Status EquijoinNode::OpenImpl(ExecState* /*exec_state*/) { return Status::OK(); }
-
-Status EquijoinNode::CloseImpl(ExecState* /*exec_state*/) {
-  join_keys_chunk_.clear();
-  build_buffer_.clear();
-  probed_keys_.clear();
-  key_values_pool_.Clear();
   return Status::OK();
 }
 
-template <types::DataType DT>
-void ExtractIntoRowTuples(std::vector<RowTuple*>* row_tuples, arrow::Array* input_col,
-                          int rt_col_idx) {
-  auto num_rows = input_col->length();
-  for (auto row_idx = 0; row_idx < num_rows; ++row_idx) {
-    ExtractIntoRowTuple<DT>((*row_tuples)[row_idx], input_col, rt_col_idx, row_idx);
+Status EquijoinNode::OpenImpl(ExecState* exec_state) {
+  if (spillable_) {
+    exec_state->AddSpillableNode();
+    added_spillable_node_ = true;
   }
+  return Status::OK();
 }
 
-Status EquijoinNode::ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb,
-                                             bool is_probe) {
-  // Reset the row tuples
-  for (auto& rt : join_keys_chunk_) {
-    if (rt == nullptr) {
-      rt = key_values_pool_.Add(new RowTuple(&key_data_types_));
-    } else {
-      rt->Reset();
-    }
-  }
-
-  // Grow the join_keys_chunk_ to be the size of the RowBatch.
-  size_t num_rows = rb.num_rows();
-  if (join_keys_chunk_.size() < num_rows) {
-    int prev_size = join_keys_chunk_.size();
-    join_keys_chunk_.reserve(num_rows);
-    for (size_t idx = prev_size; idx < num_rows; ++idx) {
-      auto tuple_ptr = key_values_pool_.Add(new RowTuple(&key_data_types_));
-      join_keys_chunk_.emplace_back(tuple_ptr);
-    }
-  }
-
-  const TableSpec& spec = is_probe ? probe_spec_ : build_spec_;
-
-  // Scan through all the group args in column order and extract the entire column.
-  for (size_t tuple_col_idx = 0; tuple_col_idx < spec.key_indices.size(); ++tuple_col_idx) {
-    auto input_col_idx = spec.key_indices[tuple_col_idx];
-    auto dt = key_data_types_[tuple_col_idx];
-    auto col = rb.ColumnAt(input_col_idx).get();
-
-#define TYPE_CASE(_dt_) ExtractIntoRowTuples<_dt_>(&join_keys_chunk_, col, tuple_col_idx);
-    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
+Status EquijoinNode::CloseImpl(ExecState* exec_state) {
+  ResetBuildState();
+  build_spill_.reset();
+  probe_spill_.reset();
+  TrackStateBytes(exec_state, -state_bytes_);
+  stats()->AddExtraMetric("spill_bytes", spill_bytes_);
+  stats()->AddExtraMetric("spill_partitions", spill_partitions_);
+  stats()->AddExtraMetric("bloom_filtered_rows", hash_table_->bloom_filtered_rows());
+  if (added_spillable_node_) {
+    exec_state->RemoveSpillableNode();
+    added_spillable_node_ = false;
   }
-
   return Status::OK();
 }
 
-std::vector<types::SharedColumnWrapper>* CreateWrapper(ObjectPool* pool,
-                                                       const std::vector<types::DataType>& types) {
-  auto ptr = pool->Add(new std::vector<types::SharedColumnWrapper>(types.size()));
-  for (size_t col_idx = 0; col_idx < types.size(); ++col_idx) {
-    (*ptr)[col_idx] = types::ColumnWrapper::Make(types[col_idx], 0);
-  }
-  return ptr;
+void EquijoinNode::TrackStateBytes(ExecState* exec_state, int64_t delta) {
+  state_bytes_ += delta;
+  exec_state->UpdateSpillableBytes(delta);
 }
 
-Status EquijoinNode::HashRowBatch(const table_store::schema::RowBatch& rb) {
-  if (rb.num_rows() > static_cast<int64_t>(build_wrappers_chunk_.size())) {
-    build_wrappers_chunk_.resize(rb.num_rows());
-  }
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    if (build_wrappers_chunk_[row_idx] == nullptr) {
-      build_wrappers_chunk_[row_idx] =
-          CreateWrapper(&column_values_pool_, build_spec_.input_col_types);
-    }
+void EquijoinNode::AddBuildBatch(const table_store::schema::RowBatch& rb) {
+  std::vector<std::shared_ptr<arrow::Array>> key_cols;
+  for (auto col_idx : build_batches_spec_->key_indices) {
+    key_cols.push_back(rb.ColumnAt(col_idx));
   }
+  hash_table_->AddBatch(std::move(key_cols), rb.num_rows());
+  build_batches_.push_back(rb);
+}
 
-  // Make sure the map has constructed the necessary column wrappers for all of the tuples.
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto& rt = join_keys_chunk_[row_idx];
-    auto& current = build_buffer_[rt];
-    auto wrappers_ptr = current != nullptr ? current : build_wrappers_chunk_[row_idx];
-
-    // Now extract the values into the corresponding column wrappers.
-    for (size_t i = 0; i < build_spec_.input_col_indices.size(); ++i) {
-      const auto& rb_col_idx = build_spec_.input_col_indices[i];
-      auto arr = rb.ColumnAt(rb_col_idx).get();
-      const auto& dt = build_spec_.input_col_types[i];
-
-#define TYPE_CASE(_dt_) \
-  types::ExtractValueToColumnWrapper<_dt_>(wrappers_ptr->at(i).get(), arr, row_idx);
-      PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
-#undef TYPE_CASE
-    }
-    // Keep track of the number of rows that the build buffer matches for each key.
-    build_buffer_rows_[rt]++;
-
-    if (current == nullptr) {
-      std::swap(build_wrappers_chunk_[row_idx], current);
-      // Reset the new tuples that we added
-      join_keys_chunk_[row_idx] = nullptr;
-    }
+template <types::DataType DT>
+Status AppendValueOrDefault(arrow::ArrayBuilder* output_builder, const arrow::Array* input_col,
+                            int64_t row_idx) {
+  using ArrowBuilderType = typename types::DataTypeTraits<DT>::arrow_builder_type;
+  auto* typed_builder = static_cast<ArrowBuilderType*>(output_builder);
+  bool is_default = input_col == nullptr || row_idx == JoinHashTable::kNoMatch;
+  if constexpr (DT == types::DataType::STRING) {
+    auto val =
+        is_default ? std::string_view() : types::GetStringViewFromArrowArray(input_col, row_idx);
+    PX_RETURN_IF_ERROR(typed_builder->Append(val.data(), static_cast<int32_t>(val.size())));
+  } else {
+    using NativeType = typename types::DataTypeTraits<DT>::native_type;
+    NativeType val =
+        is_default ? NativeType() : types::GetValueFromArrowArray<DT>(input_col, row_idx);
+    typed_builder->UnsafeAppend(val);
   }
-
   return Status::OK();
 }
 
 template <types::DataType DT>
-Status AppendValuesFromWrapper(arrow::ArrayBuilder* output_builder,
-                               types::SharedColumnWrapper input_wrapper, size_t start_idx,
-                               size_t num_rows) {
-  using ValueType = typename types::DataTypeTraits<DT>::value_type;
-  for (size_t row_idx = start_idx; row_idx < start_idx + num_rows; ++row_idx) {
-    PX_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(
-        output_builder, udf::UnWrap(input_wrapper->Get<ValueType>(row_idx))));
+Status GatherBuildColumn(arrow::ArrayBuilder* output_builder,
+                         const std::vector<const arrow::Array*>& batch_cols,
+                         const JoinHashTable& hash_table, const std::vector<int64_t>& entries) {
+  for (auto entry : entries) {
+    if (entry == JoinHashTable::kNoMatch) {
+      PX_RETURN_IF_ERROR(AppendValueOrDefault<DT>(output_builder, nullptr, 0));
+      continue;
+    }
+    const auto& ref = hash_table.row(entry);
+    PX_RETURN_IF_ERROR(AppendValueOrDefault<DT>(output_builder, batch_cols[ref.batch], ref.row));
   }
   return Status::OK();
 }
 
 template <types::DataType DT>
-Status AppendColumnDefaultValue(arrow::ArrayBuilder* output_builder, size_t num_times) {
-  using ValueType = typename types::DataTypeTraits<DT>::value_type;
-  ValueType zeroval;
-  for (size_t i = 0; i < num_times; ++i) {
-    PX_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(output_builder, udf::UnWrap(zeroval)));
+Status GatherProbeColumn(arrow::ArrayBuilder* output_builder, const arrow::Array* input_col,
+                         const std::vector<int64_t>& rows) {
+  for (auto row_idx : rows) {
+    PX_RETURN_IF_ERROR(AppendValueOrDefault<DT>(output_builder, input_col, row_idx));
   }
   return Status::OK();
 }
@@ -272,78 +241,53 @@ Status EquijoinNode::NextOutputBatch(ExecState* exec_state) {
   }
   pending_output_batch_.swap(output_batch);
 
-  return InitializeColumnBuilders();
+  return InitializeColumnBuilders(exec_state);
 }
 
-Status EquijoinNode::FlushChunkedRows(ExecState* exec_state) {
+Status EquijoinNode::GatherOutputRows(const table_store::schema::RowBatch* probe_rb) {
+  std::vector<const arrow::Array*> batch_cols(build_batches_.size());
   for (size_t col = 0; col < build_spec_.output_col_indices.size(); ++col) {
-    for (const auto& chunk : chunks_) {
-      auto output_idx = build_spec_.output_col_indices[col];
-      auto builder = column_builders_.at(output_idx).get();
+    auto output_idx = build_spec_.output_col_indices[col];
+    auto builder = column_builders_[output_idx].get();
+    auto src_idx = build_batches_spec_->input_col_indices[col];
+    for (size_t batch = 0; batch < build_batches_.size(); ++batch) {
+      batch_cols[batch] = build_batches_[batch].ColumnAt(src_idx).get();
+    }
 
-      if (chunk.wrappers_ptr == nullptr) {
-#define TYPE_CASE(_dt_) PX_RETURN_IF_ERROR(AppendColumnDefaultValue<_dt_>(builder, chunk.num_rows))
-        PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
-#undef TYPE_CASE
-      } else {
 #define TYPE_CASE(_dt_)                                                                  \
-  PX_RETURN_IF_ERROR(AppendValuesFromWrapper<_dt_>(builder, chunk.wrappers_ptr->at(col), \
-                                                   chunk.bb_row_idx, chunk.num_rows))
-        PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
+  PX_RETURN_IF_ERROR(GatherBuildColumn<_dt_>(builder, batch_cols, *hash_table_,          \
+                                             output_build_entries_))
+    PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
 #undef TYPE_CASE
-      }
-    }
   }
 
   for (size_t col = 0; col < probe_spec_.output_col_indices.size(); ++col) {
-    for (const auto& chunk : chunks_) {
-      auto output_idx = probe_spec_.output_col_indices[col];
-      auto builder = column_builders_.at(output_idx).get();
+    auto output_idx = probe_spec_.output_col_indices[col];
+    auto builder = column_builders_[output_idx].get();
+    auto src_idx = probe_spec_.input_col_indices[col];
+    auto input_col = probe_rb == nullptr ? nullptr : probe_rb->ColumnAt(src_idx).get();
 
-      if (chunk.rb == nullptr) {
-#define TYPE_CASE(_dt_) PX_RETURN_IF_ERROR(AppendColumnDefaultValue<_dt_>(builder, chunk.num_rows))
-        PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
-#undef TYPE_CASE
-      } else {
-        auto src_idx = probe_spec_.input_col_indices[col];
-        auto builder = column_builders_[output_idx].get();
-        auto input_col = chunk.rb->ColumnAt(src_idx).get();
-
-#define TYPE_CASE(_dt_)                                                             \
-  PX_RETURN_IF_ERROR(table_store::schema::CopyValueRepeated<_dt_>(                  \
-      builder, types::GetValueFromArrowArray<_dt_>(input_col, chunk.probe_row_idx), \
-      chunk.num_rows))
-        PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
+#define TYPE_CASE(_dt_) \
+  PX_RETURN_IF_ERROR(GatherProbeColumn<_dt_>(builder, input_col, output_probe_rows_))
+    PX_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
 #undef TYPE_CASE
-      }
-    }
   }
-  std::vector<EquijoinNode::OutputChunk> new_chunks(0);
-  std::swap(chunks_, new_chunks);
-  queued_rows_ = 0;
-  return NextOutputBatch(exec_state);
+
+  output_probe_rows_.clear();
+  output_build_entries_.clear();
+  return Status::OK();
 }
 
-Status EquijoinNode::MatchBuildValuesAndFlush(ExecState* exec_state,
-                                              std::vector<types::SharedColumnWrapper>* wrapper,
-                                              std::shared_ptr<RowBatch> probe_rb,
-                                              int64_t probe_rb_row, int64_t matching_bb_rows) {
-  int64_t bb_rows_left = matching_bb_rows;
-
-  while (bb_rows_left > 0) {
-    auto available = output_rows_per_batch_ - (column_builders_[0]->length() + queued_rows_);
-    auto chunk_rows = std::min(bb_rows_left, available);
-    OutputChunk c{probe_rb, wrapper, chunk_rows, matching_bb_rows - bb_rows_left, probe_rb_row};
-    chunks_.emplace_back(c);
-    queued_rows_ += chunk_rows;
-    bb_rows_left -= chunk_rows;
-
-    if (queued_rows_ == output_rows_per_batch_) {
-      PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
-    }
+Status EquijoinNode::AddOutputRow(ExecState* exec_state, const RowBatch* probe_rb,
+                                  int64_t probe_row, int64_t build_entry) {
+  output_probe_rows_.push_back(probe_row);
+  output_build_entries_.push_back(build_entry);
+  if (column_builders_[0]->length() + static_cast<int64_t>(output_probe_rows_.size()) <
+      output_rows_per_batch_) {
+    return Status::OK();
   }
-
-  return Status::OK();
+  PX_RETURN_IF_ERROR(GatherOutputRows(probe_rb));
+  return NextOutputBatch(exec_state);
 }
 
 Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::RowBatch& rb) {
@@ -351,61 +295,45 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
     probe_eos_ = true;
   }
 
-  PX_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, true));
-
-  if (rb.num_rows() > static_cast<int64_t>(probe_wrappers_chunk_.size())) {
-    probe_wrappers_chunk_.resize(rb.num_rows());
-  }
-
-  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    auto it = build_buffer_.find(join_keys_chunk_[row_idx]);
-    if (it != build_buffer_.end()) {
-      probe_wrappers_chunk_[row_idx] = it->second;
-      probed_keys_.insert(it->first);
-    } else {
-      probe_wrappers_chunk_[row_idx] = nullptr;
-    }
+  std::vector<const arrow::Array*> key_cols;
+  for (auto col_idx : probe_spec_.key_indices) {
+    key_cols.push_back(rb.ColumnAt(col_idx).get());
   }
-
-  auto rb_ptr = std::make_shared<RowBatch>(rb);
+  hash_table_->ProbeBatch(key_cols, rb.num_rows(), &probe_matches_);
 
   for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
-    if (queued_rows_ >= output_rows_per_batch_ - column_builders_[0]->length()) {
-      PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
-    }
-
-    if (probe_wrappers_chunk_[row_idx] == nullptr) {
+    auto entry = probe_matches_[row_idx];
+    if (entry == JoinHashTable::kNoMatch) {
       if (probe_spec_.emit_unmatched_rows) {
-        OutputChunk c{rb_ptr, nullptr, 1, 0, row_idx};
-        chunks_.emplace_back(c);
-        queued_rows_ += 1;
+        PX_RETURN_IF_ERROR(AddOutputRow(exec_state, &rb, row_idx, JoinHashTable::kNoMatch));
       }
       continue;
     }
-
-    PX_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, probe_wrappers_chunk_[row_idx], rb_ptr,
-                                                row_idx,
-                                                build_buffer_rows_[join_keys_chunk_[row_idx]]));
+    hash_table_->MarkMatched(entry);
+    for (; entry != JoinHashTable::kNoMatch; entry = hash_table_->next_match(entry)) {
+      PX_RETURN_IF_ERROR(AddOutputRow(exec_state, &rb, row_idx, entry));
+    }
   }
+  // The selected rows refer to this batch, so copy them out before returning.
+  PX_RETURN_IF_ERROR(GatherOutputRows(&rb));
 
-  if (probe_eos_ && queued_rows_ > 0) {
-    PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
+  if (probe_eos_ && column_builders_[0]->length() > 0) {
+    PX_RETURN_IF_ERROR(NextOutputBatch(exec_state));
   }
 
   return Status::OK();
 }
 
 Status EquijoinNode::EmitUnmatchedBuildRows(ExecState* exec_state) {
-  for (auto it = build_buffer_.begin(); it != build_buffer_.end(); ++it) {
-    if (probed_keys_.find(it->first) != probed_keys_.end()) {
-      continue;
-    }
-    PX_RETURN_IF_ERROR(MatchBuildValuesAndFlush(exec_state, it->second, nullptr, 0,
-                                                build_buffer_rows_[it->first]));
+  std::vector<int64_t> unmatched_entries;
+  hash_table_->UnmatchedEntries(&unmatched_entries);
+  for (auto entry : unmatched_entries) {
+    PX_RETURN_IF_ERROR(AddOutputRow(exec_state, nullptr, JoinHashTable::kNoMatch, entry));
   }
+  PX_RETURN_IF_ERROR(GatherOutputRows(nullptr));
 
-  if (queued_rows_ > 0) {
-    PX_RETURN_IF_ERROR(FlushChunkedRows(exec_state));
+  if (column_builders_[0]->length() > 0) {
+    PX_RETURN_IF_ERROR(NextOutputBatch(exec_state));
   }
   return Status::OK();
 }
@@ -416,12 +344,21 @@ Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
     build_eos_ = true;
   }
 
-  PX_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
-  PX_RETURN_IF_ERROR(HashRowBatch(rb));
+  if (build_spill_ != nullptr) {
+    return SpillBuildBatch(rb);
+  }
+
+  AddBuildBatch(rb);
+  TrackStateBytes(exec_state, rb.NumBytes());
+  if (!build_eos_ && ShouldSpill(exec_state)) {
+    return SpillJoinState(exec_state);
+  }
 
   if (build_eos_) {
+    hash_table_->Build();
     while (probe_batches_.size()) {
       PX_RETURN_IF_ERROR(DoProbe(exec_state, probe_batches_.front()));
+      TrackStateBytes(exec_state, -probe_batches_.front().NumBytes());
       probe_batches_.pop();
     }
   }
@@ -430,13 +367,85 @@ Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
 
 Status EquijoinNode::ConsumeProbeBatch(ExecState* exec_state,
                                        const table_store::schema::RowBatch& rb) {
+  if (probe_spill_ != nullptr) {
+    if (rb.eos()) {
+      probe_eos_ = true;
+    }
+    return probe_spill_->Append(rb, probe_spec_.key_indices);
+  }
   if (!build_eos_) {
     probe_batches_.push(rb);
+    TrackStateBytes(exec_state, rb.NumBytes());
+    if (ShouldSpill(exec_state)) {
+      return SpillJoinState(exec_state);
+    }
     return Status::OK();
   }
   return DoProbe(exec_state, rb);
 }
 
+void EquijoinNode::ResetBuildState() {
+  hash_table_->Clear();
+  build_batches_.clear();
+  probe_matches_.clear();
+}
+
+bool EquijoinNode::ShouldSpill(ExecState* exec_state) const {
+  return spillable_ && exec_state->ShouldSpill(state_bytes_);
+}
+
+Status EquijoinNode::SpillJoinState(ExecState* exec_state) {
+  build_spill_ =
+      std::make_unique<SpillPartitions>(exec_state->spill_dir(), exec_state->exec_mem_pool());
+  probe_spill_ =
+      std::make_unique<SpillPartitions>(exec_state->spill_dir(), exec_state->exec_mem_pool());
+  for (const auto& rb : build_batches_) {
+    PX_RETURN_IF_ERROR(SpillBuildBatch(rb));
+  }
+  ResetBuildState();
+  while (probe_batches_.size()) {
+    PX_RETURN_IF_ERROR(probe_spill_->Append(probe_batches_.front(), probe_spec_.key_indices));
+    probe_batches_.pop();
+  }
+  TrackStateBytes(exec_state, -state_bytes_);
+  return Status::OK();
+}
+
+Status EquijoinNode::SpillBuildBatch(const table_store::schema::RowBatch& rb) {
+  RowBatch spilled_rb(*spilled_build_descriptor_, rb.num_rows());
+  for (auto col_idx : build_spec_.key_indices) {
+    PX_RETURN_IF_ERROR(spilled_rb.AddColumn(rb.ColumnAt(col_idx)));
+  }
+  for (auto col_idx : build_spec_.input_col_indices) {
+    PX_RETURN_IF_ERROR(spilled_rb.AddColumn(rb.ColumnAt(col_idx)));
+  }
+  return build_spill_->Append(spilled_rb, spilled_build_spec_.key_indices);
+}
+
+Status EquijoinNode::JoinSpilledPartitions(ExecState* exec_state) {
+  build_batches_spec_ = &spilled_build_spec_;
+  for (int64_t partition = 0; partition < build_spill_->num_partitions(); ++partition) {
+    ResetBuildState();
+    PX_RETURN_IF_ERROR(build_spill_->ForEachBatch(partition, [&](const RowBatch& rb) {
+      AddBuildBatch(rb);
+      return Status::OK();
+    }));
+    hash_table_->Build();
+    PX_RETURN_IF_ERROR(probe_spill_->ForEachBatch(
+        partition, [&](const RowBatch& rb) { return DoProbe(exec_state, rb); }));
+    if (build_spec_.emit_unmatched_rows) {
+      PX_RETURN_IF_ERROR(EmitUnmatchedBuildRows(exec_state));
+    }
+  }
+  build_batches_spec_ = &build_spec_;
+  spill_bytes_ += build_spill_->bytes_written() + probe_spill_->bytes_written();
+  spill_partitions_ += build_spill_->num_partitions();
+  build_spill_.reset();
+  probe_spill_.reset();
+  ResetBuildState();
+  return Status::OK();
+}
+
 Status EquijoinNode::ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                                      size_t parent_index) {
   if (IsProbeTable(parent_index)) {
@@ -448,7 +457,9 @@ Status EquijoinNode::ConsumeNextImpl(ExecState* exec_state, const table_store::s
   }
 
   if (build_eos_ && probe_eos_) {
-    if (build_spec_.emit_unmatched_rows) {
+    if (build_spill_ != nullptr) {
+      PX_RETURN_IF_ERROR(JoinSpilledPartitions(exec_state));
+    } else if (build_spec_.emit_unmatched_rows) {
       PX_RETURN_IF_ERROR(EmitUnmatchedBuildRows(exec_state));
     }
 
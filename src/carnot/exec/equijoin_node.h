@@ -26,16 +26,13 @@
 #include <utility>
 #include <vector>
 
-#include <absl/container/flat_hash_map.h>
-
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
-#include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/join_hash_table.h"
+#include "src/carnot/exec/spill.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
-#include "src/common/memory/memory.h"
-#include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/types.h"
 #include "src/table_store/table_store.h"
 
@@ -64,6 +61,10 @@ class EquijoinNode : public ProcessingNode {
   EquijoinNode() = default;
   virtual ~EquijoinNode() = default;
 
+  // Dictionary encoded keys are hashed a distinct value at a time, and all columns are copied out
+  // of their dictionaries when the output rows are gathered.
+  bool SupportsDictionaryColumns() const override { return true; }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -74,22 +75,34 @@ class EquijoinNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
-  Status InitializeColumnBuilders();
+  Status InitializeColumnBuilders(ExecState* exec_state);
   bool IsProbeTable(size_t parent_index);
-  Status FlushChunkedRows(ExecState* exec_state);
-  Status ExtractJoinKeysForBatch(const table_store::schema::RowBatch& rb, bool is_probe);
-  Status HashRowBatch(const table_store::schema::RowBatch& rb);
+  // Adds a build batch, laid out as build_batches_spec_, to the hash table.
+  void AddBuildBatch(const table_store::schema::RowBatch& rb);
 
   Status DoProbe(ExecState* exec_state, const table_store::schema::RowBatch& rb);
-  Status MatchBuildValuesAndFlush(ExecState* exec_state,
-                                  std::vector<types::SharedColumnWrapper>* wrapper,
-                                  std::shared_ptr<table_store::schema::RowBatch> probe_rb,
-                                  int64_t probe_rb_row_idx, int64_t matching_bb_rows);
+  // Selects a row for the output. Either side can be JoinHashTable::kNoMatch, in which case that
+  // side's columns get default values.
+  Status AddOutputRow(ExecState* exec_state, const table_store::schema::RowBatch* probe_rb,
+                      int64_t probe_row, int64_t build_entry);
+  // Copies the selected output rows into the column builders.
+  Status GatherOutputRows(const table_store::schema::RowBatch* probe_rb);
   Status EmitUnmatchedBuildRows(ExecState* exec_state);
   Status NextOutputBatch(ExecState* exec_state);
   Status ConsumeBuildBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status ConsumeProbeBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
 
+  // Adjusts the bytes of build side and buffered probe state reported to the ExecState.
+  void TrackStateBytes(ExecState* exec_state, int64_t delta);
+  // Whether this join holds more than its share of the query's memory budget, and can spill.
+  bool ShouldSpill(ExecState* exec_state) const;
+  // Moves the build side and the buffered probe batches to the spill partitions. All input
+  // received after this is spilled too, and the join is done one partition at a time.
+  Status SpillJoinState(ExecState* exec_state);
+  Status SpillBuildBatch(const table_store::schema::RowBatch& rb);
+  Status JoinSpilledPartitions(ExecState* exec_state);
+  void ResetBuildState();
+
   bool build_eos_ = false;
   bool probe_eos_ = false;
   // Note whether the left or the right table is the probe table.
@@ -111,45 +124,39 @@ class EquijoinNode : public ProcessingNode {
   // probe_spec_: {key_indices: [0, 2], input_col_indices: [1, 2], output_col_indices: [3, 1]}
   // produces table [output_col_0, output_col_1(key_B_1), output_col_2(key_A_0), output_col_3]
 
-  // This struct represents a chunk of output rows that are queued to be written
-  // to the column builders.
-  struct OutputChunk {
-    std::shared_ptr<table_store::schema::RowBatch> rb;
-    std::vector<types::SharedColumnWrapper>* wrappers_ptr;
-    int64_t num_rows;
-    int64_t bb_row_idx;
-    int64_t probe_row_idx;
-  };
-
-  int64_t queued_rows_ = 0;
-  std::vector<OutputChunk> chunks_;
-
   // Memory/column building members
   // If the build stage isn't complete, we need to buffer the probe batches.
   std::queue<table_store::schema::RowBatch> probe_batches_;
   // Column builders will flush a batch once they hit output_rows_per_batch_ rows.
   std::vector<std::unique_ptr<arrow::ArrayBuilder>> column_builders_;
-  // Manages the RowTuples containing the keys for the join.
-  ObjectPool key_values_pool_{"equijoin_kv_pool"};
-  ObjectPool column_values_pool_{"equijoin_col_vals_pool"};
-
-  // Chunk of data to use when extracting join keys.
-  std::vector<RowTuple*> join_keys_chunk_;
-  // Chunk of data to use when performing the build stage of the join.
-  std::vector<std::vector<types::SharedColumnWrapper>*> build_wrappers_chunk_;
-
-  // Chunk of data to use when performing the probe stage of the join.
-  // This will store build table data from `build_buffer_`.
-  std::vector<std::vector<types::SharedColumnWrapper>*> probe_wrappers_chunk_;
-  AbslRowTupleHashMap<std::vector<types::SharedColumnWrapper>*> build_buffer_;
-  // Store the number of rows that match a given set of keys for the build buffer.
-  // This is necessary to store in addition to the values in `build_buffer_` in
-  // the event that no columns from the build side are emitted.
-  AbslRowTupleHashMap<int64_t> build_buffer_rows_;
-
-  // For joins where the build_buffer_ needs to emit any non-probed rows at the end of the join,
-  // keep track of which ones they were.
-  AbslRowTupleHashSet probed_keys_;
+
+  // The build batches, which the hash table and the selected output rows refer to.
+  std::vector<table_store::schema::RowBatch> build_batches_;
+  // The layout of build_batches_: build_spec_, or spilled_build_spec_ when joining spilled
+  // partitions.
+  const TableSpec* build_batches_spec_ = &build_spec_;
+  std::unique_ptr<JoinHashTable> hash_table_;
+
+  // The first matching build entry of every row of the current probe batch.
+  std::vector<int64_t> probe_matches_;
+  // The output rows that are selected but not yet copied into the column builders, as the row of
+  // the probe batch and the build entry of each.
+  std::vector<int64_t> output_probe_rows_;
+  std::vector<int64_t> output_build_entries_;
+
+  // The layout of spilled build rows: the key columns followed by the build input columns.
+  std::unique_ptr<table_store::schema::RowDescriptor> spilled_build_descriptor_;
+  TableSpec spilled_build_spec_;
+  // Time ordered joins never spill, since spilled joins emit their rows partition by partition.
+  bool spillable_ = false;
+  bool added_spillable_node_ = false;
+  // Non-null once the join has spilled.
+  std::unique_ptr<SpillPartitions> build_spill_;
+  std::unique_ptr<SpillPartitions> probe_spill_;
+  // The bytes of build side and buffered probe state reported to the ExecState.
+  int64_t state_bytes_ = 0;
+  int64_t spill_bytes_ = 0;
+  int64_t spill_partitions_ = 0;
 
   // Handle on the most recent RowBatch (in case it's the final one).
   std::unique_ptr<table_store::schema::RowBatch> pending_output_batch_;
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <absl/strings/substitute.h>
+#include <google/protobuf/text_format.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/equijoin_node.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/planpb/test_proto.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+
+using px::carnot::exec::EquijoinNode;
+using px::carnot::exec::ExecState;
+using px::carnot::exec::FakePlanNode;
+using px::carnot::exec::MockExecNode;
+using px::carnot::exec::MockMetricsStubGenerator;
+using px::carnot::exec::MockResultSinkStubGenerator;
+using px::carnot::exec::MockTraceStubGenerator;
+using px::table_store::schema::RowBatch;
+using px::table_store::schema::RowDescriptor;
+using px::types::DataType;
+using px::types::Int64Value;
+
+// Inner join of [key, build_val] (left, build) with [key, probe_val] (right, probe) on key.
+constexpr char kInnerJoinOnKey[] = R"(
+  type: INNER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 0
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 0
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 1
+  }
+  column_names: "build_val"
+  column_names: "key"
+  column_names: "probe_val"
+  rows_per_batch: 8192
+)";
+
+constexpr int64_t kRowsPerBatch = 16 * 1024;
+
+enum class KeyDistribution {
+  // Probe keys are uniform over twice the build keys, so half of them match.
+  kUniform,
+  // Probe keys are concentrated on a few hot build keys, as with a few busy services.
+  kSkewed,
+};
+
+std::vector<RowBatch> MakeBatches(const std::vector<Int64Value>& keys) {
+  RowDescriptor rd({DataType::INT64, DataType::INT64});
+  std::vector<RowBatch> batches;
+  for (size_t start = 0; start < keys.size(); start += kRowsPerBatch) {
+    size_t end = std::min(keys.size(), start + kRowsPerBatch);
+    std::vector<Int64Value> batch_keys(keys.begin() + start, keys.begin() + end);
+    std::vector<Int64Value> vals(batch_keys.size());
+    for (size_t i = 0; i < vals.size(); ++i) {
+      vals[i] = start + i;
+    }
+    RowBatch rb(rd, batch_keys.size());
+    PX_CHECK_OK(rb.AddColumn(px::types::ToArrow(batch_keys, arrow::default_memory_pool())));
+    PX_CHECK_OK(rb.AddColumn(px::types::ToArrow(vals, arrow::default_memory_pool())));
+    rb.set_eow(end == keys.size());
+    rb.set_eos(end == keys.size());
+    batches.push_back(rb);
+  }
+  return batches;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+void BM_EquijoinNode(benchmark::State& state, KeyDistribution dist) {
+  int64_t num_build_rows = state.range(0);
+  int64_t num_probe_rows = 4 * num_build_rows;
+
+  std::vector<Int64Value> build_keys;
+  for (int64_t i = 0; i < num_build_rows; ++i) {
+    build_keys.emplace_back(i);
+  }
+  std::mt19937_64 gen(42);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::vector<Int64Value> probe_keys;
+  for (int64_t i = 0; i < num_probe_rows; ++i) {
+    double u = uniform(gen);
+    if (dist == KeyDistribution::kUniform) {
+      probe_keys.emplace_back(static_cast<int64_t>(u * 2 * num_build_rows));
+    } else {
+      probe_keys.emplace_back(static_cast<int64_t>(std::pow(u, 8) * num_build_rows));
+    }
+  }
+  auto build_batches = MakeBatches(build_keys);
+  auto probe_batches = MakeBatches(probe_keys);
+
+  px::carnot::planpb::Operator op_pb;
+  CHECK(google::protobuf::TextFormat::MergeFromString(
+      absl::Substitute(px::carnot::planpb::testutils::kOperatorProtoTmpl, "JOIN_OPERATOR",
+                       "join_op", kInnerJoinOnKey),
+      &op_pb));
+  auto plan_node = px::carnot::plan::JoinOperator::FromProto(op_pb, 1);
+
+  auto func_registry = std::make_unique<px::carnot::udf::Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+      MockTraceStubGenerator, sole::uuid4(), nullptr);
+
+  RowDescriptor input_rd({DataType::INT64, DataType::INT64});
+  RowDescriptor output_rd({DataType::INT64, DataType::INT64, DataType::INT64});
+  FakePlanNode fake_plan(2);
+
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    ::testing::NiceMock<MockExecNode> child;
+    EquijoinNode node;
+    node.AddChild(&child, 0);
+    PX_CHECK_OK(node.Init(*plan_node, output_rd, {input_rd, input_rd}));
+    PX_CHECK_OK(node.Prepare(exec_state.get()));
+    PX_CHECK_OK(node.Open(exec_state.get()));
+    PX_CHECK_OK(child.Init(fake_plan, RowDescriptor({}), {output_rd}));
+    PX_CHECK_OK(child.Prepare(exec_state.get()));
+    PX_CHECK_OK(child.Open(exec_state.get()));
+
+    for (const auto& rb : build_batches) {
+      PX_CHECK_OK(node.ConsumeNext(exec_state.get(), rb, 0));
+    }
+    for (const auto& rb : probe_batches) {
+      PX_CHECK_OK(node.ConsumeNext(exec_state.get(), rb, 1));
+    }
+    PX_CHECK_OK(node.Close(exec_state.get()));
+  }
+  state.SetItemsProcessed(state.iterations() * (num_build_rows + num_probe_rows));
+}
+
+BENCHMARK_CAPTURE(BM_EquijoinNode, uniform, KeyDistribution::kUniform)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000 * 1000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EquijoinNode, skewed, KeyDistribution::kSkewed)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000 * 1000)
+    ->Unit(benchmark::kMillisecond);
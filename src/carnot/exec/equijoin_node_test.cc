@@ -151,6 +151,60 @@ TEST_F(JoinNodeTest, ordered_inner_join) {
       .Close();
 }
 
+TEST_F(JoinNodeTest, ordered_inner_join_over_memory_budget) {
+  // Joins spill by partition, which would lose the time order, so time ordered joins don't spill.
+  exec_state_->set_memory_budget_bytes(1);
+  exec_state_->set_spill_dir(::testing::TempDir());
+
+  const char* proto = R"(
+    type: INNER
+    equality_conditions {
+      left_column_index: 0
+      right_column_index: 1
+    }
+    output_columns: {
+      parent_index: 0
+      column_index: 1
+    }
+    output_columns: {
+      parent_index: 1
+      column_index: 0
+    }
+    column_names: "left_1"
+    column_names: "time_"
+    rows_per_batch: 10
+  )";
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  RowDescriptor input_rd_0({types::DataType::INT64, types::DataType::FLOAT64});
+  RowDescriptor input_rd_1({types::DataType::TIME64NS, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::FLOAT64, types::DataType::TIME64NS});
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+
+  tester
+      // Probe
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 6, true, true)
+                       .AddColumn<types::Time64NSValue>({10, 20, 30, 40, 50, 60})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6})
+                       .get(),
+                   1, 0)
+      // Build
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 6, true, true)
+                       .AddColumn<types::Int64Value>({6, 5, 4, 3, 2, 1})
+                       .AddColumn<types::Float64Value>({6.0, 5.0, 4.0, 3.0, 2.0, 1.0})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 6, true, true)
+                          .AddColumn<types::Float64Value>({1.0, 2.0, 3.0, 4.0, 5.0, 6.0})
+                          .AddColumn<types::Time64NSValue>({10, 20, 30, 40, 50, 60})
+                          .get(),
+                      true)
+      .Close();
+
+  EXPECT_EQ(0, exec_state_->spillable_bytes());
+}
+
 TEST_F(JoinNodeTest, ordered_left_join) {
   // time_ from left (probe) table, batches interleaved
   // Left table input: [time_:Time64Ns, left_1:Int]
@@ -320,6 +374,76 @@ TEST_F(JoinNodeTest, unordered_full_outer_join) {
       .Close();
 }
 
+TEST_F(JoinNodeTest, unordered_full_outer_join_spilled) {
+  // Spill the build side after its first batch.
+  exec_state_->set_memory_budget_bytes(1);
+  exec_state_->set_spill_dir(::testing::TempDir());
+
+  const char* proto = R"(
+  type: FULL_OUTER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 1
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 0
+  }
+  column_names: "left_1"
+  column_names: "right_1"
+  column_names: "right_0"
+  rows_per_batch: 5
+)";
+
+  RowDescriptor input_rd_0({types::DataType::TIME64NS, types::DataType::INT64});
+  RowDescriptor input_rd_1({types::DataType::INT64, types::DataType::TIME64NS});
+  RowDescriptor output_rd(
+      {types::DataType::INT64, types::DataType::TIME64NS, types::DataType::INT64});
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 5, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({101, 200, 101, 200, 101})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4, 5})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 5, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({200, 200, 200, 300, 300})
+                       .AddColumn<types::Int64Value>({6, 8, 10, 12, 14})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({400, 500})
+                       .AddColumn<types::Int64Value>({16, 18})
+                       .get(),
+                   0, 0)
+      .ConsumeNextAnyOutput(RowBatchBuilder(input_rd_1, 3, true, true)
+                                .AddColumn<types::Int64Value>({-10, -20, -30})
+                                .AddColumn<types::Time64NSValue>({110, 120, 101})
+                                .get(),
+                            1)
+      .ExpectAllRowBatchesData(
+          RowBatchBuilder(output_rd, 14, true, true)
+              .AddColumn<types::Int64Value>({0, 0, 1, 3, 5, 2, 4, 6, 8, 10, 12, 14, 16, 18})
+              .AddColumn<types::Time64NSValue>({110, 120, 101, 101, 101, 0, 0, 0, 0, 0, 0, 0, 0, 0})
+              .AddColumn<types::Int64Value>({-10, -20, -30, -30, -30, 0, 0, 0, 0, 0, 0, 0, 0, 0})
+              .get())
+      .Close();
+
+  EXPECT_EQ(0, exec_state_->spillable_bytes());
+}
+
 TEST_F(JoinNodeTest, unordered_no_left_columns) {
   // All batches from build first
   // Left table input: [left_0:String, left_1:Int64]
@@ -686,6 +810,71 @@ TEST_F(JoinNodeTest, unordered_many_matches) {
       .Close();
 }
 
+TEST_F(JoinNodeTest, unordered_dictionary_keys) {
+  // Left table input: [left_0:String, left_1:Int64]
+  // Right table input: [right_0:Int64, right_1:String]
+  // Output table: [left_1:Int, right_1:String, right_0:Int64]
+  // Inner join on left_0=right_1, where both keys come dictionary encoded, with different
+  // dictionaries.
+  const char* proto = R"(
+  type: INNER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 1
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 0
+  }
+  column_names: "left_1"
+  column_names: "right_1"
+  column_names: "right_0"
+  rows_per_batch: 5
+)";
+
+  // Left
+  RowDescriptor input_rd_0({types::DataType::STRING, types::DataType::INT64});
+  // Right
+  RowDescriptor input_rd_1({types::DataType::INT64, types::DataType::STRING});
+  // Left[1], Right[1], Right[0]
+  RowDescriptor output_rd(
+      {types::DataType::INT64, types::DataType::STRING, types::DataType::INT64});
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+  EXPECT_TRUE(tester.node()->SupportsDictionaryColumns());
+
+  tester
+      // Build(left) table
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 4, /*eow*/ true, /*eos*/ true)
+                       .AddDictionaryColumn({"a", "b", "a", "c"})
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                       .get(),
+                   0, 0)
+      // Probe(right) table
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 3, true, true)
+                       .AddColumn<types::Int64Value>({10, 20, 30})
+                       .AddDictionaryColumn({"c", "a", "d"})
+                       .get(),
+                   1, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 3, true, true)
+                          .AddColumn<types::Int64Value>({4, 1, 3})
+                          .AddColumn<types::StringValue>({"c", "a", "a"})
+                          .AddColumn<types::Int64Value>({10, 20, 20})
+                          .get(),
+                      true)
+      .Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
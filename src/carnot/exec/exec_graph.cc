@@ -43,6 +43,10 @@
 #include "src/common/perf/perf.h"
 #include "src/table_store/table_store.h"
 
+DEFINE_int32(carnot_exec_parallelism, gflags::Int32FromEnv("PL_CARNOT_EXEC_PARALLELISM", 1),
+             "The default number of workers used to execute the stateless operators (maps and "
+             "filters) that follow a memory source. 1 disables parallel execution.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -60,6 +64,13 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
   collect_exec_node_stats_ = collect_exec_node_stats;
   consecutive_generate_calls_per_source_ = consecutive_generate_calls_per_source;
 
+  if (exec_state->parallelism() > 1) {
+    PlanMorselPipelines();
+    if (!morsel_pipelines_.empty()) {
+      morsel_pool_ = std::make_unique<WorkStealingPool>(exec_state->parallelism());
+    }
+  }
+
   std::unordered_map<int64_t, ExecNode*> nodes;
   std::unordered_map<int64_t, RowDescriptor> descriptors;
   return plan::PlanFragmentWalker()
@@ -70,10 +81,22 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
         return OnOperatorImpl<plan::MemorySinkOperator, MemorySinkNode>(node, &descriptors);
       })
       .OnAggregate([&](auto& node) {
-        return OnOperatorImpl<plan::AggregateOperator, AggNode>(node, &descriptors);
+        PX_RETURN_IF_ERROR(
+            (OnOperatorImpl<plan::AggregateOperator, AggNode>(node, &descriptors)));
+        int64_t group_limit = PushableGroupLimit(node);
+        if (group_limit > 0) {
+          static_cast<AggNode*>(nodes_[node.id()])->set_group_limit(group_limit);
+        }
+        return Status::OK();
       })
       .OnMemorySource([&](auto& node) {
-        return OnOperatorImpl<plan::MemorySourceOperator, MemorySourceNode>(node, &descriptors);
+        PX_RETURN_IF_ERROR(
+            (OnOperatorImpl<plan::MemorySourceOperator, MemorySourceNode>(node, &descriptors)));
+        auto filter = PushableFilterExpression(node.id());
+        if (filter != nullptr) {
+          static_cast<MemorySourceNode*>(nodes_[node.id()])->set_pushed_down_filter(filter);
+        }
+        return Status::OK();
       })
       .OnFilter([&](auto& node) {
         return OnOperatorImpl<plan::FilterOperator, FilterNode>(node, &descriptors);
@@ -111,6 +134,91 @@ Status ExecutionGraph::Init(table_store::schema::Schema* schema, plan::PlanState
       .Walk(pf_);
 }
 
+std::shared_ptr<const plan::ScalarExpression> ExecutionGraph::PushableFilterExpression(
+    int64_t source_id) {
+  auto children = pf_->dag().DependenciesOf(source_id);
+  if (children.size() != 1) {
+    return nullptr;
+  }
+  int64_t child = children[0];
+  const auto& child_op = pf_->nodes()[child];
+  if (child_op->op_type() != planpb::OperatorType::FILTER_OPERATOR ||
+      pf_->dag().ParentsOf(child).size() != 1) {
+    return nullptr;
+  }
+  return static_cast<const plan::FilterOperator*>(child_op.get())->expression();
+}
+
+int64_t ExecutionGraph::PushableGroupLimit(const plan::AggregateOperator& agg) {
+  if (agg.windowed() || agg.groups().empty()) {
+    return 0;
+  }
+  auto children = pf_->dag().DependenciesOf(agg.id());
+  if (children.size() != 1) {
+    return 0;
+  }
+  int64_t child = children[0];
+  const auto& child_op = pf_->nodes()[child];
+  if (child_op->op_type() != planpb::OperatorType::LIMIT_OPERATOR ||
+      pf_->dag().ParentsOf(child).size() != 1) {
+    return 0;
+  }
+  return static_cast<const plan::LimitOperator*>(child_op.get())->record_limit();
+}
+
+void ExecutionGraph::PlanMorselPipelines() {
+  for (const auto& [id, op] : pf_->nodes()) {
+    if (op->op_type() != planpb::OperatorType::MEMORY_SOURCE_OPERATOR ||
+        static_cast<const plan::MemorySourceOperator*>(op.get())->streaming()) {
+      continue;
+    }
+    MorselPipeline pipeline;
+    pipeline.source_id = id;
+    int64_t current = id;
+    while (true) {
+      auto children = pf_->dag().DependenciesOf(current);
+      if (children.size() != 1) {
+        break;
+      }
+      int64_t child = children[0];
+      auto child_type = pf_->nodes()[child]->op_type();
+      if ((child_type != planpb::OperatorType::MAP_OPERATOR &&
+           child_type != planpb::OperatorType::FILTER_OPERATOR) ||
+          pf_->dag().ParentsOf(child).size() != 1) {
+        break;
+      }
+      pipeline.op_ids.push_back(child);
+      current = child;
+    }
+    if (pipeline.op_ids.empty()) {
+      continue;
+    }
+    for (int64_t op_id : pipeline.op_ids) {
+      op_to_morsel_pipeline_[op_id] = morsel_pipelines_.size();
+    }
+    morsel_pipelines_.push_back(std::move(pipeline));
+  }
+}
+
+Status ExecutionGraph::FinishMorselPipeline(
+    const plan::Operator& tail_op, const RowDescriptor& output_descriptor,
+    MorselPipeline* pipeline, const std::unordered_map<int64_t, RowDescriptor>& descriptors) {
+  auto source_desc = descriptors.find(pipeline->source_id);
+  auto source = nodes_.find(pipeline->source_id);
+  if (source_desc == descriptors.end() || source == nodes_.end()) {
+    return error::NotFound("Could not find source ExecNode of morsel pipeline.");
+  }
+  auto dispatch = pool_.Add(new MorselDispatchNode());
+  PX_RETURN_IF_ERROR(dispatch->Init(tail_op, output_descriptor, {source_desc->second},
+                                    collect_exec_node_stats_));
+  PX_RETURN_IF_ERROR(
+      dispatch->SetStages(tail_op, std::move(pipeline->stages), morsel_pool_.get()));
+  source->second->AddChild(dispatch, 0);
+  morsel_tail_to_dispatch_[tail_op.id()] = dispatch;
+  morsel_dispatch_nodes_.push_back(dispatch);
+  return Status::OK();
+}
+
 bool ExecutionGraph::YieldWithTimeout() {
   std::unique_lock<std::mutex> lock(execution_mutex_);
   if (continue_) {
@@ -298,6 +406,7 @@ Status ExecutionGraph::Execute() {
   // Get vector of nodes.
   std::vector<ExecNode*> nodes(nodes_.size());
   transform(nodes_.begin(), nodes_.end(), nodes.begin(), [](auto pair) { return pair.second; });
+  nodes.insert(nodes.end(), morsel_dispatch_nodes_.begin(), morsel_dispatch_nodes_.end());
 
   for (auto node : nodes) {
     PX_RETURN_IF_ERROR(node->Prepare(exec_state_));
@@ -32,6 +32,8 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/exec/morsel_dispatch_node.h"
+#include "src/carnot/exec/work_stealing_pool.h"
 #include "src/carnot/plan/plan_fragment.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/common/base/base.h"
@@ -195,6 +197,13 @@ class ExecutionGraph {
 
     AddNode(node.id(), execNode);
 
+    // Operators of a morsel pipeline are fed by the pipeline's dispatcher instead of their parent.
+    auto pipeline = op_to_morsel_pipeline_.find(node.id());
+    if (pipeline != op_to_morsel_pipeline_.end()) {
+      return AddMorselStage<TNode>(node, output_descriptor, input_descriptors, execNode,
+                                   &morsel_pipelines_[pipeline->second], *descriptors);
+    }
+
     // Update parents' children.
     for (size_t i = 0; i < parents.size(); ++i) {
       auto parent = nodes_.find(parents[i]);
@@ -202,11 +211,78 @@ class ExecutionGraph {
       if (parent == nodes_.end()) {
         return error::NotFound("Could not find parent ExecNode.");
       }
+      // The output of a morsel pipeline is produced by its dispatcher.
+      auto dispatch = morsel_tail_to_dispatch_.find(parents[i]);
+      if (dispatch != morsel_tail_to_dispatch_.end()) {
+        dispatch->second->AddChild(execNode, i);
+        continue;
+      }
       parent->second->AddChild(execNode, i);
     }
     return Status::OK();
   }
 
+  /**
+   * A chain of stateless operators fed by a non-streaming memory source. When the query runs with
+   * a parallelism greater than 1, the chain is executed morsel by morsel on morsel_pool_.
+   */
+  struct MorselPipeline {
+    int64_t source_id;
+    // The plan ids of the operators in the chain, in order.
+    std::vector<int64_t> op_ids;
+    // stages[i][w] is worker w's copy of the exec node for op_ids[i].
+    std::vector<std::vector<ExecNode*>> stages;
+  };
+
+  /**
+   * Finds the chains of the plan fragment that can be executed as morsel pipelines.
+   */
+  void PlanMorselPipelines();
+
+  /**
+   * Returns the predicate of the filter that is the only consumer of the given memory source, or
+   * nullptr if there is none. It's handed to the source to push down into its table cursor.
+   */
+  std::shared_ptr<const plan::ScalarExpression> PushableFilterExpression(int64_t source_id);
+
+  /**
+   * Returns the limit that is the only consumer of the given grouped, non-windowed aggregate, or 0
+   * if there is none. It's handed to the aggregate, which then only keeps as many groups.
+   */
+  int64_t PushableGroupLimit(const plan::AggregateOperator& agg);
+
+  /**
+   * Creates the per-worker copies of a morsel pipeline operator. worker0 is the node registered
+   * with the graph for the operator.
+   */
+  template <typename TNode>
+  Status AddMorselStage(
+      const plan::Operator& node, const table_store::schema::RowDescriptor& output_descriptor,
+      const std::vector<table_store::schema::RowDescriptor>& input_descriptors, ExecNode* worker0,
+      MorselPipeline* pipeline,
+      const std::unordered_map<int64_t, table_store::schema::RowDescriptor>& descriptors) {
+    std::vector<ExecNode*> workers{worker0};
+    for (int32_t w = 1; w < morsel_pool_->num_workers(); ++w) {
+      auto worker = pool_.Add(new TNode());
+      PX_RETURN_IF_ERROR(
+          worker->Init(node, output_descriptor, input_descriptors, collect_exec_node_stats_));
+      workers.push_back(worker);
+    }
+    pipeline->stages.push_back(std::move(workers));
+    if (node.id() != pipeline->op_ids.back()) {
+      return Status::OK();
+    }
+    return FinishMorselPipeline(node, output_descriptor, pipeline, descriptors);
+  }
+
+  /**
+   * Creates the dispatcher for a morsel pipeline once all of its stages have been created.
+   */
+  Status FinishMorselPipeline(
+      const plan::Operator& tail_op, const table_store::schema::RowDescriptor& output_descriptor,
+      MorselPipeline* pipeline,
+      const std::unordered_map<int64_t, table_store::schema::RowDescriptor>& descriptors);
+
   Status ExecuteSources();
 
   ExecState* exec_state_;
@@ -219,6 +295,16 @@ class ExecutionGraph {
   absl::flat_hash_set<int64_t> grpc_sinks_;
   std::unordered_map<int64_t, ExecNode*> nodes_;
 
+  std::vector<MorselPipeline> morsel_pipelines_;
+  // Map from the plan id of an operator to the index of the morsel pipeline it belongs to.
+  absl::flat_hash_map<int64_t, size_t> op_to_morsel_pipeline_;
+  // Map from the plan id of the last operator of a morsel pipeline to the pipeline's dispatcher.
+  absl::flat_hash_map<int64_t, MorselDispatchNode*> morsel_tail_to_dispatch_;
+  // Dispatchers aren't part of the plan, so they are tracked separately from nodes_.
+  std::vector<MorselDispatchNode*> morsel_dispatch_nodes_;
+  // The workers that execute morsel pipelines. Only created if the fragment has any.
+  std::unique_ptr<WorkStealingPool> morsel_pool_;
+
   SystemTimePoint query_start_time_;
 
   // How long to wait for any upstream result to make the initial connection to this query.
@@ -127,11 +127,14 @@ TEST_F(ExecGraphTest, basic) {
 }
 
 class ExecGraphExecuteTest : public ExecGraphTest,
-                             public ::testing::WithParamInterface<std::tuple<int32_t>> {};
+                             public ::testing::WithParamInterface<
+                                 std::tuple<int32_t, int32_t, bool>> {};
 
 TEST_P(ExecGraphExecuteTest, execute) {
   int32_t calls_to_generate;
-  std::tie(calls_to_generate) = GetParam();
+  int32_t parallelism;
+  bool collect_exec_node_stats;
+  std::tie(calls_to_generate, parallelism, collect_exec_node_stats) = GetParam();
 
   planpb::PlanFragment pf_pb;
   ASSERT_TRUE(TextFormat::MergeFromString(planpb::testutils::kLinearPlanFragment, &pf_pb));
@@ -181,10 +184,11 @@ TEST_P(ExecGraphExecuteTest, execute) {
   EXPECT_OK(exec_state_->AddScalarUDF(
       1, "multiply",
       std::vector<types::DataType>({types::DataType::FLOAT64, types::DataType::INT64})));
+  exec_state_->set_parallelism(parallelism);
 
   ExecutionGraph e;
   auto s = e.Init(schema.get(), plan_state.get(), exec_state_.get(), plan_fragment_.get(),
-                  /* collect_exec_node_stats */ false, calls_to_generate);
+                  collect_exec_node_stats, calls_to_generate);
 
   EXPECT_OK(e.Execute());
 
@@ -198,11 +202,12 @@ TEST_P(ExecGraphExecuteTest, execute) {
       types::ToArrow(out_in2, arrow::default_memory_pool())));
 }
 
-std::vector<std::tuple<int32_t>> calls_to_execute = {
-    {1},
-    {2},
-    {3},
-    {4},
+// Each case is {calls_to_generate, parallelism, collect_exec_node_stats}. The parallel cases run
+// the map of the linear plan as a morsel pipeline and must produce the same row batches in the same
+// order, with or without stats collection.
+std::vector<std::tuple<int32_t, int32_t, bool>> calls_to_execute = {
+    {1, 1, false}, {2, 1, false}, {3, 1, false}, {4, 1, false}, {1, 2, false},
+    {1, 4, false}, {3, 4, false}, {1, 4, true},  {3, 4, true},
 };
 
 INSTANTIATE_TEST_SUITE_P(ExecGraphExecuteTestSuite, ExecGraphExecuteTest,
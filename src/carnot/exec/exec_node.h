@@ -46,7 +46,7 @@ struct ExecNodeStats {
     }
     ++batches_output;
     bytes_output += rb.NumBytes();
-    rows_output += rb.num_rows();
+    rows_output += rb.num_selected_rows();
   }
 
   void AddInputStats(const table_store::schema::RowBatch& rb) {
@@ -55,7 +55,7 @@ struct ExecNodeStats {
     }
     ++batches_input;
     bytes_input += rb.NumBytes();
-    rows_input += rb.num_rows();
+    rows_input += rb.num_selected_rows();
   }
 
   void ResumeChildTimer() {
@@ -99,6 +99,22 @@ struct ExecNodeStats {
     extra_info[key] = value;
   }
 
+  /**
+   * Adds the row, byte and batch counters of other into these stats. Used to fold the stats of
+   * per-worker copies of an operator into the copy that is reported for the plan node.
+   */
+  void MergeCounters(const ExecNodeStats& other) {
+    if (!collect_exec_stats) {
+      return;
+    }
+    bytes_input += other.bytes_input;
+    rows_input += other.rows_input;
+    batches_input += other.batches_input;
+    bytes_output += other.bytes_output;
+    rows_output += other.rows_output;
+    batches_output += other.batches_output;
+  }
+
   int64_t ChildExecTime() const { return children_timer.ElapsedTime_us() * 1000; }
   int64_t TotalExecTime() const { return total_timer.ElapsedTime_us() * 1000; }
   int64_t SelfExecTime() const { return TotalExecTime() - ChildExecTime(); }
@@ -160,6 +176,8 @@ class ExecNode {
    */
   Status Prepare(ExecState* exec_state) {
     DCHECK(is_initialized_);
+    mem_pool_ = exec_state->CreateNodeMemoryPool();
+    ScopedExecMemoryPool scoped_pool(mem_pool_.get());
     return PrepareImpl(exec_state);
   }
 
@@ -170,6 +188,7 @@ class ExecNode {
    */
   Status Open(ExecState* exec_state) {
     DCHECK(is_initialized_);
+    ScopedExecMemoryPool scoped_pool(mem_pool_.get());
     return OpenImpl(exec_state);
   }
 
@@ -182,6 +201,11 @@ class ExecNode {
    */
   Status Close(ExecState* exec_state) {
     DCHECK(is_initialized_);
+    ScopedExecMemoryPool scoped_pool(mem_pool_.get());
+    if (mem_pool_ != nullptr) {
+      stats_->AddExtraMetric("peak_memory_bytes", mem_pool_->peak_bytes());
+      stats_->AddExtraMetric("total_memory_bytes", mem_pool_->total_bytes_allocated());
+    }
     return CloseImpl(exec_state);
   }
 
@@ -194,10 +218,11 @@ class ExecNode {
   Status GenerateNext(ExecState* exec_state) {
     DCHECK(is_initialized_);
     DCHECK(type() == ExecNodeType::kSourceNode);
+    ScopedExecMemoryPool scoped_pool(mem_pool_.get());
     stats_->ResumeTotalTimer();
     PX_RETURN_IF_ERROR(GenerateNextImpl(exec_state));
     stats_->StopTotalTimer();
-    return Status::OK();
+    return exec_state->CheckMemoryLimit();
   }
 
   /**
@@ -218,11 +243,12 @@ class ExecNode {
       return error::Internal(
           "ConsumeNext received row batch with end of stream set but not end of window.");
     }
+    ScopedExecMemoryPool scoped_pool(mem_pool_.get());
     stats_->AddInputStats(rb);
     stats_->ResumeTotalTimer();
     PX_RETURN_IF_ERROR(ConsumeNextImpl(exec_state, rb, parent_index));
     stats_->StopTotalTimer();
-    return Status::OK();
+    return exec_state->CheckMemoryLimit();
   }
 
   /**
@@ -275,6 +301,20 @@ class ExecNode {
 
   ExecNodeStats* stats() const { return stats_.get(); }
 
+  /**
+   * Whether this node reads the row batches it consumes through their selection (see
+   * RowBatch::selection()). Batches sent to nodes that don't are compacted first.
+   * Only valid after Init.
+   */
+  virtual bool SupportsSelection() const { return false; }
+
+  /**
+   * Whether this node reads the dictionary encoded STRING columns of the batches it consumes (see
+   * RowBatch::HasDictionaryColumns()). Batches sent to nodes that don't are decoded first.
+   * Only valid after Init.
+   */
+  virtual bool SupportsDictionaryColumns() const { return false; }
+
  protected:
   /**
    * Send data to children row batches.
@@ -284,8 +324,26 @@ class ExecNode {
    */
   Status SendRowBatchToChildren(ExecState* exec_state, const table_store::schema::RowBatch& rb) {
     stats_->ResumeChildTimer();
+    // Children that can't read through a selection get the selected rows copied out, once.
+    // Compacting also decodes dictionary columns, other children that can't read them get them
+    // decoded, once.
+    std::unique_ptr<table_store::schema::RowBatch> compacted_rb;
+    std::unique_ptr<table_store::schema::RowBatch> decoded_rb;
     for (size_t i = 0; i < children_.size(); ++i) {
-      PX_RETURN_IF_ERROR(children_[i]->ConsumeNext(exec_state, rb, parent_ids_for_children_[i]));
+      const table_store::schema::RowBatch* child_rb = &rb;
+      if (rb.has_selection() && !children_[i]->SupportsSelection()) {
+        if (compacted_rb == nullptr) {
+          PX_ASSIGN_OR_RETURN(compacted_rb, rb.Compact(exec_state->exec_mem_pool()));
+        }
+        child_rb = compacted_rb.get();
+      } else if (!children_[i]->SupportsDictionaryColumns() && rb.HasDictionaryColumns()) {
+        if (decoded_rb == nullptr) {
+          PX_ASSIGN_OR_RETURN(decoded_rb, rb.DecodeDictionaryColumns(exec_state->exec_mem_pool()));
+        }
+        child_rb = decoded_rb.get();
+      }
+      PX_RETURN_IF_ERROR(
+          children_[i]->ConsumeNext(exec_state, *child_rb, parent_ids_for_children_[i]));
     }
     stats_->StopChildTimer();
     stats_->AddOutputStats(rb);
@@ -323,6 +381,8 @@ class ExecNode {
  private:
   // The stats of this exec node.
   std::unique_ptr<ExecNodeStats> stats_;
+  // Tracks the allocations made by this exec node, created in Prepare.
+  TrackingMemoryPool::Ptr mem_pool_;
   // Unowned reference to the children. Must remain valid for the duration of query.
   std::vector<ExecNode*> children_;
   // For each of the children (which may have multiple parents) which parent is this node?
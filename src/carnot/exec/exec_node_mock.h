@@ -41,6 +41,8 @@ class MockExecNode : public ExecNode {
   MOCK_METHOD1(CloseImpl, Status(ExecState* exec_state));
   MOCK_METHOD1(GenerateNextImpl, Status(ExecState*));
   MOCK_METHOD3(ConsumeNextImpl, Status(ExecState*, const table_store::schema::RowBatch&, size_t));
+  MOCK_CONST_METHOD0(SupportsSelection, bool());
+  MOCK_CONST_METHOD0(SupportsDictionaryColumns, bool());
 };
 
 class MockSourceNode : public SourceNode {
@@ -20,6 +20,8 @@
 
 #include <arrow/memory_pool.h>
 
+#include <algorithm>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -31,6 +33,7 @@
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/exec/exec_metrics.h"
 #include "src/carnot/exec/grpc_router.h"
+#include "src/carnot/exec/tracking_memory_pool.h"
 #include "src/carnot/udf/model_pool.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
@@ -41,6 +44,11 @@
 #include "opentelemetry/proto/collector/trace/v1/trace_service.grpc.pb.h"
 #include "src/carnot/carnotpb/carnot.grpc.pb.h"
 
+DECLARE_int32(carnot_exec_parallelism);
+DECLARE_int64(carnot_query_memory_budget_mb);
+DECLARE_string(carnot_spill_dir);
+DECLARE_int64(carnot_query_memory_limit_mb);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -89,13 +97,91 @@ class ExecState {
       grpc_router_->DeleteQuery(query_id_);
     }
   }
+  /**
+   * The pool that query allocations should go through. Inside of an exec node this is the pool
+   * of that node, which allocates from the query pool.
+   */
   arrow::MemoryPool* exec_mem_pool() {
-    // TOOD(zasgar): Make this the correct pool.
-    return arrow::default_memory_pool();
+    auto* node_pool = ScopedExecMemoryPool::current();
+    return node_pool != nullptr ? node_pool : query_mem_pool_.get();
+  }
+
+  TrackingMemoryPool* query_mem_pool() { return query_mem_pool_.get(); }
+
+  /**
+   * Creates a pool that tracks the allocations of a single exec node.
+   */
+  TrackingMemoryPool::Ptr CreateNodeMemoryPool() {
+    return TrackingMemoryPool::Create(query_mem_pool_.get());
+  }
+
+  /**
+   * @return an error if the query allocated more than its memory limit.
+   */
+  Status CheckMemoryLimit() const {
+    if (!query_mem_pool_->limit_exceeded()) {
+      return Status::OK();
+    }
+    return error::ResourceUnavailable("Query $0 exceeded its memory limit of $1 bytes",
+                                      query_id_.str(), query_mem_pool_->limit_bytes());
   }
 
   udf::Registry* func_registry() { return func_registry_; }
 
+  /**
+   * The number of workers used to execute the stateless pipelines of this query.
+   * A value of 1 executes the query on the calling thread only.
+   */
+  int32_t parallelism() const { return parallelism_; }
+  void set_parallelism(int32_t parallelism) { parallelism_ = std::max(parallelism, 1); }
+
+  /**
+   * The number of bytes the spillable state of the operators of this query (aggregate groups,
+   * join build sides) may hold before they spill to disk. A value of 0 means no limit.
+   */
+  int64_t memory_budget_bytes() const { return memory_budget_bytes_; }
+  void set_memory_budget_bytes(int64_t bytes) { memory_budget_bytes_ = bytes; }
+
+  /**
+   * The directory that operators write their spilled state to.
+   */
+  const std::string& spill_dir() const { return spill_dir_; }
+  void set_spill_dir(std::string spill_dir) { spill_dir_ = std::move(spill_dir); }
+
+  /**
+   * Adjusts the number of bytes held by spillable operator state by delta.
+   */
+  void UpdateSpillableBytes(int64_t delta) { spillable_bytes_ += delta; }
+  int64_t spillable_bytes() const { return spillable_bytes_; }
+
+  /**
+   * @return true if the spillable operator state exceeds the memory budget of the query.
+   */
+  bool ExceedsMemoryBudget() const {
+    return memory_budget_bytes_ > 0 && spillable_bytes_ > memory_budget_bytes_;
+  }
+
+  /**
+   * Operators that may spill register themselves while they are open, so that each gets a share of
+   * the memory budget.
+   */
+  void AddSpillableNode() { ++num_spillable_nodes_; }
+  void RemoveSpillableNode() { --num_spillable_nodes_; }
+
+  /**
+   * @return true if an operator holding node_bytes of spillable state should spill it. That's the
+   * case when the query exceeds its memory budget and the operator holds at least its share of the
+   * budget, so that operators with small state don't spill because another one grew large. Since
+   * the state of the query is over budget, at least one operator is always over its share.
+   */
+  bool ShouldSpill(int64_t node_bytes) const {
+    if (!ExceedsMemoryBudget()) {
+      return false;
+    }
+    int64_t num_nodes = std::max<int64_t>(num_spillable_nodes_, 1);
+    return node_bytes >= memory_budget_bytes_ / num_nodes;
+  }
+
   table_store::TableStore* table_store() { return table_store_.get(); }
 
   const sole::uuid& query_id() const { return query_id_; }
@@ -158,7 +244,12 @@ class ExecState {
     return raw;
   }
 
-  udf::ScalarUDFDefinition* GetScalarUDFDefinition(int64_t id) { return id_to_scalar_udf_map_[id]; }
+  udf::ScalarUDFDefinition* GetScalarUDFDefinition(int64_t id) {
+    // Use find instead of operator[] since this is called concurrently by the workers of
+    // parallel pipelines.
+    auto it = id_to_scalar_udf_map_.find(id);
+    return it == id_to_scalar_udf_map_.end() ? nullptr : it->second;
+  }
 
   std::map<int64_t, udf::ScalarUDFDefinition*> id_to_scalar_udf_map() {
     return id_to_scalar_udf_map_;
@@ -216,6 +307,13 @@ class ExecState {
   GRPCRouter* grpc_router_ = nullptr;
   std::function<void(grpc::ClientContext*)> add_auth_to_grpc_client_context_func_;
   ExecMetrics* exec_metrics_;
+  int32_t parallelism_ = std::max(FLAGS_carnot_exec_parallelism, 1);
+  TrackingMemoryPool::Ptr query_mem_pool_ = TrackingMemoryPool::Create(
+      arrow::default_memory_pool(), FLAGS_carnot_query_memory_limit_mb * 1024 * 1024);
+  int64_t memory_budget_bytes_ = FLAGS_carnot_query_memory_budget_mb * 1024 * 1024;
+  std::string spill_dir_ = FLAGS_carnot_spill_dir;
+  std::atomic<int64_t> spillable_bytes_ = 0;
+  std::atomic<int64_t> num_spillable_nodes_ = 0;
 
   int64_t current_source_ = 0;
   bool current_source_set_ = false;
@@ -26,8 +26,10 @@
 #include <iterator>
 #include <memory>
 #include <ostream>
+#include <string>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
 #include <absl/strings/str_join.h>
 #include <absl/strings/substitute.h>
 
@@ -37,6 +39,10 @@
 #include "src/shared/types/types.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 
+DEFINE_bool(carnot_fused_expressions, gflags::BoolFromEnv("PL_CARNOT_FUSED_EXPRESSIONS", true),
+            "Whether map and filter nodes evaluate arithmetic, comparison and boolean expressions "
+            "over fixed width columns as fused loops, instead of one UDF call per function.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -66,6 +72,8 @@ std::unique_ptr<ScalarExpressionEvaluator> ScalarExpressionEvaluator::Create(
       return std::make_unique<VectorNativeScalarExpressionEvaluator>(expressions, function_ctx);
     case ScalarExpressionEvaluatorType::kArrowNative:
       return std::make_unique<ArrowNativeScalarExpressionEvaluator>(expressions, function_ctx);
+    case ScalarExpressionEvaluatorType::kFused:
+      return std::make_unique<FusedScalarExpressionEvaluator>(expressions, function_ctx);
     default:
       CHECK(0) << "Unknown expression type";
   }
@@ -151,6 +159,24 @@ std::string ScalarExpressionEvaluator::DebugString() {
   return absl::Substitute("ExpressionEvaluator<$0>", absl::StrJoin(debug_strs, ","));
 }
 
+bool CanEvaluateOutsideSelection(const plan::ScalarExpression& expr) {
+  // Builtins that can't fail, trap or run for long on any input. Integer modulo (and bin, which
+  // uses it) traps on a zero divisor, and UDFs in general may assume their inputs were filtered.
+  static const absl::flat_hash_set<std::string> kTotalFuncs = {
+      "abs", "add", "approxEqual", "ceil", "divide", "equal", "floor", "greaterThan",
+      "greaterThanEqual", "invert", "lessThan", "lessThanEqual", "logicalAnd", "logicalNot",
+      "logicalOr", "multiply", "negate", "notEqual", "subtract"};
+  plan::ExpressionWalker<bool> walker;
+  walker.OnScalarValue([](auto, auto) -> bool { return true; });
+  walker.OnColumn([](auto, auto) -> bool { return true; });
+  walker.OnScalarFunc([](const plan::ScalarFunc& fn, const std::vector<bool>& child_values) {
+    return kTotalFuncs.contains(fn.name()) &&
+           std::all_of(child_values.begin(), child_values.end(), [](bool v) { return v; });
+  });
+  auto total_or_s = walker.Walk(expr);
+  return total_or_s.ok() && total_or_s.ValueOrDie();
+}
+
 Status ScalarExpressionEvaluator::InitFuncsInExpression(
     ExecState* exec_state, std::shared_ptr<const plan::ScalarExpression> expr) {
   plan::ExpressionWalker<bool> walker;
@@ -320,7 +346,7 @@ Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
         auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
         auto udf = id_to_udf_map_[fn.udf_id()].get();
 
-        auto output = MakeArrowBuilder(def->exec_return_type(), arrow::default_memory_pool());
+        auto output = MakeArrowBuilder(def->exec_return_type(), exec_state->exec_mem_pool());
 
         std::vector<arrow::Array*> raw_children;
         raw_children.reserve(children.size());
@@ -341,6 +367,37 @@ Status exec::ArrowNativeScalarExpressionEvaluator::EvaluateSingleExpression(
   return Status::OK();
 }
 
+Status FusedScalarExpressionEvaluator::Evaluate(ExecState* exec_state, const RowBatch& input,
+                                                RowBatch* output) {
+  CHECK(exec_state != nullptr);
+  CHECK(output != nullptr);
+  CHECK_EQ(static_cast<size_t>(output->num_columns()), expressions_.size());
+
+  if (!compiled_) {
+    for (const auto& expr : expressions_) {
+      auto fused_or_s = FusedExpression::Compile(exec_state, *expr, input.desc());
+      if (!fused_or_s.ok()) {
+        VLOG(1) << absl::Substitute("Not fusing $0: $1", expr->DebugString(), fused_or_s.msg());
+        fused_expressions_.push_back(nullptr);
+        continue;
+      }
+      fused_expressions_.push_back(fused_or_s.ConsumeValueOrDie());
+    }
+    compiled_ = true;
+  }
+
+  for (const auto& [i, expr] : Enumerate(expressions_)) {
+    if (fused_expressions_[i] == nullptr) {
+      PX_RETURN_IF_ERROR(EvaluateSingleExpression(exec_state, input, *expr, output));
+      continue;
+    }
+    PX_ASSIGN_OR_RETURN(auto result,
+                        fused_expressions_[i]->Evaluate(input, exec_state->exec_mem_pool()));
+    PX_RETURN_IF_ERROR(output->AddColumn(result));
+  }
+  return Status::OK();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/fused_expression.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
 #include "src/carnot/udf/udf.h"
@@ -34,6 +35,8 @@
 #include "src/shared/types/column_wrapper.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_bool(carnot_fused_expressions);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -45,6 +48,14 @@ std::shared_ptr<types::ColumnWrapper> EvalScalarToColumnWrapper(ExecState*,
                                                                 const plan::ScalarValue& val,
                                                                 size_t count);
 
+/**
+ * Returns whether the expression can be evaluated on the rows that the selection of a batch
+ * excludes. Those rows hold values the query filtered out before the expression, such as the zero
+ * divisors of df[df.b != 0] followed by df.a % df.b, so only expressions built from builtins that
+ * are defined on every input qualify. Other expressions must be evaluated on the compacted batch.
+ */
+bool CanEvaluateOutsideSelection(const plan::ScalarExpression& expr);
+
 /**
  * Base expression evaluator class.
  */
@@ -89,6 +100,7 @@ class ExpressionEvaluator {
 enum class ScalarExpressionEvaluatorType : uint8_t {
   kVectorNative = 0,
   kArrowNative = 1,
+  kFused = 2,
 };
 
 /**
@@ -169,6 +181,27 @@ class ArrowNativeScalarExpressionEvaluator : public ScalarExpressionEvaluator {
                                   table_store::schema::RowBatch* output) override;
 };
 
+/**
+ * A scalar expression evaluator that evaluates arithmetic, comparison and boolean expressions over
+ * fixed width columns as FusedExpressions, and every other expression with the arrow native
+ * evaluator.
+ */
+class FusedScalarExpressionEvaluator : public ArrowNativeScalarExpressionEvaluator {
+ public:
+  explicit FusedScalarExpressionEvaluator(const plan::ConstScalarExpressionVector& expressions,
+                                          udf::FunctionContext* function_ctx)
+      : ArrowNativeScalarExpressionEvaluator(expressions, function_ctx) {}
+
+  Status Evaluate(ExecState* exec_state, const table_store::schema::RowBatch& input,
+                  table_store::schema::RowBatch* output) override;
+
+ private:
+  // The expressions are compiled on the first batch, since that is when the input types are
+  // known. Expressions that can't be fused have a null entry.
+  bool compiled_ = false;
+  std::vector<std::unique_ptr<FusedExpression>> fused_expressions_;
+};
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
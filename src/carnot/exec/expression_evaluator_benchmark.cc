@@ -21,13 +21,19 @@
 #include <benchmark/benchmark.h>
 #include <cstddef>
 #include <memory>
+#include <random>
 #include <vector>
 
+#include <absl/strings/substitute.h>
 #include <google/protobuf/text_format.h>
+#include <gmock/gmock.h>
 #include <sole.hpp>
 
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/exec_node_mock.h"
 #include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/filter_node.h"
+#include "src/carnot/exec/map_node.h"
 #include "src/carnot/exec/test_utils.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/carnot/plan/scalar_expression.h"
@@ -46,6 +52,10 @@
 using ScalarExpression = px::carnot::plan::ScalarExpression;
 using ScalarExpressionVector = std::vector<std::shared_ptr<ScalarExpression>>;
 using px::carnot::exec::ExecState;
+using px::carnot::exec::FakePlanNode;
+using px::carnot::exec::FilterNode;
+using px::carnot::exec::MapNode;
+using px::carnot::exec::MockExecNode;
 using px::carnot::exec::MockMetricsStubGenerator;
 using px::carnot::exec::MockResultSinkStubGenerator;
 using px::carnot::exec::MockTraceStubGenerator;
@@ -61,14 +71,57 @@ using px::carnot::udf::ScalarUDF;
 using px::table_store::schema::RowBatch;
 using px::table_store::schema::RowDescriptor;
 using px::types::DataType;
+using px::types::BoolValue;
+using px::types::Float64Value;
 using px::types::Int64Value;
 using px::types::ToArrow;
 
 class AddUDF : public ScalarUDF {
  public:
+  static constexpr px::carnot::udf::FusedOp FusedOp() { return px::carnot::udf::FusedOp::kAdd; }
   Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
 };
 
+class LessThanUDF : public ScalarUDF {
+ public:
+  static constexpr px::carnot::udf::FusedOp FusedOp() {
+    return px::carnot::udf::FusedOp::kLessThan;
+  }
+  BoolValue Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val < v2.val; }
+};
+
+class DivideUDF : public ScalarUDF {
+ public:
+  static constexpr px::carnot::udf::FusedOp FusedOp() { return px::carnot::udf::FusedOp::kDivide; }
+  Float64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) {
+    return static_cast<double>(v1.val) / static_cast<double>(v2.val);
+  }
+};
+
+class GreaterThanUDF : public ScalarUDF {
+ public:
+  static constexpr px::carnot::udf::FusedOp FusedOp() {
+    return px::carnot::udf::FusedOp::kGreaterThan;
+  }
+  BoolValue Exec(FunctionContext*, Float64Value v1, Float64Value v2) { return v1.val > v2.val; }
+};
+
+class GreaterThanEqualUDF : public ScalarUDF {
+ public:
+  static constexpr px::carnot::udf::FusedOp FusedOp() {
+    return px::carnot::udf::FusedOp::kGreaterThanEqual;
+  }
+  BoolValue Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val >= v2.val; }
+};
+
+class AndUDF : public ScalarUDF {
+ public:
+  static constexpr px::carnot::udf::FusedOp FusedOp() {
+    return px::carnot::udf::FusedOp::kLogicalAnd;
+  }
+  BoolValue Exec(FunctionContext*, BoolValue v1, BoolValue v2) { return v1.val && v2.val; }
+};
+
 // NOLINTNEXTLINE : runtime/references.
 void BM_ScalarExpressionTwoCols(benchmark::State& state,
                                 const ScalarExpressionEvaluatorType& eval_type, const char* pbtxt) {
@@ -141,6 +194,11 @@ BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_add_nested_native,
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_add_nested_fused,
+                  ScalarExpressionEvaluatorType::kFused, kAddScalarFuncNestedPbtxt)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+
 BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_arrow,
                   ScalarExpressionEvaluatorType::kArrowNative, kAddScalarFuncNestedPbtxt)
     ->RangeMultiplier(2)
@@ -149,3 +207,272 @@ BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_vector,
                   ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_fused,
+                  ScalarExpressionEvaluatorType::kFused, kAddScalarFuncPbtxt)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+
+// col0 / 1000000 > 200.0 and col1 >= 500, e.g. slow requests that failed.
+constexpr char kSlowErrorsPbtxt[] = R"(
+func {
+  name: "and"
+  id: 3
+  args {
+    func {
+      name: "greaterThan"
+      id: 1
+      args {
+        func {
+          name: "divide"
+          id: 0
+          args { column { node: 0 index: 0 } }
+          args { constant { data_type: INT64 int64_value: 1000000 } }
+          args_data_types: INT64
+          args_data_types: INT64
+        }
+      }
+      args { constant { data_type: FLOAT64 float64_value: 200.0 } }
+      args_data_types: FLOAT64
+      args_data_types: FLOAT64
+    }
+  }
+  args {
+    func {
+      name: "greaterThanEqual"
+      id: 2
+      args { column { node: 0 index: 1 } }
+      args { constant { data_type: INT64 int64_value: 500 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args_data_types: BOOLEAN
+  args_data_types: BOOLEAN
+})";
+
+// Evaluates a predicate tree of five functions, whose intermediate results the arrow and vector
+// evaluators each materialize as a column.
+// NOLINTNEXTLINE : runtime/references.
+void BM_ScalarExpressionPredicateTree(benchmark::State& state,
+                                      const ScalarExpressionEvaluatorType& eval_type) {
+  size_t data_size = state.range(0);
+
+  px::carnot::planpb::ScalarExpression se_pb;
+  CHECK(google::protobuf::TextFormat::MergeFromString(kSlowErrorsPbtxt, &se_pb));
+  auto s_or_se = px::carnot::plan::ScalarExpression::FromProto(se_pb);
+  CHECK(s_or_se.ok());
+  std::shared_ptr<ScalarExpression> se = s_or_se.ConsumeValueOrDie();
+
+  auto func_registry = std::make_unique<Registry>("test_registry");
+  PX_CHECK_OK(func_registry->Register<DivideUDF>("divide"));
+  PX_CHECK_OK(func_registry->Register<GreaterThanUDF>("greaterThan"));
+  PX_CHECK_OK(func_registry->Register<GreaterThanEqualUDF>("greaterThanEqual"));
+  PX_CHECK_OK(func_registry->Register<AndUDF>("and"));
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+      MockTraceStubGenerator, sole::uuid4(), nullptr);
+  PX_CHECK_OK(exec_state->AddScalarUDF(0, "divide", {DataType::INT64, DataType::INT64}));
+  PX_CHECK_OK(exec_state->AddScalarUDF(1, "greaterThan", {DataType::FLOAT64, DataType::FLOAT64}));
+  PX_CHECK_OK(exec_state->AddScalarUDF(2, "greaterThanEqual", {DataType::INT64, DataType::INT64}));
+  PX_CHECK_OK(exec_state->AddScalarUDF(3, "and", {DataType::BOOLEAN, DataType::BOOLEAN}));
+
+  std::default_random_engine rng(42);
+  std::uniform_int_distribution<int64_t> latency_ns(0, 1000 * 1000 * 1000);
+  std::uniform_int_distribution<int64_t> status(200, 599);
+  std::vector<Int64Value> latencies(data_size);
+  std::vector<Int64Value> statuses(data_size);
+  for (size_t i = 0; i < data_size; ++i) {
+    latencies[i] = latency_ns(rng);
+    statuses[i] = status(rng);
+  }
+
+  RowDescriptor rd({DataType::INT64, DataType::INT64});
+  RowBatch input_rb(rd, data_size);
+  PX_CHECK_OK(input_rb.AddColumn(ToArrow(latencies, arrow::default_memory_pool())));
+  PX_CHECK_OK(input_rb.AddColumn(ToArrow(statuses, arrow::default_memory_pool())));
+
+  RowDescriptor rd_output({DataType::BOOLEAN});
+  auto function_ctx = std::make_unique<px::carnot::udf::FunctionContext>(nullptr, nullptr);
+  auto evaluator = ScalarExpressionEvaluator::Create({se}, eval_type, function_ctx.get());
+  PX_CHECK_OK(evaluator->Open(exec_state.get()));
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    RowBatch output_rb(rd_output, data_size);
+    PX_CHECK_OK(evaluator->Evaluate(exec_state.get(), input_rb, &output_rb));
+    benchmark::DoNotOptimize(output_rb);
+  }
+  PX_CHECK_OK(evaluator->Close(exec_state.get()));
+  state.SetItemsProcessed(int64_t(state.iterations()) * data_size);
+}
+
+BENCHMARK_CAPTURE(BM_ScalarExpressionPredicateTree, vector,
+                  ScalarExpressionEvaluatorType::kVectorNative)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 1 << 16);
+BENCHMARK_CAPTURE(BM_ScalarExpressionPredicateTree, arrow,
+                  ScalarExpressionEvaluatorType::kArrowNative)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 1 << 16);
+BENCHMARK_CAPTURE(BM_ScalarExpressionPredicateTree, fused, ScalarExpressionEvaluatorType::kFused)
+    ->RangeMultiplier(4)
+    ->Range(1 << 10, 1 << 16);
+
+// Filter on col0 < $0, keeping all three columns.
+constexpr char kFilterLessThanPbtxt[] = R"(
+expression {
+  func {
+    name: "lt"
+    id: 1
+    args {
+      column {
+        node: 0
+        index: 0
+      }
+    }
+    args {
+      constant {
+        data_type: INT64
+        int64_value: $0
+      }
+    }
+    args_data_types: INT64
+    args_data_types: INT64
+  }
+}
+columns {
+  node: 0
+  index: 0
+}
+columns {
+  node: 0
+  index: 1
+}
+columns {
+  node: 0
+  index: 2
+}
+)";
+
+// Map computing col1 + col2.
+constexpr char kMapAddPbtxt[] = R"(
+expressions {
+  func {
+    name: "add"
+    id: 0
+    args {
+      column {
+        node: 0
+        index: 1
+      }
+    }
+    args {
+      column {
+        node: 0
+        index: 2
+      }
+    }
+    args_data_types: INT64
+    args_data_types: INT64
+  }
+}
+column_names: "sum"
+)";
+
+// Runs a batch through filter -> map -> a sink that reads selections. With selections the
+// filter passes its input columns on with the indices of the passing rows; otherwise it copies the
+// passing rows of every column before the map runs.
+// NOLINTNEXTLINE : runtime/references.
+void BM_FilterThenMap(benchmark::State& state, bool use_selection) {
+  size_t data_size = state.range(0);
+  int64_t percent_selected = state.range(1);
+  bool fused = state.range(2) != 0;
+
+  auto func_registry = std::make_unique<Registry>("test_registry");
+  PX_CHECK_OK(func_registry->Register<AddUDF>("add"));
+  PX_CHECK_OK(func_registry->Register<LessThanUDF>("lt"));
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator, MockMetricsStubGenerator,
+      MockTraceStubGenerator, sole::uuid4(), nullptr);
+  std::vector<DataType> int_args({DataType::INT64, DataType::INT64});
+  PX_CHECK_OK(exec_state->AddScalarUDF(0, "add", int_args));
+  PX_CHECK_OK(exec_state->AddScalarUDF(1, "lt", int_args));
+
+  px::carnot::planpb::Operator filter_pb;
+  CHECK(google::protobuf::TextFormat::MergeFromString(
+      absl::Substitute(px::carnot::planpb::testutils::kOperatorProtoTmpl, "FILTER_OPERATOR",
+                       "filter_op", absl::Substitute(kFilterLessThanPbtxt, percent_selected)),
+      &filter_pb));
+  auto filter_op = px::carnot::plan::FilterOperator::FromProto(filter_pb, 1);
+  px::carnot::planpb::Operator map_pb;
+  CHECK(google::protobuf::TextFormat::MergeFromString(
+      absl::Substitute(px::carnot::planpb::testutils::kOperatorProtoTmpl, "MAP_OPERATOR", "map_op",
+                       kMapAddPbtxt),
+      &map_pb));
+  auto map_op = px::carnot::plan::MapOperator::FromProto(map_pb, 2);
+
+  std::default_random_engine rng(42);
+  std::uniform_int_distribution<int64_t> percent(0, 99);
+  std::vector<Int64Value> in0(data_size);
+  for (auto& val : in0) {
+    val = percent(rng);
+  }
+  auto in1 = px::datagen::CreateLargeData<Int64Value>(data_size);
+  auto in2 = px::datagen::CreateLargeData<Int64Value>(data_size);
+
+  RowDescriptor input_rd({DataType::INT64, DataType::INT64, DataType::INT64});
+  RowDescriptor output_rd({DataType::INT64});
+  RowBatch input_rb(input_rd, data_size);
+  PX_CHECK_OK(input_rb.AddColumn(ToArrow(in0, arrow::default_memory_pool())));
+  PX_CHECK_OK(input_rb.AddColumn(ToArrow(in1, arrow::default_memory_pool())));
+  PX_CHECK_OK(input_rb.AddColumn(ToArrow(in2, arrow::default_memory_pool())));
+
+  auto prev_density = FLAGS_carnot_filter_selection_min_density;
+  // A density above 1 makes the filter always compact.
+  FLAGS_carnot_filter_selection_min_density = use_selection ? 0.0 : 2.0;
+  auto prev_fused = FLAGS_carnot_fused_expressions;
+  FLAGS_carnot_fused_expressions = fused;
+
+  FakePlanNode fake_plan(3);
+  ::testing::NiceMock<MockExecNode> sink;
+  ON_CALL(sink, SupportsSelection()).WillByDefault(::testing::Return(true));
+  FilterNode filter;
+  MapNode map;
+  filter.AddChild(&map, 0);
+  map.AddChild(&sink, 0);
+  PX_CHECK_OK(filter.Init(*filter_op, input_rd, {input_rd}));
+  PX_CHECK_OK(map.Init(*map_op, output_rd, {input_rd}));
+  PX_CHECK_OK(sink.Init(fake_plan, RowDescriptor({}), {output_rd}));
+  for (px::carnot::exec::ExecNode* node : std::vector<px::carnot::exec::ExecNode*>{
+           &filter, &map, &sink}) {
+    PX_CHECK_OK(node->Prepare(exec_state.get()));
+    PX_CHECK_OK(node->Open(exec_state.get()));
+  }
+
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    PX_CHECK_OK(filter.ConsumeNext(exec_state.get(), input_rb, 0));
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * data_size);
+
+  PX_CHECK_OK(filter.Close(exec_state.get()));
+  PX_CHECK_OK(map.Close(exec_state.get()));
+  FLAGS_carnot_filter_selection_min_density = prev_density;
+  FLAGS_carnot_fused_expressions = prev_fused;
+}
+
+// Args are the number of rows, the percentage of them that pass the filter and whether the
+// expressions are fused.
+void FilterThenMapArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t num_rows : {1 << 10, 1 << 16}) {
+    for (int64_t percent_selected : {10, 50, 90}) {
+      for (int64_t fused : {0, 1}) {
+        b->Args({num_rows, percent_selected, fused});
+      }
+    }
+  }
+}
+
+BENCHMARK_CAPTURE(BM_FilterThenMap, compact, /*use_selection*/ false)->Apply(FilterThenMapArgs);
+BENCHMARK_CAPTURE(BM_FilterThenMap, selection, /*use_selection*/ true)->Apply(FilterThenMapArgs);
@@ -55,6 +55,7 @@ using udf::FunctionContext;
 
 class AddUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kAdd; }
   types::Int64Value Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
     return v1.val + v2.val;
   }
@@ -158,7 +159,8 @@ class ScalarExpressionTest : public ::testing::TestWithParam<ScalarExpressionEva
 
 INSTANTIATE_TEST_SUITE_P(TestVecAndArrow, ScalarExpressionTest,
                          ::testing::Values(ScalarExpressionEvaluatorType::kVectorNative,
-                                           ScalarExpressionEvaluatorType::kArrowNative));
+                                           ScalarExpressionEvaluatorType::kArrowNative,
+                                           ScalarExpressionEvaluatorType::kFused));
 
 TEST_P(ScalarExpressionTest, basic_tests) {
   RowDescriptor rd_output({types::DataType::INT64});
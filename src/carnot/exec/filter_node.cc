@@ -22,6 +22,7 @@
 #include <arrow/array/builder_binary.h>
 #include <arrow/memory_pool.h>
 #include <arrow/status.h>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -39,6 +40,11 @@
 #include "src/shared/types/types.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 
+DEFINE_double(carnot_filter_selection_min_density,
+              gflags::DoubleFromEnv("PL_CARNOT_FILTER_SELECTION_MIN_DENSITY", 0.25),
+              "The minimum fraction of rows of a batch that must pass a filter for the filter to "
+              "output a selection over its input, rather than copying out the passing rows.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -55,9 +61,53 @@ Status FilterNode::InitImpl(const plan::Operator& plan_node) {
   const auto* filter_plan_node = static_cast<const plan::FilterOperator*>(&plan_node);
   // copy the plan node to local object;
   plan_node_ = std::make_unique<plan::FilterOperator>(*filter_plan_node);
+  evaluate_outside_selection_ = CanEvaluateOutsideSelection(*plan_node_->expression());
+  InitDictionaryPredicate();
   return Status::OK();
 }
 
+void FilterNode::InitDictionaryPredicate() {
+  const auto& expr = *plan_node_->expression();
+  if (expr.ExpressionType() != plan::Expression::kFunc || input_descriptors_.size() != 1) {
+    return;
+  }
+  const auto& func = static_cast<const plan::ScalarFunc&>(expr);
+  const auto& args = func.arg_deps();
+  if ((func.name() != "equal" && func.name() != "notEqual") || args.size() != 2) {
+    return;
+  }
+  const plan::ScalarExpression* lhs = args[0].get();
+  const plan::ScalarExpression* rhs = args[1].get();
+  if (lhs->ExpressionType() == plan::Expression::kConstant) {
+    std::swap(lhs, rhs);
+  }
+  if (lhs->ExpressionType() != plan::Expression::kColumn ||
+      rhs->ExpressionType() != plan::Expression::kConstant) {
+    return;
+  }
+  const auto* col = static_cast<const plan::Column*>(lhs);
+  const auto* val = static_cast<const plan::ScalarValue*>(rhs);
+  const auto& input_desc = input_descriptors_[0];
+  if (col->Index() < 0 || col->Index() >= static_cast<int64_t>(input_desc.size()) ||
+      input_desc.type(col->Index()) != types::STRING || val->DataType() != types::STRING ||
+      val->IsNull()) {
+    return;
+  }
+  dictionary_predicate_ = DictionaryPredicate{col->Index(), val->StringValue(),
+                                              /* negated */ func.name() == "notEqual"};
+}
+
+const arrow::DictionaryArray* FilterNode::DictionaryPredicateColumn(const RowBatch& rb) const {
+  if (!dictionary_predicate_.has_value()) {
+    return nullptr;
+  }
+  const auto* col = rb.ColumnAt(dictionary_predicate_->col_idx).get();
+  if (col->type_id() != arrow::Type::DICTIONARY) {
+    return nullptr;
+  }
+  return static_cast<const arrow::DictionaryArray*>(col);
+}
+
 Status FilterNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
   evaluator_ = std::make_unique<VectorNativeScalarExpressionEvaluator>(
@@ -71,24 +121,22 @@ Status FilterNode::OpenImpl(ExecState* exec_state) {
 }
 
 Status FilterNode::CloseImpl(ExecState* exec_state) {
+  stats()->AddExtraMetric("selection_batches", num_selection_batches_);
+  stats()->AddExtraMetric("compacted_batches", num_compacted_batches_);
   PX_RETURN_IF_ERROR(evaluator_->Close(exec_state));
   return Status::OK();
 }
 
 template <types::DataType T>
-Status PredicateCopyValues(const types::BoolValueColumnWrapper& pred, const arrow::Array* input_col,
-                           RowBatch* output_rb) {
-  DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
-  size_t num_output_records = output_rb->num_rows();
-  size_t num_input_records = input_col->length();
-  auto output_col_builder_generic = MakeArrowBuilder(T, arrow::default_memory_pool());
+Status SelectionCopyValues(const std::vector<int64_t>& selection, const arrow::Array* input_col,
+                           arrow::MemoryPool* mem_pool, RowBatch* output_rb) {
+  DCHECK_EQ(selection.size(), static_cast<size_t>(output_rb->num_rows()));
+  auto output_col_builder_generic = MakeArrowBuilder(T, mem_pool);
   auto* output_col_builder = static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(
       output_col_builder_generic.get());
-  PX_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
-  for (size_t idx = 0; idx < num_input_records; ++idx) {
-    if (udf::UnWrap(pred[idx])) {
-      output_col_builder->UnsafeAppend(types::GetValueFromArrowArray<T>(input_col, idx));
-    }
+  PX_RETURN_IF_ERROR(output_col_builder->Reserve(selection.size()));
+  for (int64_t idx : selection) {
+    output_col_builder->UnsafeAppend(types::GetValueFromArrowArray<T>(input_col, idx));
   }
   std::shared_ptr<arrow::Array> output_array;
   PX_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
@@ -97,31 +145,28 @@ Status PredicateCopyValues(const types::BoolValueColumnWrapper& pred, const arro
 }
 
 template <>
-Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& pred,
-                                          const arrow::Array* input_col, RowBatch* output_rb) {
-  DCHECK_EQ(pred.Size(), static_cast<size_t>(input_col->length()));
-  size_t num_output_records = output_rb->num_rows();
-  size_t num_input_records = input_col->length();
+Status SelectionCopyValues<types::STRING>(const std::vector<int64_t>& selection,
+                                          const arrow::Array* input_col,
+                                          arrow::MemoryPool* mem_pool, RowBatch* output_rb) {
+  DCHECK_EQ(selection.size(), static_cast<size_t>(output_rb->num_rows()));
   size_t reserved =
       100;  // This can be an arbritrary number, since we do exponential doubling below.
   size_t total_size = 0;
 
-  auto output_col_builder_generic = MakeArrowBuilder(types::STRING, arrow::default_memory_pool());
+  auto output_col_builder_generic = MakeArrowBuilder(types::STRING, mem_pool);
   auto* output_col_builder = static_cast<types::DataTypeTraits<types::STRING>::arrow_builder_type*>(
       output_col_builder_generic.get());
 
-  PX_RETURN_IF_ERROR(output_col_builder->Reserve(num_output_records));
+  PX_RETURN_IF_ERROR(output_col_builder->Reserve(selection.size()));
   PX_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
-  for (size_t idx = 0; idx < num_input_records; ++idx) {
-    if (udf::UnWrap(pred[idx])) {
-      auto res = types::GetValueFromArrowArray<types::STRING>(input_col, idx);
-      total_size += res.size();
-      while (total_size >= reserved) {
-        reserved *= 2;
-      }
-      PX_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
-      output_col_builder->UnsafeAppend(std::move(res));
+  for (int64_t idx : selection) {
+    auto res = types::GetStringViewFromArrowArray(input_col, idx);
+    total_size += res.size();
+    while (total_size >= reserved) {
+      reserved *= 2;
     }
+    PX_RETURN_IF_ERROR(output_col_builder->ReserveData(reserved));
+    output_col_builder->UnsafeAppend(res.data(), static_cast<int32_t>(res.size()));
   }
   std::shared_ptr<arrow::Array> output_array;
   PX_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
@@ -130,39 +175,104 @@ Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& p
 }
 
 Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (rb.has_selection() && !evaluate_outside_selection_) {
+    // Parents compact the batches they send to this node (see SupportsSelection()), this covers
+    // batches that are consumed directly.
+    PX_ASSIGN_OR_RETURN(auto compacted_rb, rb.Compact(exec_state->exec_mem_pool()));
+    return FilterBatch(exec_state, *compacted_rb);
+  }
+  if (rb.HasDictionaryColumns() && DictionaryPredicateColumn(rb) == nullptr) {
+    PX_ASSIGN_OR_RETURN(auto decoded_rb, rb.DecodeDictionaryColumns(exec_state->exec_mem_pool()));
+    return FilterBatch(exec_state, *decoded_rb);
+  }
+  return FilterBatch(exec_state, rb);
+}
+
+Status FilterNode::FilterBatch(ExecState* exec_state, const RowBatch& rb) {
   // Current implementation does not merge across row batches, we should
   // consider this for cases where the filter has really low selectivity.
-  PX_ASSIGN_OR_RETURN(auto pred_col, evaluator_->EvaluateSingleExpression(
-                                         exec_state, rb, *plan_node_->expression()));
+  if (!predicate_compiled_) {
+    predicate_compiled_ = true;
+    if (FLAGS_carnot_fused_expressions) {
+      auto fused_or_s = FusedExpression::Compile(exec_state, *plan_node_->expression(), rb.desc());
+      if (fused_or_s.ok() && fused_or_s.ValueOrDie()->output_type() == types::BOOLEAN) {
+        fused_predicate_ = fused_or_s.ConsumeValueOrDie();
+      }
+    }
+  }
 
-  // Verify that the type of the column is boolean.
-  DCHECK_EQ(pred_col->data_type(), types::BOOLEAN) << "Predicate expression must be a boolean";
+  // The selection of the output holds the live input rows that satisfy the predicate.
+  auto selection = std::make_shared<std::vector<int64_t>>();
+  selection->reserve(rb.num_selected_rows());
+  if (const auto* dict_col = DictionaryPredicateColumn(rb); dict_col != nullptr) {
+    const auto* dictionary = dict_col->dictionary().get();
+    dictionary_passes_.resize(dictionary->length());
+    for (int64_t code = 0; code < dictionary->length(); ++code) {
+      bool equal =
+          types::GetStringViewFromArrowArray(dictionary, code) == dictionary_predicate_->value;
+      dictionary_passes_[code] = equal != dictionary_predicate_->negated;
+    }
+    for (int64_t i = 0; i < rb.num_selected_rows(); ++i) {
+      int64_t row = rb.SelectedRow(i);
+      if (dictionary_passes_[types::GetDictionaryCode(dict_col, row)]) {
+        selection->push_back(row);
+      }
+    }
+  } else if (fused_predicate_ != nullptr) {
+    fused_predicate_->EvaluateBool(rb, &fused_predicate_values_);
+    for (int64_t i = 0; i < rb.num_selected_rows(); ++i) {
+      int64_t row = rb.SelectedRow(i);
+      if (fused_predicate_values_[row]) {
+        selection->push_back(row);
+      }
+    }
+  } else {
+    PX_ASSIGN_OR_RETURN(auto pred_col, evaluator_->EvaluateSingleExpression(
+                                           exec_state, rb, *plan_node_->expression()));
+
+    // Verify that the type of the column is boolean.
+    DCHECK_EQ(pred_col->data_type(), types::BOOLEAN) << "Predicate expression must be a boolean";
 
-  const types::BoolValueColumnWrapper& pred_col_wrapper =
-      *static_cast<types::BoolValueColumnWrapper*>(pred_col.get());
-  size_t num_pred = pred_col_wrapper.Size();
+    const types::BoolValueColumnWrapper& pred_col_wrapper =
+        *static_cast<types::BoolValueColumnWrapper*>(pred_col.get());
+    size_t num_pred = pred_col_wrapper.Size();
 
-  DCHECK_EQ(static_cast<size_t>(rb.num_rows()), num_pred);
+    DCHECK_EQ(static_cast<size_t>(rb.num_rows()), num_pred);
 
-  // Find out how many of them returned true;
-  size_t num_output_records = 0;
-  for (size_t i = 0; i < num_pred; ++i) {
-    if (pred_col_wrapper[i].val) {
-      ++num_output_records;
+    for (int64_t i = 0; i < rb.num_selected_rows(); ++i) {
+      int64_t row = rb.SelectedRow(i);
+      if (udf::UnWrap(pred_col_wrapper[row])) {
+        selection->push_back(row);
+      }
     }
   }
 
-  RowBatch output_rb(*output_descriptor_, num_output_records);
   DCHECK_EQ(output_descriptor_->size(), plan_node_->selected_cols().size());
+  int64_t num_selected = static_cast<int64_t>(selection->size());
+  bool all_rows_selected = num_selected == rb.num_rows();
+  double density = rb.num_rows() == 0 ? 1.0 : static_cast<double>(num_selected) / rb.num_rows();
+  bool keep_selection = density >= FLAGS_carnot_filter_selection_min_density;
 
+  RowBatch output_rb(*output_descriptor_, keep_selection ? rb.num_rows() : num_selected);
   for (const auto& [output_col_idx, input_col_idx] : Enumerate(plan_node_->selected_cols())) {
     auto input_col = rb.ColumnAt(input_col_idx);
+    if (keep_selection) {
+      PX_RETURN_IF_ERROR(output_rb.AddColumn(input_col));
+      continue;
+    }
     auto col_type = output_descriptor_->type(output_col_idx);
-#define TYPE_CASE(_dt_) \
-  PX_RETURN_IF_ERROR(PredicateCopyValues<_dt_>(pred_col_wrapper, input_col.get(), &output_rb));
+#define TYPE_CASE(_dt_)                                                                      \
+  PX_RETURN_IF_ERROR(SelectionCopyValues<_dt_>(*selection, input_col.get(),                  \
+                                               exec_state->exec_mem_pool(), &output_rb));
     PX_SWITCH_FOREACH_DATATYPE(col_type, TYPE_CASE);
 #undef TYPE_CASE
   }
+  if (!keep_selection) {
+    ++num_compacted_batches_;
+  } else if (!all_rows_selected) {
+    output_rb.set_selection(std::move(selection));
+    ++num_selection_batches_;
+  }
 
   output_rb.set_eow(rb.eow());
   output_rb.set_eos(rb.eos());
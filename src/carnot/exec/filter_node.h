@@ -20,27 +20,47 @@
 
 #include <stddef.h>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include <arrow/array.h>
+
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/fused_expression.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/udf/base.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_double(carnot_filter_selection_min_density);
+
 namespace px {
 namespace carnot {
 namespace exec {
 
+/**
+ * FilterNode drops the rows of its input that don't satisfy its predicate.
+ *
+ * When enough of the input survives, the output shares the input's columns and only records the
+ * surviving rows in a selection (see RowBatch::selection()). Sparser outputs are compacted, so
+ * that downstream nodes don't keep processing mostly dead rows.
+ *
+ * A predicate that compares a STRING column with a constant (equal or notEqual) is evaluated on the
+ * dictionary of a dictionary encoded column, once per distinct value, and rows are then selected
+ * by their codes. Other predicates get their input's dictionary columns decoded.
+ */
 class FilterNode : public ProcessingNode {
  public:
   FilterNode() = default;
   virtual ~FilterNode() = default;
 
+  bool SupportsSelection() const override { return evaluate_outside_selection_; }
+  bool SupportsDictionaryColumns() const override { return true; }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -51,9 +71,37 @@ class FilterNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
+  Status FilterBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+
+  // A predicate `column == value`, or `column != value` if negated, on a STRING column.
+  struct DictionaryPredicate {
+    int64_t col_idx;
+    std::string value;
+    bool negated;
+  };
+  void InitDictionaryPredicate();
+  // The column of rb that dictionary_predicate_ can be evaluated on through its dictionary, or
+  // null if there is none.
+  const arrow::DictionaryArray* DictionaryPredicateColumn(
+      const table_store::schema::RowBatch& rb) const;
+
   std::unique_ptr<VectorNativeScalarExpressionEvaluator> evaluator_;
+  // The predicate compiled into a fused expression on the first batch, or null if it can't be
+  // fused, in which case evaluator_ evaluates it.
+  bool predicate_compiled_ = false;
+  std::unique_ptr<FusedExpression> fused_predicate_;
+  std::vector<uint8_t> fused_predicate_values_;
+  std::optional<DictionaryPredicate> dictionary_predicate_;
+  // Whether each value of the dictionary being filtered passes dictionary_predicate_, by code.
+  std::vector<uint8_t> dictionary_passes_;
   std::unique_ptr<plan::FilterOperator> plan_node_;
   std::unique_ptr<udf::FunctionContext> function_ctx_;
+  // Whether the predicate can be evaluated on rows outside of the input's selection, otherwise the
+  // input is compacted before it gets here.
+  bool evaluate_outside_selection_ = false;
+  // The number of output batches that carried a selection and that were compacted.
+  int64_t num_selection_batches_ = 0;
+  int64_t num_compacted_batches_ = 0;
 };
 
 }  // namespace exec
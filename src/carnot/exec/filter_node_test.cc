@@ -18,8 +18,13 @@
 
 #include "src/carnot/exec/filter_node.h"
 
+#include <memory>
+#include <vector>
+
+#include <google/protobuf/text_format.h>
 #include <sole.hpp>
 
+#include "src/carnot/exec/exec_node_mock.h"
 #include "src/carnot/exec/test_utils.h"
 #include "src/carnot/planpb/test_proto.h"
 #include "src/carnot/udf/registry.h"
@@ -52,12 +57,28 @@ class StrEqUDF : public udf::ScalarUDF {
   }
 };
 
+class StrNotEqUDF : public udf::ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::StringValue v1, types::StringValue v2) {
+    return v1 != v2;
+  }
+};
+
+class ModuloUDF : public udf::ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val % v2.val;
+  }
+};
+
 class FilterNodeTest : public ::testing::Test {
  public:
   FilterNodeTest() {
     func_registry_ = std::make_unique<udf::Registry>("test_registry");
     EXPECT_OK(func_registry_->Register<EqUDF>("eq"));
     EXPECT_OK(func_registry_->Register<StrEqUDF>("eq"));
+    EXPECT_OK(func_registry_->Register<StrNotEqUDF>("notEqual"));
+    EXPECT_OK(func_registry_->Register<ModuloUDF>("modulo"));
     auto table_store = std::make_shared<table_store::TableStore>();
 
     exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
@@ -67,6 +88,12 @@ class FilterNodeTest : public ::testing::Test {
         0, "eq", std::vector<types::DataType>({types::DataType::INT64, types::DataType::INT64})));
     EXPECT_OK(exec_state_->AddScalarUDF(
         1, "eq", std::vector<types::DataType>({types::DataType::STRING, types::DataType::STRING})));
+    EXPECT_OK(exec_state_->AddScalarUDF(
+        2, "modulo",
+        std::vector<types::DataType>({types::DataType::INT64, types::DataType::INT64})));
+    EXPECT_OK(exec_state_->AddScalarUDF(
+        3, "notEqual",
+        std::vector<types::DataType>({types::DataType::STRING, types::DataType::STRING})));
   }
 
  protected:
@@ -240,6 +267,236 @@ TEST_F(FilterNodeTest, child_fail) {
                                0, error::InvalidArgument("args"));
 }
 
+TEST_F(FilterNodeTest, input_selection) {
+  auto op_proto = planpb::testutils::CreateTestFilterTwoCols();
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd(
+      {types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+
+  // Rows 0 and 1 pass the predicate, but row 0 was already filtered out.
+  RowBatch input_rb = RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                          .AddColumn<types::Int64Value>({1, 1, 3, 4})
+                          .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                          .AddColumn<types::StringValue>({"ABC", "DEF", "HELLO", "WORLD"})
+                          .get();
+  input_rb.set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{1, 2}));
+
+  auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+      *plan_node_, output_rd, {input_rd}, exec_state_.get());
+  tester.ConsumeNext(input_rb, 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::Int64Value>({3})
+                          .AddColumn<types::StringValue>({"DEF"})
+                          .get())
+      .Close();
+}
+
+TEST_F(FilterNodeTest, selection_or_compact) {
+  auto op_proto = planpb::testutils::CreateTestFilterTwoCols();
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd(
+      {types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+
+  std::vector<RowBatch> outputs;
+  ::testing::NiceMock<MockExecNode> child;
+  ON_CALL(child, SupportsSelection()).WillByDefault(::testing::Return(true));
+  ON_CALL(child, ConsumeNextImpl(_, _, _))
+      .WillByDefault(::testing::Invoke([&](ExecState*, const RowBatch& rb, size_t) {
+        outputs.push_back(rb);
+        return Status::OK();
+      }));
+  FakePlanNode fake_plan(123);
+  ASSERT_OK(child.Init(fake_plan, RowDescriptor({}), {output_rd}));
+  ASSERT_OK(child.Prepare(exec_state_.get()));
+  ASSERT_OK(child.Open(exec_state_.get()));
+
+  FilterNode node;
+  node.AddChild(&child, 0);
+  ASSERT_OK(node.Init(*plan_node_, output_rd, {input_rd}));
+  ASSERT_OK(node.Prepare(exec_state_.get()));
+  ASSERT_OK(node.Open(exec_state_.get()));
+
+  auto prev_density = FLAGS_carnot_filter_selection_min_density;
+  FLAGS_carnot_filter_selection_min_density = 0.5;
+
+  // Half of the rows pass, so the input columns are passed on with a selection.
+  RowBatch dense_rb = RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                          .AddColumn<types::Int64Value>({1, 1, 3, 4})
+                          .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                          .AddColumn<types::StringValue>({"ABC", "DEF", "HELLO", "WORLD"})
+                          .get();
+  ASSERT_OK(node.ConsumeNext(exec_state_.get(), dense_rb, 0));
+  ASSERT_EQ(1ULL, outputs.size());
+  EXPECT_EQ(4, outputs[0].num_rows());
+  EXPECT_EQ(2, outputs[0].num_selected_rows());
+  EXPECT_EQ(std::vector<int64_t>({0, 1}), *outputs[0].selection());
+  EXPECT_EQ(dense_rb.ColumnAt(2), outputs[0].ColumnAt(2));
+
+  // A quarter of the rows pass, so they are copied out.
+  RowBatch sparse_rb = RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                           .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                           .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                           .AddColumn<types::StringValue>({"ABC", "DEF", "HELLO", "WORLD"})
+                           .get();
+  ASSERT_OK(node.ConsumeNext(exec_state_.get(), sparse_rb, 0));
+  ASSERT_EQ(2ULL, outputs.size());
+  EXPECT_FALSE(outputs[1].has_selection());
+  EXPECT_EQ(1, outputs[1].num_rows());
+  EXPECT_TRUE(outputs[1].eos());
+  EXPECT_EQ("ABC", types::GetValueFromArrowArray<types::STRING>(outputs[1].ColumnAt(2).get(), 0));
+
+  FLAGS_carnot_filter_selection_min_density = prev_density;
+  EXPECT_OK(node.Close(exec_state_.get()));
+}
+
+TEST_F(FilterNodeTest, modulo_after_filter) {
+  // df[df.b != 0] followed by df[df.a % df.b == 1]. The rows where b is 0 are outside of the
+  // selection and must not be evaluated.
+  constexpr char kModuloFilterPbtxt[] = R"(
+op_type: FILTER_OPERATOR
+filter_op {
+  expression {
+    func {
+      name: "eq"
+      id: 0
+      args {
+        func {
+          name: "modulo"
+          id: 2
+          args { column { node: 0 index: 0 } }
+          args { column { node: 0 index: 1 } }
+          args_data_types: INT64
+          args_data_types: INT64
+        }
+      }
+      args { constant { data_type: INT64 int64_value: 1 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  columns { node: 0 index: 0 }
+  columns { node: 0 index: 1 }
+  columns { node: 0 index: 2 }
+})";
+  planpb::Operator op_proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kModuloFilterPbtxt, &op_proto));
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd(
+      {types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+
+  RowBatch input_rb = RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                          .AddColumn<types::Int64Value>({7, 5, 8, 4})
+                          .AddColumn<types::Int64Value>({2, 0, 4, 0})
+                          .AddColumn<types::StringValue>({"ABC", "DEF", "HELLO", "WORLD"})
+                          .get();
+  input_rb.set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{0, 2}));
+
+  auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+      *plan_node_, output_rd, {input_rd}, exec_state_.get());
+  tester.ConsumeNext(input_rb, 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Int64Value>({7})
+                          .AddColumn<types::Int64Value>({2})
+                          .AddColumn<types::StringValue>({"ABC"})
+                          .get())
+      .Close();
+}
+
+TEST_F(FilterNodeTest, dictionary_string_pred) {
+  // The predicate is evaluated on the dictionary, and the column is passed on with its codes to a
+  // child that reads dictionary columns.
+  constexpr char kNotEqualFilterPbtxt[] = R"(
+op_type: FILTER_OPERATOR
+filter_op {
+  expression {
+    func {
+      name: "notEqual"
+      id: 3
+      args { constant { data_type: STRING string_value: "A" } }
+      args { column { node: 0 index: 0 } }
+      args_data_types: STRING
+      args_data_types: STRING
+    }
+  }
+  columns { node: 0 index: 0 }
+  columns { node: 0 index: 1 }
+})";
+  planpb::Operator op_proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kNotEqualFilterPbtxt, &op_proto));
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor rd({types::DataType::STRING, types::DataType::INT64});
+
+  std::vector<RowBatch> outputs;
+  ::testing::NiceMock<MockExecNode> child;
+  ON_CALL(child, SupportsSelection()).WillByDefault(::testing::Return(true));
+  ON_CALL(child, SupportsDictionaryColumns()).WillByDefault(::testing::Return(true));
+  ON_CALL(child, ConsumeNextImpl(_, _, _))
+      .WillByDefault(::testing::Invoke([&](ExecState*, const RowBatch& rb, size_t) {
+        outputs.push_back(rb);
+        return Status::OK();
+      }));
+  FakePlanNode fake_plan(123);
+  ASSERT_OK(child.Init(fake_plan, RowDescriptor({}), {rd}));
+  ASSERT_OK(child.Prepare(exec_state_.get()));
+  ASSERT_OK(child.Open(exec_state_.get()));
+
+  FilterNode node;
+  node.AddChild(&child, 0);
+  ASSERT_OK(node.Init(*plan_node_, rd, {rd}));
+  ASSERT_OK(node.Prepare(exec_state_.get()));
+  ASSERT_OK(node.Open(exec_state_.get()));
+
+  auto prev_density = FLAGS_carnot_filter_selection_min_density;
+  FLAGS_carnot_filter_selection_min_density = 0.5;
+
+  RowBatch input_rb = RowBatchBuilder(rd, 4, /*eow*/ true, /*eos*/ true)
+                          .AddDictionaryColumn({"A", "B", "A", "C"})
+                          .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                          .get();
+  ASSERT_OK(node.ConsumeNext(exec_state_.get(), input_rb, 0));
+  ASSERT_EQ(1ULL, outputs.size());
+  EXPECT_EQ(std::vector<int64_t>({1, 3}), *outputs[0].selection());
+  EXPECT_EQ(input_rb.ColumnAt(0), outputs[0].ColumnAt(0));
+
+  FLAGS_carnot_filter_selection_min_density = prev_density;
+  EXPECT_OK(node.Close(exec_state_.get()));
+}
+
+TEST_F(FilterNodeTest, dictionary_columns_decoded) {
+  // The UDF isn't one the filter evaluates on dictionaries, so the column is decoded first, and the
+  // output is decoded for a child that doesn't read dictionary columns.
+  auto op_proto = planpb::testutils::CreateTestFilterTwoColsString();
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd(
+      {types::DataType::STRING, types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+      *plan_node_, output_rd, {input_rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                       .AddDictionaryColumn({"A", "B", "A", "D"})
+                       .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                       .AddColumn<types::Int64Value>({2, 4, 7, 10})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::StringValue>({"A", "A"})
+                          .AddColumn<types::Int64Value>({1, 6})
+                          .AddColumn<types::Int64Value>({2, 7})
+                          .get())
+      .Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,484 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/fused_expression.h"
+
+#include <arrow/builder.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "src/carnot/udf/udf_definition.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using internal::FusedKernelFn;
+using internal::FusedPhysicalType;
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+namespace {
+
+StatusOr<FusedPhysicalType> ToPhysicalType(types::DataType data_type) {
+  switch (data_type) {
+    case types::BOOLEAN:
+      return FusedPhysicalType::kBool;
+    case types::INT64:
+    case types::TIME64NS:
+      return FusedPhysicalType::kInt64;
+    case types::FLOAT64:
+      return FusedPhysicalType::kFloat64;
+    default:
+      return error::Unimplemented("Values of type $0 can't be fused.",
+                                  types::ToString(data_type));
+  }
+}
+
+// The ops mirror the Exec functions of the builtin math UDFs that declare them, including the C++
+// promotion rules of their mixed type overloads.
+struct AddOp {
+  template <typename A, typename B>
+  static auto Apply(A a, B b) {
+    return a + b;
+  }
+};
+struct SubtractOp {
+  template <typename A, typename B>
+  static auto Apply(A a, B b) {
+    return a - b;
+  }
+};
+struct MultiplyOp {
+  template <typename A, typename B>
+  static auto Apply(A a, B b) {
+    return a * b;
+  }
+};
+struct DivideOp {
+  template <typename A, typename B>
+  static double Apply(A a, B b) {
+    return static_cast<double>(a) / static_cast<double>(b);
+  }
+};
+struct ModuloOp {
+  template <typename A, typename B>
+  static auto Apply(A a, B b) {
+    if constexpr (std::is_integral_v<A> && std::is_integral_v<B>) {
+      return a % b;
+    } else {
+      return std::fmod(a, b);
+    }
+  }
+};
+struct EqualOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a == b;
+  }
+};
+struct NotEqualOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a != b;
+  }
+};
+struct LessThanOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a < b;
+  }
+};
+struct LessThanEqualOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a <= b;
+  }
+};
+struct GreaterThanOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a > b;
+  }
+};
+struct GreaterThanEqualOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a >= b;
+  }
+};
+struct LogicalAndOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a && b;
+  }
+};
+struct LogicalOrOp {
+  template <typename A, typename B>
+  static bool Apply(A a, B b) {
+    return a || b;
+  }
+};
+struct NegateOp {
+  template <typename A>
+  static auto Apply(A a) {
+    return -a;
+  }
+};
+struct LogicalNotOp {
+  template <typename A>
+  static bool Apply(A a) {
+    return !a;
+  }
+};
+
+// The kernels are simple loops over the values of a chunk, which the compiler vectorizes.
+template <typename TOp, typename TLhs, typename TRhs, typename TOut>
+void BinaryKernel(const void* lhs, const void* rhs, void* out, int64_t n) {
+  const auto* lhs_values = static_cast<const TLhs*>(lhs);
+  const auto* rhs_values = static_cast<const TRhs*>(rhs);
+  auto* out_values = static_cast<TOut*>(out);
+  for (int64_t i = 0; i < n; ++i) {
+    out_values[i] = static_cast<TOut>(TOp::Apply(lhs_values[i], rhs_values[i]));
+  }
+}
+
+template <typename TOp, typename TArg, typename TOut>
+void UnaryKernel(const void* arg, const void*, void* out, int64_t n) {
+  const auto* arg_values = static_cast<const TArg*>(arg);
+  auto* out_values = static_cast<TOut*>(out);
+  for (int64_t i = 0; i < n; ++i) {
+    out_values[i] = static_cast<TOut>(TOp::Apply(arg_values[i]));
+  }
+}
+
+// Calls fn with a value of the C++ type that holds values of the physical type.
+template <typename TFn>
+FusedKernelFn DispatchPhysicalType(FusedPhysicalType type, TFn fn) {
+  switch (type) {
+    case FusedPhysicalType::kBool:
+      return fn(uint8_t{});
+    case FusedPhysicalType::kInt64:
+      return fn(int64_t{});
+    case FusedPhysicalType::kFloat64:
+      return fn(double{});
+  }
+  return nullptr;
+}
+
+template <typename TOp>
+FusedKernelFn SelectBinaryKernel(FusedPhysicalType lhs, FusedPhysicalType rhs,
+                                 FusedPhysicalType out) {
+  return DispatchPhysicalType(lhs, [&](auto lhs_value) {
+    return DispatchPhysicalType(rhs, [&](auto rhs_value) {
+      return DispatchPhysicalType(out, [&](auto out_value) -> FusedKernelFn {
+        return &BinaryKernel<TOp, decltype(lhs_value), decltype(rhs_value), decltype(out_value)>;
+      });
+    });
+  });
+}
+
+template <typename TOp>
+FusedKernelFn SelectUnaryKernel(FusedPhysicalType arg, FusedPhysicalType out) {
+  return DispatchPhysicalType(arg, [&](auto arg_value) {
+    return DispatchPhysicalType(out, [&](auto out_value) -> FusedKernelFn {
+      return &UnaryKernel<TOp, decltype(arg_value), decltype(out_value)>;
+    });
+  });
+}
+
+StatusOr<FusedKernelFn> SelectKernel(udf::FusedOp op, const std::vector<FusedPhysicalType>& args,
+                                     FusedPhysicalType out) {
+  bool unary = op == udf::FusedOp::kNegate || op == udf::FusedOp::kLogicalNot;
+  if (args.size() != (unary ? 1UL : 2UL)) {
+    return error::Internal("Fused op $0 got $1 args.", static_cast<int>(op), args.size());
+  }
+  switch (op) {
+    case udf::FusedOp::kAdd:
+      return SelectBinaryKernel<AddOp>(args[0], args[1], out);
+    case udf::FusedOp::kSubtract:
+      return SelectBinaryKernel<SubtractOp>(args[0], args[1], out);
+    case udf::FusedOp::kMultiply:
+      return SelectBinaryKernel<MultiplyOp>(args[0], args[1], out);
+    case udf::FusedOp::kDivide:
+      return SelectBinaryKernel<DivideOp>(args[0], args[1], out);
+    case udf::FusedOp::kModulo:
+      return SelectBinaryKernel<ModuloOp>(args[0], args[1], out);
+    case udf::FusedOp::kEqual:
+      return SelectBinaryKernel<EqualOp>(args[0], args[1], out);
+    case udf::FusedOp::kNotEqual:
+      return SelectBinaryKernel<NotEqualOp>(args[0], args[1], out);
+    case udf::FusedOp::kLessThan:
+      return SelectBinaryKernel<LessThanOp>(args[0], args[1], out);
+    case udf::FusedOp::kLessThanEqual:
+      return SelectBinaryKernel<LessThanEqualOp>(args[0], args[1], out);
+    case udf::FusedOp::kGreaterThan:
+      return SelectBinaryKernel<GreaterThanOp>(args[0], args[1], out);
+    case udf::FusedOp::kGreaterThanEqual:
+      return SelectBinaryKernel<GreaterThanEqualOp>(args[0], args[1], out);
+    case udf::FusedOp::kLogicalAnd:
+      return SelectBinaryKernel<LogicalAndOp>(args[0], args[1], out);
+    case udf::FusedOp::kLogicalOr:
+      return SelectBinaryKernel<LogicalOrOp>(args[0], args[1], out);
+    case udf::FusedOp::kNegate:
+      return SelectUnaryKernel<NegateOp>(args[0], out);
+    case udf::FusedOp::kLogicalNot:
+      return SelectUnaryKernel<LogicalNotOp>(args[0], out);
+    case udf::FusedOp::kNone:
+      break;
+  }
+  return error::Unimplemented("Fused op $0 has no kernel.", static_cast<int>(op));
+}
+
+}  // namespace
+
+void* FusedExpression::Node::storage() {
+  switch (type) {
+    case FusedPhysicalType::kBool:
+      return bool_storage.data();
+    case FusedPhysicalType::kInt64:
+      return int_storage.data();
+    case FusedPhysicalType::kFloat64:
+      return float_storage.data();
+  }
+  return nullptr;
+}
+
+StatusOr<std::unique_ptr<FusedExpression>> FusedExpression::Compile(
+    ExecState* exec_state, const plan::ScalarExpression& expr, const RowDescriptor& input_desc) {
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    // Columns and constants are cheaper to pass through than to copy.
+    return error::Unimplemented("Only functions are fused.");
+  }
+  std::unique_ptr<FusedExpression> fused(new FusedExpression());
+  PX_RETURN_IF_ERROR(fused->AddNode(exec_state, expr, input_desc));
+  fused->AllocateStorage();
+  return fused;
+}
+
+StatusOr<int64_t> FusedExpression::AddNode(ExecState* exec_state,
+                                           const plan::ScalarExpression& expr,
+                                           const RowDescriptor& input_desc) {
+  Node node;
+  switch (expr.ExpressionType()) {
+    case plan::Expression::kColumn: {
+      const auto& col = static_cast<const plan::Column&>(expr);
+      if (col.Index() < 0 || col.Index() >= static_cast<int64_t>(input_desc.size())) {
+        return error::InvalidArgument("Column $0 is out of range.", col.Index());
+      }
+      node.kind = Node::Kind::kColumn;
+      node.col_idx = col.Index();
+      node.data_type = input_desc.type(col.Index());
+      PX_ASSIGN_OR_RETURN(node.type, ToPhysicalType(node.data_type));
+      break;
+    }
+    case plan::Expression::kConstant: {
+      const auto& val = static_cast<const plan::ScalarValue&>(expr);
+      if (val.IsNull()) {
+        return error::Unimplemented("Null constants can't be fused.");
+      }
+      node.kind = Node::Kind::kConstant;
+      node.data_type = val.DataType();
+      PX_ASSIGN_OR_RETURN(node.type, ToPhysicalType(node.data_type));
+      switch (node.data_type) {
+        case types::BOOLEAN:
+          node.bool_storage.assign(kChunkSize, val.BoolValue());
+          break;
+        case types::INT64:
+          node.int_storage.assign(kChunkSize, val.Int64Value());
+          break;
+        case types::TIME64NS:
+          node.int_storage.assign(kChunkSize, val.Time64NSValue());
+          break;
+        case types::FLOAT64:
+          node.float_storage.assign(kChunkSize, val.Float64Value());
+          break;
+        default:
+          break;
+      }
+      break;
+    }
+    case plan::Expression::kFunc: {
+      const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+      auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
+      if (def == nullptr || def->fused_op() == udf::FusedOp::kNone) {
+        return error::Unimplemented("Function $0 can't be fused.", fn.name());
+      }
+      if (!fn.init_arguments().empty()) {
+        return error::Unimplemented("Function $0 has init args and can't be fused.", fn.name());
+      }
+      std::vector<FusedPhysicalType> arg_types;
+      std::vector<int64_t> args;
+      for (const auto& arg : fn.arg_deps()) {
+        PX_ASSIGN_OR_RETURN(int64_t arg_idx, AddNode(exec_state, *arg, input_desc));
+        args.push_back(arg_idx);
+        arg_types.push_back(nodes_[arg_idx].type);
+      }
+      node.kind = Node::Kind::kKernel;
+      node.data_type = def->exec_return_type();
+      PX_ASSIGN_OR_RETURN(node.type, ToPhysicalType(node.data_type));
+      PX_ASSIGN_OR_RETURN(node.kernel, SelectKernel(def->fused_op(), arg_types, node.type));
+      node.lhs = args[0];
+      node.rhs = args.size() > 1 ? args[1] : -1;
+      break;
+    }
+    default:
+      return error::Unimplemented("Expression can't be fused.");
+  }
+  nodes_.push_back(std::move(node));
+  return static_cast<int64_t>(nodes_.size()) - 1;
+}
+
+void FusedExpression::AllocateStorage() {
+  for (auto& node : nodes_) {
+    switch (node.kind) {
+      case Node::Kind::kConstant:
+        node.values = node.storage();
+        break;
+      case Node::Kind::kColumn:
+        // Only boolean columns are copied, to unpack their bits into bytes.
+        if (node.type == FusedPhysicalType::kBool) {
+          node.bool_storage.resize(kChunkSize);
+        }
+        break;
+      case Node::Kind::kKernel:
+        switch (node.type) {
+          case FusedPhysicalType::kBool:
+            node.bool_storage.resize(kChunkSize);
+            break;
+          case FusedPhysicalType::kInt64:
+            node.int_storage.resize(kChunkSize);
+            break;
+          case FusedPhysicalType::kFloat64:
+            node.float_storage.resize(kChunkSize);
+            break;
+        }
+        break;
+    }
+  }
+}
+
+void FusedExpression::BindColumns(const RowBatch& input) {
+  for (auto& node : nodes_) {
+    if (node.kind != Node::Kind::kColumn) {
+      continue;
+    }
+    const arrow::Array* arr = input.ColumnAt(node.col_idx).get();
+    switch (node.type) {
+      case FusedPhysicalType::kBool:
+        node.bool_column = static_cast<const arrow::BooleanArray*>(arr);
+        break;
+      case FusedPhysicalType::kInt64:
+        node.column_base = arr->data()->GetValues<int64_t>(1);
+        break;
+      case FusedPhysicalType::kFloat64:
+        node.column_base = arr->data()->GetValues<double>(1);
+        break;
+    }
+  }
+}
+
+const void* FusedExpression::EvaluateChunk(int64_t offset, int64_t n) {
+  for (auto& node : nodes_) {
+    switch (node.kind) {
+      case Node::Kind::kConstant:
+        break;
+      case Node::Kind::kColumn:
+        switch (node.type) {
+          case FusedPhysicalType::kBool:
+            for (int64_t i = 0; i < n; ++i) {
+              node.bool_storage[i] = node.bool_column->Value(offset + i);
+            }
+            node.values = node.bool_storage.data();
+            break;
+          case FusedPhysicalType::kInt64:
+            node.values = static_cast<const int64_t*>(node.column_base) + offset;
+            break;
+          case FusedPhysicalType::kFloat64:
+            node.values = static_cast<const double*>(node.column_base) + offset;
+            break;
+        }
+        break;
+      case Node::Kind::kKernel: {
+        void* out = node.storage();
+        node.kernel(nodes_[node.lhs].values, node.rhs < 0 ? nullptr : nodes_[node.rhs].values, out,
+                    n);
+        node.values = out;
+        break;
+      }
+    }
+  }
+  return nodes_.back().values;
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> FusedExpression::Evaluate(const RowBatch& input,
+                                                                  arrow::MemoryPool* mem_pool) {
+  types::DataType out_type = output_type();
+  auto builder = types::MakeArrowBuilder(out_type, mem_pool);
+  PX_RETURN_IF_ERROR(builder->Reserve(input.num_rows()));
+
+  BindColumns(input);
+  for (int64_t offset = 0; offset < input.num_rows(); offset += kChunkSize) {
+    int64_t n = std::min(kChunkSize, input.num_rows() - offset);
+    const void* values = EvaluateChunk(offset, n);
+    switch (out_type) {
+      case types::BOOLEAN:
+        PX_RETURN_IF_ERROR(static_cast<arrow::BooleanBuilder*>(builder.get())
+                               ->AppendValues(static_cast<const uint8_t*>(values), n));
+        break;
+      case types::INT64:
+        PX_RETURN_IF_ERROR(static_cast<arrow::Int64Builder*>(builder.get())
+                               ->AppendValues(static_cast<const int64_t*>(values), n));
+        break;
+      case types::TIME64NS:
+        PX_RETURN_IF_ERROR(
+            static_cast<types::DataTypeTraits<types::TIME64NS>::arrow_builder_type*>(builder.get())
+                ->AppendValues(static_cast<const int64_t*>(values), n));
+        break;
+      case types::FLOAT64:
+        PX_RETURN_IF_ERROR(static_cast<arrow::DoubleBuilder*>(builder.get())
+                               ->AppendValues(static_cast<const double*>(values), n));
+        break;
+      default:
+        return error::Internal("Unexpected fused output type $0.", types::ToString(out_type));
+    }
+  }
+
+  std::shared_ptr<arrow::Array> output;
+  PX_RETURN_IF_ERROR(builder->Finish(&output));
+  return output;
+}
+
+void FusedExpression::EvaluateBool(const RowBatch& input, std::vector<uint8_t>* out) {
+  DCHECK_EQ(output_type(), types::BOOLEAN);
+  out->resize(input.num_rows());
+  BindColumns(input);
+  for (int64_t offset = 0; offset < input.num_rows(); offset += kChunkSize) {
+    int64_t n = std::min(kChunkSize, input.num_rows() - offset);
+    std::memcpy(out->data() + offset, EvaluateChunk(offset, n), n);
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
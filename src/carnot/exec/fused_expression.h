@@ -0,0 +1,127 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/scalar_expression.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+#include "src/table_store/schema/row_descriptor.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace internal {
+
+// The representation of the values of a fused expression node while it is evaluated: booleans are
+// one byte per value, and integers and times are int64_t.
+enum class FusedPhysicalType : uint8_t {
+  kBool,
+  kInt64,
+  kFloat64,
+};
+
+// Computes n values of a node from the values of its args. rhs is null for unary ops.
+using FusedKernelFn = void (*)(const void* lhs, const void* rhs, void* out, int64_t n);
+
+}  // namespace internal
+
+/**
+ * A FusedExpression evaluates an arithmetic, comparison and boolean expression tree over fixed
+ * width columns without calling its UDFs, and without materializing intermediate results as arrow
+ * arrays. The tree is compiled into a flat program of typed kernels that is run over the rows of a
+ * batch in chunks of kChunkSize, so that the intermediate values of a chunk stay in cache.
+ *
+ * Only functions whose UDF declares a udf::FusedOp can be fused. Compile returns an error for any
+ * other expression, so that the caller can fall back to evaluating it with its UDFs.
+ */
+class FusedExpression {
+ public:
+  static constexpr int64_t kChunkSize = 1024;
+
+  /**
+   * Compiles the expression for batches described by input_desc.
+   */
+  static StatusOr<std::unique_ptr<FusedExpression>> Compile(
+      ExecState* exec_state, const plan::ScalarExpression& expr,
+      const table_store::schema::RowDescriptor& input_desc);
+
+  types::DataType output_type() const { return nodes_.back().data_type; }
+
+  /**
+   * Evaluates the expression for every row of the input.
+   */
+  StatusOr<std::shared_ptr<arrow::Array>> Evaluate(const table_store::schema::RowBatch& input,
+                                                   arrow::MemoryPool* mem_pool);
+
+  /**
+   * Evaluates a boolean expression for every row of the input, into one byte per row.
+   */
+  void EvaluateBool(const table_store::schema::RowBatch& input, std::vector<uint8_t>* out);
+
+ private:
+  // A node of the compiled program. Nodes are stored in post order, so the args of a node are
+  // always evaluated before it and the root is the last node.
+  struct Node {
+    enum class Kind : uint8_t { kColumn, kConstant, kKernel };
+    Kind kind;
+    types::DataType data_type;
+    internal::FusedPhysicalType type;
+    // The input column of column nodes.
+    int64_t col_idx = -1;
+    // The args and kernel of kernel nodes.
+    int64_t lhs = -1;
+    int64_t rhs = -1;
+    internal::FusedKernelFn kernel = nullptr;
+
+    // The values of the node for the current chunk. Fixed width columns point into the input
+    // array, everything else points into its storage below.
+    const void* values = nullptr;
+    const void* column_base = nullptr;
+    const arrow::BooleanArray* bool_column = nullptr;
+    std::vector<uint8_t> bool_storage;
+    std::vector<int64_t> int_storage;
+    std::vector<double> float_storage;
+
+    void* storage();
+  };
+
+  FusedExpression() = default;
+
+  StatusOr<int64_t> AddNode(ExecState* exec_state, const plan::ScalarExpression& expr,
+                            const table_store::schema::RowDescriptor& input_desc);
+  void AllocateStorage();
+  void BindColumns(const table_store::schema::RowBatch& input);
+  // Evaluates the chunk of rows [offset, offset + n), and returns the values of the root.
+  const void* EvaluateChunk(int64_t offset, int64_t n);
+
+  std::vector<Node> nodes_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
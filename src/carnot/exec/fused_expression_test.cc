@@ -0,0 +1,277 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/fused_expression.h"
+
+#include <arrow/memory_pool.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+#include <sole.hpp>
+
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/plan/scalar_expression.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/carnot/udf/registry.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+using types::ToArrow;
+using udf::FunctionContext;
+
+class LessThanUDF : public udf::ScalarUDF {
+ public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kLessThan; }
+  types::BoolValue Exec(FunctionContext*, types::Int64Value v1, types::Float64Value v2) {
+    return v1.val < v2.val;
+  }
+};
+
+class DivideUDF : public udf::ScalarUDF {
+ public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kDivide; }
+  types::Float64Value Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return static_cast<double>(v1.val) / static_cast<double>(v2.val);
+  }
+};
+
+class AndUDF : public udf::ScalarUDF {
+ public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kLogicalAnd; }
+  types::BoolValue Exec(FunctionContext*, types::BoolValue v1, types::BoolValue v2) {
+    return v1.val && v2.val;
+  }
+};
+
+class NotUDF : public udf::ScalarUDF {
+ public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kLogicalNot; }
+  types::BoolValue Exec(FunctionContext*, types::BoolValue v1) { return !v1.val; }
+};
+
+class SubtractUDF : public udf::ScalarUDF {
+ public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kSubtract; }
+  types::Time64NSValue Exec(FunctionContext*, types::Time64NSValue v1, types::Int64Value v2) {
+    return v1.val - v2.val;
+  }
+};
+
+class LengthUDF : public udf::ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::StringValue v1) {
+    return static_cast<int64_t>(v1.size());
+  }
+};
+
+// not(col2) and (col0 < col1)
+constexpr char kBoolExprPbtxt[] = R"pb(
+func {
+  name: "and"
+  id: 2
+  args {
+    func {
+      name: "not"
+      id: 3
+      args { column { index: 2 } }
+      args_data_types: BOOLEAN
+    }
+  }
+  args {
+    func {
+      name: "lessThan"
+      id: 0
+      args { column { index: 0 } }
+      args { column { index: 1 } }
+      args_data_types: INT64
+      args_data_types: FLOAT64
+    }
+  }
+  args_data_types: BOOLEAN
+  args_data_types: BOOLEAN
+})pb";
+
+// col0 / 3
+constexpr char kDivideExprPbtxt[] = R"pb(
+func {
+  name: "divide"
+  id: 1
+  args { column { index: 0 } }
+  args { constant { data_type: INT64 int64_value: 3 } }
+  args_data_types: INT64
+  args_data_types: INT64
+})pb";
+
+// col3 - 10
+constexpr char kSubtractTimeExprPbtxt[] = R"pb(
+func {
+  name: "subtract"
+  id: 4
+  args { column { index: 3 } }
+  args { constant { data_type: INT64 int64_value: 10 } }
+  args_data_types: TIME64NS
+  args_data_types: INT64
+})pb";
+
+// length(col4) < col1
+constexpr char kUnfusableExprPbtxt[] = R"pb(
+func {
+  name: "lessThan"
+  id: 0
+  args {
+    func {
+      name: "length"
+      id: 5
+      args { column { index: 4 } }
+      args_data_types: STRING
+    }
+  }
+  args { column { index: 1 } }
+  args_data_types: INT64
+  args_data_types: FLOAT64
+})pb";
+
+std::unique_ptr<plan::ScalarExpression> ExprOf(const std::string& pbtxt) {
+  planpb::ScalarExpression se_pb;
+  EXPECT_TRUE(google::protobuf::TextFormat::MergeFromString(pbtxt, &se_pb));
+  auto s_or_se = plan::ScalarExpression::FromProto(se_pb);
+  EXPECT_OK(s_or_se);
+  return s_or_se.ConsumeValueOrDie();
+}
+
+class FusedExpressionTest : public ::testing::Test {
+ protected:
+  // Spans several chunks, and ends with a partial one.
+  static constexpr int64_t kNumRows = 2 * FusedExpression::kChunkSize + 123;
+
+  void SetUp() override {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    ASSERT_OK(func_registry_->Register<LessThanUDF>("lessThan"));
+    ASSERT_OK(func_registry_->Register<DivideUDF>("divide"));
+    ASSERT_OK(func_registry_->Register<AndUDF>("and"));
+    ASSERT_OK(func_registry_->Register<NotUDF>("not"));
+    ASSERT_OK(func_registry_->Register<SubtractUDF>("subtract"));
+    ASSERT_OK(func_registry_->Register<LengthUDF>("length"));
+    exec_state_ = std::make_unique<ExecState>(
+        func_registry_.get(), std::make_shared<table_store::TableStore>(),
+        MockResultSinkStubGenerator, MockMetricsStubGenerator, MockTraceStubGenerator,
+        sole::uuid4(), nullptr);
+    ASSERT_OK(exec_state_->AddScalarUDF(0, "lessThan", {types::INT64, types::FLOAT64}));
+    ASSERT_OK(exec_state_->AddScalarUDF(1, "divide", {types::INT64, types::INT64}));
+    ASSERT_OK(exec_state_->AddScalarUDF(2, "and", {types::BOOLEAN, types::BOOLEAN}));
+    ASSERT_OK(exec_state_->AddScalarUDF(3, "not", {types::BOOLEAN}));
+    ASSERT_OK(exec_state_->AddScalarUDF(4, "subtract", {types::TIME64NS, types::INT64}));
+    ASSERT_OK(exec_state_->AddScalarUDF(5, "length", {types::STRING}));
+
+    std::vector<types::Int64Value> ints;
+    std::vector<types::Float64Value> floats;
+    std::vector<types::BoolValue> bools;
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::StringValue> strs;
+    for (int64_t i = 0; i < kNumRows; ++i) {
+      ints.emplace_back(i % 100);
+      floats.emplace_back(i % 37 + 0.5);
+      bools.emplace_back(i % 3 == 0);
+      times.emplace_back(i * 1000);
+      strs.emplace_back(std::string(i % 5, 'a'));
+    }
+    RowDescriptor rd({types::INT64, types::FLOAT64, types::BOOLEAN, types::TIME64NS,
+                      types::STRING});
+    input_rb_ = std::make_unique<RowBatch>(rd, kNumRows);
+    auto pool = arrow::default_memory_pool();
+    ASSERT_OK(input_rb_->AddColumn(ToArrow(ints, pool)));
+    ASSERT_OK(input_rb_->AddColumn(ToArrow(floats, pool)));
+    ASSERT_OK(input_rb_->AddColumn(ToArrow(bools, pool)));
+    ASSERT_OK(input_rb_->AddColumn(ToArrow(times, pool)));
+    ASSERT_OK(input_rb_->AddColumn(ToArrow(strs, pool)));
+  }
+
+  StatusOr<std::unique_ptr<FusedExpression>> Compile(const std::string& pbtxt) {
+    auto expr = ExprOf(pbtxt);
+    return FusedExpression::Compile(exec_state_.get(), *expr, input_rb_->desc());
+  }
+
+  std::unique_ptr<udf::Registry> func_registry_;
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<RowBatch> input_rb_;
+};
+
+TEST_F(FusedExpressionTest, boolean_and_comparison) {
+  ASSERT_OK_AND_ASSIGN(auto fused, Compile(kBoolExprPbtxt));
+  EXPECT_EQ(types::BOOLEAN, fused->output_type());
+
+  ASSERT_OK_AND_ASSIGN(auto out, fused->Evaluate(*input_rb_, arrow::default_memory_pool()));
+  ASSERT_EQ(kNumRows, out->length());
+  auto casted = static_cast<arrow::BooleanArray*>(out.get());
+
+  std::vector<uint8_t> out_bytes;
+  fused->EvaluateBool(*input_rb_, &out_bytes);
+  ASSERT_EQ(static_cast<size_t>(kNumRows), out_bytes.size());
+
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    bool expected = !(i % 3 == 0) && (i % 100 < i % 37 + 0.5);
+    EXPECT_EQ(expected, casted->Value(i)) << i;
+    EXPECT_EQ(expected, out_bytes[i] != 0) << i;
+  }
+}
+
+TEST_F(FusedExpressionTest, divide_by_constant) {
+  ASSERT_OK_AND_ASSIGN(auto fused, Compile(kDivideExprPbtxt));
+  EXPECT_EQ(types::FLOAT64, fused->output_type());
+
+  ASSERT_OK_AND_ASSIGN(auto out, fused->Evaluate(*input_rb_, arrow::default_memory_pool()));
+  ASSERT_EQ(kNumRows, out->length());
+  auto casted = static_cast<arrow::DoubleArray*>(out.get());
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    EXPECT_DOUBLE_EQ((i % 100) / 3.0, casted->Value(i)) << i;
+  }
+}
+
+TEST_F(FusedExpressionTest, time_output) {
+  ASSERT_OK_AND_ASSIGN(auto fused, Compile(kSubtractTimeExprPbtxt));
+  EXPECT_EQ(types::TIME64NS, fused->output_type());
+
+  ASSERT_OK_AND_ASSIGN(auto out, fused->Evaluate(*input_rb_, arrow::default_memory_pool()));
+  ASSERT_EQ(kNumRows, out->length());
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    EXPECT_EQ(i * 1000 - 10, types::GetValueFromArrowArray<types::TIME64NS>(out.get(), i)) << i;
+  }
+}
+
+TEST_F(FusedExpressionTest, unfusable_expressions) {
+  // A function that doesn't declare a fused op.
+  EXPECT_NOT_OK(Compile(kUnfusableExprPbtxt));
+  // Bare columns and constants are left to the other evaluators.
+  EXPECT_NOT_OK(Compile("column { index: 0 }"));
+  EXPECT_NOT_OK(Compile("constant { data_type: INT64 int64_value: 1 }"));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
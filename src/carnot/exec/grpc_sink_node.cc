@@ -304,8 +304,15 @@ Status GRPCSinkNode::SplitAndSendBatch(ExecState* exec_state, const RowBatch& rb
 
 Status GRPCSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t parent_idx) {
   if (rb.NumBytes() > (max_batch_size_ * batch_size_factor_)) {
+    if (rb.has_selection()) {
+      // Splitting works on whole columns, so drop the filtered out rows first. They may well have
+      // been what made the batch too big.
+      PX_ASSIGN_OR_RETURN(auto compacted_rb, rb.Compact(exec_state->exec_mem_pool()));
+      return ConsumeNextImpl(exec_state, *compacted_rb, parent_idx);
+    }
     return SplitAndSendBatch(exec_state, rb, parent_idx);
   }
+  // Serializing the batch only writes out its selected rows.
   return ConsumeNextImplNoSplit(exec_state, rb, parent_idx);
 }
 
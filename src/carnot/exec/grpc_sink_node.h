@@ -58,6 +58,8 @@ class GRPCSinkNode : public SinkNode {
   GRPCSinkNode() : GRPCSinkNode(kMaxBatchSize, kBatchSizeFactor) {}
   virtual ~GRPCSinkNode() = default;
 
+  bool SupportsSelection() const override { return true; }
+
   // Used to check the downstream connection after connection_check_timeout_ has elapsed.
   Status OptionallyCheckConnection(ExecState* exec_state);
 
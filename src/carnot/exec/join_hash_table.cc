@@ -0,0 +1,293 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/join_hash_table.h"
+
+#include <algorithm>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include "src/carnot/exec/agg_hash_table.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+template <types::DataType DT>
+bool ValueEquals(const arrow::Array* a, int64_t a_row, const arrow::Array* b, int64_t b_row) {
+  if constexpr (DT == types::DataType::STRING) {
+    return types::GetStringViewFromArrowArray(a, a_row) ==
+           types::GetStringViewFromArrowArray(b, b_row);
+  } else {
+    using ArrowArrayType = typename types::DataTypeTraits<DT>::arrow_array_type;
+    return types::GetValue(static_cast<const ArrowArrayType*>(a), a_row) ==
+           types::GetValue(static_cast<const ArrowArrayType*>(b), b_row);
+  }
+}
+
+int64_t NextPowerOf2(int64_t n) {
+  int64_t pow2 = 1;
+  while (pow2 < n) {
+    pow2 <<= 1;
+  }
+  return pow2;
+}
+
+// The bits a hash sets in its bloom filter word.
+inline uint64_t BloomBits(uint64_t hash) {
+  return (uint64_t{1} << (hash & 63)) | (uint64_t{1} << ((hash >> 6) & 63)) |
+         (uint64_t{1} << ((hash >> 12) & 63)) | (uint64_t{1} << ((hash >> 18) & 63));
+}
+
+}  // namespace
+
+JoinHashTable::JoinHashTable(std::vector<types::DataType> key_types)
+    : key_types_(std::move(key_types)) {
+  for (const auto& dt : key_types_) {
+#define TYPE_CASE(_dt_) key_equals_.push_back(&ValueEquals<_dt_>);
+    PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+  }
+  Clear();
+}
+
+void JoinHashTable::AddBatch(std::vector<std::shared_ptr<arrow::Array>> key_cols,
+                             int64_t num_rows) {
+  DCHECK(!built_);
+  DCHECK_EQ(key_cols.size(), key_types_.size());
+  std::vector<const arrow::Array*> raw_cols;
+  for (const auto& col : key_cols) {
+    raw_cols.push_back(col.get());
+  }
+  std::vector<uint64_t> hashes;
+  HashKeyColumns(key_types_, raw_cols, num_rows, &hashes);
+
+  int32_t batch = static_cast<int32_t>(batch_key_cols_.size());
+  added_hashes_.insert(added_hashes_.end(), hashes.begin(), hashes.end());
+  for (int64_t row = 0; row < num_rows; ++row) {
+    added_rows_.push_back({batch, static_cast<int32_t>(row)});
+  }
+  batch_key_cols_.push_back(std::move(key_cols));
+}
+
+bool JoinHashTable::KeyEquals(int64_t entry, const std::vector<const arrow::Array*>& key_cols,
+                              int64_t row) const {
+  const RowRef& ref = entry_rows_[entry];
+  const auto& build_cols = batch_key_cols_[ref.batch];
+  for (size_t i = 0; i < key_equals_.size(); ++i) {
+    if (!key_equals_[i](build_cols[i].get(), ref.row, key_cols[i], row)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool JoinHashTable::KeyEquals(int64_t entry, int64_t other_entry) const {
+  const RowRef& ref = entry_rows_[entry];
+  const RowRef& other_ref = entry_rows_[other_entry];
+  const auto& build_cols = batch_key_cols_[ref.batch];
+  const auto& other_cols = batch_key_cols_[other_ref.batch];
+  for (size_t i = 0; i < key_equals_.size(); ++i) {
+    if (!key_equals_[i](build_cols[i].get(), ref.row, other_cols[i].get(), other_ref.row)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void JoinHashTable::BloomInsert(uint64_t hash) {
+  bloom_[(hash >> 32) & bloom_mask_] |= BloomBits(hash);
+}
+
+bool JoinHashTable::BloomMayContain(uint64_t hash) const {
+  uint64_t bits = BloomBits(hash);
+  return (bloom_[(hash >> 32) & bloom_mask_] & bits) == bits;
+}
+
+void JoinHashTable::Build() {
+  DCHECK(!built_);
+  int64_t num_rows = static_cast<int64_t>(added_rows_.size());
+  radix_bits_ = 0;
+  while (radix_bits_ < kMaxRadixBits && (num_rows >> radix_bits_) > kTargetPartitionRows) {
+    ++radix_bits_;
+  }
+  int64_t num_partitions = int64_t{1} << radix_bits_;
+
+  // Count the rows of every partition, then scatter them. The scatter is stable, so rows with the
+  // same key stay in the order they were added.
+  partition_offsets_.assign(num_partitions + 1, 0);
+  for (uint64_t hash : added_hashes_) {
+    ++partition_offsets_[Partition(hash) + 1];
+  }
+  for (int64_t p = 0; p < num_partitions; ++p) {
+    partition_offsets_[p + 1] += partition_offsets_[p];
+  }
+  std::vector<int64_t> cursors(partition_offsets_.begin(), partition_offsets_.end() - 1);
+  entry_hashes_.resize(num_rows);
+  entry_rows_.resize(num_rows);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    int64_t entry = cursors[Partition(added_hashes_[i])]++;
+    entry_hashes_[entry] = added_hashes_[i];
+    entry_rows_[entry] = added_rows_[i];
+  }
+  added_hashes_ = {};
+  added_rows_ = {};
+  entry_next_.assign(num_rows, kNoMatch);
+  matched_.assign(num_rows, false);
+
+  // Keep the load factor of every partition at or below 1/2.
+  slot_offsets_.assign(num_partitions + 1, 0);
+  for (int64_t p = 0; p < num_partitions; ++p) {
+    int64_t partition_rows = partition_offsets_[p + 1] - partition_offsets_[p];
+    slot_offsets_[p + 1] =
+        slot_offsets_[p] + NextPowerOf2(std::max<int64_t>(16, 2 * partition_rows));
+  }
+  slots_.assign(slot_offsets_.back(), kEmptySlot);
+
+  // About 16 bits per row.
+  int64_t bloom_words = NextPowerOf2(std::max<int64_t>(1, num_rows / 4));
+  bloom_.assign(bloom_words, 0);
+  bloom_mask_ = bloom_words - 1;
+
+  for (int64_t p = 0; p < num_partitions; ++p) {
+    BuildPartition(p);
+  }
+  built_ = true;
+}
+
+void JoinHashTable::BuildPartition(int64_t partition) {
+  int64_t begin = partition_offsets_[partition];
+  int64_t end = partition_offsets_[partition + 1];
+  int64_t* slots = slots_.data() + slot_offsets_[partition];
+  uint64_t slot_mask = slot_offsets_[partition + 1] - slot_offsets_[partition] - 1;
+  // The last entry of the chain of every key, indexed by the first entry of the key.
+  std::vector<int64_t> tails(end - begin);
+
+  for (int64_t entry = begin; entry < end; ++entry) {
+    uint64_t hash = entry_hashes_[entry];
+    BloomInsert(hash);
+    uint64_t pos = hash & slot_mask;
+    while (true) {
+      int64_t head = slots[pos];
+      if (head == kEmptySlot) {
+        slots[pos] = entry;
+        tails[entry - begin] = entry;
+        break;
+      }
+      if (entry_hashes_[head] == hash && KeyEquals(head, entry)) {
+        entry_next_[tails[head - begin]] = entry;
+        tails[head - begin] = entry;
+        break;
+      }
+      pos = (pos + 1) & slot_mask;
+    }
+  }
+}
+
+void JoinHashTable::ProbeBatch(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                               std::vector<int64_t>* matches) {
+  DCHECK(built_);
+  DCHECK_EQ(key_cols.size(), key_types_.size());
+  matches->assign(num_rows, kNoMatch);
+  HashKeyColumns(key_types_, key_cols, num_rows, &probe_hashes_);
+
+  // Drop the rows that the bloom filter rules out before touching the table.
+  probe_sel_.clear();
+  for (int64_t row = 0; row < num_rows; ++row) {
+    if (BloomMayContain(probe_hashes_[row])) {
+      probe_sel_.push_back(row);
+    }
+  }
+  bloom_filtered_rows_ += num_rows - static_cast<int64_t>(probe_sel_.size());
+
+  auto slot_index = [&](uint64_t hash) {
+    int64_t partition = Partition(hash);
+    uint64_t slot_mask = slot_offsets_[partition + 1] - slot_offsets_[partition] - 1;
+    return slot_offsets_[partition] + static_cast<int64_t>(hash & slot_mask);
+  };
+
+  for (size_t i = 0; i < probe_sel_.size(); ++i) {
+    if (i + kPrefetchDistance < probe_sel_.size()) {
+      __builtin_prefetch(&slots_[slot_index(probe_hashes_[probe_sel_[i + kPrefetchDistance]])]);
+    }
+    int64_t row = probe_sel_[i];
+    uint64_t hash = probe_hashes_[row];
+    int64_t partition = Partition(hash);
+    const int64_t* slots = slots_.data() + slot_offsets_[partition];
+    uint64_t slot_mask = slot_offsets_[partition + 1] - slot_offsets_[partition] - 1;
+    for (uint64_t pos = hash & slot_mask; slots[pos] != kEmptySlot; pos = (pos + 1) & slot_mask) {
+      int64_t head = slots[pos];
+      if (entry_hashes_[head] == hash && KeyEquals(head, key_cols, row)) {
+        (*matches)[row] = head;
+        break;
+      }
+    }
+  }
+}
+
+void JoinHashTable::UnmatchedEntries(std::vector<int64_t>* entries) const {
+  auto first_entry = static_cast<int64_t>(entries->size());
+  for (int64_t head : slots_) {
+    if (head == kEmptySlot || matched_[head]) {
+      continue;
+    }
+    for (int64_t entry = head; entry != kNoMatch; entry = entry_next_[entry]) {
+      entries->push_back(entry);
+    }
+  }
+  // The slots are in hash order, so put the entries back in the order their rows were added.
+  std::sort(entries->begin() + first_entry, entries->end(), [this](int64_t a, int64_t b) {
+    const RowRef& row_a = entry_rows_[a];
+    const RowRef& row_b = entry_rows_[b];
+    return std::tie(row_a.batch, row_a.row) < std::tie(row_b.batch, row_b.row);
+  });
+}
+
+void JoinHashTable::Clear() {
+  batch_key_cols_ = {};
+  added_hashes_ = {};
+  added_rows_ = {};
+  entry_hashes_ = {};
+  entry_rows_ = {};
+  entry_next_ = {};
+  matched_ = {};
+  slots_ = {};
+  bloom_ = {};
+  radix_bits_ = 0;
+  partition_offsets_ = {0};
+  slot_offsets_ = {0};
+  bloom_mask_ = 0;
+  built_ = false;
+}
+
+int64_t JoinHashTable::BytesUsed() const {
+  return static_cast<int64_t>(
+      (added_hashes_.capacity() + entry_hashes_.capacity() + bloom_.capacity()) *
+          sizeof(uint64_t) +
+      (added_rows_.capacity() + entry_rows_.capacity()) * sizeof(RowRef) +
+      (entry_next_.capacity() + slots_.capacity()) * sizeof(int64_t) + matched_.capacity());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
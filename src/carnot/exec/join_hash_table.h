@@ -0,0 +1,171 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * JoinHashTable indexes the rows of the build side of a hash join by their key columns.
+ *
+ *  - Keys are never materialized per row: the table refers to the key columns of the build
+ *    batches, and keys are hashed a column at a time.
+ *  - Once all build batches are added, rows are radix partitioned on the high bits of their hash so
+ *    that the table of each partition fits in cache. Each partition is an open-addressing table
+ *    that maps a key to its first build row; the other rows with that key are chained after it, in
+ *    the order they were added.
+ *  - A blocked bloom filter over the build hashes lets probe rows that can't match skip the table.
+ *
+ * Build rows are referred to by entry ids, which are only valid after Build().
+ */
+class JoinHashTable : public NotCopyable {
+ public:
+  static constexpr int64_t kNoMatch = -1;
+
+  // The location of a build row: the index of its batch, in the order batches were added, and the
+  // row within that batch.
+  struct RowRef {
+    int32_t batch;
+    int32_t row;
+  };
+
+  explicit JoinHashTable(std::vector<types::DataType> key_types);
+
+  /**
+   * Adds the key columns of a build batch. The columns are held until Clear().
+   */
+  void AddBatch(std::vector<std::shared_ptr<arrow::Array>> key_cols, int64_t num_rows);
+
+  /**
+   * Partitions the added rows and builds the table. No batches can be added after this, until the
+   * table is cleared.
+   */
+  void Build();
+
+  /**
+   * Finds, for every row of a probe batch, the first build entry with the same key.
+   * @param key_cols The key columns of the probe batch, in the order of the key types.
+   * @param num_rows The number of rows in the batch.
+   * @param matches Output, the first matching entry of every row, or kNoMatch.
+   */
+  void ProbeBatch(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                  std::vector<int64_t>* matches);
+
+  /**
+   * @return The next entry with the same key as the given one, or kNoMatch.
+   */
+  int64_t next_match(int64_t entry) const { return entry_next_[entry]; }
+  const RowRef& row(int64_t entry) const { return entry_rows_[entry]; }
+
+  /**
+   * Marks the key of a first entry, as returned by ProbeBatch, as matched.
+   */
+  void MarkMatched(int64_t entry) { matched_[entry] = true; }
+
+  /**
+   * Appends every entry whose key was never marked as matched, in the order their rows were added.
+   */
+  void UnmatchedEntries(std::vector<int64_t>* entries) const;
+
+  /**
+   * Removes all rows and releases the memory they held.
+   */
+  void Clear();
+
+  int64_t num_rows() const { return static_cast<int64_t>(entry_rows_.size()); }
+  int64_t num_partitions() const { return static_cast<int64_t>(partition_offsets_.size()) - 1; }
+  bool built() const { return built_; }
+
+  /**
+   * @return The number of probe rows that the bloom filter rejected since this table was created.
+   */
+  int64_t bloom_filtered_rows() const { return bloom_filtered_rows_; }
+
+  /**
+   * @return The number of bytes held by the table, not counting the key columns.
+   */
+  int64_t BytesUsed() const;
+
+ private:
+  using ValueEqualsFn = bool (*)(const arrow::Array*, int64_t, const arrow::Array*, int64_t);
+
+  bool KeyEquals(int64_t entry, const std::vector<const arrow::Array*>& key_cols,
+                 int64_t row) const;
+  bool KeyEquals(int64_t entry, int64_t other_entry) const;
+  int64_t Partition(uint64_t hash) const {
+    return radix_bits_ == 0 ? 0 : static_cast<int64_t>(hash >> (64 - radix_bits_));
+  }
+  void BuildPartition(int64_t partition);
+  void BloomInsert(uint64_t hash);
+  bool BloomMayContain(uint64_t hash) const;
+
+  static constexpr int64_t kEmptySlot = -1;
+  // Partitions are sized so that their slots and entries stay in the L2 cache.
+  static constexpr int64_t kTargetPartitionRows = 4096;
+  static constexpr int kMaxRadixBits = 10;
+  // How many probe rows ahead to prefetch the table slot of.
+  static constexpr size_t kPrefetchDistance = 16;
+
+  std::vector<types::DataType> key_types_;
+  std::vector<ValueEqualsFn> key_equals_;
+
+  // The key columns of every added batch.
+  std::vector<std::vector<std::shared_ptr<arrow::Array>>> batch_key_cols_;
+  // The hash and location of every added row, in the order they were added.
+  std::vector<uint64_t> added_hashes_;
+  std::vector<RowRef> added_rows_;
+
+  // The entries, grouped by partition.
+  std::vector<uint64_t> entry_hashes_;
+  std::vector<RowRef> entry_rows_;
+  std::vector<int64_t> entry_next_;
+  std::vector<uint8_t> matched_;
+
+  int radix_bits_ = 0;
+  // The first entry and the first slot of every partition, plus one past the last.
+  std::vector<int64_t> partition_offsets_;
+  std::vector<int64_t> slot_offsets_;
+  // The first entry of each key. The slots of a partition are a power of 2.
+  std::vector<int64_t> slots_;
+
+  std::vector<uint64_t> bloom_;
+  uint64_t bloom_mask_ = 0;
+
+  bool built_ = false;
+  int64_t bloom_filtered_rows_ = 0;
+
+  // Per probe batch state.
+  std::vector<uint64_t> probe_hashes_;
+  std::vector<int64_t> probe_sel_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
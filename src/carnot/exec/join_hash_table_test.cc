@@ -0,0 +1,210 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/exec/join_hash_table.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using ::testing::ElementsAre;
+
+// The (batch, row) of every entry in a chain of matches.
+std::vector<std::pair<int32_t, int32_t>> MatchedRows(const JoinHashTable& table, int64_t entry) {
+  std::vector<std::pair<int32_t, int32_t>> rows;
+  for (; entry != JoinHashTable::kNoMatch; entry = table.next_match(entry)) {
+    rows.emplace_back(table.row(entry).batch, table.row(entry).row);
+  }
+  return rows;
+}
+
+TEST(JoinHashTableTest, single_int_key) {
+  JoinHashTable table({types::DataType::INT64});
+  table.AddBatch({types::ToArrow(std::vector<types::Int64Value>{5, 1, 5, 7},
+                                 arrow::default_memory_pool())},
+                 4);
+  table.AddBatch(
+      {types::ToArrow(std::vector<types::Int64Value>{1, 5}, arrow::default_memory_pool())}, 2);
+  table.Build();
+  EXPECT_EQ(6, table.num_rows());
+
+  auto probe =
+      types::ToArrow(std::vector<types::Int64Value>{5, 2, 1, 7}, arrow::default_memory_pool());
+  std::vector<int64_t> matches;
+  table.ProbeBatch({probe.get()}, probe->length(), &matches);
+  ASSERT_EQ(4ULL, matches.size());
+
+  // Matches are chained in the order they were added.
+  using Row = std::pair<int32_t, int32_t>;
+  EXPECT_THAT(MatchedRows(table, matches[0]), ElementsAre(Row{0, 0}, Row{0, 2}, Row{1, 1}));
+  EXPECT_EQ(JoinHashTable::kNoMatch, matches[1]);
+  EXPECT_THAT(MatchedRows(table, matches[2]), ElementsAre(Row{0, 1}, Row{1, 0}));
+  EXPECT_THAT(MatchedRows(table, matches[3]), ElementsAre(Row{0, 3}));
+}
+
+TEST(JoinHashTableTest, mixed_keys) {
+  JoinHashTable table({types::DataType::STRING, types::DataType::INT64});
+  table.AddBatch({types::ToArrow(std::vector<types::StringValue>{"abc", "abc", "ab"},
+                                 arrow::default_memory_pool()),
+                  types::ToArrow(std::vector<types::Int64Value>{1, 2, 1},
+                                 arrow::default_memory_pool())},
+                 3);
+  table.Build();
+
+  auto probe_strs = types::ToArrow(std::vector<types::StringValue>{"ab", "abc", "abc", "a"},
+                                   arrow::default_memory_pool());
+  auto probe_ints =
+      types::ToArrow(std::vector<types::Int64Value>{1, 2, 3, 1}, arrow::default_memory_pool());
+  std::vector<int64_t> matches;
+  table.ProbeBatch({probe_strs.get(), probe_ints.get()}, 4, &matches);
+
+  using Row = std::pair<int32_t, int32_t>;
+  EXPECT_THAT(MatchedRows(table, matches[0]), ElementsAre(Row{0, 2}));
+  EXPECT_THAT(MatchedRows(table, matches[1]), ElementsAre(Row{0, 1}));
+  EXPECT_EQ(JoinHashTable::kNoMatch, matches[2]);
+  EXPECT_EQ(JoinHashTable::kNoMatch, matches[3]);
+}
+
+TEST(JoinHashTableTest, unmatched_entries) {
+  JoinHashTable table({types::DataType::INT64});
+  table.AddBatch({types::ToArrow(std::vector<types::Int64Value>{1, 2, 3, 2},
+                                 arrow::default_memory_pool())},
+                 4);
+  table.Build();
+
+  auto probe = types::ToArrow(std::vector<types::Int64Value>{3}, arrow::default_memory_pool());
+  std::vector<int64_t> matches;
+  table.ProbeBatch({probe.get()}, 1, &matches);
+  table.MarkMatched(matches[0]);
+
+  std::vector<int64_t> unmatched;
+  table.UnmatchedEntries(&unmatched);
+  std::vector<int32_t> rows;
+  for (auto entry : unmatched) {
+    rows.push_back(table.row(entry).row);
+  }
+  EXPECT_THAT(rows, ElementsAre(0, 1, 3));
+}
+
+TEST(JoinHashTableTest, unmatched_entries_in_added_order) {
+  constexpr int64_t kRowsPerBatch = 10 * 1000;
+  JoinHashTable table({types::DataType::INT64});
+  for (int64_t batch = 0; batch < 2; ++batch) {
+    std::vector<types::Int64Value> keys;
+    for (int64_t i = 0; i < kRowsPerBatch; ++i) {
+      keys.emplace_back(batch * kRowsPerBatch + i);
+    }
+    table.AddBatch({types::ToArrow(keys, arrow::default_memory_pool())}, kRowsPerBatch);
+  }
+  table.Build();
+  EXPECT_GT(table.num_partitions(), 1);
+
+  // Match every even key.
+  std::vector<types::Int64Value> probe_keys;
+  for (int64_t i = 0; i < 2 * kRowsPerBatch; i += 2) {
+    probe_keys.emplace_back(i);
+  }
+  auto probe = types::ToArrow(probe_keys, arrow::default_memory_pool());
+  std::vector<int64_t> matches;
+  table.ProbeBatch({probe.get()}, probe->length(), &matches);
+  for (auto entry : matches) {
+    table.MarkMatched(entry);
+  }
+
+  std::vector<int64_t> unmatched;
+  table.UnmatchedEntries(&unmatched);
+  ASSERT_EQ(kRowsPerBatch, static_cast<int64_t>(unmatched.size()));
+  for (int64_t i = 0; i < kRowsPerBatch; ++i) {
+    int64_t key = 2 * i + 1;
+    EXPECT_EQ(key / kRowsPerBatch, table.row(unmatched[i]).batch);
+    EXPECT_EQ(key % kRowsPerBatch, table.row(unmatched[i]).row);
+  }
+}
+
+TEST(JoinHashTableTest, many_rows_partitioned) {
+  constexpr int64_t kNumRows = 100 * 1000;
+  JoinHashTable table({types::DataType::INT64, types::DataType::STRING});
+  std::vector<types::Int64Value> ints;
+  std::vector<types::StringValue> strs;
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    ints.emplace_back(i % 1000);
+    strs.emplace_back(std::to_string(i / 1000));
+  }
+  table.AddBatch({types::ToArrow(ints, arrow::default_memory_pool()),
+                  types::ToArrow(strs, arrow::default_memory_pool())},
+                 kNumRows);
+  table.Build();
+  EXPECT_GT(table.num_partitions(), 1);
+
+  // Probe every key once, plus as many keys that aren't in the table.
+  std::vector<types::Int64Value> probe_ints;
+  std::vector<types::StringValue> probe_strs;
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    probe_ints.emplace_back(i % 1000);
+    probe_strs.emplace_back(std::to_string(i / 1000));
+    probe_ints.emplace_back(i % 1000);
+    probe_strs.emplace_back("missing" + std::to_string(i / 1000));
+  }
+  auto probe_int_col = types::ToArrow(probe_ints, arrow::default_memory_pool());
+  auto probe_str_col = types::ToArrow(probe_strs, arrow::default_memory_pool());
+  std::vector<int64_t> matches;
+  table.ProbeBatch({probe_int_col.get(), probe_str_col.get()}, 2 * kNumRows, &matches);
+
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    ASSERT_NE(JoinHashTable::kNoMatch, matches[2 * i]);
+    EXPECT_EQ(i, table.row(matches[2 * i]).row);
+    EXPECT_EQ(JoinHashTable::kNoMatch, table.next_match(matches[2 * i]));
+    EXPECT_EQ(JoinHashTable::kNoMatch, matches[2 * i + 1]);
+  }
+  // Most of the missing keys never reach the table.
+  EXPECT_GT(table.bloom_filtered_rows(), kNumRows / 2);
+}
+
+TEST(JoinHashTableTest, clear) {
+  JoinHashTable table({types::DataType::INT64});
+  table.AddBatch(
+      {types::ToArrow(std::vector<types::Int64Value>{1, 2}, arrow::default_memory_pool())}, 2);
+  table.Build();
+  table.Clear();
+  EXPECT_FALSE(table.built());
+
+  table.AddBatch({types::ToArrow(std::vector<types::Int64Value>{2}, arrow::default_memory_pool())},
+                 1);
+  table.Build();
+  EXPECT_EQ(1, table.num_rows());
+
+  auto probe = types::ToArrow(std::vector<types::Int64Value>{1, 2}, arrow::default_memory_pool());
+  std::vector<int64_t> matches;
+  table.ProbeBatch({probe.get()}, 2, &matches);
+  EXPECT_EQ(JoinHashTable::kNoMatch, matches[0]);
+  EXPECT_NE(JoinHashTable::kNoMatch, matches[1]);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
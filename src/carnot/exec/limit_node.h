@@ -40,6 +40,8 @@ class LimitNode : public ProcessingNode {
   LimitNode() = default;
   virtual ~LimitNode() = default;
 
+  bool SupportsSelection() const override { return true; }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -281,6 +281,38 @@ TEST_F(LimitNodeTest, drop_input_columns_fewer_than_limit) {
       .Close();
 }
 
+TEST_F(LimitNodeTest, limits_selected_records) {
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  // Only the selected rows count towards the limit.
+  RowBatch rb1 = RowBatchBuilder(input_rd, 6, /*eow*/ false, /*eos*/ false)
+                     .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6})
+                     .AddColumn<types::Int64Value>({1, 3, 6, 9, 12, 15})
+                     .get();
+  rb1.set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{0, 2, 4, 5}));
+  RowBatch rb2 = RowBatchBuilder(input_rd, 8, /*eow*/ true, /*eos*/ true)
+                     .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6, 7, 8})
+                     .AddColumn<types::Int64Value>({1, 4, 6, 8, 10, 12, 14, 16})
+                     .get();
+  rb2.set_selection(
+      std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{0, 1, 2, 4, 5, 6, 7}));
+
+  auto tester = exec::ExecNodeTester<LimitNode, plan::LimitOperator>(*plan_node_, output_rd,
+                                                                     {input_rd}, exec_state_.get());
+  tester.ConsumeNext(rb1, 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 4, false, false)
+                          .AddColumn<types::Int64Value>({1, 3, 5, 6})
+                          .AddColumn<types::Int64Value>({1, 6, 12, 15})
+                          .get())
+      .ConsumeNext(rb2, 0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 6, true, true)
+                          .AddColumn<types::Int64Value>({1, 2, 3, 5, 6, 7})
+                          .AddColumn<types::Int64Value>({1, 4, 6, 10, 12, 14})
+                          .get())
+      .Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
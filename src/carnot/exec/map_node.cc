@@ -42,12 +42,19 @@ Status MapNode::InitImpl(const plan::Operator& plan_node) {
   const auto* map_plan_node = static_cast<const plan::MapOperator*>(&plan_node);
   // copy the plan node to local object;
   plan_node_ = std::make_unique<plan::MapOperator>(*map_plan_node);
+  evaluate_outside_selection_ = true;
+  for (const auto& expr : plan_node_->expressions()) {
+    evaluate_outside_selection_ = evaluate_outside_selection_ && CanEvaluateOutsideSelection(*expr);
+  }
   return Status::OK();
 }
 Status MapNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
-  evaluator_ = ScalarExpressionEvaluator::Create(
-      plan_node_->expressions(), ScalarExpressionEvaluatorType::kArrowNative, function_ctx_.get());
+  auto evaluator_type = FLAGS_carnot_fused_expressions
+                            ? ScalarExpressionEvaluatorType::kFused
+                            : ScalarExpressionEvaluatorType::kArrowNative;
+  evaluator_ = ScalarExpressionEvaluator::Create(plan_node_->expressions(), evaluator_type,
+                                                 function_ctx_.get());
   return Status::OK();
 }
 
@@ -61,8 +68,22 @@ Status MapNode::CloseImpl(ExecState* exec_state) {
   return Status::OK();
 }
 Status MapNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (rb.has_selection() && !evaluate_outside_selection_) {
+    // Parents compact the batches they send to this node (see SupportsSelection()), this covers
+    // batches that are consumed directly.
+    PX_ASSIGN_OR_RETURN(auto compacted_rb, rb.Compact(exec_state->exec_mem_pool()));
+    return EvaluateBatch(exec_state, *compacted_rb);
+  }
+  return EvaluateBatch(exec_state, rb);
+}
+
+Status MapNode::EvaluateBatch(ExecState* exec_state, const RowBatch& rb) {
   RowBatch output_rb(*output_descriptor_, rb.num_rows());
   PX_RETURN_IF_ERROR(evaluator_->Evaluate(exec_state, rb, &output_rb));
+  // Rows outside of the selection are evaluated too, which is cheaper than compacting the input
+  // as long as the selection isn't sparse. Batches only have a selection here if the expressions
+  // are defined on every row (see SupportsSelection()). The output keeps the input's selection.
+  output_rb.set_selection(rb.selection());
   output_rb.set_eow(rb.eow());
   output_rb.set_eos(rb.eos());
   PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
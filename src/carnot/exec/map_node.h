@@ -41,6 +41,8 @@ class MapNode : public ProcessingNode {
   MapNode() = default;
   virtual ~MapNode() = default;
 
+  bool SupportsSelection() const override { return evaluate_outside_selection_; }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -51,9 +53,14 @@ class MapNode : public ProcessingNode {
                          size_t parent_index) override;
 
  private:
+  Status EvaluateBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+
   std::unique_ptr<ExpressionEvaluator> evaluator_;
   std::unique_ptr<plan::MapOperator> plan_node_;
   std::unique_ptr<udf::FunctionContext> function_ctx_;
+  // Whether all of the expressions can be evaluated on rows outside of the input's selection,
+  // otherwise the input is compacted before it gets here.
+  bool evaluate_outside_selection_ = false;
 };
 
 }  // namespace exec
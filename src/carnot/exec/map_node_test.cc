@@ -22,6 +22,7 @@
 #include <vector>
 
 #include <gmock/gmock.h>
+#include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
 
@@ -51,6 +52,13 @@ class AddUDF : public udf::ScalarUDF {
   }
 };
 
+class ModuloUDF : public udf::ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val % v2.val;
+  }
+};
+
 class MapNodeTest : public ::testing::Test {
  public:
   MapNodeTest() {
@@ -59,6 +67,7 @@ class MapNodeTest : public ::testing::Test {
 
     func_registry_ = std::make_unique<udf::Registry>("test_registry");
     EXPECT_OK(func_registry_->Register<AddUDF>("add"));
+    EXPECT_OK(func_registry_->Register<ModuloUDF>("modulo"));
     auto table_store = std::make_shared<table_store::TableStore>();
 
     exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
@@ -66,6 +75,9 @@ class MapNodeTest : public ::testing::Test {
                                               MockTraceStubGenerator, sole::uuid4(), nullptr);
     EXPECT_OK(exec_state_->AddScalarUDF(
         0, "add", std::vector<types::DataType>({types::DataType::INT64, types::DataType::INT64})));
+    EXPECT_OK(exec_state_->AddScalarUDF(
+        1, "modulo",
+        std::vector<types::DataType>({types::DataType::INT64, types::DataType::INT64})));
   }
 
  protected:
@@ -144,6 +156,62 @@ TEST_F(MapNodeTest, child_fail) {
                                0, error::InvalidArgument("args"));
 }
 
+TEST_F(MapNodeTest, memory_limit_exceeded) {
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+  exec_state_->query_mem_pool()->set_limit_bytes(1);
+
+  auto tester = exec::ExecNodeTester<MapNode, plan::MapOperator>(*plan_node_, output_rd, {},
+                                                                 exec_state_.get());
+  // The child consumes the batch, but the query fails once the map node returns.
+  tester.ConsumeNextShouldFail(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                                   .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                                   .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                                   .get(),
+                               0, Status::OK());
+  EXPECT_TRUE(exec_state_->query_mem_pool()->limit_exceeded());
+  EXPECT_TRUE(error::IsResourceUnavailable(exec_state_->CheckMemoryLimit()));
+}
+
+TEST_F(MapNodeTest, modulo_after_filter) {
+  // df[df.b != 0] followed by df.a % df.b. The rows where b is 0 are outside of the selection and
+  // must not be evaluated.
+  constexpr char kModuloMapPbtxt[] = R"(
+op_type: MAP_OPERATOR
+map_op {
+  expressions {
+    func {
+      name: "modulo"
+      id: 1
+      args { column { node: 0 index: 0 } }
+      args { column { node: 0 index: 1 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  column_names: "mod"
+})";
+  planpb::Operator op_proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kModuloMapPbtxt, &op_proto));
+  auto plan_node = plan::MapOperator::FromProto(op_proto, 1);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  RowBatch input_rb = RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                          .AddColumn<types::Int64Value>({7, 5, 9, 4})
+                          .AddColumn<types::Int64Value>({2, 0, 4, 0})
+                          .get();
+  input_rb.set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{0, 2}));
+
+  auto tester = exec::ExecNodeTester<MapNode, plan::MapOperator>(*plan_node, output_rd, {input_rd},
+                                                                 exec_state_.get());
+  tester.ConsumeNext(input_rb, 0)
+      .ExpectRowBatch(
+          RowBatchBuilder(output_rd, 2, true, true).AddColumn<types::Int64Value>({1, 1}).get())
+      .Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
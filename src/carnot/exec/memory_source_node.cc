@@ -20,7 +20,9 @@
 #include "src/table_store/table/table.h"
 
 #include <limits>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <absl/strings/substitute.h>
@@ -34,6 +36,36 @@ namespace exec {
 
 using StartSpec = Table::Cursor::StartSpec;
 using StopSpec = Table::Cursor::StopSpec;
+using Predicate = Table::Cursor::Predicate;
+
+namespace {
+
+std::optional<Predicate::Op> ComparisonOp(const std::string& func_name) {
+  if (func_name == "equal") return Predicate::Op::kEqual;
+  if (func_name == "lessThan") return Predicate::Op::kLess;
+  if (func_name == "lessThanEqual") return Predicate::Op::kLessEqual;
+  if (func_name == "greaterThan") return Predicate::Op::kGreater;
+  if (func_name == "greaterThanEqual") return Predicate::Op::kGreaterEqual;
+  return std::nullopt;
+}
+
+// Returns the op that keeps the comparison the same when its operands are swapped.
+Predicate::Op SwapOperands(Predicate::Op op) {
+  switch (op) {
+    case Predicate::Op::kLess:
+      return Predicate::Op::kGreater;
+    case Predicate::Op::kLessEqual:
+      return Predicate::Op::kGreaterEqual;
+    case Predicate::Op::kGreater:
+      return Predicate::Op::kLess;
+    case Predicate::Op::kGreaterEqual:
+      return Predicate::Op::kLessEqual;
+    default:
+      return op;
+  }
+}
+
+}  // namespace
 
 std::string MemorySourceNode::DebugStringImpl() {
   return absl::Substitute("Exec::MemorySourceNode: <name: $0, output: $1>", plan_node_->TableName(),
@@ -85,17 +117,105 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
       stop_spec.type = StopSpec::StopType::CurrentEndOfTable;
     }
   }
-  cursor_ = std::make_unique<Table::Cursor>(table_, start_spec, stop_spec);
+  std::vector<Predicate> predicates;
+  if (pushed_down_filter_ != nullptr) {
+    ExtractPredicates(*pushed_down_filter_, &predicates);
+  }
+  cursor_ = std::make_unique<Table::Cursor>(table_, start_spec, stop_spec, std::move(predicates));
+  // Dictionary columns are only decoded for the children that can't read them.
+  for (auto* child : children()) {
+    keep_dictionaries_ = keep_dictionaries_ || child->SupportsDictionaryColumns();
+  }
 
   return Status::OK();
 }
 
+void MemorySourceNode::ExtractPredicates(const plan::ScalarExpression& expr,
+                                         std::vector<Predicate>* predicates) const {
+  if (expr.ExpressionType() != plan::Expression::kFunc) {
+    return;
+  }
+  const auto& func = static_cast<const plan::ScalarFunc&>(expr);
+  const auto& args = func.arg_deps();
+  if (func.name() == "logicalAnd") {
+    for (const auto& arg : args) {
+      ExtractPredicates(*arg, predicates);
+    }
+    return;
+  }
+  auto op = ComparisonOp(func.name());
+  if (!op.has_value() || args.size() != 2) {
+    return;
+  }
+  const plan::ScalarExpression* lhs = args[0].get();
+  const plan::ScalarExpression* rhs = args[1].get();
+  if (lhs->ExpressionType() == plan::Expression::kConstant &&
+      rhs->ExpressionType() == plan::Expression::kColumn) {
+    std::swap(lhs, rhs);
+    op = SwapOperands(op.value());
+  }
+  if (lhs->ExpressionType() != plan::Expression::kColumn ||
+      rhs->ExpressionType() != plan::Expression::kConstant) {
+    return;
+  }
+  const auto* col = static_cast<const plan::Column*>(lhs);
+  const auto* val = static_cast<const plan::ScalarValue*>(rhs);
+  auto source_cols = plan_node_->Columns();
+  if (val->IsNull() || col->Index() < 0 ||
+      col->Index() >= static_cast<int64_t>(source_cols.size())) {
+    return;
+  }
+
+  // Only comparisons between values of the same type are pushed down, mixed type comparisons (eg.
+  // INT64 with FLOAT64) are left to the filter.
+  Predicate predicate{source_cols[col->Index()], op.value(), {}};
+  switch (output_descriptor_->type(col->Index())) {
+    case types::DataType::BOOLEAN:
+      if (val->DataType() != types::DataType::BOOLEAN) return;
+      predicate.value = static_cast<int64_t>(val->BoolValue());
+      break;
+    case types::DataType::INT64:
+      if (val->DataType() != types::DataType::INT64) return;
+      predicate.value = val->Int64Value();
+      break;
+    case types::DataType::TIME64NS:
+      if (val->DataType() == types::DataType::TIME64NS) {
+        predicate.value = val->Time64NSValue();
+      } else if (val->DataType() == types::DataType::INT64) {
+        predicate.value = val->Int64Value();
+      } else {
+        return;
+      }
+      break;
+    case types::DataType::FLOAT64:
+      // Equality of floats is approximate.
+      if (val->DataType() != types::DataType::FLOAT64 || op == Predicate::Op::kEqual) return;
+      predicate.value = val->Float64Value();
+      break;
+    case types::DataType::UINT128:
+      if (val->DataType() != types::DataType::UINT128) return;
+      predicate.value = val->UInt128Value();
+      break;
+    case types::DataType::STRING:
+      if (val->DataType() != types::DataType::STRING) return;
+      predicate.value = val->StringValue();
+      break;
+    default:
+      return;
+  }
+  predicates->push_back(std::move(predicate));
+}
+
 Status MemorySourceNode::CloseImpl(ExecState*) {
   stats()->AddExtraInfo("streaming", streaming_ ? "true" : "false");
+  if (cursor_ != nullptr) {
+    stats()->AddExtraMetric("zone_map_batches_skipped", cursor_->batches_skipped());
+    stats()->AddExtraMetric("zone_map_rows_skipped", cursor_->rows_skipped());
+  }
   return Status::OK();
 }
 
-StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*) {
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState* exec_state) {
   DCHECK(table_ != nullptr);
 
   if (!cursor_->NextBatchReady()) {
@@ -108,7 +228,11 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
                                   /* eos */ cursor_->Done());
   }
 
-  PX_ASSIGN_OR_RETURN(auto row_batch, cursor_->GetNextRowBatch(plan_node_->Columns()));
+  Table::Cursor::ReadOptions read_options;
+  read_options.mem_pool = exec_state->exec_mem_pool();
+  read_options.keep_dictionaries = keep_dictionaries_;
+  PX_ASSIGN_OR_RETURN(auto row_batch,
+                      cursor_->GetNextRowBatch(plan_node_->Columns(), read_options));
 
   rows_processed_ += row_batch->num_rows();
   bytes_processed_ += row_batch->NumBytes();
@@ -21,11 +21,13 @@
 #include <stdint.h>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/plan/operators.h"
+#include "src/carnot/plan/scalar_expression.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
 #include "src/table_store/schema/row_batch.h"
@@ -46,6 +48,15 @@ class MemorySourceNode : public SourceNode {
 
   bool NextBatchReady() override;
 
+  /**
+   * Sets the predicate of the filter that consumes this source. Its comparisons of columns against
+   * constants are pushed down to the table cursor, which then skips the cold batches they rule
+   * out. The filter still runs on every batch that is read.
+   */
+  void set_pushed_down_filter(std::shared_ptr<const plan::ScalarExpression> filter) {
+    pushed_down_filter_ = std::move(filter);
+  }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -57,10 +68,18 @@ class MemorySourceNode : public SourceNode {
  private:
   StatusOr<std::unique_ptr<RowBatch>> GetNextRowBatch(ExecState* exec_state);
   bool InfiniteStreamNextBatchReady();
+  // Collects the conjuncts of expr that compare a column against a constant, as cursor predicates
+  // on the table's columns.
+  void ExtractPredicates(const plan::ScalarExpression& expr,
+                         std::vector<Table::Cursor::Predicate>* predicates) const;
   // Whether this memory source will stream future results.
   bool streaming_ = false;
 
   std::unique_ptr<Table::Cursor> cursor_;
+  // Whether the cursor returns dictionary encoded columns with their codes, which it does when
+  // any child reads them.
+  bool keep_dictionaries_ = false;
+  std::shared_ptr<const plan::ScalarExpression> pushed_down_filter_;
 
   std::unique_ptr<plan::MemorySourceOperator> plan_node_;
   table_store::Table* table_ = nullptr;
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/morsel_dispatch_node.h"
+
+#include <utility>
+
+#include <absl/strings/substitute.h>
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+std::string MorselDispatchNode::DebugStringImpl() {
+  return absl::Substitute("Exec::MorselDispatchNode<stages: $0, parallelism: $1>", stages_.size(),
+                          parallelism());
+}
+
+Status MorselDispatchNode::InitImpl(const plan::Operator&) { return Status::OK(); }
+
+Status MorselDispatchNode::SetStages(const plan::Operator& tail_op,
+                                     std::vector<std::vector<ExecNode*>> stages,
+                                     WorkStealingPool* pool) {
+  if (stages.empty()) {
+    return error::InvalidArgument("MorselDispatchNode requires at least one stage.");
+  }
+  for (const auto& stage : stages) {
+    if (stage.size() != static_cast<size_t>(pool->num_workers())) {
+      return error::InvalidArgument("Expected $0 workers per stage, got $1.", pool->num_workers(),
+                                    stage.size());
+    }
+  }
+  stages_ = std::move(stages);
+  pool_ = pool;
+
+  // Connect each worker's copy of the chain and terminate it with a collector.
+  for (int32_t w = 0; w < pool_->num_workers(); ++w) {
+    for (size_t i = 1; i < stages_.size(); ++i) {
+      stages_[i - 1][w]->AddChild(stages_[i][w], 0);
+    }
+    auto collector = std::make_unique<MorselCollectorNode>();
+    PX_RETURN_IF_ERROR(collector->Init(tail_op, *output_descriptor_, {*output_descriptor_}));
+    stages_.back()[w]->AddChild(collector.get(), 0);
+    collectors_.push_back(std::move(collector));
+  }
+  return Status::OK();
+}
+
+Status MorselDispatchNode::PrepareImpl(ExecState* exec_state) {
+  // Selections only survive the workers if every child reads through them. Otherwise the workers
+  // compact their outputs, in parallel, instead of this node doing it when forwarding them.
+  bool children_support_selection = !children().empty();
+  for (auto* child : children()) {
+    children_support_selection = children_support_selection && child->SupportsSelection();
+  }
+  for (auto& collector : collectors_) {
+    collector->set_supports_selection(children_support_selection);
+  }
+  for (const auto& stage : stages_) {
+    for (size_t w = 1; w < stage.size(); ++w) {
+      PX_RETURN_IF_ERROR(stage[w]->Prepare(exec_state));
+    }
+  }
+  return Status::OK();
+}
+
+Status MorselDispatchNode::OpenImpl(ExecState* exec_state) {
+  for (const auto& stage : stages_) {
+    for (size_t w = 1; w < stage.size(); ++w) {
+      PX_RETURN_IF_ERROR(stage[w]->Open(exec_state));
+    }
+  }
+  return Status::OK();
+}
+
+Status MorselDispatchNode::CloseImpl(ExecState* exec_state) {
+  Status close_status = Status::OK();
+  for (const auto& stage : stages_) {
+    for (size_t w = 1; w < stage.size(); ++w) {
+      auto s = stage[w]->Close(exec_state);
+      if (!s.ok()) {
+        close_status = s;
+      }
+      stage[0]->stats()->MergeCounters(*stage[w]->stats());
+    }
+  }
+  for (const auto& stage : stages_) {
+    stage[0]->stats()->AddExtraMetric("parallelism", parallelism());
+  }
+  stats()->AddExtraMetric("parallelism", parallelism());
+  stats()->AddExtraMetric("morsels", num_morsels_);
+  stats()->AddExtraMetric("morsel_flushes", num_flushes_);
+  return close_status;
+}
+
+Status MorselDispatchNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  pending_morsels_.push_back(rb);
+  ++num_morsels_;
+  if (rb.eos() || pending_morsels_.size() >= kMorselsPerWorker * static_cast<size_t>(parallelism())) {
+    return Flush(exec_state);
+  }
+  return Status::OK();
+}
+
+Status MorselDispatchNode::Flush(ExecState* exec_state) {
+  if (pending_morsels_.empty()) {
+    return Status::OK();
+  }
+  ++num_flushes_;
+
+  std::vector<Status> statuses(pending_morsels_.size());
+  std::vector<std::vector<RowBatch>> outputs(pending_morsels_.size());
+  pool_->ParallelFor(pending_morsels_.size(), [&](int32_t worker, size_t morsel) {
+    statuses[morsel] = stages_[0][worker]->ConsumeNext(exec_state, pending_morsels_[morsel], 0);
+    outputs[morsel] = collectors_[worker]->TakeBatches();
+  });
+  pending_morsels_.clear();
+
+  for (const auto& s : statuses) {
+    PX_RETURN_IF_ERROR(s);
+  }
+  for (const auto& morsel_output : outputs) {
+    for (const auto& rb : morsel_output) {
+      PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, rb));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/work_stealing_pool.h"
+#include "src/carnot/plan/operators.h"
+#include "src/common/base/base.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * MorselCollectorNode terminates a per-worker operator chain of a MorselDispatchNode. It holds
+ * on to every row batch it receives until the dispatcher takes them.
+ */
+class MorselCollectorNode : public SinkNode {
+ public:
+  MorselCollectorNode() = default;
+  virtual ~MorselCollectorNode() = default;
+
+  std::vector<table_store::schema::RowBatch> TakeBatches() { return std::move(batches_); }
+
+  /**
+   * Whether the collected batches may keep their selection. When they can't, the worker chain
+   * compacts them before they are collected.
+   */
+  void set_supports_selection(bool supports_selection) {
+    supports_selection_ = supports_selection;
+  }
+  bool SupportsSelection() const override { return supports_selection_; }
+
+ protected:
+  std::string DebugStringImpl() override { return "Exec::MorselCollectorNode"; }
+  Status InitImpl(const plan::Operator&) override { return Status::OK(); }
+  Status PrepareImpl(ExecState*) override { return Status::OK(); }
+  Status OpenImpl(ExecState*) override { return Status::OK(); }
+  Status CloseImpl(ExecState*) override { return Status::OK(); }
+  Status ConsumeNextImpl(ExecState*, const table_store::schema::RowBatch& rb, size_t) override {
+    batches_.push_back(rb);
+    return Status::OK();
+  }
+
+ private:
+  std::vector<table_store::schema::RowBatch> batches_;
+  bool supports_selection_ = false;
+};
+
+/**
+ * MorselDispatchNode executes a chain of stateless operators (Map/Filter) that sits between a
+ * memory source and the next pipeline breaker on a WorkStealingPool.
+ *
+ * Every row batch produced by the source is a morsel. Morsels are buffered until there are enough
+ * of them to keep all workers busy (or the stream ends), then each morsel is pushed through one
+ * worker's private copy of the operator chain. The outputs are forwarded to the children of this
+ * node in the original morsel order, so downstream operators observe exactly the same sequence of
+ * row batches as in single threaded execution.
+ *
+ * The copies of the chain for worker 0 are the nodes registered with the ExecutionGraph; their
+ * lifecycle is managed by the graph and they carry the stats reported for the plan nodes. The
+ * dispatcher manages the lifecycle of the remaining workers' copies and folds their stats into
+ * the worker 0 copies on Close.
+ */
+class MorselDispatchNode : public ProcessingNode {
+ public:
+  MorselDispatchNode() = default;
+  virtual ~MorselDispatchNode() = default;
+
+  /**
+   * Sets the operator chain this node dispatches to.
+   * @param tail_op The plan operator of the last stage of the chain.
+   * @param stages stages[i][w] is worker w's copy of the i-th operator of the chain. The copies of
+   * consecutive stages must not be connected yet.
+   * @param pool The pool to run the morsels on. Must outlive this node.
+   */
+  Status SetStages(const plan::Operator& tail_op, std::vector<std::vector<ExecNode*>> stages,
+                   WorkStealingPool* pool);
+
+  int32_t parallelism() const { return pool_ == nullptr ? 1 : pool_->num_workers(); }
+
+ protected:
+  std::string DebugStringImpl() override;
+  Status InitImpl(const plan::Operator& plan_node) override;
+  Status PrepareImpl(ExecState* exec_state) override;
+  Status OpenImpl(ExecState* exec_state) override;
+  Status CloseImpl(ExecState* exec_state) override;
+  Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                         size_t parent_index) override;
+
+ private:
+  // Runs all of the buffered morsels on the pool and forwards the results to the children.
+  Status Flush(ExecState* exec_state);
+
+  // The number of morsels buffered per worker before a flush. More than one morsel per worker
+  // gives the pool room to balance out uneven morsel costs.
+  static constexpr size_t kMorselsPerWorker = 2;
+
+  std::vector<std::vector<ExecNode*>> stages_;
+  std::vector<std::unique_ptr<MorselCollectorNode>> collectors_;
+  WorkStealingPool* pool_ = nullptr;
+
+  std::vector<table_store::schema::RowBatch> pending_morsels_;
+  int64_t num_morsels_ = 0;
+  int64_t num_flushes_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/spill.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <utility>
+
+#include "src/carnot/exec/agg_hash_table.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+DEFINE_int64(carnot_query_memory_budget_mb,
+             gflags::Int64FromEnv("PL_CARNOT_QUERY_MEMORY_BUDGET_MB", 0),
+             "The number of MB the aggregate and join state of a query may hold before it is "
+             "spilled to disk. 0 disables spilling.");
+DEFINE_string(carnot_spill_dir, gflags::StringFromEnv("PL_CARNOT_SPILL_DIR", "/tmp"),
+              "The directory that queries spill their aggregate and join state to.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+StatusOr<std::unique_ptr<SpillFile>> SpillFile::Create(const std::string& dir) {
+  std::string path = dir + "/carnot_spill_XXXXXX";
+  int fd = mkstemp(path.data());
+  if (fd < 0) {
+    return error::Internal("Failed to create spill file in $0: $1", dir, strerror(errno));
+  }
+  unlink(path.c_str());
+  FILE* file = fdopen(fd, "w+b");
+  if (file == nullptr) {
+    close(fd);
+    return error::Internal("Failed to open spill file in $0: $1", dir, strerror(errno));
+  }
+  return std::unique_ptr<SpillFile>(new SpillFile(file));
+}
+
+SpillFile::~SpillFile() { fclose(file_); }
+
+Status SpillFile::Append(const RowBatch& rb) {
+  table_store::schemapb::RowBatchData rb_pb;
+  PX_RETURN_IF_ERROR(rb.ToProto(&rb_pb));
+  std::string data = rb_pb.SerializeAsString();
+  uint64_t size = data.size();
+  if (fwrite(&size, sizeof(size), 1, file_) != 1 ||
+      fwrite(data.data(), 1, data.size(), file_) != data.size()) {
+    return error::Internal("Failed to write to spill file: $0", strerror(errno));
+  }
+  bytes_written_ += sizeof(size) + data.size();
+  ++num_batches_;
+  return Status::OK();
+}
+
+Status SpillFile::ForEachBatch(const std::function<Status(const RowBatch&)>& fn) {
+  if (fflush(file_) != 0 || fseek(file_, 0, SEEK_SET) != 0) {
+    return error::Internal("Failed to rewind spill file: $0", strerror(errno));
+  }
+  std::string data;
+  for (int64_t i = 0; i < num_batches_; ++i) {
+    uint64_t size;
+    if (fread(&size, sizeof(size), 1, file_) != 1) {
+      return error::Internal("Failed to read from spill file: $0", strerror(errno));
+    }
+    data.resize(size);
+    if (fread(data.data(), 1, size, file_) != size) {
+      return error::Internal("Failed to read from spill file: $0", strerror(errno));
+    }
+    table_store::schemapb::RowBatchData rb_pb;
+    if (!rb_pb.ParseFromString(data)) {
+      return error::Internal("Corrupt row batch in spill file");
+    }
+    PX_ASSIGN_OR_RETURN(auto rb, RowBatch::FromProto(rb_pb));
+    PX_RETURN_IF_ERROR(fn(*rb));
+  }
+  if (fseek(file_, 0, SEEK_END) != 0) {
+    return error::Internal("Failed to seek spill file: $0", strerror(errno));
+  }
+  return Status::OK();
+}
+
+namespace {
+
+template <types::DataType DT>
+Status AppendRows(arrow::ArrayBuilder* builder, const arrow::Array* arr,
+                  const std::vector<int64_t>& rows) {
+  PX_RETURN_IF_ERROR(builder->Reserve(rows.size()));
+  for (int64_t row : rows) {
+    if constexpr (DT == types::DataType::STRING) {
+      // Dictionary encoded columns are decoded as they are spilled.
+      PX_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(
+          builder, std::string(types::GetStringViewFromArrowArray(arr, row))));
+    } else {
+      PX_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(
+          builder, types::GetValueFromArrowArray<DT>(arr, row)));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status SpillPartitions::Append(const RowBatch& rb, const std::vector<int64_t>& key_cols) {
+  if (rb.num_rows() == 0) {
+    return Status::OK();
+  }
+  std::vector<types::DataType> key_types;
+  std::vector<const arrow::Array*> key_arrays;
+  for (int64_t col : key_cols) {
+    key_types.push_back(rb.desc().type(col));
+    key_arrays.push_back(rb.ColumnAt(col).get());
+  }
+  std::vector<uint64_t> hashes;
+  HashKeyColumns(key_types, key_arrays, rb.num_rows(), &hashes);
+
+  // Use the high bits of the hash, the low bits place the keys within a hash table.
+  std::vector<std::vector<int64_t>> partition_rows(partitions_.size());
+  for (int64_t row = 0; row < rb.num_rows(); ++row) {
+    partition_rows[(hashes[row] >> 32) % partitions_.size()].push_back(row);
+  }
+
+  for (const auto& [partition, rows] : Enumerate(partition_rows)) {
+    if (rows.empty()) {
+      continue;
+    }
+    RowBatch part(rb.desc(), rows.size());
+    for (int64_t col = 0; col < rb.num_columns(); ++col) {
+      auto dt = rb.desc().type(col);
+      auto builder = types::MakeArrowBuilder(dt, mem_pool_);
+#define TYPE_CASE(_dt_) \
+  PX_RETURN_IF_ERROR(AppendRows<_dt_>(builder.get(), rb.ColumnAt(col).get(), rows));
+      PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
+#undef TYPE_CASE
+      std::shared_ptr<arrow::Array> arr;
+      PX_RETURN_IF_ERROR(builder->Finish(&arr));
+      PX_RETURN_IF_ERROR(part.AddColumn(arr));
+    }
+
+    auto& file = partitions_[partition];
+    if (file == nullptr) {
+      PX_ASSIGN_OR_RETURN(file, SpillFile::Create(dir_));
+    }
+    int64_t prev_bytes = file->bytes_written();
+    PX_RETURN_IF_ERROR(file->Append(part));
+    bytes_written_ += file->bytes_written() - prev_bytes;
+  }
+  return Status::OK();
+}
+
+Status SpillPartitions::ForEachBatch(int64_t partition,
+                                     const std::function<Status(const RowBatch&)>& fn) {
+  DCHECK_LT(partition, num_partitions());
+  if (partitions_[partition] == nullptr) {
+    return Status::OK();
+  }
+  return partitions_[partition]->ForEachBatch(fn);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
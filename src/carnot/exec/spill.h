@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arrow/memory_pool.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * SpillFile stores row batches in a file on local disk and reads them back in the order they were
+ * appended. The file is unlinked as soon as it's created, so its space is reclaimed when the
+ * SpillFile is destroyed, even if the process dies before then.
+ */
+class SpillFile : public NotCopyable {
+ public:
+  /**
+   * Creates an empty spill file in the given directory.
+   */
+  static StatusOr<std::unique_ptr<SpillFile>> Create(const std::string& dir);
+  ~SpillFile();
+
+  Status Append(const table_store::schema::RowBatch& rb);
+
+  /**
+   * Calls fn on every row batch appended so far, in order. More batches can be appended after.
+   */
+  Status ForEachBatch(const std::function<Status(const table_store::schema::RowBatch&)>& fn);
+
+  int64_t bytes_written() const { return bytes_written_; }
+  int64_t num_batches() const { return num_batches_; }
+
+ private:
+  explicit SpillFile(FILE* file) : file_(file) {}
+
+  FILE* file_;
+  int64_t bytes_written_ = 0;
+  int64_t num_batches_ = 0;
+};
+
+/**
+ * SpillPartitions hash partitions row batches on their key columns into spill files, so that all
+ * rows with the same key end up in the same partition. Operators that run out of memory spill their
+ * state here and later process it back one partition at a time.
+ *
+ * Partitions are not split any further, so a partition is read back into memory whole even if it
+ * is larger than the memory budget, e.g. when most rows share a few keys. Spilling bounds the
+ * memory of an operator to about 1/num_partitions of its state, not to the budget.
+ */
+class SpillPartitions : public NotCopyable {
+ public:
+  static constexpr int64_t kDefaultNumPartitions = 16;
+
+  /**
+   * @param dir The directory to create the spill files in.
+   * @param mem_pool The pool the batches of each partition are built from, which should be the
+   * query's, so that the memory used while spilling is accounted to it.
+   * @param num_partitions The number of partitions to split the rows into.
+   */
+  SpillPartitions(std::string dir, arrow::MemoryPool* mem_pool,
+                  int64_t num_partitions = kDefaultNumPartitions)
+      : dir_(std::move(dir)), mem_pool_(mem_pool), partitions_(num_partitions) {}
+
+  /**
+   * Splits the rows of a batch by the hash of their keys and appends them to their partitions.
+   * @param rb The row batch to spill.
+   * @param key_cols The indices of the key columns of the row batch.
+   */
+  Status Append(const table_store::schema::RowBatch& rb, const std::vector<int64_t>& key_cols);
+
+  /**
+   * Calls fn on every row batch spilled to the given partition.
+   */
+  Status ForEachBatch(int64_t partition,
+                      const std::function<Status(const table_store::schema::RowBatch&)>& fn);
+
+  int64_t num_partitions() const { return static_cast<int64_t>(partitions_.size()); }
+  int64_t bytes_written() const { return bytes_written_; }
+
+ private:
+  std::string dir_;
+  arrow::MemoryPool* mem_pool_;
+  // Created the first time a row is spilled to the partition.
+  std::vector<std::unique_ptr<SpillFile>> partitions_;
+  int64_t bytes_written_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
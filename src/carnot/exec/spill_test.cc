@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/spill.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+using ::testing::UnorderedElementsAre;
+
+TEST(SpillFileTest, write_and_read_back) {
+  ASSERT_OK_AND_ASSIGN(auto file, SpillFile::Create(::testing::TempDir()));
+  RowDescriptor rd({types::DataType::INT64, types::DataType::STRING});
+
+  ASSERT_OK(file->Append(*RowBatchBuilder(rd, 2, false, false)
+                              .AddColumn<types::Int64Value>({1, 2})
+                              .AddColumn<types::StringValue>({"a", "bc"})
+                              .get()));
+  ASSERT_OK(file->Append(*RowBatchBuilder(rd, 1, false, false)
+                              .AddColumn<types::Int64Value>({3})
+                              .AddColumn<types::StringValue>({"def"})
+                              .get()));
+  EXPECT_EQ(2, file->num_batches());
+  EXPECT_GT(file->bytes_written(), 0);
+
+  std::vector<int64_t> ints;
+  std::vector<std::string> strs;
+  auto collect = [&](const RowBatch& rb) {
+    for (int64_t i = 0; i < rb.num_rows(); ++i) {
+      ints.push_back(types::GetValueFromArrowArray<types::INT64>(rb.ColumnAt(0).get(), i));
+      strs.push_back(types::GetValueFromArrowArray<types::STRING>(rb.ColumnAt(1).get(), i));
+    }
+    return Status::OK();
+  };
+  ASSERT_OK(file->ForEachBatch(collect));
+  EXPECT_THAT(ints, ::testing::ElementsAre(1, 2, 3));
+  EXPECT_THAT(strs, ::testing::ElementsAre("a", "bc", "def"));
+
+  // Batches can still be appended after reading.
+  ASSERT_OK(file->Append(*RowBatchBuilder(rd, 1, false, false)
+                              .AddColumn<types::Int64Value>({4})
+                              .AddColumn<types::StringValue>({"g"})
+                              .get()));
+  ints.clear();
+  strs.clear();
+  ASSERT_OK(file->ForEachBatch(collect));
+  EXPECT_THAT(ints, ::testing::ElementsAre(1, 2, 3, 4));
+}
+
+TEST(SpillPartitionsTest, same_keys_same_partition) {
+  arrow::ProxyMemoryPool mem_pool(arrow::default_memory_pool());
+  SpillPartitions partitions(::testing::TempDir(), &mem_pool, 4);
+  RowDescriptor rd({types::DataType::STRING, types::DataType::INT64});
+
+  ASSERT_OK(partitions.Append(*RowBatchBuilder(rd, 4, false, false)
+                                   .AddColumn<types::StringValue>({"a", "b", "c", "a"})
+                                   .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                                   .get(),
+                               {0}));
+  ASSERT_OK(partitions.Append(*RowBatchBuilder(rd, 2, false, false)
+                                   .AddColumn<types::StringValue>({"b", "a"})
+                                   .AddColumn<types::Int64Value>({5, 6})
+                                   .get(),
+                               {0}));
+  EXPECT_GT(partitions.bytes_written(), 0);
+  // The partitioned batches are built from the given pool.
+  EXPECT_GT(mem_pool.max_memory(), 0);
+
+  std::vector<int64_t> all_values;
+  for (int64_t p = 0; p < partitions.num_partitions(); ++p) {
+    std::map<std::string, std::vector<int64_t>> values_by_key;
+    ASSERT_OK(partitions.ForEachBatch(p, [&](const RowBatch& rb) {
+      for (int64_t i = 0; i < rb.num_rows(); ++i) {
+        auto key = types::GetValueFromArrowArray<types::STRING>(rb.ColumnAt(0).get(), i);
+        auto value = types::GetValueFromArrowArray<types::INT64>(rb.ColumnAt(1).get(), i);
+        values_by_key[key].push_back(value);
+        all_values.push_back(value);
+      }
+      return Status::OK();
+    }));
+    // Every key found in this partition has all of its rows here.
+    for (const auto& [key, values] : values_by_key) {
+      if (key == "a") {
+        EXPECT_THAT(values, UnorderedElementsAre(1, 4, 6));
+      } else if (key == "b") {
+        EXPECT_THAT(values, UnorderedElementsAre(2, 5));
+      } else {
+        EXPECT_THAT(values, UnorderedElementsAre(3));
+      }
+    }
+  }
+  EXPECT_THAT(all_values, UnorderedElementsAre(1, 2, 3, 4, 5, 6));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
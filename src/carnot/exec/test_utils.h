@@ -283,6 +283,30 @@ class RowBatchBuilder {
     return *this;
   }
 
+  /**
+   * Add a dictionary encoded STRING column to the rowbatch. The dictionary holds the distinct
+   * values of col in the order they first appear.
+   * @param col The strings of the rows.
+   * @return the RowBatchBuilder, to allow for chaining.
+   */
+  RowBatchBuilder& AddDictionaryColumn(const std::vector<std::string>& col) {
+    std::vector<types::StringValue> dictionary;
+    arrow::Int32Builder codes_builder;
+    for (const auto& value : col) {
+      auto it = std::find(dictionary.begin(), dictionary.end(), value);
+      EXPECT_TRUE(codes_builder.Append(static_cast<int32_t>(it - dictionary.begin())).ok());
+      if (it == dictionary.end()) {
+        dictionary.emplace_back(value);
+      }
+    }
+    std::shared_ptr<arrow::Array> codes;
+    EXPECT_TRUE(codes_builder.Finish(&codes).ok());
+    EXPECT_OK(rb_->AddColumn(types::MakeStringDictionaryArray(
+        codes, types::ToArrow(dictionary, arrow::default_memory_pool()))));
+
+    return *this;
+  }
+
   /**
    * @return The rowbatch.
    */
@@ -342,6 +366,14 @@ class ExecNodeTester {
     EXPECT_OK(exec_node_->Prepare(exec_state_));
     EXPECT_OK(exec_node_->Open(exec_state_));
     FakePlanNode fake_plan(123);
+    // The mock child is given compacted and decoded batches, so the expected outputs don't depend
+    // on whether the node under test emits selections or dictionary columns.
+    EXPECT_CALL(mock_child_, SupportsSelection())
+        .Times(::testing::AnyNumber())
+        .WillRepeatedly(::testing::Return(false));
+    EXPECT_CALL(mock_child_, SupportsDictionaryColumns())
+        .Times(::testing::AnyNumber())
+        .WillRepeatedly(::testing::Return(false));
     EXPECT_CALL(mock_child_, InitImpl(::testing::_));
     EXPECT_CALL(mock_child_, PrepareImpl(::testing::_));
     EXPECT_CALL(mock_child_, OpenImpl(::testing::_));
@@ -430,6 +462,39 @@ class ExecNodeTester {
     return *this;
   }
 
+  /**
+   * Calls ConsumeNext on the execution node, for nodes that may output any number of row batches
+   * (ie. nodes that spill).
+   * @param rb The input rowbatch to ConsumeNext.
+   * @return the ExecNodeTester, to allow for chaining.
+   */
+  ExecNodeTester& ConsumeNextAnyOutput(const table_store::schema::RowBatch& rb,
+                                       int64_t parent_id) {
+    auto check_result_batch = [&](ExecState*, const table_store::schema::RowBatch& child_rb,
+                                  int64_t) {
+      current_row_batches_.push(std::make_unique<table_store::schema::RowBatch>(child_rb));
+    };
+
+    EXPECT_CALL(mock_child_, ConsumeNextImpl(::testing::_, ::testing::_, ::testing::_))
+        .Times(::testing::AnyNumber())
+        .WillRepeatedly(::testing::DoAll(::testing::Invoke(check_result_batch),
+                                         ::testing::Return(Status::OK())));
+    auto s = exec_node_->ConsumeNext(exec_state_, rb, parent_id);
+    EXPECT_OK(s) << s.msg();
+
+    return *this;
+  }
+
+  /**
+   * Checks that the data of all of the row batches output so far matches the expected row batch,
+   * regardless of how it was split into batches.
+   * @param expected_rb Row batch that should match the output.
+   * @return the ExecNodeTester, to allow for chaining.
+   */
+  ExecNodeTester& ExpectAllRowBatchesData(const table_store::schema::RowBatch& expected_rb) {
+    return ExpectRowBatchesData(expected_rb, current_row_batches_.size());
+  }
+
   /**
    * Checks that the row batch matches the last rowbatch output by ConsumeNext/GenerateNext.
    * @param expected_rb Row batch that should match the last rowbatch output by
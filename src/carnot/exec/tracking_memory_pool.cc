@@ -0,0 +1,79 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/tracking_memory_pool.h"
+
+DEFINE_int64(carnot_query_memory_limit_mb,
+             gflags::Int64FromEnv("PL_CARNOT_QUERY_MEMORY_LIMIT_MB", 0),
+             "The number of MB of arrow memory a query may allocate before it is failed. "
+             "0 means no limit.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+thread_local TrackingMemoryPool* ScopedExecMemoryPool::current_ = nullptr;
+
+void TrackingMemoryPool::AddBytes(int64_t delta) {
+  int64_t bytes = bytes_allocated_.fetch_add(delta) + delta;
+  if (delta > 0) {
+    total_bytes_allocated_ += delta;
+  }
+  int64_t peak = peak_bytes_.load();
+  while (bytes > peak && !peak_bytes_.compare_exchange_weak(peak, bytes)) {
+  }
+  int64_t limit_bytes = limit_bytes_;
+  if (limit_bytes > 0 && bytes > limit_bytes) {
+    limit_exceeded_ = true;
+  }
+}
+
+arrow::Status TrackingMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  auto status = arrow::ProxyMemoryPool::Allocate(size, out);
+  if (!status.ok()) {
+    return status;
+  }
+  ++refs_;
+  AddBytes(size);
+  return status;
+}
+
+arrow::Status TrackingMemoryPool::Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) {
+  auto status = arrow::ProxyMemoryPool::Reallocate(old_size, new_size, ptr);
+  if (!status.ok()) {
+    return status;
+  }
+  AddBytes(new_size - old_size);
+  return status;
+}
+
+void TrackingMemoryPool::Free(uint8_t* buffer, int64_t size) {
+  arrow::ProxyMemoryPool::Free(buffer, size);
+  AddBytes(-size);
+  Release();
+}
+
+void TrackingMemoryPool::Release() {
+  if (refs_.fetch_sub(1) == 1) {
+    delete this;
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+
+#include <atomic>
+#include <memory>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * TrackingMemoryPool forwards allocations to a parent pool and counts the bytes that go through
+ * it: the bytes currently allocated, the peak and the total ever allocated.
+ *
+ * A pool can have a limit. Allocations over the limit still succeed, since a lot of the code that
+ * builds arrays treats allocation failures as fatal, but the pool remembers that the limit was
+ * exceeded so the query can be failed at the next operator boundary.
+ *
+ * Arrow buffers keep a raw pointer to the pool that allocated them and can outlive the query
+ * (ie. batches written to the table store), so pools are reference counted: the owner and every
+ * outstanding allocation hold a reference, and the pool deletes itself when the last one goes away.
+ */
+class TrackingMemoryPool : public arrow::ProxyMemoryPool {
+ public:
+  struct Unref {
+    void operator()(TrackingMemoryPool* pool) const { pool->Release(); }
+  };
+  using Ptr = std::unique_ptr<TrackingMemoryPool, Unref>;
+
+  /**
+   * Creates a pool.
+   * @param parent The pool to allocate from.
+   * @param limit_bytes The number of bytes the pool may hold, 0 means no limit.
+   */
+  static Ptr Create(arrow::MemoryPool* parent, int64_t limit_bytes = 0) {
+    return Ptr(new TrackingMemoryPool(parent, limit_bytes));
+  }
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override;
+  void Free(uint8_t* buffer, int64_t size) override;
+
+  int64_t bytes_allocated() const override { return bytes_allocated_; }
+  int64_t max_memory() const override { return peak_bytes_; }
+
+  int64_t peak_bytes() const { return peak_bytes_; }
+  int64_t total_bytes_allocated() const { return total_bytes_allocated_; }
+  int64_t limit_bytes() const { return limit_bytes_; }
+  void set_limit_bytes(int64_t limit_bytes) { limit_bytes_ = limit_bytes; }
+  bool limit_exceeded() const { return limit_exceeded_; }
+
+ private:
+  TrackingMemoryPool(arrow::MemoryPool* parent, int64_t limit_bytes)
+      : arrow::ProxyMemoryPool(parent), limit_bytes_(limit_bytes) {}
+  ~TrackingMemoryPool() override = default;
+
+  void AddBytes(int64_t delta);
+  void Release();
+
+  std::atomic<int64_t> limit_bytes_;
+  std::atomic<int64_t> bytes_allocated_ = 0;
+  std::atomic<int64_t> peak_bytes_ = 0;
+  std::atomic<int64_t> total_bytes_allocated_ = 0;
+  std::atomic<bool> limit_exceeded_ = false;
+  // One for the owner plus one per outstanding allocation.
+  std::atomic<int64_t> refs_ = 1;
+};
+
+/**
+ * Makes a pool the one that ExecState::exec_mem_pool() returns on this thread, for the lifetime of
+ * the object. Exec nodes use this to attribute the allocations they make to themselves.
+ */
+class ScopedExecMemoryPool {
+ public:
+  explicit ScopedExecMemoryPool(TrackingMemoryPool* pool) : prev_(current_) {
+    if (pool != nullptr) {
+      current_ = pool;
+    }
+  }
+  ~ScopedExecMemoryPool() { current_ = prev_; }
+
+  /**
+   * @return The pool in scope on this thread, or nullptr if there is none.
+   */
+  static TrackingMemoryPool* current() { return current_; }
+
+ private:
+  TrackingMemoryPool* prev_;
+  static thread_local TrackingMemoryPool* current_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
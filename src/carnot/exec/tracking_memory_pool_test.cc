@@ -0,0 +1,121 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <arrow/buffer.h>
+
+#include <memory>
+
+#include "src/carnot/exec/tracking_memory_pool.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+TEST(TrackingMemoryPoolTest, counts_bytes) {
+  auto pool = TrackingMemoryPool::Create(arrow::default_memory_pool());
+
+  uint8_t* a;
+  uint8_t* b;
+  ASSERT_TRUE(pool->Allocate(128, &a).ok());
+  ASSERT_TRUE(pool->Allocate(64, &b).ok());
+  EXPECT_EQ(192, pool->bytes_allocated());
+
+  ASSERT_TRUE(pool->Reallocate(64, 256, &b).ok());
+  EXPECT_EQ(384, pool->bytes_allocated());
+
+  pool->Free(a, 128);
+  EXPECT_EQ(256, pool->bytes_allocated());
+  pool->Free(b, 256);
+  EXPECT_EQ(0, pool->bytes_allocated());
+
+  EXPECT_EQ(384, pool->peak_bytes());
+  EXPECT_EQ(384, pool->total_bytes_allocated());
+  EXPECT_FALSE(pool->limit_exceeded());
+}
+
+TEST(TrackingMemoryPoolTest, child_allocates_from_parent) {
+  auto parent = TrackingMemoryPool::Create(arrow::default_memory_pool());
+  auto child = TrackingMemoryPool::Create(parent.get());
+
+  uint8_t* a;
+  ASSERT_TRUE(child->Allocate(100, &a).ok());
+  EXPECT_EQ(100, child->bytes_allocated());
+  EXPECT_EQ(100, parent->bytes_allocated());
+
+  child->Free(a, 100);
+  EXPECT_EQ(0, parent->bytes_allocated());
+  EXPECT_EQ(100, parent->peak_bytes());
+}
+
+TEST(TrackingMemoryPoolTest, limit_exceeded) {
+  auto parent = TrackingMemoryPool::Create(arrow::default_memory_pool(), 1000);
+  auto child = TrackingMemoryPool::Create(parent.get());
+
+  uint8_t* a;
+  uint8_t* b;
+  ASSERT_TRUE(child->Allocate(600, &a).ok());
+  EXPECT_FALSE(parent->limit_exceeded());
+  // Allocations over the limit still succeed but are flagged.
+  ASSERT_TRUE(child->Allocate(600, &b).ok());
+  EXPECT_TRUE(parent->limit_exceeded());
+  EXPECT_FALSE(child->limit_exceeded());
+
+  // The flag sticks once set.
+  child->Free(b, 600);
+  child->Free(a, 600);
+  EXPECT_TRUE(parent->limit_exceeded());
+}
+
+TEST(TrackingMemoryPoolTest, buffers_outlive_owner) {
+  std::shared_ptr<arrow::Buffer> buffer;
+  {
+    auto pool = TrackingMemoryPool::Create(arrow::default_memory_pool());
+    ASSERT_TRUE(arrow::AllocateBuffer(pool.get(), 1024, &buffer).ok());
+    EXPECT_EQ(1024, pool->bytes_allocated());
+  }
+  // The pool is kept alive until the buffer is freed.
+  ASSERT_NE(nullptr, buffer->data());
+  buffer.reset();
+}
+
+TEST(ScopedExecMemoryPoolTest, nests) {
+  auto outer = TrackingMemoryPool::Create(arrow::default_memory_pool());
+  auto inner = TrackingMemoryPool::Create(arrow::default_memory_pool());
+
+  EXPECT_EQ(nullptr, ScopedExecMemoryPool::current());
+  {
+    ScopedExecMemoryPool scoped_outer(outer.get());
+    EXPECT_EQ(outer.get(), ScopedExecMemoryPool::current());
+    {
+      ScopedExecMemoryPool scoped_inner(inner.get());
+      EXPECT_EQ(inner.get(), ScopedExecMemoryPool::current());
+      ScopedExecMemoryPool scoped_none(nullptr);
+      EXPECT_EQ(inner.get(), ScopedExecMemoryPool::current());
+    }
+    EXPECT_EQ(outer.get(), ScopedExecMemoryPool::current());
+  }
+  EXPECT_EQ(nullptr, ScopedExecMemoryPool::current());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/work_stealing_pool.h"
+
+#include <algorithm>
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+WorkStealingPool::WorkStealingPool(int32_t num_workers) {
+  num_workers = std::max(num_workers, 1);
+  for (int32_t i = 0; i < num_workers; ++i) {
+    queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+  // Worker 0 is the thread calling ParallelFor().
+  for (int32_t i = 1; i < num_workers; ++i) {
+    threads_.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    shutdown_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+bool WorkStealingPool::PopOrSteal(int32_t worker, size_t* task) {
+  {
+    WorkerQueue* own = queues_[worker].get();
+    std::lock_guard<std::mutex> lock(own->mu);
+    if (!own->tasks.empty()) {
+      *task = own->tasks.front();
+      own->tasks.pop_front();
+      return true;
+    }
+  }
+  for (int32_t i = 1; i < num_workers(); ++i) {
+    WorkerQueue* victim = queues_[(worker + i) % num_workers()].get();
+    std::lock_guard<std::mutex> lock(victim->mu);
+    if (!victim->tasks.empty()) {
+      *task = victim->tasks.back();
+      victim->tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingPool::RunTasks(int32_t worker, const std::function<void(int32_t, size_t)>* fn) {
+  if (fn == nullptr) {
+    return;
+  }
+  size_t task;
+  while (PopOrSteal(worker, &task)) {
+    (*fn)(worker, task);
+  }
+}
+
+void WorkStealingPool::WorkerLoop(int32_t worker) {
+  uint64_t seen_generation = 0;
+  while (true) {
+    const std::function<void(int32_t, size_t)>* fn;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      work_cv_.wait(lock, [&] { return shutdown_ || generation_ != seen_generation; });
+      if (shutdown_) {
+        return;
+      }
+      seen_generation = generation_;
+      fn = fn_;
+      ++active_workers_;
+    }
+    RunTasks(worker, fn);
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      --active_workers_;
+    }
+    done_cv_.notify_all();
+  }
+}
+
+void WorkStealingPool::ParallelFor(size_t num_tasks,
+                                   const std::function<void(int32_t, size_t)>& fn) {
+  if (num_tasks == 0) {
+    return;
+  }
+  if (threads_.empty()) {
+    for (size_t i = 0; i < num_tasks; ++i) {
+      fn(0, i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (size_t i = 0; i < num_tasks; ++i) {
+      WorkerQueue* queue = queues_[i % queues_.size()].get();
+      std::lock_guard<std::mutex> queue_lock(queue->mu);
+      queue->tasks.push_back(i);
+    }
+    fn_ = &fn;
+    ++generation_;
+  }
+  work_cv_.notify_all();
+
+  RunTasks(0, &fn);
+
+  // All tasks have been claimed once worker 0 runs out of work; wait for the pool threads to
+  // finish the ones they are still executing before fn goes out of scope.
+  std::unique_lock<std::mutex> lock(mu_);
+  done_cv_.wait(lock, [this] { return active_workers_ == 0; });
+  fn_ = nullptr;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
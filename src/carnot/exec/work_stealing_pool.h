@@ -0,0 +1,88 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * WorkStealingPool runs batches of independent tasks across a fixed set of workers.
+ *
+ * Tasks are distributed round-robin into per-worker queues. A worker drains its own queue from
+ * the front and, once empty, steals from the back of the other workers' queues, so a skewed
+ * distribution of task cost still keeps every worker busy.
+ *
+ * The thread calling ParallelFor() participates as worker 0, so a pool with N workers only owns
+ * N-1 threads. Each task is told which worker runs it, which lets callers keep per-worker state
+ * (such as a private copy of an operator chain) without any locking.
+ */
+class WorkStealingPool : public NotCopyable {
+ public:
+  explicit WorkStealingPool(int32_t num_workers);
+  ~WorkStealingPool();
+
+  int32_t num_workers() const { return static_cast<int32_t>(queues_.size()); }
+
+  /**
+   * Runs fn(worker_id, task_id) for every task_id in [0, num_tasks) and blocks until all of them
+   * have completed. Must not be called concurrently from multiple threads.
+   */
+  void ParallelFor(size_t num_tasks, const std::function<void(int32_t, size_t)>& fn);
+
+ private:
+  struct WorkerQueue {
+    std::mutex mu;
+    std::deque<size_t> tasks;
+  };
+
+  bool PopOrSteal(int32_t worker, size_t* task);
+  void RunTasks(int32_t worker, const std::function<void(int32_t, size_t)>* fn);
+  void WorkerLoop(int32_t worker);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mu_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  // The function for the batch currently being executed. Guarded by mu_.
+  const std::function<void(int32_t, size_t)>* fn_ = nullptr;
+  // Incremented every time a new batch is submitted. Guarded by mu_.
+  uint64_t generation_ = 0;
+  // The number of pool threads currently running tasks of a batch. Guarded by mu_.
+  int32_t active_workers_ = 0;
+  bool shutdown_ = false;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/work_stealing_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+TEST(WorkStealingPoolTest, runs_every_task_once) {
+  WorkStealingPool pool(4);
+  EXPECT_EQ(4, pool.num_workers());
+
+  // Run several batches to make sure the pool can be reused.
+  for (int batch = 0; batch < 100; ++batch) {
+    std::vector<std::atomic<int>> counts(257);
+    pool.ParallelFor(counts.size(), [&](int32_t, size_t task) { ++counts[task]; });
+    for (const auto& count : counts) {
+      EXPECT_EQ(1, count.load());
+    }
+  }
+}
+
+TEST(WorkStealingPoolTest, worker_ids_in_range) {
+  WorkStealingPool pool(3);
+  std::atomic<bool> out_of_range = false;
+  pool.ParallelFor(64, [&](int32_t worker, size_t) {
+    if (worker < 0 || worker >= 3) {
+      out_of_range = true;
+    }
+  });
+  EXPECT_FALSE(out_of_range);
+}
+
+TEST(WorkStealingPoolTest, idle_workers_steal) {
+  WorkStealingPool pool(2);
+  // Task 0 lands in worker 0's queue and blocks until another task has run, which can only
+  // happen if worker 1 steals from worker 0's queue once its own queue is empty.
+  std::atomic<int> completed = 0;
+  pool.ParallelFor(4, [&](int32_t, size_t task) {
+    if (task == 0) {
+      while (completed < 3) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+    ++completed;
+  });
+  EXPECT_EQ(4, completed);
+}
+
+TEST(WorkStealingPoolTest, single_worker_runs_inline) {
+  WorkStealingPool pool(1);
+  std::vector<int32_t> workers;
+  pool.ParallelFor(5, [&](int32_t worker, size_t) { workers.push_back(worker); });
+  EXPECT_EQ(std::vector<int32_t>({0, 0, 0, 0, 0}), workers);
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -18,6 +18,12 @@
 
 #include "src/carnot/funcs/builtins/json_ops.h"
 
+#include <algorithm>
+#include <limits>
+
+#include <rapidjson/encodedstream.h>
+#include <rapidjson/memorystream.h>
+
 #include "src/carnot/udf/registry.h"
 
 namespace px {
@@ -26,11 +32,234 @@ namespace builtins {
 
 using types::StringValue;
 
+namespace internal {
+
+/**
+ * The SAX handler of JSONKeyScanner. It tracks the nesting depth to tell the members of the root
+ * object apart from nested ones, and records the values of the members the scanner looks for.
+ * Returning false from a handler stops the parse with an error, which is how roots that aren't
+ * objects are rejected.
+ */
+class JSONKeyScanner::Handler
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JSONKeyScanner::Handler> {
+ public:
+  explicit Handler(JSONKeyScanner* scanner) : scanner_(scanner) {}
+
+  bool Null() {
+    if (capture_idx_ >= 0) {
+      return !writing() || scanner_->writer_.Null();
+    }
+    // Null members are treated as missing.
+    pending_idx_ = -1;
+    return depth_ > 0;
+  }
+  bool Bool(bool b) {
+    return Scalar([&](auto* writer) { return writer->Bool(b); }, [](PluckedJSONValue*) {});
+  }
+  bool Int(int i) { return Int64(i); }
+  bool Uint(unsigned u) { return Int64(u); }
+  bool Int64(int64_t i) {
+    return Scalar([&](auto* writer) { return writer->Int64(i); },
+                  [&](PluckedJSONValue* value) {
+                    value->is_int64 = true;
+                    value->int64_value = i;
+                  });
+  }
+  bool Uint64(uint64_t u) {
+    return Scalar([&](auto* writer) { return writer->Uint64(u); },
+                  [&](PluckedJSONValue* value) {
+                    // Matches rapidjson::Value::IsInt64, which only holds if the value fits.
+                    if (u <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+                      value->is_int64 = true;
+                      value->int64_value = static_cast<int64_t>(u);
+                    }
+                  });
+  }
+  bool Double(double d) {
+    return Scalar([&](auto* writer) { return writer->Double(d); },
+                  [&](PluckedJSONValue* value) {
+                    value->is_double = true;
+                    value->double_value = d;
+                  });
+  }
+  bool String(const char* str, rapidjson::SizeType length, bool) {
+    if (capture_idx_ >= 0) {
+      return !writing() || scanner_->writer_.String(str, length);
+    }
+    if (depth_ == 0) {
+      return false;
+    }
+    if (pending_idx_ >= 0) {
+      PluckedJSONValue* value = Found(pending_idx_);
+      if (scanner_->keep_text_) {
+        // Strings are returned as is, without the quotes and escapes of their JSON form.
+        value->text.assign(str, length);
+      }
+      pending_idx_ = -1;
+    }
+    return true;
+  }
+
+  bool StartObject() { return StartContainer(/*is_object*/ true); }
+  bool EndObject(rapidjson::SizeType) { return EndContainer(/*is_object*/ true); }
+  bool StartArray() { return StartContainer(/*is_object*/ false); }
+  bool EndArray(rapidjson::SizeType) { return EndContainer(/*is_object*/ false); }
+
+  bool Key(const char* str, rapidjson::SizeType length, bool) {
+    if (capture_idx_ >= 0) {
+      return !writing() || scanner_->writer_.Key(str, length);
+    }
+    if (depth_ != 1) {
+      return true;
+    }
+    int64_t key_idx = scanner_->KeyIndex(std::string_view(str, length));
+    // Only the first member with the key counts, as it does for rapidjson::Value::FindMember.
+    if (key_idx >= 0 && !scanner_->seen_[key_idx]) {
+      scanner_->seen_[key_idx] = true;
+      pending_idx_ = key_idx;
+    } else {
+      pending_idx_ = -1;
+    }
+    return true;
+  }
+
+ private:
+  bool writing() const { return capture_idx_ >= 0 && scanner_->keep_text_; }
+
+  PluckedJSONValue* Found(int64_t key_idx) {
+    PluckedJSONValue* value = &scanner_->values_[key_idx];
+    value->found = true;
+    return value;
+  }
+
+  void ResetWriter() {
+    scanner_->sb_.Clear();
+    scanner_->writer_.Reset(scanner_->sb_);
+  }
+
+  void TakeText(PluckedJSONValue* value) {
+    value->text.assign(scanner_->sb_.GetString(), scanner_->sb_.GetSize());
+  }
+
+  template <typename TWrite, typename TRecord>
+  bool Scalar(TWrite write, TRecord record) {
+    if (capture_idx_ >= 0) {
+      return !writing() || write(&scanner_->writer_);
+    }
+    if (depth_ == 0) {
+      return false;
+    }
+    if (pending_idx_ >= 0) {
+      PluckedJSONValue* value = Found(pending_idx_);
+      record(value);
+      if (scanner_->keep_text_) {
+        ResetWriter();
+        write(&scanner_->writer_);
+        TakeText(value);
+      }
+      pending_idx_ = -1;
+    }
+    return true;
+  }
+
+  bool StartContainer(bool is_object) {
+    if (capture_idx_ >= 0) {
+      ++depth_;
+      if (!writing()) {
+        return true;
+      }
+      return is_object ? scanner_->writer_.StartObject() : scanner_->writer_.StartArray();
+    }
+    if (depth_ == 0 && !is_object) {
+      return false;
+    }
+    if (depth_ == 1 && pending_idx_ >= 0) {
+      // A nested value of one of the keys, which is captured until its container is closed.
+      capture_idx_ = pending_idx_;
+      pending_idx_ = -1;
+      if (writing()) {
+        ResetWriter();
+        is_object ? scanner_->writer_.StartObject() : scanner_->writer_.StartArray();
+      }
+    }
+    ++depth_;
+    return true;
+  }
+
+  bool EndContainer(bool is_object) {
+    --depth_;
+    if (capture_idx_ < 0) {
+      return true;
+    }
+    if (writing() && !(is_object ? scanner_->writer_.EndObject() : scanner_->writer_.EndArray())) {
+      return false;
+    }
+    if (depth_ == 1) {
+      PluckedJSONValue* value = Found(capture_idx_);
+      if (scanner_->keep_text_) {
+        TakeText(value);
+      }
+      capture_idx_ = -1;
+    }
+    return true;
+  }
+
+  JSONKeyScanner* scanner_;
+  // The number of containers the parser is in, 1 while in the root object.
+  int64_t depth_ = 0;
+  // The key whose value is next, if that is one of the keys the scanner looks for.
+  int64_t pending_idx_ = -1;
+  // The key whose nested value is being captured.
+  int64_t capture_idx_ = -1;
+};
+
+void JSONKeyScanner::SetKeys(std::vector<std::string> keys) {
+  keys_ = std::move(keys);
+  values_.resize(keys_.size());
+  seen_.resize(keys_.size());
+}
+
+int64_t JSONKeyScanner::KeyIndex(std::string_view key) const {
+  // The scanners look for a handful of keys, so a linear search beats hashing the key.
+  for (size_t i = 0; i < keys_.size(); ++i) {
+    if (keys_[i] == key) {
+      return static_cast<int64_t>(i);
+    }
+  }
+  return -1;
+}
+
+bool JSONKeyScanner::Scan(std::string_view in) {
+  for (auto& value : values_) {
+    value.found = false;
+    value.is_int64 = false;
+    value.is_double = false;
+  }
+  std::fill(seen_.begin(), seen_.end(), false);
+
+  Handler handler(this);
+  rapidjson::MemoryStream ms(in.data(), in.size());
+  rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream> is(ms);
+  if (reader_.Parse(is, handler).IsError()) {
+    // Nothing is plucked from invalid JSON, even the keys that came before the error.
+    for (auto& value : values_) {
+      value.found = false;
+    }
+    return false;
+  }
+  return true;
+}
+
+}  // namespace internal
+
 void RegisterJSONOpsOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<PluckUDF>("pluck");
   registry->RegisterOrDie<PluckAsInt64UDF>("pluck_int64");
   registry->RegisterOrDie<PluckAsFloat64UDF>("pluck_float64");
   registry->RegisterOrDie<PluckArrayUDF>("pluck_array");
+  registry->RegisterOrDie<PluckMultiUDF<types::DataType::STRING>>("_pluck_multi");
+  registry->RegisterOrDie<PluckMultiUDF<types::DataType::INT64>>("_pluck_multi_int64");
+  registry->RegisterOrDie<PluckMultiUDF<types::DataType::FLOAT64>>("_pluck_multi_float64");
 
   // Up to 8 script args are supported for the _script_reference UDF, due to the lack of support for
   // variadic UDF arguments in the UDF registry today. We should clean this up if/when variadic UDF
@@ -18,14 +18,18 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include <rapidjson/document.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include "src/carnot/udf/column_view.h"
 #include "src/carnot/udf/registry.h"
 #include "src/carnot/udf/udf.h"
 
@@ -33,37 +37,127 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+namespace internal {
+
+/**
+ * The value of a top-level member of a JSON object, as found by JSONKeyScanner.
+ */
+struct PluckedJSONValue {
+  // False if the member is missing or null, or if the input isn't a valid JSON object.
+  bool found = false;
+  bool is_int64 = false;
+  bool is_double = false;
+  int64_t int64_value = 0;
+  double double_value = 0.0;
+  // Strings as is, every other value serialized as JSON. Only set if the scanner keeps text.
+  std::string text;
+};
+
+/**
+ * JSONKeyScanner finds the values of a fixed set of top-level keys in serialized JSON objects.
+ * Instead of parsing each input into a document, it runs the rapidjson SAX reader over it and only
+ * copies out the values of the keys it looks for, so once warm scanning a row doesn't allocate.
+ * The whole input is still validated, and the values found are the ones a lookup in the parsed
+ * rapidjson::Document returns: the first occurrence of each key, with null values treated as
+ * missing.
+ */
+class JSONKeyScanner {
+ public:
+  /**
+   * @param keep_text: whether to keep the text of the values found, which pluck needs but
+   * pluck_int64 and pluck_float64 don't.
+   */
+  explicit JSONKeyScanner(bool keep_text) : keep_text_(keep_text) {}
+
+  void SetKeys(std::vector<std::string> keys);
+  const std::vector<std::string>& keys() const { return keys_; }
+
+  /**
+   * Returns the index of key in keys(), or -1 if the scanner doesn't look for it.
+   */
+  int64_t KeyIndex(std::string_view key) const;
+
+  /**
+   * Scans the serialized JSON object in `in` for the keys. Returns false, with none of the values
+   * found, if `in` isn't a valid JSON object.
+   */
+  bool Scan(std::string_view in);
+
+  const PluckedJSONValue& value(size_t key_idx) const { return values_[key_idx]; }
+
+  /**
+   * Returns the value of `key` in `in` the way the pluck UDF returning T does. String results
+   * point into the scanner and are only valid until the next scan.
+   */
+  template <types::DataType T>
+  udf::ColumnValueType<T> Pluck(std::string_view in, std::string_view key);
+
+ private:
+  class Handler;
+
+  bool keep_text_;
+  std::vector<std::string> keys_;
+  std::vector<PluckedJSONValue> values_;
+  // Whether each key was seen in the current object, including with a null value.
+  std::vector<bool> seen_;
+  rapidjson::Reader reader_;
+  // Serializes the non-string values that are kept as text.
+  rapidjson::StringBuffer sb_;
+  rapidjson::Writer<rapidjson::StringBuffer> writer_{sb_};
+};
+
+/**
+ * Converts a plucked value to the result of the pluck UDF returning T.
+ */
+template <types::DataType T>
+udf::ColumnValueType<T> PluckedValueAs(const PluckedJSONValue& value) {
+  // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
+  if constexpr (T == types::DataType::STRING) {
+    return value.found ? std::string_view(value.text) : std::string_view();
+  } else if constexpr (T == types::DataType::INT64) {
+    return value.found && value.is_int64 ? value.int64_value : 0;
+  } else {
+    static_assert(T == types::DataType::FLOAT64);
+    return value.found && value.is_double ? value.double_value : 0.0;
+  }
+}
+
+template <types::DataType T>
+udf::ColumnValueType<T> JSONKeyScanner::Pluck(std::string_view in, std::string_view key) {
+  if (keys_.size() != 1 || keys_[0] != key) {
+    SetKeys({std::string(key)});
+  }
+  Scan(in);
+  return PluckedValueAs<T>(values_[0]);
+}
+
+/**
+ * Runs the single-key pluck returning T over a batch.
+ */
+template <types::DataType T>
+void PluckBatch(const udf::StringColumnView& in, const udf::StringColumnView& key,
+                JSONKeyScanner* scanner, udf::ColumnWriter<T>* out) {
+  for (int64_t idx = 0; idx < in.size(); ++idx) {
+    out->Append(scanner->Pluck<T>(in[idx], key[idx]));
+  }
+}
+
+}  // namespace internal
+
 // TODO(zasgar): PL-419 To have proper support for JSON we need structs and nullable types.
 // Revisit when we have them.
 class PluckUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
-    // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return "";
-    }
-    if (!d.IsObject()) {
-      return "";
-    }
-    if (!d.HasMember(key.data())) {
-      return "";
-    }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
-      return "";
-    }
-    if (plucked_value.IsString()) {
-      return plucked_value.GetString();
-    }
+    return StringValue(scanner_.Pluck<types::DataType::STRING>(in, key));
+  }
 
-    // This is robust to nested JSON.
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    plucked_value.Accept(writer);
-    return sb.GetString();
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& in,
+                   const udf::StringColumnView& key, udf::StringColumnWriter* out) {
+    internal::PluckBatch(in, key, &scanner_, out);
+    return Status::OK();
   }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Grabs the value for the key value the serialized JSON string and returns as a "
@@ -82,32 +176,23 @@ class PluckUDF : public udf::ScalarUDF {
         .Arg("key", "The key to get the value for.")
         .Returns("The value for the key as a string.");
   }
+
+ private:
+  internal::JSONKeyScanner scanner_{/*keep_text*/ true};
 };
 
 class PluckAsInt64UDF : public udf::ScalarUDF {
  public:
   Int64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
-    // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return 0;
-    }
-    if (!d.IsObject()) {
-      return 0;
-    }
-    if (!d.HasMember(key.data())) {
-      return 0;
-    }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
-      return 0;
-    }
-    if (plucked_value.IsInt64()) {
-      return plucked_value.GetInt64();
-    }
-    return 0;
+    return scanner_.Pluck<types::DataType::INT64>(in, key);
+  }
+
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& in,
+                   const udf::StringColumnView& key, udf::Int64ColumnWriter* out) {
+    internal::PluckBatch(in, key, &scanner_, out);
+    return Status::OK();
   }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Grabs the value for the key from the serialized JSON string and returns as an int.")
@@ -126,32 +211,23 @@ class PluckAsInt64UDF : public udf::ScalarUDF {
         .Arg("key", "The key to get the value for.")
         .Returns("The value for the key as an int.");
   }
+
+ private:
+  internal::JSONKeyScanner scanner_{/*keep_text*/ false};
 };
 
 class PluckAsFloat64UDF : public udf::ScalarUDF {
  public:
   Float64Value Exec(FunctionContext*, StringValue in, StringValue key) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(in.data());
-    // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
-    if (ok == nullptr) {
-      return 0.0;
-    }
-    if (!d.IsObject()) {
-      return 0.0;
-    }
-    if (!d.HasMember(key.data())) {
-      return 0.0;
-    }
-    const auto& plucked_value = d[key.data()];
-    if (plucked_value.IsNull()) {
-      return 0.0;
-    }
-    if (plucked_value.IsDouble()) {
-      return plucked_value.GetDouble();
-    }
-    return 0.0;
+    return scanner_.Pluck<types::DataType::FLOAT64>(in, key);
+  }
+
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& in,
+                   const udf::StringColumnView& key, udf::Float64ColumnWriter* out) {
+    internal::PluckBatch(in, key, &scanner_, out);
+    return Status::OK();
   }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Grabs the value for the key from the serialized JSON string and returns as a "
@@ -173,6 +249,122 @@ class PluckAsFloat64UDF : public udf::ScalarUDF {
         .Arg("key", "The key to get the value for.")
         .Returns("The value for the key as a float");
   }
+
+ private:
+  internal::JSONKeyScanner scanner_{/*keep_text*/ false};
+};
+
+/**
+  DocString intentionally omitted, this is a non-public function.
+  The compiler rewrites the px.pluck, px.pluck_int64 and px.pluck_float64 calls of a map that read
+  different keys from the same column into calls of PluckMultiUDF (see FuseColumnScansRule). The
+  init arg holds all of the keys read from the column as a JSON array of strings. Since the
+  rewritten calls have the same init args, they share one instance of the UDF, which scans each
+  batch once for all of the keys and answers the remaining calls for that batch from the values it
+  cached.
+ */
+template <types::DataType T>
+class PluckMultiUDF : public udf::ScalarUDF {
+ public:
+  using ReturnValue = typename types::DataTypeTraits<T>::value_type;
+
+  Status Init(FunctionContext*, StringValue keys_json) {
+    rapidjson::Document d;
+    rapidjson::ParseResult ok = d.Parse(keys_json.data(), keys_json.size());
+    if (ok == nullptr || !d.IsArray()) {
+      return error::InvalidArgument("Expected a JSON array of keys, got '$0'", keys_json);
+    }
+    std::vector<std::string> keys;
+    for (const auto& key : d.GetArray()) {
+      if (!key.IsString()) {
+        return error::InvalidArgument("Expected a JSON array of keys, got '$0'", keys_json);
+      }
+      keys.emplace_back(key.GetString(), key.GetStringLength());
+    }
+    multi_scanner_.SetKeys(std::move(keys));
+    return Status::OK();
+  }
+
+  ReturnValue Exec(FunctionContext*, StringValue in, StringValue key) {
+    return ReturnValue(single_scanner_.Pluck<T>(in, key));
+  }
+
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& in,
+                   const udf::StringColumnView& key, udf::ColumnWriter<T>* out) {
+    if (in.size() == 0) {
+      return Status::OK();
+    }
+    int64_t key_idx = multi_scanner_.KeyIndex(key[0]);
+    std::shared_ptr<arrow::ArrayData> in_data = in.arrow_data();
+    if (key_idx < 0 || in_data == nullptr) {
+      // Either not one of the fused keys, or a column that can't be recognized when it is passed
+      // again, so there is nothing to share with the other calls.
+      internal::PluckBatch(in, key, &single_scanner_, out);
+      return Status::OK();
+    }
+    if (in_data != cached_in_ || in.size() != cached_size_) {
+      CacheBatch(in);
+      cached_in_ = std::move(in_data);
+      cached_size_ = in.size();
+    }
+    const auto& values = cached_values_[key_idx];
+    for (int64_t idx = 0; idx < in.size(); ++idx) {
+      if (key[idx] == key[0]) {
+        out->Append(values[idx]);
+      } else {
+        out->Append(single_scanner_.Pluck<T>(in[idx], key[idx]));
+      }
+    }
+    return Status::OK();
+  }
+
+ private:
+  // Scans every row of the batch for all of the keys and caches the results, by key and row.
+  void CacheBatch(const udf::StringColumnView& in) {
+    size_t num_keys = multi_scanner_.keys().size();
+    cached_values_.resize(num_keys);
+    for (auto& values : cached_values_) {
+      values.resize(in.size());
+    }
+    if constexpr (T == types::DataType::STRING) {
+      // The strings are copied into one buffer, which can move as it grows, so they are recorded
+      // as offsets and only turned into views once the whole batch is scanned.
+      cached_text_.clear();
+      cached_text_offsets_.resize(num_keys * in.size());
+    }
+    for (int64_t idx = 0; idx < in.size(); ++idx) {
+      multi_scanner_.Scan(in[idx]);
+      for (size_t k = 0; k < num_keys; ++k) {
+        auto value = internal::PluckedValueAs<T>(multi_scanner_.value(k));
+        if constexpr (T == types::DataType::STRING) {
+          cached_text_offsets_[k * in.size() + idx] = {cached_text_.size(), value.size()};
+          cached_text_.append(value);
+        } else {
+          cached_values_[k][idx] = value;
+        }
+      }
+    }
+    if constexpr (T == types::DataType::STRING) {
+      for (size_t k = 0; k < num_keys; ++k) {
+        for (int64_t idx = 0; idx < in.size(); ++idx) {
+          const auto& [offset, size] = cached_text_offsets_[k * in.size() + idx];
+          cached_values_[k][idx] = std::string_view(cached_text_).substr(offset, size);
+        }
+      }
+    }
+  }
+
+  static constexpr bool kKeepText = T == types::DataType::STRING;
+  internal::JSONKeyScanner multi_scanner_{kKeepText};
+  internal::JSONKeyScanner single_scanner_{kKeepText};
+
+  // The input column of the cached batch, held on to so that it can't be freed and its address
+  // reused by another batch while it is cached.
+  std::shared_ptr<arrow::ArrayData> cached_in_;
+  int64_t cached_size_ = 0;
+  std::vector<std::vector<udf::ColumnValueType<T>>> cached_values_;
+  std::string cached_text_;
+  std::vector<std::pair<size_t, size_t>> cached_text_offsets_;
 };
 
 class PluckArrayUDF : public udf::ScalarUDF {
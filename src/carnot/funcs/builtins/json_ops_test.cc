@@ -18,6 +18,10 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "src/carnot/funcs/builtins/json_ops.h"
 #include "src/carnot/udf/test_utils.h"
 
@@ -111,6 +115,99 @@ TEST(JSONOps, PluckArrayUDF_index_out_of_bound) {
   udf_tester.ForInput(kTestJSONArray, 3).Expect("");
 }
 
+TEST(JSONOps, JSONKeyScanner_matches_document_lookup) {
+  internal::JSONKeyScanner scanner(/*keep_text*/ true);
+  scanner.SetKeys({"a", "b", "c", "d", "e", "f"});
+
+  // Only top-level members count, the first one wins, and null values are missing.
+  ASSERT_TRUE(scanner.Scan(
+      R"({"x": {"a": 1, "b": [2]}, "a": "first", "a": "second", "b": null, "c": [1, {"d": 2}],)"
+      R"( "d": "q\"uote", "e": 18446744073709551615, "f": -7})"));
+  EXPECT_TRUE(scanner.value(0).found);
+  EXPECT_EQ("first", scanner.value(0).text);
+  EXPECT_FALSE(scanner.value(1).found);
+  EXPECT_TRUE(scanner.value(2).found);
+  EXPECT_EQ(R"([1,{"d":2}])", scanner.value(2).text);
+  EXPECT_EQ("q\"uote", scanner.value(3).text);
+  // Like rapidjson::Value::IsInt64, unsigned values that don't fit aren't int64.
+  EXPECT_TRUE(scanner.value(4).found);
+  EXPECT_FALSE(scanner.value(4).is_int64);
+  EXPECT_EQ("18446744073709551615", scanner.value(4).text);
+  EXPECT_TRUE(scanner.value(5).is_int64);
+  EXPECT_EQ(-7, scanner.value(5).int64_value);
+
+  // Values aren't carried over between scans.
+  ASSERT_TRUE(scanner.Scan(R"({"b": 1.5})"));
+  EXPECT_FALSE(scanner.value(0).found);
+  EXPECT_TRUE(scanner.value(1).is_double);
+  EXPECT_EQ(1.5, scanner.value(1).double_value);
+
+  // Nothing is found in invalid JSON, even before the error.
+  EXPECT_FALSE(scanner.Scan(R"({"a": 1, "b": })"));
+  EXPECT_FALSE(scanner.value(0).found);
+  EXPECT_FALSE(scanner.Scan(R"({"a": 1} trailing)"));
+  EXPECT_FALSE(scanner.value(0).found);
+  EXPECT_FALSE(scanner.Scan(R"(["a", 1])"));
+  EXPECT_FALSE(scanner.Scan("1"));
+}
+
+TEST(JSONOps, PluckMultiUDF) {
+  auto udf_tester = udf::UDFTester<PluckMultiUDF<types::DataType::STRING>>();
+  udf_tester.Init(StringValue(R"(["str_key", "str_plain"])"));
+  udf_tester.ForInput(kTestJSONStr, "str_key").Expect(R"({"abc":"def"})");
+  udf_tester.ForInput(kTestJSONStr, "str_plain").Expect("abc");
+  // Keys that weren't fused are still plucked.
+  udf_tester.ForInput(kTestJSONStr, "float64_key").Expect("123423.5234");
+  udf_tester.ForInput(kTestJSONStr, "blah").Expect("");
+}
+
+TEST(JSONOps, PluckMultiUDF_numeric) {
+  auto int_tester = udf::UDFTester<PluckMultiUDF<types::DataType::INT64>>();
+  int_tester.Init(StringValue(R"(["int64_key", "float64_key"])"));
+  int_tester.ForInput(kTestJSONStr, "int64_key").Expect(34243242341);
+  int_tester.ForInput(kTestJSONStr, "float64_key").Expect(0);
+
+  auto float_tester = udf::UDFTester<PluckMultiUDF<types::DataType::FLOAT64>>();
+  float_tester.Init(StringValue(R"(["int64_key", "float64_key"])"));
+  float_tester.ForInput(kTestJSONStr, "float64_key").Expect(123423.5234);
+  float_tester.ForInput(kTestJSONStr, "int64_key").Expect(0.0);
+}
+
+TEST(JSONOps, PluckMultiUDF_bad_keys) {
+  PluckMultiUDF<types::DataType::STRING> udf;
+  EXPECT_NOT_OK(udf.Init(nullptr, R"({"a": 1})"));
+  EXPECT_NOT_OK(udf.Init(nullptr, R"(["a", 1])"));
+}
+
+TEST(JSONOps, PluckMultiUDF_batches_share_scan) {
+  PluckMultiUDF<types::DataType::INT64> udf;
+  ASSERT_OK(udf.Init(nullptr, R"(["a", "b"])"));
+
+  auto in = types::ToArrow(
+      std::vector<StringValue>{R"({"a": 1, "b": 2})", R"({"b": 4})", "bad", R"({"a": 5, "b": 6})"},
+      arrow::default_memory_pool());
+  auto in_view = udf::StringColumnView::FromArrow(in.get(), in->length());
+  auto expect_batch = [&](const std::string& key, const std::vector<int64_t>& expected) {
+    auto keys = types::ToArrow(std::vector<StringValue>(in->length(), key),
+                               arrow::default_memory_pool());
+    arrow::Int64Builder builder;
+    auto out = udf::Int64ColumnWriter::ToArrow(&builder, in->length());
+    ASSERT_OK(udf.ExecBatch(nullptr, in_view,
+                            udf::StringColumnView::FromArrow(keys.get(), keys->length()), &out));
+    std::shared_ptr<arrow::Array> out_arr;
+    ASSERT_TRUE(builder.Finish(&out_arr).ok());
+    auto* typed_out = static_cast<arrow::Int64Array*>(out_arr.get());
+    ASSERT_EQ(static_cast<int64_t>(expected.size()), typed_out->length());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(expected[i], typed_out->Value(i));
+    }
+  };
+  expect_batch("a", {1, 0, 0, 5});
+  // Served from the values cached for the first call.
+  expect_batch("b", {2, 4, 0, 6});
+  expect_batch("c", {0, 0, 0, 0});
+}
+
 TEST(JSONOps, ScriptReferenceUDF_no_args) {
   auto udf_tester = udf::UDFTester<ScriptReferenceUDF<>>();
   auto res = udf_tester.ForInput("text", "px/script").Result();
@@ -34,6 +34,7 @@ udf::ScalarUDFDocBuilder AddDoc();
 template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class AddUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kAdd; }
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val + b2.val; }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
@@ -59,6 +60,7 @@ class AddUDF<types::StringValue> : public udf::ScalarUDF {
 template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class SubtractUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kSubtract; }
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val - b2.val; }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
@@ -85,6 +87,7 @@ class SubtractUDF : public udf::ScalarUDF {
 template <typename TArg1, typename TArg2 = TArg1>
 class DivideUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kDivide; }
   types::Float64Value Exec(FunctionContext*, TArg1 b1, TArg2 b2) {
     return static_cast<double>(b1.val) / static_cast<double>(b2.val);
   }
@@ -112,6 +115,7 @@ class DivideUDF : public udf::ScalarUDF {
 template <typename TReturn, typename TArg1 = TReturn, typename TArg2 = TReturn>
 class MultiplyUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kMultiply; }
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val * b2.val; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Multiplies the arguments.")
@@ -244,6 +248,7 @@ class SqrtUDF : public udf::ScalarUDF {
 template <typename TReturn, typename TArg1, typename TArg2>
 class ModuloUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kModulo; }
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val % b2.val; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Calculates the remainder of the division of the two numbers")
@@ -265,6 +270,7 @@ class ModuloUDF : public udf::ScalarUDF {
 template <typename TArg1, typename TArg2 = TArg1>
 class LogicalOrUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kLogicalOr; }
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val || b2.val; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean ORs the passed in values.")
@@ -284,6 +290,7 @@ class LogicalOrUDF : public udf::ScalarUDF {
 template <typename TArg1, typename TArg2 = TArg1>
 class LogicalAndUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kLogicalAnd; }
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val && b2.val; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean ANDs the passed in values.")
@@ -301,6 +308,7 @@ class LogicalAndUDF : public udf::ScalarUDF {
 template <typename TArg1>
 class LogicalNotUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kLogicalNot; }
   BoolValue Exec(FunctionContext*, TArg1 b1) { return !b1.val; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean NOTs the passed in value.")
@@ -317,6 +325,7 @@ class LogicalNotUDF : public udf::ScalarUDF {
 template <typename TArg1>
 class NegateUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kNegate; }
   TArg1 Exec(FunctionContext*, TArg1 b1) { return -b1.val; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Negates the passed in value.")
@@ -373,6 +382,7 @@ class FloorUDF : public udf::ScalarUDF {
 template <typename TArg1, typename TArg2 = TArg1>
 class EqualUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kEqual; }
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 == b2; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the values are equal.")
@@ -393,6 +403,7 @@ class EqualUDF : public udf::ScalarUDF {
 template <typename TArg1, typename TArg2 = TArg1>
 class NotEqualUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kNotEqual; }
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 != b2; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the values are not equal.")
@@ -438,6 +449,7 @@ class ApproxNotEqualUDF : public udf::ScalarUDF {
 template <typename TArg1, typename TArg2 = TArg1>
 class GreaterThanUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kGreaterThan; }
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 > b2; }
 
   static udf::ScalarUDFDocBuilder Doc() {
@@ -457,6 +469,7 @@ class GreaterThanUDF : public udf::ScalarUDF {
 template <typename TArg1, typename TArg2 = TArg1>
 class GreaterThanEqualUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kGreaterThanEqual; }
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 >= b2; }
 
   static udf::ScalarUDFDocBuilder Doc() {
@@ -477,6 +490,7 @@ class GreaterThanEqualUDF : public udf::ScalarUDF {
 template <typename TArg1, typename TArg2 = TArg1>
 class LessThanUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kLessThan; }
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 < b2; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns which value is less than the other.")
@@ -493,6 +507,7 @@ class LessThanUDF : public udf::ScalarUDF {
 template <typename TArg1, typename TArg2 = TArg1>
 class LessThanEqualUDF : public udf::ScalarUDF {
  public:
+  static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kLessThanEqual; }
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 <= b2; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns which value is less than or equal to the the other.")
@@ -16,10 +16,18 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <cstring>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "src/carnot/funcs/builtins/math_sketches.h"
 
+DEFINE_bool(carnot_binary_tdigest_sketches,
+            gflags::BoolFromEnv("PL_CARNOT_BINARY_TDIGEST_SKETCHES", false),
+            "Whether the quantile UDAs serialize their t-digests as binary sketches rather than "
+            "JSON. Only enable once every agent can read binary sketches.");
+
 namespace px {
 namespace carnot {
 namespace builtins {
@@ -27,6 +35,9 @@ namespace builtins {
 void RegisterMathSketchesOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<QuantilesUDA<types::Int64Value>>("quantiles");
   registry->RegisterOrDie<QuantilesUDA<types::Float64Value>>("quantiles");
+  registry->RegisterOrDie<QuantilesSketchUDA<types::Int64Value>>("quantiles_sketch");
+  registry->RegisterOrDie<QuantilesSketchUDA<types::Float64Value>>("quantiles_sketch");
+  registry->RegisterOrDie<SketchQuantileUDF>("sketch_quantile");
 }
 
 void WriteCentroidArray(rapidjson::Writer<rapidjson::StringBuffer>* writer,
@@ -52,6 +63,159 @@ std::vector<tdigest::Centroid> CentroidArrayFromJSON(const rapidjson::Value& val
   return centroids;
 }
 
+namespace {
+
+// Starts every binary sketch: "PXTD" followed by the version of the format, in little endian.
+constexpr uint64_t kTDigestSketchMagic = 0x0000000144545850;
+
+struct TDigestSketchHeader {
+  uint64_t magic;
+  double compression;
+  uint64_t max_unprocessed;
+  uint64_t max_processed;
+  uint64_t num_processed;
+  uint64_t num_unprocessed;
+};
+
+// A centroid is stored as its mean followed by its weight.
+constexpr size_t kCentroidBytes = 2 * sizeof(double);
+
+char* WriteCentroids(const std::vector<tdigest::Centroid>& centroids, char* pos) {
+  for (const auto& c : centroids) {
+    double mean = c.mean();
+    double weight = c.weight();
+    std::memcpy(pos, &mean, sizeof(double));
+    std::memcpy(pos + sizeof(double), &weight, sizeof(double));
+    pos += kCentroidBytes;
+  }
+  return pos;
+}
+
+// Bounds on the parameters of deserialized t-digests, which size the buffers tdigest::TDigest
+// allocates. They are far above what the quantile UDAs use.
+constexpr double kMaxTDigestCompression = 100 * kTDigestCompression;
+constexpr uint64_t kMaxTDigestCentroids = 1 << 20;
+
+Status ValidateTDigestParams(double compression, uint64_t max_unprocessed, uint64_t max_processed) {
+  if (!(compression > 0 && compression <= kMaxTDigestCompression)) {
+    return error::InvalidArgument("invalid tdigest compression $0", compression);
+  }
+  if (max_unprocessed == 0 || max_unprocessed > kMaxTDigestCentroids || max_processed == 0 ||
+      max_processed > kMaxTDigestCentroids) {
+    return error::InvalidArgument("invalid tdigest buffer sizes $0 and $1", max_unprocessed,
+                                  max_processed);
+  }
+  return Status::OK();
+}
+
+std::vector<tdigest::Centroid> ReadCentroids(const char* pos, uint64_t count) {
+  std::vector<tdigest::Centroid> centroids;
+  centroids.reserve(count);
+  for (uint64_t i = 0; i < count; ++i, pos += kCentroidBytes) {
+    double mean;
+    double weight;
+    std::memcpy(&mean, pos, sizeof(double));
+    std::memcpy(&weight, pos + sizeof(double), sizeof(double));
+    centroids.emplace_back(mean, weight);
+  }
+  return centroids;
+}
+
+}  // namespace
+
+std::string SerializeTDigest(const tdigest::TDigest& digest) {
+  if (!FLAGS_carnot_binary_tdigest_sketches) {
+    return SerializeTDigestJSON(digest);
+  }
+  const auto& processed = digest.processed();
+  const auto& unprocessed = digest.unprocessed();
+  TDigestSketchHeader header{kTDigestSketchMagic,
+                             digest.compression(),
+                             static_cast<uint64_t>(digest.maxUnprocessed()),
+                             static_cast<uint64_t>(digest.maxProcessed()),
+                             processed.size(),
+                             unprocessed.size()};
+
+  std::string sketch(sizeof(header) + (processed.size() + unprocessed.size()) * kCentroidBytes,
+                     '\0');
+  std::memcpy(sketch.data(), &header, sizeof(header));
+  char* pos = WriteCentroids(processed, sketch.data() + sizeof(header));
+  WriteCentroids(unprocessed, pos);
+  return sketch;
+}
+
+Status DeserializeTDigest(std::string_view sketch, tdigest::TDigest* digest) {
+  if (!sketch.empty() && sketch.front() == '{') {
+    return DeserializeTDigestJSON(sketch, digest);
+  }
+
+  TDigestSketchHeader header;
+  if (sketch.size() < sizeof(header)) {
+    return error::InvalidArgument("invalid tdigest sketch");
+  }
+  std::memcpy(&header, sketch.data(), sizeof(header));
+  uint64_t max_centroids = (sketch.size() - sizeof(header)) / kCentroidBytes;
+  if (header.magic != kTDigestSketchMagic || header.num_processed > max_centroids ||
+      header.num_unprocessed > max_centroids - header.num_processed ||
+      sketch.size() !=
+          sizeof(header) + (header.num_processed + header.num_unprocessed) * kCentroidBytes) {
+    return error::InvalidArgument("invalid tdigest sketch");
+  }
+  PX_RETURN_IF_ERROR(
+      ValidateTDigestParams(header.compression, header.max_unprocessed, header.max_processed));
+
+  const char* pos = sketch.data() + sizeof(header);
+  auto processed = ReadCentroids(pos, header.num_processed);
+  auto unprocessed =
+      ReadCentroids(pos + header.num_processed * kCentroidBytes, header.num_unprocessed);
+  *digest = tdigest::TDigest(std::move(processed), std::move(unprocessed), header.compression,
+                             header.max_unprocessed, header.max_processed);
+  return Status::OK();
+}
+
+namespace {
+constexpr char kProcessedKey[] = "0";
+constexpr char kUnprocessedKey[] = "1";
+constexpr char kCompressionKey[] = "2";
+constexpr char kMaxUnprocessedKey[] = "3";
+constexpr char kMaxProcessedKey[] = "4";
+}  // namespace
+
+std::string SerializeTDigestJSON(const tdigest::TDigest& digest) {
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  writer.StartObject();
+  writer.Key(kProcessedKey);
+  WriteCentroidArray(&writer, digest.processed());
+  writer.Key(kUnprocessedKey);
+  WriteCentroidArray(&writer, digest.unprocessed());
+  writer.Key(kCompressionKey);
+  writer.Double(digest.compression());
+  writer.Key(kMaxUnprocessedKey);
+  writer.Uint64(digest.maxUnprocessed());
+  writer.Key(kMaxProcessedKey);
+  writer.Uint64(digest.maxProcessed());
+  writer.EndObject();
+  return std::string(sb.GetString(), sb.GetSize());
+}
+
+Status DeserializeTDigestJSON(std::string_view json, tdigest::TDigest* digest) {
+  rapidjson::Document d;
+  rapidjson::ParseResult ok = d.Parse(json.data(), json.size());
+  if (ok == nullptr || !d.IsObject()) {
+    return error::InvalidArgument("invalid serialized tdigest");
+  }
+  auto processed = CentroidArrayFromJSON(d[kProcessedKey]);
+  auto unprocessed = CentroidArrayFromJSON(d[kUnprocessedKey]);
+  auto compression = d[kCompressionKey].GetDouble();
+  auto maxUnprocessed = d[kMaxUnprocessedKey].GetUint64();
+  auto maxProcessed = d[kMaxProcessedKey].GetUint64();
+  PX_RETURN_IF_ERROR(ValidateTDigestParams(compression, maxUnprocessed, maxProcessed));
+  *digest = tdigest::TDigest(std::move(processed), std::move(unprocessed), compression,
+                             maxUnprocessed, maxProcessed);
+  return Status::OK();
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -20,28 +20,59 @@
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/error.h"
+#include "src/common/base/logging.h"
 #include "src/shared/types/types.h"
 #include "tdigest/tdigest.h"
 
+DECLARE_bool(carnot_binary_tdigest_sketches);
+
 namespace px {
 namespace carnot {
 namespace builtins {
 
+// The compression of the t-digests behind the quantile UDAs.
+constexpr double kTDigestCompression = 1000;
+
 void WriteCentroidArray(rapidjson::Writer<rapidjson::StringBuffer>* writer,
                         const std::vector<tdigest::Centroid>& centroids);
 
 std::vector<tdigest::Centroid> CentroidArrayFromJSON(const rapidjson::Value& val);
 
+/**
+ * Serializes the t-digest into its binary sketch: a fixed header followed by the raw processed
+ * and unprocessed centroids. Reading it back is two memcpys, and at 16 bytes a centroid it is a
+ * fraction of the size of the JSON form. The sketch uses the host byte order, which is little
+ * endian on every platform we run on.
+ *
+ * Agents that predate the binary sketch can only read JSON, so this returns the JSON form unless
+ * --carnot_binary_tdigest_sketches is set.
+ */
+std::string SerializeTDigest(const tdigest::TDigest& digest);
+
+/**
+ * Reads a t-digest from the output of SerializeTDigest, or, for partial aggregates from agents
+ * that haven't been upgraded yet, from the output of SerializeTDigestJSON.
+ */
+Status DeserializeTDigest(std::string_view sketch, tdigest::TDigest* digest);
+
+/**
+ * The JSON serialization of t-digests that the quantile UDAs used before the binary sketch.
+ */
+std::string SerializeTDigestJSON(const tdigest::TDigest& digest);
+Status DeserializeTDigestJSON(std::string_view json, tdigest::TDigest* digest);
+
 // TODO(zasgar): PL-419 Replace this when we add support for structs.
 template <typename TArg>
 class QuantilesUDA : public udf::UDA {
  public:
-  QuantilesUDA() : digest_(1000) {}
+  QuantilesUDA() : digest_(kTDigestCompression) {}
   void Update(FunctionContext*, TArg val) { digest_.add(val.val); }
   void Merge(FunctionContext*, const QuantilesUDA& other) { digest_.merge(&other.digest_); }
 
@@ -61,44 +92,10 @@ class QuantilesUDA : public udf::UDA {
     return sb.GetString();
   }
 
-  static constexpr char kProcessedKey[] = "0";
-  static constexpr char kUnprocessedKey[] = "1";
-  static constexpr char kCompressionKey[] = "2";
-  static constexpr char kMaxUnprocessedKey[] = "3";
-  static constexpr char kMaxProcessedKey[] = "4";
-
-  StringValue Serialize(FunctionContext*) {
-    rapidjson::StringBuffer sb;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-    writer.StartObject();
-    writer.Key(kProcessedKey);
-    WriteCentroidArray(&writer, digest_.processed());
-    writer.Key(kUnprocessedKey);
-    WriteCentroidArray(&writer, digest_.unprocessed());
-    writer.Key(kCompressionKey);
-    writer.Double(digest_.compression());
-    writer.Key(kMaxUnprocessedKey);
-    writer.Uint64(digest_.maxUnprocessed());
-    writer.Key(kMaxProcessedKey);
-    writer.Uint64(digest_.maxProcessed());
-    writer.EndObject();
-    return sb.GetString();
-  }
+  StringValue Serialize(FunctionContext*) { return SerializeTDigest(digest_); }
 
-  Status Deserialize(FunctionContext*, const StringValue& json) {
-    rapidjson::Document d;
-    rapidjson::ParseResult ok = d.Parse(json.data());
-    if (ok == nullptr) {
-      return error::InvalidArgument("invalid serialized tdigest");
-    }
-    auto processed = CentroidArrayFromJSON(d[kProcessedKey]);
-    auto unprocessed = CentroidArrayFromJSON(d[kUnprocessedKey]);
-    auto compression = d[kCompressionKey].GetDouble();
-    auto maxUnprocessed = d[kMaxUnprocessedKey].GetUint64();
-    auto maxProcessed = d[kMaxProcessedKey].GetUint64();
-    digest_ = tdigest::TDigest(std::move(processed), std::move(unprocessed), compression,
-                               maxUnprocessed, maxProcessed);
-    return Status::OK();
+  Status Deserialize(FunctionContext*, const StringValue& sketch) {
+    return DeserializeTDigest(sketch, &digest_);
   }
 
   static udf::InfRuleVec SemanticInferenceRules() {
@@ -129,6 +126,65 @@ class QuantilesUDA : public udf::UDA {
   tdigest::TDigest digest_;
 };
 
+template <typename TArg>
+class QuantilesSketchUDA : public udf::UDA {
+ public:
+  QuantilesSketchUDA() : digest_(kTDigestCompression) {}
+  void Update(FunctionContext*, TArg val) { digest_.add(val.val); }
+  void Merge(FunctionContext*, const QuantilesSketchUDA& other) { digest_.merge(&other.digest_); }
+
+  StringValue Finalize(FunctionContext*) { return SerializeTDigest(digest_); }
+
+  StringValue Serialize(FunctionContext*) { return SerializeTDigest(digest_); }
+
+  Status Deserialize(FunctionContext*, const StringValue& sketch) {
+    return DeserializeTDigest(sketch, &digest_);
+  }
+
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder("Summarizes the distribution of the aggregated data as a sketch.")
+        .Details(
+            "Builds the same [tdigest](https://github.com/tdunning/t-digest) as `px.quantiles`, "
+            "but returns it in a compact binary form instead of as a JSON object of fixed "
+            "percentiles. Use `px.sketch_quantile` to read any percentile from the sketch.")
+        .Example(R"doc(
+        | df = df.agg(latency_sketch=('latency_ms', px.quantiles_sketch))
+        | df.p99 = px.sketch_quantile(df.latency_sketch, 0.99)
+        )doc")
+        .Arg("val", "The data to summarize the distribution of.")
+        .Returns("The binary sketch of the distribution.");
+  }
+
+ protected:
+  tdigest::TDigest digest_;
+};
+
+class SketchQuantileUDF : public udf::ScalarUDF {
+ public:
+  Float64Value Exec(FunctionContext*, StringValue sketch, Float64Value quantile) {
+    tdigest::TDigest digest(kTDigestCompression);
+    // TODO(zasgar/michellenguyen, PP-419): Replace with null when available.
+    if (!DeserializeTDigest(sketch, &digest).ok()) {
+      return 0.0;
+    }
+    return digest.quantile(quantile.val);
+  }
+
+  static udf::ScalarUDFDocBuilder Doc() {
+    return udf::ScalarUDFDocBuilder("Reads a percentile from a distribution sketch.")
+        .Details(
+            "Estimates the given quantile, between 0 and 1, of the distribution summarized by a "
+            "sketch from `px.quantiles_sketch`. Returns 0.0 if the value isn't a sketch.")
+        .Example(R"doc(
+        | df = df.agg(latency_sketch=('latency_ms', px.quantiles_sketch))
+        | df.p99 = px.sketch_quantile(df.latency_sketch, 0.99)
+        )doc")
+        .Arg("sketch", "The sketch from px.quantiles_sketch.")
+        .Arg("quantile", "The quantile to estimate, between 0 and 1.")
+        .Returns("The estimated value at the quantile.");
+  }
+};
+
 void RegisterMathSketchesOrDie(udf::Registry* registry);
 
 }  // namespace builtins
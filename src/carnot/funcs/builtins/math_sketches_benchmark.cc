@@ -0,0 +1,102 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/carnot/funcs/builtins/math_sketches.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+// Partial quantile aggregates of `count` groups, as an agent would send them for merging.
+std::vector<std::string> PartialAggregates(int64_t count, int64_t values_per_group, bool json) {
+  std::mt19937 gen(37);
+  std::lognormal_distribution<> latency_ms(3, 1);
+  FLAGS_carnot_binary_tdigest_sketches = !json;
+  std::vector<std::string> partials;
+  for (int64_t i = 0; i < count; ++i) {
+    tdigest::TDigest digest(kTDigestCompression);
+    for (int64_t j = 0; j < values_per_group; ++j) {
+      digest.add(latency_ms(gen));
+    }
+    partials.push_back(json ? SerializeTDigestJSON(digest) : SerializeTDigest(digest));
+  }
+  return partials;
+}
+
+// Deserializes and merges partial aggregates, as the final aggregate does for each group.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_MergePartialQuantiles(benchmark::State& state, bool json) {
+  constexpr int64_t kNumPartials = 64;
+  auto partials = PartialAggregates(kNumPartials, state.range(0), json);
+  int64_t bytes = 0;
+  for (const auto& partial : partials) {
+    bytes += partial.size();
+  }
+
+  for (auto _ : state) {
+    tdigest::TDigest merged(kTDigestCompression);
+    for (const auto& partial : partials) {
+      tdigest::TDigest digest(kTDigestCompression);
+      PX_CHECK_OK(DeserializeTDigest(partial, &digest));
+      merged.merge(&digest);
+    }
+    benchmark::DoNotOptimize(merged.quantile(0.99));
+  }
+  state.SetItemsProcessed(state.iterations() * kNumPartials);
+  state.SetBytesProcessed(state.iterations() * bytes);
+  state.counters["bytes_per_partial"] = static_cast<double>(bytes) / kNumPartials;
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_SerializePartialQuantiles(benchmark::State& state, bool json) {
+  FLAGS_carnot_binary_tdigest_sketches = !json;
+  tdigest::TDigest digest(kTDigestCompression);
+  std::mt19937 gen(37);
+  std::lognormal_distribution<> latency_ms(3, 1);
+  for (int64_t j = 0; j < state.range(0); ++j) {
+    digest.add(latency_ms(gen));
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(json ? SerializeTDigestJSON(digest) : SerializeTDigest(digest));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(BM_MergePartialQuantiles, json, /*json*/ true)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+BENCHMARK_CAPTURE(BM_MergePartialQuantiles, binary, /*json*/ false)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+BENCHMARK_CAPTURE(BM_SerializePartialQuantiles, json, /*json*/ true)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+BENCHMARK_CAPTURE(BM_SerializePartialQuantiles, binary, /*json*/ false)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -22,9 +22,14 @@
 
 #include <gtest/gtest.h>
 
+#include <cstring>
+#include <limits>
+#include <string>
+
 #include "src/carnot/funcs/builtins/math_sketches.h"
 #include "src/carnot/udf/test_utils.h"
 #include "src/common/base/base.h"
+#include "src/common/testing/testing.h"
 #include "src/shared/types/types.h"
 
 namespace px {
@@ -73,15 +78,16 @@ TEST(MathSketches, quantiles_int64) {
   EXPECT_DOUBLE_EQ(d["p99"].GetDouble(), 6);
 }
 
-TEST(MathSketches, quantiles_serialize) {
-  auto uda_tester = udf::UDATester<QuantilesUDA<types::Float64Value>>();
-  auto serialized = uda_tester.ForInput(1).Serialize();
+TEST(MathSketches, tdigest_json_serialize) {
+  tdigest::TDigest digest(kTDigestCompression);
+  digest.add(1);
+  auto serialized = SerializeTDigestJSON(digest);
   rapidjson::Document d;
   d.Parse(serialized.data());
-  const auto& processed = d[QuantilesUDA<types::Float64Value>::kProcessedKey];
+  const auto& processed = d["0"];
   EXPECT_TRUE(processed.IsArray());
   EXPECT_EQ(0, processed.GetArray().Size());
-  const auto& unprocessed = d[QuantilesUDA<types::Float64Value>::kUnprocessedKey];
+  const auto& unprocessed = d["1"];
   EXPECT_EQ(1, unprocessed.GetArray().Size());
   const auto& first_centroid = unprocessed.GetArray()[0].GetArray();
   EXPECT_EQ(2, first_centroid.Size());
@@ -91,6 +97,66 @@ TEST(MathSketches, quantiles_serialize) {
   // those here.
 }
 
+TEST(MathSketches, tdigest_binary_serialize) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_binary_tdigest_sketches, true);
+  tdigest::TDigest digest(kTDigestCompression);
+  for (int i = 0; i < 100; ++i) {
+    digest.add(i);
+  }
+  auto sketch = SerializeTDigest(digest);
+  // A 48 byte header and 16 bytes per centroid.
+  EXPECT_EQ(0, (sketch.size() - 48) % 16);
+  EXPECT_LT(sketch.size(), SerializeTDigestJSON(digest).size());
+
+  tdigest::TDigest from_sketch(kTDigestCompression);
+  ASSERT_OK(DeserializeTDigest(sketch, &from_sketch));
+  tdigest::TDigest from_json(kTDigestCompression);
+  ASSERT_OK(DeserializeTDigest(SerializeTDigestJSON(digest), &from_json));
+  for (double q : {0.01, 0.5, 0.99}) {
+    EXPECT_DOUBLE_EQ(digest.quantile(q), from_sketch.quantile(q));
+    EXPECT_DOUBLE_EQ(digest.quantile(q), from_json.quantile(q));
+  }
+
+  EXPECT_NOT_OK(DeserializeTDigest("", &from_sketch));
+  EXPECT_NOT_OK(DeserializeTDigest(sketch.substr(0, sketch.size() - 1), &from_sketch));
+  EXPECT_NOT_OK(DeserializeTDigest(std::string(sketch.size(), 'x'), &from_sketch));
+}
+
+TEST(MathSketches, tdigest_serializes_json_by_default) {
+  tdigest::TDigest digest(kTDigestCompression);
+  digest.add(1);
+  EXPECT_EQ(SerializeTDigestJSON(digest), SerializeTDigest(digest));
+}
+
+TEST(MathSketches, tdigest_binary_bad_params) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_binary_tdigest_sketches, true);
+  tdigest::TDigest digest(kTDigestCompression);
+  digest.add(1);
+  auto sketch = SerializeTDigest(digest);
+
+  // The header holds the magic, then the compression, max_unprocessed and max_processed.
+  auto with_compression = [&](double compression) {
+    std::string bad = sketch;
+    std::memcpy(bad.data() + 8, &compression, sizeof(compression));
+    return bad;
+  };
+  auto with_buffer_size = [&](size_t offset, uint64_t size) {
+    std::string bad = sketch;
+    std::memcpy(bad.data() + offset, &size, sizeof(size));
+    return bad;
+  };
+  tdigest::TDigest from_sketch(kTDigestCompression);
+  EXPECT_NOT_OK(DeserializeTDigest(with_compression(0), &from_sketch));
+  EXPECT_NOT_OK(DeserializeTDigest(with_compression(-1), &from_sketch));
+  EXPECT_NOT_OK(
+      DeserializeTDigest(with_compression(std::numeric_limits<double>::quiet_NaN()), &from_sketch));
+  EXPECT_NOT_OK(DeserializeTDigest(with_compression(1e300), &from_sketch));
+  EXPECT_NOT_OK(DeserializeTDigest(with_buffer_size(16, 0), &from_sketch));
+  EXPECT_NOT_OK(DeserializeTDigest(with_buffer_size(16, uint64_t{1} << 62), &from_sketch));
+  EXPECT_NOT_OK(DeserializeTDigest(with_buffer_size(24, uint64_t{1} << 62), &from_sketch));
+  EXPECT_OK(DeserializeTDigest(sketch, &from_sketch));
+}
+
 TEST(MathSketches, quantiles_serde) {
   auto uda_tester = udf::UDATester<QuantilesUDA<types::Float64Value>>();
   auto res_before_serde = uda_tester.ForInput(1)
@@ -108,6 +174,50 @@ TEST(MathSketches, quantiles_serde) {
   EXPECT_EQ(res_before_serde, res_after_serde);
 }
 
+TEST(MathSketches, quantiles_merges_json_partials) {
+  // Partial aggregates from agents that still serialize JSON are merged too.
+  tdigest::TDigest digest(kTDigestCompression);
+  digest.add(1);
+  digest.add(3);
+  auto uda_tester = udf::UDATester<QuantilesUDA<types::Float64Value>>();
+  EXPECT_OK(uda_tester.ForInput(2).Deserialize(SerializeTDigestJSON(digest)));
+  rapidjson::Document d;
+  auto res = uda_tester.Result();
+  d.Parse(res.data());
+  EXPECT_DOUBLE_EQ(d["p50"].GetDouble(), 2);
+}
+
+TEST(MathSketches, quantiles_sketch) {
+  auto uda_tester = udf::UDATester<QuantilesSketchUDA<types::Int64Value>>();
+  auto sketch = uda_tester.ForInput(1)
+                    .ForInput(2)
+                    .ForInput(2)
+                    .ForInput(1)
+                    .ForInput(1)
+                    .ForInput(5)
+                    .ForInput(6)
+                    .Result();
+
+  // The sketch gives the same quantiles as px.quantiles.
+  auto udf_tester = udf::UDFTester<SketchQuantileUDF>();
+  udf_tester.ForInput(sketch, 0.5).Expect(2);
+  udf_tester.ForInput(sketch, 0.9).Expect(5.7999999999999998);
+  udf_tester.ForInput("not a sketch", 0.5).Expect(0.0);
+}
+
+TEST(MathSketches, quantiles_sketch_merge) {
+  auto uda_tester = udf::UDATester<QuantilesSketchUDA<types::Float64Value>>();
+  uda_tester.ForInput(1).ForInput(2);
+  auto other_tester = udf::UDATester<QuantilesSketchUDA<types::Float64Value>>();
+  other_tester.ForInput(3).ForInput(4).ForInput(5);
+  EXPECT_OK(uda_tester.Deserialize(other_tester.Serialize()));
+  auto sketch = uda_tester.Result();
+
+  tdigest::TDigest digest(kTDigestCompression);
+  ASSERT_OK(DeserializeTDigest(sketch, &digest));
+  EXPECT_NEAR(3, digest.quantile(0.5), 0.5);
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
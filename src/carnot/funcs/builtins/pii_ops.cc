@@ -334,6 +334,16 @@ Status RedactPIIUDF::Init(FunctionContext*) {
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::IMEISV>>());
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::CC_NUMBER>>());
   taggers_.push_back(std::make_unique<RegexTagger<Tag::Type::SSN>>());
+
+  tagger_set_ = std::make_unique<RegexSet>(RE2::Options(), RE2::UNANCHORED);
+  for (const auto& tagger : taggers_) {
+    PX_RETURN_IF_ERROR(tagger_set_->Add(tagger->pattern()));
+  }
+  if (!tagger_set_->Compile().ok()) {
+    LOG_FIRST_N(WARNING, 1) << "Failed to compile the PII patterns into a set, running them one by "
+                               "one instead.";
+    tagger_set_.reset();
+  }
   return Status::OK();
 }
 
@@ -394,7 +404,20 @@ static inline std::string ReplaceTagsWithSubs(std::string input, std::vector<Tag
 
 StringValue RedactPIIUDF::Exec(FunctionContext*, StringValue input) {
   std::vector<Tag> tags;
-  for (const auto& tagger : taggers_) {
+  // Taggers whose pattern doesn't match anywhere in the input can't add tags. If the set ran out
+  // of memory on the input, every tagger runs.
+  bool use_set = tagger_set_ != nullptr && tagger_set_->Match(input, &matched_taggers_);
+  if (use_set && matched_taggers_.empty()) {
+    return input;
+  }
+  auto matched_it = matched_taggers_.begin();
+  for (const auto& [idx, tagger] : Enumerate(taggers_)) {
+    if (use_set) {
+      if (matched_it == matched_taggers_.end() || *matched_it != static_cast<int>(idx)) {
+        continue;
+      }
+      ++matched_it;
+    }
     auto s = tagger->AddTags(&input, &tags);
     if (!s.ok()) {
       return "Invalid regex: " + s.msg();
@@ -20,9 +20,11 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "re2/re2.h"
+#include "src/carnot/funcs/builtins/regex_set.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -70,6 +72,8 @@ class Tagger {
  public:
   virtual ~Tagger() = default;
   virtual Status AddTags(std::string* input, std::vector<Tag>* tags) = 0;
+  // The regex pattern of the strings the tagger tags.
+  virtual std::string_view pattern() const = 0;
 };
 
 class RedactPIIUDF : public udf::ScalarUDF {
@@ -94,6 +98,11 @@ class RedactPIIUDF : public udf::ScalarUDF {
 
  private:
   std::vector<std::unique_ptr<Tagger>> taggers_;
+  // The patterns of all of the taggers, compiled into one automaton. A single pass over the input
+  // finds the taggers that have something to tag, so the others are skipped. Null if the set
+  // couldn't be compiled, in which case every tagger runs.
+  std::unique_ptr<RegexSet> tagger_set_;
+  std::vector<int> matched_taggers_;
 };
 
 void RegisterPIIOpsOrDie(udf::Registry* registry);
@@ -106,7 +115,9 @@ class RegexTagger : public Tagger {
     DCHECK_EQ(regex_.error_code(), RE2::NoError) << regex_.error();
   }
 
-  Status AddTags(std::string* input, std::vector<Tag>* tags) {
+  std::string_view pattern() const override { return TagTypeTraits<TTag>::BuildRegexPattern(); }
+
+  Status AddTags(std::string* input, std::vector<Tag>* tags) override {
     re2::StringPiece input_piece(input->data(), input->length());
     auto prev_length = input_piece.length();
     int curr_idx = 0;
@@ -267,6 +267,14 @@ INSTANTIATE_TEST_SUITE_P(TemplatedRedactionTest, RedactionTest,
                                                           EmailGen(), CCGen(), IMEIGen(), SSNGen(),
                                                           NegativeExampleGen()})));
 
+TEST(RedactPII, no_pii_is_unchanged) {
+  auto udf_tester = udf::UDFTester<RedactPIIUDF>();
+  udf_tester.Init().ForInput("").Expect("");
+  udf_tester.Init()
+      .ForInput(R"({"method": "GET", "path": "/api/v1/users"})")
+      .Expect(R"({"method": "GET", "path": "/api/v1/users"})");
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
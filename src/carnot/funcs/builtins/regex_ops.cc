@@ -33,6 +33,7 @@ void RegisterRegexOpsOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<RegexMatchUDF>("regex_match");
   registry->RegisterOrDie<RegexReplaceUDF>("replace");
   registry->RegisterOrDie<MatchRegexRule>("_match_regex_rule");
+  registry->RegisterOrDie<RegexMatchMultiUDF>("_regex_match_multi");
   /*****************************************
    * Aggregate UDFs.
    *****************************************/
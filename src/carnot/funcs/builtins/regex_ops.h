@@ -20,15 +20,18 @@
 
 #include <rapidjson/document.h>
 
+#include <absl/container/flat_hash_map.h>
 #include <absl/strings/strip.h>
 
 #include <algorithm>
 #include <memory>
 #include <regex>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 #include "re2/re2.h"
+#include "src/carnot/funcs/builtins/regex_set.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -37,13 +40,18 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+// The options of the regexes of px.regex_match.
+inline re2::RE2::Options RegexMatchOptions() {
+  re2::RE2::Options opts;
+  opts.set_dot_nl(true);
+  opts.set_log_errors(false);
+  return opts;
+}
+
 class RegexMatchUDF : public udf::ScalarUDF {
  public:
   Status Init(FunctionContext*, StringValue regex) {
-    re2::RE2::Options opts;
-    opts.set_dot_nl(true);
-    opts.set_log_errors(false);
-    regex_ = std::make_unique<re2::RE2>(regex, opts);
+    regex_ = std::make_unique<re2::RE2>(regex, RegexMatchOptions());
     return Status::OK();
   }
   BoolValue Exec(FunctionContext*, StringValue input) {
@@ -53,6 +61,16 @@ class RegexMatchUDF : public udf::ScalarUDF {
     return RE2::FullMatch(input, *regex_);
   }
 
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& input,
+                   udf::BoolColumnWriter* out) {
+    bool valid_regex = regex_->error_code() == RE2::NoError;
+    for (int64_t idx = 0; idx < input.size(); ++idx) {
+      std::string_view in = input[idx];
+      out->Append(valid_regex && RE2::FullMatch(re2::StringPiece(in.data(), in.size()), *regex_));
+    }
+    return Status::OK();
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Check for a match to a regex pattern in a string.")
         .Details(
@@ -81,15 +99,20 @@ class RegexReplaceUDF : public udf::ScalarUDF {
     return Status::OK();
   }
   StringValue Exec(FunctionContext*, StringValue input, StringValue sub) {
-    if (regex_->error_code() != RE2::NoError) {
-      return absl::Substitute("Invalid regex expr: $0", regex_->error());
-    }
-    std::string err_str;
-    if (!regex_->CheckRewriteString(sub, &err_str)) {
-      return absl::Substitute("Invalid regex in substitution string: $0", err_str);
+    StringValue out;
+    Replace(input, sub, &out);
+    return out;
+  }
+
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& input,
+                   const udf::StringColumnView& sub, udf::StringColumnWriter* out) {
+    // The result of each row is built in the same buffer, so its capacity is reused across rows.
+    std::string replaced;
+    for (int64_t idx = 0; idx < input.size(); ++idx) {
+      Replace(input[idx], sub[idx], &replaced);
+      out->Append(replaced);
     }
-    RE2::GlobalReplace(&input, *regex_, sub);
-    return input;
+    return Status::OK();
   }
 
   static udf::ScalarUDFDocBuilder Doc() {
@@ -114,6 +137,23 @@ class RegexReplaceUDF : public udf::ScalarUDF {
   }
 
  private:
+  // Writes the input with all matches replaced into out, or the error message if either the
+  // regex or the substitution string is invalid.
+  void Replace(std::string_view input, std::string_view sub, std::string* out) {
+    if (regex_->error_code() != RE2::NoError) {
+      *out = absl::Substitute("Invalid regex expr: $0", regex_->error());
+      return;
+    }
+    re2::StringPiece rewrite(sub.data(), sub.size());
+    std::string err_str;
+    if (!regex_->CheckRewriteString(rewrite, &err_str)) {
+      *out = absl::Substitute("Invalid regex in substitution string: $0", err_str);
+      return;
+    }
+    out->assign(input.data(), input.size());
+    RE2::GlobalReplace(out, *regex_, rewrite);
+  }
+
   std::unique_ptr<re2::RE2> regex_;
 };
 
@@ -126,6 +166,13 @@ class MatchRegexRule : public udf::ScalarUDF {
     if (!parse_result) {
       return Status(statuspb::Code::INVALID_ARGUMENT, "unable to parse string as json");
     }
+    regex_rules.clear();
+    regex_rules_length = 0;
+    // The rules are also compiled into one automaton, which finds every rule that matches in a
+    // single pass over the value. rule_idx_by_set_idx_ maps the set's patterns back to the rules,
+    // since invalid rules are left out of the set.
+    rule_set_ = std::make_unique<RegexSet>(RegexMatchOptions(), RE2::ANCHOR_BOTH);
+    rule_idx_by_set_idx_.clear();
     // Populate the parse regular expressions into self::regex_rules.
     for (rapidjson::Value::ConstMemberIterator itr = regex_rules_json.MemberBegin();
          itr != regex_rules_json.MemberEnd(); ++itr) {
@@ -133,13 +180,23 @@ class MatchRegexRule : public udf::ScalarUDF {
       std::string name = itr->name.GetString();
       std::string regex_pattern = itr->value.GetString();
       PX_RETURN_IF_ERROR(regex_match_udf.Init(ctx, regex_pattern));
+      if (rule_set_->Add(regex_pattern).ok()) {
+        rule_idx_by_set_idx_.push_back(regex_rules_length);
+      }
       regex_rules.emplace_back(make_pair(name, std::move(regex_match_udf)));
       regex_rules_length++;
     }
+    if (!rule_set_->Compile().ok()) {
+      rule_set_.reset();
+    }
     return Status::OK();
   }
 
   types::StringValue Exec(FunctionContext* ctx, StringValue value) {
+    if (rule_set_ != nullptr && rule_set_->Match(value, &matched_)) {
+      // The first rule that matched, the matches are in increasing order.
+      return matched_.empty() ? "" : regex_rules[rule_idx_by_set_idx_[matched_[0]]].first;
+    }
     for (int i = 0; i < regex_rules_length; i++) {
       if (regex_rules[i].second.Exec(ctx, value).val) {
         return regex_rules[i].first;
@@ -172,6 +229,122 @@ class MatchRegexRule : public udf::ScalarUDF {
  private:
   int regex_rules_length = 0;
   std::vector<std::pair<std::string, RegexMatchUDF> > regex_rules;
+  std::unique_ptr<RegexSet> rule_set_;
+  std::vector<int> rule_idx_by_set_idx_;
+  std::vector<int> matched_;
+};
+
+/**
+  DocString intentionally omitted, this is a non-public function.
+  The compiler rewrites the px.regex_match calls of a map that match different patterns against
+  the same column into calls of RegexMatchMultiUDF (see FuseColumnScansRule). The init arg holds all
+  of the patterns matched against the column as a JSON array of strings. Since the rewritten calls
+  have the same init args, they share one instance of the UDF, which runs all of the patterns over
+  each batch in a single pass per value, and answers the remaining calls for that batch from the
+  results it cached.
+ */
+class RegexMatchMultiUDF : public udf::ScalarUDF {
+ public:
+  Status Init(FunctionContext*, StringValue patterns_json) {
+    rapidjson::Document d;
+    rapidjson::ParseResult ok = d.Parse(patterns_json.data(), patterns_json.size());
+    if (ok == nullptr || !d.IsArray()) {
+      return error::InvalidArgument("Expected a JSON array of patterns, got '$0'", patterns_json);
+    }
+    pattern_set_ = std::make_unique<RegexSet>(RegexMatchOptions(), RE2::ANCHOR_BOTH);
+    for (const auto& pattern : d.GetArray()) {
+      if (!pattern.IsString()) {
+        return error::InvalidArgument("Expected a JSON array of patterns, got '$0'", patterns_json);
+      }
+      std::string_view pattern_str(pattern.GetString(), pattern.GetStringLength());
+      // Invalid patterns never match, as for px.regex_match, so they are left out of the set.
+      if (pattern_set_->Add(pattern_str).ok()) {
+        set_idx_by_pattern_.emplace(pattern_str, pattern_set_->size() - 1);
+      }
+    }
+    if (!pattern_set_->Compile().ok()) {
+      pattern_set_.reset();
+    }
+    return Status::OK();
+  }
+
+  BoolValue Exec(FunctionContext*, StringValue input, StringValue pattern) {
+    return MatchOne(input, pattern);
+  }
+
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& input,
+                   const udf::StringColumnView& pattern, udf::BoolColumnWriter* out) {
+    if (input.size() == 0) {
+      return Status::OK();
+    }
+    auto set_idx_it = set_idx_by_pattern_.find(pattern[0]);
+    std::shared_ptr<arrow::ArrayData> input_data = input.arrow_data();
+    if (pattern_set_ == nullptr || set_idx_it == set_idx_by_pattern_.end() ||
+        input_data == nullptr) {
+      for (int64_t idx = 0; idx < input.size(); ++idx) {
+        out->Append(MatchOne(input[idx], pattern[idx]));
+      }
+      return Status::OK();
+    }
+    if (input_data != cached_input_ || input.size() != cached_size_) {
+      CacheBatch(input);
+      cached_input_ = std::move(input_data);
+      cached_size_ = input.size();
+    }
+    int set_idx = set_idx_it->second;
+    for (int64_t idx = 0; idx < input.size(); ++idx) {
+      if (pattern[idx] != pattern[0] || cached_fallback_[idx]) {
+        out->Append(MatchOne(input[idx], pattern[idx]));
+      } else {
+        out->Append(static_cast<bool>(cached_matches_[set_idx * input.size() + idx]));
+      }
+    }
+    return Status::OK();
+  }
+
+ private:
+  // Matches a single pattern with its own regex, compiled on first use.
+  bool MatchOne(std::string_view input, std::string_view pattern) {
+    auto it = regexes_.find(pattern);
+    if (it == regexes_.end()) {
+      it = regexes_.emplace(pattern, std::make_unique<re2::RE2>(
+                                         re2::StringPiece(pattern.data(), pattern.size()),
+                                         RegexMatchOptions()))
+               .first;
+    }
+    const re2::RE2& regex = *it->second;
+    return regex.error_code() == RE2::NoError &&
+           RE2::FullMatch(re2::StringPiece(input.data(), input.size()), regex);
+  }
+
+  // Runs the pattern set over every value of the batch and caches which patterns matched each.
+  void CacheBatch(const udf::StringColumnView& input) {
+    cached_matches_.assign(pattern_set_->size() * input.size(), false);
+    cached_fallback_.assign(input.size(), false);
+    for (int64_t idx = 0; idx < input.size(); ++idx) {
+      if (!pattern_set_->Match(input[idx], &matched_)) {
+        cached_fallback_[idx] = true;
+        continue;
+      }
+      for (int set_idx : matched_) {
+        cached_matches_[set_idx * input.size() + idx] = true;
+      }
+    }
+  }
+
+  std::unique_ptr<RegexSet> pattern_set_;
+  absl::flat_hash_map<std::string, int> set_idx_by_pattern_;
+  absl::flat_hash_map<std::string, std::unique_ptr<re2::RE2>> regexes_;
+  std::vector<int> matched_;
+
+  // The input column of the cached batch, held on to so that it can't be freed and its address
+  // reused by another batch while it is cached.
+  std::shared_ptr<arrow::ArrayData> cached_input_;
+  int64_t cached_size_ = 0;
+  // Whether each pattern of the set matched each value, indexed by set_idx * size + row.
+  std::vector<bool> cached_matches_;
+  // The values the set ran out of memory on, which are matched one pattern at a time.
+  std::vector<bool> cached_fallback_;
 };
 
 void RegisterRegexOpsOrDie(udf::Registry* registry);
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/funcs/builtins/regex_ops.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+constexpr int64_t kNumRows = 1024;
+
+// Patterns of the shape used to classify requests, only one of which matches each row.
+std::vector<std::string> MakePatterns(int64_t num_patterns) {
+  std::vector<std::string> patterns;
+  for (int64_t i = 0; i < num_patterns; ++i) {
+    patterns.push_back(absl::Substitute(".*/api/v$0/(users|orders)/[0-9]+.*", i));
+  }
+  return patterns;
+}
+
+std::shared_ptr<arrow::Array> MakeInput(int64_t num_patterns, int64_t body_size) {
+  std::vector<types::StringValue> rows;
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    std::string row = absl::Substitute("GET /api/v$0/users/$1 HTTP/1.1\n", i % num_patterns, i);
+    while (static_cast<int64_t>(row.size()) < body_size) {
+      row += "Accept: */*\n";
+    }
+    rows.push_back(row);
+  }
+  return types::ToArrow(rows, arrow::default_memory_pool());
+}
+
+// The unfused plan: one px.regex_match per pattern, each of which runs over every row.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RegexMatch_PerPattern(benchmark::State& state) {
+  auto patterns = MakePatterns(state.range(0));
+  auto input = MakeInput(state.range(0), state.range(1));
+  std::vector<RegexMatchUDF> udfs(patterns.size());
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    PX_CHECK_OK(udfs[i].Init(nullptr, patterns[i]));
+  }
+  auto* typed_input = static_cast<arrow::StringArray*>(input.get());
+
+  for (auto _ : state) {
+    for (auto& udf : udfs) {
+      for (int64_t i = 0; i < kNumRows; ++i) {
+        benchmark::DoNotOptimize(udf.Exec(nullptr, typed_input->GetString(i)));
+      }
+    }
+  }
+  state.SetItemsProcessed(kNumRows * state.iterations());
+}
+
+// The fused plan: the calls share one RegexMatchMultiUDF, which runs the set once per row.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RegexMatchMulti(benchmark::State& state) {
+  auto patterns = MakePatterns(state.range(0));
+  auto input = MakeInput(state.range(0), state.range(1));
+  std::string patterns_json = "[";
+  for (const auto& pattern : patterns) {
+    absl::StrAppend(&patterns_json, patterns_json.size() > 1 ? "," : "", "\"", pattern, "\"");
+  }
+  patterns_json += "]";
+  auto input_view = udf::StringColumnView::FromArrow(input.get(), kNumRows);
+  std::vector<std::shared_ptr<arrow::Array>> pattern_cols;
+  for (const auto& pattern : patterns) {
+    pattern_cols.push_back(types::ToArrow(
+        std::vector<types::StringValue>(kNumRows, pattern), arrow::default_memory_pool()));
+  }
+
+  for (auto _ : state) {
+    // A new instance per iteration, so that every iteration scans the batch.
+    RegexMatchMultiUDF udf;
+    PX_CHECK_OK(udf.Init(nullptr, patterns_json));
+    for (const auto& pattern_col : pattern_cols) {
+      arrow::BooleanBuilder builder;
+      auto out = udf::BoolColumnWriter::ToArrow(&builder, kNumRows);
+      PX_CHECK_OK(udf.ExecBatch(
+          nullptr, input_view, udf::StringColumnView::FromArrow(pattern_col.get(), kNumRows),
+          &out));
+      benchmark::DoNotOptimize(builder.length());
+    }
+  }
+  state.SetItemsProcessed(kNumRows * state.iterations());
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_MatchRegexRule(benchmark::State& state) {
+  auto patterns = MakePatterns(state.range(0));
+  auto input = MakeInput(state.range(0), state.range(1));
+  std::string rules_json = "{";
+  for (const auto& [i, pattern] : Enumerate(patterns)) {
+    absl::StrAppend(&rules_json, i > 0 ? "," : "", "\"rule", i, "\":\"", pattern, "\"");
+  }
+  rules_json += "}";
+  MatchRegexRule udf;
+  PX_CHECK_OK(udf.Init(nullptr, rules_json));
+  auto* typed_input = static_cast<arrow::StringArray*>(input.get());
+
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kNumRows; ++i) {
+      benchmark::DoNotOptimize(udf.Exec(nullptr, typed_input->GetString(i)));
+    }
+  }
+  state.SetItemsProcessed(kNumRows * state.iterations());
+}
+
+BENCHMARK(BM_RegexMatch_PerPattern)->ArgsProduct({{2, 8, 32}, {64, 4096}});
+BENCHMARK(BM_RegexMatchMulti)->ArgsProduct({{2, 8, 32}, {64, 4096}});
+BENCHMARK(BM_MatchRegexRule)->ArgsProduct({{2, 8, 32}, {64, 4096}});
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -17,7 +17,9 @@
  */
 
 #include <gtest/gtest.h>
+#include <memory>
 #include <numeric>
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -30,6 +32,8 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+using types::StringValue;
+
 constexpr char kMultiLine[] = R"str(
 abcd
 1234
@@ -96,6 +100,64 @@ TEST(RegexOps, regex_match_rules) {
   EXPECT_NOT_OK(MatchRegexRule().Init(nullptr, "(?i).*onpointerenter.*"));
 }
 
+TEST(RegexOps, regex_match_rules_first_match) {
+  auto udf_tester = udf::UDFTester<MatchRegexRule>();
+  udf_tester.Init(R"({"select": "(?i)select.*", "any": ".*", "bad": "\\K"})")
+      .ForInput("SELECT 1")
+      .Expect("select");
+  udf_tester.Init(R"({"select": "(?i)select.*", "any": ".*", "bad": "\\K"})")
+      .ForInput("UPDATE")
+      .Expect("any");
+  udf_tester.Init(R"({"bad": "\\K", "insert": "INSERT.*"})").ForInput("UPDATE").Expect("");
+}
+
+TEST(RegexOps, regex_match_multi) {
+  auto udf_tester = udf::UDFTester<RegexMatchMultiUDF>();
+  udf_tester.Init(StringValue(R"(["abcd.*", ".*1234.*", "\\K"])"));
+  udf_tester.ForInput(kMultiLine, "abcd.*").Expect(false);
+  udf_tester.ForInput(kMultiLine, ".*1234.*").Expect(true);
+  udf_tester.ForInput("abcdefg", "abcd.*").Expect(true);
+  // Invalid patterns never match.
+  udf_tester.ForInput("abcdefg", R"regex(\K)regex").Expect(false);
+  // Patterns that weren't fused are still matched.
+  udf_tester.ForInput("abcdefg", ".*efg").Expect(true);
+}
+
+TEST(RegexOps, regex_match_multi_bad_patterns) {
+  RegexMatchMultiUDF udf;
+  EXPECT_NOT_OK(udf.Init(nullptr, R"({"a": "b"})"));
+  EXPECT_NOT_OK(udf.Init(nullptr, R"(["a", 1])"));
+}
+
+TEST(RegexOps, regex_match_multi_batches_share_scan) {
+  RegexMatchMultiUDF udf;
+  ASSERT_OK(udf.Init(nullptr, R"(["GET .*", "POST .*"])"));
+
+  auto in = types::ToArrow(std::vector<StringValue>{"GET /a", "POST /b", "PUT /c", "GET"},
+                           arrow::default_memory_pool());
+  auto in_view = udf::StringColumnView::FromArrow(in.get(), in->length());
+  auto expect_batch = [&](const std::string& pattern, const std::vector<bool>& expected) {
+    auto patterns = types::ToArrow(std::vector<StringValue>(in->length(), pattern),
+                                   arrow::default_memory_pool());
+    arrow::BooleanBuilder builder;
+    auto out = udf::BoolColumnWriter::ToArrow(&builder, in->length());
+    ASSERT_OK(udf.ExecBatch(nullptr, in_view,
+                            udf::StringColumnView::FromArrow(patterns.get(), patterns->length()),
+                            &out));
+    std::shared_ptr<arrow::Array> out_arr;
+    ASSERT_TRUE(builder.Finish(&out_arr).ok());
+    auto* typed_out = static_cast<arrow::BooleanArray*>(out_arr.get());
+    ASSERT_EQ(static_cast<int64_t>(expected.size()), typed_out->length());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(expected[i], typed_out->Value(i));
+    }
+  };
+  expect_batch("GET .*", {true, false, false, false});
+  // Served from the matches cached for the first call.
+  expect_batch("POST .*", {false, true, false, false});
+  expect_batch("PUT .*", {false, false, true, false});
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/funcs/builtins/regex_set.h"
+
+#include <algorithm>
+#include <string>
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+StatusOr<int> RegexSet::Add(std::string_view pattern) {
+  DCHECK(!compiled_) << "Can't add patterns to a compiled RegexSet";
+  std::string error;
+  int idx = set_->Add(re2::StringPiece(pattern.data(), pattern.size()), &error);
+  if (idx < 0) {
+    return error::InvalidArgument("Invalid regex '$0': $1", pattern, error);
+  }
+  ++size_;
+  return idx;
+}
+
+Status RegexSet::Compile() {
+  if (!set_->Compile()) {
+    return error::ResourceUnavailable("Not enough memory to compile the regex set");
+  }
+  compiled_ = true;
+  return Status::OK();
+}
+
+bool RegexSet::Match(std::string_view input, std::vector<int>* matches) const {
+  DCHECK(compiled_) << "RegexSet must be compiled before matching";
+  matches->clear();
+  re2::RE2::Set::ErrorInfo error_info;
+  if (set_->Match(re2::StringPiece(input.data(), input.size()), matches, &error_info)) {
+    // RE2::Set returns the matches in no particular order.
+    std::sort(matches->begin(), matches->end());
+    return true;
+  }
+  return error_info.kind == re2::RE2::Set::kNoError;
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "re2/re2.h"
+#include "re2/set.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+/**
+ * RegexSet matches strings against many RE2 patterns at once. The patterns are compiled into one
+ * RE2::Set automaton, which finds every pattern that matches in a single pass over the string
+ * instead of one pass per pattern.
+ *
+ * The set can only tell which patterns match, not where. Callers that need the matches themselves
+ * use it to skip the patterns that can't match before running those that can.
+ */
+class RegexSet {
+ public:
+  RegexSet(const re2::RE2::Options& options, re2::RE2::Anchor anchor)
+      : set_(std::make_unique<re2::RE2::Set>(options, anchor)) {}
+
+  /**
+   * Adds a pattern and returns its index. Patterns are indexed in the order they are added, and
+   * invalid patterns are an error that doesn't use up an index.
+   */
+  StatusOr<int> Add(std::string_view pattern);
+
+  /**
+   * Compiles the automaton. Must be called once all of the patterns are added and before Match.
+   */
+  Status Compile();
+
+  int size() const { return size_; }
+
+  /**
+   * Sets `matches` to the indices of the patterns that match input, in increasing order. Returns
+   * false if the automaton ran out of memory on this input, in which case the patterns have to be
+   * matched one at a time.
+   */
+  bool Match(std::string_view input, std::vector<int>* matches) const;
+
+ private:
+  std::unique_ptr<re2::RE2::Set> set_;
+  int size_ = 0;
+  bool compiled_ = false;
+};
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
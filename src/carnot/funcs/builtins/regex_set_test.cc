@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "src/carnot/funcs/builtins/regex_set.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace builtins {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(RegexSet, unanchored_matches_are_sorted) {
+  RegexSet set(re2::RE2::Options(), re2::RE2::UNANCHORED);
+  EXPECT_OK_AND_EQ(set.Add("c+"), 0);
+  EXPECT_OK_AND_EQ(set.Add("a+"), 1);
+  EXPECT_OK_AND_EQ(set.Add("b+"), 2);
+  EXPECT_OK_AND_EQ(set.Add("x"), 3);
+  ASSERT_OK(set.Compile());
+  EXPECT_EQ(4, set.size());
+
+  std::vector<int> matches;
+  ASSERT_TRUE(set.Match("aabbcc", &matches));
+  EXPECT_THAT(matches, ElementsAre(0, 1, 2));
+  ASSERT_TRUE(set.Match("bx", &matches));
+  EXPECT_THAT(matches, ElementsAre(2, 3));
+  ASSERT_TRUE(set.Match("zzz", &matches));
+  EXPECT_THAT(matches, IsEmpty());
+}
+
+TEST(RegexSet, anchored_matches) {
+  RegexSet set(re2::RE2::Options(), re2::RE2::ANCHOR_BOTH);
+  ASSERT_OK(set.Add("abc"));
+  ASSERT_OK(set.Add("abc.*"));
+  ASSERT_OK(set.Compile());
+
+  std::vector<int> matches;
+  ASSERT_TRUE(set.Match("abc", &matches));
+  EXPECT_THAT(matches, ElementsAre(0, 1));
+  ASSERT_TRUE(set.Match("abcd", &matches));
+  EXPECT_THAT(matches, ElementsAre(1));
+  ASSERT_TRUE(set.Match("xabc", &matches));
+  EXPECT_THAT(matches, IsEmpty());
+}
+
+TEST(RegexSet, invalid_pattern_doesnt_use_an_index) {
+  RegexSet set(re2::RE2::Options(), re2::RE2::UNANCHORED);
+  EXPECT_OK_AND_EQ(set.Add("a"), 0);
+  EXPECT_NOT_OK(set.Add(R"regex(\K)regex"));
+  EXPECT_OK_AND_EQ(set.Add("b"), 1);
+  ASSERT_OK(set.Compile());
+  EXPECT_EQ(2, set.size());
+
+  std::vector<int> matches;
+  ASSERT_TRUE(set.Match("b", &matches));
+  EXPECT_THAT(matches, ElementsAre(1));
+}
+
+}  // namespace builtins
+}  // namespace carnot
+}  // namespace px
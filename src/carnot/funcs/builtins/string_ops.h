@@ -21,6 +21,7 @@
 #include <absl/strings/strip.h>
 #include <algorithm>
 #include <string>
+#include <string_view>
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/utils.h"
 #include "src/shared/types/types.h"
@@ -35,6 +36,14 @@ class ContainsUDF : public udf::ScalarUDF {
     return absl::StrContains(b1, b2);
   }
 
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& b1,
+                   const udf::StringColumnView& b2, udf::BoolColumnWriter* out) {
+    for (int64_t idx = 0; idx < b1.size(); ++idx) {
+      out->Append(absl::StrContains(b1[idx], b2[idx]));
+    }
+    return Status::OK();
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the first string contains the second string.")
         .Example("matching_df = matching_df[px.contains(matching_df.svc_names, 'my_svc')]")
@@ -47,6 +56,13 @@ class ContainsUDF : public udf::ScalarUDF {
 class LengthUDF : public udf::ScalarUDF {
  public:
   Int64Value Exec(FunctionContext*, StringValue b1) { return b1.length(); }
+
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& b1, udf::Int64ColumnWriter* out) {
+    for (int64_t idx = 0; idx < b1.size(); ++idx) {
+      out->Append(static_cast<int64_t>(b1[idx].length()));
+    }
+    return Status::OK();
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns the length of the string")
         .Example(R"doc(df.service = 'checkout'
@@ -63,6 +79,14 @@ class FindUDF : public udf::ScalarUDF {
     return src.find(substr);
   }
 
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& src,
+                   const udf::StringColumnView& substr, udf::Int64ColumnWriter* out) {
+    for (int64_t idx = 0; idx < src.size(); ++idx) {
+      out->Append(static_cast<int64_t>(src[idx].find(substr[idx])));
+    }
+    return Status::OK();
+  }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Find the index of the first occurrence of the substring.")
         .Details(
@@ -79,12 +103,18 @@ class FindUDF : public udf::ScalarUDF {
 class SubstringUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue b1, Int64Value pos, Int64Value length) {
-    // If the pos is "erroneous" then just return empty string.
-    if (pos < 0 || pos > static_cast<int64_t>(b1.length()) || length < 0) {
-      return "";
+    return StringValue(Substring(b1, pos.val, length.val));
+  }
+
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& b1,
+                   const udf::Int64ColumnView& pos, const udf::Int64ColumnView& length,
+                   udf::StringColumnWriter* out) {
+    for (int64_t idx = 0; idx < b1.size(); ++idx) {
+      out->Append(Substring(b1[idx], pos[idx].val, length[idx].val));
     }
-    return b1.substr(static_cast<size_t>(pos.val), static_cast<size_t>(length.val));
+    return Status::OK();
   }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns the specified substring from the string")
         .Details(
@@ -100,6 +130,15 @@ class SubstringUDF : public udf::ScalarUDF {
         .Arg("length", "The length of the substring to return.")
         .Returns("The substring from `string`.");
   }
+
+ private:
+  static std::string_view Substring(std::string_view s, int64_t pos, int64_t length) {
+    // If the pos is "erroneous" then just return empty string.
+    if (pos < 0 || pos > static_cast<int64_t>(s.length()) || length < 0) {
+      return "";
+    }
+    return s.substr(static_cast<size_t>(pos), static_cast<size_t>(length));
+  }
 };
 
 class ToLowerUDF : public udf::ScalarUDF {
@@ -108,6 +147,18 @@ class ToLowerUDF : public udf::ScalarUDF {
     transform(b1.begin(), b1.end(), b1.begin(), ::tolower);
     return b1;
   }
+
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& b1,
+                   udf::StringColumnWriter* out) {
+    std::string lower;
+    for (int64_t idx = 0; idx < b1.size(); ++idx) {
+      std::string_view in = b1[idx];
+      lower.assign(in.data(), in.size());
+      transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+      out->Append(lower);
+    }
+    return Status::OK();
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Transforms all uppercase ascii characters in the string to lowercase.")
@@ -125,6 +176,18 @@ class ToUpperUDF : public udf::ScalarUDF {
     transform(b1.begin(), b1.end(), b1.begin(), ::toupper);
     return b1;
   }
+
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& b1,
+                   udf::StringColumnWriter* out) {
+    std::string upper;
+    for (int64_t idx = 0; idx < b1.size(); ++idx) {
+      std::string_view in = b1[idx];
+      upper.assign(in.data(), in.size());
+      transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+      out->Append(upper);
+    }
+    return Status::OK();
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Transforms all lowercase ascii characters in the string to uppercase.")
@@ -143,6 +206,13 @@ class TrimUDF : public udf::ScalarUDF {
     absl::StripAsciiWhitespace(&val);
     return val;
   }
+
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& s, udf::StringColumnWriter* out) {
+    for (int64_t idx = 0; idx < s.size(); ++idx) {
+      out->Append(absl::StripAsciiWhitespace(s[idx]));
+    }
+    return Status::OK();
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Trim ascii whitespace from before and after the string content.")
@@ -162,6 +232,14 @@ class StripPrefixUDF : public udf::ScalarUDF {
   StringValue Exec(FunctionContext*, StringValue prefix, StringValue s) {
     return StringValue(absl::StripPrefix(s, prefix));
   }
+
+  Status ExecBatch(FunctionContext*, const udf::StringColumnView& prefix,
+                   const udf::StringColumnView& s, udf::StringColumnWriter* out) {
+    for (int64_t idx = 0; idx < s.size(); ++idx) {
+      out->Append(absl::StripPrefix(s[idx], prefix[idx]));
+    }
+    return Status::OK();
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Strips the specified prefix from the string.")
         .Details(
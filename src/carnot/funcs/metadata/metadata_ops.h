@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "src/carnot/funcs/shared/utils.h"
+#include "src/carnot/udf/memoized_udf.h"
 #include "src/carnot/udf/registry.h"
 #include "src/carnot/udf/type_inference.h"
 #include "src/shared/metadata/metadata_state.h"
@@ -40,6 +41,17 @@ namespace funcs {
 namespace metadata {
 
 using ScalarUDF = px::carnot::udf::ScalarUDF;
+
+/**
+ * Bases for the UDFs that only look up the metadata of a UPID or a K8s object ID. These are
+ * evaluated once per distinct input value instead of once per row, see MemoizedScalarUDF.
+ */
+template <typename TUDF>
+using UPIDMetadataUDF =
+    px::carnot::udf::MemoizedScalarUDF<TUDF, types::DataType::UINT128, types::DataType::STRING>;
+template <typename TUDF>
+using K8sIDMetadataUDF =
+    px::carnot::udf::MemoizedScalarUDF<TUDF, types::DataType::STRING, types::DataType::STRING>;
 using K8sNameIdentView = px::md::K8sMetadataState::K8sNameIdentView;
 
 namespace internal {
@@ -99,7 +111,7 @@ class UPIDToASIDUDF : public ScalarUDF {
   }
 };
 
-class PodIDToPodNameUDF : public ScalarUDF {
+class PodIDToPodNameUDF : public K8sIDMetadataUDF<PodIDToPodNameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -188,7 +200,7 @@ class PodNameToPodIPUDF : public ScalarUDF {
   }
 };
 
-class PodIDToNamespaceUDF : public ScalarUDF {
+class PodIDToNamespaceUDF : public K8sIDMetadataUDF<PodIDToNamespaceUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -234,7 +246,7 @@ class PodNameToNamespaceUDF : public ScalarUDF {
   }
 };
 
-class UPIDToContainerIDUDF : public ScalarUDF {
+class UPIDToContainerIDUDF : public UPIDMetadataUDF<UPIDToContainerIDUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -275,7 +287,7 @@ inline const md::ContainerInfo* UPIDToContainer(const px::md::AgentMetadataState
   return md->k8s_metadata_state().ContainerInfoByID(pid->cid());
 }
 
-class UPIDToContainerNameUDF : public ScalarUDF {
+class UPIDToContainerNameUDF : public UPIDMetadataUDF<UPIDToContainerNameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -317,7 +329,7 @@ inline const px::md::PodInfo* UPIDtoPod(const px::md::AgentMetadataState* md,
   return pod_info;
 }
 
-class UPIDToNamespaceUDF : public ScalarUDF {
+class UPIDToNamespaceUDF : public UPIDMetadataUDF<UPIDToNamespaceUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -349,7 +361,7 @@ class UPIDToNamespaceUDF : public ScalarUDF {
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
 };
 
-class UPIDToPodIDUDF : public ScalarUDF {
+class UPIDToPodIDUDF : public UPIDMetadataUDF<UPIDToPodIDUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -376,7 +388,7 @@ class UPIDToPodIDUDF : public ScalarUDF {
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
 };
 
-class UPIDToPodNameUDF : public ScalarUDF {
+class UPIDToPodNameUDF : public UPIDMetadataUDF<UPIDToPodNameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -407,7 +419,7 @@ class UPIDToPodNameUDF : public ScalarUDF {
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
 };
 
-class ServiceIDToServiceNameUDF : public ScalarUDF {
+class ServiceIDToServiceNameUDF : public K8sIDMetadataUDF<ServiceIDToServiceNameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue service_id) {
     auto md = GetMetadataState(ctx);
@@ -535,7 +547,7 @@ class ServiceNameToNamespaceUDF : public ScalarUDF {
 /**
  * @brief Returns the service ids for services that are currently running.
  */
-class UPIDToServiceIDUDF : public ScalarUDF {
+class UPIDToServiceIDUDF : public UPIDMetadataUDF<UPIDToServiceIDUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -577,7 +589,7 @@ class UPIDToServiceIDUDF : public ScalarUDF {
 /**
  * @brief Returns the service names for services that are currently running.
  */
-class UPIDToServiceNameUDF : public ScalarUDF {
+class UPIDToServiceNameUDF : public UPIDMetadataUDF<UPIDToServiceNameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -623,7 +635,7 @@ class UPIDToServiceNameUDF : public ScalarUDF {
 /**
  * @brief Returns the node name for the pod associated with the input upid.
  */
-class UPIDToNodeNameUDF : public ScalarUDF {
+class UPIDToNodeNameUDF : public UPIDMetadataUDF<UPIDToNodeNameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1542,7 +1554,7 @@ class DeploymentNameToStatusUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set names for Replica Sets that are currently running.
  */
-class UPIDToReplicaSetNameUDF : public ScalarUDF {
+class UPIDToReplicaSetNameUDF : public UPIDMetadataUDF<UPIDToReplicaSetNameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1583,7 +1595,7 @@ class UPIDToReplicaSetNameUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set IDs for Replica Sets that are currently running.
  */
-class UPIDToReplicaSetIDUDF : public ScalarUDF {
+class UPIDToReplicaSetIDUDF : public UPIDMetadataUDF<UPIDToReplicaSetIDUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1623,7 +1635,7 @@ class UPIDToReplicaSetIDUDF : public ScalarUDF {
 /**
  * @brief Returns the Replica Set status for Replica Sets that are currently running.
  */
-class UPIDToReplicaSetStatusUDF : public ScalarUDF {
+class UPIDToReplicaSetStatusUDF : public UPIDMetadataUDF<UPIDToReplicaSetStatusUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1661,7 +1673,7 @@ class UPIDToReplicaSetStatusUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment name for processes which are currently running.
  */
-class UPIDToDeploymentNameUDF : public ScalarUDF {
+class UPIDToDeploymentNameUDF : public UPIDMetadataUDF<UPIDToDeploymentNameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1707,7 +1719,7 @@ class UPIDToDeploymentNameUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment ID for process which is currently running.
  */
-class UPIDToDeploymentIDUDF : public ScalarUDF {
+class UPIDToDeploymentIDUDF : public UPIDMetadataUDF<UPIDToDeploymentIDUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1752,7 +1764,7 @@ class UPIDToDeploymentIDUDF : public ScalarUDF {
 /**
  * @brief Returns the hostname for the pod associated with the input upid.
  */
-class UPIDToHostnameUDF : public ScalarUDF {
+class UPIDToHostnameUDF : public UPIDMetadataUDF<UPIDToHostnameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, UInt128Value upid_value) {
     auto md = GetMetadataState(ctx);
@@ -1780,7 +1792,7 @@ class UPIDToHostnameUDF : public ScalarUDF {
 /**
  * @brief Returns the service names for the given pod ID.
  */
-class PodIDToServiceNameUDF : public ScalarUDF {
+class PodIDToServiceNameUDF : public K8sIDMetadataUDF<PodIDToServiceNameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -1822,7 +1834,7 @@ class PodIDToServiceNameUDF : public ScalarUDF {
 /**
  * @brief Returns the service ids for the given pod ID.
  */
-class PodIDToServiceIDUDF : public ScalarUDF {
+class PodIDToServiceIDUDF : public K8sIDMetadataUDF<PodIDToServiceIDUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -1919,7 +1931,7 @@ class PodNameToOwnerReferencesUDF : public ScalarUDF {
 /**
  * @brief Returns the Node Name of a pod ID passed in.
  */
-class PodIDToNodeNameUDF : public ScalarUDF {
+class PodIDToNodeNameUDF : public K8sIDMetadataUDF<PodIDToNodeNameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -1948,7 +1960,7 @@ class PodIDToNodeNameUDF : public ScalarUDF {
 /**
  * @brief Returns the ReplicaSet name of a pod ID passed in.
  */
-class PodIDToReplicaSetNameUDF : public ScalarUDF {
+class PodIDToReplicaSetNameUDF : public K8sIDMetadataUDF<PodIDToReplicaSetNameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -2014,7 +2026,7 @@ class PodIDToReplicaSetIDUDF : public ScalarUDF {
 /**
  * @brief Returns the Deployment name of a pod ID passed in.
  */
-class PodIDToDeploymentNameUDF : public ScalarUDF {
+class PodIDToDeploymentNameUDF : public K8sIDMetadataUDF<PodIDToDeploymentNameUDF> {
  public:
   StringValue Exec(FunctionContext* ctx, StringValue pod_id) {
     auto md = GetMetadataState(ctx);
@@ -87,27 +87,15 @@ char* PlannerPlan(PlannerPtr planner_ptr, const char* query_request_str_c,
 
   auto planner = reinterpret_cast<px::carnot::planner::LogicalPlanner*>(planner_ptr);
 
-  auto distributed_plan_status = planner->Plan(query_request_pb);
-  if (!distributed_plan_status.ok()) {
-    return ExitEarly<LogicalPlannerResult>(distributed_plan_status.status(), resultLen);
+  auto plan_status = planner->PlanProto(query_request_pb);
+  if (!plan_status.ok()) {
+    return ExitEarly<LogicalPlannerResult>(plan_status.status(), resultLen);
   }
-  std::unique_ptr<px::carnot::planner::distributed::DistributedPlan> distributed_plan =
-      distributed_plan_status.ConsumeValueOrDie();
 
   // If the response is ok, then we can go ahead and set this up.
   LogicalPlannerResult planner_result_pb;
-  WrapStatus(&planner_result_pb, distributed_plan_status.status());
-  // In the future, if we actually have plan options that will actually determine how the plan is
-  // constructed, we may want to pass the planOptions to planner.Plan. However, this
-  // will need to go through many more layers (such as the coordinator), so this is fine for now.
-  distributed_plan->SetPlanOptions(query_request_pb.logical_planner_state().plan_options());
-
-  auto plan_pb_status = distributed_plan->ToProto();
-  if (!plan_pb_status.ok()) {
-    return ExitEarly<LogicalPlannerResult>(plan_pb_status.status(), resultLen);
-  }
-
-  *(planner_result_pb.mutable_plan()) = plan_pb_status.ConsumeValueOrDie();
+  WrapStatus(&planner_result_pb, plan_status.status());
+  *(planner_result_pb.mutable_plan()) = *plan_status.ConsumeValueOrDie();
 
   // Serialize the logical plan into bytes.
   return PrepareResult(&planner_result_pb, resultLen);
@@ -27,6 +27,7 @@
 #include "src/carnot/planner/compiler/analyzer/combine_consecutive_maps_rule.h"
 #include "src/carnot/planner/compiler/analyzer/convert_metadata_rule.h"
 #include "src/carnot/planner/compiler/analyzer/drop_to_map_rule.h"
+#include "src/carnot/planner/compiler/analyzer/fuse_column_scans_rule.h"
 #include "src/carnot/planner/compiler/analyzer/merge_group_by_into_group_acceptor_rule.h"
 #include "src/carnot/planner/compiler/analyzer/nested_blocking_agg_fn_check_rule.h"
 #include "src/carnot/planner/compiler/analyzer/propagate_expression_annotations_rule.h"
@@ -35,6 +36,7 @@
 #include "src/carnot/planner/compiler/analyzer/resolve_stream_rule.h"
 #include "src/carnot/planner/compiler/analyzer/resolve_types_rule.h"
 #include "src/carnot/planner/compiler/analyzer/restrict_columns_rule.h"
+#include "src/carnot/planner/compiler/analyzer/select_join_build_side_rule.h"
 #include "src/carnot/planner/compiler/analyzer/setup_join_type_rule.h"
 #include "src/carnot/planner/compiler/analyzer/unique_sink_names_rule.h"
 #include "src/carnot/planner/compiler/analyzer/verify_filter_expression_rule.h"
@@ -66,6 +68,10 @@ class Analyzer : public RuleExecutor<IR> {
     source_and_metadata_resolution_batch->AddRule<ResolveMetadataPropertyRule>(compiler_state_,
                                                                                md_handler_.get());
     source_and_metadata_resolution_batch->AddRule<SetupJoinTypeRule>();
+    // Only the local execution engine knows the sizes of the tables it plans against.
+    if (!compiler_state_->table_size_estimates().empty()) {
+      source_and_metadata_resolution_batch->AddRule<SelectJoinBuildSideRule>(compiler_state_);
+    }
     source_and_metadata_resolution_batch->AddRule<MergeGroupByIntoGroupAcceptorRule>(
         IRNodeType::kBlockingAgg);
     source_and_metadata_resolution_batch->AddRule<MergeGroupByIntoGroupAcceptorRule>(
@@ -107,6 +113,11 @@ class Analyzer : public RuleExecutor<IR> {
     metadata_conversion_batch->AddRule<PropagateExpressionAnnotationsRule>();
   }
 
+  void CreateFuseColumnScansBatch() {
+    RuleBatch* fuse_column_scans_batch = CreateRuleBatch<FailOnMax>("FuseColumnScans", 2);
+    fuse_column_scans_batch->AddRule<FuseColumnScansRule>(compiler_state_);
+  }
+
   void CreateResolutionVerificationBatch() {
     RuleBatch* resolution_verification_batch =
         CreateRuleBatch<FailOnMax>("ResolutionVerification", 1);
@@ -127,6 +138,7 @@ class Analyzer : public RuleExecutor<IR> {
     CreateDataTypeResolutionBatch();
     CreateManageColumnAccessBatch();
     CreateMetadataConversionBatch();
+    CreateFuseColumnScansBatch();
     CreateResolutionVerificationBatch();
     CreateRemoveIROnlyNodesBatch();
     return Status::OK();
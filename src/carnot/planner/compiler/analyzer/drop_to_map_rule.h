@@ -35,6 +35,9 @@ class DropToMapOperatorRule : public Rule {
   explicit DropToMapOperatorRule(CompilerState* compiler_state)
       : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
 
+  // Drops are only ever converted once, so only newly added drops need converting.
+  bool SupportsIncrementalExecution() const override { return true; }
+
  protected:
   StatusOr<bool> Apply(IRNode* ir_node) override;
 
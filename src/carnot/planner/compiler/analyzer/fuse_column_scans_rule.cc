@@ -0,0 +1,192 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "src/carnot/planner/compiler/analyzer/fuse_column_scans_rule.h"
+#include "src/carnot/planner/ir/column_ir.h"
+#include "src/carnot/planner/ir/string_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+namespace {
+
+// A UDF that scans a column for a constant key, and the multi-key UDF it is rewritten to. The
+// multi-key UDFs take the JSON list of keys as their init arg, followed by the column and the key.
+struct FusableFunc {
+  std::string multi_func_name;
+  int64_t column_arg_idx;
+  int64_t key_arg_idx;
+};
+
+const absl::flat_hash_map<std::string, FusableFunc>& FusableFuncs() {
+  static const auto* funcs = new absl::flat_hash_map<std::string, FusableFunc>{
+      {"pluck", {"_pluck_multi", 0, 1}},
+      {"pluck_int64", {"_pluck_multi_int64", 0, 1}},
+      {"pluck_float64", {"_pluck_multi_float64", 0, 1}},
+      {"regex_match", {"_regex_match_multi", 1, 0}},
+  };
+  return *funcs;
+}
+
+// The calls of a map that scan the same column with the same UDF.
+struct ScanGroup {
+  std::vector<FuncIR*> funcs;
+  std::vector<std::string> keys;
+};
+
+// Groups are keyed by the UDF and the column it scans, ordered so that the rewrite doesn't depend
+// on hashing.
+using ScanGroups = std::map<std::pair<std::string, std::string>, ScanGroup>;
+
+// Returns the fusable func that func calls with a column and a constant key, or nullptr.
+const FusableFunc* GetFusableFunc(FuncIR* func) {
+  auto it = FusableFuncs().find(func->func_name());
+  if (it == FusableFuncs().end()) {
+    return nullptr;
+  }
+  const auto& args = func->all_args();
+  if (args.size() != 2 || !Match(args[it->second.column_arg_idx], ColumnNode()) ||
+      !Match(args[it->second.key_arg_idx], String())) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+void CollectScans(ExpressionIR* expr, ScanGroups* groups) {
+  if (!Match(expr, Func())) {
+    return;
+  }
+  auto func = static_cast<FuncIR*>(expr);
+  const FusableFunc* fusable = GetFusableFunc(func);
+  if (fusable == nullptr) {
+    for (ExpressionIR* arg : func->all_args()) {
+      CollectScans(arg, groups);
+    }
+    return;
+  }
+  auto column = static_cast<ColumnIR*>(func->all_args()[fusable->column_arg_idx]);
+  auto key = static_cast<StringIR*>(func->all_args()[fusable->key_arg_idx])->str();
+  ScanGroup& group = (*groups)[{func->func_name(), column->col_name()}];
+  if (std::find(group.funcs.begin(), group.funcs.end(), func) != group.funcs.end()) {
+    return;
+  }
+  group.funcs.push_back(func);
+  if (std::find(group.keys.begin(), group.keys.end(), key) == group.keys.end()) {
+    group.keys.push_back(key);
+  }
+}
+
+std::string KeysToJSON(const std::vector<std::string>& keys) {
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  writer.StartArray();
+  for (const auto& key : keys) {
+    writer.String(key.data(), key.size());
+  }
+  writer.EndArray();
+  return sb.GetString();
+}
+
+}  // namespace
+
+StatusOr<bool> FuseColumnScansRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, Map())) {
+    return false;
+  }
+  auto map = static_cast<MapIR*>(ir_node);
+
+  ScanGroups groups;
+  for (const auto& col_expr : map->col_exprs()) {
+    CollectScans(col_expr.node, &groups);
+  }
+
+  bool fused = false;
+  for (const auto& [func_and_column, group] : groups) {
+    // A single key gains nothing from the multi-key UDF.
+    if (group.keys.size() < 2) {
+      continue;
+    }
+    const std::string& multi_func_name =
+        FusableFuncs().at(func_and_column.first).multi_func_name;
+    if (!compiler_state_->registry_info()->GetUDFExecType(multi_func_name).ok()) {
+      continue;
+    }
+    std::string keys_json = KeysToJSON(group.keys);
+    for (FuncIR* func : group.funcs) {
+      PX_RETURN_IF_ERROR(FuseScan(map, func, multi_func_name, keys_json));
+    }
+    fused = true;
+  }
+  return fused;
+}
+
+Status FuseColumnScansRule::FuseScan(MapIR* map, FuncIR* func, const std::string& multi_func_name,
+                                     const std::string& keys_json) {
+  IR* graph = map->graph();
+  const FusableFunc* fusable = GetFusableFunc(func);
+  DCHECK(fusable != nullptr);
+  auto column = static_cast<ColumnIR*>(func->all_args()[fusable->column_arg_idx]);
+  auto key = static_cast<StringIR*>(func->all_args()[fusable->key_arg_idx]);
+
+  PX_ASSIGN_OR_RETURN(StringIR * keys_arg, graph->CreateNode<StringIR>(func->ast(), keys_json));
+  PX_ASSIGN_OR_RETURN(ColumnIR * column_arg,
+                      graph->CreateNode<ColumnIR>(func->ast(), column->col_name(),
+                                                  column->container_op_parent_idx()));
+  PX_ASSIGN_OR_RETURN(StringIR * key_arg, graph->CreateNode<StringIR>(func->ast(), key->str()));
+  PX_ASSIGN_OR_RETURN(
+      FuncIR * multi_func,
+      graph->CreateNode<FuncIR>(func->ast(),
+                                FuncIR::Op{FuncIR::Opcode::non_op, "", multi_func_name},
+                                std::vector<ExpressionIR*>{keys_arg, column_arg, key_arg}));
+  multi_func->set_annotations(func->annotations());
+
+  int64_t func_id = func->id();
+  for (int64_t parent_id : graph->dag().ParentsOf(func_id)) {
+    IRNode* container = graph->Get(parent_id);
+    if (Match(container, Func())) {
+      PX_RETURN_IF_ERROR(static_cast<FuncIR*>(container)->UpdateArg(func, multi_func));
+    } else if (Match(container, Map())) {
+      PX_RETURN_IF_ERROR(static_cast<MapIR*>(container)->UpdateColExpr(func, multi_func));
+    } else {
+      return error::Internal("Unsupported IRNode container for $0: $1", func->func_name(),
+                             container->DebugString());
+    }
+  }
+  // Delete the replaced scan and its args, unless replacing its last use already did.
+  if (graph->HasNode(func_id)) {
+    PX_RETURN_IF_ERROR(graph->DeleteOrphansInSubtree(func_id));
+  }
+  return PropagateTypeChangesFromNode(graph, multi_func, compiler_state_);
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/analyzer/fuse_column_scans_rule.h"
+#include "src/carnot/planner/compiler/analyzer/resolve_types_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+using table_store::schema::Relation;
+
+class FuseColumnScansRuleTest : public RulesTest {
+ protected:
+  void SetUpImpl() override {
+    RulesTest::SetUpImpl();
+    relation_ = Relation({types::STRING, types::STRING}, {"json", "other_json"});
+    compiler_state_->relation_map()->emplace("table", relation_);
+  }
+
+  FuncIR* MakePluck(const std::string& name, const std::string& col, const std::string& key) {
+    return MakeFunc(name, {MakeColumn(col, 0), MakeString(key)});
+  }
+
+  Relation relation_;
+};
+
+TEST_F(FuseColumnScansRuleTest, fuses_plucks_of_same_column) {
+  auto src = MakeMemSource(relation_);
+  auto map = MakeMap(src, {{"p50", MakePluck("pluck_float64", "json", "p50")},
+                           {"p90", MakePluck("pluck_float64", "json", "p90")},
+                           {"p50_again", MakePluck("pluck_float64", "json", "p50")},
+                           {"count", MakeFunc("add", {MakePluck("pluck_int64", "json", "count"),
+                                                      MakeInt(1)})},
+                           {"other", MakePluck("pluck_float64", "other_json", "p99")}});
+  MakeMemSink(map, "sink");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  FuseColumnScansRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+
+  const auto& exprs = map->col_exprs();
+  for (int64_t i : {0, 1, 2}) {
+    ASSERT_MATCH(exprs[i].node, Func());
+    auto func = static_cast<FuncIR*>(exprs[i].node);
+    EXPECT_EQ("_pluck_multi_float64", func->func_name());
+    ASSERT_EQ(3, func->all_args().size());
+    EXPECT_MATCH(func->all_args()[0], String(R"(["p50","p90"])"));
+    EXPECT_MATCH(func->all_args()[1], ColumnNode("json"));
+    EXPECT_MATCH(func, ResolvedExpression());
+    EXPECT_EQ(types::FLOAT64, func->EvaluatedDataType());
+    EXPECT_EQ(1, func->init_args().size());
+  }
+  EXPECT_MATCH(static_cast<FuncIR*>(exprs[1].node)->all_args()[2], String("p90"));
+  // The same UDF with the same init args, so the calls share an instance at execution time.
+  EXPECT_EQ(static_cast<FuncIR*>(exprs[0].node)->func_id(),
+            static_cast<FuncIR*>(exprs[1].node)->func_id());
+
+  // A single key per pluck UDF and column is left alone, including when nested.
+  auto count = static_cast<FuncIR*>(exprs[3].node);
+  EXPECT_EQ("pluck_int64", static_cast<FuncIR*>(count->all_args()[0])->func_name());
+  EXPECT_EQ("pluck_float64", static_cast<FuncIR*>(exprs[4].node)->func_name());
+
+  // The rewritten plucks aren't fused again.
+  result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ValueOrDie());
+}
+
+TEST_F(FuseColumnScansRuleTest, deletes_replaced_scans) {
+  auto p50 = MakePluck("pluck_float64", "json", "p50");
+  auto p90 = MakePluck("pluck_float64", "json", "p90");
+  auto nested = MakePluck("pluck_float64", "json", "p99");
+  std::vector<int64_t> replaced_ids;
+  for (FuncIR* func : {p50, p90, nested}) {
+    replaced_ids.push_back(func->id());
+    for (ExpressionIR* arg : func->all_args()) {
+      replaced_ids.push_back(arg->id());
+    }
+  }
+
+  auto src = MakeMemSource(relation_);
+  auto map = MakeMap(src, {{"p50", p50},
+                           {"p90", p90},
+                           {"p99_plus_one", MakeFunc("add", {nested, MakeInt(1)})}});
+  MakeMemSink(map, "sink");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  FuseColumnScansRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+
+  for (int64_t id : replaced_ids) {
+    EXPECT_FALSE(graph->HasNode(id)) << graph->Get(id)->DebugString();
+  }
+}
+
+TEST_F(FuseColumnScansRuleTest, nested_plucks) {
+  auto src = MakeMemSource(relation_);
+  auto map = MakeMap(src, {{"sum", MakeFunc("add", {MakePluck("pluck_int64", "json", "a"),
+                                                    MakePluck("pluck_int64", "json", "b")})}});
+  MakeMemSink(map, "sink");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  FuseColumnScansRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+
+  ASSERT_MATCH(map->col_exprs()[0].node, Func());
+  auto sum = static_cast<FuncIR*>(map->col_exprs()[0].node);
+  for (ExpressionIR* arg : sum->all_args()) {
+    ASSERT_MATCH(arg, Func());
+    EXPECT_EQ("_pluck_multi_int64", static_cast<FuncIR*>(arg)->func_name());
+    EXPECT_MATCH(static_cast<FuncIR*>(arg)->all_args()[0], String(R"(["a","b"])"));
+  }
+  EXPECT_MATCH(sum, ResolvedExpression());
+  EXPECT_EQ(types::INT64, sum->EvaluatedDataType());
+}
+
+TEST_F(FuseColumnScansRuleTest, fuses_regex_matches_of_same_column) {
+  auto src = MakeMemSource(relation_);
+  auto map = MakeMap(
+      src, {{"is_get", MakeFunc("regex_match", {MakeString("GET .*"), MakeColumn("json", 0)})},
+            {"is_post", MakeFunc("regex_match", {MakeString("POST .*"), MakeColumn("json", 0)})},
+            {"other", MakeFunc("regex_match", {MakeString(".*"), MakeColumn("other_json", 0)})}});
+  MakeMemSink(map, "sink");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  FuseColumnScansRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+
+  const auto& exprs = map->col_exprs();
+  for (int64_t i : {0, 1}) {
+    ASSERT_MATCH(exprs[i].node, Func());
+    auto func = static_cast<FuncIR*>(exprs[i].node);
+    EXPECT_EQ("_regex_match_multi", func->func_name());
+    ASSERT_EQ(3, func->all_args().size());
+    EXPECT_MATCH(func->all_args()[0], String(R"(["GET .*","POST .*"])"));
+    EXPECT_MATCH(func->all_args()[1], ColumnNode("json"));
+    EXPECT_MATCH(func, ResolvedExpression());
+    EXPECT_EQ(types::BOOLEAN, func->EvaluatedDataType());
+  }
+  EXPECT_MATCH(static_cast<FuncIR*>(exprs[0].node)->all_args()[2], String("GET .*"));
+  EXPECT_MATCH(static_cast<FuncIR*>(exprs[1].node)->all_args()[2], String("POST .*"));
+  EXPECT_EQ("regex_match", static_cast<FuncIR*>(exprs[2].node)->func_name());
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
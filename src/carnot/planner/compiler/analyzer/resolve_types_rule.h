@@ -37,6 +37,9 @@ class ResolveTypesRule : public Rule {
       : Rule(compiler_state, /*use_topo*/ true, /*reverse_topological_execution*/ false) {}
 
   StatusOr<bool> Apply(IRNode* ir_node) override;
+
+  // Only operators that are added or whose types are cleared by a change upstream need resolving.
+  bool SupportsIncrementalExecution() const override { return true; }
 };
 
 }  // namespace compiler
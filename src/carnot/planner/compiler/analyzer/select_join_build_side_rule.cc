@@ -0,0 +1,143 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "src/carnot/planner/compiler/analyzer/select_join_build_side_rule.h"
+#include "src/carnot/planner/ir/blocking_agg_ir.h"
+#include "src/carnot/planner/ir/limit_ir.h"
+#include "src/carnot/planner/ir/memory_source_ir.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+namespace {
+
+// The fraction of its input a filter is assumed to keep.
+constexpr double kFilterSelectivity = 0.5;
+// The fraction of its input a grouped aggregate is assumed to output, one row per group.
+constexpr double kGroupedAggSelectivity = 0.1;
+
+double BytesPerRow(const TableSizeEstimate& size) {
+  return size.num_rows > 0 ? static_cast<double>(size.num_bytes) / size.num_rows : 0;
+}
+
+TableSizeEstimate WithRows(int64_t num_rows, double bytes_per_row) {
+  return {num_rows, static_cast<int64_t>(num_rows * bytes_per_row)};
+}
+
+}  // namespace
+
+std::optional<TableSizeEstimate> SelectJoinBuildSideRule::EstimateSize(
+    const OperatorIR* op, EstimateCache* cache) const {
+  auto it = cache->find(op);
+  if (it != cache->end()) {
+    return it->second;
+  }
+  auto estimate = EstimateSizeImpl(op, cache);
+  cache->emplace(op, estimate);
+  return estimate;
+}
+
+std::optional<TableSizeEstimate> SelectJoinBuildSideRule::EstimateSizeImpl(
+    const OperatorIR* op, EstimateCache* cache) const {
+  if (Match(op, MemorySource())) {
+    const auto& estimates = compiler_state_->table_size_estimates();
+    auto it = estimates.find(static_cast<const MemorySourceIR*>(op)->table_name());
+    if (it == estimates.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+  if (Match(op, EmptySource())) {
+    return TableSizeEstimate{};
+  }
+  if (op->parents().empty()) {
+    return std::nullopt;
+  }
+
+  std::vector<TableSizeEstimate> parent_sizes;
+  for (OperatorIR* parent : op->parents()) {
+    auto parent_size = EstimateSize(parent, cache);
+    if (!parent_size.has_value()) {
+      return std::nullopt;
+    }
+    parent_sizes.push_back(parent_size.value());
+  }
+  const TableSizeEstimate& input = parent_sizes[0];
+
+  if (Match(op, Join())) {
+    // Joins are assumed to be on keys, so each row of the larger side matches one row.
+    const TableSizeEstimate& right = parent_sizes[1];
+    return WithRows(std::max(input.num_rows, right.num_rows),
+                    BytesPerRow(input) + BytesPerRow(right));
+  }
+  if (Match(op, Union())) {
+    TableSizeEstimate total;
+    for (const auto& size : parent_sizes) {
+      total.num_rows += size.num_rows;
+      total.num_bytes += size.num_bytes;
+    }
+    return total;
+  }
+  if (Match(op, Filter())) {
+    return WithRows(static_cast<int64_t>(input.num_rows * kFilterSelectivity), BytesPerRow(input));
+  }
+  if (Match(op, Limit())) {
+    auto limit = static_cast<const LimitIR*>(op);
+    return WithRows(std::min(input.num_rows, limit->limit_value()), BytesPerRow(input));
+  }
+  if (Match(op, BlockingAgg())) {
+    auto agg = static_cast<const BlockingAggIR*>(op);
+    if (agg->groups().empty() && !Match(op->parents()[0], GroupBy())) {
+      return WithRows(1, BytesPerRow(input));
+    }
+    return WithRows(static_cast<int64_t>(input.num_rows * kGroupedAggSelectivity),
+                    BytesPerRow(input));
+  }
+  // Maps, drops and the other operators keep the size of their input.
+  return input;
+}
+
+StatusOr<bool> SelectJoinBuildSideRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, Join())) {
+    return false;
+  }
+  auto join = static_cast<JoinIR*>(ir_node);
+  if (join->join_type() != JoinIR::JoinType::kInner &&
+      join->join_type() != JoinIR::JoinType::kOuter) {
+    return false;
+  }
+  EstimateCache cache;
+  auto build_size = EstimateSize(join->parents()[0], &cache);
+  auto probe_size = EstimateSize(join->parents()[1], &cache);
+  if (!build_size.has_value() || !probe_size.has_value() ||
+      build_size->num_bytes <= probe_size->num_bytes) {
+    return false;
+  }
+  PX_RETURN_IF_ERROR(join->SwapParents());
+  return true;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
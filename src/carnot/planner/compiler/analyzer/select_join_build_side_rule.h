@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <optional>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/carnot/planner/compiler_state/compiler_state.h"
+#include "src/carnot/planner/ir/join_ir.h"
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+/**
+ * @brief Makes the smaller input of each inner and outer join its build side.
+ *
+ * The executor builds its hash table from the left parent of a join and streams the right parent
+ * through it, so a script that joins a large table against a small one can end up holding the
+ * large one in memory. This rule estimates the size of both inputs from the table sizes in the
+ * CompilerState and swaps the parents when the left one is larger. Joins over multiple tables
+ * pick the build side of each of their joins in turn. Joins whose inputs have no estimate are left
+ * as written, as are left joins, which the executor can only run with the left parent as the build
+ * side.
+ *
+ * Table sizes are only known when planning for local execution, against the engine's own table
+ * store. The distributed planner's state has no table stats, so the analyzer only runs this rule
+ * when the CompilerState has size estimates.
+ */
+class SelectJoinBuildSideRule : public Rule {
+ public:
+  explicit SelectJoinBuildSideRule(CompilerState* compiler_state)
+      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+
+  using EstimateCache = absl::flat_hash_map<const OperatorIR*, std::optional<TableSizeEstimate>>;
+
+  /**
+   * @brief Estimates the rows and bytes an operator outputs, or returns std::nullopt if it reads
+   * from a table of unknown size.
+   */
+  std::optional<TableSizeEstimate> EstimateSize(const OperatorIR* op, EstimateCache* cache) const;
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+
+ private:
+  std::optional<TableSizeEstimate> EstimateSizeImpl(const OperatorIR* op,
+                                                    EstimateCache* cache) const;
+};
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
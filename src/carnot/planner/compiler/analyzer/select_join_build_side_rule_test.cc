@@ -0,0 +1,149 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "src/carnot/planner/compiler/analyzer/resolve_types_rule.h"
+#include "src/carnot/planner/compiler/analyzer/select_join_build_side_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+using table_store::schema::Relation;
+using ::testing::ElementsAre;
+
+class SelectJoinBuildSideRuleTest : public RulesTest {
+ protected:
+  void SetUpImpl() override {
+    RulesTest::SetUpImpl();
+    big_relation_ = Relation({types::INT64, types::STRING}, {"upid", "req_body"});
+    small_relation_ = Relation({types::INT64, types::STRING}, {"id", "pod"});
+    compiler_state_->relation_map()->emplace("big", big_relation_);
+    compiler_state_->relation_map()->emplace("small", small_relation_);
+    compiler_state_->set_table_size_estimates(
+        {{"big", {1000 * 1000, 100 * 1000 * 1000}}, {"small", {10, 1000}}});
+  }
+
+  JoinIR* MakeBigSmallJoin(OperatorIR* big, OperatorIR* small, const std::string& join_type) {
+    return MakeJoin({big, small}, join_type, big_relation_, small_relation_,
+                    std::vector<std::string>{"upid"}, std::vector<std::string>{"id"},
+                    std::vector<std::string>{"_x", "_y"});
+  }
+
+  Relation big_relation_;
+  Relation small_relation_;
+};
+
+TEST_F(SelectJoinBuildSideRuleTest, builds_on_smaller_side) {
+  auto big = MakeMemSource("big", big_relation_);
+  auto small = MakeMemSource("small", small_relation_);
+  auto join = MakeBigSmallJoin(big, small, "inner");
+  MakeMemSink(join, "sink");
+
+  SelectJoinBuildSideRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+
+  EXPECT_EQ(small, join->parents()[0]);
+  EXPECT_EQ(big, join->parents()[1]);
+  ASSERT_EQ(1, join->left_on_columns().size());
+  EXPECT_EQ("id", join->left_on_columns()[0]->col_name());
+  EXPECT_EQ(0, join->left_on_columns()[0]->container_op_parent_idx());
+  ASSERT_EQ(1, join->right_on_columns().size());
+  EXPECT_EQ("upid", join->right_on_columns()[0]->col_name());
+  EXPECT_EQ(1, join->right_on_columns()[0]->container_op_parent_idx());
+  EXPECT_THAT(join->suffix_strs(), ElementsAre("_y", "_x"));
+
+  // The join already builds on the smaller side.
+  result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ValueOrDie());
+
+  // The output columns keep the order of the script.
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+  EXPECT_THAT(join->column_names(), ElementsAre("upid", "req_body", "id", "pod"));
+  for (ColumnIR* col : join->output_columns()) {
+    EXPECT_EQ(col->col_name() == "id" || col->col_name() == "pod" ? 0 : 1,
+              col->container_op_parent_idx());
+  }
+}
+
+TEST_F(SelectJoinBuildSideRuleTest, keeps_left_joins_and_unknown_sizes) {
+  auto big = MakeMemSource("big", big_relation_);
+  auto small = MakeMemSource("small", small_relation_);
+  auto left_join = MakeBigSmallJoin(big, small, "left");
+  MakeMemSink(left_join, "left_sink");
+
+  compiler_state_->relation_map()->emplace("unknown", small_relation_);
+  auto unknown = MakeMemSource("unknown", small_relation_);
+  auto unknown_join = MakeBigSmallJoin(big, unknown, "inner");
+  MakeMemSink(unknown_join, "unknown_sink");
+
+  SelectJoinBuildSideRule rule(compiler_state_.get());
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ValueOrDie());
+  EXPECT_EQ(big, left_join->parents()[0]);
+  EXPECT_EQ(big, unknown_join->parents()[0]);
+}
+
+TEST_F(SelectJoinBuildSideRuleTest, estimates_through_operators) {
+  auto big = MakeMemSource("big", big_relation_);
+  auto small = MakeMemSource("small", small_relation_);
+  auto limit = MakeLimit(big, 5);
+  auto join = MakeJoin({small, limit}, "inner", small_relation_, big_relation_,
+                       std::vector<std::string>{"id"}, std::vector<std::string>{"upid"});
+  auto filter = MakeFilter(join);
+  MakeMemSink(filter, "sink");
+
+  SelectJoinBuildSideRule rule(compiler_state_.get());
+  SelectJoinBuildSideRule::EstimateCache cache;
+  auto limit_size = rule.EstimateSize(limit, &cache);
+  ASSERT_TRUE(limit_size.has_value());
+  EXPECT_EQ(5, limit_size->num_rows);
+  EXPECT_EQ(500, limit_size->num_bytes);
+
+  auto join_size = rule.EstimateSize(join, &cache);
+  ASSERT_TRUE(join_size.has_value());
+  EXPECT_EQ(10, join_size->num_rows);
+  EXPECT_EQ(10 * (100 + 100), join_size->num_bytes);
+
+  auto filter_size = rule.EstimateSize(filter, &cache);
+  ASSERT_TRUE(filter_size.has_value());
+  EXPECT_EQ(5, filter_size->num_rows);
+
+  // The limited side of the join is now the smaller one.
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+  EXPECT_EQ(limit, join->parents()[0]);
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -72,11 +72,13 @@ StatusOr<std::shared_ptr<IR>> Compiler::CompileToIR(const std::string& query,
 
 Status Compiler::Analyze(IR* ir, CompilerState* compiler_state) {
   PX_ASSIGN_OR_RETURN(std::unique_ptr<Analyzer> analyzer, Analyzer::Create(compiler_state));
+  analyzer->set_rule_profiler(compiler_state->rule_profiler());
   return analyzer->Execute(ir);
 }
 
 Status Compiler::Optimize(IR* ir, CompilerState* compiler_state) {
   PX_ASSIGN_OR_RETURN(std::unique_ptr<Optimizer> optimizer, Optimizer::Create(compiler_state));
+  optimizer->set_rule_profiler(compiler_state->rule_profiler());
   return optimizer->Execute(ir);
 }
 
@@ -34,6 +34,8 @@ namespace px {
 namespace carnot {
 namespace planner {
 
+class RuleProfiler;
+
 /**
  * IDRegistryKey is the class used to uniquely refer to a UDF or UDA in the ID registry.
  * Distinct from the normal RegistryKey since that registry only cares about types, whereas the ID
@@ -105,7 +107,17 @@ struct DebugInfo {
   std::vector<OTelDebugAttribute> otel_debug_attrs;
 };
 
+/**
+ * The size of a table, as last reported by the table store that holds it. The planner uses it to
+ * estimate the sizes of the operators that read from the table.
+ */
+struct TableSizeEstimate {
+  int64_t num_rows = 0;
+  int64_t num_bytes = 0;
+};
+
 using RelationMap = std::unordered_map<std::string, table_store::schema::Relation>;
+using TableSizeEstimateMap = absl::flat_hash_map<std::string, TableSizeEstimate>;
 using SensitiveColumnMap = absl::flat_hash_map<std::string, absl::flat_hash_set<std::string>>;
 class CompilerState : public NotCopyable {
  public:
@@ -135,11 +147,28 @@ class CompilerState : public NotCopyable {
   CompilerState() = delete;
 
   RelationMap* relation_map() const { return relation_map_.get(); }
+  /**
+   * The sizes of the tables, by table name. Tables without an estimate are of unknown size, and
+   * plans that read from them are left as written. Only set for local execution, see
+   * EngineState::CreateLocalExecutionCompilerState.
+   */
+  const TableSizeEstimateMap& table_size_estimates() const { return table_size_estimates_; }
+  void set_table_size_estimates(TableSizeEstimateMap estimates) {
+    table_size_estimates_ = std::move(estimates);
+  }
   SensitiveColumnMap* table_names_to_sensitive_columns() {
     return &table_names_to_sensitive_columns_;
   }
   RegistryInfo* registry_info() const { return registry_info_; }
-  types::Time64NSValue time_now() const { return time_now_; }
+  types::Time64NSValue time_now() const {
+    time_now_used_ = true;
+    return time_now_;
+  }
+  /**
+   * Whether the compiled plan depends on the current time, ie. relative times or px.now() were
+   * resolved against time_now(). Such plans are only valid around the time they were compiled.
+   */
+  bool time_now_used() const { return time_now_used_; }
   const std::string& result_address() const { return result_address_; }
   const std::string& result_ssl_targetname() const { return result_ssl_targetname_; }
 
@@ -176,11 +205,20 @@ class CompilerState : public NotCopyable {
   PluginConfig* plugin_config() { return plugin_config_.get(); }
   const DebugInfo& debug_info() { return debug_info_; }
 
+  /**
+   * The profiler that the rule executors record the time spent on each rule to, nullptr unless
+   * the compilation is being profiled. Unowned.
+   */
+  RuleProfiler* rule_profiler() const { return rule_profiler_; }
+  void set_rule_profiler(RuleProfiler* rule_profiler) { rule_profiler_ = rule_profiler; }
+
  private:
   std::unique_ptr<RelationMap> relation_map_;
+  TableSizeEstimateMap table_size_estimates_;
   SensitiveColumnMap table_names_to_sensitive_columns_;
   RegistryInfo* registry_info_;
   types::Time64NSValue time_now_;
+  mutable bool time_now_used_ = false;
   std::map<IDRegistryKey, int64_t> udf_to_id_map_;
   std::map<IDRegistryKey, int64_t> uda_to_id_map_;
 
@@ -191,6 +229,7 @@ class CompilerState : public NotCopyable {
   std::unique_ptr<planpb::OTelEndpointConfig> endpoint_config_ = nullptr;
   std::unique_ptr<PluginConfig> plugin_config_ = nullptr;
   DebugInfo debug_info_;
+  RuleProfiler* rule_profiler_ = nullptr;
 };
 
 }  // namespace planner
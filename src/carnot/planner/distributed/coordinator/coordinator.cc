@@ -29,6 +29,7 @@
 #include "src/carnot/planner/distributed/coordinator/prune_unavailable_sources_rule.h"
 #include "src/carnot/planner/distributed/coordinator/removable_ops_rule.h"
 #include "src/carnot/planner/distributed/splitter/splitter.h"
+#include "src/carnot/planner/rules/fragment_executor.h"
 #include "src/carnot/planner/rules/rules.h"
 #include "src/carnot/udfspb/udfs.pb.h"
 #include "src/common/uuid/uuid.h"
@@ -140,8 +141,14 @@ StatusOr<AgentToPlanMap> GetUniquePEMPlans(IR* query, DistributedPlan* plan,
   if (!remaining_agents.empty()) {
     clusters.emplace_back(remaining_agents, absl::flat_hash_set<OperatorIR*>{});
   }
-  for (const auto& c : clusters) {
-    PX_ASSIGN_OR_RETURN(auto cluster_plan_uptr, c.CreatePlan(query));
+  // Each cluster prunes its own clone of the query, so the plans are created concurrently.
+  std::vector<std::unique_ptr<IR>> cluster_plans(clusters.size());
+  PX_RETURN_IF_ERROR(ExecutePerFragment(clusters.size(), [&](size_t i) -> Status {
+    PX_ASSIGN_OR_RETURN(cluster_plans[i], clusters[i].CreatePlan(query));
+    return Status::OK();
+  }));
+  for (const auto& [i, c] : Enumerate(clusters)) {
+    auto cluster_plan_uptr = std::move(cluster_plans[i]);
     auto cluster_plan = cluster_plan_uptr.get();
     if (cluster_plan->FindNodesThatMatch(Operator()).empty()) {
       continue;
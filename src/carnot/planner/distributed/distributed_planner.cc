@@ -27,6 +27,7 @@
 #include "src/carnot/planner/distributed/distributed_rules.h"
 #include "src/carnot/planner/distributed/distributed_stitcher_rules.h"
 #include "src/carnot/planner/distributed/grpc_source_conversion.h"
+#include "src/carnot/planner/rules/fragment_executor.h"
 #include "src/carnot/planner/rules/rules.h"
 
 namespace px {
@@ -80,10 +81,12 @@ StatusOr<std::unique_ptr<DistributedPlan>> DistributedPlanner::Plan(
 
   PX_RETURN_IF_ERROR(StitchPlan(distributed_plan.get()));
 
-  AnnotateAbortableSourcesForLimitsRule rule;
-  for (IR* agent_plan : distributed_plan->UniquePlans()) {
-    rule.Execute(agent_plan);
-  }
+  // The agent plans are independent of each other, so they are annotated concurrently.
+  std::vector<IR*> agent_plans = distributed_plan->UniquePlans();
+  PX_RETURN_IF_ERROR(ExecutePerFragment(agent_plans.size(), [&](size_t i) -> Status {
+    AnnotateAbortableSourcesForLimitsRule rule;
+    return rule.Execute(agent_plans[i]).status();
+  }));
 
   return distributed_plan;
 }
@@ -83,6 +83,22 @@ StatusOr<OperatorIR*> AggOperatorMgr::CreateMergeOperator(IR* plan, OperatorIR*
   DCHECK(Match(new_agg, FinalizeAgg()));
   return new_agg;
 }
+
+StatusOr<OperatorIR*> AggOperatorMgr::CreatePrepareOutput(IR* plan, OperatorIR* prepare_op,
+                                                          OperatorIR* op) const {
+  DCHECK(Matches(op));
+  BlockingAggIR* agg = static_cast<BlockingAggIR*>(op);
+  if (agg->groups().empty() || agg->Children().size() != 1 ||
+      !Match(agg->Children()[0], Limit())) {
+    return prepare_op;
+  }
+  LimitIR* limit = static_cast<LimitIR*>(agg->Children()[0]);
+  PX_ASSIGN_OR_RETURN(LimitIR * group_limit,
+                      plan->CreateNode<LimitIR>(limit->ast(), prepare_op, limit->limit_value(),
+                                                /* pem_only */ true));
+  PX_RETURN_IF_ERROR(group_limit->SetResolvedType(prepare_op->resolved_type()));
+  return group_limit;
+}
 }  // namespace distributed
 }  // namespace planner
 }  // namespace carnot
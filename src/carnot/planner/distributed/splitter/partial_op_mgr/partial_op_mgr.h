@@ -66,6 +66,20 @@ class PartialOperatorMgr : public NotCopyable {
    */
   virtual StatusOr<OperatorIR*> CreateMergeOperator(IR* plan, OperatorIR* new_parent,
                                                     OperatorIR* op) const = 0;
+
+  /**
+   * @brief Optionally adds operators after the Prepare Operator that shrink its output before it is
+   * sent over the network. By default nothing is added.
+   *
+   * @param plan
+   * @param prepare_op the operator returned by CreatePrepareOperator.
+   * @param op the original operator.
+   * @return OperatorIR* the operator whose output should be sent to the merge side.
+   */
+  virtual StatusOr<OperatorIR*> CreatePrepareOutput(IR* /* plan */, OperatorIR* prepare_op,
+                                                    OperatorIR* /* op */) const {
+    return prepare_op;
+  }
 };
 
 /**
@@ -108,6 +122,16 @@ class AggOperatorMgr : public PartialOperatorMgr {
   StatusOr<OperatorIR*> CreatePrepareOperator(IR* plan, OperatorIR* op) const override;
   StatusOr<OperatorIR*> CreateMergeOperator(IR* plan, OperatorIR* new_parent,
                                             OperatorIR* op) const override;
+
+  /**
+   * @brief When a grouped aggregate feeds a limit of N, the merged result only needs N groups. The
+   * executor keeps the N groups with the smallest key hashes for an aggregate that feeds a limit.
+   * That choice only depends on the keys, so each partial aggregate can drop every group that isn't
+   * among its own N smallest: none of them can be among the N smallest overall. This adds the limit
+   * after the partial aggregate so each PEM sends at most N groups instead of all of them.
+   */
+  StatusOr<OperatorIR*> CreatePrepareOutput(IR* plan, OperatorIR* prepare_op,
+                                            OperatorIR* op) const override;
 };
 }  // namespace distributed
 }  // namespace planner
@@ -122,10 +122,12 @@ StatusOr<std::unique_ptr<BlockingSplitPlan>> Splitter::SplitKelvinAndAgents(cons
   // Run the pre-split analysis step.
   PX_ASSIGN_OR_RETURN(std::unique_ptr<PreSplitAnalyzer> analyzer,
                       PreSplitAnalyzer::Create(compiler_state_));
+  analyzer->set_rule_profiler(compiler_state_->rule_profiler());
   PX_RETURN_IF_ERROR(analyzer->Execute(logical_plan.get()));
   // Run the pre-split optimization step.
   PX_ASSIGN_OR_RETURN(std::unique_ptr<PreSplitOptimizer> optimizer,
                       PreSplitOptimizer::Create(compiler_state_));
+  optimizer->set_rule_profiler(compiler_state_->rule_profiler());
   PX_RETURN_IF_ERROR(optimizer->Execute(logical_plan.get()));
 
   // Source_ids are necessary because we will make a clone of the plan at which point we will no
@@ -435,10 +437,13 @@ Status Splitter::InsertGRPCBridge(IR* plan, OperatorIR* parent,
     DCHECK(prepare_op->IsChildOf(parent)) << absl::Substitute(
         "'$0' is not a child of '$1'", prepare_op->DebugString(), parent->DebugString());
 
-    // Create the GRPC Bridge from the prepare_op.
-    PX_ASSIGN_OR_RETURN(GRPCSinkIR * grpc_sink, CreateGRPCSink(prepare_op, grpc_id_counter_));
+    PX_ASSIGN_OR_RETURN(OperatorIR * prepare_output,
+                        mgr->CreatePrepareOutput(plan, prepare_op, c));
+
+    // Create the GRPC Bridge from the output of the prepare_op.
+    PX_ASSIGN_OR_RETURN(GRPCSinkIR * grpc_sink, CreateGRPCSink(prepare_output, grpc_id_counter_));
     PX_ASSIGN_OR_RETURN(GRPCSourceGroupIR * grpc_source_group,
-                        CreateGRPCSourceGroup(prepare_op, grpc_id_counter_));
+                        CreateGRPCSourceGroup(prepare_output, grpc_id_counter_));
     DCHECK_EQ(grpc_sink->destination_id(), grpc_source_group->source_id());
 
     // Create the finalize version of the operator, getting input from the grpc_source_group.
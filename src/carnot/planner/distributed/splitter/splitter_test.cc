@@ -193,6 +193,59 @@ TEST_F(SplitterTest, partial_agg_test) {
   }
 }
 
+TEST_F(SplitterTest, partial_agg_with_limit_test) {
+  auto mem_src = MakeMemSource("cpu", cpu_relation);
+  auto count_col = MakeColumn("count", 0, types::DataType::INT64);
+  EXPECT_OK(count_col->SetResolvedType(ValueType::Create(types::INT64, types::ST_NONE)));
+  auto mean_func = MakeMeanFuncWithFloatType(MakeColumn("count", 0, types::DataType::INT64));
+  ASSERT_OK(AddUDAToRegistry("mean", types::FLOAT64, {types::INT64}, /*supports_partial*/ true));
+  auto agg = MakeBlockingAgg(mem_src, {count_col}, {{"mean", mean_func}});
+  auto limit = MakeLimit(agg, 10);
+  auto sink = MakeMemSink(limit, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  auto splitter_or_s = Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ true);
+  ASSERT_OK(splitter_or_s);
+  std::unique_ptr<Splitter> splitter = splitter_or_s.ConsumeValueOrDie();
+  std::unique_ptr<BlockingSplitPlan> split_plan =
+      splitter->SplitKelvinAndAgents(graph.get()).ConsumeValueOrDie();
+
+  auto before_blocking = split_plan->before_blocking.get();
+  auto after_blocking = split_plan->after_blocking.get();
+
+  // The PEMs only send the groups that can make the limit.
+  MemorySourceIR* new_mem_src = GetEquivalentInNewPlan(before_blocking, mem_src);
+  ASSERT_EQ(new_mem_src->Children().size(), 1UL);
+  ASSERT_MATCH(new_mem_src->Children()[0], PartialAgg());
+  auto partial_agg = static_cast<BlockingAggIR*>(new_mem_src->Children()[0]);
+  ASSERT_EQ(partial_agg->Children().size(), 1UL);
+  ASSERT_MATCH(partial_agg->Children()[0], Limit());
+  auto pem_limit = static_cast<LimitIR*>(partial_agg->Children()[0]);
+  EXPECT_EQ(pem_limit->limit_value(), 10);
+  EXPECT_TRUE(pem_limit->pem_only());
+  EXPECT_THAT(*pem_limit->resolved_table_type(),
+              IsTableType(Relation({types::INT64, types::STRING}, {"count", "serialized_mean"})));
+  ASSERT_EQ(pem_limit->Children().size(), 1UL);
+  ASSERT_MATCH(pem_limit->Children()[0], GRPCSink());
+  GRPCSinkIR* grpc_sink = static_cast<GRPCSinkIR*>(pem_limit->Children()[0]);
+
+  // The Kelvin finalizes the candidate groups and still applies the original limit.
+  auto grpc_source_groups = after_blocking->FindNodesThatMatch(GRPCSourceGroup());
+  ASSERT_EQ(grpc_source_groups.size(), 1);
+  GRPCSourceGroupIR* grpc_source = static_cast<GRPCSourceGroupIR*>(grpc_source_groups[0]);
+  EXPECT_EQ(grpc_sink->destination_id(), grpc_source->source_id());
+  ASSERT_EQ(grpc_source->Children().size(), 1);
+  ASSERT_MATCH(grpc_source->Children()[0], FinalizeAgg());
+  auto finalize_agg = static_cast<BlockingAggIR*>(grpc_source->Children()[0]);
+  ASSERT_EQ(finalize_agg->Children().size(), 1);
+  ASSERT_MATCH(finalize_agg->Children()[0], Limit());
+  auto kelvin_limit = static_cast<LimitIR*>(finalize_agg->Children()[0]);
+  EXPECT_EQ(kelvin_limit->limit_value(), 10);
+  EXPECT_EQ(GetEquivalentInNewPlan(after_blocking, sink)->parents()[0], kelvin_limit);
+}
+
 TEST_F(SplitterTest, limit_test) {
   auto mem_src = MakeMemSource("cpu", cpu_relation);
   auto limit = MakeLimit(mem_src, 10);
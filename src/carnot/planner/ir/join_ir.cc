@@ -17,6 +17,7 @@
  */
 #include <map>
 #include <memory>
+#include <utility>
 
 #include "src/carnot/planner/ir/column_ir.h"
 #include "src/carnot/planner/ir/ir.h"
@@ -52,6 +53,7 @@ Status JoinIR::CopyFromNodeImpl(const IRNode* node,
 
   PX_RETURN_IF_ERROR(SetJoinColumns(new_left_columns, new_right_columns));
   suffix_strs_ = join_node->suffix_strs_;
+  specified_as_right_ = join_node->specified_as_right_;
   return Status::OK();
 }
 
@@ -157,6 +159,34 @@ Status JoinIR::SetJoinColumns(const std::vector<ColumnIR*>& left_columns,
   return Status::OK();
 }
 
+Status JoinIR::SwapParents() {
+  DCHECK_EQ(parents().size(), 2UL) << "There should be exactly two parents.";
+  DCHECK(join_type_ == JoinType::kInner || join_type_ == JoinType::kOuter);
+
+  std::vector<OperatorIR*> old_parents = parents();
+  for (OperatorIR* parent : old_parents) {
+    PX_RETURN_IF_ERROR(RemoveParent(parent));
+  }
+  PX_RETURN_IF_ERROR(AddParent(old_parents[1]));
+  PX_RETURN_IF_ERROR(AddParent(old_parents[0]));
+
+  for (const auto* columns : {&left_on_columns_, &right_on_columns_, &output_columns_}) {
+    for (ColumnIR* col : *columns) {
+      DCHECK_LT(col->container_op_parent_idx(), 2);
+      col->SetContainingOperatorParentIdx(1 - col->container_op_parent_idx());
+    }
+  }
+  // The equality conditions index the left columns into parent 0 and the right into parent 1.
+  std::swap(left_on_columns_, right_on_columns_);
+  // The suffixes are indexed by parent, and the output columns keep their order by tracking which
+  // parent the user specified as the left one.
+  if (suffix_strs_.size() == 2) {
+    std::swap(suffix_strs_[0], suffix_strs_[1]);
+  }
+  specified_as_right_ = !specified_as_right_;
+  return Status::OK();
+}
+
 StatusOr<std::vector<absl::flat_hash_set<std::string>>> JoinIR::RequiredInputColumns() const {
   DCHECK(key_columns_set_);
   DCHECK(!output_columns_.empty());
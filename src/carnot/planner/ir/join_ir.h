@@ -90,6 +90,13 @@ class JoinIR : public OperatorIR {
                           const std::vector<ColumnIR*>& columns);
   bool specified_as_right() const { return specified_as_right_; }
 
+  /**
+   * @brief Swaps the left and right parents of the join, along with the columns and suffixes that
+   * refer to them. The output columns keep their order and names, so the swap only changes which
+   * side the join executes as the build side. Only inner and outer joins are symmetric.
+   */
+  Status SwapParents();
+
   StatusOr<std::vector<absl::flat_hash_set<std::string>>> RequiredInputColumns() const override;
 
   const std::tuple<std::shared_ptr<TableType>, std::shared_ptr<TableType>> left_right_table_types()
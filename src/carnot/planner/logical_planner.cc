@@ -18,6 +18,9 @@
 
 #include "src/carnot/planner/logical_planner.h"
 
+#include <algorithm>
+#include <memory>
+#include <string>
 #include <utility>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
@@ -26,6 +29,13 @@
 #include "src/carnot/planner/parser/parser.h"
 #include "src/shared/scriptspb/scripts.pb.h"
 
+DEFINE_int64(planner_plan_cache_size, gflags::Int64FromEnv("PL_PLANNER_PLAN_CACHE_SIZE", 256),
+             "The number of distributed plans the planner caches. 0 disables the plan cache.");
+DEFINE_int64(planner_plan_cache_time_tolerance_ms,
+             gflags::Int64FromEnv("PL_PLANNER_PLAN_CACHE_TIME_TOLERANCE_MS", 1000),
+             "How long a cached plan that depends on the time it was compiled at, eg. through a "
+             "relative start time, is reused for.");
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -120,29 +130,67 @@ Status LogicalPlanner::Init(const udfspb::UDFInfo& udf_info) {
   PX_RETURN_IF_ERROR(registry_info_->Init(udf_info));
 
   PX_ASSIGN_OR_RETURN(distributed_planner_, distributed::DistributedPlanner::Create());
+  // Plans compiled against a previous registry are no longer valid.
+  plan_cache_ = std::make_unique<PlanCache>(
+      static_cast<size_t>(std::max<int64_t>(FLAGS_planner_plan_cache_size, 0)),
+      FLAGS_planner_plan_cache_time_tolerance_ms * 1000 * 1000);
   return Status::OK();
 }
 
 StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
     const plannerpb::QueryRequest& query_request) {
-  // Compile into the IR.
-
   auto ms = query_request.logical_planner_state().plan_options().max_output_rows_per_table();
   VLOG(1) << "Max output rows: " << ms;
   PX_ASSIGN_OR_RETURN(
       std::unique_ptr<CompilerState> compiler_state,
       CreateCompilerState(query_request.logical_planner_state(), registry_info_.get(), ms));
+  return Plan(query_request, compiler_state.get());
+}
 
+StatusOr<std::shared_ptr<const distributedpb::DistributedPlan>> LogicalPlanner::PlanProto(
+    const plannerpb::QueryRequest& query_request) {
+  std::string key;
+  if (plan_cache_->enabled()) {
+    key = PlanCache::Key(query_request);
+    auto cached_plan = plan_cache_->Get(key, px::CurrentTimeNS());
+    if (cached_plan != nullptr) {
+      return cached_plan;
+    }
+  }
+
+  auto ms = query_request.logical_planner_state().plan_options().max_output_rows_per_table();
+  PX_ASSIGN_OR_RETURN(
+      std::unique_ptr<CompilerState> compiler_state,
+      CreateCompilerState(query_request.logical_planner_state(), registry_info_.get(), ms));
+  PX_ASSIGN_OR_RETURN(auto distributed_plan, Plan(query_request, compiler_state.get()));
+  // In the future, if we actually have plan options that will actually determine how the plan is
+  // constructed, we may want to pass the planOptions to planner.Plan. However, this
+  // will need to go through many more layers (such as the coordinator), so this is fine for now.
+  distributed_plan->SetPlanOptions(query_request.logical_planner_state().plan_options());
+  PX_ASSIGN_OR_RETURN(auto plan_pb, distributed_plan->ToProto());
+
+  auto plan = std::make_shared<const distributedpb::DistributedPlan>(std::move(plan_pb));
+  if (plan_cache_->enabled()) {
+    bool time_dependent = compiler_state->time_now_used();
+    plan_cache_->Put(key, plan, compiler_state->time_now().val, time_dependent);
+  }
+  return plan;
+}
+
+StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
+    const plannerpb::QueryRequest& query_request, CompilerState* compiler_state) {
+  compiler_state->set_rule_profiler(rule_profiler_);
+  // Compile into the IR.
   std::vector<plannerpb::FuncToExecute> exec_funcs(query_request.exec_funcs().begin(),
                                                    query_request.exec_funcs().end());
   PX_ASSIGN_OR_RETURN(
       std::shared_ptr<IR> single_node_plan,
-      compiler_.CompileToIR(query_request.query_str(), compiler_state.get(), exec_funcs));
+      compiler_.CompileToIR(query_request.query_str(), compiler_state, exec_funcs));
   // Create the distributed plan.
   PX_ASSIGN_OR_RETURN(
       auto distributed_plan,
       distributed_planner_->Plan(query_request.logical_planner_state().distributed_state(),
-                                 compiler_state.get(), single_node_plan.get()));
+                                 compiler_state, single_node_plan.get()));
   distributed_plan->SetExecutionCompleteAddress(
       query_request.logical_planner_state().result_address(),
       query_request.logical_planner_state().result_ssl_targetname());
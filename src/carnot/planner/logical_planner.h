@@ -25,8 +25,10 @@
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
 #include "src/carnot/planner/distributed/distributed_planner.h"
+#include "src/carnot/planner/plan_cache.h"
 #include "src/carnot/planner/plannerpb/service.pb.h"
 #include "src/carnot/planner/probes/probes.h"
+#include "src/carnot/planner/rules/rule_profiler.h"
 #include "src/shared/scriptspb/scripts.pb.h"
 
 namespace px {
@@ -57,6 +59,17 @@ class LogicalPlanner : public NotCopyable {
   StatusOr<std::unique_ptr<distributed::DistributedPlan>> Plan(
       const plannerpb::QueryRequest& query);
 
+  /**
+   * @brief Plans the query like Plan, and returns the distributed plan proto with the plan options
+   * of the request set. Plans are cached, so a query that repeats a recent one with the same
+   * cluster state returns the cached plan without compiling it again.
+   *
+   * @param query: QueryRequest
+   * @return the distributed plan proto or error if one occurs during compilation.
+   */
+  StatusOr<std::shared_ptr<const distributedpb::DistributedPlan>> PlanProto(
+      const plannerpb::QueryRequest& query);
+
   StatusOr<std::unique_ptr<compiler::MutationsIR>> CompileTrace(
       const plannerpb::CompileMutationsRequest& mutations_req);
 
@@ -66,13 +79,26 @@ class LogicalPlanner : public NotCopyable {
   Status Init(std::unique_ptr<planner::RegistryInfo> registry_info);
   Status Init(const udfspb::UDFInfo& udf_info);
 
+  PlanCache* plan_cache() { return plan_cache_.get(); }
+
+  /**
+   * @brief Records the time spent on each planner rule of the queries planned from now on to the
+   * profiler. Unowned, nullptr turns profiling off.
+   */
+  void set_rule_profiler(RuleProfiler* rule_profiler) { rule_profiler_ = rule_profiler; }
+
  protected:
   LogicalPlanner() {}
 
  private:
+  StatusOr<std::unique_ptr<distributed::DistributedPlan>> Plan(
+      const plannerpb::QueryRequest& query, CompilerState* compiler_state);
+
   compiler::Compiler compiler_;
   std::unique_ptr<distributed::Planner> distributed_planner_;
   std::unique_ptr<planner::RegistryInfo> registry_info_;
+  std::unique_ptr<PlanCache> plan_cache_;
+  RuleProfiler* rule_profiler_ = nullptr;
 };
 
 StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
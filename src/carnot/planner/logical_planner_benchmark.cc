@@ -24,6 +24,8 @@
 #include "src/common/perf/perf.h"
 #include "src/common/testing/testing.h"
 
+DECLARE_int64(planner_plan_cache_time_tolerance_ms);
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -45,6 +47,64 @@ void BM_Query(benchmark::State& state) {
 
 BENCHMARK(BM_Query);
 
+plannerpb::QueryRequest HttpRequestStatsQuery() {
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(testutils::kHttpRequestStats);
+  *query_request.mutable_logical_planner_state() =
+      testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  return query_request;
+}
+
+// Compiles the query every time, as for the first run of a script.
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryPlanProtoCold(benchmark::State& state) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  auto query_request = HttpRequestStatsQuery();
+  for (auto _ : state) {
+    planner->plan_cache()->Clear();
+    auto plan_or_s = planner->PlanProto(query_request);
+    EXPECT_OK(plan_or_s);
+  }
+}
+
+// Reruns the same script against the same cluster state, as dashboards do.
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryPlanProtoWarm(benchmark::State& state) {
+  // The script uses a relative start time, keep its plan for the whole benchmark.
+  FLAGS_planner_plan_cache_time_tolerance_ms = 3600 * 1000;
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  auto query_request = HttpRequestStatsQuery();
+  EXPECT_OK(planner->PlanProto(query_request));
+  for (auto _ : state) {
+    auto plan_or_s = planner->PlanProto(query_request);
+    EXPECT_OK(plan_or_s);
+  }
+}
+
+// Plans the query like BM_Query, and reports the time spent on each planner rule as counters.
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryRuleProfile(benchmark::State& state) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  RuleProfiler profiler;
+  planner->set_rule_profiler(&profiler);
+  auto query_request = HttpRequestStatsQuery();
+  for (auto _ : state) {
+    auto plan_or_s = planner->Plan(query_request);
+    EXPECT_OK(plan_or_s);
+  }
+  for (const auto& profile : profiler.Profiles()) {
+    state.counters[absl::StrCat(profile.batch, "/", profile.rule, "_us")] = benchmark::Counter(
+        profile.time_ns / 1000.0, benchmark::Counter::kAvgIterations);
+  }
+}
+
+BENCHMARK(BM_QueryRuleProfile);
+BENCHMARK(BM_QueryPlanProtoCold);
+BENCHMARK(BM_QueryPlanProtoWarm);
+
 }  // namespace logical_planner
 }  // namespace planner
 }  // namespace carnot
@@ -132,6 +132,31 @@ TEST_F(LogicalPlannerTest, max_output_rows) {
   EXPECT_OK(plan->ToProto());
 }
 
+TEST_F(LogicalPlannerTest, plan_proto_is_cached) {
+  auto planner = LogicalPlanner::Create(info_).ConsumeValueOrDie();
+  auto state = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  auto query_request =
+      MakeQueryRequest(state, "import px\npx.display(px.DataFrame('http_events'), 'out')");
+
+  ASSERT_OK_AND_ASSIGN(auto plan_pb, planner->PlanProto(query_request));
+  ASSERT_OK_AND_ASSIGN(auto cached_plan_pb, planner->PlanProto(query_request));
+  EXPECT_EQ(plan_pb, cached_plan_pb);
+  EXPECT_EQ(1, planner->plan_cache()->hits());
+
+  // The cached plan is the same as a freshly compiled one.
+  ASSERT_OK_AND_ASSIGN(auto plan, planner->Plan(query_request));
+  plan->SetPlanOptions(state.plan_options());
+  ASSERT_OK_AND_ASSIGN(auto expected_pb, plan->ToProto());
+  EXPECT_THAT(*cached_plan_pb, EqualsProto(expected_pb.DebugString()));
+
+  // A different cluster state is planned again.
+  state.mutable_plan_options()->set_max_output_rows_per_table(100);
+  ASSERT_OK_AND_ASSIGN(auto other_plan_pb, planner->PlanProto(MakeQueryRequest(
+                                               state, query_request.query_str())));
+  EXPECT_NE(plan_pb, other_plan_pb);
+  EXPECT_EQ(2, planner->plan_cache()->misses());
+}
+
 constexpr char kCompileTimeQuery[] = R"pxl(
 import px
 
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/plan_cache.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include <limits>
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/str_replace.h>
+
+// NOLINTNEXTLINE: build/include_subdir
+#include "xxhash.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+std::string PlanCache::Key(const plannerpb::QueryRequest& query_request) {
+  plannerpb::QueryRequest normalized = query_request;
+  std::string query_str = absl::StrReplaceAll(query_request.query_str(), {{"\r\n", "\n"}});
+  absl::StripTrailingAsciiWhitespace(&query_str);
+  normalized.set_query_str(query_str);
+
+  // Map fields don't have a stable encoding unless serialization is deterministic.
+  std::string key;
+  {
+    google::protobuf::io::StringOutputStream string_stream(&key);
+    google::protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    normalized.SerializeToCodedStream(&coded_stream);
+  }
+  return key;
+}
+
+uint64_t PlanCache::Fingerprint(const std::string& key) {
+  return XXH64(key.data(), key.size(), /*seed*/ 0);
+}
+
+std::shared_ptr<const distributedpb::DistributedPlan> PlanCache::Get(const std::string& key,
+                                                                     int64_t now_ns) {
+  uint64_t fingerprint = Fingerprint(key);
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(fingerprint);
+  // A different key with the same fingerprint is a miss.
+  if (it == index_.end() || it->second->key != key) {
+    ++misses_;
+    return nullptr;
+  }
+  if (now_ns > it->second->expiry_ns) {
+    entries_.erase(it->second);
+    index_.erase(it);
+    ++misses_;
+    return nullptr;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  ++hits_;
+  return it->second->plan;
+}
+
+void PlanCache::Put(const std::string& key,
+                    std::shared_ptr<const distributedpb::DistributedPlan> plan,
+                    int64_t compile_time_ns, bool time_dependent) {
+  if (!enabled()) {
+    return;
+  }
+  int64_t expiry_ns = time_dependent ? compile_time_ns + time_tolerance_ns_
+                                     : std::numeric_limits<int64_t>::max();
+  uint64_t fingerprint = Fingerprint(key);
+  absl::MutexLock lock(&mu_);
+  // Replaces the plan of the same key, or of a different key with the same fingerprint.
+  auto it = index_.find(fingerprint);
+  if (it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  entries_.push_front(Entry{fingerprint, key, std::move(plan), expiry_ns});
+  index_[fingerprint] = entries_.begin();
+  if (entries_.size() > capacity_) {
+    index_.erase(entries_.back().fingerprint);
+    entries_.pop_back();
+  }
+}
+
+void PlanCache::Clear() {
+  absl::MutexLock lock(&mu_);
+  entries_.clear();
+  index_.clear();
+}
+
+size_t PlanCache::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+int64_t PlanCache::hits() const {
+  absl::MutexLock lock(&mu_);
+  return hits_;
+}
+
+int64_t PlanCache::misses() const {
+  absl::MutexLock lock(&mu_);
+  return misses_;
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/carnot/planner/distributedpb/distributed_plan.pb.h"
+#include "src/carnot/planner/plannerpb/service.pb.h"
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief PlanCache holds the distributed plans of recently planned queries, so that running the
+ * same script against the same cluster state again skips compilation.
+ *
+ * Plans are keyed on everything the planner reads from the query request: the script, its exec
+ * funcs and arguments, and the logical planner state, which includes the schemas and the layout of
+ * the agents. The registry is fixed for the lifetime of a planner, so it's not part of the key.
+ * Since the key includes the whole cluster state it can be large, so plans are indexed on a 64-bit
+ * fingerprint of the key, and each entry keeps one copy of the key to rule out collisions.
+ *
+ * Scripts that read the current time (relative start times, px.now()) compile to plans with
+ * absolute timestamps. Those plans are only reused for `time_tolerance_ns` after they were
+ * compiled, every other plan is kept until it is evicted by newer plans.
+ *
+ * The cache is thread-safe.
+ */
+class PlanCache : public NotCopyable {
+ public:
+  /**
+   * @param capacity the maximum number of plans to keep, the least recently used plan is evicted
+   * first. A capacity of 0 disables the cache.
+   * @param time_tolerance_ns how long a plan that depends on the time it was compiled at is valid.
+   */
+  PlanCache(size_t capacity, int64_t time_tolerance_ns)
+      : capacity_(capacity), time_tolerance_ns_(time_tolerance_ns) {}
+
+  /**
+   * @brief Returns the cache key of a query request. Line endings and trailing whitespace of the
+   * script are normalized, so that they don't cause misses.
+   */
+  static std::string Key(const plannerpb::QueryRequest& query_request);
+
+  /**
+   * @brief Returns the plan cached for the key, or nullptr if there is none or it's expired.
+   *
+   * @param key the cache key of the query.
+   * @param now_ns the current time.
+   */
+  std::shared_ptr<const distributedpb::DistributedPlan> Get(const std::string& key, int64_t now_ns);
+
+  /**
+   * @brief Caches a plan.
+   *
+   * @param key the cache key of the query.
+   * @param plan the plan to cache.
+   * @param compile_time_ns the time the plan was compiled at.
+   * @param time_dependent whether the plan depends on the time it was compiled at.
+   */
+  void Put(const std::string& key, std::shared_ptr<const distributedpb::DistributedPlan> plan,
+           int64_t compile_time_ns, bool time_dependent);
+
+  void Clear();
+
+  bool enabled() const { return capacity_ > 0; }
+  size_t size() const;
+  int64_t hits() const;
+  int64_t misses() const;
+
+ private:
+  static uint64_t Fingerprint(const std::string& key);
+
+  struct Entry {
+    uint64_t fingerprint;
+    std::string key;
+    std::shared_ptr<const distributedpb::DistributedPlan> plan;
+    int64_t expiry_ns;
+  };
+  using EntryList = std::list<Entry>;
+
+  const size_t capacity_;
+  const int64_t time_tolerance_ns_;
+
+  mutable absl::Mutex mu_;
+  // The entries, most recently used first.
+  EntryList entries_ ABSL_GUARDED_BY(mu_);
+  // The entries by the fingerprint of their key.
+  absl::flat_hash_map<uint64_t, EntryList::iterator> index_ ABSL_GUARDED_BY(mu_);
+  int64_t hits_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t misses_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
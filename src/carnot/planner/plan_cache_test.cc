@@ -0,0 +1,105 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "src/carnot/planner/plan_cache.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+constexpr int64_t kTolerance = 1000;
+
+plannerpb::QueryRequest MakeQueryRequest(const std::string& query, int64_t max_output_rows) {
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(query);
+  auto* plan_options = query_request.mutable_logical_planner_state()->mutable_plan_options();
+  plan_options->set_max_output_rows_per_table(max_output_rows);
+  return query_request;
+}
+
+std::shared_ptr<const distributedpb::DistributedPlan> MakePlan() {
+  return std::make_shared<const distributedpb::DistributedPlan>();
+}
+
+TEST(PlanCacheTest, key_normalizes_script) {
+  auto key = PlanCache::Key(MakeQueryRequest("import px\npx.display(df)\n", 10));
+  EXPECT_EQ(key, PlanCache::Key(MakeQueryRequest("import px\r\npx.display(df)  \n\n", 10)));
+  // Indentation is part of the script.
+  EXPECT_NE(key, PlanCache::Key(MakeQueryRequest("import px\n px.display(df)\n", 10)));
+  // So is the rest of the request.
+  EXPECT_NE(key, PlanCache::Key(MakeQueryRequest("import px\npx.display(df)\n", 20)));
+}
+
+TEST(PlanCacheTest, hit_and_miss) {
+  PlanCache cache(/* capacity */ 4, kTolerance);
+  EXPECT_EQ(nullptr, cache.Get("a", 0));
+
+  auto plan = MakePlan();
+  cache.Put("a", plan, /* compile_time_ns */ 0, /* time_dependent */ false);
+  EXPECT_EQ(plan, cache.Get("a", 0));
+  // Plans that don't depend on the time never expire.
+  EXPECT_EQ(plan, cache.Get("a", 100 * kTolerance));
+  EXPECT_EQ(nullptr, cache.Get("b", 0));
+  EXPECT_EQ(2, cache.hits());
+  EXPECT_EQ(2, cache.misses());
+}
+
+TEST(PlanCacheTest, time_dependent_plans_expire) {
+  PlanCache cache(/* capacity */ 4, kTolerance);
+  auto plan = MakePlan();
+  cache.Put("a", plan, /* compile_time_ns */ 100, /* time_dependent */ true);
+  EXPECT_EQ(plan, cache.Get("a", 100 + kTolerance));
+  EXPECT_EQ(nullptr, cache.Get("a", 101 + kTolerance));
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST(PlanCacheTest, evicts_least_recently_used) {
+  PlanCache cache(/* capacity */ 2, kTolerance);
+  auto plan_a = MakePlan();
+  auto plan_b = MakePlan();
+  auto plan_c = MakePlan();
+  cache.Put("a", plan_a, 0, false);
+  cache.Put("b", plan_b, 0, false);
+  // Using a makes b the least recently used plan.
+  EXPECT_EQ(plan_a, cache.Get("a", 0));
+  cache.Put("c", plan_c, 0, false);
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(nullptr, cache.Get("b", 0));
+  EXPECT_EQ(plan_a, cache.Get("a", 0));
+  EXPECT_EQ(plan_c, cache.Get("c", 0));
+
+  cache.Clear();
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST(PlanCacheTest, zero_capacity_disables_cache) {
+  PlanCache cache(/* capacity */ 0, kTolerance);
+  EXPECT_FALSE(cache.enabled());
+  cache.Put("a", MakePlan(), 0, false);
+  EXPECT_EQ(nullptr, cache.Get("a", 0));
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "src/carnot/planner/rules/fragment_executor.h"
+
+DEFINE_int32(planner_fragment_threads, gflags::Int32FromEnv("PL_PLANNER_FRAGMENT_THREADS", 4),
+             "The number of threads the planner processes independent plan fragments with. 1 "
+             "processes them sequentially.");
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+Status ExecutePerFragment(size_t num_fragments, const std::function<Status(size_t)>& fn) {
+  size_t num_threads =
+      std::min(num_fragments, static_cast<size_t>(std::max(FLAGS_planner_fragment_threads, 1)));
+  if (num_threads <= 1) {
+    for (size_t i = 0; i < num_fragments; ++i) {
+      PX_RETURN_IF_ERROR(fn(i));
+    }
+    return Status::OK();
+  }
+
+  std::vector<Status> statuses(num_fragments);
+  std::atomic<size_t> next_fragment{0};
+  auto worker = [&]() {
+    for (size_t i = next_fragment++; i < num_fragments; i = next_fragment++) {
+      statuses[i] = fn(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (size_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& s : statuses) {
+    PX_RETURN_IF_ERROR(s);
+  }
+  return Status::OK();
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <functional>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * @brief Runs fn(i) for every fragment i in [0, num_fragments). Fragments are independent plans,
+ * such as the plans of the different agent clusters of a distributed plan, so they are processed
+ * concurrently on up to --planner_fragment_threads threads, including the calling one.
+ *
+ * fn must only touch the state of its own fragment.
+ *
+ * @return the error of the first fragment that failed, if any.
+ */
+Status ExecutePerFragment(size_t num_fragments, const std::function<Status(size_t)>& fn);
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
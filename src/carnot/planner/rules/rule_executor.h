@@ -17,14 +17,19 @@
  */
 
 #pragma once
+#include <chrono>
 #include <memory>
 #include <string>
+#include <typeinfo>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
+
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/ir/ir.h"
+#include "src/carnot/planner/rules/rule_profiler.h"
 #include "src/carnot/planner/rules/rules.h"
 
 namespace px {
@@ -123,32 +128,10 @@ class RuleExecutor {
 
  public:
   virtual ~RuleExecutor() = default;
-  // TODO(philkuz) figure out how to collect stats on the execution.
+
   Status Execute(TPlan* ir_graph) {
     for (const auto& rb : rule_batches) {
-      bool can_continue = true;
-      int64_t iteration = 0;
-      // We continue executing a batch until a stop condition is met.
-      while (can_continue) {
-        iteration += 1;
-        bool graph_is_updated = false;
-        for (const auto& rule : rb->rules()) {
-          PX_ASSIGN_OR_RETURN(bool rule_updates_graph, rule->Execute(ir_graph));
-          graph_is_updated = graph_is_updated || rule_updates_graph;
-        }
-        if (iteration >= rb->max_iterations() && graph_is_updated) {
-          PX_RETURN_IF_ERROR(rb->MaxIterationsHandler());
-          // TODO(philkuz) Reviewer: should this be a failure somehow?
-          can_continue = false;
-        }
-        // TODO(philkuz) in the future we might have a fast way to check whether the graph has
-        // changed. For now let's be lazy and leave it up to the user to make sure rules properly
-        // update.
-        // (graph_is_updated == false) => the graph has reached a fixed point and is done
-        if (!graph_is_updated) {
-          can_continue = false;
-        }
-      }
+      PX_RETURN_IF_ERROR(ExecuteBatch(rb.get(), ir_graph));
     }
     return Status::OK();
   }
@@ -160,8 +143,111 @@ class RuleExecutor {
     return out_ptr;
   }
 
+  /**
+   * @brief Sets the profiler that the time spent on each rule is recorded to. Unowned, may be
+   * nullptr to turn profiling off.
+   */
+  void set_rule_profiler(RuleProfiler* rule_profiler) { rule_profiler_ = rule_profiler; }
+
  private:
+  // What changed in the graph since a rule of the batch last ran.
+  struct RuleState {
+    // The number of changes to the graph in the batch before the rule last ran, -1 if it hasn't.
+    int64_t changes_at_last_run = -1;
+    // Only used by the rules that SupportsIncrementalExecution(). The nodes that other rules
+    // changed, and the nodes the rule has seen, which tells which nodes were added since.
+    bool needs_full_run = true;
+    absl::flat_hash_set<int64_t> dirty_nodes;
+    absl::flat_hash_set<int64_t> seen_nodes;
+  };
+
+  Status ExecuteBatch(TRuleBatch* rb, TPlan* ir_graph) {
+    std::vector<RuleState> states(rb->rules().size());
+    // The number of rule executions in this batch that changed the graph.
+    int64_t num_changes = 0;
+    bool can_continue = true;
+    int64_t iteration = 0;
+    // We continue executing a batch until a stop condition is met.
+    while (can_continue) {
+      iteration += 1;
+      bool graph_is_updated = false;
+      for (size_t i = 0; i < rb->rules().size(); ++i) {
+        TRule* rule = rb->rules()[i].get();
+        RuleState* state = &states[i];
+        // The rule didn't change the graph when it last ran and nothing changed it since, so it
+        // won't change the graph this time either.
+        if (state->changes_at_last_run == num_changes) {
+          RecordProfile(rb, rule, /*skipped*/ true, /*changed*/ false, 0);
+          continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        PX_ASSIGN_OR_RETURN(bool rule_updates_graph, ExecuteRule(rule, state, ir_graph));
+        RecordProfile(rb, rule, /*skipped*/ false, rule_updates_graph,
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count());
+        state->changes_at_last_run = num_changes;
+        if (!rule_updates_graph) {
+          continue;
+        }
+        graph_is_updated = true;
+        ++num_changes;
+        // Tell the incremental rules what changed, or to revisit the whole graph if the rule
+        // can't tell which nodes it changed.
+        for (size_t j = 0; j < states.size(); ++j) {
+          if (!rb->rules()[j]->SupportsIncrementalExecution()) {
+            continue;
+          }
+          if (rule->changed_nodes().empty()) {
+            states[j].needs_full_run = true;
+          }
+          states[j].dirty_nodes.insert(rule->changed_nodes().begin(), rule->changed_nodes().end());
+        }
+      }
+      if (iteration >= rb->max_iterations() && graph_is_updated) {
+        PX_RETURN_IF_ERROR(rb->MaxIterationsHandler());
+        // TODO(philkuz) Reviewer: should this be a failure somehow?
+        can_continue = false;
+      }
+      // (graph_is_updated == false) => the graph has reached a fixed point and is done
+      if (!graph_is_updated) {
+        can_continue = false;
+      }
+    }
+    return Status::OK();
+  }
+
+  StatusOr<bool> ExecuteRule(TRule* rule, RuleState* state, TPlan* ir_graph) {
+    if (!rule->SupportsIncrementalExecution()) {
+      return rule->Execute(ir_graph);
+    }
+    bool full_run = state->needs_full_run;
+    state->needs_full_run = false;
+    if (full_run) {
+      state->dirty_nodes.clear();
+      state->seen_nodes = ir_graph->dag().nodes();
+      return rule->Execute(ir_graph);
+    }
+    // Nodes added since the rule last ran are dirty too.
+    for (int64_t node : ir_graph->dag().nodes()) {
+      if (state->seen_nodes.insert(node).second) {
+        state->dirty_nodes.insert(node);
+      }
+    }
+    absl::flat_hash_set<int64_t> dirty_nodes;
+    dirty_nodes.swap(state->dirty_nodes);
+    return rule->ExecuteIncremental(ir_graph, dirty_nodes);
+  }
+
+  void RecordProfile(TRuleBatch* rb, TRule* rule, bool skipped, bool changed, int64_t time_ns) {
+    if (rule_profiler_ == nullptr) {
+      return;
+    }
+    rule_profiler_->Record(rb->name(), RuleName(typeid(*rule)), skipped, changed, time_ns);
+  }
+
   std::vector<std::unique_ptr<TRuleBatch>> rule_batches;
+  RuleProfiler* rule_profiler_ = nullptr;
 };
 
 }  // namespace planner
@@ -19,6 +19,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -26,6 +27,7 @@
 #include <pypa/parser/parser.hh>
 
 #include "src/carnot/planner/compiler/test_utils.h"
+#include "src/carnot/planner/rules/fragment_executor.h"
 #include "src/carnot/planner/rules/rule_executor.h"
 #include "src/carnot/planner/rules/rule_mock.h"
 #include "src/carnot/udf_exporter/udf_exporter.h"
@@ -35,6 +37,7 @@ namespace carnot {
 namespace planner {
 
 using ::testing::_;
+using ::testing::UnorderedElementsAre;
 
 class RuleExecutorTest : public OperatorTests {
  protected:
@@ -162,8 +165,9 @@ TEST_F(RuleExecutorTest, rules_in_batch_correspond) {
       .WillOnce(Return(true))
       .WillOnce(Return(false));
 
+  // rule1_2 is skipped in the last iteration, as the graph didn't change since it last ran.
   MockRule* rule1_2 = rule_batch1->AddRule<MockRule>(compiler_state_.get());
-  EXPECT_CALL(*rule1_2, Execute(_)).Times(3).WillOnce(Return(true)).WillRepeatedly(Return(false));
+  EXPECT_CALL(*rule1_2, Execute(_)).Times(2).WillOnce(Return(true)).WillRepeatedly(Return(false));
 
   EXPECT_OK(executor->Execute(graph.get()));
 }
@@ -182,6 +186,125 @@ TEST_F(RuleExecutorTest, exit_early) {
   EXPECT_NOT_OK(executor->Execute(graph.get()));
 }
 
+// Records the nodes it visits without changing them.
+class VisitRecordingRule : public Rule {
+ public:
+  VisitRecordingRule()
+      : Rule(nullptr, /*use_topo*/ true, /*reverse_topological_execution*/ false) {}
+  bool SupportsIncrementalExecution() const override { return true; }
+
+  std::vector<int64_t> visited;
+
+ protected:
+  StatusOr<bool> Apply(IRNode* node) override {
+    visited.push_back(node->id());
+    return false;
+  }
+};
+
+// Reports a change to the target node the first time it sees it.
+class ChangeNodeOnceRule : public Rule {
+ public:
+  explicit ChangeNodeOnceRule(int64_t target)
+      : Rule(nullptr, /*use_topo*/ false, /*reverse_topological_execution*/ false),
+        target_(target) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* node) override {
+    if (node->id() != target_ || changed_) {
+      return false;
+    }
+    changed_ = true;
+    return true;
+  }
+
+ private:
+  int64_t target_;
+  bool changed_ = false;
+};
+
+TEST_F(RuleExecutorTest, incremental_rules_revisit_changed_subgraph) {
+  std::unique_ptr<TestExecutor> executor = std::move(TestExecutor::Create().ValueOrDie());
+  RuleBatch* rule_batch = executor->CreateRuleBatch<FailOnMax>("resolve", 10);
+  auto recording_rule = rule_batch->AddRule<VisitRecordingRule>();
+  rule_batch->AddRule<ChangeNodeOnceRule>(func->id());
+  ASSERT_OK(executor->Execute(graph.get()));
+
+  // The first run visits the whole graph, the second only the changed node and its arguments.
+  size_t num_nodes = graph->dag().nodes().size();
+  ASSERT_EQ(num_nodes + 3, recording_rule->visited.size());
+  std::vector<int64_t> second_run(recording_rule->visited.begin() + num_nodes,
+                                  recording_rule->visited.end());
+  EXPECT_EQ(func->id(), second_run[0]);
+  EXPECT_THAT(second_run, UnorderedElementsAre(func->id(), int_constant->id(), col->id()));
+}
+
+TEST_F(RuleExecutorTest, incremental_rules_visit_new_nodes) {
+  std::unique_ptr<TestExecutor> executor = std::move(TestExecutor::Create().ValueOrDie());
+  RuleBatch* rule_batch = executor->CreateRuleBatch<FailOnMax>("resolve", 10);
+  auto recording_rule = rule_batch->AddRule<VisitRecordingRule>();
+  MockRule* add_node_rule = rule_batch->AddRule<MockRule>();
+  IntIR* new_int = nullptr;
+  EXPECT_CALL(*add_node_rule, Execute(_))
+      .Times(2)
+      .WillOnce([&](IR* ir) -> StatusOr<bool> {
+        PX_ASSIGN_OR_RETURN(new_int, ir->CreateNode<IntIR>(ast, 3));
+        return true;
+      })
+      .WillRepeatedly(Return(false));
+  ASSERT_OK(executor->Execute(graph.get()));
+
+  // The mock doesn't tell which nodes it changed, so the second run visits the whole graph.
+  ASSERT_NE(nullptr, new_int);
+  size_t num_nodes = graph->dag().nodes().size();
+  EXPECT_EQ(2 * num_nodes - 1, recording_rule->visited.size());
+}
+
+TEST_F(RuleExecutorTest, rule_profiler) {
+  std::unique_ptr<TestExecutor> executor = std::move(TestExecutor::Create().ValueOrDie());
+  RuleProfiler profiler;
+  executor->set_rule_profiler(&profiler);
+  RuleBatch* rule_batch = executor->CreateRuleBatch<FailOnMax>("resolve", 10);
+  rule_batch->AddRule<ChangeNodeOnceRule>(func->id());
+  rule_batch->AddRule<VisitRecordingRule>();
+  ASSERT_OK(executor->Execute(graph.get()));
+
+  auto profiles = profiler.Profiles();
+  ASSERT_EQ(2UL, profiles.size());
+  std::sort(profiles.begin(), profiles.end(),
+            [](const RuleProfile& a, const RuleProfile& b) { return a.rule < b.rule; });
+  EXPECT_EQ("resolve", profiles[0].batch);
+  EXPECT_EQ("ChangeNodeOnceRule", profiles[0].rule);
+  EXPECT_EQ(2, profiles[0].executions);
+  EXPECT_EQ(1, profiles[0].changes);
+  EXPECT_EQ(0, profiles[0].skipped);
+  // The recording rule ran after the change, and so is skipped in the second iteration.
+  EXPECT_EQ("VisitRecordingRule", profiles[1].rule);
+  EXPECT_EQ(1, profiles[1].executions);
+  EXPECT_EQ(0, profiles[1].changes);
+  EXPECT_EQ(1, profiles[1].skipped);
+}
+
+TEST(ExecutePerFragmentTest, runs_every_fragment) {
+  std::vector<int64_t> results(100, 0);
+  ASSERT_OK(ExecutePerFragment(results.size(), [&](size_t i) -> Status {
+    results[i] = static_cast<int64_t>(i) * 2;
+    return Status::OK();
+  }));
+  for (const auto& [i, result] : Enumerate(results)) {
+    EXPECT_EQ(static_cast<int64_t>(i) * 2, result);
+  }
+
+  auto s = ExecutePerFragment(10, [&](size_t i) -> Status {
+    if (i == 7) {
+      return error::InvalidArgument("fragment $0 failed", i);
+    }
+    return Status::OK();
+  });
+  ASSERT_NOT_OK(s);
+  EXPECT_EQ("fragment 7 failed", s.msg());
+}
+
 }  // namespace planner
 }  // namespace carnot
 }  // namespace px
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/planner/rules/rule_profiler.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+void RuleProfiler::Record(std::string_view batch, std::string_view rule, bool skipped,
+                          bool changed, int64_t time_ns) {
+  absl::MutexLock lock(&mu_);
+  auto& profile = profiles_[std::make_pair(std::string(batch), std::string(rule))];
+  if (profile.rule.empty()) {
+    profile.batch = batch;
+    profile.rule = rule;
+  }
+  if (skipped) {
+    ++profile.skipped;
+    return;
+  }
+  ++profile.executions;
+  if (changed) {
+    ++profile.changes;
+  }
+  profile.time_ns += time_ns;
+}
+
+std::vector<RuleProfile> RuleProfiler::Profiles() const {
+  std::vector<RuleProfile> profiles;
+  {
+    absl::MutexLock lock(&mu_);
+    profiles.reserve(profiles_.size());
+    for (const auto& [key, profile] : profiles_) {
+      profiles.push_back(profile);
+    }
+  }
+  std::sort(profiles.begin(), profiles.end(), [](const RuleProfile& a, const RuleProfile& b) {
+    if (a.time_ns != b.time_ns) {
+      return a.time_ns > b.time_ns;
+    }
+    return std::tie(a.batch, a.rule) < std::tie(b.batch, b.rule);
+  });
+  return profiles;
+}
+
+std::string RuleProfiler::DebugString() const {
+  std::string out;
+  for (const auto& profile : Profiles()) {
+    absl::StrAppend(&out, absl::Substitute("$0/$1: $2us, $3 runs ($4 changed, $5 skipped)\n",
+                                           profile.batch, profile.rule, profile.time_ns / 1000,
+                                           profile.executions, profile.changes, profile.skipped));
+  }
+  return out;
+}
+
+void RuleProfiler::Clear() {
+  absl::MutexLock lock(&mu_);
+  profiles_.clear();
+}
+
+std::string RuleName(const std::type_info& rule_type) {
+  int status = 0;
+  std::unique_ptr<char, decltype(&std::free)> demangled(
+      abi::__cxa_demangle(rule_type.name(), nullptr, nullptr, &status), &std::free);
+  std::string name = status == 0 ? demangled.get() : rule_type.name();
+  // Drop the namespaces, but not the ones of template arguments.
+  size_t end = name.find('<');
+  size_t start = name.rfind("::", end);
+  if (start != std::string::npos) {
+    name = name.substr(start + 2);
+  }
+  return name;
+}
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
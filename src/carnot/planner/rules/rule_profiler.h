@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+
+/**
+ * The time the RuleExecutor spent on one rule of a rule batch.
+ */
+struct RuleProfile {
+  std::string batch;
+  std::string rule;
+  // How often the rule ran, and how many of those runs changed the graph.
+  int64_t executions = 0;
+  int64_t changes = 0;
+  // How often the rule was skipped because the graph had not changed since it last ran.
+  int64_t skipped = 0;
+  int64_t time_ns = 0;
+};
+
+/**
+ * RuleProfiler collects the time spent on every rule across the RuleExecutors of a compilation.
+ * It is optional, the RuleExecutor only takes timings when one is set.
+ */
+class RuleProfiler : public NotCopyable {
+ public:
+  void Record(std::string_view batch, std::string_view rule, bool skipped, bool changed,
+              int64_t time_ns);
+
+  /**
+   * @brief Returns the profiles of all rules, the most expensive first.
+   */
+  std::vector<RuleProfile> Profiles() const;
+
+  std::string DebugString() const;
+  void Clear();
+
+ private:
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<std::pair<std::string, std::string>, RuleProfile> profiles_
+      ABSL_GUARDED_BY(mu_);
+};
+
+/**
+ * @brief Returns the unqualified class name of a rule, such as "ResolveTypesRule".
+ */
+std::string RuleName(const std::type_info& rule_type);
+
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
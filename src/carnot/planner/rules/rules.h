@@ -17,12 +17,14 @@
  */
 
 #pragma once
+#include <algorithm>
 #include <memory>
 #include <queue>
 #include <string>
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/compiler_state/registry_info.h"
@@ -55,6 +57,7 @@ class BaseRule {
   virtual ~BaseRule() = default;
 
   virtual StatusOr<bool> Execute(TPlan* graph) {
+    changed_nodes_.clear();
     bool any_changed = false;
     if (!use_topo_) {
       PX_ASSIGN_OR_RETURN(any_changed, ExecuteUnsorted(graph));
@@ -65,6 +68,46 @@ class BaseRule {
     return any_changed;
   }
 
+  /**
+   * @brief Executes the rule on the dirty nodes and all of their descendants, rather than on the
+   * whole graph. Only valid for rules that SupportsIncrementalExecution().
+   *
+   * @param graph the graph to execute the rule on.
+   * @param dirty_nodes the nodes that were added or changed since the rule last ran on the graph.
+   * @return true if the rule changed any node.
+   */
+  StatusOr<bool> ExecuteIncremental(TPlan* graph, const absl::flat_hash_set<int64_t>& dirty_nodes) {
+    DCHECK(SupportsIncrementalExecution());
+    changed_nodes_.clear();
+    bool any_changed = false;
+    for (int64_t node_i : DirtySubgraph(graph, dirty_nodes)) {
+      // The node may have been deleted by a prior call to Apply on a parent or child node.
+      if (!graph->HasNode(node_i)) {
+        continue;
+      }
+      PX_ASSIGN_OR_RETURN(bool node_is_changed, Apply(graph->Get(node_i)));
+      if (node_is_changed) {
+        changed_nodes_.push_back(node_i);
+      }
+      any_changed = any_changed || node_is_changed;
+    }
+    PX_RETURN_IF_ERROR(EmptyDeleteQueue(graph));
+    return any_changed;
+  }
+
+  /**
+   * @brief Whether the result of Apply on a node only depends on the node and its ancestors. Once
+   * such a rule has run over the whole graph, running it again can only change the nodes that were
+   * added or changed since, or their descendants, so the RuleExecutor only revisits those.
+   */
+  virtual bool SupportsIncrementalExecution() const { return false; }
+
+  /**
+   * @brief The nodes that Apply changed during the last execution of the rule. Empty if the rule
+   * overrides Execute, in which case the changes it makes can't be attributed to nodes.
+   */
+  const std::vector<int64_t>& changed_nodes() const { return changed_nodes_; }
+
  protected:
   StatusOr<bool> ExecuteTopologicalSorted(TPlan* graph) {
     bool any_changed = false;
@@ -78,6 +121,9 @@ class BaseRule {
         continue;
       }
       PX_ASSIGN_OR_RETURN(bool node_is_changed, Apply(graph->Get(node_i)));
+      if (node_is_changed) {
+        changed_nodes_.push_back(node_i);
+      }
       any_changed = any_changed || node_is_changed;
     }
     return any_changed;
@@ -94,11 +140,74 @@ class BaseRule {
         continue;
       }
       PX_ASSIGN_OR_RETURN(bool node_is_changed, Apply(graph->Get(node_i)));
+      if (node_is_changed) {
+        changed_nodes_.push_back(node_i);
+      }
       any_changed = any_changed || node_is_changed;
     }
     return any_changed;
   }
 
+  /**
+   * @brief Returns the dirty nodes that are still in the graph and all of their descendants, in the
+   * order that the rule visits the graph in.
+   */
+  std::vector<int64_t> DirtySubgraph(TPlan* graph,
+                                     const absl::flat_hash_set<int64_t>& dirty_nodes) const {
+    absl::flat_hash_set<int64_t> subgraph;
+    std::queue<int64_t> q;
+    for (int64_t node_i : dirty_nodes) {
+      if (graph->HasNode(node_i) && subgraph.insert(node_i).second) {
+        q.push(node_i);
+      }
+    }
+    while (!q.empty()) {
+      int64_t node_i = q.front();
+      q.pop();
+      for (int64_t child : graph->dag().DependenciesOf(node_i)) {
+        if (subgraph.insert(child).second) {
+          q.push(child);
+        }
+      }
+    }
+
+    std::vector<int64_t> order;
+    order.reserve(subgraph.size());
+    if (!use_topo_) {
+      order.assign(subgraph.begin(), subgraph.end());
+      std::sort(order.begin(), order.end());
+      return order;
+    }
+    // Topologically sort the subgraph alone. It is closed under descendants, so only the parents
+    // inside of the subgraph hold a node back.
+    absl::flat_hash_map<int64_t, int64_t> num_parents;
+    for (int64_t node_i : subgraph) {
+      int64_t& count = num_parents[node_i];
+      for (int64_t parent : graph->dag().ParentsOf(node_i)) {
+        if (subgraph.contains(parent)) {
+          ++count;
+        }
+      }
+      if (count == 0) {
+        q.push(node_i);
+      }
+    }
+    while (!q.empty()) {
+      int64_t node_i = q.front();
+      q.pop();
+      order.push_back(node_i);
+      for (int64_t child : graph->dag().DependenciesOf(node_i)) {
+        if (--num_parents[child] == 0) {
+          q.push(child);
+        }
+      }
+    }
+    if (reverse_topological_execution_) {
+      std::reverse(order.begin(), order.end());
+    }
+    return order;
+  }
+
   /**
    * @brief Applies the rule to a node.
    * Should include a check for type and should return true if it changes the node.
@@ -122,6 +231,8 @@ class BaseRule {
 
   // The queue containing nodes to delete.
   std::queue<int64_t> node_delete_q;
+  // The nodes that Apply changed during the last execution.
+  std::vector<int64_t> changed_nodes_;
   CompilerState* compiler_state_;
   bool use_topo_;
   bool reverse_topological_execution_;
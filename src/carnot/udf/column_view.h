@@ -0,0 +1,201 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/builder.h>
+
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace udf {
+
+// This is the size we assume for an "average" string. If this is too large we waste
+// memory, if too small we spend more time allocating. Since we use exponential doubling
+// it's better to keep this number small.
+const int kStringAssumedSizeHeuristic = 10;
+
+/**
+ * The type a ColumnView returns for each row and a ColumnWriter accepts. Strings are passed as
+ * std::string_view so that batch UDFs never copy their inputs or outputs, every other type uses
+ * the regular UDF value type.
+ */
+template <types::DataType T>
+using ColumnValueType =
+    std::conditional_t<T == types::DataType::STRING, std::string_view,
+                       typename types::DataTypeTraits<T>::value_type>;
+
+/**
+ * ColumnView is a read-only, zero-copy view of the first `size()` rows of a UDF input column.
+ * It is backed by either an arrow::Array or a types::ColumnWrapper, so batch UDFs can be written
+ * once for both the arrow-native and the vector-native evaluators.
+ *
+ * String rows are returned as std::string_view into the underlying buffer and are only valid as
+ * long as the column is.
+ */
+template <types::DataType T>
+class ColumnView {
+ public:
+  using value_type = ColumnValueType<T>;
+
+  static ColumnView FromArrow(const arrow::Array* arr, int64_t size) {
+    DCHECK(arr != nullptr);
+    DCHECK_GE(arr->length(), size);
+    ColumnView view;
+    view.arr_ = arr;
+    view.size_ = size;
+    return view;
+  }
+
+  static ColumnView FromColumnWrapper(const types::ColumnWrapper* col, int64_t size) {
+    DCHECK(col != nullptr);
+    DCHECK_EQ(col->data_type(), T);
+    DCHECK_GE(static_cast<int64_t>(col->Size()), size);
+    ColumnView view;
+    view.values_ =
+        static_cast<const typename types::DataTypeTraits<T>::value_type*>(col->UnsafeRawData());
+    view.size_ = size;
+    return view;
+  }
+
+  int64_t size() const { return size_; }
+
+  /**
+   * The arrow data backing the view, or nullptr if the view is backed by a ColumnWrapper. Holding
+   * on to it keeps the column's buffers alive, so it can be used to recognize the same column when
+   * it is passed to a UDF again.
+   */
+  std::shared_ptr<arrow::ArrayData> arrow_data() const {
+    return arr_ == nullptr ? nullptr : arr_->data();
+  }
+
+  value_type operator[](int64_t idx) const {
+    if (arr_ != nullptr) {
+      if constexpr (T == types::DataType::STRING) {
+        return types::GetStringViewFromArrowArray(arr_, idx);
+      } else {
+        return types::GetValueFromArrowArray<T>(arr_, idx);
+      }
+    }
+    if constexpr (T == types::DataType::STRING) {
+      return std::string_view(values_[idx]);
+    } else {
+      return values_[idx];
+    }
+  }
+
+ private:
+  ColumnView() = default;
+
+  const arrow::Array* arr_ = nullptr;
+  const typename types::DataTypeTraits<T>::value_type* values_ = nullptr;
+  int64_t size_ = 0;
+};
+
+/**
+ * ColumnWriter appends the results of a batch UDF to its output column, one row at a time and in
+ * order. For the arrow-native evaluator the values are written straight into the output builder,
+ * whose buffers are reserved up front and grown by doubling, so appending a string is a single
+ * memcpy into the builder's data buffer.
+ */
+template <types::DataType T>
+class ColumnWriter {
+ public:
+  using value_type = ColumnValueType<T>;
+  using arrow_builder_type = typename types::DataTypeTraits<T>::arrow_builder_type;
+
+  ColumnWriter() = default;
+
+  static ColumnWriter ToArrow(arrow::ArrayBuilder* builder, int64_t count) {
+    DCHECK(builder != nullptr);
+    ColumnWriter writer;
+    writer.builder_ = static_cast<arrow_builder_type*>(builder);
+    CHECK(writer.builder_->Reserve(count).ok());
+    // PX_CARNOT_UPDATE_FOR_NEW_TYPES.
+    if constexpr (T == types::DataType::STRING) {
+      writer.reserved_bytes_ = count * kStringAssumedSizeHeuristic;
+      CHECK(writer.builder_->ReserveData(writer.reserved_bytes_).ok());
+    }
+    return writer;
+  }
+
+  static ColumnWriter ToColumnWrapper(types::ColumnWrapper* col) {
+    DCHECK(col != nullptr);
+    DCHECK_EQ(col->data_type(), T);
+    ColumnWriter writer;
+    writer.values_ =
+        static_cast<typename types::DataTypeTraits<T>::value_type*>(col->UnsafeRawData());
+    return writer;
+  }
+
+  void Append(value_type val) {
+    if (builder_ != nullptr) {
+      // PX_CARNOT_UPDATE_FOR_NEW_TYPES.
+      if constexpr (T == types::DataType::STRING) {
+        used_bytes_ += val.size();
+        // We use doubling to make sure we minimize the number of allocations.
+        if (used_bytes_ >= reserved_bytes_) {
+          while (used_bytes_ >= reserved_bytes_) {
+            reserved_bytes_ *= 2;
+          }
+          CHECK(builder_->ReserveData(reserved_bytes_).ok());
+        }
+        builder_->UnsafeAppend(val.data(), static_cast<int32_t>(val.size()));
+      } else {
+        builder_->UnsafeAppend(val.val);
+      }
+      return;
+    }
+    if constexpr (T == types::DataType::STRING) {
+      values_[idx_++] = types::StringValue(val.data(), val.size());
+    } else {
+      values_[idx_++] = val;
+    }
+  }
+
+ private:
+  arrow_builder_type* builder_ = nullptr;
+  typename types::DataTypeTraits<T>::value_type* values_ = nullptr;
+  int64_t idx_ = 0;
+  int64_t reserved_bytes_ = 0;
+  int64_t used_bytes_ = 0;
+};
+
+using BoolColumnView = ColumnView<types::DataType::BOOLEAN>;
+using Int64ColumnView = ColumnView<types::DataType::INT64>;
+using Float64ColumnView = ColumnView<types::DataType::FLOAT64>;
+using UInt128ColumnView = ColumnView<types::DataType::UINT128>;
+using StringColumnView = ColumnView<types::DataType::STRING>;
+
+using BoolColumnWriter = ColumnWriter<types::DataType::BOOLEAN>;
+using Int64ColumnWriter = ColumnWriter<types::DataType::INT64>;
+using Float64ColumnWriter = ColumnWriter<types::DataType::FLOAT64>;
+using StringColumnWriter = ColumnWriter<types::DataType::STRING>;
+
+}  // namespace udf
+}  // namespace carnot
+}  // namespace px
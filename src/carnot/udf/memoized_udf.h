@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/container/flat_hash_map.h>
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "src/carnot/udf/base.h"
+#include "src/carnot/udf/column_view.h"
+#include "src/carnot/udf/udf.h"
+#include "src/shared/metadata/metadata_state.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace udf {
+
+/**
+ * MemoizedScalarUDF is the base for scalar UDFs with a single argument, whose result only depends
+ * on that argument and on the metadata state of the function context (eg. upid_to_pod_name).
+ *
+ * The derived class implements Exec as usual, and inherits an ExecBatch that calls Exec once per
+ * distinct input value instead of once per row. The results are kept for the lifetime of the UDF
+ * instance, which is the whole query, and are dropped whenever the metadata state (or its epoch)
+ * changes. A batch usually has only a handful of distinct values, so most rows are a hash lookup
+ * and a copy of the memoized result into the output.
+ *
+ * @tparam TUDF The derived UDF.
+ * @tparam TArg The data type of the argument of Exec.
+ * @tparam TReturn The data type Exec returns.
+ */
+template <typename TUDF, types::DataType TArg, types::DataType TReturn>
+class MemoizedScalarUDF : public ScalarUDF {
+ public:
+  // Past this many distinct values the memo is cleared, to bound its memory on high cardinality
+  // inputs.
+  static constexpr size_t kMaxMemoizedValues = 64 * 1024;
+
+  Status ExecBatch(FunctionContext* ctx, const ColumnView<TArg>& in, ColumnWriter<TReturn>* out) {
+    ResetIfStale(ctx);
+    // Consecutive rows often share the same input, so the last lookup is checked first.
+    const ReturnValueType* last_result = nullptr;
+    MemoKeyType last_key{};
+    for (int64_t idx = 0; idx < in.size(); ++idx) {
+      auto val = in[idx];
+      if (last_result == nullptr || !(Key(val) == last_key)) {
+        last_key = MemoKeyType(Key(val));
+        last_result = &Lookup(ctx, val);
+      }
+      if constexpr (TReturn == types::DataType::STRING) {
+        out->Append(std::string_view(*last_result));
+      } else {
+        out->Append(*last_result);
+      }
+    }
+    return Status::OK();
+  }
+
+  size_t num_memoized_values() const { return memo_.size(); }
+
+ private:
+  using ReturnValueType = typename types::DataTypeTraits<TReturn>::value_type;
+  using MemoKeyType = typename types::DataTypeTraits<TArg>::native_type;
+
+  static auto Key(const ColumnValueType<TArg>& val) {
+    if constexpr (TArg == types::DataType::STRING) {
+      return val;
+    } else {
+      return val.val;
+    }
+  }
+
+  const ReturnValueType& Lookup(FunctionContext* ctx, const ColumnValueType<TArg>& val) {
+    auto it = memo_.find(Key(val));
+    if (it != memo_.end()) {
+      return it->second;
+    }
+    if (memo_.size() >= kMaxMemoizedValues) {
+      memo_.clear();
+    }
+    auto* udf = static_cast<TUDF*>(this);
+    if constexpr (TArg == types::DataType::STRING) {
+      return memo_.emplace(Key(val), udf->Exec(ctx, types::StringValue(val.data(), val.size())))
+          .first->second;
+    } else {
+      return memo_.emplace(Key(val), udf->Exec(ctx, val)).first->second;
+    }
+  }
+
+  void ResetIfStale(FunctionContext* ctx) {
+    const px::md::AgentMetadataState* md = ctx == nullptr ? nullptr : ctx->metadata_state();
+    uint64_t epoch = md == nullptr ? 0 : md->epoch_id();
+    if (md != memo_md_ || epoch != memo_epoch_) {
+      memo_.clear();
+      memo_md_ = md;
+      memo_epoch_ = epoch;
+    }
+  }
+
+  absl::flat_hash_map<MemoKeyType, ReturnValueType> memo_;
+  const px::md::AgentMetadataState* memo_md_ = nullptr;
+  uint64_t memo_epoch_ = 0;
+};
+
+}  // namespace udf
+}  // namespace carnot
+}  // namespace px
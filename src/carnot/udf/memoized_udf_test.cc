@@ -0,0 +1,131 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/udf/memoized_udf.h"
+#include "src/carnot/udf/udf_wrapper.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace udf {
+
+// Upper cases its input, and counts how often Exec runs.
+class CountingUpperUDF
+    : public MemoizedScalarUDF<CountingUpperUDF, types::DataType::STRING, types::DataType::STRING> {
+ public:
+  StringValue Exec(FunctionContext*, StringValue s) {
+    ++exec_calls;
+    std::transform(s.begin(), s.end(), s.begin(), ::toupper);
+    return s;
+  }
+
+  int64_t exec_calls = 0;
+};
+
+class CountingHighUDF
+    : public MemoizedScalarUDF<CountingHighUDF, types::DataType::UINT128, types::DataType::INT64> {
+ public:
+  Int64Value Exec(FunctionContext*, UInt128Value v) {
+    ++exec_calls;
+    return static_cast<int64_t>(v.High64());
+  }
+
+  int64_t exec_calls = 0;
+};
+
+template <typename TUDF>
+std::shared_ptr<arrow::Array> RunBatch(TUDF* udf, FunctionContext* ctx,
+                                       const std::shared_ptr<arrow::Array>& in,
+                                       types::DataType out_type) {
+  auto builder = types::MakeArrowBuilder(out_type, arrow::default_memory_pool());
+  std::vector<arrow::Array*> inputs{in.get()};
+  EXPECT_OK(ScalarUDFWrapper<TUDF>::ExecBatchArrow(udf, ctx, inputs, builder.get(), in->length()));
+  std::shared_ptr<arrow::Array> out;
+  EXPECT_TRUE(builder->Finish(&out).ok());
+  return out;
+}
+
+TEST(MemoizedScalarUDF, exec_once_per_distinct_value) {
+  EXPECT_TRUE(ScalarUDFTraits<CountingUpperUDF>::HasExecBatch());
+
+  auto in = types::ToArrow(std::vector<types::StringValue>{"a", "a", "b", "a", "c", "b", "b"},
+                           arrow::default_memory_pool());
+  CountingUpperUDF udf;
+  auto out = RunBatch(&udf, nullptr, in, types::DataType::STRING);
+  ASSERT_EQ(7, out->length());
+  std::vector<std::string> vals;
+  for (int64_t i = 0; i < out->length(); ++i) {
+    vals.push_back(types::GetValueFromArrowArray<types::DataType::STRING>(out.get(), i));
+  }
+  EXPECT_THAT(vals, ::testing::ElementsAre("A", "A", "B", "A", "C", "B", "B"));
+  EXPECT_EQ(3, udf.exec_calls);
+  EXPECT_EQ(3U, udf.num_memoized_values());
+
+  // The memoized values are reused by the following batches.
+  RunBatch(&udf, nullptr, in, types::DataType::STRING);
+  EXPECT_EQ(3, udf.exec_calls);
+}
+
+TEST(MemoizedScalarUDF, uint128_keys) {
+  auto in = types::ToArrow(
+      std::vector<types::UInt128Value>{absl::MakeUint128(1, 5), absl::MakeUint128(1, 6),
+                                       absl::MakeUint128(2, 5), absl::MakeUint128(1, 5)},
+      arrow::default_memory_pool());
+  CountingHighUDF udf;
+  auto out = RunBatch(&udf, nullptr, in, types::DataType::INT64);
+  auto* int_out = static_cast<arrow::Int64Array*>(out.get());
+  ASSERT_EQ(4, int_out->length());
+  EXPECT_EQ(1, int_out->Value(0));
+  EXPECT_EQ(1, int_out->Value(1));
+  EXPECT_EQ(2, int_out->Value(2));
+  EXPECT_EQ(1, int_out->Value(3));
+  EXPECT_EQ(3, udf.exec_calls);
+}
+
+TEST(MemoizedScalarUDF, reset_on_new_metadata_epoch) {
+  auto in = types::ToArrow(std::vector<types::StringValue>{"a", "b", "a"},
+                           arrow::default_memory_pool());
+  auto md = std::make_shared<px::md::AgentMetadataState>(
+      /* hostname */ "myhost", /* asid */ 1, /* pid */ 123, /* agent_id */ sole::uuid4(), "mypod",
+      sole::uuid4(), "myvizier", "myviziernamespace", nullptr);
+  md->set_epoch_id(1);
+  FunctionContext ctx(md, nullptr);
+  CountingUpperUDF udf;
+  RunBatch(&udf, &ctx, in, types::DataType::STRING);
+  EXPECT_EQ(2, udf.exec_calls);
+  RunBatch(&udf, &ctx, in, types::DataType::STRING);
+  EXPECT_EQ(2, udf.exec_calls);
+
+  // A new metadata epoch invalidates everything that was memoized.
+  md->set_epoch_id(2);
+  RunBatch(&udf, &ctx, in, types::DataType::STRING);
+  EXPECT_EQ(4, udf.exec_calls);
+}
+
+}  // namespace udf
+}  // namespace carnot
+}  // namespace px
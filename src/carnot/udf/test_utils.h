@@ -29,7 +29,9 @@
 
 #include <absl/strings/str_format.h>
 #include "src/carnot/udf/udf.h"
+#include "src/carnot/udf/udf_wrapper.h"
 #include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/types.h"
 
 namespace px {
@@ -87,10 +89,16 @@ class UDFTester {
    * Execute the UDF on the given arguments and store the result to be checked by Expect.
    * Arguments must be of a type that can usually be passed into the UDF's Exec function,
    * or else there will be an error.
+   *
+   * If the UDF implements ExecBatch, it is also run on the arguments and must produce the same
+   * result as Exec.
    */
   template <typename... Args>
   UDFTester& ForInput(Args... args) {
     res_ = udf_.Exec(function_ctx_.get(), args...);
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      ExpectExecBatchMatches(std::index_sequence_for<Args...>{}, args...);
+    }
 
     return *this;
   }
@@ -108,6 +116,33 @@ class UDFTester {
   typename types::DataTypeTraits<udf_data_type>::value_type Result() { return res_; }
 
  private:
+  template <types::DataType T, typename TArg>
+  static std::shared_ptr<arrow::Array> ToSingleRowArray(TArg arg) {
+    std::vector<typename types::DataTypeTraits<T>::value_type> values;
+    values.emplace_back(arg);
+    return types::ToArrow(values, arrow::default_memory_pool());
+  }
+
+  template <std::size_t... I, typename... Args>
+  void ExpectExecBatchMatches(std::index_sequence<I...>, Args... args) {
+    constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+    std::vector<std::shared_ptr<arrow::Array>> arrays = {
+        ToSingleRowArray<exec_argument_types[I]>(args)...};
+    std::vector<arrow::Array*> inputs;
+    for (const auto& arr : arrays) {
+      inputs.push_back(arr.get());
+    }
+    auto builder = types::MakeArrowBuilder(udf_data_type, arrow::default_memory_pool());
+    EXPECT_OK(ScalarUDFWrapper<TUDF>::ExecBatchArrow(&udf_, function_ctx_.get(), inputs,
+                                                     builder.get(), 1));
+    std::shared_ptr<arrow::Array> out;
+    ASSERT_TRUE(builder->Finish(&out).ok());
+    ASSERT_EQ(1, out->length());
+    typename types::DataTypeTraits<udf_data_type>::value_type batch_res(
+        types::GetValueFromArrowArray<udf_data_type>(out.get(), 0));
+    internal::ExpectEquality(batch_res, res_);
+  }
+
   TUDF udf_;
   std::unique_ptr<udf::FunctionContext> function_ctx_ = nullptr;
   typename types::DataTypeTraits<udf_data_type>::value_type res_;
@@ -31,6 +31,7 @@
 #include <functional>
 
 #include "src/carnot/udf/base.h"
+#include "src/carnot/udf/column_view.h"
 #include "src/carnot/udfspb/udfs.pb.h"
 #include "src/common/base/base.h"
 #include "src/shared/metadata/metadata_state.h"
@@ -74,6 +75,15 @@ class AnyUDA : public BaseFunc {
  *      Status Init(FunctionContext *ctx, UDFValue... init_args) {}
  *  This function is called once during initialization of each instance (many instances
  *  may exists in a given query). The arguments are as provided by the query.
+ *
+ * Hot UDFs can _optionally_ implement a batch version of Exec as well:
+ *      Status ExecBatch(FunctionContext *ctx, const ColumnView<ArgType>&... args,
+ *                       ColumnWriter<ReturnType>* out) {}
+ *  with one ColumnView per argument of Exec. When it exists, it is called once per batch instead
+ *  of calling Exec once per record. String arguments are std::string_views into the input
+ *  buffers and string results are appended straight into the output, so no per-row StringValues
+ *  are created. It must append exactly one value per input row and produce the same values as
+ *  Exec, which is still used for type information and constant folding.
  */
 class ScalarUDF : public AnyUDF {
  public:
@@ -117,6 +127,45 @@ struct has_udf_init_fn<T, std::void_t<decltype(&T::Init)>> : std::true_type {
       "If an init function exists, it must have the form: Status Init(FunctionContext*, ...)");
 };
 
+/**
+ * The elementwise operations that the fused expression evaluator can compile into its own
+ * kernels, instead of calling the UDF. A scalar UDF whose Exec is exactly one of these operations
+ * on its (fixed width) arguments can declare so with:
+ *      static constexpr udf::FusedOp FusedOp() { return udf::FusedOp::kAdd; }
+ */
+enum class FusedOp : uint8_t {
+  kNone = 0,
+  kAdd,
+  kSubtract,
+  kMultiply,
+  kDivide,
+  kModulo,
+  kNegate,
+  kEqual,
+  kNotEqual,
+  kLessThan,
+  kLessThanEqual,
+  kGreaterThan,
+  kGreaterThanEqual,
+  kLogicalAnd,
+  kLogicalOr,
+  kLogicalNot,
+};
+
+// SFINAE test for the optional fused op fn.
+template <typename T, typename = void>
+struct has_udf_fused_op_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_fused_op_fn<T, std::void_t<decltype(&T::FusedOp)>> : std::true_type {};
+
+// SFINAE test for the optional batch exec fn.
+template <typename T, typename = void>
+struct has_udf_exec_batch_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_exec_batch_fn<T, std::void_t<decltype(&T::ExecBatch)>> : std::true_type {};
+
 /**
  * Checks to see if a valid looking Init Function exists.
  */
@@ -228,6 +277,22 @@ class ScalarUDFTraits {
    */
   static constexpr bool HasExecutor() { return has_udf_executor_fn<T>::value; }
 
+  /**
+   * Checks if the UDF implements the batch (ColumnView based) version of Exec.
+   */
+  static constexpr bool HasExecBatch() { return has_udf_exec_batch_fn<T>::value; }
+
+  /**
+   * Returns the elementwise operation this UDF declares it computes, or kNone.
+   */
+  static constexpr udf::FusedOp FusedOp() {
+    if constexpr (has_udf_fused_op_fn<T>::value) {
+      return T::FusedOp();
+    } else {
+      return udf::FusedOp::kNone;
+    }
+  }
+
   template <typename Q = T, std::enable_if_t<ScalarUDFTraits<Q>::HasInit(), void>* = nullptr>
   static constexpr auto InitArguments() {
     return GetArgumentTypesHelper(&Q::Init);
@@ -111,6 +111,7 @@ class ScalarUDFDefinition : public UDFDefinition {
     } else {
       executor_ = udfspb::UDFSourceExecutor::UDF_ALL;
     }
+    fused_op_ = ScalarUDFTraits<TUDF>::FusedOp();
 
     return Status::OK();
   }
@@ -144,6 +145,7 @@ class ScalarUDFDefinition : public UDFDefinition {
   const std::vector<types::DataType>& exec_arguments() const { return exec_arguments_; }
   const std::vector<types::DataType>& init_arguments() const { return init_arguments_; }
   udfspb::UDFSourceExecutor executor() const { return executor_; }
+  FusedOp fused_op() const { return fused_op_; }
 
   const std::vector<types::DataType>& RegistryArgTypes() override { return registry_arguments_; }
   size_t Arity() const { return exec_arguments_.size(); }
@@ -155,6 +157,7 @@ class ScalarUDFDefinition : public UDFDefinition {
   std::vector<types::DataType> registry_arguments_;
   types::DataType exec_return_type_;
   udfspb::UDFSourceExecutor executor_;
+  FusedOp fused_op_ = FusedOp::kNone;
   std::function<std::unique_ptr<ScalarUDF>()> make_fn_;
   std::function<Status(ScalarUDF*, FunctionContext* ctx,
                        const std::vector<const types::ColumnWrapper*>& inputs,
@@ -194,6 +197,9 @@ class UDADefinition : public UDFDefinition {
     update_arguments_ = {update_arguments_array.begin(), update_arguments_array.end()};
     finalize_return_type_ = UDATraits<T>::FinalizeReturnType();
     make_fn_ = UDAWrapper<T>::Make;
+    make_at_fn_ = UDAWrapper<T>::MakeAt;
+    uda_size_ = sizeof(T);
+    uda_alignment_ = alignof(T);
     exec_batch_update_fn_ = UDAWrapper<T>::ExecBatchUpdate;
     exec_batch_update_arrow_fn_ = UDAWrapper<T>::ExecBatchUpdateArrow;
     init_wrapper_fn_ = UDAWrapper<T>::ExecInit;
@@ -227,6 +233,15 @@ class UDADefinition : public UDFDefinition {
 
   std::unique_ptr<UDA> Make() { return make_fn_(); }
 
+  /**
+   * Creates a UDA in caller owned storage of at least uda_size() bytes, aligned to
+   * uda_alignment(). Lets callers that hold many UDAs of the same definition keep them adjacent in
+   * memory, rather than allocating each one.
+   */
+  UDA* MakeAt(void* storage) { return make_at_fn_(storage); }
+  size_t uda_size() const { return uda_size_; }
+  size_t uda_alignment() const { return uda_alignment_; }
+
   Status ExecBatchUpdate(UDA* uda, FunctionContext* ctx,
                          const std::vector<const types::ColumnWrapper*>& inputs) {
     return exec_batch_update_fn_(uda, ctx, inputs);
@@ -263,6 +278,9 @@ class UDADefinition : public UDFDefinition {
   bool supports_partial_;
 
   std::function<std::unique_ptr<UDA>()> make_fn_;
+  std::function<UDA*(void* storage)> make_at_fn_;
+  size_t uda_size_ = 0;
+  size_t uda_alignment_ = 0;
   std::function<Status(UDA* uda, FunctionContext* ctx,
                        const std::vector<const types::ColumnWrapper*>& inputs)>
       exec_batch_update_fn_;
@@ -252,6 +252,25 @@ TEST(UDADefinition, with_merge) {
   EXPECT_EQ(11, out.val);
 }
 
+TEST(UDADefinition, make_at) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  UDADefinition def("minsum");
+  EXPECT_OK(def.Init<MinSumUDA>());
+  EXPECT_EQ(sizeof(MinSumUDA), def.uda_size());
+  EXPECT_EQ(alignof(MinSumUDA), def.uda_alignment());
+
+  types::Int64ValueColumnWrapper v1({1, 2, 3});
+  types::Int64ValueColumnWrapper v2({5, 1, 3});
+
+  types::Int64Value out;
+  alignas(MinSumUDA) char storage[sizeof(MinSumUDA)];
+  UDA* u = def.MakeAt(storage);
+  EXPECT_OK(def.ExecBatchUpdate(u, &ctx, {&v1, &v2}));
+  EXPECT_OK(def.FinalizeValue(u, &ctx, &out));
+  EXPECT_EQ(5, out.val);
+  u->~UDA();
+}
+
 TEST(UDADefinition, arrow_output) {
   auto ctx = FunctionContext(nullptr, nullptr);
   UDADefinition def("minsum");
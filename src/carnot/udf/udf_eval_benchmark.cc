@@ -19,8 +19,14 @@
 #include <benchmark/benchmark.h>
 
 #include <random>
+#include <string>
 #include <vector>
 
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/funcs/builtins/json_ops.h"
+#include "src/carnot/funcs/builtins/regex_ops.h"
+#include "src/carnot/funcs/builtins/string_ops.h"
 #include "src/carnot/udf/registry.h"
 #include "src/carnot/udf/udf_wrapper.h"
 #include "src/common/base/base.h"
@@ -42,6 +48,12 @@ using px::types::StringValue;
 using px::types::StringValueColumnWrapper;
 using px::types::ToArrow;
 
+using px::carnot::builtins::PluckAsInt64UDF;
+using px::carnot::builtins::PluckUDF;
+using px::carnot::builtins::RegexMatchUDF;
+using px::carnot::builtins::SubstringUDF;
+using px::carnot::builtins::ToLowerUDF;
+
 using px::datagen::CreateLargeData;
 using px::datagen::RandomString;
 
@@ -244,6 +256,102 @@ static void BM_SubStrArrow(benchmark::State& state) {
   state.SetBytesProcessed(int64_t(state.iterations()) * width * data.size());
 }
 
+// Generates JSON objects like the bodies that are usually plucked by scripts.
+std::vector<StringValue> GenerateJSONVector(int size) {
+  std::vector<StringValue> data;
+  data.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    data.emplace_back(absl::Substitute(
+        R"({"status": $0, "latency": $1.5, "service": "svc-$2", "path": "/api/v1/$3"})",
+        200 + i % 5, i % 1000, i % 17, RandomString(12)));
+  }
+  return data;
+}
+
+std::shared_ptr<arrow::Array> RepeatedStringArray(const std::string& val, int size) {
+  return ToArrow(std::vector<StringValue>(size, val), arrow::default_memory_pool());
+}
+
+// Runs the UDF over the arrow inputs with a per-row call to Exec when state.range(1) is 0, or a
+// single ExecBatch call for the whole batch when it is 1.
+template <typename TUDF>
+void RunArrowUDF(benchmark::State& state, TUDF* udf, const std::vector<arrow::Array*>& inputs,
+                 px::types::DataType out_type, int size) {
+  bool batch = state.range(1) == 1;
+  std::shared_ptr<arrow::Array> out;
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    auto output_builder = px::types::MakeArrowBuilder(out_type, arrow::default_memory_pool());
+    Status res = batch ? ScalarUDFWrapper<TUDF>::ExecBatchArrow(udf, nullptr, inputs,
+                                                                output_builder.get(), size)
+                       : ScalarUDFWrapper<TUDF>::ExecBatchArrowPerRow(
+                             udf, nullptr, inputs, output_builder.get(), size);
+    PX_CHECK_OK(res);
+    CHECK(output_builder->Finish(&out).ok());
+    benchmark::DoNotOptimize(out);
+  }
+  CHECK_EQ(size, out->length());
+
+  int64_t bytes = 0;
+  for (const auto* input : inputs) {
+    if (input->type_id() == arrow::Type::STRING) {
+      bytes += px::types::GetArrowArrayBytes<px::types::DataType::STRING>(input);
+    }
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * bytes);
+}
+
+// Benchmark plucking a string value out of JSON objects.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckArrow(benchmark::State& state) {
+  int size = state.range(0);
+  auto json_arr = ToArrow(GenerateJSONVector(size), arrow::default_memory_pool());
+  auto key_arr = RepeatedStringArray("service", size);
+  PluckUDF udf;
+  RunArrowUDF(state, &udf, {json_arr.get(), key_arr.get()}, px::types::DataType::STRING, size);
+}
+
+// Benchmark plucking an int value out of JSON objects.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_PluckInt64Arrow(benchmark::State& state) {
+  int size = state.range(0);
+  auto json_arr = ToArrow(GenerateJSONVector(size), arrow::default_memory_pool());
+  auto key_arr = RepeatedStringArray("status", size);
+  PluckAsInt64UDF udf;
+  RunArrowUDF(state, &udf, {json_arr.get(), key_arr.get()}, px::types::DataType::INT64, size);
+}
+
+// Benchmark matching a regex against JSON objects.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RegexMatchArrow(benchmark::State& state) {
+  int size = state.range(0);
+  auto json_arr = ToArrow(GenerateJSONVector(size), arrow::default_memory_pool());
+  RegexMatchUDF udf;
+  PX_CHECK_OK(udf.Init(nullptr, ".*\"status\": 50[0-9].*"));
+  RunArrowUDF(state, &udf, {json_arr.get()}, px::types::DataType::BOOLEAN, size);
+}
+
+// Benchmark lower casing strings.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ToLowerArrow(benchmark::State& state) {
+  int size = state.range(0);
+  auto str_arr = ToArrow(GenerateStringValueVector(size, 32), arrow::default_memory_pool());
+  ToLowerUDF udf;
+  RunArrowUDF(state, &udf, {str_arr.get()}, px::types::DataType::STRING, size);
+}
+
+// Benchmark the substring builtin.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_SubstringArrow(benchmark::State& state) {
+  int size = state.range(0);
+  auto str_arr = ToArrow(GenerateStringValueVector(size, 32), arrow::default_memory_pool());
+  auto pos_arr = ToArrow(std::vector<Int64Value>(size, 4), arrow::default_memory_pool());
+  auto len_arr = ToArrow(std::vector<Int64Value>(size, 16), arrow::default_memory_pool());
+  SubstringUDF udf;
+  RunArrowUDF(state, &udf, {str_arr.get(), pos_arr.get(), len_arr.get()},
+              px::types::DataType::STRING, size);
+}
+
 BENCHMARK(BM_AddInt64ValueToArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_AddTwoInt64sArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_AddInt64Values)->RangeMultiplier(2)->Range(1, 1 << 16);
@@ -253,3 +361,16 @@ BENCHMARK(BM_ConvertToArrowInt64)->RangeMultiplier(2)->Range(1, 1 << 16);
 
 BENCHMARK(BM_SubStrArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_SubStr)->RangeMultiplier(2)->Range(1, 1 << 16);
+
+// The second argument selects the per-row Exec path (0) or the ExecBatch path (1).
+BENCHMARK(BM_PluckArrow)->ArgsProduct({{1 << 10, 1 << 16}, {0, 1}})->ArgNames({"rows", "batch"});
+BENCHMARK(BM_PluckInt64Arrow)
+    ->ArgsProduct({{1 << 10, 1 << 16}, {0, 1}})
+    ->ArgNames({"rows", "batch"});
+BENCHMARK(BM_RegexMatchArrow)
+    ->ArgsProduct({{1 << 10, 1 << 16}, {0, 1}})
+    ->ArgNames({"rows", "batch"});
+BENCHMARK(BM_ToLowerArrow)->ArgsProduct({{1 << 10, 1 << 16}, {0, 1}})->ArgNames({"rows", "batch"});
+BENCHMARK(BM_SubstringArrow)
+    ->ArgsProduct({{1 << 10, 1 << 16}, {0, 1}})
+    ->ArgNames({"rows", "batch"});
@@ -19,11 +19,16 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 #include "src/carnot/udf/udf_wrapper.h"
 #include "src/carnot/udfspb/udfs.pb.h"
 #include "src/common/base/base.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/types.h"
 
 namespace px {
@@ -51,6 +56,85 @@ TEST(ScalarUDF, basic_tests) {
   EXPECT_TRUE(ScalarUDFTraits<ScalarUDF1WithInit>::HasInit());
 }
 
+// Returns the prefix of the given length, and counts how often each exec path is used.
+class PrefixBatchUDF : public ScalarUDF {
+ public:
+  types::StringValue Exec(FunctionContext*, types::StringValue s, types::Int64Value len) {
+    ++exec_calls;
+    return types::StringValue(std::string_view(s).substr(0, len.val));
+  }
+
+  Status ExecBatch(FunctionContext*, const StringColumnView& s, const Int64ColumnView& len,
+                   StringColumnWriter* out) {
+    ++exec_batch_calls;
+    for (int64_t idx = 0; idx < s.size(); ++idx) {
+      out->Append(s[idx].substr(0, len[idx].val));
+    }
+    return Status::OK();
+  }
+
+  int64_t exec_calls = 0;
+  int64_t exec_batch_calls = 0;
+};
+
+TEST(ScalarUDF, exec_batch_traits) {
+  EXPECT_FALSE(ScalarUDFTraits<ScalarUDF1>::HasExecBatch());
+  EXPECT_TRUE(ScalarUDFTraits<PrefixBatchUDF>::HasExecBatch());
+  EXPECT_THAT(ScalarUDFTraits<PrefixBatchUDF>::ExecArguments(),
+              ElementsAre(types::DataType::STRING, types::DataType::INT64));
+}
+
+TEST(ScalarUDF, exec_batch_arrow) {
+  // Enough long strings to make the writer grow the output data buffer a few times.
+  std::vector<types::StringValue> strs;
+  std::vector<types::Int64Value> lens;
+  for (int64_t i = 0; i < 1000; ++i) {
+    strs.emplace_back(std::string(100, static_cast<char>('a' + i % 26)));
+    lens.emplace_back(i % 120);
+  }
+  auto str_arr = types::ToArrow(strs, arrow::default_memory_pool());
+  auto len_arr = types::ToArrow(lens, arrow::default_memory_pool());
+  std::vector<arrow::Array*> inputs{str_arr.get(), len_arr.get()};
+
+  PrefixBatchUDF udf;
+  arrow::StringBuilder batch_builder;
+  ASSERT_OK(ScalarUDFWrapper<PrefixBatchUDF>::ExecBatchArrow(&udf, nullptr, inputs,
+                                                             &batch_builder, strs.size()));
+  EXPECT_EQ(1, udf.exec_batch_calls);
+  EXPECT_EQ(0, udf.exec_calls);
+
+  arrow::StringBuilder row_builder;
+  ASSERT_OK(ScalarUDFWrapper<PrefixBatchUDF>::ExecBatchArrowPerRow(&udf, nullptr, inputs,
+                                                                   &row_builder, strs.size()));
+  EXPECT_EQ(1, udf.exec_batch_calls);
+  EXPECT_EQ(1000, udf.exec_calls);
+
+  std::shared_ptr<arrow::Array> batch_out;
+  std::shared_ptr<arrow::Array> row_out;
+  ASSERT_TRUE(batch_builder.Finish(&batch_out).ok());
+  ASSERT_TRUE(row_builder.Finish(&row_out).ok());
+  ASSERT_EQ(1000, batch_out->length());
+  EXPECT_TRUE(batch_out->Equals(row_out));
+  EXPECT_EQ(std::string(27, 'b'),
+            types::GetValueFromArrowArray<types::DataType::STRING>(batch_out.get(), 27));
+}
+
+TEST(ScalarUDF, exec_batch_column_wrapper) {
+  types::StringValueColumnWrapper strs(std::vector<types::StringValue>{"abc", "defg", "", "hi"});
+  types::Int64ValueColumnWrapper lens(std::vector<types::Int64Value>{2, 10, 1, 0});
+  std::vector<const types::ColumnWrapper*> inputs{&strs, &lens};
+
+  PrefixBatchUDF udf;
+  types::StringValueColumnWrapper out(4);
+  ASSERT_OK(ScalarUDFWrapper<PrefixBatchUDF>::ExecBatch(&udf, nullptr, inputs, &out, 4));
+  EXPECT_EQ(1, udf.exec_batch_calls);
+  EXPECT_EQ(0, udf.exec_calls);
+  EXPECT_EQ("ab", out[0]);
+  EXPECT_EQ("defg", out[1]);
+  EXPECT_EQ("", out[2]);
+  EXPECT_EQ("", out[3]);
+}
+
 TEST(UDFDataTypes, valid_tests) {
   EXPECT_TRUE((true == types::IsValidValueType<types::BoolValue>::value));
   EXPECT_TRUE((true == types::IsValidValueType<types::Int64Value>::value));
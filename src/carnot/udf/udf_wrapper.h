@@ -21,6 +21,7 @@
 #include <arrow/array.h>
 
 #include <memory>
+#include <new>
 #include <string>
 #include <vector>
 
@@ -35,11 +36,6 @@ namespace px {
 namespace carnot {
 namespace udf {
 
-// This is the size we assume for an "average" string. If this is too large we waste
-// memory, if too small we spend more time allocating. Since we use exponential doubling
-// it's better to keep this number small.
-const int kStringAssumedSizeHeuristic = 10;
-
 // This function takes in a generic types::BaseValueType and then converts it to actual
 // UDFValue type. This function is unsafe and will produce wrong results (or crash)
 // if used incorrectly.
@@ -133,6 +129,35 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
   return Status::OK();
 }
 
+/**
+ * This is the inner wrapper for UDFs that implement ExecBatch. It wraps every input in a
+ * ColumnView and the output in a ColumnWriter, and calls ExecBatch once for the whole batch.
+ */
+template <typename TUDF, std::size_t... I>
+Status ExecBatchViewWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count,
+                                 arrow::ArrayBuilder* out, const std::vector<arrow::Array*>& args,
+                                 std::index_sequence<I...>) {
+  [[maybe_unused]] static constexpr auto exec_argument_types =
+      ScalarUDFTraits<TUDF>::ExecArguments();
+  constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+  auto writer = ColumnWriter<return_type>::ToArrow(out, count);
+  return udf->ExecBatch(
+      ctx, ColumnView<exec_argument_types[I]>::FromArrow(args[I], count)..., &writer);
+}
+
+template <typename TUDF, std::size_t... I>
+Status ExecBatchViewWrapper(TUDF* udf, FunctionContext* ctx, size_t count,
+                            types::ColumnWrapper* out,
+                            const std::vector<const types::ColumnWrapper*>& args,
+                            std::index_sequence<I...>) {
+  [[maybe_unused]] static constexpr auto exec_argument_types =
+      ScalarUDFTraits<TUDF>::ExecArguments();
+  constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+  auto writer = ColumnWriter<return_type>::ToColumnWrapper(out);
+  return udf->ExecBatch(
+      ctx, ColumnView<exec_argument_types[I]>::FromColumnWrapper(args[I], count)..., &writer);
+}
+
 /**
  * Checks types between column wrapper and array of types::UDFDataTypes.
  * @return true if all types match.
@@ -178,6 +203,9 @@ struct ScalarUDFWrapper {
    * type. This function is unsafe and will perform unsafe casts and using an incorrect
    * type will result in a crash!
    *
+   * If the UDF implements ExecBatch it is called once for the batch, otherwise Exec is called
+   * once per row.
+   *
    * @note This function and underlying templates are fully expanded at compile time.
    *
    * @param udf a pointer to the UDF.
@@ -190,6 +218,25 @@ struct ScalarUDFWrapper {
   static Status ExecBatchArrow(ScalarUDF* udf, FunctionContext* ctx,
                                const std::vector<arrow::Array*>& inputs,
                                arrow::ArrayBuilder* output, int count) {
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+      DCHECK(output != nullptr);
+      DCHECK(inputs.size() == exec_argument_types.size());
+      return ExecBatchViewWrapperArrow<TUDF>(
+          static_cast<TUDF*>(udf), ctx, count, output, inputs,
+          std::make_index_sequence<exec_argument_types.size()>{});
+    } else {
+      return ExecBatchArrowPerRow(udf, ctx, inputs, output, count);
+    }
+  }
+
+  /**
+   * Same as ExecBatchArrow, but always calls Exec once per row, even if the UDF implements
+   * ExecBatch.
+   */
+  static Status ExecBatchArrowPerRow(ScalarUDF* udf, FunctionContext* ctx,
+                                     const std::vector<arrow::Array*>& inputs,
+                                     arrow::ArrayBuilder* output, int count) {
     constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
     auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
 
@@ -215,6 +262,9 @@ struct ScalarUDFWrapper {
    * type. This function is unsafe and will perform unsafe casts and using an incorrect
    * type will result in a crash!
    *
+   * If the UDF implements ExecBatch it is called once for the batch, otherwise Exec is called
+   * once per row.
+   *
    * @note This function and underlying templates are fully expanded at compile time.
    *
    * @param udf a pointer to the UDF.
@@ -227,6 +277,23 @@ struct ScalarUDFWrapper {
   static Status ExecBatch(ScalarUDF* udf, FunctionContext* ctx,
                           const std::vector<const types::ColumnWrapper*>& inputs,
                           types::ColumnWrapper* output, int count) {
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+      DCHECK(output != nullptr);
+      DCHECK(CheckTypes(inputs, exec_argument_types));
+      return ExecBatchViewWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, output, inputs,
+                                        std::make_index_sequence<exec_argument_types.size()>{});
+    } else {
+      return ExecBatchPerRow(udf, ctx, inputs, output, count);
+    }
+  }
+
+  /**
+   * Same as ExecBatch, but always calls Exec once per row, even if the UDF implements ExecBatch.
+   */
+  static Status ExecBatchPerRow(ScalarUDF* udf, FunctionContext* ctx,
+                                const std::vector<const types::ColumnWrapper*>& inputs,
+                                types::ColumnWrapper* output, int count) {
     // Check that output is allocated.
     DCHECK(output != nullptr);
     // Check that the arity is correct.
@@ -325,6 +392,13 @@ struct UDAWrapper {
    */
   static std::unique_ptr<UDA> Make() { return std::make_unique<TUDA>(); }
 
+  /**
+   * Create a new UDA in the given storage, which must be at least sizeof(TUDA) bytes large and
+   * aligned to alignof(TUDA). The caller destroys the UDA, through its virtual destructor.
+   * @return A pointer to the UDA instance.
+   */
+  static UDA* MakeAt(void* storage) { return new (storage) TUDA(); }
+
   /**
    * Perform a batch update of the passed in UDA based in the inputs.
    * @param uda The UDA instances.
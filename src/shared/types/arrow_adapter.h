@@ -141,7 +141,32 @@ constexpr auto GetValueFromArrowArray(const arrow::Array* arg, int64_t idx) {
   return GetValue(static_cast<const arrow_array_type*>(arg), idx);
 }
 
+/**
+ * Makes a dictionary encoded STRING column, whose rows hold int32 codes into the given dictionary
+ * of strings.
+ */
+inline std::shared_ptr<arrow::Array> MakeStringDictionaryArray(
+    const std::shared_ptr<arrow::Array>& codes, const std::shared_ptr<arrow::Array>& dictionary) {
+  DCHECK(codes->type_id() == arrow::Type::INT32);
+  DCHECK(dictionary->type_id() == arrow::Type::STRING);
+  return std::make_shared<arrow::DictionaryArray>(arrow::dictionary(arrow::int32(), arrow::utf8()),
+                                                  codes, dictionary);
+}
+
+/**
+ * The dictionary code of a row of a column made by MakeStringDictionaryArray.
+ */
+inline int32_t GetDictionaryCode(const arrow::DictionaryArray* arr, int64_t idx) {
+  return static_cast<const arrow::Int32Array*>(arr->indices().get())->Value(idx);
+}
+
+// Reads STRING columns, including dictionary encoded ones.
 inline std::string_view GetStringViewFromArrowArray(const arrow::Array* arr, int64_t idx) {
+  if (arr->type_id() == arrow::Type::DICTIONARY) {
+    const auto* dict_arr = static_cast<const arrow::DictionaryArray*>(arr);
+    return GetStringViewFromArrowArray(dict_arr->dictionary().get(),
+                                       GetDictionaryCode(dict_arr, idx));
+  }
   DCHECK(arr->type_id() == arrow::Type::STRING);
   auto arrow_string_view = static_cast<const arrow::StringArray*>(arr)->GetView(idx);
   return std::string_view(arrow_string_view.data(), arrow_string_view.size());
@@ -157,7 +182,7 @@ inline int64_t GetArrowArrayBytes<types::DataType::STRING>(const arrow::Array* a
   int64_t total_bytes = 0;
   // Loop through each string in the Arrow array.
   for (int64_t i = 0; i < arr->length(); i++) {
-    total_bytes += sizeof(char) * GetValueFromArrowArray<types::DataType::STRING>(arr, i).length();
+    total_bytes += sizeof(char) * GetStringViewFromArrowArray(arr, i).length();
   }
   return total_bytes;
 }
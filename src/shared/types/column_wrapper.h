@@ -351,8 +351,14 @@ struct ColumnWrapperType<DataType::STRING> {
 
 template <types::DataType DT>
 void ExtractValueToColumnWrapper(ColumnWrapper* wrapper, arrow::Array* arr, int64_t row_idx) {
-  static_cast<typename ColumnWrapperType<DT>::type*>(wrapper)->Append(
-      types::GetValueFromArrowArray<DT>(arr, row_idx));
+  if constexpr (DT == DataType::STRING) {
+    // STRING columns may be dictionary encoded.
+    static_cast<StringValueColumnWrapper*>(wrapper)->Append(
+        StringValue(std::string(types::GetStringViewFromArrowArray(arr, row_idx))));
+  } else {
+    static_cast<typename ColumnWrapperType<DT>::type*>(wrapper)->Append(
+        types::GetValueFromArrowArray<DT>(arr, row_idx));
+  }
 }
 
 template <types::DataType T>
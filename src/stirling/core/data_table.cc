@@ -33,6 +33,20 @@ namespace stirling {
 using types::ColumnWrapper;
 using types::DataType;
 
+namespace {
+
+template <typename TValueType>
+void MoveAppend(ColumnWrapper* src, ColumnWrapper* dst) {
+  auto* typed_src = static_cast<types::ColumnWrapperTmpl<TValueType>*>(src);
+  auto* typed_dst = static_cast<types::ColumnWrapperTmpl<TValueType>*>(dst);
+  for (size_t i = 0; i < typed_src->Size(); ++i) {
+    typed_dst->Append(std::move((*typed_src)[i]));
+  }
+  typed_src->Clear();
+}
+
+}  // namespace
+
 DataTable::DataTable(uint64_t id, const DataTableSchema& schema) : id_(id), table_schema_(schema) {}
 
 void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
@@ -59,6 +73,31 @@ Tablet* DataTable::GetTablet(types::TabletIDView tablet_id) {
   return &tablet;
 }
 
+void DataTable::MoveRecordsFrom(DataTable* other) {
+  DCHECK_EQ(table_schema_.name(), other->table_schema_.name());
+
+  for (auto& [tablet_id, other_tablet] : other->tablets_) {
+    if (other_tablet.times.empty()) {
+      continue;
+    }
+
+    Tablet* tablet = GetTablet(tablet_id);
+    tablet->times.insert(tablet->times.end(), other_tablet.times.begin(),
+                         other_tablet.times.end());
+    // Only the contents are cleared, so the other table keeps its reserved buffers.
+    other_tablet.times.clear();
+
+    for (size_t i = 0; i < tablet->records.size(); ++i) {
+      DataType type = table_schema_.elements()[i].type();
+#define TYPE_CASE(_dt_) \
+  MoveAppend<types::DataTypeTraits<_dt_>::value_type>(other_tablet.records[i].get(), \
+                                                      tablet->records[i].get());
+      PX_SWITCH_FOREACH_DATATYPE(type, TYPE_CASE);
+#undef TYPE_CASE
+    }
+  }
+}
+
 std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
   std::vector<TaggedRecordBatch> tablets_out;
   absl::flat_hash_map<types::TabletID, Tablet> carryover_tablets;
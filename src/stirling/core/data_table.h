@@ -80,6 +80,15 @@ class DataTable : public NotCopyable {
     if (cutoff_time_.has_value()) {
       DCHECK(cutoff_time >= cutoff_time_);
     }
+
+  /**
+   * Moves the buffered records of another table with the same schema into this one, and leaves
+   * the other table empty. The records are ordered with the records of this table, by their time,
+   * when they are consumed.
+   *
+   * @param other The table whose records are moved.
+   */
+  void MoveRecordsFrom(DataTable* other);
     cutoff_time_ = cutoff_time;
   }
 
@@ -314,6 +314,39 @@ TEST_F(DataTableTest, Carryover) {
   }
 }
 
+TEST_F(DataTableTest, MoveRecordsFrom) {
+  DataTable other_table(/*id*/ 0, kSchema);
+
+  std::vector<int> time_vals = {0, 10, 40, 20, 30, 50};
+  std::vector<std::string> s_vals = {"a", "b", "e", "c", "d", "f"};
+  for (size_t i = 0; i < time_vals.size(); ++i) {
+    // Alternate between the tables.
+    DataTable* table = (i % 2 == 0) ? data_table_.get() : &other_table;
+    DataTable::RecordBuilder<&kSchema> r(table, time_vals[i]);
+    r.Append<r.ColIndex("time_")>(time_vals[i]);
+    r.Append<r.ColIndex("x")>(time_vals[i] / 10);
+    r.Append<r.ColIndex("s")>(s_vals[i]);
+  }
+
+  data_table_->MoveRecordsFrom(&other_table);
+  EXPECT_EQ(data_table_->Occupancy(), 6);
+  EXPECT_EQ(other_table.Occupancy(), 0);
+  EXPECT_TRUE(other_table.ConsumeRecords().empty());
+
+  // The moved records are sorted with the others, and respect the cutoff time.
+  data_table_->SetConsumeRecordsCutoffTime(40);
+  std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+  ASSERT_EQ(rb[0]->Size(), 5);
+  for (size_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(i), 10 * static_cast<int>(i));
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(i), static_cast<int>(i));
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(i), std::string(1, 'a' + i));
+  }
+  EXPECT_EQ(data_table_->Occupancy(), 1);
+}
+
 class DataTableStressTest : public ::testing::Test {
  private:
   std::default_random_engine rng_;
@@ -140,24 +140,24 @@ void ConnTracker::AddConnCloseEvent(const socket_control_event_t& event) {
   MarkForDeath();
 }
 
-void ConnTracker::AddDataEvent(std::unique_ptr<SocketDataEvent> event) {
-  SetRole(event->attr.role, "inferred from data_event");
-  SetProtocol(event->attr.protocol, "inferred from data_event");
-  SetSSL(event->attr.ssl, "inferred from data_event");
+void ConnTracker::AddDataEvent(const SocketDataEvent& event) {
+  SetRole(event.attr.role, "inferred from data_event");
+  SetProtocol(event.attr.protocol, "inferred from data_event");
+  SetSSL(event.attr.ssl, "inferred from data_event");
 
   CheckTracker();
-  UpdateTimestamps(event->attr.timestamp_ns);
-  UpdateDataStats(*event);
+  UpdateTimestamps(event.attr.timestamp_ns);
+  UpdateDataStats(event);
 
-  CONN_TRACE(1) << absl::Substitute("Data event: $0", event->ToString());
+  CONN_TRACE(1) << absl::Substitute("Data event: $0", event.ToString());
 
   // TODO(yzhao): Change to let userspace resolve the connection type and signal back to BPF.
   // Then we need at least one data event to let ConnTracker know the field descriptor.
-  if (event->attr.protocol == kProtocolUnknown) {
+  if (event.attr.protocol == kProtocolUnknown) {
     return;
   }
 
-  if (event->attr.protocol != protocol_) {
+  if (event.attr.protocol != protocol_) {
     return;
   }
 
@@ -166,12 +166,12 @@ void ConnTracker::AddDataEvent(std::unique_ptr<SocketDataEvent> event) {
     return;
   }
 
-  switch (event->attr.direction) {
+  switch (event.attr.direction) {
     case traffic_direction_t::kEgress: {
-      send_data_.AddData(std::move(event));
+      send_data_.AddData(event);
     } break;
     case traffic_direction_t::kIngress: {
-      recv_data_.AddData(std::move(event));
+      recv_data_.AddData(event);
     } break;
   }
 }
@@ -318,14 +318,14 @@ void ConnTracker::AddHTTP2Header(std::unique_ptr<HTTP2HeaderEvent> hdr) {
   half_stream_ptr->UpdateTimestamp(hdr->attr.timestamp_ns);
 }
 
-void ConnTracker::AddHTTP2Data(std::unique_ptr<HTTP2DataEvent> data) {
+void ConnTracker::AddHTTP2Data(const HTTP2DataEvent& data) {
   SetProtocol(kProtocolHTTP2, "inferred from http2 data");
 
   if (protocol_ != kProtocolHTTP2) {
     return;
   }
 
-  CONN_TRACE(1) << absl::Substitute("HTTP2 data event: $0", data->ToString());
+  CONN_TRACE(1) << absl::Substitute("HTTP2 data event: $0", data.ToString());
 
   if (conn_id_.fd == 0) {
     Disable(
@@ -342,14 +342,14 @@ void ConnTracker::AddHTTP2Data(std::unique_ptr<HTTP2DataEvent> data) {
   CheckTracker();
 
   // Don't trace any control messages.
-  if (data->attr.stream_id == 0) {
+  if (data.attr.stream_id == 0) {
     return;
   }
 
-  UpdateTimestamps(data->attr.timestamp_ns);
+  UpdateTimestamps(data.attr.timestamp_ns);
 
   bool write_event = false;
-  switch (data->attr.event_type) {
+  switch (data.attr.event_type) {
     case grpc_event_type_t::kDataFrameEventWrite:
       write_event = true;
       break;
@@ -361,23 +361,23 @@ void ConnTracker::AddHTTP2Data(std::unique_ptr<HTTP2DataEvent> data) {
       return;
   }
 
-  protocols::http2::HalfStream* half_stream_ptr = HalfStreamPtr(data->attr.stream_id, write_event);
+  protocols::http2::HalfStream* half_stream_ptr = HalfStreamPtr(data.attr.stream_id, write_event);
 
   // Note: Duplicate calls to the writeHeaders have been observed (though they are rare).
   // It is not yet known if duplicate data also occurs. This log will help us figure out if such
   // cases exist. Note that the duplicates are not related to the end_stream flag being set;
   // the end_stream cases are just the easiest to detect.
-  if (half_stream_ptr->end_stream() && data->attr.end_stream) {
+  if (half_stream_ptr->end_stream() && data.attr.end_stream) {
     CONN_TRACE(1) << absl::Substitute(
-        "Duplicate end_stream flag in data. stream_id: $0, conn_id: $1", data->attr.stream_id,
-        ::ToString(data->attr.conn_id));
+        "Duplicate end_stream flag in data. stream_id: $0, conn_id: $1", data.attr.stream_id,
+        ::ToString(data.attr.conn_id));
   }
 
-  half_stream_ptr->AddData(data->payload);
-  if (data->attr.end_stream) {
+  half_stream_ptr->AddData(data.payload);
+  if (data.attr.end_stream) {
     half_stream_ptr->AddEndStream();
   }
-  half_stream_ptr->UpdateTimestamp(data->attr.timestamp_ns);
+  half_stream_ptr->UpdateTimestamp(data.attr.timestamp_ns);
 }
 
 template <>
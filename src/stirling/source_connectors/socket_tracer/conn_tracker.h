@@ -208,9 +208,11 @@ class ConnTracker : NotCopyMoveable {
   /**
    * Registers a BPF data event into the tracker.
    *
-   * @param event The data event from BPF.
+   * @param event The data event from BPF. Its msg is copied into the data stream, and may point
+   *              straight into the perf buffer.
    */
-  void AddDataEvent(std::unique_ptr<SocketDataEvent> event);
+  void AddDataEvent(const SocketDataEvent& event);
+  void AddDataEvent(std::unique_ptr<SocketDataEvent> event) { AddDataEvent(*event); }
 
   /**
    * Registers a BPF connection stats event into the tracker.
@@ -235,7 +237,8 @@ class ConnTracker : NotCopyMoveable {
    *
    * @param data The event from BPF uprobe.
    */
-  void AddHTTP2Data(std::unique_ptr<HTTP2DataEvent> data);
+  void AddHTTP2Data(const HTTP2DataEvent& data);
+  void AddHTTP2Data(std::unique_ptr<HTTP2DataEvent> data) { AddHTTP2Data(*data); }
 
   /**
    * Attempts to infer the remote endpoint of a connection.
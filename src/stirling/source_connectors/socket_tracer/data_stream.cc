@@ -46,12 +46,12 @@ DEFINE_uint32(
 namespace px {
 namespace stirling {
 
-void DataStream::AddData(std::unique_ptr<SocketDataEvent> event) {
-  LOG_IF(WARNING, event->attr.msg_size > event->msg.size() && !event->msg.empty())
+void DataStream::AddData(const SocketDataEvent& event) {
+  LOG_IF(WARNING, event.attr.msg_size > event.msg.size() && !event.msg.empty())
       << absl::Substitute("Message truncated, original size: $0, transferred size: $1",
-                          event->attr.msg_size, event->msg.size());
+                          event.attr.msg_size, event.msg.size());
 
-  data_buffer_.Add(event->attr.pos, event->msg, event->attr.timestamp_ns);
+  data_buffer_.Add(event.attr.pos, event.msg, event.attr.timestamp_ns);
 
   has_new_events_ = true;
 }
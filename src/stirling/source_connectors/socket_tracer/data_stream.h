@@ -56,9 +56,11 @@ class DataStream : NotCopyMoveable {
       : data_buffer_(spike_capacity, max_gap_size, allow_before_gap_size) {}
 
   /**
-   * Adds a raw (unparsed) chunk of data into the stream.
+   * Adds a raw (unparsed) chunk of data into the stream. The bytes of the event are copied into
+   * the stream, so the event does not need to outlive the call.
    */
-  void AddData(std::unique_ptr<SocketDataEvent> event);
+  void AddData(const SocketDataEvent& event);
+  void AddData(std::unique_ptr<SocketDataEvent> event) { AddData(*event); }
 
   /**
    * Parses as many messages as it can from the raw events into the messages container.
@@ -17,6 +17,7 @@
  */
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -70,6 +71,9 @@ SocketTracerMetrics::SocketTracerMetrics(prometheus::Registry* registry,
 
 namespace {
 
+// The connection trackers may be processed by multiple threads, see
+// --stirling_conn_tracker_threads.
+std::mutex g_protocol_metrics_mutex;
 std::unordered_map<metrics_key, std::unique_ptr<SocketTracerMetrics>> g_protocol_metrics;
 
 void ResetProtocolMetrics(traffic_protocol_t protocol, bool tls) {
@@ -82,6 +86,7 @@ void ResetProtocolMetrics(traffic_protocol_t protocol, bool tls) {
 SocketTracerMetrics& SocketTracerMetrics::GetProtocolMetrics(traffic_protocol_t protocol,
                                                              bool tls) {
   std::pair<traffic_protocol_t, bool> key = {protocol, tls};
+  std::lock_guard<std::mutex> lock(g_protocol_metrics_mutex);
   if (g_protocol_metrics.find(key) == g_protocol_metrics.end()) {
     ResetProtocolMetrics(protocol, tls);
   }
@@ -89,6 +94,7 @@ SocketTracerMetrics& SocketTracerMetrics::GetProtocolMetrics(traffic_protocol_t
 }
 
 void SocketTracerMetrics::TestOnlyResetProtocolMetrics(traffic_protocol_t protocol, bool tls) {
+  std::lock_guard<std::mutex> lock(g_protocol_metrics_mutex);
   ResetProtocolMetrics(protocol, tls);
 }
 
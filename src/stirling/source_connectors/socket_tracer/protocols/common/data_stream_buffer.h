@@ -27,6 +27,7 @@
 #include "src/common/base/base.h"
 
 DECLARE_bool(stirling_data_stream_buffer_always_contiguous_buffer);
+DECLARE_bool(stirling_data_stream_buffer_mirrored_ring_buffer);
 
 namespace px {
 namespace stirling {
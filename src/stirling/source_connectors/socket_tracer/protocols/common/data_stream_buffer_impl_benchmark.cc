@@ -24,6 +24,7 @@
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/always_contiguous_data_stream_buffer_impl.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/lazy_contiguous_data_stream_buffer_impl.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/mirrored_ring_data_stream_buffer_impl.h"
 
 template <typename TDataStreamBufferImpl>
 // NOLINTNEXTLINE : runtime/references.
@@ -231,6 +232,7 @@ static void BM_RemovePrefix(benchmark::State& state) {
 
 using px::stirling::protocols::AlwaysContiguousDataStreamBufferImpl;
 using px::stirling::protocols::LazyContiguousDataStreamBufferImpl;
+using px::stirling::protocols::MirroredRingDataStreamBufferImpl;
 
 BENCHMARK_TEMPLATE(BM_ContiguousBytes, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -238,9 +240,13 @@ BENCHMARK_TEMPLATE(BM_ContiguousBytes, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_ContiguousBytes, AlwaysContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_ContiguousBytes, MirroredRingDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_TEMPLATE(BM_SingleAdd, LazyContiguousDataStreamBufferImpl)->Range(1024, 32 * 1024);
 BENCHMARK_TEMPLATE(BM_SingleAdd, AlwaysContiguousDataStreamBufferImpl)->Range(1024, 32 * 1024);
+BENCHMARK_TEMPLATE(BM_SingleAdd, MirroredRingDataStreamBufferImpl)->Range(1024, 32 * 1024);
 
 BENCHMARK_TEMPLATE(BM_OoOBytes, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -248,6 +254,9 @@ BENCHMARK_TEMPLATE(BM_OoOBytes, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_OoOBytes, AlwaysContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_OoOBytes, MirroredRingDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_TEMPLATE(BM_OverrunCapacity, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -255,6 +264,9 @@ BENCHMARK_TEMPLATE(BM_OverrunCapacity, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_OverrunCapacity, AlwaysContiguousDataStreamBufferImpl)
     ->Range(32 * 1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_OverrunCapacity, MirroredRingDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_TEMPLATE(BM_LargeGap, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -262,6 +274,9 @@ BENCHMARK_TEMPLATE(BM_LargeGap, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_LargeGap, AlwaysContiguousDataStreamBufferImpl)
     ->Range(32 * 1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_LargeGap, MirroredRingDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_TEMPLATE(BM_RemovePrefix, LazyContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
@@ -269,3 +284,6 @@ BENCHMARK_TEMPLATE(BM_RemovePrefix, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_RemovePrefix, AlwaysContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_RemovePrefix, MirroredRingDataStreamBufferImpl)
+    ->Range(1024, 32 * 1024)
+    ->Unit(benchmark::kMillisecond);
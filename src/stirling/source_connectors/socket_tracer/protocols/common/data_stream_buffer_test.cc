@@ -17,6 +17,7 @@
  */
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/data_stream_buffer.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/mirrored_ring_data_stream_buffer_impl.h"
 
 #include "src/common/testing/testing.h"
 
@@ -24,18 +25,46 @@ namespace px {
 namespace stirling {
 namespace protocols {
 
-class DataStreamBufferTest : public ::testing::TestWithParam<bool> {
+enum class BufferImpl {
+  kAlwaysContiguous,
+  kLazyContiguous,
+  kMirroredRing,
+  // The mirrored ring implementation, with none of its rings mapped.
+  kMirroredRingOnHeap,
+};
+
+class DataStreamBufferTest : public ::testing::TestWithParam<BufferImpl> {
  protected:
   void SetUp() override {
-    old_flag_val_ = FLAGS_stirling_data_stream_buffer_always_contiguous_buffer;
-    FLAGS_stirling_data_stream_buffer_always_contiguous_buffer = GetParam();
+    old_always_contiguous_flag_val_ = FLAGS_stirling_data_stream_buffer_always_contiguous_buffer;
+    old_mirrored_ring_flag_val_ = FLAGS_stirling_data_stream_buffer_mirrored_ring_buffer;
+    old_mirrored_ring_min_size_flag_val_ = FLAGS_stirling_data_stream_buffer_mirrored_ring_min_size;
+    old_max_mirrored_rings_flag_val_ = FLAGS_stirling_data_stream_buffer_max_mirrored_rings;
+    FLAGS_stirling_data_stream_buffer_always_contiguous_buffer =
+        GetParam() == BufferImpl::kAlwaysContiguous;
+    FLAGS_stirling_data_stream_buffer_mirrored_ring_buffer =
+        GetParam() == BufferImpl::kMirroredRing || GetParam() == BufferImpl::kMirroredRingOnHeap;
+    // The buffers of these tests are small, so map them regardless of their size.
+    FLAGS_stirling_data_stream_buffer_mirrored_ring_min_size = 0;
+    if (GetParam() == BufferImpl::kMirroredRingOnHeap) {
+      FLAGS_stirling_data_stream_buffer_max_mirrored_rings = 0;
+    }
   }
   void TearDown() override {
-    FLAGS_stirling_data_stream_buffer_always_contiguous_buffer = old_flag_val_;
+    FLAGS_stirling_data_stream_buffer_always_contiguous_buffer = old_always_contiguous_flag_val_;
+    FLAGS_stirling_data_stream_buffer_mirrored_ring_buffer = old_mirrored_ring_flag_val_;
+    FLAGS_stirling_data_stream_buffer_mirrored_ring_min_size = old_mirrored_ring_min_size_flag_val_;
+    FLAGS_stirling_data_stream_buffer_max_mirrored_rings = old_max_mirrored_rings_flag_val_;
   }
 
+  // The always contiguous and the mirrored ring implementations keep gaps in the buffer.
+  bool BufferIncludesGaps() const { return GetParam() != BufferImpl::kLazyContiguous; }
+
  private:
-  bool old_flag_val_;
+  bool old_always_contiguous_flag_val_;
+  bool old_mirrored_ring_flag_val_;
+  uint64_t old_mirrored_ring_min_size_flag_val_;
+  uint64_t old_max_mirrored_rings_flag_val_;
 };
 
 TEST_P(DataStreamBufferTest, AddAndGet) {
@@ -197,10 +226,10 @@ TEST_P(DataStreamBufferTest, SizeAndGetPos) {
   // Add event with a gap.
   stream_buffer.Add(8, "89", 8);
   EXPECT_EQ(stream_buffer.position(), 0);
-  // size() is different between the two current implementations (the new impl does not
-  // include the gap in size, the old one does).
+  // size() is different between the current implementations (the lazy impl does not
+  // include the gap in size, the others do).
   // TODO(james): remove one of the two checks when we settle on an implementation.
-  if (FLAGS_stirling_data_stream_buffer_always_contiguous_buffer) {
+  if (BufferIncludesGaps()) {
     EXPECT_EQ(stream_buffer.size(), 10);
   } else {
     EXPECT_EQ(stream_buffer.size(), 6);
@@ -250,10 +279,10 @@ TEST_P(DataStreamBufferTest, LargeGap) {
   // Add event with gap larger than max_gap_size.
   stream_buffer.Add(100, "abcd", 20);
 
-  // These tests only apply to the old implementation, the new implementation will keep all of this
-  // data in its buffer, since it doesn't allocate gaps.
+  // These tests don't apply to the lazy implementation, which will keep all of this data in its
+  // buffer, since it doesn't allocate gaps.
   // TODO(james): remove when we settle on an implementation.
-  if (FLAGS_stirling_data_stream_buffer_always_contiguous_buffer) {
+  if (BufferIncludesGaps()) {
     EXPECT_EQ(stream_buffer.size(), 4 + kAllowBeforeGapSize);
 
     // Add event more than allow_before_gap_size before the last event. This event should not be
@@ -268,16 +297,69 @@ TEST_P(DataStreamBufferTest, LargeGap) {
   }
 }
 
+// With 4KB pages, the events in this test wrap around the end of the mirrored ring.
+TEST_P(DataStreamBufferTest, WrapAround) {
+  const size_t kCapacity = 4096;
+  DataStreamBuffer stream_buffer(kCapacity, kCapacity, 0);
+
+  std::string data(1000, 'a');
+  size_t pos = 0;
+  for (char c = 'a'; c <= 'z'; ++c) {
+    data.assign(1000, c);
+    stream_buffer.Add(pos, data, pos);
+    pos += data.size();
+    EXPECT_EQ(stream_buffer.Head().substr(stream_buffer.Head().size() - data.size()), data);
+
+    // Keep a partial event at the head, so that the next one ends up in front of it.
+    stream_buffer.RemovePrefix(stream_buffer.size() - 500);
+    EXPECT_EQ(stream_buffer.Head(), std::string(500, c));
+    EXPECT_OK_AND_EQ(stream_buffer.GetTimestamp(pos - 1), pos - data.size());
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(DataStreamBufferImplTest, DataStreamBufferTest,
-                         ::testing::Values(true, false),
+                         ::testing::Values(BufferImpl::kAlwaysContiguous,
+                                           BufferImpl::kLazyContiguous, BufferImpl::kMirroredRing,
+                                           BufferImpl::kMirroredRingOnHeap),
                          [](const ::testing::TestParamInfo<DataStreamBufferTest::ParamType>& info) {
-                           if (info.param) {
-                             return "AlwaysContiguousImpl";
-                           } else {
-                             return "LazyContiguousImpl";
+                           switch (info.param) {
+                             case BufferImpl::kAlwaysContiguous:
+                               return "AlwaysContiguousImpl";
+                             case BufferImpl::kLazyContiguous:
+                               return "LazyContiguousImpl";
+                             case BufferImpl::kMirroredRing:
+                               return "MirroredRingImpl";
+                             case BufferImpl::kMirroredRingOnHeap:
+                               return "MirroredRingOnHeapImpl";
                            }
+                           return "";
                          });
 
+TEST(MirroredRingDataStreamBufferImplTest, LimitsMappedRings) {
+  const uint64_t old_min_size = FLAGS_stirling_data_stream_buffer_mirrored_ring_min_size;
+  const uint64_t old_max_rings = FLAGS_stirling_data_stream_buffer_max_mirrored_rings;
+  FLAGS_stirling_data_stream_buffer_mirrored_ring_min_size = 0;
+  FLAGS_stirling_data_stream_buffer_max_mirrored_rings = 1;
+
+  MirroredRingDataStreamBufferImpl buffer1(1 << 16, 1 << 16, 0);
+  MirroredRingDataStreamBufferImpl buffer2(1 << 16, 1 << 16, 0);
+  buffer1.Add(0, "abc", 0);
+  buffer2.Add(0, "def", 0);
+  EXPECT_THAT(buffer1.DebugInfo(), ::testing::HasSubstr("Mapped: true"));
+  EXPECT_THAT(buffer2.DebugInfo(), ::testing::HasSubstr("Mapped: false"));
+  EXPECT_EQ(buffer1.Head(), "abc");
+  EXPECT_EQ(buffer2.Head(), "def");
+
+  // Once the first ring is released, the second buffer maps its ring when it grows.
+  buffer1.Reset();
+  buffer2.Add(3, std::string(1 << 15, 'g'), 3);
+  EXPECT_THAT(buffer2.DebugInfo(), ::testing::HasSubstr("Mapped: true"));
+  EXPECT_EQ(buffer2.Head(), absl::StrCat("def", std::string(1 << 15, 'g')));
+
+  FLAGS_stirling_data_stream_buffer_mirrored_ring_min_size = old_min_size;
+  FLAGS_stirling_data_stream_buffer_max_mirrored_rings = old_max_rings;
+}
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
@@ -0,0 +1,546 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/mirrored_ring_data_stream_buffer_impl.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include "src/common/base/defer.h"
+
+DEFINE_uint64(stirling_data_stream_buffer_mirrored_ring_min_size, 64 * 1024,
+              "Mirrored ring data stream buffers smaller than this many bytes are kept on the heap "
+              "instead of being mapped, since mapping a ring is slow.");
+DEFINE_uint64(stirling_data_stream_buffer_max_mirrored_rings, 4096,
+              "The maximum number of rings that mirrored ring data stream buffers map at a time. "
+              "Each ring uses a few memory mappings, which count towards vm.max_map_count. "
+              "Buffers beyond the limit are kept on the heap.");
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+namespace {
+
+// Get element <= key in a map.
+template <typename TMapType>
+auto MapLE(TMapType& map, size_t key) -> decltype(map.begin()) {
+  auto iter = map.upper_bound(key);
+  if (iter == map.begin()) {
+    return map.end();
+  }
+  --iter;
+
+  return iter;
+}
+
+size_t PageSize() {
+  static const size_t kPageSize = sysconf(_SC_PAGESIZE);
+  return kPageSize;
+}
+
+// Maps size bytes of memory twice, back to back, so that ring[i + size] is the same byte as
+// ring[i]. The size must be a multiple of the page size.
+StatusOr<char*> MapMirroredRing(size_t size) {
+  int fd = memfd_create("data_stream_buffer", MFD_CLOEXEC);
+  if (fd < 0) {
+    return error::Internal("Could not create the ring buffer file: $0", std::strerror(errno));
+  }
+  // The mappings keep the file alive.
+  DEFER(close(fd));
+
+  if (ftruncate(fd, size) != 0) {
+    return error::Internal("Could not resize the ring buffer file: $0", std::strerror(errno));
+  }
+
+  // Reserve the address range of both mappings first, so that they are adjacent.
+  void* addr = mmap(nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED) {
+    return error::Internal("Could not reserve the ring buffer: $0", std::strerror(errno));
+  }
+
+  char* ring = static_cast<char*>(addr);
+  for (char* mirror : {ring, ring + size}) {
+    if (mmap(mirror, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+      std::string err = std::strerror(errno);
+      munmap(ring, 2 * size);
+      return error::Internal("Could not map the ring buffer: $0", err);
+    }
+  }
+
+  return ring;
+}
+
+// The number of rings mapped by all of the buffers.
+std::atomic<uint64_t> num_mapped_rings{0};
+
+// Counts a new mapped ring, unless there are already as many as allowed.
+bool ReserveMappedRing() {
+  if (num_mapped_rings.fetch_add(1) >= FLAGS_stirling_data_stream_buffer_max_mirrored_rings) {
+    num_mapped_rings.fetch_sub(1);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+void MirroredRingDataStreamBufferImpl::Reset() {
+  chunks_.clear();
+  timestamps_.clear();
+  position_ = 0;
+  size_ = 0;
+  ReleaseRing();
+}
+
+size_t MirroredRingDataStreamBufferImpl::RingSizeFor(size_t size) const {
+  const size_t page_size = PageSize();
+  const size_t max_ring_size =
+      std::max(page_size, (capacity_ + page_size - 1) / page_size * page_size);
+
+  size_t ring_size = page_size;
+  while (ring_size < size && ring_size < max_ring_size) {
+    ring_size *= 2;
+  }
+  return std::min(ring_size, max_ring_size);
+}
+
+void MirroredRingDataStreamBufferImpl::ResizeRing(size_t ring_size) {
+  DCHECK_GE(ring_size, size_);
+
+  char* ring = nullptr;
+  bool mapped = false;
+  if (ring_size >= FLAGS_stirling_data_stream_buffer_mirrored_ring_min_size &&
+      ReserveMappedRing()) {
+    StatusOr<char*> ring_or = MapMirroredRing(ring_size);
+    if (ring_or.ok()) {
+      ring = ring_or.ConsumeValueOrDie();
+      mapped = true;
+    } else {
+      num_mapped_rings.fetch_sub(1);
+      LOG_FIRST_N(WARNING, 10) << absl::Substitute(
+          "Keeping data stream buffer on the heap, could not map its ring: $0",
+          ring_or.status().msg());
+    }
+  }
+
+  std::unique_ptr<char[]> heap_ring;
+  if (!mapped) {
+    heap_ring.reset(new char[ring_size]);
+    ring = heap_ring.get();
+  }
+  if (size_ > 0) {
+    memcpy(ring, ring_ + head_, size_);
+  }
+
+  ReleaseRing();
+  ring_ = ring;
+  ring_size_ = ring_size;
+  mapped_ = mapped;
+  heap_ring_ = std::move(heap_ring);
+}
+
+void MirroredRingDataStreamBufferImpl::ReleaseRing() {
+  if (mapped_) {
+    munmap(ring_, 2 * ring_size_);
+    num_mapped_rings.fetch_sub(1);
+  }
+  heap_ring_.reset();
+  ring_ = nullptr;
+  ring_size_ = 0;
+  mapped_ = false;
+  head_ = 0;
+}
+
+void MirroredRingDataStreamBufferImpl::AdvanceHead(size_t n) {
+  DCHECK_LE(n, size_);
+  size_ -= n;
+  if (mapped_) {
+    head_ = (head_ + n) % ring_size_;
+  } else if (size_ > 0) {
+    // Without a mirror, the bytes are only contiguous at the front of the ring.
+    memmove(ring_, ring_ + n, size_);
+  }
+}
+
+void MirroredRingDataStreamBufferImpl::ShrinkToFit() {
+  if (size_ == 0) {
+    ReleaseRing();
+    return;
+  }
+
+  size_t ring_size = RingSizeFor(size_);
+  if (ring_size < ring_size_) {
+    ResizeRing(ring_size);
+  }
+}
+
+bool MirroredRingDataStreamBufferImpl::CheckOverlap(size_t pos, size_t size) {
+  bool left_overlap = false;
+  bool right_overlap = false;
+
+  // Look for the first chunk whose start position is to the right
+  // of start position of this new chunk.
+  auto r_iter = chunks_.lower_bound(pos);
+
+  if (r_iter != chunks_.end()) {
+    // There is a chunk to the right. Check for overlap.
+    size_t r_pos = r_iter->first;
+    size_t r_size = r_iter->second;
+
+    right_overlap = (pos + size > r_pos);
+    ECHECK(!right_overlap) << absl::Substitute(
+        "New chunk overlaps with right chunk. "
+        "Existing right chunk: [p=$0,s=$1] New Chunk: [p=$2,s=$3]",
+        r_pos, r_size, pos, size);
+  }
+
+  // Find the chunk right before the right chunk. If it exists, this should
+  // be our left chunk.
+  auto l_iter = r_iter;
+  if (l_iter != chunks_.begin()) {
+    --l_iter;
+    // There is a chunk to the left. Check for overlap.
+    size_t l_pos = l_iter->first;
+    size_t l_size = l_iter->second;
+
+    left_overlap = (pos < l_pos + l_size);
+    ECHECK(!left_overlap) << absl::Substitute(
+        "New chunk overlaps with left chunk. "
+        "Existing left chunk: [p=$0,s=$1] New Chunk: [p=$2,s=$3]",
+        l_pos, l_size, pos, size);
+  }
+
+  return left_overlap || right_overlap;
+}
+
+void MirroredRingDataStreamBufferImpl::AddNewChunk(size_t pos, size_t size) {
+  // Look for the chunks to the left and right of this new chunk.
+  auto r_iter = chunks_.lower_bound(pos);
+
+  // Does this chunk fuse with the chunk on the left of it?
+  bool left_fuse = false;
+  auto l_iter = r_iter;
+  if (l_iter != chunks_.begin()) {
+    --l_iter;
+    left_fuse = (l_iter->first + l_iter->second == pos);
+  }
+
+  // Does this chunk fuse with the chunk on the right of it?
+  bool right_fuse = false;
+  if (r_iter != chunks_.end()) {
+    right_fuse = (pos + size == r_iter->first);
+  }
+
+  if (left_fuse && right_fuse) {
+    // The new chunk bridges two previously separate chunks together.
+    // Keep the left one and increase its size to cover all three chunks.
+    l_iter->second += (size + r_iter->second);
+    chunks_.erase(r_iter);
+  } else if (left_fuse) {
+    // Merge new chunk directly to the one on its left.
+    l_iter->second += size;
+  } else if (right_fuse) {
+    // Merge new chunk into the one on its right.
+    // Since its key changes, this requires removing and re-inserting the chunk.
+    size_t r_size = r_iter->second;
+    chunks_.erase(r_iter);
+    chunks_[pos] = size + r_size;
+  } else {
+    // No fusing, so just add the new chunk.
+    chunks_[pos] = size;
+  }
+}
+
+void MirroredRingDataStreamBufferImpl::AddNewTimestamp(size_t pos, uint64_t timestamp) {
+  timestamps_[pos] = timestamp;
+}
+
+void MirroredRingDataStreamBufferImpl::Add(size_t pos, std::string_view data,
+                                           uint64_t timestamp) {
+  if (data.size() > capacity_) {
+    size_t oversize_amount = data.size() - capacity_;
+    data.remove_prefix(oversize_amount);
+    pos += oversize_amount;
+  }
+
+  // Calculate the offsets (ppos) where the data would live relative to the head of the ring.
+  ssize_t ppos_front = pos - position_;
+  ssize_t ppos_back = pos + data.size() - position_;
+
+  bool run_metadata_cleanup = false;
+
+  if (ppos_back <= 0) {
+    // Case 1: Data being added is too far back. Just ignore it.
+    VLOG(1) << absl::Substitute(
+        "Ignoring event that has already been skipped [event pos=$0, current pos=$1].", pos,
+        position_);
+    return;
+  }
+
+  if (ppos_front < 0) {
+    // Case 2: Data being added is straddling the front-side of the buffer. Cut-off the prefix.
+    VLOG(1) << absl::Substitute(
+        "Event is partially too far in the past [event pos=$0, current pos=$1].", pos, position_);
+
+    ssize_t prefix = 0 - ppos_front;
+    data.remove_prefix(prefix);
+    pos += prefix;
+    ppos_front = 0;
+  }
+
+  if (ppos_back > static_cast<ssize_t>(size_)) {
+    // Case 3: Data being added extends the buffer.
+    // See AlwaysContiguousDataStreamBufferImpl::Add() for how large gaps are handled.
+    if (pos > EndPosition() + max_gap_size_) {
+      position_ = pos - allow_before_gap_size_;
+      ppos_front = allow_before_gap_size_;
+      ppos_back = allow_before_gap_size_ + data.size();
+      // Delay cleaning up metadata until after adding the new chunk, so that `CleanupMetadata`'s
+      // view of the ring and chunks_ is not in an intermediate state.
+      run_metadata_cleanup = true;
+    }
+
+    if (pos > position_ + capacity_) {
+      VLOG(1) << absl::Substitute("Event skips ahead *a lot* [event pos=$0, current pos=$1].", pos,
+                                  position_);
+    }
+
+    ssize_t logical_size = pos + data.size() - position_;
+    if (logical_size > static_cast<ssize_t>(capacity_)) {
+      // The movement of the buffer position will cause some bytes to "fall off",
+      // remove those now. This only moves the head of the ring.
+      size_t remove_count = logical_size - capacity_;
+
+      VLOG(1) << absl::Substitute("Event bytes to be dropped [count=$0].", remove_count);
+
+      RemovePrefix(remove_count);
+      ppos_front -= remove_count;
+      ppos_back -= remove_count;
+    }
+
+    DCHECK_GE(ppos_front, 0);
+    DCHECK_LE(ppos_back, static_cast<ssize_t>(capacity_));
+
+    size_t new_size = ppos_back;
+    if (new_size > ring_size_) {
+      ResizeRing(RingSizeFor(new_size));
+    }
+    size_ = new_size;
+  }
+
+  if (CheckOverlap(pos, data.size())) {
+    // This chunk overlaps with an existing chunk. Don't add the new chunk.
+    return;
+  }
+
+  // Now copy the data into the ring. The copy may wrap around the end of the ring into the
+  // mirror, which writes it to the front of the ring.
+  if (!data.empty()) {
+    memcpy(ring_ + head_ + ppos_front, data.data(), data.size());
+  }
+
+  // Update the metadata.
+  AddNewChunk(pos, data.size());
+  AddNewTimestamp(pos, timestamp);
+
+  if (run_metadata_cleanup) {
+    CleanupMetadata();
+  }
+}
+
+absl::btree_map<size_t, size_t>::const_iterator MirroredRingDataStreamBufferImpl::GetChunkForPos(
+    size_t pos) const {
+  // Get chunk which is <= pos.
+  auto iter = MapLE(chunks_, pos);
+  if (iter == chunks_.cend()) {
+    return chunks_.cend();
+  }
+
+  DCHECK_GE(pos, iter->first);
+
+  // Does the chunk include pos? If not, return {}.
+  ssize_t available = iter->second - (pos - iter->first);
+  if (available <= 0) {
+    return chunks_.cend();
+  }
+
+  return iter;
+}
+
+std::string_view MirroredRingDataStreamBufferImpl::Get(size_t pos) const {
+  auto iter = GetChunkForPos(pos);
+  if (iter == chunks_.cend()) {
+    return {};
+  }
+
+  size_t chunk_pos = iter->first;
+  size_t chunk_size = iter->second;
+
+  ssize_t bytes_available = chunk_size - (pos - chunk_pos);
+  DCHECK_GT(bytes_available, 0);
+
+  DCHECK_GE(pos, position_);
+  size_t ppos = pos - position_;
+  DCHECK_LT(ppos, size_);
+  // The mirror makes the bytes contiguous even if they wrap around the end of the ring.
+  return std::string_view(ring_ + head_ + ppos, bytes_available);
+}
+
+StatusOr<uint64_t> MirroredRingDataStreamBufferImpl::GetTimestamp(size_t pos) const {
+  // Ensure the specified time corresponds to a real chunk.
+  if (GetChunkForPos(pos) == chunks_.cend()) {
+    return error::Internal("Specified position not found");
+  }
+
+  // Get chunk which is <= pos.
+  auto iter = MapLE(timestamps_, pos);
+  if (iter == timestamps_.cend()) {
+    LOG(DFATAL) << absl::Substitute(
+        "Specified position should have been found, since we verified we are not in a chunk gap "
+        "[position=$0]\n$1.",
+        pos, DebugInfo());
+    return error::Internal("Specified position not found.");
+  }
+
+  DCHECK_GE(pos, iter->first);
+
+  return iter->second;
+}
+
+void MirroredRingDataStreamBufferImpl::CleanupMetadata() {
+  CleanupChunks();
+  CleanupTimestamps();
+}
+
+void MirroredRingDataStreamBufferImpl::CleanupChunks() {
+  // Find and remove irrelevant metadata in `chunks_`.
+
+  // Get chunk which is <= position_.
+  auto iter = MapLE(chunks_, position_);
+  if (iter == chunks_.end()) {
+    return;
+  }
+
+  size_t chunk_pos = iter->first;
+  size_t chunk_size = iter->second;
+
+  DCHECK_GE(position_, chunk_pos);
+  ssize_t available = chunk_size - (position_ - chunk_pos);
+
+  if (available <= 0) {
+    // position_ was in a gap area between two chunks, so go back to the next chunk.
+    ++iter;
+    chunks_.erase(chunks_.begin(), iter);
+  } else {
+    // Remove all chunks before position_, including the one it is in, and add back the part of
+    // that chunk at and after position_.
+    ++iter;
+    chunks_.erase(chunks_.begin(), iter);
+    chunks_[position_] = available;
+  }
+
+  if (chunks_.empty()) {
+    ECHECK_EQ(size_, 0U) << "Invalid state in MirroredRingDataStreamBufferImpl. "
+                            "The ring is non-empty, but chunks_ is empty.";
+    size_ = 0;
+  }
+}
+
+void MirroredRingDataStreamBufferImpl::CleanupTimestamps() {
+  // Find and remove irrelevant metadata in `timestamps_`.
+
+  // Get timestamp which is <= position_.
+  auto iter = MapLE(timestamps_, position_);
+  if (iter == timestamps_.end()) {
+    return;
+  }
+
+  // We are now at the timestamp that covers position_,
+  // anything before this is expired and can be removed.
+  timestamps_.erase(timestamps_.begin(), iter);
+
+  DCHECK(!timestamps_.empty());
+}
+
+void MirroredRingDataStreamBufferImpl::RemovePrefix(ssize_t n) {
+  // Check for positive values of n.
+  // For safety in production code, just return.
+  DCHECK_GE(n, 0);
+  if (n < 0) {
+    return;
+  }
+
+  AdvanceHead(std::min(static_cast<size_t>(n), size_));
+  position_ += n;
+
+  CleanupMetadata();
+}
+
+void MirroredRingDataStreamBufferImpl::Trim() {
+  if (chunks_.empty()) {
+    return;
+  }
+
+  size_t chunk_pos = chunks_.begin()->first;
+  DCHECK_GE(chunk_pos, position_);
+  size_t trim_size = chunk_pos - position_;
+
+  AdvanceHead(trim_size);
+  position_ += trim_size;
+}
+
+size_t MirroredRingDataStreamBufferImpl::EndPosition() {
+  size_t end_position = position_;
+  if (!chunks_.empty()) {
+    auto last_chunk = std::prev(chunks_.end());
+    end_position = last_chunk->first + last_chunk->second;
+  }
+  return end_position;
+}
+
+std::string MirroredRingDataStreamBufferImpl::DebugInfo() const {
+  std::string s;
+
+  absl::StrAppend(&s, absl::Substitute("Position: $0\n", position_));
+  absl::StrAppend(&s, absl::Substitute("BufferSize: $0/$1\n", size_, capacity_));
+  absl::StrAppend(&s, absl::Substitute("RingSize: $0 RingHead: $1 Mapped: $2\n", ring_size_, head_,
+                                       mapped_));
+  absl::StrAppend(&s, "Chunks:\n");
+  for (const auto& [pos, size] : chunks_) {
+    absl::StrAppend(&s, absl::Substitute("  position:$0 size:$1\n", pos, size));
+  }
+  absl::StrAppend(&s, "Timestamps:\n");
+  for (const auto& [pos, timestamp] : timestamps_) {
+    absl::StrAppend(&s, absl::Substitute("  position:$0 timestamp:$1\n", pos, timestamp));
+  }
+  std::string_view buffer =
+      (ring_ == nullptr) ? std::string_view() : std::string_view(ring_ + head_, size_);
+  absl::StrAppend(&s, absl::Substitute("Buffer: $0\n", buffer));
+
+  return s;
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
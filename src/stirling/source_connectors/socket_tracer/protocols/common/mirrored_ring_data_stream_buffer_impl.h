@@ -0,0 +1,151 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <absl/container/btree_map.h>
+
+#include "src/common/base/mixins.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/data_stream_buffer.h"
+
+DECLARE_uint64(stirling_data_stream_buffer_mirrored_ring_min_size);
+DECLARE_uint64(stirling_data_stream_buffer_max_mirrored_rings);
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+/**
+ * A DataStreamBufferImpl with the same behavior as AlwaysContiguousDataStreamBufferImpl, whose
+ * bytes are kept in a ring buffer that is mapped twice, back to back, in virtual memory. Any range
+ * of the ring is then contiguous in memory, so Head() never copies and RemovePrefix() only moves
+ * the head of the ring, instead of moving the remaining bytes to the front of the buffer.
+ *
+ * The ring starts at a single page and doubles as needed, up to the capacity rounded up to whole
+ * pages. Mapping a ring is slow, and its mappings count towards vm.max_map_count, so only rings of
+ * at least --stirling_data_stream_buffer_mirrored_ring_min_size bytes are mapped, and at most
+ * --stirling_data_stream_buffer_max_mirrored_rings of them at a time. Other rings are a single
+ * heap allocation, whose bytes are moved to its front on RemovePrefix(), like the always contiguous
+ * implementation does.
+ */
+class MirroredRingDataStreamBufferImpl : public DataStreamBufferImpl, public NotCopyMoveable {
+ public:
+  MirroredRingDataStreamBufferImpl(size_t max_capacity, size_t max_gap_size,
+                                   size_t allow_before_gap_size)
+      : capacity_(max_capacity),
+        max_gap_size_(max_gap_size),
+        allow_before_gap_size_(allow_before_gap_size) {}
+
+  ~MirroredRingDataStreamBufferImpl() override { ReleaseRing(); }
+
+  void Add(size_t pos, std::string_view data, uint64_t timestamp) override;
+
+  std::string_view Head() override { return Get(position_); }
+
+  StatusOr<uint64_t> GetTimestamp(size_t pos) const override;
+
+  void RemovePrefix(ssize_t n) override;
+
+  void Trim() override;
+
+  size_t size() const override { return size_; }
+
+  size_t capacity() const override { return ring_size_; }
+
+  bool empty() const override { return size_ == 0; }
+
+  size_t position() const override { return position_; }
+
+  std::string DebugInfo() const override;
+
+  void Reset() override;
+
+  void ShrinkToFit() override;
+
+ private:
+  absl::btree_map<size_t, size_t>::const_iterator GetChunkForPos(size_t pos) const;
+  void AddNewChunk(size_t pos, size_t size);
+  void AddNewTimestamp(size_t pos, uint64_t timestamp);
+
+  // CheckOverlap checks if the chunk to be added as indicated by pos and size
+  // overlaps with any existing chunks in the data buffer.
+  bool CheckOverlap(size_t pos, size_t size);
+
+  void CleanupTimestamps();
+  void CleanupChunks();
+
+  // Umbrella that calls CleanupTimestamps and CleanupChunks.
+  void CleanupMetadata();
+
+  // Get the end of valid data in the buffer.
+  size_t EndPosition();
+
+  // Get a string_view for the chunk at pos.
+  std::string_view Get(size_t pos) const;
+
+  // The size of the smallest ring that can hold size bytes.
+  size_t RingSizeFor(size_t size) const;
+
+  // Moves the bytes of the buffer to the front of a new ring of ring_size bytes, which is mapped
+  // if it is large enough and the limit of mapped rings allows it.
+  void ResizeRing(size_t ring_size);
+
+  void ReleaseRing();
+
+  // Drops the first n bytes of the ring.
+  void AdvanceHead(size_t n);
+
+  const size_t capacity_;
+  const size_t max_gap_size_;
+  const size_t allow_before_gap_size_;
+
+  // Logical position of data stream buffer.
+  // In other words, the position of the byte at ring_[head_].
+  size_t position_ = 0;
+
+  // The first of the two mappings of the ring if mapped_, in which case the second one starts at
+  // ring_ + ring_size_. Otherwise, ring_ points to heap_ring_.
+  char* ring_ = nullptr;
+  size_t ring_size_ = 0;
+  bool mapped_ = false;
+  std::unique_ptr<char[]> heap_ring_;
+
+  // Offset of the head of the buffer in the ring, always less than ring_size_, and 0 unless
+  // mapped_.
+  size_t head_ = 0;
+
+  // Number of bytes of the buffer, including gaps.
+  size_t size_ = 0;
+
+  // Interval set of the chunks in the buffer, from chunk start positions to chunk sizes.
+  // A chunk is a contiguous sequence of bytes.
+  // Adjacent chunks are always fused, so a chunk either ends at a gap or the end of the buffer.
+  absl::btree_map<size_t, size_t> chunks_;
+
+  // Sorted positions and their timestamps.
+  // Unlike chunks_, which will fuse when adjacent, timestamps never fuse.
+  // Also, we don't track gaps in the buffer with timestamps; must use chunks_ for that.
+  absl::btree_map<size_t, uint64_t> timestamps_;
+};
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/headers_map.h"
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/match.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "src/common/base/utils.h"
+#include "src/common/json/json.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http {
+
+namespace {
+
+// Large enough for the headers of most messages, which are inserted after a Reserve() anyway.
+constexpr size_t kMinArenaBlockSize = 256;
+
+// FNV-1a of the lower-cased name.
+uint32_t CaseInsensitiveHash(std::string_view name) {
+  uint32_t hash = 2166136261u;
+  for (char c : name) {
+    hash ^= static_cast<uint8_t>(absl::ascii_tolower(c));
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+}  // namespace
+
+HeadersMap::HeadersMap(std::initializer_list<value_type> headers) {
+  size_t num_bytes = 0;
+  for (const auto& [name, value] : headers) {
+    num_bytes += name.size() + value.size();
+  }
+  Reserve(headers.size(), num_bytes);
+  for (const auto& header : headers) {
+    insert(header);
+  }
+}
+
+HeadersMap::HeadersMap(const HeadersMap& other) {
+  size_t num_bytes = 0;
+  for (const auto& block : other.arena_) {
+    num_bytes += block.used;
+  }
+  Reserve(other.size(), num_bytes);
+  for (const auto& header : other) {
+    insert(header);
+  }
+}
+
+HeadersMap& HeadersMap::operator=(const HeadersMap& other) {
+  if (this != &other) {
+    HeadersMap copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+void HeadersMap::Reserve(size_t num_headers, size_t num_bytes) {
+  headers_.reserve(headers_.size() + num_headers);
+  name_hashes_.reserve(name_hashes_.size() + num_headers);
+  if (num_bytes == 0) {
+    return;
+  }
+  if (!arena_.empty() && arena_.back().capacity - arena_.back().used >= num_bytes) {
+    return;
+  }
+  ArenaBlock block;
+  // Not value-initialized, every byte is written before it is read.
+  block.data.reset(new char[num_bytes]);
+  block.capacity = num_bytes;
+  arena_.push_back(std::move(block));
+}
+
+char* HeadersMap::Allocate(size_t num_bytes) {
+  if (arena_.empty() || arena_.back().capacity - arena_.back().used < num_bytes) {
+    size_t capacity = kMinArenaBlockSize;
+    if (!arena_.empty()) {
+      capacity = std::max(capacity, 2 * arena_.back().capacity);
+    }
+    capacity = std::max(capacity, num_bytes);
+    ArenaBlock block;
+    block.data.reset(new char[capacity]);
+    block.capacity = capacity;
+    arena_.push_back(std::move(block));
+  }
+  ArenaBlock& block = arena_.back();
+  char* ptr = block.data.get() + block.used;
+  block.used += num_bytes;
+  return ptr;
+}
+
+HeadersMap::const_iterator HeadersMap::emplace(std::string_view name, std::string_view value) {
+  std::string_view name_copy;
+  std::string_view value_copy;
+  if (!name.empty() || !value.empty()) {
+    char* ptr = Allocate(name.size() + value.size());
+    // Arena blocks never move, so the name and value may be views of this map's own headers.
+    if (!name.empty()) {
+      memcpy(ptr, name.data(), name.size());
+    }
+    if (!value.empty()) {
+      memcpy(ptr + name.size(), value.data(), value.size());
+    }
+    name_copy = std::string_view(ptr, name.size());
+    value_copy = std::string_view(ptr + name.size(), value.size());
+  }
+  headers_.emplace_back(name_copy, value_copy);
+  name_hashes_.push_back(CaseInsensitiveHash(name));
+  return headers_.end() - 1;
+}
+
+HeadersMap::const_iterator HeadersMap::find(std::string_view name) const {
+  const uint32_t hash = CaseInsensitiveHash(name);
+  for (size_t i = 0; i < name_hashes_.size(); ++i) {
+    if (name_hashes_[i] == hash && absl::EqualsIgnoreCase(headers_[i].first, name)) {
+      return headers_.begin() + i;
+    }
+  }
+  return headers_.end();
+}
+
+size_t HeadersMap::count(std::string_view name) const {
+  const uint32_t hash = CaseInsensitiveHash(name);
+  size_t count = 0;
+  for (size_t i = 0; i < name_hashes_.size(); ++i) {
+    if (name_hashes_[i] == hash && absl::EqualsIgnoreCase(headers_[i].first, name)) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+void HeadersMap::clear() {
+  headers_.clear();
+  name_hashes_.clear();
+  arena_.clear();
+}
+
+std::vector<HeadersMap::value_type> HeadersMap::SortedByName() const {
+  std::vector<value_type> sorted = headers_;
+  std::stable_sort(sorted.begin(), sorted.end(), [](const value_type& lhs, const value_type& rhs) {
+    return CaseInsensitiveLess()(lhs.first, rhs.first);
+  });
+  return sorted;
+}
+
+bool operator==(const HeadersMap& lhs, const HeadersMap& rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  return lhs.SortedByName() == rhs.SortedByName();
+}
+
+std::string ToJSONString(const HeadersMap& headers) {
+  utils::JSONObjectBuilder builder;
+  for (const auto& [name, value] : headers.SortedByName()) {
+    builder.WriteKV(name, value);
+  }
+  return builder.GetString();
+}
+
+}  // namespace http
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http {
+
+/**
+ * HeadersMap holds the headers of an HTTP/1.x message.
+ *
+ * HTTP1.x headers can have multiple values for the same name, and field names are
+ * case-insensitive: https://www.w3.org/Protocols/rfc2616/rfc2616-sec4.html#sec4.2
+ *
+ * The headers are kept in a flat vector in the order they were inserted, and their names and
+ * values are copied into arena blocks owned by the map, so a parsed message costs a single
+ * allocation for all of its header bytes instead of a node and two strings per header.
+ * Messages only have a handful of headers, so lookups scan a parallel vector of case-insensitive
+ * name hashes and only compare the names whose hashes match.
+ *
+ * The interface follows the std::multimap it replaces: find() returns the first header with the
+ * name, and two maps are equal if they have the same headers regardless of the order of
+ * different names.
+ */
+class HeadersMap {
+ public:
+  using value_type = std::pair<std::string_view, std::string_view>;
+  using const_iterator = std::vector<value_type>::const_iterator;
+  using iterator = const_iterator;
+
+  HeadersMap() = default;
+  HeadersMap(std::initializer_list<value_type> headers);
+
+  HeadersMap(const HeadersMap& other);
+  HeadersMap& operator=(const HeadersMap& other);
+  // Moving keeps the arena blocks, so the views of the moved headers stay valid.
+  HeadersMap(HeadersMap&& other) noexcept = default;
+  HeadersMap& operator=(HeadersMap&& other) noexcept = default;
+
+  /**
+   * Reserves room for num_headers headers whose names and values add up to num_bytes, so that
+   * inserting them allocates at most once for the headers and once for their bytes.
+   */
+  void Reserve(size_t num_headers, size_t num_bytes);
+
+  /**
+   * Copies the name and value into the map. Existing headers with the same name are kept.
+   */
+  const_iterator emplace(std::string_view name, std::string_view value);
+  const_iterator insert(const value_type& header) { return emplace(header.first, header.second); }
+
+  /**
+   * Returns the first header whose name equals name ignoring case, or end().
+   */
+  const_iterator find(std::string_view name) const;
+  size_t count(std::string_view name) const;
+
+  const_iterator begin() const { return headers_.begin(); }
+  const_iterator end() const { return headers_.end(); }
+  size_t size() const { return headers_.size(); }
+  bool empty() const { return headers_.empty(); }
+  void clear();
+
+  /**
+   * Returns the headers ordered by their case-insensitive names, and in insertion order for equal
+   * names, which is the order the std::multimap this class replaces iterated in.
+   */
+  std::vector<value_type> SortedByName() const;
+
+  friend bool operator==(const HeadersMap& lhs, const HeadersMap& rhs);
+  friend bool operator!=(const HeadersMap& lhs, const HeadersMap& rhs) { return !(lhs == rhs); }
+
+ private:
+  struct ArenaBlock {
+    std::unique_ptr<char[]> data;
+    size_t capacity = 0;
+    size_t used = 0;
+  };
+
+  // Returns num_bytes of arena memory, which stay at the same address until clear().
+  char* Allocate(size_t num_bytes);
+
+  std::vector<value_type> headers_;
+  std::vector<uint32_t> name_hashes_;
+  std::vector<ArenaBlock> arena_;
+};
+
+/**
+ * Converts the headers into a JSON object, with the keys sorted like SortedByName().
+ */
+std::string ToJSONString(const HeadersMap& headers);
+
+}  // namespace http
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
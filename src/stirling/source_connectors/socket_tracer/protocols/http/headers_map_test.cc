@@ -0,0 +1,113 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <absl/strings/str_cat.h>
+
+#include <string>
+#include <utility>
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/headers_map.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::StrEq;
+
+TEST(HeadersMapTest, KeepsDuplicatesInInsertionOrder) {
+  HeadersMap headers = {{"Set-Cookie", "a=1"}, {"Host", "pixielabs.ai"}, {"set-cookie", "b=2"}};
+  EXPECT_THAT(headers, ElementsAre(Pair("Set-Cookie", "a=1"), Pair("Host", "pixielabs.ai"),
+                                   Pair("set-cookie", "b=2")));
+
+  auto iter = headers.find("SET-COOKIE");
+  ASSERT_NE(iter, headers.end());
+  EXPECT_EQ(iter->second, "a=1");
+  EXPECT_EQ(headers.count("Set-Cookie"), 2);
+  EXPECT_EQ(headers.count("Content-Type"), 0);
+  EXPECT_EQ(headers.find("Content-Type"), headers.end());
+}
+
+TEST(HeadersMapTest, EqualityIgnoresOrderOfDifferentNames) {
+  const HeadersMap headers = {{"Host", "pixielabs.ai"}, {"Accept", "*/*"}};
+  EXPECT_EQ(headers, HeadersMap({{"Accept", "*/*"}, {"Host", "pixielabs.ai"}}));
+  EXPECT_NE(headers, HeadersMap({{"Accept", "*/*"}, {"host", "pixielabs.ai"}}));
+  EXPECT_NE(headers, HeadersMap({{"Accept", "*/*"}, {"Host", "pixielabs.com"}}));
+  EXPECT_NE(headers, HeadersMap({{"Accept", "*/*"}}));
+
+  // Like a std::multimap, the values of the same name are compared in insertion order.
+  EXPECT_NE(HeadersMap({{"Via", "a"}, {"Via", "b"}}), HeadersMap({{"Via", "b"}, {"Via", "a"}}));
+}
+
+TEST(HeadersMapTest, CopiesOwnTheirBytes) {
+  HeadersMap copy;
+  HeadersMap moved;
+  {
+    std::string name = "Content-Type";
+    std::string value = "application/json";
+    HeadersMap headers;
+    headers.emplace(name, value);
+    name.assign(name.size(), 'x');
+    value.assign(value.size(), 'x');
+
+    copy = headers;
+    moved = std::move(headers);
+  }
+  EXPECT_THAT(copy, ElementsAre(Pair("Content-Type", "application/json")));
+  EXPECT_THAT(moved, ElementsAre(Pair("Content-Type", "application/json")));
+}
+
+TEST(HeadersMapTest, GrowsPastReservedBytes) {
+  HeadersMap headers;
+  headers.Reserve(1, 4);
+  for (int i = 0; i < 100; ++i) {
+    headers.emplace(absl::StrCat("X-Header-", i), std::string(i, 'v'));
+  }
+  // Inserting a header of the map itself must not invalidate its source.
+  headers.insert(*headers.find("x-header-99"));
+
+  ASSERT_EQ(headers.size(), 101);
+  for (int i = 0; i < 100; ++i) {
+    auto iter = headers.find(absl::StrCat("x-header-", i));
+    ASSERT_NE(iter, headers.end());
+    EXPECT_EQ(iter->second, std::string(i, 'v'));
+  }
+  EXPECT_EQ(headers.count("X-Header-99"), 2);
+
+  headers.clear();
+  EXPECT_TRUE(headers.empty());
+  EXPECT_EQ(headers.find("X-Header-0"), headers.end());
+}
+
+TEST(HeadersMapTest, ToJSONStringSortsByName) {
+  const HeadersMap headers = {
+      {"b", "2"}, {"Content-Type", "json"}, {"A", "1"}, {"b", "3"}, {"Quote", "\"x\""}};
+  EXPECT_THAT(ToJSONString(headers),
+              StrEq(R"({"A":"1","b":"2","b":"3","Content-Type":"json","Quote":"\"x\""})"));
+  EXPECT_THAT(ToJSONString(HeadersMap()), StrEq("{}"));
+}
+
+}  // namespace http
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -21,6 +21,10 @@
 
 #include <picohttpparser.h>
 
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 #include <algorithm>
 #include <string>
 #include <utility>
@@ -75,14 +79,18 @@ int ParseResponse(std::string_view buf, HTTPResponse* result) {
                             /*last_len*/ 0);
 }
 
-HeadersMap GetHTTPHeadersMap(const phr_header* headers, size_t num_headers) {
-  HeadersMap result;
+// Copies the headers into the message's HeadersMap, which allocates once for all of their bytes.
+void CopyHTTPHeaders(const phr_header* headers, size_t num_headers, HeadersMap* result) {
+  size_t num_bytes = 0;
+  for (size_t i = 0; i < num_headers; i++) {
+    num_bytes += headers[i].name_len + headers[i].value_len;
+  }
+  result->clear();
+  result->Reserve(num_headers, num_bytes);
   for (size_t i = 0; i < num_headers; i++) {
-    std::string name(headers[i].name, headers[i].name_len);
-    std::string value(headers[i].value, headers[i].value_len);
-    result.emplace(std::move(name), std::move(value));
+    result->emplace(std::string_view(headers[i].name, headers[i].name_len),
+                    std::string_view(headers[i].value, headers[i].value_len));
   }
-  return result;
 }
 
 }  // namespace pico_wrapper
@@ -220,7 +228,7 @@ ParseState ParseRequest(std::string_view* buf, Message* result) {
 
     result->type = message_type_t::kRequest;
     result->minor_version = req.minor_version;
-    result->headers = pico_wrapper::GetHTTPHeadersMap(req.headers, req.num_headers);
+    pico_wrapper::CopyHTTPHeaders(req.headers, req.num_headers, &result->headers);
     result->req_method = std::string(req.method, req.method_len);
     result->req_path = std::string(req.path, req.path_len);
     result->headers_byte_size = retval;
@@ -242,7 +250,7 @@ ParseState ParseResponse(std::string_view* buf, Message* result, State* state) {
 
     result->type = message_type_t::kResponse;
     result->minor_version = resp.minor_version;
-    result->headers = pico_wrapper::GetHTTPHeadersMap(resp.headers, resp.num_headers);
+    pico_wrapper::CopyHTTPHeaders(resp.headers, resp.num_headers, &result->headers);
     result->resp_status = resp.status;
     result->resp_message = std::string(resp.msg, resp.msg_len);
     result->headers_byte_size = retval;
@@ -276,6 +284,77 @@ ParseState ParseFrame(message_type_t type, std::string_view* buf, Message* resul
   }
 }
 
+namespace {
+
+constexpr std::string_view kBoundaryMarker = "\r\n\r\n";
+
+#if defined(__x86_64__)
+
+// Header lines end with "\r\n", so searching for the first byte of the marker and comparing the
+// rest, like std::string_view::find() does, stops on every line. Instead, the bytes at offsets 0
+// to 3 of kWidth candidate positions are compared to the marker at once, and only a full match
+// sets the candidate's bit in the mask.
+__attribute__((target("avx2"))) size_t FindHeadersEndAVX2(std::string_view buf, size_t pos) {
+  constexpr size_t kWidth = 32;
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i lf = _mm256_set1_epi8('\n');
+  const char* data = buf.data();
+  for (; pos + kWidth + kBoundaryMarker.size() - 1 <= buf.size(); pos += kWidth) {
+    __m256i match0 =
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos)), cr);
+    __m256i match1 = _mm256_cmpeq_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + 1)), lf);
+    __m256i match2 = _mm256_cmpeq_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + 2)), cr);
+    __m256i match3 = _mm256_cmpeq_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + 3)), lf);
+    __m256i match =
+        _mm256_and_si256(_mm256_and_si256(match0, match1), _mm256_and_si256(match2, match3));
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(match));
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+  }
+  // Every position before pos has been checked.
+  return buf.find(kBoundaryMarker, pos);
+}
+
+size_t FindHeadersEndSSE2(std::string_view buf, size_t pos) {
+  constexpr size_t kWidth = 16;
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+  const char* data = buf.data();
+  for (; pos + kWidth + kBoundaryMarker.size() - 1 <= buf.size(); pos += kWidth) {
+    __m128i match0 =
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos)), cr);
+    __m128i match1 =
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 1)), lf);
+    __m128i match2 =
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 2)), cr);
+    __m128i match3 =
+        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 3)), lf);
+    __m128i match = _mm_and_si128(_mm_and_si128(match0, match1), _mm_and_si128(match2, match3));
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(match));
+    if (mask != 0) {
+      return pos + __builtin_ctz(mask);
+    }
+  }
+  return buf.find(kBoundaryMarker, pos);
+}
+
+#endif
+
+}  // namespace
+
+size_t FindHeadersEnd(std::string_view buf, size_t pos) {
+#if defined(__x86_64__)
+  static const bool kHasAVX2 = __builtin_cpu_supports("avx2");
+  return kHasAVX2 ? FindHeadersEndAVX2(buf, pos) : FindHeadersEndSSE2(buf, pos);
+#else
+  return buf.find(kBoundaryMarker, pos);
+#endif
+}
+
 // TODO(oazizi/yzhao): This function should use is_http_{response,request} inside
 // bcc_bpf/socket_trace.c to check if a sequence of bytes are aligned on HTTP message boundary.
 // ATM, they actually do not share the same logic. As a result, BPF events detected as HTTP traffic,
@@ -297,8 +376,6 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
   static constexpr ArrayView<std::string_view> kHTTPRespStartPatterns =
       ArrayView<std::string_view>(kHTTPRespStartPatternArray);
 
-  static constexpr std::string_view kBoundaryMarker = "\r\n\r\n";
-
   // Choose the right set of patterns for request vs response.
   const ArrayView<std::string_view>* start_patterns = nullptr;
   switch (type) {
@@ -324,7 +401,7 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
   // Note that we don't search forwards for HTTP/1.1 directly, because it could result in matches
   // inside the request/response body.
   while (true) {
-    size_t marker_pos = buf.find(kBoundaryMarker, start_pos);
+    size_t marker_pos = FindHeadersEnd(buf, start_pos);
 
     if (marker_pos == std::string::npos) {
       return std::string::npos;
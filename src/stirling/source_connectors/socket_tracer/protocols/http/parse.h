@@ -29,6 +29,16 @@ DECLARE_uint32(http_body_limit_bytes);
 namespace px {
 namespace stirling {
 namespace protocols {
+namespace http {
+
+/**
+ * Returns the position of the first "\r\n\r\n", which ends the headers of an HTTP/1.x message,
+ * at or after pos in buf, or std::string::npos if there is none. On x86-64 the buffer is scanned
+ * 32 bytes at a time with AVX2 if the CPU supports it, and 16 bytes at a time with SSE2 otherwise.
+ */
+size_t FindHeadersEnd(std::string_view buf, size_t pos = 0);
+
+}  // namespace http
 
 /**
  * Parses a single HTTP message from the input string.
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/parse.h"
+
+using px::stirling::ParseState;
+using px::stirling::protocols::FindFrameBoundary;
+using px::stirling::protocols::ParseFrame;
+using px::stirling::protocols::http::FindHeadersEnd;
+using px::stirling::protocols::http::Message;
+using px::stirling::protocols::http::StateWrapper;
+
+// A response with the typical headers of an API server, followed by num_extra_headers tracing and
+// caching headers.
+std::string CreateResponse(int num_extra_headers) {
+  std::string resp =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: application/json; charset=utf-8\r\n"
+      "Date: Mon, 05 Oct 2020 18:21:46 GMT\r\n"
+      "Server: nginx/1.19.2\r\n"
+      "Vary: Accept-Encoding\r\n";
+  for (int i = 0; i < num_extra_headers; ++i) {
+    absl::StrAppend(&resp, "X-Trace-Header-", i, ": 4bf92f3577b34da6a3ce929d0e0e4736-", i, "\r\n");
+  }
+  absl::StrAppend(&resp, "Content-Length: 16\r\n\r\n{\"status\":\"ok\"}\n");
+  return resp;
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_ParseResponse(benchmark::State& state) {
+  const std::string resp = CreateResponse(state.range(0));
+  StateWrapper parser_state{};
+
+  for (auto _ : state) {
+    std::string_view buf(resp);
+    Message message;
+    ParseState parse_state =
+        ParseFrame(px::stirling::message_type_t::kResponse, &buf, &message, &parser_state);
+    CHECK(parse_state == ParseState::kSuccess);
+    benchmark::DoNotOptimize(message);
+  }
+  state.SetBytesProcessed(state.iterations() * resp.size());
+}
+
+// Resynchronizing on a stream starts with leftover body bytes, before the next message.
+// NOLINTNEXTLINE(runtime/references)
+static void BM_FindFrameBoundary(benchmark::State& state) {
+  const std::string buf =
+      absl::StrCat(std::string(1000, 'x'), CreateResponse(state.range(0)), CreateResponse(0));
+  StateWrapper parser_state{};
+
+  for (auto _ : state) {
+    size_t pos = FindFrameBoundary<Message>(px::stirling::message_type_t::kResponse, buf, 1,
+                                            &parser_state);
+    CHECK_EQ(pos, 1000);
+    benchmark::DoNotOptimize(pos);
+  }
+  state.SetBytesProcessed(state.iterations() * buf.size());
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_FindHeadersEnd(benchmark::State& state) {
+  const std::string resp = CreateResponse(state.range(0));
+
+  for (auto _ : state) {
+    size_t pos = FindHeadersEnd(resp);
+    benchmark::DoNotOptimize(pos);
+  }
+  state.SetBytesProcessed(state.iterations() * resp.size());
+}
+
+// The scalar search that FindHeadersEnd() replaces, for comparison.
+// NOLINTNEXTLINE(runtime/references)
+static void BM_FindHeadersEndScalar(benchmark::State& state) {
+  const std::string resp = CreateResponse(state.range(0));
+
+  for (auto _ : state) {
+    size_t pos = std::string_view(resp).find("\r\n\r\n");
+    benchmark::DoNotOptimize(pos);
+  }
+  state.SetBytesProcessed(state.iterations() * resp.size());
+}
+
+BENCHMARK(BM_ParseResponse)->Arg(0)->Arg(10)->Arg(40);
+BENCHMARK(BM_FindFrameBoundary)->Arg(0)->Arg(10)->Arg(40);
+BENCHMARK(BM_FindHeadersEnd)->Arg(0)->Arg(10)->Arg(40);
+BENCHMARK(BM_FindHeadersEndScalar)->Arg(0)->Arg(10)->Arg(40);
@@ -741,6 +741,52 @@ TEST_F(HTTPParserTest, PartialMessageInTheMiddleOfStream) {
   EXPECT_THAT(parsed_messages, ElementsAre(HasBody("foobar"), HasBody("pixielabs rocks!")));
 }
 
+TEST_F(HTTPParserTest, ParseHeaderHeavyResponse) {
+  StateWrapper state{};
+  std::string buf = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n";
+  for (int i = 0; i < 40; ++i) {
+    absl::StrAppend(&buf, "X-Trace-", i, ": ", std::string(i, 'v'), "\r\n");
+  }
+  absl::StrAppend(&buf, "set-cookie: a=1\r\nSet-Cookie: b=2\r\nContent-Length: 2\r\n\r\nok");
+
+  std::deque<Message> parsed_messages;
+  ParseResult result = ParseFramesLoop(message_type_t::kResponse, buf, &parsed_messages, &state);
+  ASSERT_EQ(ParseState::kSuccess, result.state);
+  ASSERT_EQ(parsed_messages.size(), 1);
+
+  // The headers are copied out of the parsed buffer.
+  buf.assign(buf.size(), 'x');
+
+  const Message& message = parsed_messages.front();
+  EXPECT_EQ(message.body, "ok");
+  ASSERT_EQ(message.headers.size(), 44);
+  EXPECT_THAT(*message.headers.begin(), Pair("Content-Type", "application/json"));
+  for (int i = 0; i < 40; ++i) {
+    auto iter = message.headers.find(absl::StrCat("x-trace-", i));
+    ASSERT_NE(iter, message.headers.end());
+    EXPECT_EQ(iter->second, std::string(i, 'v'));
+  }
+  EXPECT_EQ(message.headers.count("SET-COOKIE"), 2);
+  EXPECT_EQ(message.headers.find("Set-Cookie")->second, "a=1");
+  EXPECT_EQ(message.headers.find("content-length")->second, "2");
+}
+
+TEST_F(HTTPParserTest, ParsedHeadersSurviveMessageCopies) {
+  StateWrapper state{};
+  std::deque<Message> parsed_messages;
+  {
+    std::string buf(kHTTPGetReq0);
+    ParseResult result = ParseFramesLoop(message_type_t::kRequest, buf, &parsed_messages, &state);
+    ASSERT_EQ(ParseState::kSuccess, result.state);
+  }
+
+  Message copy = parsed_messages.front();
+  Message moved = std::move(parsed_messages.front());
+  parsed_messages.clear();
+  EXPECT_EQ(copy, HTTPGetReq0ExpectedMessage());
+  EXPECT_EQ(moved, HTTPGetReq0ExpectedMessage());
+}
+
 //=============================================================================
 // HTTP Parsing Stress Tests
 //=============================================================================
@@ -1038,6 +1084,44 @@ TEST_F(HTTPParserTest, FindNoBoundary) {
   }
 }
 
+TEST_F(HTTPParserTest, FindHeadersEnd) {
+  // Place the marker at every offset of buffers long enough to cover the vectorized loop and its
+  // scalar tail, among partial markers that must not match.
+  for (size_t size = 0; size < 100; ++size) {
+    std::string buf;
+    for (size_t i = 0; i < size; ++i) {
+      buf += "a\r\n\r"[i % 5];
+    }
+    ASSERT_EQ(FindHeadersEnd(buf), std::string::npos) << size;
+
+    for (size_t marker_pos = 0; marker_pos + 4 <= size; ++marker_pos) {
+      std::string marked = buf;
+      marked.replace(marker_pos, 4, "\r\n\r\n");
+      size_t expected_pos = std::string_view(marked).find("\r\n\r\n");
+      EXPECT_EQ(FindHeadersEnd(marked), expected_pos) << size << " " << marker_pos;
+      EXPECT_EQ(FindHeadersEnd(marked, marker_pos + 1),
+                std::string_view(marked).find("\r\n\r\n", marker_pos + 1))
+          << size << " " << marker_pos;
+    }
+  }
+  EXPECT_EQ(FindHeadersEnd("\r\n\r\n", 4), std::string::npos);
+  EXPECT_EQ(FindHeadersEnd("\r\n\r\n", 5), std::string::npos);
+}
+
+TEST_F(HTTPParserTest, FindReqBoundaryAfterLongHeaders) {
+  StateWrapper state{};
+  std::string long_req = "GET /long.html HTTP/1.1\r\n";
+  for (int i = 0; i < 20; ++i) {
+    absl::StrAppend(&long_req, "X-Header-", i, ": value\r\n");
+  }
+  absl::StrAppend(&long_req, "\r\n");
+  const std::string buf = absl::StrCat("garbage", long_req, kHTTPGetReq1);
+
+  size_t pos = FindFrameBoundary<http::Message>(message_type_t::kRequest, buf, 0, &state);
+  ASSERT_NE(pos, std::string::npos);
+  EXPECT_EQ(buf.substr(pos), absl::StrCat(long_req, kHTTPGetReq1));
+}
+
 //=============================================================================
 // HTTP Automatic Recovery to Message Boundary Tests
 //=============================================================================
@@ -23,6 +23,7 @@
 
 #include "src/common/base/utils.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/event_parser.h"  // For FrameBase
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/headers_map.h"
 
 namespace px {
 namespace stirling {
@@ -36,10 +37,6 @@ using ::px::operator<<;
 // HTTP Message
 //-----------------------------------------------------------------------------
 
-// HTTP1.x headers can have multiple values for the same name, and field names are case-insensitive:
-// https://www.w3.org/Protocols/rfc2616/rfc2616-sec4.html#sec4.2
-using HeadersMap = std::multimap<std::string, std::string, CaseInsensitiveLess>;
-
 inline constexpr char kContentEncoding[] = "Content-Encoding";
 inline constexpr char kContentLength[] = "Content-Length";
 inline constexpr char kContentType[] = "Content-Type";
@@ -29,7 +29,7 @@ bool MatchesHTTPHeaders(const HeadersMap& http_headers, const HTTPHeaderFilter&
   if (!filter.inclusions.empty()) {
     bool included = false;
     for (auto [http_header, substr] : filter.inclusions) {
-      auto http_header_iter = http_headers.find(std::string(http_header));
+      auto http_header_iter = http_headers.find(http_header);
       if (http_header_iter != http_headers.end() &&
           absl::StrContains(http_header_iter->second, substr)) {
         included = true;
@@ -45,7 +45,7 @@ bool MatchesHTTPHeaders(const HeadersMap& http_headers, const HTTPHeaderFilter&
   if (!filter.exclusions.empty()) {
     bool excluded = false;
     for (auto [http_header, substr] : filter.exclusions) {
-      auto http_header_iter = http_headers.find(std::string(http_header));
+      auto http_header_iter = http_headers.find(http_header);
       if (http_header_iter != http_headers.end() &&
           absl::StrContains(http_header_iter->second, substr)) {
         excluded = true;
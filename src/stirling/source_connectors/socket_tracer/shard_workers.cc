@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/shard_workers.h"
+
+namespace px {
+namespace stirling {
+
+ShardWorkers::~ShardWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    shutdown_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void ShardWorkers::Run(size_t num_shards, const std::function<void(size_t)>& fn) {
+  if (num_shards == 0) {
+    return;
+  }
+  // Only Run() changes generation_, so the new threads start from the current generation and wait
+  // for the one below.
+  while (threads_.size() < num_shards - 1) {
+    threads_.emplace_back(&ShardWorkers::WorkerLoop, this, threads_.size() + 1, generation_);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    fn_ = &fn;
+    num_shards_ = num_shards;
+    pending_ = num_shards - 1;
+    ++generation_;
+  }
+  work_cv_.notify_all();
+
+  fn(0);
+
+  std::unique_lock<std::mutex> lock(mu_);
+  done_cv_.wait(lock, [this] { return pending_ == 0; });
+  fn_ = nullptr;
+}
+
+void ShardWorkers::WorkerLoop(size_t shard, uint64_t generation) {
+  while (true) {
+    const std::function<void(size_t)>* fn = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      work_cv_.wait(lock, [&] { return shutdown_ || generation_ != generation; });
+      if (shutdown_) {
+        return;
+      }
+      generation = generation_;
+      // Runs with fewer shards leave the threads of the other shards idle.
+      if (shard >= num_shards_) {
+        continue;
+      }
+      fn = fn_;
+    }
+
+    (*fn)(shard);
+
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      --pending_;
+    }
+    done_cv_.notify_one();
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
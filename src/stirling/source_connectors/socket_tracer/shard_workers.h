@@ -0,0 +1,75 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * ShardWorkers runs a function on a number of shards in parallel, on threads that are started once
+ * and reused by every run, rather than created and joined each time.
+ *
+ * The thread calling Run() runs shard 0, so running N shards takes N-1 worker threads. Threads are
+ * started when a run needs more than there are, and live until the ShardWorkers is destroyed.
+ * Shard i always runs on the same thread.
+ */
+class ShardWorkers : public NotCopyMoveable {
+ public:
+  ShardWorkers() = default;
+  ~ShardWorkers();
+
+  size_t num_threads() const { return threads_.size(); }
+
+  /**
+   * Runs fn(shard) for every shard in [0, num_shards) and blocks until all of them have returned.
+   * Must not be called concurrently from multiple threads.
+   */
+  void Run(size_t num_shards, const std::function<void(size_t)>& fn);
+
+ private:
+  void WorkerLoop(size_t shard, uint64_t generation);
+
+  std::vector<std::thread> threads_;
+
+  std::mutex mu_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  // The function of the current run. Guarded by mu_.
+  const std::function<void(size_t)>* fn_ = nullptr;
+  // The number of shards of the current run. Guarded by mu_.
+  size_t num_shards_ = 0;
+  // Incremented by every run. Guarded by mu_.
+  uint64_t generation_ = 0;
+  // The number of worker threads still running shards of the current run. Guarded by mu_.
+  size_t pending_ = 0;
+  bool shutdown_ = false;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/shard_workers.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+TEST(ShardWorkersTest, RunsEveryShardOnce) {
+  ShardWorkers workers;
+  std::vector<std::atomic<int>> runs(4);
+  workers.Run(4, [&](size_t shard) { ++runs[shard]; });
+  for (const auto& count : runs) {
+    EXPECT_EQ(count.load(), 1);
+  }
+  EXPECT_EQ(workers.num_threads(), 3U);
+}
+
+TEST(ShardWorkersTest, ReusesThreads) {
+  ShardWorkers workers;
+  std::vector<std::thread::id> first_ids(3);
+  workers.Run(3, [&](size_t shard) { first_ids[shard] = std::this_thread::get_id(); });
+  EXPECT_EQ(first_ids[0], std::this_thread::get_id());
+  EXPECT_NE(first_ids[1], first_ids[0]);
+  EXPECT_NE(first_ids[2], first_ids[0]);
+  EXPECT_NE(first_ids[1], first_ids[2]);
+
+  for (int i = 0; i < 100; ++i) {
+    std::vector<std::thread::id> ids(3);
+    workers.Run(3, [&](size_t shard) { ids[shard] = std::this_thread::get_id(); });
+    EXPECT_EQ(ids, first_ids);
+  }
+  EXPECT_EQ(workers.num_threads(), 2U);
+}
+
+TEST(ShardWorkersTest, RunsFewerAndMoreShards) {
+  ShardWorkers workers;
+  std::atomic<size_t> total{0};
+  for (size_t num_shards : std::vector<size_t>{4, 1, 2, 0, 6, 3}) {
+    total = 0;
+    workers.Run(num_shards, [&](size_t shard) { total += shard + 1; });
+    EXPECT_EQ(total.load(), num_shards * (num_shards + 1) / 2);
+  }
+  EXPECT_EQ(workers.num_threads(), 5U);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -23,10 +23,13 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
+#include <thread>
 #include <utility>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/hash/hash.h>
 #include <absl/strings/match.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/delimited_message_util.h>
@@ -104,6 +107,10 @@ DEFINE_int32(stirling_enable_amqp_tracing, px::stirling::TraceMode::On,
 DEFINE_bool(stirling_disable_self_tracing, true,
             "If true, stirling will not trace and process syscalls made by itself.");
 
+DEFINE_int32(stirling_conn_tracker_threads, 1,
+             "The number of threads that parse and stitch the data of the connection trackers. "
+             "The trackers are sharded across the threads by their conn_id.");
+
 // Assume a moderate default network bandwidth peak of 100MiB/s across socket connections for data.
 DEFINE_uint32(stirling_socket_tracer_target_data_bw_percpu, 100 * 1024 * 1024,
               "Target bytes/sec of data per CPU");
@@ -715,13 +722,6 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
   }
 
   for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
-    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
-
-    DataTable* data_table = nullptr;
-    if (transfer_spec.enabled) {
-      data_table = data_tables_[transfer_spec.table_num];
-    }
-
     UpdateTrackerTraceLevel(conn_tracker);
 
     // Once a known UPID, always a known UPID.
@@ -735,17 +735,11 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
 
     conn_tracker->IterationPreTick(iteration_time_, cluster_cidrs, proc_parser_.get(),
                                    socket_info_mgr_.get());
+  }
 
-    if (transfer_spec.transfer_fn != nullptr) {
-      transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table);
-    } else {
-      // If there's no transfer function, then the tracker should not be holding any data.
-      // http::ProtocolTraits is used as a placeholder; the frames deque is expected to be
-      // std::monotstate.
-      ECHECK(conn_tracker->send_data().Empty<protocols::http::Message>());
-      ECHECK(conn_tracker->recv_data().Empty<protocols::http::Message>());
-    }
+  TransferConnTrackers(ctx);
 
+  for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
     conn_tracker->IterationPostTick();
   }
 
@@ -792,28 +786,32 @@ void SocketTraceConnector::HandleDataEvent(void* cb_cookie, void* data, int data
   auto* connector = static_cast<SocketTraceConnector*>(cb_cookie);
   connector->stats_.Increment(StatKey::kPollSocketDataEventSize, data_size);
 
-  std::unique_ptr<SocketDataEvent> data_event_ptr = std::make_unique<SocketDataEvent>(data);
+  // The events only live for the duration of this callback: the payload is copied straight from
+  // the perf buffer into the DataStreamBuffer of the connection, so nothing is allocated per event.
+  SocketDataEvent data_event(data);
 
   // The servers of certain protocols (e.g. Kafka) read the length headers of frames separately
   // from the payload. In these cases, the protocol inference misses the header of the first frame.
   // This header is encoded in the attributes instead.
   // We account for this with a separate header event.
-  std::unique_ptr<SocketDataEvent> header_event_ptr = data_event_ptr->ExtractHeaderEvent();
+  SocketDataEvent header_event;
+  bool has_header_event = data_event.ExtractHeaderEvent(&header_event);
 
   // In some scenarios when we are unable to trace the data (notably including sendfile syscalls),
   // we create a filler event instead. This is important to Kafka, for example,
   // where the sendfile data is in the payload and the protocol parser can still succeed
   // as long as it is properly accounted for.
-  std::unique_ptr<SocketDataEvent> filler_event_ptr = data_event_ptr->ExtractFillerEvent();
+  SocketDataEvent filler_event;
+  bool has_filler_event = data_event.ExtractFillerEvent(&filler_event);
 
-  if (header_event_ptr) {
-    connector->AcceptDataEvent(std::move(header_event_ptr));
+  if (has_header_event) {
+    connector->AcceptDataEvent(header_event);
   }
-  if (data_event_ptr && !data_event_ptr->msg.empty()) {
-    connector->AcceptDataEvent(std::move(data_event_ptr));
+  if (!data_event.msg.empty()) {
+    connector->AcceptDataEvent(data_event);
   }
-  if (filler_event_ptr) {
-    connector->AcceptDataEvent(std::move(filler_event_ptr));
+  if (has_filler_event) {
+    connector->AcceptDataEvent(filler_event);
   }
 }
 
@@ -883,14 +881,15 @@ void SocketTraceConnector::HandleHTTP2Event(void* cb_cookie, void* data, int /*d
     } break;
     case kDataFrameEventRead:
     case kDataFrameEventWrite: {
-      auto event = std::make_unique<HTTP2DataEvent>(data);
+      // The payload is a view into the perf buffer, which stays valid for this callback.
+      HTTP2DataEvent event(data);
 
       VLOG(3) << absl::Substitute(
           "t=$0 pid=$1 type=$2 fd=$3 tsid=$4 stream_id=$5 end_stream=$6 data=$7",
-          event->attr.timestamp_ns, event->attr.conn_id.upid.pid,
-          magic_enum::enum_name(event->attr.event_type), event->attr.conn_id.fd,
-          event->attr.conn_id.tsid, event->attr.stream_id, event->attr.end_stream, event->payload);
-      connector->AcceptHTTP2Data(std::move(event));
+          event.attr.timestamp_ns, event.attr.conn_id.upid.pid,
+          magic_enum::enum_name(event.attr.event_type), event.attr.conn_id.fd,
+          event.attr.conn_id.tsid, event.attr.stream_id, event.attr.end_stream, event.payload);
+      connector->AcceptHTTP2Data(event);
     } break;
     default:
       LOG(DFATAL) << absl::Substitute("Unexpected event_type $0",
@@ -921,11 +920,11 @@ void SocketTraceConnector::HandleGrpcCEvent(void* cb_cookie, void* data, int /*d
   DCHECK(cb_cookie != nullptr) << "Perf buffer callback not set-up properly. Missing cb_cookie.";
 
   auto* connector = static_cast<SocketTraceConnector*>(cb_cookie);
-  struct grpc_c_event_data_t* event_data = static_cast<struct grpc_c_event_data_t*>(data);
-  // TODO(yzhao): Implement a C++ companion of the C struct so that smart object management applies.
-  auto event = std::make_unique<struct grpc_c_event_data_t>(*event_data);
+  // The perf buffer data may be unaligned, so copy it into the preallocated buffer before reading
+  // its fields.
+  std::memcpy(connector->grpc_c_event_buffer_.get(), data, sizeof(struct grpc_c_event_data_t));
 
-  connector->AcceptGrpcCEventData(std::move(event));
+  connector->AcceptGrpcCEventData(*connector->grpc_c_event_buffer_);
 }
 
 void SocketTraceConnector::HandleGrpcCCloseEvent(void* cb_cookie, void* data, int /*data_size*/) {
@@ -968,17 +967,17 @@ ConnTracker& SocketTraceConnector::GetOrCreateConnTracker(struct conn_id_t conn_
   return tracker;
 }
 
-void SocketTraceConnector::AcceptDataEvent(std::unique_ptr<SocketDataEvent> event) {
+void SocketTraceConnector::AcceptDataEvent(const SocketDataEvent& event) {
   if (perf_buffer_events_output_stream_ != nullptr) {
-    WriteDataEvent(*event);
+    WriteDataEvent(event);
   }
 
   stats_.Increment(StatKey::kPollSocketDataEventCount);
-  stats_.Increment(StatKey::kPollSocketDataEventAttrSize, sizeof(event->attr));
-  stats_.Increment(StatKey::kPollSocketDataEventDataSize, event->msg.size());
+  stats_.Increment(StatKey::kPollSocketDataEventAttrSize, sizeof(event.attr));
+  stats_.Increment(StatKey::kPollSocketDataEventDataSize, event.msg.size());
 
-  ConnTracker& tracker = GetOrCreateConnTracker(event->attr.conn_id);
-  tracker.AddDataEvent(std::move(event));
+  ConnTracker& tracker = GetOrCreateConnTracker(event.attr.conn_id);
+  tracker.AddDataEvent(event);
 }
 
 void SocketTraceConnector::AcceptControlEvent(socket_control_event_t event) {
@@ -996,15 +995,15 @@ void SocketTraceConnector::AcceptHTTP2Header(std::unique_ptr<HTTP2HeaderEvent> e
   tracker.AddHTTP2Header(std::move(event));
 }
 
-void SocketTraceConnector::AcceptHTTP2Data(std::unique_ptr<HTTP2DataEvent> event) {
-  ConnTracker& tracker = GetOrCreateConnTracker(event->attr.conn_id);
-  tracker.AddHTTP2Data(std::move(event));
+void SocketTraceConnector::AcceptHTTP2Data(const HTTP2DataEvent& event) {
+  ConnTracker& tracker = GetOrCreateConnTracker(event.attr.conn_id);
+  tracker.AddHTTP2Data(event);
 }
 
 void SocketTraceConnector::AcceptGrpcCEvent(struct conn_id_t connection_id, uint32_t stream_id,
                                             uint64_t timestamp, bool outgoing,
                                             uint64_t position_in_stream,
-                                            std::vector<struct grpc_c_data_slice_t> slices) {
+                                            absl::Span<const struct grpc_c_data_slice_t> slices) {
   // Initiate data event template as if it arrived from Golang gRPC eBPF.
   struct go_grpc_data_event_t data_event_go_style = {};
 
@@ -1021,7 +1020,7 @@ void SocketTraceConnector::AcceptGrpcCEvent(struct conn_id_t connection_id, uint
   data_event_go_style.attr.conn_id = connection_id;
 
   uint64_t extra_position = 0;
-  for (struct grpc_c_data_slice_t data_slice : slices) {
+  for (const struct grpc_c_data_slice_t& data_slice : slices) {
     struct go_grpc_data_event_t current_data_event = data_event_go_style;
     current_data_event.data_attr.pos = position_in_stream += extra_position;
     extra_position += data_slice.length;  // Add extra position for next slices.
@@ -1034,28 +1033,25 @@ void SocketTraceConnector::AcceptGrpcCEvent(struct conn_id_t connection_id, uint
                                        (uint32_t)data_slice.length, (uint32_t)GRPC_C_SLICE_SIZE);
     }
 
-    auto d_event_ready = std::make_unique<HTTP2DataEvent>();
-    d_event_ready->attr = current_data_event.attr;
-    d_event_ready->data_attr = current_data_event.data_attr;
-    d_event_ready->payload =
+    HTTP2DataEvent d_event_ready;
+    d_event_ready.attr = current_data_event.attr;
+    d_event_ready.data_attr = current_data_event.data_attr;
+    d_event_ready.payload =
         std::string_view(data_slice.bytes, current_data_event.data_attr.data_buf_size);
-    this->AcceptHTTP2Data(std::move(d_event_ready));
+    this->AcceptHTTP2Data(d_event_ready);
   }
 }
 
-void SocketTraceConnector::AcceptGrpcCEventData(std::unique_ptr<struct grpc_c_event_data_t> event) {
-  if (event->direction != kIngress && event->direction != kEgress) {
+void SocketTraceConnector::AcceptGrpcCEventData(const struct grpc_c_event_data_t& event) {
+  if (event.direction != kIngress && event.direction != kEgress) {
     LOG(WARNING) << absl::Substitute("gRPC-C event from pid $0 with invalid direction $1",
-                                     event->conn_id.upid.pid, event->direction);
+                                     event.conn_id.upid.pid, event.direction);
     return;
   }
 
-  // Prepare list of slices.
-  std::vector<struct grpc_c_data_slice_t> slices(0);
-  slices.push_back(event->slice);
-
-  this->AcceptGrpcCEvent(event->conn_id, event->stream_id, event->timestamp,
-                         event->direction == kEgress, event->position_in_stream, std::move(slices));
+  this->AcceptGrpcCEvent(event.conn_id, event.stream_id, event.timestamp,
+                         event.direction == kEgress, event.position_in_stream,
+                         absl::MakeConstSpan(&event.slice, 1));
 }
 
 void SocketTraceConnector::InitiateHeaderEventDataGoStyle(
@@ -1200,12 +1196,14 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("major_version")>(1);
   r.Append<r.ColIndex("minor_version")>(resp_message.minor_version);
   r.Append<r.ColIndex("content_type")>(static_cast<uint64_t>(content_type));
-  r.Append<r.ColIndex("req_headers")>(ToJSONString(req_message.headers), kMaxHTTPHeadersBytes);
+  r.Append<r.ColIndex("req_headers")>(protocols::http::ToJSONString(req_message.headers),
+                                      kMaxHTTPHeadersBytes);
   r.Append<r.ColIndex("req_method")>(std::move(req_message.req_method));
   r.Append<r.ColIndex("req_path")>(std::move(req_message.req_path));
   r.Append<r.ColIndex("req_body_size")>(req_message.body_size);
   r.Append<r.ColIndex("req_body")>(std::move(req_message.body), FLAGS_max_body_bytes);
-  r.Append<r.ColIndex("resp_headers")>(ToJSONString(resp_message.headers), kMaxHTTPHeadersBytes);
+  r.Append<r.ColIndex("resp_headers")>(protocols::http::ToJSONString(resp_message.headers),
+                                       kMaxHTTPHeadersBytes);
   r.Append<r.ColIndex("resp_status")>(resp_message.resp_status);
   r.Append<r.ColIndex("resp_message")>(std::move(resp_message.resp_message));
   r.Append<r.ColIndex("resp_body_size")>(resp_message.body_size);
@@ -1547,6 +1545,8 @@ void SocketDataEventToPB(const SocketDataEvent& event, sockeventpb::SocketDataEv
   pb->mutable_attr()->set_direction(event.attr.direction);
   pb->mutable_attr()->set_pos(event.attr.pos);
   pb->mutable_attr()->set_msg_size(event.attr.msg_size);
+  pb->mutable_attr()->set_ssl(event.attr.ssl);
+  pb->mutable_attr()->set_source_fn(event.attr.source_fn);
   pb->set_msg(std::string(event.msg));
 }
 }  // namespace
@@ -1611,6 +1611,75 @@ void SocketTraceConnector::TransferStream(ConnectorContext* ctx, ConnTracker* tr
                                     message_expiry_timestamp, buffer_expiry_timestamp);
 }
 
+void SocketTraceConnector::TransferConnTracker(ConnectorContext* ctx, ConnTracker* tracker,
+                                               const std::vector<DataTable*>& data_tables) {
+  const auto& transfer_spec = protocol_transfer_specs_[tracker->protocol()];
+
+  DataTable* data_table = nullptr;
+  if (transfer_spec.enabled) {
+    data_table = data_tables[transfer_spec.table_num];
+  }
+
+  if (transfer_spec.transfer_fn != nullptr) {
+    transfer_spec.transfer_fn(*this, ctx, tracker, data_table);
+  } else {
+    // If there's no transfer function, then the tracker should not be holding any data.
+    // http::ProtocolTraits is used as a placeholder; the frames deque is expected to be
+    // std::monotstate.
+    ECHECK(tracker->send_data().Empty<protocols::http::Message>());
+    ECHECK(tracker->recv_data().Empty<protocols::http::Message>());
+  }
+}
+
+void SocketTraceConnector::TransferConnTrackers(ConnectorContext* ctx) {
+  const std::list<ConnTracker*>& trackers = conn_trackers_mgr_.active_trackers();
+  const size_t num_shards =
+      std::min<size_t>(std::max(FLAGS_stirling_conn_tracker_threads, 1), trackers.size());
+
+  if (num_shards <= 1) {
+    for (ConnTracker* tracker : trackers) {
+      TransferConnTracker(ctx, tracker, data_tables_);
+    }
+    return;
+  }
+
+  // Parsing and stitching only touch the tracker itself, so the shards don't share any state other
+  // than the tables they append to. A connection always lands in the same shard.
+  std::vector<std::vector<ConnTracker*>> shards(num_shards);
+  for (ConnTracker* tracker : trackers) {
+    shards[absl::Hash<conn_id_t>{}(tracker->conn_id()) % num_shards].push_back(tracker);
+  }
+
+  while (shard_data_tables_.size() < num_shards - 1) {
+    shard_data_tables_.push_back(std::make_unique<DataTables>(kTables));
+  }
+  std::vector<std::vector<DataTable*>> shard_tables(num_shards);
+  shard_tables[0] = data_tables_;
+  for (size_t i = 1; i < num_shards; ++i) {
+    shard_tables[i] = shard_data_tables_[i - 1]->tables();
+    // Disabled tables stay disabled.
+    for (size_t j = 0; j < data_tables_.size(); ++j) {
+      if (data_tables_[j] == nullptr) {
+        shard_tables[i][j] = nullptr;
+      }
+    }
+  }
+
+  conn_tracker_workers_.Run(num_shards, [&](size_t i) {
+    for (ConnTracker* tracker : shards[i]) {
+      TransferConnTracker(ctx, tracker, shard_tables[i]);
+    }
+  });
+
+  for (size_t i = 1; i < num_shards; ++i) {
+    for (size_t j = 0; j < data_tables_.size(); ++j) {
+      if (data_tables_[j] != nullptr) {
+        data_tables_[j]->MoveRecordsFrom(shard_tables[i][j]);
+      }
+    }
+  }
+}
+
 void SocketTraceConnector::TransferConnStats(ConnectorContext* ctx, DataTable* data_table) {
   namespace idx = ::px::stirling::conn_stats_idx;
 
@@ -29,6 +29,7 @@
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/synchronization/mutex.h>
+#include <absl/types/span.h>
 
 #include "src/common/grpcutils/service_descriptor_database.h"
 #include "src/common/metrics/metrics.h"
@@ -37,12 +38,14 @@
 #include "src/stirling/obj_tools/dwarf_reader.h"
 #include "src/stirling/obj_tools/elf_reader.h"
 
+#include "src/stirling/core/data_tables.h"
 #include "src/stirling/core/source_connector.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/grpc_c.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
 #include "src/stirling/source_connectors/socket_tracer/conn_stats.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_tracker.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
+#include "src/stirling/source_connectors/socket_tracer/shard_workers.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_bpf_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/uprobe_manager.h"
@@ -66,6 +69,7 @@ DECLARE_int32(stirling_enable_mux_tracing);
 DECLARE_int32(stirling_enable_amqp_tracing);
 DECLARE_bool(stirling_disable_self_tracing);
 DECLARE_string(stirling_role_to_trace);
+DECLARE_int32(stirling_conn_tracker_threads);
 
 DECLARE_uint32(stirling_socket_tracer_target_data_bw_percpu);
 DECLARE_uint32(stirling_socket_tracer_target_control_bw_percpu);
@@ -187,16 +191,18 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   ConnTracker& GetOrCreateConnTracker(struct conn_id_t conn_id);
 
   // Events from BPF.
-  void AcceptDataEvent(std::unique_ptr<SocketDataEvent> event);
+  void AcceptDataEvent(const SocketDataEvent& event);
+  void AcceptDataEvent(std::unique_ptr<SocketDataEvent> event) { AcceptDataEvent(*event); }
   void AcceptControlEvent(socket_control_event_t event);
   void AcceptConnStatsEvent(conn_stats_event_t event);
   void AcceptHTTP2Header(std::unique_ptr<HTTP2HeaderEvent> event);
-  void AcceptHTTP2Data(std::unique_ptr<HTTP2DataEvent> event);
-  void AcceptGrpcCEventData(std::unique_ptr<struct grpc_c_event_data_t> event);
+  void AcceptHTTP2Data(const HTTP2DataEvent& event);
+  void AcceptHTTP2Data(std::unique_ptr<HTTP2DataEvent> event) { AcceptHTTP2Data(*event); }
+  void AcceptGrpcCEventData(const struct grpc_c_event_data_t& event);
   void AcceptGrpcCHeaderEventData(std::unique_ptr<struct grpc_c_header_event_data_t> event);
   void AcceptGrpcCEvent(struct conn_id_t connection_id, uint32_t stream_id, uint64_t timestamp,
                         bool outgoing, uint64_t position_in_stream,
-                        std::vector<struct grpc_c_data_slice_t> slices);
+                        absl::Span<const struct grpc_c_data_slice_t> slices);
   void AcceptGrpcCCloseEvent(std::unique_ptr<struct grpc_c_stream_closed_data> event);
   void InitiateHeaderEventDataGoStyle(
       struct conn_id_t conn_id, uint32_t stream_id, uint64_t timestamp, bool end_stream,
@@ -207,6 +213,12 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   void TransferStream(ConnectorContext* ctx, ConnTracker* tracker, DataTable* data_table);
   void TransferConnStats(ConnectorContext* ctx, DataTable* data_table);
 
+  // Runs the transfer function of every active tracker. The trackers are sharded by conn_id across
+  // --stirling_conn_tracker_threads threads, see shard_data_tables_.
+  void TransferConnTrackers(ConnectorContext* ctx);
+  void TransferConnTracker(ConnectorContext* ctx, ConnTracker* tracker,
+                           const std::vector<DataTable*>& data_tables);
+
   void set_iteration_time(std::chrono::time_point<std::chrono::steady_clock> time) {
     DCHECK(time >= iteration_time_);
     iteration_time_ = time;
@@ -263,6 +275,19 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // The transfer_fn defines which function is called to process the data for transfer.
   std::vector<TransferSpec> protocol_transfer_specs_;
 
+  // When the trackers are processed by multiple threads, the first shard appends its records to
+  // data_tables_ and every other shard to its own tables here. Those records are moved to
+  // data_tables_ once all shards are done, and their timestamps still order them when the tables
+  // are consumed. The tables are kept across iterations to reuse their buffers.
+  std::vector<std::unique_ptr<DataTables>> shard_data_tables_;
+  // The threads that process the shards other than the first, kept across iterations.
+  ShardWorkers conn_tracker_workers_;
+
+  // An aligned copy of the gRPC-C event being handled. It is several KB large, so it is allocated
+  // once rather than for every event.
+  std::unique_ptr<struct grpc_c_event_data_t> grpc_c_event_buffer_ =
+      std::make_unique<struct grpc_c_event_data_t>();
+
   // The time at which TransferDataImpl() begin. Used as a universal timestamp for the iteration,
   // to avoid too many calls to std::chrono::steady_clock::now().
   std::chrono::time_point<std::chrono::steady_clock> iteration_time_;
@@ -18,6 +18,10 @@
 
 #include <gflags/gflags.h>
 
+#include <cstring>
+#include <memory>
+#include <vector>
+
 #include <absl/container/flat_hash_set.h>
 #include <absl/strings/str_split.h>
 #include <benchmark/benchmark.h>
@@ -220,6 +224,106 @@ static void BM_SocketTraceConnector(benchmark::State& state, BenchmarkDataGenera
 #undef MEM_COUNTER
 }
 
+// Benchmark of the path from the perf buffer callback to the DataStreamBuffer of a connection,
+// which runs once for every data event. Each event is handled in place and its payload is copied
+// once into the connection's buffer. The trackers are drained by TransferData between batches,
+// outside of the timed part.
+
+namespace {
+
+constexpr int kEventsPerBatch = 64;
+
+std::vector<socket_data_event_t> GenDataEventBatch(size_t payload_size) {
+  std::vector<socket_data_event_t> events(kEventsPerBatch);
+  for (auto& event : events) {
+    event.attr.protocol = kProtocolHTTP;
+    event.attr.role = kRoleServer;
+    event.attr.direction = kIngress;
+    event.attr.conn_id.upid.pid = 1;
+    event.attr.conn_id.fd = 3;
+    event.attr.msg_size = payload_size;
+    event.attr.msg_buf_size = payload_size;
+    memset(event.msg, 'a', payload_size);
+  }
+  return events;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE: runtime/references.
+static void BM_HandleDataEvent(benchmark::State& state) {
+  const size_t payload_size = state.range(0);
+  std::vector<socket_data_event_t> events = GenDataEventBatch(payload_size);
+
+  SystemWideStandaloneContext ctx;
+  auto source_connector = SocketTraceConnectorFriend::Create("socket_trace_connector");
+  auto socket_trace_connector = static_cast<SocketTraceConnectorFriend*>(source_connector.get());
+  px::stirling::DataTables tables(SocketTraceConnector::kTables);
+  source_connector->set_data_tables({tables.tables()});
+
+  uint64_t pos = 0;
+  uint64_t ts = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (auto& event : events) {
+      event.attr.pos = pos;
+      event.attr.timestamp_ns = ++ts;
+      pos += payload_size;
+    }
+    state.ResumeTiming();
+
+    for (auto& event : events) {
+      socket_trace_connector->HandleDataEvent(&event,
+                                              sizeof(socket_data_event_t::attr) + payload_size);
+    }
+
+    state.PauseTiming();
+    source_connector->TransferData(&ctx);
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(kEventsPerBatch * state.iterations());
+  state.SetBytesProcessed(kEventsPerBatch * payload_size * state.iterations());
+}
+
+// The same path with a heap allocated event per callback, as a baseline for BM_HandleDataEvent.
+// NOLINTNEXTLINE: runtime/references.
+static void BM_HandleDataEventHeapAllocated(benchmark::State& state) {
+  const size_t payload_size = state.range(0);
+  std::vector<socket_data_event_t> events = GenDataEventBatch(payload_size);
+
+  SystemWideStandaloneContext ctx;
+  auto source_connector = SocketTraceConnectorFriend::Create("socket_trace_connector");
+  auto socket_trace_connector = static_cast<SocketTraceConnectorFriend*>(source_connector.get());
+  px::stirling::DataTables tables(SocketTraceConnector::kTables);
+  source_connector->set_data_tables({tables.tables()});
+
+  uint64_t pos = 0;
+  uint64_t ts = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (auto& event : events) {
+      event.attr.pos = pos;
+      event.attr.timestamp_ns = ++ts;
+      pos += payload_size;
+    }
+    state.ResumeTiming();
+
+    for (auto& event : events) {
+      socket_trace_connector->AcceptDataEvent(
+          std::make_unique<px::stirling::SocketDataEvent>(&event));
+    }
+
+    state.PauseTiming();
+    source_connector->TransferData(&ctx);
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(kEventsPerBatch * state.iterations());
+  state.SetBytesProcessed(kEventsPerBatch * payload_size * state.iterations());
+}
+
+BENCHMARK(BM_HandleDataEvent)->RangeMultiplier(4)->Range(64, 16 * 1024);
+BENCHMARK(BM_HandleDataEventHeapAllocated)->RangeMultiplier(4)->Range(64, 16 * 1024);
+
 constexpr uint64_t kRecordSize = 128 * 1024;
 BENCHMARK_CAPTURE(BM_SocketTraceConnector, http1_no_gaps,
                   BenchmarkDataGenerationSpec{
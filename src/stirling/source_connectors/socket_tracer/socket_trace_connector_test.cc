@@ -18,6 +18,7 @@
 
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_connector.h"
 
+#include <algorithm>
 #include <memory>
 
 #include <absl/functional/bind_front.h>
@@ -223,6 +224,36 @@ TEST_F(SocketTraceConnectorTest, Basic) {
   EXPECT_THAT(ToStringVector(records[kHTTPRespBodyIdx]), ElementsAre("foo"));
 }
 
+TEST_F(SocketTraceConnectorTest, ShardedConnTrackers) {
+  PX_SET_FOR_SCOPE(FLAGS_stirling_conn_tracker_threads, 4);
+
+  // Enough connections for every shard to get some.
+  constexpr int kNumConns = 32;
+  std::vector<std::unique_ptr<testing::EventGenerator>> event_gens;
+  for (int fd = 0; fd < kNumConns; ++fd) {
+    event_gens.push_back(std::make_unique<testing::EventGenerator>(&mock_clock_, kPID, fd));
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    for (auto& event_gen : event_gens) {
+      if (i == 0) {
+        source_->AcceptControlEvent(event_gen->InitConn());
+      }
+      source_->AcceptDataEvent(event_gen->InitSendEvent<kProtocolHTTP>(kReq0));
+      source_->AcceptDataEvent(event_gen->InitRecvEvent<kProtocolHTTP>(kResp0));
+    }
+    connector_->TransferData(ctx_.get());
+  }
+
+  std::vector<TaggedRecordBatch> tablets = http_table_->ConsumeRecords();
+  ASSERT_NOT_EMPTY_AND_GET_RECORDS(RecordBatch & records, tablets);
+
+  // Every record of every shard makes it to the table, in time order.
+  ASSERT_THAT(records, RecordBatchSizeIs(2 * kNumConns));
+  std::vector<int64_t> times = ToIntVector<types::Time64NSValue>(records[kHTTPTimeIdx]);
+  EXPECT_TRUE(std::is_sorted(times.begin(), times.end()));
+}
+
 TEST_F(SocketTraceConnectorTest, HTTPDelayedRespBody) {
   struct socket_control_event_t conn = event_gen_.InitConn();
   std::unique_ptr<SocketDataEvent> event0_req = event_gen_.InitSendEvent<kProtocolHTTP>(kReq4);
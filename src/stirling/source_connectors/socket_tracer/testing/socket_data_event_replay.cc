@@ -0,0 +1,239 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/testing/socket_data_event_replay.h"
+
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/util/delimited_message_util.h>
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include <absl/container/flat_hash_set.h>
+#include <magic_enum.hpp>
+
+#include "src/common/base/file.h"
+#include "src/common/testing/test_environment.h"
+#include "src/stirling/core/connector_context.h"
+#include "src/stirling/core/data_tables.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/socket_trace_connector_friend.h"
+
+namespace px {
+namespace stirling {
+namespace testing {
+
+namespace {
+
+StatusOr<std::vector<sockeventpb::SocketDataEvent>> ParseBinaryEvents(std::string_view contents) {
+  google::protobuf::io::ArrayInputStream stream(contents.data(), contents.size());
+  std::vector<sockeventpb::SocketDataEvent> events;
+  while (true) {
+    sockeventpb::SocketDataEvent pb;
+    bool clean_eof = false;
+    if (!google::protobuf::util::ParseDelimitedFromZeroCopyStream(&pb, &stream, &clean_eof)) {
+      if (clean_eof) {
+        break;
+      }
+      return error::Internal("Malformed socket data event after $0 events.", events.size());
+    }
+    events.push_back(std::move(pb));
+  }
+  return events;
+}
+
+StatusOr<std::vector<sockeventpb::SocketDataEvent>> ParseTextEvents(std::string_view contents) {
+  // The printed events are concatenated, and each of them starts with its top-level attr field.
+  constexpr std::string_view kEventStart = "attr {";
+
+  std::vector<std::string_view> event_texts;
+  size_t start = std::string_view::npos;
+  size_t line_start = 0;
+  while (line_start < contents.size()) {
+    size_t line_end = contents.find('\n', line_start);
+    if (line_end == std::string_view::npos) {
+      line_end = contents.size();
+    }
+    if (contents.substr(line_start, line_end - line_start) == kEventStart) {
+      if (start != std::string_view::npos) {
+        event_texts.push_back(contents.substr(start, line_start - start));
+      }
+      start = line_start;
+    }
+    line_start = line_end + 1;
+  }
+  if (start != std::string_view::npos) {
+    event_texts.push_back(contents.substr(start));
+  }
+
+  std::vector<sockeventpb::SocketDataEvent> events(event_texts.size());
+  for (size_t i = 0; i < event_texts.size(); ++i) {
+    if (!google::protobuf::TextFormat::ParseFromString(std::string(event_texts[i]), &events[i])) {
+      return error::Internal("Malformed socket data event $0.", i);
+    }
+  }
+  return events;
+}
+
+std::string ProtocolName(uint32_t protocol) {
+  return std::string(magic_enum::enum_name(static_cast<traffic_protocol_t>(protocol)));
+}
+
+double PerSecond(uint64_t count, std::chrono::nanoseconds duration) {
+  if (duration.count() == 0) {
+    return 0;
+  }
+  return count / std::chrono::duration<double>(duration).count();
+}
+
+}  // namespace
+
+StatusOr<std::vector<sockeventpb::SocketDataEvent>> ReadSocketDataEvents(
+    const std::filesystem::path& path) {
+  const bool binary = path.extension() == ".bin";
+  PX_ASSIGN_OR_RETURN(std::string contents,
+                      ReadFileToString(path.string(), binary ? std::ios_base::in | std::ios::binary
+                                                             : std::ios_base::in));
+  if (binary) {
+    return ParseBinaryEvents(contents);
+  }
+  return ParseTextEvents(contents);
+}
+
+std::unique_ptr<SocketDataEvent> SocketDataEventFromPB(const sockeventpb::SocketDataEvent& pb) {
+  auto event = std::make_unique<SocketDataEvent>();
+  const auto& attr = pb.attr();
+  event->attr.timestamp_ns = attr.timestamp_ns();
+  event->attr.conn_id.upid.pid = attr.conn_id().pid();
+  event->attr.conn_id.upid.start_time_ticks = attr.conn_id().start_time_ns();
+  event->attr.conn_id.fd = attr.conn_id().fd();
+  event->attr.conn_id.tsid = attr.conn_id().generation();
+  event->attr.protocol = static_cast<traffic_protocol_t>(attr.protocol());
+  event->attr.role = static_cast<endpoint_role_t>(attr.role());
+  event->attr.direction = static_cast<traffic_direction_t>(attr.direction());
+  event->attr.ssl = attr.ssl();
+  event->attr.source_fn = static_cast<source_function_t>(attr.source_fn());
+  event->attr.pos = attr.pos();
+  event->attr.msg_size = attr.msg_size();
+  event->attr.msg_buf_size = pb.msg().size();
+  event->msg = pb.msg();
+  return event;
+}
+
+void ReplayStats::Merge(const ReplayStats& other) {
+  elapsed += other.elapsed;
+  busy += other.busy;
+  for (const auto& [protocol, stats] : other.protocols) {
+    protocols[protocol].events += stats.events;
+    protocols[protocol].bytes += stats.bytes;
+  }
+  for (const auto& [table, num_records] : other.records) {
+    records[table] += num_records;
+  }
+}
+
+std::string ReplayStats::ToString() const {
+  using std::chrono::duration_cast;
+  using std::chrono::milliseconds;
+
+  std::string out = absl::Substitute("elapsed=$0ms busy=$1ms\n",
+                                     duration_cast<milliseconds>(elapsed).count(),
+                                     duration_cast<milliseconds>(busy).count());
+  for (const auto& [protocol, stats] : protocols) {
+    absl::StrAppend(&out, absl::Substitute("  $0: events=$1 ($2/s) bytes=$3 ($4 MB/s)\n", protocol,
+                                           stats.events, PerSecond(stats.events, busy),
+                                           stats.bytes, PerSecond(stats.bytes, busy) / 1e6));
+  }
+  for (const auto& [table, num_records] : records) {
+    if (num_records == 0) {
+      continue;
+    }
+    absl::StrAppend(&out, absl::Substitute("  $0: records=$1 ($2/s)\n", table, num_records,
+                                           PerSecond(num_records, busy)));
+  }
+  return out;
+}
+
+StatusOr<ReplayStats> ReplaySocketDataEvents(
+    const std::vector<sockeventpb::SocketDataEvent>& events, const ReplayOptions& options) {
+  using std::chrono::steady_clock;
+
+  // The processes of the capture are gone, so their connections can't be checked in /proc.
+  PX_SET_FOR_SCOPE(FLAGS_stirling_check_proc_for_conn_close, false);
+
+  DataTables data_tables(SocketTraceConnector::kTables);
+  SocketTraceConnectorFriend connector("socket_trace_replay");
+  connector.set_data_tables(data_tables.tables());
+
+  absl::flat_hash_set<md::UPID> upids;
+  for (const auto& event : events) {
+    upids.emplace(/*asid*/ 0, event.attr().conn_id().pid(), event.attr().conn_id().start_time_ns());
+  }
+  StandaloneContext ctx(upids);
+
+  uint64_t now_ns = events.empty() ? 0 : events.front().attr().timestamp_ns();
+  connector.test_only_set_now_fn(
+      [&now_ns]() { return steady_clock::time_point(std::chrono::nanoseconds(now_ns)); });
+
+  ReplayStats stats;
+  auto transfer_data = [&]() {
+    auto start = steady_clock::now();
+    connector.TransferData(&ctx);
+    stats.busy += steady_clock::now() - start;
+    for (size_t i = 0; i < SocketTraceConnector::kTables.size(); ++i) {
+      uint64_t& num_records = stats.records[std::string(SocketTraceConnector::kTables[i].name())];
+      for (const auto& tagged_record_batch : data_tables[i]->ConsumeRecords()) {
+        if (!tagged_record_batch.records.empty()) {
+          num_records += tagged_record_batch.records[0]->Size();
+        }
+      }
+    }
+  };
+
+  const auto replay_start = steady_clock::now();
+  uint64_t next_transfer_ns = now_ns + options.transfer_period.count();
+  for (const auto& event : events) {
+    const uint64_t timestamp_ns = event.attr().timestamp_ns();
+    if (options.recorded_pace && timestamp_ns > now_ns) {
+      std::this_thread::sleep_for(std::chrono::nanoseconds(timestamp_ns - now_ns));
+    }
+    now_ns = std::max(now_ns, timestamp_ns);
+    if (now_ns >= next_transfer_ns) {
+      transfer_data();
+      next_transfer_ns = now_ns + options.transfer_period.count();
+    }
+
+    ProtocolReplayStats& protocol_stats = stats.protocols[ProtocolName(event.attr().protocol())];
+    ++protocol_stats.events;
+    protocol_stats.bytes += event.msg().size();
+
+    auto start = steady_clock::now();
+    connector.AcceptDataEvent(SocketDataEventFromPB(event));
+    stats.busy += steady_clock::now() - start;
+  }
+  // Flush whatever the last events completed.
+  transfer_data();
+  stats.elapsed = steady_clock::now() - replay_start;
+
+  return stats;
+}
+
+}  // namespace testing
+}  // namespace stirling
+}  // namespace px
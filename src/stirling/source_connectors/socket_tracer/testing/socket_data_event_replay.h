@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/container/btree_map.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
+#include "src/stirling/source_connectors/socket_tracer/proto/sock_event.pb.h"
+#include "src/stirling/source_connectors/socket_tracer/socket_trace_connector.h"
+
+namespace px {
+namespace stirling {
+namespace testing {
+
+/**
+ * Reads a capture of the data events the socket tracer accepted, as written to
+ * --socket_trace_data_events_output_path. Captures ending in ".bin" hold length delimited
+ * messages, other captures hold the messages in text format, one after the other.
+ */
+StatusOr<std::vector<sockeventpb::SocketDataEvent>> ReadSocketDataEvents(
+    const std::filesystem::path& path);
+
+/**
+ * Converts a recorded event back to the event that the socket tracer accepted. The msg of the
+ * returned event points into the msg of pb.
+ */
+std::unique_ptr<SocketDataEvent> SocketDataEventFromPB(const sockeventpb::SocketDataEvent& pb);
+
+struct ReplayOptions {
+  // Replay the events at the pace they were recorded at, rather than as fast as the socket tracer
+  // can process them.
+  bool recorded_pace = false;
+
+  // How much recorded time passes between TransferData calls, as the socket tracer transfers data
+  // once per sampling period in production.
+  std::chrono::nanoseconds transfer_period = SocketTraceConnector::kSamplingPeriod;
+};
+
+struct ProtocolReplayStats {
+  uint64_t events = 0;
+  uint64_t bytes = 0;
+};
+
+struct ReplayStats {
+  // The wall time of the replay, and the part of it spent in the socket tracer.
+  std::chrono::nanoseconds elapsed{0};
+  std::chrono::nanoseconds busy{0};
+
+  // The replayed events, by protocol name.
+  absl::btree_map<std::string, ProtocolReplayStats> protocols;
+  // The records the socket tracer output, by table name.
+  absl::btree_map<std::string, uint64_t> records;
+
+  void Merge(const ReplayStats& other);
+
+  /**
+   * Returns the events/s and bytes/s of each protocol and the records/s of each table, over the
+   * time spent in the socket tracer.
+   */
+  std::string ToString() const;
+};
+
+/**
+ * Replays a capture through the user-space pipeline of a new socket tracer, without BPF: each
+ * event is handed to AcceptDataEvent(), and TransferData() runs the connection trackers, parsers
+ * and stitchers, and appends the records to the data tables.
+ *
+ * The socket tracer's clock follows the recorded timestamps, so connection timeouts behave as
+ * they did when the capture was taken. Captures don't hold control events, so connections are
+ * only opened implicitly by their first data event.
+ */
+StatusOr<ReplayStats> ReplaySocketDataEvents(
+    const std::vector<sockeventpb::SocketDataEvent>& events, const ReplayOptions& options);
+
+}  // namespace testing
+}  // namespace stirling
+}  // namespace px
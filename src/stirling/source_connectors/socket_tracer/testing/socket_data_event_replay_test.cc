@@ -0,0 +1,134 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/testing/socket_data_event_replay.h"
+
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/util/delimited_message_util.h>
+
+#include <fstream>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace testing {
+
+constexpr std::string_view kReq =
+    "GET /index.html HTTP/1.1\r\n"
+    "Host: www.pixielabs.ai\r\n"
+    "\r\n";
+
+constexpr std::string_view kResp =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: json\r\n"
+    "Content-Length: 3\r\n"
+    "\r\n"
+    "foo";
+
+sockeventpb::SocketDataEvent HTTPServerEvent(uint64_t timestamp_ns,
+                                             traffic_direction_t direction, uint64_t pos,
+                                             std::string_view msg) {
+  sockeventpb::SocketDataEvent pb;
+  pb.mutable_attr()->set_timestamp_ns(timestamp_ns);
+  pb.mutable_attr()->mutable_conn_id()->set_pid(123);
+  pb.mutable_attr()->mutable_conn_id()->set_start_time_ns(11000000);
+  pb.mutable_attr()->mutable_conn_id()->set_fd(4);
+  pb.mutable_attr()->mutable_conn_id()->set_generation(1);
+  pb.mutable_attr()->set_protocol(kProtocolHTTP);
+  pb.mutable_attr()->set_role(kRoleServer);
+  pb.mutable_attr()->set_direction(direction);
+  pb.mutable_attr()->set_pos(pos);
+  pb.mutable_attr()->set_msg_size(msg.size());
+  pb.mutable_attr()->set_source_fn(kSyscallRead);
+  pb.set_msg(std::string(msg));
+  return pb;
+}
+
+std::vector<sockeventpb::SocketDataEvent> HTTPCapture() {
+  return {HTTPServerEvent(1000, kIngress, 0, kReq), HTTPServerEvent(2000, kEgress, 0, kResp)};
+}
+
+TEST(SocketDataEventReplayTest, ReadBinaryCapture) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "events.bin";
+  {
+    std::ofstream out(path, std::ios::binary);
+    for (const auto& pb : HTTPCapture()) {
+      ASSERT_TRUE(google::protobuf::util::SerializeDelimitedToOstream(pb, &out));
+    }
+  }
+
+  ASSERT_OK_AND_ASSIGN(std::vector<sockeventpb::SocketDataEvent> events,
+                       ReadSocketDataEvents(path));
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_EQ(events[0].msg(), kReq);
+  EXPECT_EQ(events[1].msg(), kResp);
+}
+
+TEST(SocketDataEventReplayTest, ReadTextCapture) {
+  px::testing::TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "events.txt";
+  {
+    std::ofstream out(path);
+    for (const auto& pb : HTTPCapture()) {
+      std::string text;
+      ASSERT_TRUE(google::protobuf::TextFormat::PrintToString(pb, &text));
+      out << text;
+    }
+  }
+
+  ASSERT_OK_AND_ASSIGN(std::vector<sockeventpb::SocketDataEvent> events,
+                       ReadSocketDataEvents(path));
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_EQ(events[0].attr().timestamp_ns(), 1000);
+  EXPECT_EQ(events[0].msg(), kReq);
+  EXPECT_EQ(events[1].attr().direction(), kEgress);
+  EXPECT_EQ(events[1].msg(), kResp);
+}
+
+TEST(SocketDataEventReplayTest, EventFromPB) {
+  const sockeventpb::SocketDataEvent pb = HTTPServerEvent(1000, kIngress, 7, kReq);
+  std::unique_ptr<SocketDataEvent> event = SocketDataEventFromPB(pb);
+  EXPECT_EQ(event->attr.timestamp_ns, 1000);
+  EXPECT_EQ(event->attr.conn_id.upid.pid, 123);
+  EXPECT_EQ(event->attr.conn_id.upid.start_time_ticks, 11000000);
+  EXPECT_EQ(event->attr.conn_id.fd, 4);
+  EXPECT_EQ(event->attr.conn_id.tsid, 1);
+  EXPECT_EQ(event->attr.protocol, kProtocolHTTP);
+  EXPECT_EQ(event->attr.role, kRoleServer);
+  EXPECT_EQ(event->attr.direction, kIngress);
+  EXPECT_EQ(event->attr.source_fn, kSyscallRead);
+  EXPECT_EQ(event->attr.pos, 7);
+  EXPECT_EQ(event->attr.msg_size, kReq.size());
+  EXPECT_EQ(event->attr.msg_buf_size, kReq.size());
+  EXPECT_EQ(event->msg, kReq);
+}
+
+TEST(SocketDataEventReplayTest, ReplayHTTP) {
+  ASSERT_OK_AND_ASSIGN(ReplayStats stats, ReplaySocketDataEvents(HTTPCapture(), ReplayOptions{}));
+
+  ASSERT_TRUE(stats.protocols.contains("kProtocolHTTP"));
+  EXPECT_EQ(stats.protocols["kProtocolHTTP"].events, 2);
+  EXPECT_EQ(stats.protocols["kProtocolHTTP"].bytes, kReq.size() + kResp.size());
+  EXPECT_EQ(stats.records["http_events"], 1);
+}
+
+}  // namespace testing
+}  // namespace stirling
+}  // namespace px
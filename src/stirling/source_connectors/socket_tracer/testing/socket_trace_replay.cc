@@ -0,0 +1,68 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Replays a capture of socket data events, as written by --socket_trace_data_events_output_path,
+// through the user-space pipeline of the socket tracer and reports its throughput.
+//
+// Example:
+//   socket_trace_replay --capture=/tmp/events.bin --repeat=10
+
+#include <iostream>
+#include <string>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/socket_data_event_replay.h"
+
+DEFINE_string(capture, "", "The capture to replay. Captures ending in .bin are read as binary.");
+DEFINE_bool(recorded_pace, false,
+            "Replay the events at the pace they were recorded at, instead of as fast as possible.");
+DEFINE_int32(repeat, 1, "The number of times to replay the capture, each with a new tracer.");
+
+int main(int argc, char** argv) {
+  px::EnvironmentGuard env_guard(&argc, argv);
+
+  using px::stirling::testing::ReplayStats;
+
+  if (FLAGS_capture.empty()) {
+    LOG(ERROR) << "--capture must be set.";
+    return 1;
+  }
+
+  auto events_or = px::stirling::testing::ReadSocketDataEvents(FLAGS_capture);
+  if (!events_or.ok()) {
+    LOG(ERROR) << events_or.msg();
+    return 1;
+  }
+  const auto events = events_or.ConsumeValueOrDie();
+  LOG(INFO) << absl::Substitute("Read $0 events from $1.", events.size(), FLAGS_capture);
+
+  px::stirling::testing::ReplayOptions options;
+  options.recorded_pace = FLAGS_recorded_pace;
+
+  ReplayStats total;
+  for (int i = 0; i < FLAGS_repeat; ++i) {
+    auto stats_or = px::stirling::testing::ReplaySocketDataEvents(events, options);
+    if (!stats_or.ok()) {
+      LOG(ERROR) << stats_or.msg();
+      return 1;
+    }
+    total.Merge(stats_or.ValueOrDie());
+  }
+  std::cout << total.ToString();
+  return 0;
+}
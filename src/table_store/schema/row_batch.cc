@@ -43,7 +43,11 @@ Status RowBatch::AddColumn(const std::shared_ptr<arrow::Array>& col) {
   if (col->length() != num_rows_) {
     return error::InvalidArgument("Schema only allows $0 rows, got $1", num_rows_, col->length());
   }
-  if (col->type_id() != types::ToArrowType(desc_.type(columns_.size()))) {
+  auto type_id = col->type_id();
+  if (type_id == arrow::Type::DICTIONARY) {
+    type_id = static_cast<const arrow::DictionaryType&>(*col->type()).value_type()->id();
+  }
+  if (type_id != types::ToArrowType(desc_.type(columns_.size()))) {
     return error::InvalidArgument("Column[$0] was given incorrect type", columns_.size());
   }
 
@@ -70,9 +74,9 @@ int64_t RowBatch::NumBytes() const {
   }
 
   int64_t total_bytes = 0;
-  for (auto col : columns_) {
+  for (const auto& [col_idx, col] : Enumerate(columns_)) {
 #define TYPE_CASE(_dt_) total_bytes += types::GetArrowArrayBytes<_dt_>(col.get());
-    PX_SWITCH_FOREACH_DATATYPE(types::ArrowToDataType(col->type_id()), TYPE_CASE);
+    PX_SWITCH_FOREACH_DATATYPE(desc_.type(col_idx), TYPE_CASE);
 #undef TYPE_CASE
   }
   return total_bytes;
@@ -120,13 +124,16 @@ constexpr const auto& GetPBDataColumn(const table_store::schemapb::Column& data_
 }
 
 template <DataType T>
-void CopyIntoOutputPB(table_store::schemapb::Column* output_column, arrow::Array* input_column) {
+void CopyIntoOutputPB(table_store::schemapb::Column* output_column, arrow::Array* input_column,
+                      const RowBatch& rb) {
   CHECK_NOTNULL(input_column);
   CHECK_NOTNULL(output_column);
 
-  size_t col_length = input_column->length();
+  int64_t num_selected = rb.num_selected_rows();
   auto casted_output_data = GetMutablePBDataColumn<T>(output_column);
-  for (size_t i = 0; i < col_length; ++i) {
+  casted_output_data->mutable_data()->Reserve(num_selected);
+  for (int64_t selected_idx = 0; selected_idx < num_selected; ++selected_idx) {
+    int64_t i = rb.SelectedRow(selected_idx);
     if constexpr (T == DataType::UINT128) {
       auto out_datum = casted_output_data->add_data();
       auto val = types::GetValueFromArrowArray<DataType::UINT128>(input_column, i);
@@ -159,7 +166,7 @@ Status CopyFromInputPB(std::shared_ptr<arrow::Array>* output_column,
 }
 
 Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
-  proto->set_num_rows(num_rows_);
+  proto->set_num_rows(num_selected_rows());
   proto->set_eow(eow_);
   proto->set_eos(eos_);
 
@@ -168,7 +175,7 @@ Status RowBatch::ToProto(table_store::schemapb::RowBatchData* proto) const {
     auto output_col_data = proto->add_cols();
     auto dt = desc_.type(col_idx);
 
-#define TYPE_CASE(_dt_) CopyIntoOutputPB<_dt_>(output_col_data, input_col);
+#define TYPE_CASE(_dt_) CopyIntoOutputPB<_dt_>(output_col_data, input_col, *this);
     PX_SWITCH_FOREACH_DATATYPE(dt, TYPE_CASE);
 #undef TYPE_CASE
   }
@@ -253,6 +260,7 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::WithZeroRows(const RowDescriptor&
 }
 
 StatusOr<std::unique_ptr<RowBatch>> RowBatch::Slice(int64_t offset, int64_t length) const {
+  DCHECK(!has_selection()) << "Compact a batch with a selection before slicing it.";
   if (offset + length > num_rows() || offset < 0) {
     return error::InvalidArgument("Slice(offset=$0, length=$1) on rowbatch of length $2 is invalid",
                                   offset, length, num_rows());
@@ -265,6 +273,87 @@ StatusOr<std::unique_ptr<RowBatch>> RowBatch::Slice(int64_t offset, int64_t leng
   return output_rb;
 }
 
+template <DataType T>
+Status CopySelectedValues(const arrow::Array* input_col, const std::vector<int64_t>& selection,
+                          arrow::MemoryPool* mem_pool, std::shared_ptr<arrow::Array>* output_col) {
+  auto builder = types::MakeArrowBuilder(T, mem_pool);
+  PX_RETURN_IF_ERROR(builder->Reserve(selection.size()));
+  if constexpr (T == DataType::STRING) {
+    int64_t total_size = 0;
+    for (int64_t row : selection) {
+      total_size += types::GetStringViewFromArrowArray(input_col, row).size();
+    }
+    auto* typed_builder = static_cast<arrow::StringBuilder*>(builder.get());
+    PX_RETURN_IF_ERROR(typed_builder->ReserveData(total_size));
+    for (int64_t row : selection) {
+      auto val = types::GetStringViewFromArrowArray(input_col, row);
+      typed_builder->UnsafeAppend(val.data(), static_cast<int32_t>(val.size()));
+    }
+  } else {
+    auto* typed_builder =
+        static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(builder.get());
+    for (int64_t row : selection) {
+      typed_builder->UnsafeAppend(types::GetValueFromArrowArray<T>(input_col, row));
+    }
+  }
+  PX_RETURN_IF_ERROR(builder->Finish(output_col));
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::Compact(arrow::MemoryPool* mem_pool) const {
+  auto output_rb = std::make_unique<RowBatch>(desc(), num_selected_rows());
+  output_rb->set_eow(eow());
+  output_rb->set_eos(eos());
+  for (int64_t col_idx = 0; col_idx < num_columns(); ++col_idx) {
+    if (selection_ == nullptr) {
+      PX_RETURN_IF_ERROR(output_rb->AddColumn(ColumnAt(col_idx)));
+      continue;
+    }
+    std::shared_ptr<arrow::Array> output_col;
+#define TYPE_CASE(_dt_)                                                                      \
+  PX_RETURN_IF_ERROR(                                                                        \
+      CopySelectedValues<_dt_>(ColumnAt(col_idx).get(), *selection_, mem_pool, &output_col));
+    PX_SWITCH_FOREACH_DATATYPE(desc_.type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(output_col));
+  }
+  return output_rb;
+}
+
+bool RowBatch::HasDictionaryColumns() const {
+  return std::any_of(columns_.begin(), columns_.end(),
+                     [](const auto& col) { return col->type_id() == arrow::Type::DICTIONARY; });
+}
+
+StatusOr<std::unique_ptr<RowBatch>> RowBatch::DecodeDictionaryColumns(
+    arrow::MemoryPool* mem_pool) const {
+  auto output_rb = std::make_unique<RowBatch>(desc(), num_rows());
+  output_rb->set_selection(selection_);
+  output_rb->set_eow(eow());
+  output_rb->set_eos(eos());
+  for (const auto& col : columns_) {
+    if (col->type_id() != arrow::Type::DICTIONARY) {
+      PX_RETURN_IF_ERROR(output_rb->AddColumn(col));
+      continue;
+    }
+    int64_t total_size = 0;
+    for (int64_t row = 0; row < num_rows(); ++row) {
+      total_size += types::GetStringViewFromArrowArray(col.get(), row).size();
+    }
+    arrow::StringBuilder builder(mem_pool);
+    PX_RETURN_IF_ERROR(builder.Reserve(num_rows()));
+    PX_RETURN_IF_ERROR(builder.ReserveData(total_size));
+    for (int64_t row = 0; row < num_rows(); ++row) {
+      auto val = types::GetStringViewFromArrowArray(col.get(), row);
+      builder.UnsafeAppend(val.data(), static_cast<int32_t>(val.size()));
+    }
+    std::shared_ptr<arrow::Array> output_col;
+    PX_RETURN_IF_ERROR(builder.Finish(&output_col));
+    PX_RETURN_IF_ERROR(output_rb->AddColumn(output_col));
+  }
+  return output_rb;
+}
+
 }  // namespace schema
 }  // namespace table_store
 }  // namespace px
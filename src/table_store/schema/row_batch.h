@@ -19,6 +19,7 @@
 #pragma once
 
 #include <arrow/array.h>
+#include <arrow/memory_pool.h>
 #include <arrow/type.h>
 #include <map>
 #include <memory>
@@ -67,7 +68,8 @@ class RowBatch {
    * @brief Returns a slice of the specified `length` starting at the `offset` from the RowBatch.
    *
    * RowBatch Slice has the same columns as this rowbatch, just of length `length` and starting at
-   * `offset`. Does not set eow and eos.
+   * `offset`. Does not set eow and eos. Offsets are into the columns, so batches with a selection
+   * must be compacted before being sliced.
    *
    *
    * @param offset The starting position of the slice.
@@ -77,7 +79,36 @@ class RowBatch {
   StatusOr<std::unique_ptr<RowBatch>> Slice(int64_t offset, int64_t length) const;
 
   /**
-   * Adds the given column to the row batch, given that it correctly fits the schema.
+   * @brief Returns a batch holding only the selected rows of this batch, with no selection.
+   *
+   * The selected values of every column are copied into new arrays allocated from mem_pool, which
+   * also decodes dictionary columns. A batch without a selection is returned as is, sharing its
+   * columns. Copies eow and eos.
+   *
+   * @param mem_pool The pool to allocate the new columns from.
+   * @return StatusOr<std::unique_ptr<RowBatch>>
+   */
+  StatusOr<std::unique_ptr<RowBatch>> Compact(arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * @brief Returns a copy of this batch whose dictionary columns are decoded into plain arrays.
+   *
+   * STRING columns read from the table store may be dictionary encoded, see
+   * types::MakeStringDictionaryArray. Other columns are shared. Copies the selection, eow and eos.
+   *
+   * @param mem_pool The pool to allocate the decoded columns from.
+   * @return StatusOr<std::unique_ptr<RowBatch>>
+   */
+  StatusOr<std::unique_ptr<RowBatch>> DecodeDictionaryColumns(arrow::MemoryPool* mem_pool) const;
+
+  /**
+   * @return whether any of the columns are dictionary encoded.
+   */
+  bool HasDictionaryColumns() const;
+
+  /**
+   * Adds the given column to the row batch, given that it correctly fits the schema. STRING
+   * columns may be dictionary encoded.
    * param col ptr to the arrow array that should be added to the row batch.
    */
   Status AddColumn(const std::shared_ptr<arrow::Array>& col);
@@ -99,6 +130,31 @@ class RowBatch {
    */
   int64_t num_rows() const { return num_rows_; }
 
+  /**
+   * The selection of a batch is a sorted list of the indices of its live rows. Rows outside of the
+   * selection have been filtered out but are still present in the columns, which lets a filter
+   * pass its input columns on without copying them. A batch without a selection has every row
+   * live. The selection is shared, so copies of a batch don't copy it.
+   */
+  const std::shared_ptr<const std::vector<int64_t>>& selection() const { return selection_; }
+  bool has_selection() const { return selection_ != nullptr; }
+  void set_selection(std::shared_ptr<const std::vector<int64_t>> selection) {
+    selection_ = std::move(selection);
+  }
+
+  /**
+   * @ return the number of live rows, which is num_rows() unless the batch has a selection.
+   */
+  int64_t num_selected_rows() const {
+    return selection_ == nullptr ? num_rows_ : static_cast<int64_t>(selection_->size());
+  }
+
+  /**
+   * @ param i the index of a live row, less than num_selected_rows().
+   * @ returns the index of the i-th live row in the columns.
+   */
+  int64_t SelectedRow(int64_t i) const { return selection_ == nullptr ? i : (*selection_)[i]; }
+
   /**
    * @ return the number of columns which the row batch should contain.
    */
@@ -126,6 +182,7 @@ class RowBatch {
   bool eow_ = false;
   bool eos_ = false;
   std::vector<std::shared_ptr<arrow::Array>> columns_;
+  std::shared_ptr<const std::vector<int64_t>> selection_;
 };
 
 // Append a scalar value to an arrow::Array.
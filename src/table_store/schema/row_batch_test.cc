@@ -19,6 +19,8 @@
 #include <arrow/array.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "src/common/testing/testing.h"
@@ -231,6 +233,92 @@ TEST_F(RowBatchTest, slice) {
   ASSERT_EQ(status2.msg(), "Slice(offset=-1, length=3) on rowbatch of length 3 is invalid");
 }
 
+TEST_F(RowBatchTest, selection_compact) {
+  EXPECT_FALSE(rb_->has_selection());
+  EXPECT_EQ(3, rb_->num_selected_rows());
+
+  rb_->set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{0, 2}));
+  rb_->set_eow(true);
+  EXPECT_TRUE(rb_->has_selection());
+  EXPECT_EQ(3, rb_->num_rows());
+  EXPECT_EQ(2, rb_->num_selected_rows());
+  EXPECT_EQ(2, rb_->SelectedRow(1));
+
+  ASSERT_OK_AND_ASSIGN(auto compacted_rb, rb_->Compact(arrow::default_memory_pool()));
+  EXPECT_FALSE(compacted_rb->has_selection());
+  EXPECT_EQ(2, compacted_rb->num_rows());
+  EXPECT_TRUE(compacted_rb->eow());
+  EXPECT_FALSE(compacted_rb->eos());
+  EXPECT_EQ("RowBatch(eow=1, eos=0):\n  [\n  true,\n  true\n]\n  [\n  3,\n  5\n]\n  [\n  "
+            "3.3,\n  5.6\n]\n",
+            compacted_rb->DebugString());
+
+  // Compacting a batch without a selection shares its columns.
+  ASSERT_OK_AND_ASSIGN(auto same_rb, compacted_rb->Compact(arrow::default_memory_pool()));
+  EXPECT_EQ(compacted_rb->ColumnAt(1), same_rb->ColumnAt(1));
+}
+
+TEST_F(RowBatchTest, selection_to_proto) {
+  table_store::schemapb::RowBatchData input_proto;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kTestRowBatchProto, &input_proto));
+  auto rb = RowBatch::FromProto(input_proto).ConsumeValueOrDie();
+  rb->set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{1, 2}));
+
+  // Only the selected rows are serialized, the same as if the batch had been compacted.
+  table_store::schemapb::RowBatchData output_proto;
+  EXPECT_OK(rb->ToProto(&output_proto));
+  EXPECT_EQ(2, output_proto.num_rows());
+
+  ASSERT_OK_AND_ASSIGN(auto compacted_rb, rb->Compact(arrow::default_memory_pool()));
+  table_store::schemapb::RowBatchData compacted_proto;
+  EXPECT_OK(compacted_rb->ToProto(&compacted_proto));
+
+  google::protobuf::util::MessageDifferencer differ;
+  EXPECT_TRUE(differ.Compare(compacted_proto, output_proto));
+  EXPECT_EQ(2, output_proto.cols(2).string_data().data_size());
+}
+
+TEST(RowBatchDictionaryTest, decode_dictionary_columns) {
+  arrow::Int32Builder codes_builder;
+  for (int32_t code : {1, 0, 1, 2}) {
+    ASSERT_TRUE(codes_builder.Append(code).ok());
+  }
+  std::shared_ptr<arrow::Array> codes;
+  ASSERT_TRUE(codes_builder.Finish(&codes).ok());
+  auto dictionary = types::ToArrow(std::vector<types::StringValue>{"abc", "de", "fghi"},
+                                   arrow::default_memory_pool());
+  auto plain = types::ToArrow(std::vector<types::StringValue>{"de", "abc", "de", "fghi"},
+                              arrow::default_memory_pool());
+  auto ints = types::ToArrow(std::vector<types::Int64Value>{1, 2, 3, 4},
+                             arrow::default_memory_pool());
+
+  // Dictionary columns fit STRING columns of the descriptor.
+  RowBatch rb(RowDescriptor({types::DataType::STRING, types::DataType::INT64}), 4);
+  ASSERT_OK(rb.AddColumn(types::MakeStringDictionaryArray(codes, dictionary)));
+  ASSERT_OK(rb.AddColumn(ints));
+  EXPECT_TRUE(rb.HasDictionaryColumns());
+  // The strings of the rows, and 8 bytes per int.
+  EXPECT_EQ(11 + 4 * 8, rb.NumBytes());
+  rb.set_selection(std::make_shared<const std::vector<int64_t>>(std::vector<int64_t>{1, 3}));
+  rb.set_eos(true);
+
+  ASSERT_OK_AND_ASSIGN(auto decoded_rb, rb.DecodeDictionaryColumns(arrow::default_memory_pool()));
+  EXPECT_FALSE(decoded_rb->HasDictionaryColumns());
+  EXPECT_TRUE(decoded_rb->ColumnAt(0)->Equals(plain));
+  EXPECT_EQ(ints, decoded_rb->ColumnAt(1));
+  EXPECT_EQ(rb.selection(), decoded_rb->selection());
+  EXPECT_TRUE(decoded_rb->eos());
+
+  // Compacting decodes the selected rows.
+  ASSERT_OK_AND_ASSIGN(auto compacted_rb, rb.Compact(arrow::default_memory_pool()));
+  EXPECT_FALSE(compacted_rb->HasDictionaryColumns());
+  EXPECT_TRUE(compacted_rb->ColumnAt(0)->Equals(types::ToArrow(
+      std::vector<types::StringValue>{"abc", "fghi"}, arrow::default_memory_pool())));
+
+  RowBatch int_rb(RowDescriptor({types::DataType::INT64}), 4);
+  EXPECT_NOT_OK(int_rb.AddColumn(types::MakeStringDictionaryArray(codes, dictionary)));
+}
+
 }  // namespace schema
 }  // namespace table_store
 }  // namespace px
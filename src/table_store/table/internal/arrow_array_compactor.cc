@@ -59,6 +59,26 @@ StatusOr<std::vector<ArrowArrayPtr>> ArrowArrayCompactor::Finish() {
   return out_columns;
 }
 
+StatusOr<ColdBatch> ArrowArrayCompactor::FinishCold(const ColdEncodingOptions& options,
+                                                    int64_t time_col_idx,
+                                                    arrow::MemoryPool* mem_pool) {
+  PX_ASSIGN_OR_RETURN(std::vector<ArrowArrayPtr> out_columns, Finish());
+  ColdEncodingOptions time_col_options = options;
+  time_col_options.allow_delta = false;
+
+  ColdBatch cold_batch;
+  cold_batch.reserve(out_columns.size());
+  for (size_t col_idx = 0; col_idx < out_columns.size(); ++col_idx) {
+    const auto& col_options =
+        static_cast<int64_t>(col_idx) == time_col_idx ? time_col_options : options;
+    PX_ASSIGN_OR_RETURN(auto column,
+                        ColdColumn::Encode(rel_.col_types()[col_idx],
+                                           std::move(out_columns[col_idx]), col_options, mem_pool));
+    cold_batch.push_back(std::move(column));
+  }
+  return cold_batch;
+}
+
 }  // namespace internal
 }  // namespace table_store
 }  // namespace px
@@ -42,6 +42,8 @@ namespace internal {
  *    compactor.UnsafeAppendBatchSlice(record_or_row_batch, 0, NumRows(record_or_row_batch));
  *  }
  *  auto output_arrow_arrays = compactor.Finish();
+ *
+ * or, to produce an encoded cold batch, `compactor.FinishCold(options, time_col_idx, mem_pool)`.
  */
 class ArrowArrayCompactor {
  public:
@@ -74,6 +76,17 @@ class ArrowArrayCompactor {
    * @return compacted arrow::Array's per column in the batch.
    */
   StatusOr<std::vector<ArrowArrayPtr>> Finish();
+  /**
+   * Return the compacted columns as a cold batch, encoding each column with the smallest encoding
+   * allowed by `options`. Delta encoding is never used for the time column, which must stay
+   * randomly accessible for time searches.
+   * @param options the encodings the columns may use.
+   * @param time_col_idx the index of the time column, or -1 if there is none.
+   * @param mem_pool the pool to allocate encoded columns from.
+   * @return the (possibly encoded) columns of the compacted batch.
+   */
+  StatusOr<ColdBatch> FinishCold(const ColdEncodingOptions& options, int64_t time_col_idx,
+                                 arrow::MemoryPool* mem_pool);
 
  private:
   const schema::Relation& rel_;
@@ -156,6 +156,8 @@ void BatchSizeAccountant::ExpireHotBatch() {
 void BatchSizeAccountant::ExpireColdBatch() {
   cold_bytes_ -= cold_batch_bytes_.front();
   cold_batch_bytes_.pop_front();
+  cold_uncompressed_bytes_ -= cold_batch_uncompressed_bytes_.front();
+  cold_batch_uncompressed_bytes_.pop_front();
 }
 
 bool BatchSizeAccountant::CompactedBatchReady() const {
@@ -170,13 +172,19 @@ const BatchSizeAccountant::CompactedBatchSpec& BatchSizeAccountant::GetNextCompa
 }
 
 uint64_t BatchSizeAccountant::FinishCompactedBatch() {
+  return FinishCompactedBatch(GetNextCompactedBatchSpec().bytes);
+}
+
+uint64_t BatchSizeAccountant::FinishCompactedBatch(uint64_t stored_bytes) {
   DCHECK(CompactedBatchReady());
   auto spec = std::move(compacted_batch_specs_.front());
   compacted_batch_specs_.pop_front();
 
   hot_bytes_ -= spec.bytes;
-  cold_bytes_ += spec.bytes;
-  cold_batch_bytes_.push_back(spec.bytes);
+  cold_bytes_ += stored_bytes;
+  cold_batch_bytes_.push_back(stored_bytes);
+  cold_uncompressed_bytes_ += spec.bytes;
+  cold_batch_uncompressed_bytes_.push_back(spec.bytes);
 
   if (spec.hot_slices.back().last_slice_for_batch) {
     // If the last slice in the compacted batch was the last slice for the corresponding hot batch,
@@ -216,6 +224,8 @@ uint64_t BatchSizeAccountant::HotBytes() const { return hot_bytes_; }
 
 uint64_t BatchSizeAccountant::ColdBytes() const { return cold_bytes_; }
 
+uint64_t BatchSizeAccountant::ColdUncompressedBytes() const { return cold_uncompressed_bytes_; }
+
 const BatchSizeAccountantNonMutableState& BatchSizeAccountant::NonMutableState() const {
   return non_mutable_state_;
 }
@@ -134,6 +134,13 @@ class BatchSizeAccountant {
    * into the cold store via CompactedBatchSpec.
    */
   uint64_t FinishCompactedBatch();
+  /**
+   * Same as `FinishCompactedBatch()`, for a compacted batch that was encoded so that it takes
+   * `stored_bytes` in the cold store rather than the bytes of its spec.
+   * @param stored_bytes number of bytes the encoded batch takes in the cold store.
+   * @return Number of rows to remove from the front of the hot store.
+   */
+  uint64_t FinishCompactedBatch(uint64_t stored_bytes);
   /**
    * @return the number of bytes stored in the hot store.
    */
@@ -142,6 +149,10 @@ class BatchSizeAccountant {
    * @return the number of bytes stored in the cold store.
    */
   uint64_t ColdBytes() const;
+  /**
+   * @return the number of bytes the batches in the cold store would take if they weren't encoded.
+   */
+  uint64_t ColdUncompressedBytes() const;
 
   const BatchSizeAccountantNonMutableState& NonMutableState() const;
 
@@ -150,8 +161,10 @@ class BatchSizeAccountant {
 
   std::deque<CompactedBatchSpec> compacted_batch_specs_;
   std::deque<uint64_t> cold_batch_bytes_;
+  std::deque<uint64_t> cold_batch_uncompressed_bytes_;
   uint64_t hot_bytes_ = 0;
   uint64_t cold_bytes_ = 0;
+  uint64_t cold_uncompressed_bytes_ = 0;
 
   static BatchSizeAccountantNonMutableState CreateNonMutableState(const schema::Relation& rel,
                                                                   size_t compacted_size);
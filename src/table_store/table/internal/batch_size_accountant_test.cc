@@ -201,6 +201,24 @@ TEST_P(BatchSizeAccountantTest, IndexThenCompactWithExpiry) {
   EXPECT_EQ(2 * half_compaction_rb_bytes_, accountant_->ColdBytes());
 }
 
+TEST_P(BatchSizeAccountantTest, EncodedColdBatch) {
+  accountant_->NewHotBatch(
+      BatchSizeAccountant::CalcBatchStats(accountant_->NonMutableState(), *half_compaction_rb_));
+  accountant_->NewHotBatch(
+      BatchSizeAccountant::CalcBatchStats(accountant_->NonMutableState(), *half_compaction_rb_));
+
+  ASSERT_TRUE(accountant_->CompactedBatchReady());
+  // The cold store counts the encoded size of the batch, and keeps track of its plain size.
+  EXPECT_EQ(0, accountant_->FinishCompactedBatch(half_compaction_rb_bytes_));
+  EXPECT_EQ(0, accountant_->HotBytes());
+  EXPECT_EQ(half_compaction_rb_bytes_, accountant_->ColdBytes());
+  EXPECT_EQ(2 * half_compaction_rb_bytes_, accountant_->ColdUncompressedBytes());
+
+  accountant_->ExpireColdBatch();
+  EXPECT_EQ(0, accountant_->ColdBytes());
+  EXPECT_EQ(0, accountant_->ColdUncompressedBytes());
+}
+
 INSTANTIATE_RECORD_OR_ROW_BATCH_TESTSUITE(BatchSizeAccountant, BatchSizeAccountantTest,
                                           /*include_mixed*/ true);
 
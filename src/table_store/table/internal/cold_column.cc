@@ -0,0 +1,349 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/cold_column.h"
+
+#include <absl/container/flat_hash_map.h>
+#include <arrow/builder.h>
+
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+int64_t StringDataBytes(const arrow::StringArray* arr) {
+  return arr->value_offset(arr->length()) - arr->value_offset(0);
+}
+
+int BitWidth(uint64_t range) { return range == 0 ? 0 : 64 - __builtin_clzll(range); }
+
+uint64_t BitMask(int bit_width) {
+  return bit_width == 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t{1} << bit_width) - 1;
+}
+
+int64_t NumPackedWords(int64_t num_values, int bit_width) {
+  return (num_values * bit_width + 63) / 64;
+}
+
+// Packs the offsets of the given values from `reference` into `bit_width` bits each. The
+// arithmetic wraps, so that offsets spanning the whole int64 range are still packed correctly.
+template <typename TGetValue>
+std::vector<uint64_t> Pack(int64_t num_values, int bit_width, int64_t reference,
+                           TGetValue get_value) {
+  std::vector<uint64_t> packed(NumPackedWords(num_values, bit_width), 0);
+  if (bit_width == 0) {
+    return packed;
+  }
+  for (int64_t i = 0; i < num_values; ++i) {
+    uint64_t val = static_cast<uint64_t>(get_value(i)) - static_cast<uint64_t>(reference);
+    int64_t bit = i * bit_width;
+    int64_t word = bit >> 6;
+    int off = bit & 63;
+    packed[word] |= val << off;
+    if (off + bit_width > 64) {
+      packed[word + 1] |= val >> (64 - off);
+    }
+  }
+  return packed;
+}
+
+}  // namespace
+
+ColdColumn::ColdColumn(ArrowArrayPtr arr) : length_(arr->length()), array_(std::move(arr)) {}
+
+StatusOr<ColdColumn> ColdColumn::Encode(types::DataType type, ArrowArrayPtr arr,
+                                        const ColdEncodingOptions& options,
+                                        arrow::MemoryPool* mem_pool) {
+  switch (type) {
+    case types::DataType::STRING:
+      return EncodeString(std::move(arr), options.dictionary_max_distinct_ratio, mem_pool);
+    case types::DataType::INT64:
+    case types::DataType::TIME64NS:
+      if (options.bit_pack_integers) {
+        return EncodeInt64(type, std::move(arr), options.allow_delta);
+      }
+      return ColdColumn(std::move(arr));
+    default:
+      return ColdColumn(std::move(arr));
+  }
+}
+
+StatusOr<ColdColumn> ColdColumn::EncodeInt64(types::DataType type, ArrowArrayPtr arr,
+                                             bool allow_delta) {
+  int64_t num_rows = arr->length();
+  if (num_rows == 0 || arr->null_count() > 0) {
+    return ColdColumn(std::move(arr));
+  }
+  // INT64 and TIME64NS arrays share the same layout.
+  const int64_t* values = arr->data()->GetValues<int64_t>(1);
+
+  int64_t min_value = values[0];
+  int64_t max_value = values[0];
+  // Deltas are computed with wrapping arithmetic, and are only decoded in order from a
+  // checkpoint, so overflowing deltas still round trip.
+  auto delta = [values](int64_t i) {
+    return static_cast<int64_t>(static_cast<uint64_t>(values[i + 1]) -
+                                static_cast<uint64_t>(values[i]));
+  };
+  int64_t min_delta = num_rows > 1 ? delta(0) : 0;
+  int64_t max_delta = min_delta;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    min_value = std::min(min_value, values[i]);
+    max_value = std::max(max_value, values[i]);
+    if (allow_delta && i + 1 < num_rows) {
+      min_delta = std::min(min_delta, delta(i));
+      max_delta = std::max(max_delta, delta(i));
+    }
+  }
+
+  int for_width = BitWidth(static_cast<uint64_t>(max_value) - static_cast<uint64_t>(min_value));
+  int64_t plain_words = num_rows;
+  int64_t for_words = NumPackedWords(num_rows, for_width);
+  int delta_width = BitWidth(static_cast<uint64_t>(max_delta) - static_cast<uint64_t>(min_delta));
+  int64_t delta_words = allow_delta ? NumPackedWords(num_rows - 1, delta_width) : plain_words;
+  if (std::min(for_words, delta_words) >= plain_words) {
+    return ColdColumn(std::move(arr));
+  }
+
+  ColdColumn column;
+  column.length_ = num_rows;
+  column.type_ = type;
+  column.min_value_ = min_value;
+  column.max_value_ = max_value;
+  if (delta_words < for_words) {
+    column.encoding_ = Encoding::kDeltaBitPacked;
+    column.reference_ = min_delta;
+    column.bit_width_ = delta_width;
+    column.packed_ = Pack(num_rows - 1, delta_width, min_delta, delta);
+    for (int64_t i = 0; i < num_rows; i += kDeltaCheckpointRows) {
+      column.checkpoints_.push_back(values[i]);
+    }
+  } else {
+    column.encoding_ = Encoding::kBitPacked;
+    column.reference_ = min_value;
+    column.bit_width_ = for_width;
+    column.packed_ =
+        Pack(num_rows, for_width, min_value, [values](int64_t i) { return values[i]; });
+  }
+  return column;
+}
+
+uint64_t ColdColumn::PackedValue(int64_t idx) const {
+  if (bit_width_ == 0) {
+    return 0;
+  }
+  int64_t bit = idx * bit_width_;
+  int64_t word = bit >> 6;
+  int off = bit & 63;
+  uint64_t val = packed_[word] >> off;
+  if (off + bit_width_ > 64) {
+    val |= packed_[word + 1] << (64 - off);
+  }
+  return val & BitMask(bit_width_);
+}
+
+int64_t ColdColumn::Int64At(int64_t row) const {
+  DCHECK(encoding_ == Encoding::kBitPacked);
+  DCHECK_LT(row, length_);
+  return static_cast<int64_t>(static_cast<uint64_t>(reference_) + PackedValue(row));
+}
+
+int64_t ColdColumn::LowerBound(int64_t val) const {
+  int64_t lo = 0;
+  int64_t hi = length_;
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if (Int64At(mid) < val) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo == length_ ? -1 : lo;
+}
+
+int64_t ColdColumn::UpperBound(int64_t val) const {
+  int64_t lo = 0;
+  int64_t hi = length_;
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if (Int64At(mid) <= val) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+template <types::DataType TDataType>
+StatusOr<ArrowArrayPtr> ColdColumn::DecodeInt64(int64_t offset, int64_t length,
+                                                arrow::MemoryPool* mem_pool) const {
+  using BuilderType = typename types::DataTypeTraits<TDataType>::arrow_builder_type;
+  auto builder = types::GetArrowBuilder<TDataType>(mem_pool);
+  auto* typed_builder = static_cast<BuilderType*>(builder.get());
+  PX_RETURN_IF_ERROR(typed_builder->Reserve(length));
+  if (encoding_ == Encoding::kBitPacked) {
+    for (int64_t i = offset; i < offset + length; ++i) {
+      typed_builder->UnsafeAppend(Int64At(i));
+    }
+  } else {
+    // Delta encoded values depend on every previous row, so decoding starts at the last
+    // checkpoint before the offset.
+    int64_t start = offset - offset % kDeltaCheckpointRows;
+    uint64_t val = static_cast<uint64_t>(checkpoints_[start / kDeltaCheckpointRows]);
+    for (int64_t i = start; i < offset + length; ++i) {
+      if (i > start) {
+        val += static_cast<uint64_t>(reference_) + PackedValue(i - 1);
+      }
+      if (i >= offset) {
+        typed_builder->UnsafeAppend(static_cast<int64_t>(val));
+      }
+    }
+  }
+  ArrowArrayPtr out;
+  PX_RETURN_IF_ERROR(typed_builder->Finish(&out));
+  return out;
+}
+
+StatusOr<ColdColumn> ColdColumn::EncodeString(ArrowArrayPtr arr, double max_distinct_ratio,
+                                              arrow::MemoryPool* mem_pool) {
+  DCHECK(arr->type_id() == arrow::Type::STRING);
+  int64_t num_rows = arr->length();
+  auto max_distinct = static_cast<int64_t>(max_distinct_ratio * num_rows);
+  max_distinct = std::min<int64_t>(max_distinct, std::numeric_limits<uint16_t>::max() + 1);
+  if (num_rows == 0 || max_distinct <= 0) {
+    return ColdColumn(std::move(arr));
+  }
+
+  ColdColumn column;
+  column.length_ = num_rows;
+  column.codes_.reserve(num_rows);
+  absl::flat_hash_map<std::string_view, uint16_t> codes;
+  std::vector<std::string_view> distinct_values;
+  int64_t dictionary_data_bytes = 0;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    auto val = types::GetStringViewFromArrowArray(arr.get(), i);
+    auto [it, inserted] = codes.try_emplace(val, static_cast<uint16_t>(distinct_values.size()));
+    if (inserted) {
+      if (static_cast<int64_t>(distinct_values.size()) == max_distinct) {
+        return ColdColumn(std::move(arr));
+      }
+      distinct_values.push_back(val);
+      dictionary_data_bytes += val.size();
+    }
+    column.codes_.push_back(it->second);
+  }
+
+  int64_t plain_bytes = num_rows * sizeof(int32_t) +
+                        StringDataBytes(static_cast<const arrow::StringArray*>(arr.get()));
+  int64_t encoded_bytes = num_rows * sizeof(uint16_t) +
+                          distinct_values.size() * sizeof(int32_t) + dictionary_data_bytes;
+  if (encoded_bytes >= plain_bytes) {
+    return ColdColumn(std::move(arr));
+  }
+
+  arrow::StringBuilder builder(mem_pool);
+  PX_RETURN_IF_ERROR(builder.Reserve(distinct_values.size()));
+  PX_RETURN_IF_ERROR(builder.ReserveData(dictionary_data_bytes));
+  for (const auto& val : distinct_values) {
+    builder.UnsafeAppend(val.data(), static_cast<int32_t>(val.size()));
+  }
+  PX_RETURN_IF_ERROR(builder.Finish(&column.dictionary_));
+  return column;
+}
+
+StatusOr<ArrowArrayPtr> ColdColumn::Slice(int64_t offset, int64_t length,
+                                          arrow::MemoryPool* mem_pool, bool keep_dictionary) const {
+  DCHECK_LE(offset + length, length_);
+  switch (encoding_) {
+    case Encoding::kPlain:
+      return array_->Slice(offset, length);
+    case Encoding::kBitPacked:
+    case Encoding::kDeltaBitPacked:
+      if (type_ == types::DataType::TIME64NS) {
+        return DecodeInt64<types::DataType::TIME64NS>(offset, length, mem_pool);
+      }
+      return DecodeInt64<types::DataType::INT64>(offset, length, mem_pool);
+    case Encoding::kDictionary:
+      break;
+  }
+
+  if (keep_dictionary) {
+    arrow::Int32Builder codes_builder(mem_pool);
+    PX_RETURN_IF_ERROR(codes_builder.Reserve(length));
+    for (int64_t i = offset; i < offset + length; ++i) {
+      codes_builder.UnsafeAppend(codes_[i]);
+    }
+    ArrowArrayPtr codes;
+    PX_RETURN_IF_ERROR(codes_builder.Finish(&codes));
+    return types::MakeStringDictionaryArray(codes, dictionary_);
+  }
+
+  const auto* dictionary = static_cast<const arrow::StringArray*>(dictionary_.get());
+  int64_t data_bytes = 0;
+  for (int64_t i = offset; i < offset + length; ++i) {
+    data_bytes += dictionary->value_length(codes_[i]);
+  }
+  arrow::StringBuilder builder(mem_pool);
+  PX_RETURN_IF_ERROR(builder.Reserve(length));
+  PX_RETURN_IF_ERROR(builder.ReserveData(data_bytes));
+  for (int64_t i = offset; i < offset + length; ++i) {
+    auto val = dictionary->GetView(codes_[i]);
+    builder.UnsafeAppend(val.data(), static_cast<int32_t>(val.size()));
+  }
+  ArrowArrayPtr out;
+  PX_RETURN_IF_ERROR(builder.Finish(&out));
+  return out;
+}
+
+int64_t ColdColumn::StoredBytes(types::DataType type) const {
+  if (dictionary_encoded()) {
+    const auto* dictionary = static_cast<const arrow::StringArray*>(dictionary_.get());
+    return length_ * sizeof(uint16_t) + dictionary->length() * sizeof(int32_t) +
+           StringDataBytes(dictionary);
+  }
+  if (bit_packed()) {
+    return (packed_.size() + checkpoints_.size()) * sizeof(uint64_t);
+  }
+  int64_t bytes = 0;
+#define TYPE_CASE(_dt_)                                                                     \
+  if constexpr (_dt_ == types::DataType::STRING) {                                          \
+    bytes = length_ * sizeof(int32_t) +                                                     \
+            StringDataBytes(static_cast<const arrow::StringArray*>(array_.get()));          \
+  } else {                                                                                  \
+    bytes = length_ * sizeof(types::DataTypeTraits<_dt_>::native_type);                     \
+  }
+  PX_SWITCH_FOREACH_DATATYPE(type, TYPE_CASE);
+#undef TYPE_CASE
+  return bytes;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+using ArrowArrayPtr = std::shared_ptr<arrow::Array>;
+
+/**
+ * ColdEncodingOptions picks the encodings that compaction may use for the columns of cold batches.
+ */
+struct ColdEncodingOptions {
+  // STRING columns with at most this ratio of distinct values to rows are dictionary encoded. 0
+  // disables dictionary encoding.
+  double dictionary_max_distinct_ratio = 0;
+  // Whether INT64 and TIME64NS columns are bit-packed.
+  bool bit_pack_integers = false;
+  // Whether bit-packed columns may store the deltas between consecutive rows. Delta encoded
+  // columns can't be accessed randomly, so this is disabled for the time column, which is
+  // searched when cursors are created.
+  bool allow_delta = false;
+};
+
+/**
+ * ColdReadOptions control how the cold columns read by a cursor are decoded.
+ */
+struct ColdReadOptions {
+  // The pool that decoded columns are allocated from.
+  arrow::MemoryPool* mem_pool = arrow::default_memory_pool();
+  // Whether dictionary encoded columns are read as their codes (see ColdColumn::Slice) rather
+  // than decoded.
+  bool keep_dictionaries = false;
+};
+
+/**
+ * ColdColumn holds one column of a cold batch, in one of the following encodings:
+ *  - kPlain: the arrow::Array produced by compaction.
+ *  - kDictionary: for STRING columns with few distinct values. The distinct strings are stored
+ *    once, and each row stores the 16-bit code of its string.
+ *  - kBitPacked: for INT64 and TIME64NS columns. Each row stores its offset from the column's
+ *    minimum value (frame of reference), packed into as many bits as the largest offset needs.
+ *  - kDeltaBitPacked: like kBitPacked, but the packed values are the deltas between consecutive
+ *    rows, which is much smaller for sorted or slowly changing columns like timestamps. The value
+ *    of every kDeltaCheckpointRows'th row is kept as well, so that reads can start decoding at the
+ *    last checkpoint before them instead of at the first row.
+ *
+ * Readers get arrow::Arrays through `Slice`, which decodes only the requested rows, so columns are
+ * only decompressed when a cursor asks for them.
+ */
+class ColdColumn {
+ public:
+  enum class Encoding {
+    kPlain,
+    kDictionary,
+    kBitPacked,
+    kDeltaBitPacked,
+  };
+
+  static constexpr int64_t kDeltaCheckpointRows = 1024;
+
+  ColdColumn() = default;
+  /**
+   * Creates a plain (unencoded) column. It's implicit so that cold batches can be built directly
+   * from a list of arrays.
+   */
+  ColdColumn(ArrowArrayPtr arr);  // NOLINT(runtime/explicit)
+
+  /**
+   * Encode returns the smallest encoding of the given array allowed by the options, or a plain
+   * column if no encoding saves space.
+   * @param type the data type of the array.
+   * @param arr the array to encode.
+   * @param options the encodings that may be used.
+   * @param mem_pool the pool to allocate the encoded column from.
+   * @return the encoded or plain column.
+   */
+  static StatusOr<ColdColumn> Encode(types::DataType type, ArrowArrayPtr arr,
+                                     const ColdEncodingOptions& options,
+                                     arrow::MemoryPool* mem_pool);
+
+  /**
+   * EncodeString dictionary encodes the given STRING array, if it has at most
+   * `max_distinct_ratio * arr->length()` distinct values and encoding it saves space. Otherwise
+   * the array is kept as a plain column.
+   */
+  static StatusOr<ColdColumn> EncodeString(ArrowArrayPtr arr, double max_distinct_ratio,
+                                           arrow::MemoryPool* mem_pool);
+
+  int64_t length() const { return length_; }
+  Encoding encoding() const { return encoding_; }
+  bool dictionary_encoded() const { return encoding_ == Encoding::kDictionary; }
+  bool bit_packed() const {
+    return encoding_ == Encoding::kBitPacked || encoding_ == Encoding::kDeltaBitPacked;
+  }
+
+  /**
+   * The plain array of the column. Only valid for kPlain columns.
+   */
+  const ArrowArrayPtr& array() const {
+    DCHECK(encoding_ == Encoding::kPlain);
+    return array_;
+  }
+  /**
+   * The distinct values of a dictionary encoded column, as an arrow::StringArray.
+   */
+  const ArrowArrayPtr& dictionary() const { return dictionary_; }
+  /**
+   * The index in `dictionary()` of the value of each row of a dictionary encoded column.
+   */
+  const std::vector<uint16_t>& codes() const { return codes_; }
+  /**
+   * The smallest and largest values of a bit-packed column.
+   */
+  int64_t min_value() const { return min_value_; }
+  int64_t max_value() const { return max_value_; }
+
+  /**
+   * Int64At returns the value of the given row of a kBitPacked column.
+   */
+  int64_t Int64At(int64_t row) const;
+  /**
+   * For a kBitPacked column sorted in ascending order, LowerBound returns the first row with a
+   * value >= val (or -1 if there is none), and UpperBound the first row with a value > val (or the
+   * column length if there is none).
+   */
+  int64_t LowerBound(int64_t val) const;
+  int64_t UpperBound(int64_t val) const;
+
+  /**
+   * Slice returns rows [offset, offset + length) of the column as a plain arrow::Array. Plain
+   * columns are sliced without copying, encoded columns are decoded into a new array. If
+   * keep_dictionary is set, a dictionary encoded column is instead returned with its codes, as made
+   * by types::MakeStringDictionaryArray, sharing `dictionary()`.
+   */
+  StatusOr<ArrowArrayPtr> Slice(int64_t offset, int64_t length, arrow::MemoryPool* mem_pool,
+                                bool keep_dictionary = false) const;
+
+  /**
+   * StoredBytes returns the bytes used to store the column, counted the same way the
+   * BatchSizeAccountant counts the bytes of a plain column of the given type.
+   */
+  int64_t StoredBytes(types::DataType type) const;
+
+ private:
+  static StatusOr<ColdColumn> EncodeInt64(types::DataType type, ArrowArrayPtr arr,
+                                          bool allow_delta);
+  uint64_t PackedValue(int64_t idx) const;
+  template <types::DataType TDataType>
+  StatusOr<ArrowArrayPtr> DecodeInt64(int64_t offset, int64_t length,
+                                      arrow::MemoryPool* mem_pool) const;
+
+  Encoding encoding_ = Encoding::kPlain;
+  int64_t length_ = 0;
+  ArrowArrayPtr array_;
+
+  // kDictionary state.
+  ArrowArrayPtr dictionary_;
+  std::vector<uint16_t> codes_;
+
+  // kBitPacked and kDeltaBitPacked state.
+  types::DataType type_ = types::DataType::DATA_TYPE_UNKNOWN;
+  int64_t min_value_ = 0;
+  int64_t max_value_ = 0;
+  // The value that packed values are offsets from: the minimum value for kBitPacked columns and
+  // the minimum delta for kDeltaBitPacked columns.
+  int64_t reference_ = 0;
+  int bit_width_ = 0;
+  std::vector<uint64_t> packed_;
+  // The value of every kDeltaCheckpointRows'th row of a kDeltaBitPacked column.
+  std::vector<int64_t> checkpoints_;
+};
+
+using ColdBatch = std::vector<ColdColumn>;
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/cold_column.h"
+#include "src/table_store/table/internal/test_utils.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+TEST(ColdColumnTest, dictionary_encodes_repetitive_strings) {
+  std::vector<types::StringValue> strings;
+  for (int i = 0; i < 100; ++i) {
+    strings.push_back(absl::StrCat("/api/v1/endpoint", i % 4));
+  }
+  auto arr = types::ToArrow(strings, arrow::default_memory_pool());
+  ColdColumn plain(arr);
+
+  ASSERT_OK_AND_ASSIGN(auto column,
+                       ColdColumn::EncodeString(arr, 0.5, arrow::default_memory_pool()));
+  ASSERT_TRUE(column.dictionary_encoded());
+  EXPECT_EQ(100, column.length());
+  EXPECT_EQ(4, column.dictionary()->length());
+  EXPECT_LT(column.StoredBytes(types::DataType::STRING),
+            plain.StoredBytes(types::DataType::STRING));
+
+  ASSERT_OK_AND_ASSIGN(auto slice, column.Slice(10, 5, arrow::default_memory_pool()));
+  EXPECT_TRUE(slice->Equals(arr->Slice(10, 5)));
+  ASSERT_OK_AND_ASSIGN(auto all, column.Slice(0, 100, arrow::default_memory_pool()));
+  EXPECT_TRUE(all->Equals(arr));
+}
+
+TEST(ColdColumnTest, dictionary_slice_keeps_codes) {
+  std::vector<types::StringValue> strings;
+  for (int i = 0; i < 100; ++i) {
+    strings.push_back(absl::StrCat("/api/v1/endpoint", i % 4));
+  }
+  auto arr = types::ToArrow(strings, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto column,
+                       ColdColumn::EncodeString(arr, 0.5, arrow::default_memory_pool()));
+  ASSERT_TRUE(column.dictionary_encoded());
+
+  ASSERT_OK_AND_ASSIGN(auto slice, column.Slice(10, 5, arrow::default_memory_pool(),
+                                                /* keep_dictionary */ true));
+  ASSERT_EQ(arrow::Type::DICTIONARY, slice->type_id());
+  const auto* dict_slice = static_cast<const arrow::DictionaryArray*>(slice.get());
+  // The dictionary is shared with the column rather than copied.
+  EXPECT_EQ(column.dictionary(), dict_slice->dictionary());
+  ASSERT_EQ(5, slice->length());
+  for (int64_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(column.codes()[10 + i], types::GetDictionaryCode(dict_slice, i));
+    EXPECT_EQ(strings[10 + i], std::string(types::GetStringViewFromArrowArray(slice.get(), i)));
+  }
+}
+
+TEST(ColdColumnTest, keeps_distinct_strings_plain) {
+  auto arr = types::ToArrow(std::vector<types::StringValue>{"a", "b", "c", "d"},
+                            arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto column,
+                       ColdColumn::EncodeString(arr, 0.5, arrow::default_memory_pool()));
+  EXPECT_FALSE(column.dictionary_encoded());
+  EXPECT_EQ(arr, column.array());
+
+  // Encoding can be disabled.
+  auto repeated = types::ToArrow(std::vector<types::StringValue>{"abc", "abc", "abc", "abc"},
+                                 arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(column,
+                       ColdColumn::EncodeString(repeated, 0, arrow::default_memory_pool()));
+  EXPECT_FALSE(column.dictionary_encoded());
+}
+
+namespace {
+
+std::vector<int64_t> Int64Values(const arrow::Array* arr) {
+  std::vector<int64_t> values;
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    values.push_back(arr->data()->GetValues<int64_t>(1)[i]);
+  }
+  return values;
+}
+
+ColdEncodingOptions BitPackOptions(bool allow_delta) {
+  ColdEncodingOptions options;
+  options.bit_pack_integers = true;
+  options.allow_delta = allow_delta;
+  return options;
+}
+
+}  // namespace
+
+TEST(ColdColumnTest, bit_packs_small_range_ints) {
+  std::vector<types::Int64Value> ints;
+  for (int i = 0; i < 1000; ++i) {
+    // Unsorted values in a small range around a large reference.
+    ints.push_back(1000 * 1000 + (i * 37) % 200);
+  }
+  auto arr = types::ToArrow(ints, arrow::default_memory_pool());
+  ColdColumn plain(arr);
+
+  ASSERT_OK_AND_ASSIGN(auto column, ColdColumn::Encode(types::DataType::INT64, arr,
+                                                       BitPackOptions(/*allow_delta*/ true),
+                                                       arrow::default_memory_pool()));
+  ASSERT_EQ(ColdColumn::Encoding::kBitPacked, column.encoding());
+  EXPECT_EQ(1000 * 1000, column.min_value());
+  EXPECT_EQ(1000 * 1000 + 199, column.max_value());
+  // 8 bits per value instead of 64.
+  EXPECT_EQ(1000, column.StoredBytes(types::DataType::INT64));
+  EXPECT_LT(column.StoredBytes(types::DataType::INT64),
+            plain.StoredBytes(types::DataType::INT64));
+
+  for (int64_t i = 0; i < 1000; ++i) {
+    EXPECT_EQ(ints[i].val, column.Int64At(i));
+  }
+  ASSERT_OK_AND_ASSIGN(auto slice, column.Slice(123, 456, arrow::default_memory_pool()));
+  EXPECT_TRUE(slice->Equals(arr->Slice(123, 456)));
+}
+
+TEST(ColdColumnTest, delta_encodes_timestamps) {
+  std::vector<types::Time64NSValue> times;
+  int64_t time = 1600000000000000000;
+  for (int i = 0; i < 1000; ++i) {
+    time += 1000 + (i % 7) * 10;
+    times.push_back(time);
+  }
+  // Columns of compacted batches are Time64 arrays.
+  arrow::Time64Builder builder(arrow::time64(arrow::TimeUnit::NANO), arrow::default_memory_pool());
+  for (const auto& t : times) {
+    ASSERT_TRUE(builder.Append(t.val).ok());
+  }
+  ArrowArrayPtr arr;
+  ASSERT_TRUE(builder.Finish(&arr).ok());
+
+  ASSERT_OK_AND_ASSIGN(auto column, ColdColumn::Encode(types::DataType::TIME64NS, arr,
+                                                       BitPackOptions(/*allow_delta*/ true),
+                                                       arrow::default_memory_pool()));
+  ASSERT_EQ(ColdColumn::Encoding::kDeltaBitPacked, column.encoding());
+  EXPECT_EQ(times.front().val, column.min_value());
+  EXPECT_EQ(times.back().val, column.max_value());
+  // The deltas span 60ns, so they take 6 bits each, and the first row is a checkpoint.
+  EXPECT_EQ(((999 * 6) + 63) / 64 * 8 + 8, column.StoredBytes(types::DataType::TIME64NS));
+
+  ASSERT_OK_AND_ASSIGN(auto slice, column.Slice(500, 20, arrow::default_memory_pool()));
+  EXPECT_TRUE(slice->Equals(arr->Slice(500, 20)));
+  ASSERT_OK_AND_ASSIGN(auto all, column.Slice(0, 1000, arrow::default_memory_pool()));
+  EXPECT_TRUE(all->Equals(arr));
+}
+
+TEST(ColdColumnTest, delta_slices_start_at_checkpoints) {
+  constexpr int64_t kNumRows = 5 * ColdColumn::kDeltaCheckpointRows + 100;
+  std::vector<types::Int64Value> ints;
+  int64_t val = -1000;
+  for (int64_t i = 0; i < kNumRows; ++i) {
+    val += (i * 13) % 50 - 20;
+    ints.push_back(val);
+  }
+  auto arr = types::ToArrow(ints, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto column, ColdColumn::Encode(types::DataType::INT64, arr,
+                                                       BitPackOptions(/*allow_delta*/ true),
+                                                       arrow::default_memory_pool()));
+  ASSERT_EQ(ColdColumn::Encoding::kDeltaBitPacked, column.encoding());
+
+  constexpr int64_t kCheckpoint = ColdColumn::kDeltaCheckpointRows;
+  for (int64_t offset : {int64_t{0}, kCheckpoint - 1, kCheckpoint, kCheckpoint + 1,
+                         3 * kCheckpoint + 17, kNumRows - 1}) {
+    for (int64_t length : {int64_t{1}, int64_t{10}, 2 * kCheckpoint}) {
+      length = std::min(length, kNumRows - offset);
+      ASSERT_OK_AND_ASSIGN(auto slice, column.Slice(offset, length, arrow::default_memory_pool()));
+      EXPECT_TRUE(slice->Equals(arr->Slice(offset, length))) << offset << " " << length;
+    }
+  }
+}
+
+TEST(ColdColumnTest, searches_bit_packed_time_column) {
+  std::vector<types::Time64NSValue> times{10, 20, 20, 20, 35, 40, 40, 90};
+  auto arr = types::ToArrow(times, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto column, ColdColumn::Encode(types::DataType::TIME64NS, arr,
+                                                       BitPackOptions(/*allow_delta*/ false),
+                                                       arrow::default_memory_pool()));
+  ASSERT_EQ(ColdColumn::Encoding::kBitPacked, column.encoding());
+
+  EXPECT_EQ(0, column.LowerBound(0));
+  EXPECT_EQ(1, column.LowerBound(20));
+  EXPECT_EQ(4, column.LowerBound(21));
+  EXPECT_EQ(7, column.LowerBound(90));
+  EXPECT_EQ(-1, column.LowerBound(91));
+
+  EXPECT_EQ(0, column.UpperBound(9));
+  EXPECT_EQ(4, column.UpperBound(20));
+  EXPECT_EQ(7, column.UpperBound(40));
+  EXPECT_EQ(8, column.UpperBound(90));
+}
+
+TEST(ColdColumnTest, bit_packs_full_int64_range) {
+  std::vector<types::Int64Value> ints{std::numeric_limits<int64_t>::min(), 0, -1,
+                                      std::numeric_limits<int64_t>::max(), 42};
+  auto arr = types::ToArrow(ints, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto column, ColdColumn::Encode(types::DataType::INT64, arr,
+                                                       BitPackOptions(/*allow_delta*/ false),
+                                                       arrow::default_memory_pool()));
+  // Nothing can be saved, so the column stays plain.
+  EXPECT_EQ(ColdColumn::Encoding::kPlain, column.encoding());
+
+  // Deltas that overflow int64 still round trip.
+  ints.clear();
+  for (int i = 0; i < 16; ++i) {
+    ints.push_back(i % 2 == 0 ? std::numeric_limits<int64_t>::min()
+                              : std::numeric_limits<int64_t>::max());
+  }
+  arr = types::ToArrow(ints, arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(column, ColdColumn::Encode(types::DataType::INT64, arr,
+                                                  BitPackOptions(/*allow_delta*/ true),
+                                                  arrow::default_memory_pool()));
+  ASSERT_EQ(ColdColumn::Encoding::kDeltaBitPacked, column.encoding());
+  ASSERT_OK_AND_ASSIGN(auto all, column.Slice(0, ints.size(), arrow::default_memory_pool()));
+  EXPECT_EQ(Int64Values(arr.get()), Int64Values(all.get()));
+}
+
+TEST(ColdColumnTest, bit_packing_disabled) {
+  auto arr = types::ToArrow(std::vector<types::Int64Value>{1, 2, 3, 4},
+                            arrow::default_memory_pool());
+  ASSERT_OK_AND_ASSIGN(auto column, ColdColumn::Encode(types::DataType::INT64, arr,
+                                                       ColdEncodingOptions{},
+                                                       arrow::default_memory_pool()));
+  EXPECT_EQ(ColdColumn::Encoding::kPlain, column.encoding());
+  EXPECT_EQ(arr, column.array());
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
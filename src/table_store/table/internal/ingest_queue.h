@@ -0,0 +1,113 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * IngestQueue is a lock-free multi-producer queue of items waiting to be written to a table.
+ * Producers push with a single compare-and-swap and never wait on each other, or on the consumer.
+ * The consumer takes every queued item at once, in push order, with a single exchange.
+ *
+ * Pushes from the same thread are taken in the order they were pushed. There is no ordering
+ * between the pushes of different threads, beyond the order in which their compare-and-swaps
+ * succeeded.
+ *
+ * Typical usage:
+ *
+ *  // Any number of producers.
+ *  queue.Push(std::move(item));
+ *  // A single consumer at a time.
+ *  for (auto& item : queue.TakeAll()) {
+ *    ...
+ *  }
+ */
+template <typename T>
+class IngestQueue {
+ public:
+  IngestQueue() = default;
+  ~IngestQueue() { DeleteList(head_.exchange(nullptr)); }
+
+  IngestQueue(const IngestQueue&) = delete;
+  IngestQueue& operator=(const IngestQueue&) = delete;
+
+  /**
+   * Push adds the item to the queue. Safe to call from any number of threads concurrently.
+   */
+  void Push(T item) {
+    auto* node = new Node{std::move(item), head_.load(std::memory_order_relaxed)};
+    while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+
+  /**
+   * TakeAll removes and returns every item in the queue, oldest first. Items pushed concurrently
+   * with TakeAll are either returned, or left in the queue for the next call.
+   */
+  std::vector<T> TakeAll() {
+    // The list holds the newest item first.
+    std::vector<Node*> nodes;
+    for (Node* node = head_.exchange(nullptr, std::memory_order_acquire); node != nullptr;
+         node = node->next) {
+      nodes.push_back(node);
+    }
+    std::vector<T> items;
+    items.reserve(nodes.size());
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+      items.push_back(std::move((*it)->item));
+      delete *it;
+    }
+    return items;
+  }
+
+  /**
+   * Empty returns whether the queue had no items at the time of the call.
+   */
+  bool Empty() const { return head_.load(std::memory_order_acquire) == nullptr; }
+
+ private:
+  struct Node {
+    T item;
+    Node* next;
+  };
+
+  static void DeleteList(Node* node) {
+    while (node != nullptr) {
+      Node* next = node->next;
+      delete node;
+      node = next;
+    }
+  }
+
+  std::atomic<Node*> head_{nullptr};
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "src/table_store/table/internal/ingest_queue.h"
+#include "src/table_store/table/internal/test_utils.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(IngestQueueTest, takes_items_in_push_order) {
+  IngestQueue<std::unique_ptr<int>> queue;
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_THAT(queue.TakeAll(), IsEmpty());
+
+  for (int i = 0; i < 3; ++i) {
+    queue.Push(std::make_unique<int>(i));
+  }
+  EXPECT_FALSE(queue.Empty());
+  auto items = queue.TakeAll();
+  ASSERT_EQ(3, items.size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(i, *items[i]);
+  }
+  EXPECT_TRUE(queue.Empty());
+
+  // Items left in the queue are freed with it.
+  queue.Push(std::make_unique<int>(3));
+}
+
+TEST(IngestQueueTest, concurrent_producers) {
+  constexpr int kNumProducers = 8;
+  constexpr int kItemsPerProducer = 10 * 1000;
+  IngestQueue<std::pair<int, int>> queue;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kNumProducers; ++p) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < kItemsPerProducer; ++i) {
+        queue.Push({p, i});
+      }
+    });
+  }
+
+  // Consume concurrently with the producers. Each producer's items must arrive in order.
+  std::vector<int> next_item(kNumProducers, 0);
+  int64_t num_items = 0;
+  auto consume = [&]() {
+    for (const auto& [p, i] : queue.TakeAll()) {
+      EXPECT_EQ(next_item[p], i);
+      next_item[p] = i + 1;
+      ++num_items;
+    }
+  };
+  while (num_items < kNumProducers * kItemsPerProducer) {
+    consume();
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  consume();
+
+  EXPECT_EQ(kNumProducers * kItemsPerProducer, num_items);
+  EXPECT_THAT(next_item, ElementsAre(kItemsPerProducer, kItemsPerProducer, kItemsPerProducer,
+                                     kItemsPerProducer, kItemsPerProducer, kItemsPerProducer,
+                                     kItemsPerProducer, kItemsPerProducer));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
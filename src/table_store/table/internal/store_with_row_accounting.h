@@ -29,6 +29,7 @@
 #include "src/shared/types/column_wrapper.h"
 #include "src/table_store/schema/relation.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
 
 namespace px {
 namespace table_store {
@@ -48,6 +49,16 @@ inline bool TimeIntervalComparatorUpperBound(Time val, const TimeInterval& inter
   return val < interval.second;
 }
 
+/**
+ * ZoneMapScan holds the predicates a scan pushes down to the cold store, and counts the batches
+ * (and rows) that their zone maps allowed the scan to skip.
+ */
+struct ZoneMapScan {
+  std::vector<ColumnPredicate> predicates;
+  int64_t batches_skipped = 0;
+  int64_t rows_skipped = 0;
+};
+
 template <bool always_false = false>
 void constexpr_else_static_assert_false() {
   static_assert(always_false, "constexpr else block reached");
@@ -87,12 +98,17 @@ class StoreWithRowTimeAccounting {
    * @param stop_row_id, an optional unique RowID to stop the batch at. If provided, the batch will
    * be sliced such that no rows are included with `RowID >= stop_row_id.value()`.
    * @param cols, a vector of column indices to include in the outputted row batch.
+   * @param zone_map_scan, optional predicates to skip cold batches with. Cold batches whose zone
+   * maps rule out the predicates are skipped over, advancing `last_read_row_id` past them. Ignored
+   * by the hot store.
+   * @param read_options, how cold columns are decoded. Ignored by the hot store.
    * @return a unique_ptr to the RowBatch or nullptr if there are no more rows in this store that
    * match the parameters above. On error returns a Status.
    */
   StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(
       RowID* last_read_row_id, BatchHints* hints, std::optional<RowID> stop_row_id,
-      const std::vector<int64_t>& cols) const {
+      const std::vector<int64_t>& cols, ZoneMapScan* zone_map_scan = nullptr,
+      const ColdReadOptions& read_options = {}) const {
     auto start_row_id = *last_read_row_id + 1;
     if (batches_.empty() || start_row_id < FirstRowID() || start_row_id > LastRowID()) {
       return std::unique_ptr<schema::RowBatch>(nullptr);
@@ -108,6 +124,28 @@ class StoreWithRowTimeAccounting {
       batch_id = FindBatchIDFromRowID(start_row_id);
     }
 
+    if constexpr (TStoreType == StoreType::Cold) {
+      if (zone_map_scan != nullptr && !zone_map_scan->predicates.empty()) {
+        while (!zone_maps_[batch_id - first_batch_id_].MayMatch(zone_map_scan->predicates)) {
+          RowID skip_last_row_id = BatchLastRowID(batch_id);
+          if (stop_row_id.has_value() && skip_last_row_id >= stop_row_id.value()) {
+            skip_last_row_id = stop_row_id.value() - 1;
+          }
+          zone_map_scan->batches_skipped++;
+          zone_map_scan->rows_skipped += skip_last_row_id - start_row_id + 1;
+          *last_read_row_id = skip_last_row_id;
+          start_row_id = skip_last_row_id + 1;
+          hints->batch_id = batch_id + 1;
+          hints->hint_type = TStoreType;
+          if (batch_id == LastBatchID() ||
+              (stop_row_id.has_value() && start_row_id >= stop_row_id.value())) {
+            return std::unique_ptr<schema::RowBatch>(nullptr);
+          }
+          batch_id++;
+        }
+      }
+    }
+
     const auto& batch = GetBatchFromBatchID(batch_id);
     RowID batch_first_row_id = BatchFirstRowID(batch_id);
     RowID batch_last_row_id = BatchLastRowID(batch_id);
@@ -126,8 +164,8 @@ class StoreWithRowTimeAccounting {
     }
     auto output_rb =
         std::make_unique<schema::RowBatch>(schema::RowDescriptor(col_types), batch_size);
-    PX_RETURN_IF_ERROR(
-        AddBatchSliceToRowBatch(batch, row_offset, batch_size, cols, output_rb.get()));
+    PX_RETURN_IF_ERROR(AddBatchSliceToRowBatch(batch, row_offset, batch_size, cols, read_options,
+                                               output_rb.get()));
 
     // Update the ptr to the last read row.
     *last_read_row_id = start_row_id + batch_size - 1;
@@ -164,6 +202,9 @@ class StoreWithRowTimeAccounting {
 
     row_ids_.pop_front();
     if (time_col_idx_ != -1) times_.pop_front();
+    if constexpr (TStoreType == StoreType::Cold) {
+      zone_maps_.pop_front();
+    }
 
     auto&& front = std::move(batches_.front());
     batches_.pop_front();
@@ -186,6 +227,9 @@ class StoreWithRowTimeAccounting {
       auto last_time = GetTimeValue(batch, BatchLength(batch) - 1);
       times_.emplace_back(first_time, last_time);
     }
+    if constexpr (TStoreType == StoreType::Cold) {
+      zone_maps_.push_back(ZoneMap::Create(rel_, batch));
+    }
     return batch;
   }
 
@@ -342,7 +386,7 @@ class StoreWithRowTimeAccounting {
 
   size_t BatchLength(const TBatch& batch) const {
     if constexpr (std::is_same_v<ColdBatch, TBatch>) {
-      return batch[0]->length();
+      return batch[0].length();
     } else if constexpr (std::is_same_v<HotBatch, TBatch>) {
       return batch.Length();
     } else {
@@ -352,8 +396,12 @@ class StoreWithRowTimeAccounting {
 
   size_t FindTimeFirstGreaterThanOrEqual(const TBatch& batch, Time time) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
+      const auto& time_col = batch[time_col_idx_];
+      if (time_col.bit_packed()) {
+        return time_col.LowerBound(time);
+      }
       return types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(
-          batch[time_col_idx_].get(), time);
+          time_col.array().get(), time);
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.FindTimeFirstGreaterThanOrEqual(time_col_idx_, time);
     } else {
@@ -363,8 +411,12 @@ class StoreWithRowTimeAccounting {
 
   size_t FindTimeFirstGreaterThan(const TBatch& batch, Time time) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
+      const auto& time_col = batch[time_col_idx_];
+      if (time_col.bit_packed()) {
+        return time_col.UpperBound(time);
+      }
       return types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(
-                 batch[time_col_idx_].get(), time) +
+                 time_col.array().get(), time) +
              1;
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.FindTimeFirstGreaterThan(time_col_idx_, time);
@@ -375,7 +427,11 @@ class StoreWithRowTimeAccounting {
 
   Time GetTimeValue(const TBatch& batch, int64_t row_idx) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(batch[time_col_idx_].get(),
+      const auto& time_col = batch[time_col_idx_];
+      if (time_col.bit_packed()) {
+        return time_col.Int64At(row_idx);
+      }
+      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(time_col.array().get(),
                                                                       row_idx);
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.GetTimeValue(time_col_idx_, row_idx);
@@ -386,10 +442,13 @@ class StoreWithRowTimeAccounting {
 
   Status AddBatchSliceToRowBatch(const TBatch& batch, size_t row_offset, size_t batch_size,
                                  const std::vector<int64_t>& cols,
+                                 const ColdReadOptions& read_options,
                                  schema::RowBatch* output_rb) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
       for (auto col_idx : cols) {
-        auto arr = batch[col_idx]->Slice(row_offset, batch_size);
+        PX_ASSIGN_OR_RETURN(auto arr,
+                            batch[col_idx].Slice(row_offset, batch_size, read_options.mem_pool,
+                                                 read_options.keep_dictionaries));
         PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
       }
       return Status::OK();
@@ -406,6 +465,8 @@ class StoreWithRowTimeAccounting {
   std::deque<TBatch> batches_;
   std::deque<RowIDInterval> row_ids_;
   std::deque<TimeInterval> times_;
+  // Zone maps of each batch, only kept for the Cold store.
+  std::deque<ZoneMap> zone_maps_;
 };
 
 }  // namespace internal
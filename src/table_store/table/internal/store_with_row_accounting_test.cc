@@ -47,6 +47,11 @@ class ColdStoreTest : public ::testing::Test {
     return rb;
   }
 
+  ColdBatch ToColdBatch(const schema::RowBatch& rb) {
+    auto columns = rb.columns();
+    return ColdBatch(columns.begin(), columns.end());
+  }
+
   std::unique_ptr<schema::Relation> rel_;
   std::unique_ptr<StoreWithRowTimeAccounting<StoreType::Cold>> store_;
 };
@@ -68,7 +73,7 @@ TEST_F(ColdStoreTest, PushRowBatchesCheckProperties) {
 
   EXPECT_EQ(0, store_->Size());
 
-  store_->EmplaceBack(0, rb0.columns());
+  store_->EmplaceBack(0, ToColdBatch(rb0));
   auto next_row_id = 4;
   EXPECT_EQ(1, store_->Size());
 
@@ -93,7 +98,7 @@ TEST_F(ColdStoreTest, PushRowBatchesCheckProperties) {
   strings = {"", "", ""};
   auto rb1 = MakeRowBatch(times, bools, strings);
 
-  store_->EmplaceBack(next_row_id, rb1.columns());
+  store_->EmplaceBack(next_row_id, ToColdBatch(rb1));
   EXPECT_EQ(2, store_->Size());
 
   EXPECT_EQ(0, store_->FirstRowID());
@@ -124,6 +129,37 @@ TEST_F(ColdStoreTest, PushRowBatchesCheckProperties) {
   EXPECT_EQ(4, optional_row_id.value());
 }
 
+TEST_F(ColdStoreTest, ZoneMapsSkipBatches) {
+  auto rb0 = MakeRowBatch({1, 2}, {true, true}, {"ab", "cd"});
+  auto rb1 = MakeRowBatch({3, 4}, {false, false}, {"ef", "gh"});
+  auto rb2 = MakeRowBatch({5, 6}, {true, false}, {"ij", "kl"});
+  store_->EmplaceBack(0, ToColdBatch(rb0));
+  store_->EmplaceBack(2, ToColdBatch(rb1));
+  store_->EmplaceBack(4, ToColdBatch(rb2));
+
+  ZoneMapScan scan;
+  scan.predicates.push_back(ColumnPredicate{2, ColumnPredicate::Op::kEqual, std::string("ij")});
+  RowID last_read_row_id = -1;
+  BatchHints hints{};
+  ASSERT_OK_AND_ASSIGN(auto rb, store_->GetNextRowBatch(&last_read_row_id, &hints, std::nullopt,
+                                                        {0, 2}, &scan));
+  ASSERT_NE(nullptr, rb);
+  EXPECT_EQ(2, rb->num_rows());
+  EXPECT_EQ(5, last_read_row_id);
+  EXPECT_EQ(2, scan.batches_skipped);
+  EXPECT_EQ(4, scan.rows_skipped);
+
+  // Skipping up to the stop row stops the scan there.
+  scan.predicates = {ColumnPredicate{0, ColumnPredicate::Op::kGreater, int64_t{10}}};
+  last_read_row_id = 0;
+  ASSERT_OK_AND_ASSIGN(
+      rb, store_->GetNextRowBatch(&last_read_row_id, &hints, RowID{3}, {0, 2}, &scan));
+  EXPECT_EQ(nullptr, rb);
+  EXPECT_EQ(2, last_read_row_id);
+  EXPECT_EQ(4, scan.batches_skipped);
+  EXPECT_EQ(6, scan.rows_skipped);
+}
+
 TEST_P(HotStoreTest, PushRowBatchesCheckProperties) {
   std::vector<types::Time64NSValue> times = {1, 1, 10, 11};
   std::vector<types::BoolValue> bools = {true, false, true, false};
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/internal/zone_map.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+// Bloom filters get about 8 bits per row, capped at 4096 bits per column.
+constexpr int64_t kBloomBitsPerRow = 8;
+constexpr int64_t kMaxBloomWords = 64;
+
+uint64_t MixHash(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+uint64_t HashValue(std::string_view val) { return MixHash(std::hash<std::string_view>{}(val)); }
+
+uint64_t HashValue(absl::uint128 val) {
+  return MixHash(absl::Uint128High64(val) ^ MixHash(absl::Uint128Low64(val)));
+}
+
+// The bits a hash sets in its bloom filter word.
+uint64_t BloomBits(uint64_t hash) {
+  return (uint64_t{1} << (hash & 63)) | (uint64_t{1} << ((hash >> 6) & 63)) |
+         (uint64_t{1} << ((hash >> 12) & 63));
+}
+
+void BloomInsert(std::vector<uint64_t>* bloom, uint64_t hash) {
+  (*bloom)[(hash >> 32) & (bloom->size() - 1)] |= BloomBits(hash);
+}
+
+bool BloomMayContain(const std::vector<uint64_t>& bloom, uint64_t hash) {
+  uint64_t bits = BloomBits(hash);
+  return (bloom[(hash >> 32) & (bloom.size() - 1)] & bits) == bits;
+}
+
+int64_t NumBloomWords(int64_t num_rows) {
+  int64_t words = 1;
+  while (words < kMaxBloomWords && words * 64 < num_rows * kBloomBitsPerRow) {
+    words <<= 1;
+  }
+  return words;
+}
+
+template <types::DataType TDataType, typename TValue>
+void ComputeRange(const arrow::Array* arr, ColumnPredicate::Value* min,
+                  ColumnPredicate::Value* max) {
+  // NaNs never compare true, so they are left out of the range, which matches the filter semantics
+  // of comparisons against NaN.
+  TValue lo = std::numeric_limits<TValue>::max();
+  TValue hi = std::numeric_limits<TValue>::lowest();
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    auto val = static_cast<TValue>(types::GetValueFromArrowArray<TDataType>(arr, i));
+    if (val < lo) lo = val;
+    if (hi < val) hi = val;
+  }
+  *min = lo;
+  *max = hi;
+}
+
+template <typename TValue>
+bool RangeMayMatch(const TValue& min, const TValue& max, ColumnPredicate::Op op,
+                   const TValue& val) {
+  switch (op) {
+    case ColumnPredicate::Op::kEqual:
+      return !(val < min) && !(max < val);
+    case ColumnPredicate::Op::kLess:
+      return min < val;
+    case ColumnPredicate::Op::kLessEqual:
+      return !(val < min);
+    case ColumnPredicate::Op::kGreater:
+      return val < max;
+    case ColumnPredicate::Op::kGreaterEqual:
+      return !(max < val);
+  }
+  return true;
+}
+
+}  // namespace
+
+ZoneMap ZoneMap::Create(const schema::Relation& rel, const ColdBatch& batch) {
+  ZoneMap zone_map;
+  zone_map.columns_.reserve(batch.size());
+  for (const auto& [col_idx, column] : Enumerate(batch)) {
+    auto& zone = zone_map.columns_.emplace_back();
+    zone.type = rel.GetColumnType(col_idx);
+    if (column.dictionary_encoded()) {
+      // The dictionary holds each distinct value of the column once.
+      const auto* dictionary = column.dictionary().get();
+      zone.bloom.resize(NumBloomWords(dictionary->length()));
+      for (int64_t i = 0; i < dictionary->length(); ++i) {
+        BloomInsert(&zone.bloom, HashValue(types::GetStringViewFromArrowArray(dictionary, i)));
+      }
+      continue;
+    }
+    if (column.bit_packed()) {
+      // Bit-packed columns already track their range.
+      zone.min = column.min_value();
+      zone.max = column.max_value();
+      zone.has_range = true;
+      continue;
+    }
+    const auto* arr = column.array().get();
+    switch (zone.type) {
+      case types::DataType::BOOLEAN:
+        ComputeRange<types::DataType::BOOLEAN, int64_t>(arr, &zone.min, &zone.max);
+        zone.has_range = true;
+        break;
+      case types::DataType::INT64:
+        ComputeRange<types::DataType::INT64, int64_t>(arr, &zone.min, &zone.max);
+        zone.has_range = true;
+        break;
+      case types::DataType::TIME64NS:
+        ComputeRange<types::DataType::TIME64NS, int64_t>(arr, &zone.min, &zone.max);
+        zone.has_range = true;
+        break;
+      case types::DataType::FLOAT64:
+        ComputeRange<types::DataType::FLOAT64, double>(arr, &zone.min, &zone.max);
+        zone.has_range = true;
+        break;
+      case types::DataType::UINT128:
+        zone.bloom.resize(NumBloomWords(arr->length()));
+        for (int64_t i = 0; i < arr->length(); ++i) {
+          auto val = types::GetValueFromArrowArray<types::DataType::UINT128>(arr, i);
+          BloomInsert(&zone.bloom, HashValue(val));
+        }
+        break;
+      case types::DataType::STRING:
+        zone.bloom.resize(NumBloomWords(arr->length()));
+        for (int64_t i = 0; i < arr->length(); ++i) {
+          BloomInsert(&zone.bloom, HashValue(types::GetStringViewFromArrowArray(arr, i)));
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return zone_map;
+}
+
+bool ZoneMap::PredicateMayMatch(const ColumnPredicate& predicate) const {
+  if (predicate.col_idx < 0 || predicate.col_idx >= static_cast<int64_t>(columns_.size())) {
+    return true;
+  }
+  const auto& zone = columns_[predicate.col_idx];
+  if (zone.has_range) {
+    if (zone.type == types::DataType::FLOAT64) {
+      if (!std::holds_alternative<double>(predicate.value)) {
+        return true;
+      }
+      return RangeMayMatch(std::get<double>(zone.min), std::get<double>(zone.max), predicate.op,
+                           std::get<double>(predicate.value));
+    }
+    if (!std::holds_alternative<int64_t>(predicate.value)) {
+      return true;
+    }
+    return RangeMayMatch(std::get<int64_t>(zone.min), std::get<int64_t>(zone.max), predicate.op,
+                         std::get<int64_t>(predicate.value));
+  }
+  if (zone.bloom.empty() || predicate.op != ColumnPredicate::Op::kEqual) {
+    return true;
+  }
+  if (zone.type == types::DataType::STRING &&
+      std::holds_alternative<std::string>(predicate.value)) {
+    return BloomMayContain(zone.bloom, HashValue(std::get<std::string>(predicate.value)));
+  }
+  if (zone.type == types::DataType::UINT128 &&
+      std::holds_alternative<absl::uint128>(predicate.value)) {
+    return BloomMayContain(zone.bloom, HashValue(std::get<absl::uint128>(predicate.value)));
+  }
+  return true;
+}
+
+bool ZoneMap::MayMatch(const std::vector<ColumnPredicate>& predicates) const {
+  return std::all_of(
+      predicates.begin(), predicates.end(),
+      [this](const ColumnPredicate& predicate) { return PredicateMayMatch(predicate); });
+}
+
+int64_t ZoneMap::BytesUsed() const {
+  int64_t bytes = sizeof(ZoneMap);
+  for (const auto& zone : columns_) {
+    bytes += sizeof(ColumnZone) + zone.bloom.size() * sizeof(uint64_t);
+  }
+  return bytes;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
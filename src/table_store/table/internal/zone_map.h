@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/numeric/int128.h>
+
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * ColumnPredicate is a comparison of a table column against a constant, of the form
+ * `column <op> value`. BOOLEAN, INT64 and TIME64NS columns are compared against int64_t values,
+ * FLOAT64 columns against doubles, UINT128 columns against absl::uint128 and STRING columns against
+ * std::string.
+ */
+struct ColumnPredicate {
+  enum class Op {
+    kEqual,
+    kLess,
+    kLessEqual,
+    kGreater,
+    kGreaterEqual,
+  };
+  using Value = std::variant<int64_t, double, absl::uint128, std::string>;
+
+  // Index of the column in the table's relation.
+  int64_t col_idx;
+  Op op;
+  Value value;
+};
+
+/**
+ * ZoneMap summarizes the values of each column of a cold batch, so that a scan can rule out whole
+ * batches without touching their data. Numeric and time columns keep their min and max value.
+ * STRING and UINT128 columns keep a small blocked bloom filter that only answers equality
+ * predicates, since min/max of values like `upid` or `req_path` rarely excludes anything.
+ */
+class ZoneMap {
+ public:
+  static ZoneMap Create(const schema::Relation& rel, const ColdBatch& batch);
+
+  /**
+   * MayMatch returns false only if no row of the batch can satisfy all of the given predicates.
+   * Predicates that the zone map can't evaluate (e.g. the value doesn't match the column type) are
+   * treated as possibly matching.
+   * @param predicates the conjunction of predicates to check.
+   * @return whether any row of the batch may match the predicates.
+   */
+  bool MayMatch(const std::vector<ColumnPredicate>& predicates) const;
+
+  /**
+   * @return the number of bytes held by this zone map.
+   */
+  int64_t BytesUsed() const;
+
+ private:
+  struct ColumnZone {
+    types::DataType type;
+    bool has_range = false;
+    ColumnPredicate::Value min;
+    ColumnPredicate::Value max;
+    // Blocked bloom filter of the column values, empty if the column has none.
+    std::vector<uint64_t> bloom;
+  };
+
+  bool PredicateMayMatch(const ColumnPredicate& predicate) const;
+
+  std::vector<ColumnZone> columns_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/test_utils.h"
+#include "src/table_store/table/internal/zone_map.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+using Op = ColumnPredicate::Op;
+
+class ZoneMapTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    rel_ = std::make_unique<schema::Relation>(
+        std::vector<types::DataType>{types::DataType::TIME64NS, types::DataType::FLOAT64,
+                                     types::DataType::STRING, types::DataType::UINT128},
+        std::vector<std::string>{"time_", "latency", "req_path", "upid"});
+    ColdBatch batch{
+        types::ToArrow(std::vector<types::Time64NSValue>{10, 30, 20},
+                       arrow::default_memory_pool()),
+        types::ToArrow(std::vector<types::Float64Value>{0.5, -1.5, 2.0},
+                       arrow::default_memory_pool()),
+        types::ToArrow(std::vector<types::StringValue>{"/healthz", "/api/v1", "/api/v2"},
+                       arrow::default_memory_pool()),
+        types::ToArrow(
+            std::vector<types::UInt128Value>{absl::MakeUint128(1, 2), absl::MakeUint128(3, 4),
+                                             absl::MakeUint128(1, 2)},
+            arrow::default_memory_pool()),
+    };
+    zone_map_ = ZoneMap::Create(*rel_, batch);
+  }
+
+  bool MayMatch(ColumnPredicate predicate) { return zone_map_.MayMatch({std::move(predicate)}); }
+
+  std::unique_ptr<schema::Relation> rel_;
+  ZoneMap zone_map_;
+};
+
+TEST_F(ZoneMapTest, int_range) {
+  EXPECT_TRUE(MayMatch({0, Op::kEqual, int64_t{20}}));
+  EXPECT_TRUE(MayMatch({0, Op::kEqual, int64_t{15}}));
+  EXPECT_FALSE(MayMatch({0, Op::kEqual, int64_t{31}}));
+  EXPECT_FALSE(MayMatch({0, Op::kLess, int64_t{10}}));
+  EXPECT_TRUE(MayMatch({0, Op::kLessEqual, int64_t{10}}));
+  EXPECT_FALSE(MayMatch({0, Op::kGreater, int64_t{30}}));
+  EXPECT_TRUE(MayMatch({0, Op::kGreaterEqual, int64_t{30}}));
+}
+
+TEST_F(ZoneMapTest, float_range) {
+  EXPECT_TRUE(MayMatch({1, Op::kLess, -1.0}));
+  EXPECT_FALSE(MayMatch({1, Op::kLess, -1.5}));
+  EXPECT_FALSE(MayMatch({1, Op::kGreater, 2.0}));
+  EXPECT_TRUE(MayMatch({1, Op::kEqual, 0.5}));
+}
+
+TEST_F(ZoneMapTest, string_bloom) {
+  EXPECT_TRUE(MayMatch({2, Op::kEqual, std::string("/api/v1")}));
+  EXPECT_TRUE(MayMatch({2, Op::kEqual, std::string("/healthz")}));
+  EXPECT_FALSE(MayMatch({2, Op::kEqual, std::string("/api/v3")}));
+  // The bloom filter only answers equality.
+  EXPECT_TRUE(MayMatch({2, Op::kLess, std::string("/")}));
+}
+
+TEST_F(ZoneMapTest, uint128_bloom) {
+  EXPECT_TRUE(MayMatch({3, Op::kEqual, absl::MakeUint128(3, 4)}));
+  EXPECT_FALSE(MayMatch({3, Op::kEqual, absl::MakeUint128(4, 3)}));
+}
+
+TEST_F(ZoneMapTest, conjunction_and_mismatched_types) {
+  EXPECT_FALSE(zone_map_.MayMatch({{0, Op::kGreater, int64_t{15}}, {1, Op::kGreater, 5.0}}));
+  EXPECT_TRUE(zone_map_.MayMatch({{0, Op::kGreater, int64_t{15}}, {1, Op::kGreater, 1.0}}));
+  // Predicates the zone map can't evaluate never rule out a batch.
+  EXPECT_TRUE(MayMatch({0, Op::kEqual, std::string("10")}));
+  EXPECT_TRUE(MayMatch({7, Op::kEqual, int64_t{1}}));
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -17,6 +17,7 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstddef>
 #include <iterator>
@@ -45,6 +46,16 @@ DEFINE_int32(table_store_table_size_limit,
              "The maximal size a table allows. When the size grows beyond this limit, "
              "old data will be discarded.");
 
+DEFINE_double(table_store_dictionary_max_distinct_ratio,
+              gflags::DoubleFromEnv("PL_TABLE_STORE_DICTIONARY_MAX_DISTINCT_RATIO", 0.5),
+              "String columns of cold batches are dictionary encoded when their ratio of distinct "
+              "values to rows is at most this value. 0 disables dictionary encoding.");
+
+DEFINE_bool(table_store_compress_cold_batches,
+            gflags::BoolFromEnv("PL_TABLE_STORE_COMPRESS_COLD_BATCHES", true),
+            "Whether the integer and time columns of cold batches are compressed with "
+            "frame-of-reference, delta and bit-packing encodings.");
+
 namespace px {
 namespace table_store {
 
@@ -54,6 +65,12 @@ Table::Cursor::Cursor(const Table* table, StartSpec start, StopSpec stop)
   StopStateFromSpec(std::move(stop));
 }
 
+Table::Cursor::Cursor(const Table* table, StartSpec start, StopSpec stop,
+                      std::vector<Predicate> predicates)
+    : Cursor(table, start, std::move(stop)) {
+  zone_map_scan_.predicates = std::move(predicates);
+}
+
 void Table::Cursor::AdvanceToStart(const StartSpec& start) {
   switch (start.type) {
     case StartSpec::StartType::StartAtTime: {
@@ -155,6 +172,8 @@ internal::RowID* Table::Cursor::LastReadRowID() { return &last_read_row_id_; }
 
 internal::BatchHints* Table::Cursor::Hints() { return &hints_; }
 
+internal::ZoneMapScan* Table::Cursor::ZoneMapScan() { return &zone_map_scan_; }
+
 std::optional<internal::RowID> Table::Cursor::StopRowID() const {
   if (stop_.spec.type == StopSpec::StopType::Infinite) {
     return std::nullopt;
@@ -163,8 +182,8 @@ std::optional<internal::RowID> Table::Cursor::StopRowID() const {
 }
 
 StatusOr<std::unique_ptr<schema::RowBatch>> Table::Cursor::GetNextRowBatch(
-    const std::vector<int64_t>& cols) {
-  return table_->GetNextRowBatch(this, cols);
+    const std::vector<int64_t>& cols, const ReadOptions& read_options) {
+  return table_->GetNextRowBatch(this, cols, read_options);
 }
 
 Table::Table(std::string_view table_name, const schema::Relation& relation, size_t max_table_size,
@@ -210,16 +229,23 @@ Status Table::ToProto(table_store::schemapb::Table* table_proto) const {
 }
 
 StatusOr<std::unique_ptr<schema::RowBatch>> Table::GetNextRowBatch(
-    Cursor* cursor, const std::vector<int64_t>& cols) const {
+    Cursor* cursor, const std::vector<int64_t>& cols,
+    const Cursor::ReadOptions& read_options) const {
   DCHECK(!cursor->Done()) << "Calling GetNextRowBatch on an exhausted Cursor";
+  auto prev_batches_skipped = cursor->ZoneMapScan()->batches_skipped;
+  auto stop_row_id = cursor->StopRowID();
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
   PX_ASSIGN_OR_RETURN(auto rb,
                       cold_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                   cursor->StopRowID(), cols));
-  if (rb == nullptr) {
+                                                   stop_row_id, cols, cursor->ZoneMapScan(),
+                                                   read_options));
+  // The zone maps can skip the cursor all the way to its stop row.
+  bool reached_stop =
+      stop_row_id.has_value() && *cursor->LastReadRowID() + 1 >= stop_row_id.value();
+  if (rb == nullptr && !reached_stop) {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     PX_ASSIGN_OR_RETURN(rb, hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                        cursor->StopRowID(), cols));
+                                                        stop_row_id, cols));
     if (rb == nullptr && hot_store_->Size() > 0) {
       // If the cursor was pointing to an expired row batch, update the cursor to point to the start
       // of the table, then try to get the next row batch.
@@ -227,10 +253,19 @@ StatusOr<std::unique_ptr<schema::RowBatch>> Table::GetNextRowBatch(
       if (!cursor->Done()) {
         PX_ASSIGN_OR_RETURN(rb,
                             hot_store_->GetNextRowBatch(cursor->LastReadRowID(), cursor->Hints(),
-                                                        cursor->StopRowID(), cols));
+                                                        stop_row_id, cols));
       }
     }
   }
+  if (rb == nullptr && cursor->ZoneMapScan()->batches_skipped > prev_batches_skipped) {
+    // Every remaining row the cursor could read was skipped.
+    std::vector<types::DataType> col_types;
+    for (int64_t col_idx : cols) {
+      col_types.push_back(rel_.col_types()[col_idx]);
+    }
+    return schema::RowBatch::WithZeroRows(schema::RowDescriptor(col_types), /* eow */ false,
+                                          /* eos */ false);
+  }
   if (rb == nullptr) {
     return error::InvalidArgument("Data after Cursor is not in the table.");
   }
@@ -298,13 +333,60 @@ Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
   auto batch_stats = internal::BatchSizeAccountant::CalcBatchStats(
       ABSL_TS_UNCHECKED_READ(batch_size_accountant_)->NonMutableState(), record_or_row_batch);
 
-  PX_RETURN_IF_ERROR(ExpireRowBatches(batch_stats.bytes));
+  PendingWrite write;
+  pending_batches_.Push(
+      PendingBatch{std::move(record_or_row_batch), std::move(batch_stats), &write});
+  auto drain_status = DrainPendingBatches();
+  // If another writer held drain_lock_, it writes this batch before it stops draining. Wait for it,
+  // so that the batch can be read once this call returns and so that its error is returned here.
+  // This also keeps `write` alive until the drainer is done with it.
+  write.written.WaitForNotification();
+  PX_RETURN_IF_ERROR(write.status);
+  return drain_status;
+}
 
+Status Table::DrainPendingBatches() {
+  bool drained = false;
+  // If another writer is draining, it will write this writer's batch: the drainer checks for
+  // pending batches again after releasing drain_lock_, so a batch queued while the lock is held is
+  // never left behind. The fence orders the push (or the unlock) before the check on both sides, so
+  // that at least one of the two writers sees the other's update.
+  while (true) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (pending_batches_.Empty() || !drain_lock_.TryLock()) {
+      break;
+    }
+    WritePendingBatches();
+    drain_lock_.Unlock();
+    drained = true;
+  }
+  if (!drained) {
+    return Status::OK();
+  }
+  // Make sure locks are released for this call, since they are reacquired inside.
+  return UpdateTableMetricGauges();
+}
+
+void Table::WritePendingBatches() {
+  // A batch that fails to be written only fails its own writer, the batches queued after it are
+  // still written.
+  for (auto& pending : pending_batches_.TakeAll()) {
+    PendingWrite* write = pending.write;
+    write->status = WritePendingBatch(&pending);
+    // The writer may return and release `write` as soon as it is notified.
+    write->written.Notify();
+  }
+}
+
+Status Table::WritePendingBatch(PendingBatch* pending) {
+  PX_RETURN_IF_ERROR(ExpireRowBatches(pending->stats.bytes));
+
+  int64_t bytes = pending->stats.bytes;
   {
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
-    auto batch_length = record_or_row_batch.Length();
-    batch_size_accountant_->NewHotBatch(std::move(batch_stats));
-    hot_store_->EmplaceBack(next_row_id_, std::move(record_or_row_batch));
+    auto batch_length = pending->batch.Length();
+    batch_size_accountant_->NewHotBatch(std::move(pending->stats));
+    hot_store_->EmplaceBack(next_row_id_, std::move(pending->batch));
     next_row_id_ += batch_length;
   }
 
@@ -312,12 +394,9 @@ Status Table::WriteHot(internal::RecordOrRowBatch&& record_or_row_batch) {
     absl::base_internal::SpinLockHolder lock(&stats_lock_);
     ++batches_added_;
     metrics_.batches_added_counter.Increment();
-    bytes_added_ += batch_stats.bytes;
-    metrics_.bytes_added_counter.Increment(batch_stats.bytes);
+    bytes_added_ += bytes;
+    metrics_.bytes_added_counter.Increment(bytes);
   }
-
-  // Make sure locks are released for this call, since they are reacquired inside.
-  PX_RETURN_IF_ERROR(UpdateTableMetricGauges());
   return Status::OK();
 }
 
@@ -391,16 +470,26 @@ TableStats Table::GetTableStats() const {
   TableStats info;
   int64_t min_time = -1;
   int64_t num_batches = 0;
+  int64_t num_rows = 0;
   int64_t hot_bytes = 0;
   int64_t cold_bytes = 0;
+  int64_t cold_uncompressed_bytes = 0;
   {
     absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
     min_time = cold_store_->MinTime();
     num_batches += cold_store_->Size();
+    // The row ids of each store are contiguous.
+    if (cold_store_->Size() > 0) {
+      num_rows += cold_store_->LastRowID() - cold_store_->FirstRowID() + 1;
+    }
     absl::base_internal::SpinLockHolder hot_lock(&hot_lock_);
     num_batches += hot_store_->Size();
+    if (hot_store_->Size() > 0) {
+      num_rows += hot_store_->LastRowID() - hot_store_->FirstRowID() + 1;
+    }
     hot_bytes = batch_size_accountant_->HotBytes();
     cold_bytes = batch_size_accountant_->ColdBytes();
+    cold_uncompressed_bytes = batch_size_accountant_->ColdUncompressedBytes();
     if (min_time == -1) {
       min_time = hot_store_->MinTime();
     }
@@ -411,9 +500,13 @@ TableStats Table::GetTableStats() const {
   info.batches_expired = batches_expired_;
   info.bytes_added = bytes_added_;
   info.num_batches = num_batches;
+  info.num_rows = num_rows;
   info.bytes = hot_bytes + cold_bytes;
   info.hot_bytes = hot_bytes;
   info.cold_bytes = cold_bytes;
+  info.cold_uncompressed_bytes = cold_uncompressed_bytes;
+  info.compression_ratio =
+      cold_bytes > 0 ? static_cast<double>(cold_uncompressed_bytes) / cold_bytes : 1.0;
   info.compacted_batches = compacted_batches_;
   info.max_table_size = max_table_size_;
   info.min_time = min_time;
@@ -421,7 +514,7 @@ TableStats Table::GetTableStats() const {
   return info;
 }
 
-Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
+Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool* mem_pool) {
   const auto& compaction_spec = batch_size_accountant_->GetNextCompactedBatchSpec();
 
   PX_RETURN_IF_ERROR(
@@ -439,11 +532,21 @@ Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
     }
   }
 
-  PX_ASSIGN_OR_RETURN(std::vector<ArrowArrayPtr> out_columns, compactor_.Finish());
+  internal::ColdEncodingOptions encoding_options;
+  encoding_options.dictionary_max_distinct_ratio = FLAGS_table_store_dictionary_max_distinct_ratio;
+  encoding_options.bit_pack_integers = FLAGS_table_store_compress_cold_batches;
+  encoding_options.allow_delta = FLAGS_table_store_compress_cold_batches;
+  PX_ASSIGN_OR_RETURN(ColdBatch cold_batch,
+                      compactor_.FinishCold(encoding_options, time_col_idx_, mem_pool));
+
+  int64_t stored_bytes = 0;
+  for (const auto& [col_idx, column] : Enumerate(cold_batch)) {
+    stored_bytes += column.StoredBytes(rel_.col_types()[col_idx]);
+  }
 
-  cold_store_->EmplaceBack(first_row_id, out_columns);
+  cold_store_->EmplaceBack(first_row_id, std::move(cold_batch));
 
-  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch();
+  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch(stored_bytes);
   if (num_rows_to_remove > 0) {
     hot_store_->RemovePrefix(num_rows_to_remove);
   }
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
 #include <arrow/array.h>
 #include <arrow/record_batch.h>
 #include <algorithm>
@@ -43,12 +44,16 @@
 #include "src/table_store/schemapb/schema.pb.h"
 #include "src/table_store/table/internal/arrow_array_compactor.h"
 #include "src/table_store/table/internal/batch_size_accountant.h"
+#include "src/table_store/table/internal/ingest_queue.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
 #include "src/table_store/table/internal/store_with_row_accounting.h"
 #include "src/table_store/table/internal/types.h"
+#include "src/table_store/table/internal/zone_map.h"
 #include "src/table_store/table/table_metrics.h"
 
 DECLARE_int32(table_store_table_size_limit);
+DECLARE_double(table_store_dictionary_max_distinct_ratio);
+DECLARE_bool(table_store_compress_cold_batches);
 
 namespace px {
 namespace table_store {
@@ -59,7 +64,11 @@ struct TableStats {
   int64_t bytes;
   int64_t hot_bytes;
   int64_t cold_bytes;
+  // The bytes the cold batches would take without encoding, and its ratio to cold_bytes.
+  int64_t cold_uncompressed_bytes;
+  double compression_ratio;
   int64_t num_batches;
+  int64_t num_rows;
   int64_t batches_added;
   int64_t batches_expired;
   int64_t bytes_added;
@@ -173,8 +182,24 @@ class Table : public NotCopyable {
       Time stop_time = -1;
     };
 
+    /**
+     * Predicate is a `column <op> constant` comparison pushed down to the Cursor. Cold batches
+     * whose zone maps show that no row satisfies all of the cursor's predicates are skipped. The
+     * skipping is conservative: the batches that are returned may still contain rows that don't
+     * match, so the caller still has to filter them.
+     */
+    using Predicate = internal::ColumnPredicate;
+
+    /**
+     * ReadOptions control the batches returned by GetNextRowBatch: the pool that compressed
+     * columns are decoded into, and whether dictionary encoded STRING columns are returned with
+     * their codes (see types::MakeStringDictionaryArray) instead of being decoded.
+     */
+    using ReadOptions = internal::ColdReadOptions;
+
     explicit Cursor(const Table* table) : Cursor(table, StartSpec{}, StopSpec{}) {}
     Cursor(const Table* table, StartSpec start, StopSpec stop);
+    Cursor(const Table* table, StartSpec start, StopSpec stop, std::vector<Predicate> predicates);
 
     // In the case of StopType == Infinite or StopType == StopAtTime, this returns whether the table
     // has the next batch ready. In the case of StopType == CurrentEndOfTable, this returns !Done().
@@ -183,11 +208,15 @@ class Table : public NotCopyable {
     // `NextBatchReady()` and `GetNextRowBatch(...)`, and then the row batch after the expired one
     // is past the stopping condition. In this case `GetNextRowBatch(...)` will return an error.
     bool NextBatchReady();
-    StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(const std::vector<int64_t>& cols);
+    StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(
+        const std::vector<int64_t>& cols, const ReadOptions& read_options = {});
     // In the case of StopType == Infinite, this function always returns false.
     bool Done();
     // Change the StopSpec of the cursor.
     void UpdateStopSpec(StopSpec stop);
+    // The number of batches and rows skipped through the zone maps of the cursor's predicates.
+    int64_t batches_skipped() const { return zone_map_scan_.batches_skipped; }
+    int64_t rows_skipped() const { return zone_map_scan_.rows_skipped; }
 
    private:
     void AdvanceToStart(const StartSpec& start);
@@ -198,6 +227,7 @@ class Table : public NotCopyable {
     internal::RowID* LastReadRowID();
     internal::BatchHints* Hints();
     std::optional<internal::RowID> StopRowID() const;
+    internal::ZoneMapScan* ZoneMapScan();
 
     struct StopState {
       StopSpec spec;
@@ -210,6 +240,7 @@ class Table : public NotCopyable {
     internal::BatchHints hints_;
     RowID last_read_row_id_;
     StopState stop_;
+    internal::ZoneMapScan zone_map_scan_;
 
     friend class Table;
   };
@@ -233,10 +264,12 @@ class Table : public NotCopyable {
    * Get a RowBatch of data corresponding to the next data after the given cursor.
    * @param cursor the Table::Cursor to get the next row batch after.
    * @param cols a vector of column indices to get data for.
+   * @param read_options how the columns of cold batches are decoded.
    * @return a unique ptr to a RowBatch with the requested data.
    */
   StatusOr<std::unique_ptr<schema::RowBatch>> GetNextRowBatch(
-      Cursor* cursor, const std::vector<int64_t>& cols) const;
+      Cursor* cursor, const std::vector<int64_t>& cols,
+      const Cursor::ReadOptions& read_options = {}) const;
 
   /**
    * Get the unique identifier of the first row in the table.
@@ -327,7 +360,27 @@ class Table : public NotCopyable {
   int64_t next_row_id_ ABSL_GUARDED_BY(hot_lock_) = 0;
   int64_t time_col_idx_ = -1;
 
+  // Written batches wait in pending_batches_ until they are moved into the hot store, by whichever
+  // writer holds drain_lock_. Writers only ever try to take drain_lock_, so concurrent writers
+  // don't spin on the table's locks: one of them writes every pending batch, while the others
+  // sleep until their batch is written. The result of writing a batch is handed back to its writer
+  // through its PendingWrite, which lives on the writer's stack.
+  struct PendingWrite {
+    absl::Notification written;
+    Status status;
+  };
+  struct PendingBatch {
+    internal::RecordOrRowBatch batch;
+    internal::BatchSizeAccountant::BatchStats stats;
+    PendingWrite* write;
+  };
+  internal::IngestQueue<PendingBatch> pending_batches_;
+  absl::base_internal::SpinLock drain_lock_;
+
   Status WriteHot(internal::RecordOrRowBatch&& record_or_row_batch);
+  Status DrainPendingBatches();
+  void WritePendingBatches() ABSL_EXCLUSIVE_LOCKS_REQUIRED(drain_lock_);
+  Status WritePendingBatch(PendingBatch* pending) ABSL_EXCLUSIVE_LOCKS_REQUIRED(drain_lock_);
 
   Status ExpireBatch();
   Status ExpireHot();
@@ -19,12 +19,14 @@
 #include <absl/synchronization/barrier.h>
 #include <absl/synchronization/notification.h>
 #include <benchmark/benchmark.h>
+#include <atomic>
 #include <chrono>
 #include <deque>
 #include <numeric>
 #include <random>
 #include <thread>
 
+#include "src/common/testing/test_environment.h"
 #include "src/shared/types/types.h"
 #include "src/table_store/table/table.h"
 
@@ -82,6 +84,38 @@ static inline int64_t FillTableCold(Table* table, int64_t table_size, int64_t ba
   return time_counter;
 }
 
+static inline std::unique_ptr<Table> MakeMetricsTable(int64_t max_size, int64_t compaction_size) {
+  schema::Relation rel(std::vector<types::DataType>({types::DataType::TIME64NS,
+                                                     types::DataType::INT64,
+                                                     types::DataType::INT64}),
+                       std::vector<std::string>({"time_", "latency_ns", "resp_bytes"}));
+  return std::make_unique<Table>("test_table", rel, max_size, compaction_size);
+}
+
+// Makes a batch that looks like request metrics: increasing timestamps with jitter, and latencies
+// and response sizes in narrow ranges.
+static inline std::unique_ptr<types::ColumnWrapperRecordBatch> MakeMetricsBatch(
+    int64_t batch_length, int64_t* time_counter, std::mt19937_64* rng) {
+  std::uniform_int_distribution<int64_t> time_step(500, 1500);
+  std::uniform_int_distribution<int64_t> latency(100 * 1000, 5 * 1000 * 1000);
+  std::uniform_int_distribution<int64_t> resp_bytes(0, 64 * 1024);
+
+  auto time_col = std::make_shared<types::Time64NSValueColumnWrapper>(batch_length);
+  auto latency_col = std::make_shared<types::Int64ValueColumnWrapper>(batch_length);
+  auto bytes_col = std::make_shared<types::Int64ValueColumnWrapper>(batch_length);
+  for (int64_t i = 0; i < batch_length; ++i) {
+    *time_counter += time_step(*rng);
+    (*time_col)[i] = *time_counter;
+    (*latency_col)[i] = latency(*rng);
+    (*bytes_col)[i] = resp_bytes(*rng);
+  }
+  auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+  wrapper_batch->push_back(time_col);
+  wrapper_batch->push_back(latency_col);
+  wrapper_batch->push_back(bytes_col);
+  return wrapper_batch;
+}
+
 static inline void ReadFullTable(Table::Cursor* cursor) {
   while (!cursor->Done()) {
     benchmark::DoNotOptimize(cursor->GetNextRowBatch({0, 1}));
@@ -114,12 +148,14 @@ static void BM_TableReadAllHot(benchmark::State& state) {
 
 // NOLINTNEXTLINE : runtime/references.
 static void BM_TableReadAllCold(benchmark::State& state) {
+  PX_SET_FOR_SCOPE(FLAGS_table_store_compress_cold_batches, state.range(0) != 0);
   int64_t table_size = 4 * 1024 * 1024;
   int64_t compaction_size = 64 * 1024;
   int64_t batch_length = 256;
   auto table = MakeTable(table_size, compaction_size);
   FillTableCold(table.get(), table_size, batch_length);
-  CHECK_EQ(table->GetTableStats().bytes, table_size);
+  auto stats = table->GetTableStats();
+  CHECK_EQ(stats.hot_bytes + stats.cold_uncompressed_bytes, table_size);
   Table::Cursor cursor(table.get());
 
   for (auto _ : state) {
@@ -237,6 +273,7 @@ static void BM_TableWriteFull(benchmark::State& state) {
 
 // NOLINTNEXTLINE : runtime/references.
 static void BM_TableCompaction(benchmark::State& state) {
+  PX_SET_FOR_SCOPE(FLAGS_table_store_compress_cold_batches, state.range(0) != 0);
   int64_t compaction_size = 64 * 1024;
   int64_t table_size = Table::kMaxBatchesPerCompactionCall * compaction_size;
   int64_t batch_length = 256;
@@ -257,6 +294,146 @@ static void BM_TableCompaction(benchmark::State& state) {
                           Table::kMaxBatchesPerCompactionCall);
 }
 
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableReadAllColdMetrics(benchmark::State& state) {
+  PX_SET_FOR_SCOPE(FLAGS_table_store_compress_cold_batches, state.range(0) != 0);
+  int64_t table_size = 4 * 1024 * 1024;
+  int64_t compaction_size = 64 * 1024;
+  int64_t batch_length = 256;
+  int64_t batch_size = batch_length * 3 * sizeof(int64_t);
+  auto table = MakeMetricsTable(table_size, compaction_size);
+  int64_t time_counter = 0;
+  std::mt19937_64 rng(42);
+  for (int64_t i = 0; i < table_size / batch_size; ++i) {
+    PX_CHECK_OK(table->TransferRecordBatch(MakeMetricsBatch(batch_length, &time_counter, &rng)));
+    PX_CHECK_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+  }
+  auto stats = table->GetTableStats();
+  Table::Cursor cursor(table.get());
+
+  for (auto _ : state) {
+    while (!cursor.Done()) {
+      benchmark::DoNotOptimize(cursor.GetNextRowBatch({0, 1, 2}));
+    }
+    state.PauseTiming();
+    cursor = Table::Cursor(table.get());
+    state.ResumeTiming();
+  }
+
+  // Bytes processed are counted uncompressed, so that the throughput of both cases is comparable.
+  state.SetBytesProcessed(state.iterations() * (stats.hot_bytes + stats.cold_uncompressed_bytes));
+  state.counters["compression_ratio"] = benchmark::Counter(stats.compression_ratio);
+}
+
+// Measures how much data a table with a fixed size limit retains, with and without compression.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableColdFootprint(benchmark::State& state) {
+  PX_SET_FOR_SCOPE(FLAGS_table_store_compress_cold_batches, state.range(0) != 0);
+  int64_t table_size = 4 * 1024 * 1024;
+  int64_t compaction_size = 64 * 1024;
+  int64_t batch_length = 256;
+  int64_t rows_written = 0;
+  TableStats stats;
+
+  for (auto _ : state) {
+    auto table = MakeMetricsTable(table_size, compaction_size);
+    int64_t time_counter = 0;
+    std::mt19937_64 rng(42);
+    // Write 4x the table size, so that old batches get expired.
+    int64_t batch_size = batch_length * 3 * sizeof(int64_t);
+    for (int64_t i = 0; i < 4 * table_size / batch_size; ++i) {
+      PX_CHECK_OK(table->TransferRecordBatch(MakeMetricsBatch(batch_length, &time_counter, &rng)));
+      PX_CHECK_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+      rows_written += batch_length;
+    }
+    stats = table->GetTableStats();
+  }
+
+  int64_t retained_bytes = stats.hot_bytes + stats.cold_uncompressed_bytes;
+  state.counters["cold_bytes"] = benchmark::Counter(stats.cold_bytes);
+  state.counters["retained_uncompressed_bytes"] = benchmark::Counter(retained_bytes);
+  state.counters["retained_rows"] =
+      benchmark::Counter(retained_bytes / static_cast<double>(3 * sizeof(int64_t)));
+  state.counters["compression_ratio"] = benchmark::Counter(stats.compression_ratio);
+  state.SetItemsProcessed(rows_written);
+}
+
+// Measures write throughput when several writers (like the connectors of Stirling) write to the
+// same table, while several readers scan it. state.range(0) is the number of writers, and
+// state.range(1) the number of readers.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableWriteReadContention(benchmark::State& state) {
+  int64_t num_writers = state.range(0);
+  int64_t num_readers = state.range(1);
+  int64_t table_size = 16 * 1024 * 1024;
+  int64_t compaction_size = 64 * 1024;
+  int64_t batch_length = 256;
+  int64_t batches_per_writer = 1024;
+  int64_t rows_read = 0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::shared_ptr<Table> table = MakeTable(table_size, compaction_size);
+    absl::Notification writers_done;
+    std::atomic<int64_t> reader_rows = 0;
+    absl::Barrier barrier(num_writers + num_readers + 1);
+
+    std::vector<std::thread> readers;
+    for (int64_t i = 0; i < num_readers; ++i) {
+      readers.emplace_back([&]() {
+        barrier.Block();
+        while (!writers_done.HasBeenNotified()) {
+          Table::Cursor cursor(table.get());
+          while (!cursor.Done()) {
+            auto rb_or_s = cursor.GetNextRowBatch({0, 1});
+            if (!rb_or_s.ok()) {
+              // The batch was expired under the cursor.
+              break;
+            }
+            reader_rows += rb_or_s.ConsumeValueOrDie()->num_rows();
+          }
+        }
+      });
+    }
+    std::vector<std::thread> writers;
+    for (int64_t i = 0; i < num_writers; ++i) {
+      writers.emplace_back([&]() {
+        int64_t time_counter = 0;
+        std::vector<std::unique_ptr<types::ColumnWrapperRecordBatch>> batches;
+        for (int64_t j = 0; j < batches_per_writer; ++j) {
+          batches.push_back(MakeHotBatch(batch_length, &time_counter));
+        }
+        barrier.Block();
+        for (auto& batch : batches) {
+          PX_CHECK_OK(table->TransferRecordBatch(std::move(batch)));
+        }
+      });
+    }
+    std::thread compaction_thread([&]() {
+      while (!writers_done.WaitForNotificationWithTimeout(absl::Milliseconds(10))) {
+        PX_CHECK_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+      }
+    });
+
+    barrier.Block();
+    state.ResumeTiming();
+    for (auto& writer : writers) {
+      writer.join();
+    }
+    state.PauseTiming();
+    writers_done.Notify();
+    for (auto& reader : readers) {
+      reader.join();
+    }
+    compaction_thread.join();
+    rows_read += reader_rows;
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_writers * batches_per_writer * batch_length);
+  state.counters["rows_read"] = benchmark::Counter(rows_read, benchmark::Counter::kIsRate);
+}
+
 // NOLINTNEXTLINE : runtime/references.
 static void BM_TableThreaded(benchmark::State& state) {
   schema::Relation rel({types::DataType::TIME64NS}, {"time_"});
@@ -361,12 +538,19 @@ static void BM_TableThreaded(benchmark::State& state) {
 }
 
 BENCHMARK(BM_TableReadAllHot);
-BENCHMARK(BM_TableReadAllCold);
+// The argument toggles compression of cold batches.
+BENCHMARK(BM_TableReadAllCold)->Arg(0)->Arg(1);
 BENCHMARK(BM_TableReadLastBatchAllHot)->Iterations(1000);
 BENCHMARK(BM_TableReadLastBatchAllCold)->Iterations(1000);
 BENCHMARK(BM_TableWriteEmpty);
 BENCHMARK(BM_TableWriteFull);
-BENCHMARK(BM_TableCompaction);
+BENCHMARK(BM_TableCompaction)->Arg(0)->Arg(1);
+BENCHMARK(BM_TableReadAllColdMetrics)->Arg(0)->Arg(1);
+BENCHMARK(BM_TableColdFootprint)->Arg(0)->Arg(1)->Iterations(1);
 BENCHMARK(BM_TableThreaded)->UseManualTime()->Iterations(1);
+BENCHMARK(BM_TableWriteReadContention)
+    ->ArgsProduct({{1, 4, 8}, {0, 4}})
+    ->ArgNames({"writers", "readers"})
+    ->UseRealTime();
 
 }  // namespace px::table_store
@@ -34,6 +34,20 @@ std::unique_ptr<std::unordered_map<std::string, schema::Relation>> TableStore::G
   return map;
 }
 
+TableStore::TableStatsMap TableStore::GetTableStatsMap() const {
+  TableStatsMap map;
+  for (const auto& [name_tablet, table] : name_to_table_map_) {
+    TableStats tablet_stats = table->GetTableStats();
+    TableStats& stats = map[name_tablet.name_];
+    stats.bytes += tablet_stats.bytes;
+    stats.hot_bytes += tablet_stats.hot_bytes;
+    stats.cold_bytes += tablet_stats.cold_bytes;
+    stats.num_batches += tablet_stats.num_batches;
+    stats.num_rows += tablet_stats.num_rows;
+  }
+  return map;
+}
+
 StatusOr<Table*> TableStore::CreateNewTablet(uint64_t table_id, const types::TabletID& tablet_id) {
   auto id_to_table_info_map_iter = id_to_table_info_map_.find(table_id);
   if (id_to_table_info_map_iter == id_to_table_info_map_.end()) {
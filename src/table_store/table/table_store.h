@@ -79,6 +79,7 @@ struct TableInfo {
 class TableStore {
  public:
   using RelationMap = std::unordered_map<std::string, schema::Relation>;
+  using TableStatsMap = absl::flat_hash_map<std::string, TableStats>;
 
   TableStore() = default;
 
@@ -139,6 +140,12 @@ class TableStore {
    */
   std::unique_ptr<RelationMap> GetRelationMap();
 
+  /**
+   * @return A map of table name to the size of the table, summed across its tablets. Only the
+   * additive stats (bytes, num_batches and num_rows) are filled in.
+   */
+  TableStatsMap GetTableStatsMap() const;
+
   /**
    * @brief Appends the record_batch to the sepcified table and tablet_id. If the table exists but
    * the tablet does not, then the method creates a new container for the tablet.
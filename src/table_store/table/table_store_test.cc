@@ -250,6 +250,23 @@ TEST_F(TableStoreTabletsTest, tablet_test) {
   EXPECT_EQ(tablet2->GetTableStats().batches_added, 0);
 }
 
+TEST_F(TableStoreTabletsTest, table_stats_map_sums_tablets) {
+  auto table_store = TableStore();
+  uint64_t table_id = 123;
+  table_store.AddTable(tablet1_1, "a", table_id, "456");
+  table_store.AddTable(tablet1_2, "a", table_id, "789");
+
+  EXPECT_OK(table_store.AppendData(table_id, "456", MakeRel1ColumnWrapperBatch()));
+  EXPECT_OK(table_store.AppendData(table_id, "789", MakeRel1ColumnWrapperBatch()));
+  EXPECT_OK(table_store.AppendData(table_id, "789", MakeRel1ColumnWrapperBatch()));
+
+  auto stats = table_store.GetTableStatsMap();
+  ASSERT_EQ(1, stats.size());
+  EXPECT_EQ(81, stats["a"].bytes);
+  EXPECT_EQ(9, stats["a"].num_rows);
+  EXPECT_EQ(3, stats["a"].num_batches);
+}
+
 // Test to make sure that appending data makes a tablet.
 TEST_F(TableStoreTabletsTest, add_tablet_on_append_data) {
   auto table_store = TableStore();
@@ -21,6 +21,8 @@
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
 #include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "src/common/testing/testing.h"
@@ -111,6 +113,7 @@ TEST(TableTest, bytes_test) {
 
   EXPECT_OK(table.WriteRowBatch(rb1));
   EXPECT_EQ(table.GetTableStats().bytes, rb1_size);
+  EXPECT_EQ(table.GetTableStats().num_rows, 3);
 
   schema::RowBatch rb2(rd, 2);
   std::vector<types::Int64Value> col1_rb2 = {4, 5};
@@ -123,6 +126,7 @@ TEST(TableTest, bytes_test) {
 
   EXPECT_OK(table.WriteRowBatch(rb2));
   EXPECT_EQ(table.GetTableStats().bytes, rb1_size + rb2_size);
+  EXPECT_EQ(table.GetTableStats().num_rows, 5);
 
   std::vector<types::Int64Value> time_hot_col1 = {1, 5, 3};
   std::vector<types::StringValue> time_hot_col2 = {"test", "abc", "de"};
@@ -144,9 +148,12 @@ TEST(TableTest, bytes_test) {
   EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch_1)));
 
   EXPECT_EQ(table.GetTableStats().bytes, rb1_size + rb2_size + rb3_size);
+  EXPECT_EQ(table.GetTableStats().num_rows, 8);
 }
 
 TEST(TableTest, bytes_test_w_compaction) {
+  // The byte counts below are for uncompressed cold batches.
+  PX_SET_FOR_SCOPE(FLAGS_table_store_compress_cold_batches, false);
   auto rd = schema::RowDescriptor({types::DataType::INT64, types::DataType::STRING});
   schema::Relation rel(rd.types(), {"col1", "col2"});
 
@@ -290,6 +297,8 @@ TEST(TableTest, expiry_test) {
 }
 
 TEST(TableTest, expiry_test_w_compaction) {
+  // The byte counts below are for uncompressed cold batches.
+  PX_SET_FOR_SCOPE(FLAGS_table_store_compress_cold_batches, false);
   auto rd = schema::RowDescriptor({types::DataType::INT64, types::DataType::STRING});
   schema::Relation rel(rd.types(), {"col1", "col2"});
 
@@ -864,6 +873,158 @@ TEST(TableTest, threaded) {
   reader_thread.join();
 }
 
+TEST(TableTest, concurrent_writers) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::INT64}, {"writer", "seq"});
+  std::shared_ptr<Table> table_ptr =
+      std::make_shared<Table>("test_table", rel, 64 * 1024 * 1024, 64 * 1024);
+
+  constexpr int64_t kNumWriters = 8;
+  constexpr int64_t kBatchesPerWriter = 200;
+  constexpr int64_t kBatchLength = 64;
+
+  std::vector<std::thread> writers;
+  for (int64_t writer = 0; writer < kNumWriters; ++writer) {
+    writers.emplace_back([table_ptr, writer]() {
+      int64_t seq = 0;
+      for (int64_t batch = 0; batch < kBatchesPerWriter; ++batch) {
+        auto writer_col = std::make_shared<types::Int64ValueColumnWrapper>(kBatchLength);
+        auto seq_col = std::make_shared<types::Int64ValueColumnWrapper>(kBatchLength);
+        for (int64_t i = 0; i < kBatchLength; ++i) {
+          (*writer_col)[i] = writer;
+          (*seq_col)[i] = seq++;
+        }
+        auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+        wrapper_batch->push_back(writer_col);
+        wrapper_batch->push_back(seq_col);
+        EXPECT_OK(table_ptr->TransferRecordBatch(std::move(wrapper_batch)));
+      }
+    });
+  }
+  std::thread compaction_thread([table_ptr]() {
+    for (int i = 0; i < 20; ++i) {
+      EXPECT_OK(table_ptr->CompactHotToCold(arrow::default_memory_pool()));
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+  });
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  compaction_thread.join();
+
+  // Once every writer returned, all of their batches are in the table, and each writer's rows are
+  // in the order it wrote them.
+  std::vector<int64_t> next_seq(kNumWriters, 0);
+  Table::Cursor cursor(table_ptr.get());
+  while (!cursor.Done()) {
+    ASSERT_OK_AND_ASSIGN(auto rb, cursor.GetNextRowBatch({0, 1}));
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      auto writer =
+          types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(0).get(), i);
+      auto seq = types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(1).get(), i);
+      ASSERT_EQ(next_seq[writer], seq);
+      ++next_seq[writer];
+    }
+  }
+  for (int64_t writer = 0; writer < kNumWriters; ++writer) {
+    EXPECT_EQ(kBatchesPerWriter * kBatchLength, next_seq[writer]);
+  }
+  EXPECT_EQ(kNumWriters * kBatchesPerWriter, table_ptr->GetTableStats().batches_added);
+}
+
+namespace {
+Status WriteSeqBatch(Table* table, int64_t writer, int64_t first_seq, int64_t length) {
+  auto writer_col = std::make_shared<types::Int64ValueColumnWrapper>(length);
+  auto seq_col = std::make_shared<types::Int64ValueColumnWrapper>(length);
+  for (int64_t i = 0; i < length; ++i) {
+    (*writer_col)[i] = writer;
+    (*seq_col)[i] = first_seq + i;
+  }
+  auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+  wrapper_batch->push_back(writer_col);
+  wrapper_batch->push_back(seq_col);
+  return table->TransferRecordBatch(std::move(wrapper_batch));
+}
+
+// Returns the number of rows each writer has in the table.
+std::vector<int64_t> RowsPerWriter(const Table* table, int64_t num_writers) {
+  std::vector<int64_t> rows(num_writers, 0);
+  Table::Cursor cursor(table);
+  while (!cursor.Done()) {
+    auto rb = cursor.GetNextRowBatch({0}).ConsumeValueOrDie();
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      ++rows[types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(0).get(), i)];
+    }
+  }
+  return rows;
+}
+}  // namespace
+
+TEST(TableTest, concurrent_writers_read_their_writes) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::INT64}, {"writer", "seq"});
+  std::shared_ptr<Table> table_ptr =
+      std::make_shared<Table>("test_table", rel, 64 * 1024 * 1024, 64 * 1024);
+
+  constexpr int64_t kNumWriters = 4;
+  constexpr int64_t kBatchesPerWriter = 50;
+  constexpr int64_t kBatchLength = 8;
+
+  std::vector<std::thread> writers;
+  for (int64_t writer = 0; writer < kNumWriters; ++writer) {
+    writers.emplace_back([table_ptr, writer]() {
+      for (int64_t batch = 0; batch < kBatchesPerWriter; ++batch) {
+        EXPECT_OK(WriteSeqBatch(table_ptr.get(), writer, batch * kBatchLength, kBatchLength));
+        // Even when another writer wrote the batch, it is in the table once the write returns.
+        EXPECT_EQ((batch + 1) * kBatchLength, RowsPerWriter(table_ptr.get(), kNumWriters)[writer]);
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  EXPECT_EQ(kNumWriters * kBatchesPerWriter, table_ptr->GetTableStats().batches_added);
+}
+
+TEST(TableTest, failed_write_only_fails_its_writer) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::INT64}, {"writer", "seq"});
+  constexpr int64_t kMaxTableSize = 1024 * 1024;
+  std::shared_ptr<Table> table_ptr =
+      std::make_shared<Table>("test_table", rel, kMaxTableSize, 64 * 1024);
+
+  constexpr int64_t kNumWriters = 4;
+  constexpr int64_t kBatchesPerWriter = 100;
+  constexpr int64_t kBatchLength = 8;
+  // Each row takes 16 bytes, so these batches are bigger than the table.
+  constexpr int64_t kTooBigBatchLength = kMaxTableSize / 8;
+  constexpr int64_t kNumTooBigBatches = 20;
+
+  std::vector<std::thread> writers;
+  for (int64_t writer = 0; writer < kNumWriters; ++writer) {
+    writers.emplace_back([table_ptr, writer]() {
+      for (int64_t batch = 0; batch < kBatchesPerWriter; ++batch) {
+        EXPECT_OK(WriteSeqBatch(table_ptr.get(), writer, batch * kBatchLength, kBatchLength));
+      }
+    });
+  }
+  std::thread too_big_writer([table_ptr]() {
+    for (int64_t batch = 0; batch < kNumTooBigBatches; ++batch) {
+      auto s = WriteSeqBatch(table_ptr.get(), kNumWriters, 0, kTooBigBatchLength);
+      EXPECT_EQ(s.code(), px::statuspb::INVALID_ARGUMENT);
+    }
+  });
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  too_big_writer.join();
+
+  // The failed batches didn't take any of the other writers' batches down with them.
+  auto rows = RowsPerWriter(table_ptr.get(), kNumWriters + 1);
+  for (int64_t writer = 0; writer < kNumWriters; ++writer) {
+    EXPECT_EQ(kBatchesPerWriter * kBatchLength, rows[writer]);
+  }
+  EXPECT_EQ(0, rows[kNumWriters]);
+  EXPECT_EQ(kNumWriters * kBatchesPerWriter, table_ptr->GetTableStats().batches_added);
+}
+
 // This test was add when `NextBatch` and `BatchSlice`'s were still around, and there was a bug with
 // generation handling of `BatchSlice`'s. Maintaining so as not to decrease test coverage, but this
 // bug should no longer even be plausible.
@@ -939,6 +1100,138 @@ TEST(TableTest, GetNextRowBatch_after_expiry) {
   EXPECT_TRUE(rb1->ColumnAt(1)->Equals(types::ToArrow(col2_in2, arrow::default_memory_pool())));
 }
 
+TEST(TableTest, cursor_predicates_skip_cold_batches) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "col1"});
+  int64_t compaction_size = 2 * 2 * sizeof(int64_t);
+  Table table("test_table", rel, 128 * 1024, compaction_size);
+
+  std::vector<std::vector<types::Int64Value>> col1_batches = {{1, 2}, {3, 4}, {200, 5}};
+  int64_t time = 0;
+  for (const auto& col1 : col1_batches) {
+    schema::RowBatch rb(schema::RowDescriptor(rel.col_types()), col1.size());
+    std::vector<types::Time64NSValue> times;
+    for (size_t i = 0; i < col1.size(); ++i) {
+      times.emplace_back(++time);
+    }
+    EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+    EXPECT_OK(table.WriteRowBatch(rb));
+  }
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+
+  Table::Cursor cursor(
+      &table, Table::Cursor::StartSpec{}, Table::Cursor::StopSpec{},
+      {Table::Cursor::Predicate{1, Table::Cursor::Predicate::Op::kGreater, int64_t{100}}});
+  int64_t rows_read = 0;
+  bool found_match = false;
+  while (!cursor.Done()) {
+    ASSERT_OK_AND_ASSIGN(auto rb, cursor.GetNextRowBatch({1}));
+    rows_read += rb->num_rows();
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      found_match |= types::GetValueFromArrowArray<types::DataType::INT64>(
+                         rb->ColumnAt(0).get(), i) == 200;
+    }
+  }
+  EXPECT_TRUE(found_match);
+  EXPECT_GT(cursor.batches_skipped(), 0);
+  EXPECT_EQ(6, rows_read + cursor.rows_skipped());
+}
+
+TEST(TableTest, dictionary_encoded_cold_strings) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::STRING}, {"col1", "req_path"});
+  Table table("test_table", rel, 128 * 1024, 1024);
+
+  std::vector<types::Int64Value> col1;
+  std::vector<types::StringValue> paths;
+  for (int64_t i = 0; i < 256; ++i) {
+    col1.emplace_back(i);
+    paths.emplace_back(i % 2 == 0 ? "/api/v1/users" : "/api/v1/orders");
+  }
+  schema::RowBatch rb(schema::RowDescriptor(rel.col_types()), col1.size());
+  EXPECT_OK(rb.AddColumn(types::ToArrow(col1, arrow::default_memory_pool())));
+  EXPECT_OK(rb.AddColumn(types::ToArrow(paths, arrow::default_memory_pool())));
+  EXPECT_OK(table.WriteRowBatch(rb));
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+
+  auto stats = table.GetTableStats();
+  EXPECT_GT(stats.cold_bytes, 0);
+  EXPECT_LT(stats.cold_bytes, stats.cold_uncompressed_bytes);
+  EXPECT_GT(stats.compression_ratio, 1.0);
+
+  // Reads decode the strings.
+  Table::Cursor cursor(&table);
+  int64_t row = 0;
+  while (!cursor.Done()) {
+    ASSERT_OK_AND_ASSIGN(auto out_rb, cursor.GetNextRowBatch({1}));
+    for (int64_t i = 0; i < out_rb->num_rows(); ++i, ++row) {
+      EXPECT_EQ(paths[row], types::GetValueFromArrowArray<types::DataType::STRING>(
+                                out_rb->ColumnAt(0).get(), i));
+    }
+  }
+  EXPECT_EQ(256, row);
+
+  // Or return their codes, allocated from the given pool.
+  arrow::ProxyMemoryPool pool(arrow::default_memory_pool());
+  Table::Cursor::ReadOptions read_options;
+  read_options.mem_pool = &pool;
+  read_options.keep_dictionaries = true;
+  Table::Cursor codes_cursor(&table);
+  row = 0;
+  while (!codes_cursor.Done()) {
+    ASSERT_OK_AND_ASSIGN(auto out_rb, codes_cursor.GetNextRowBatch({1}, read_options));
+    EXPECT_TRUE(out_rb->HasDictionaryColumns());
+    EXPECT_GT(pool.bytes_allocated(), 0);
+    for (int64_t i = 0; i < out_rb->num_rows(); ++i, ++row) {
+      EXPECT_EQ(paths[row],
+                std::string(types::GetStringViewFromArrowArray(out_rb->ColumnAt(0).get(), i)));
+    }
+  }
+  EXPECT_EQ(256, row);
+}
+
+TEST(TableTest, bit_packed_cold_columns) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::INT64}, {"time_", "latency"});
+  Table table("test_table", rel, 128 * 1024, 256 * 2 * sizeof(int64_t));
+
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::Int64Value> latencies;
+  int64_t time = 1600000000000000000;
+  for (int64_t i = 0; i < 256; ++i) {
+    time += 1000 + (i % 3);
+    times.emplace_back(time);
+    latencies.emplace_back(5000 + (i * 7) % 100);
+  }
+  schema::RowBatch rb(schema::RowDescriptor(rel.col_types()), times.size());
+  EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+  EXPECT_OK(rb.AddColumn(types::ToArrow(latencies, arrow::default_memory_pool())));
+  EXPECT_OK(table.WriteRowBatch(rb));
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(256 * 2 * sizeof(int64_t), stats.cold_uncompressed_bytes);
+  EXPECT_GT(stats.compression_ratio, 3.0);
+
+  // Time searches work on the bit-packed time column.
+  EXPECT_EQ(100, table.FindRowIDFromTimeFirstGreaterThanOrEqual(times[100].val));
+  EXPECT_EQ(101, table.FindRowIDFromTimeFirstGreaterThanOrEqual(times[100].val + 1));
+
+  // Cursors only decode the requested columns.
+  Table::Cursor::StartSpec start_spec;
+  start_spec.type = Table::Cursor::StartSpec::StartAtTime;
+  start_spec.start_time = times[10].val;
+  Table::Cursor cursor(&table, start_spec, Table::Cursor::StopSpec{});
+  int64_t row = 10;
+  while (!cursor.Done()) {
+    ASSERT_OK_AND_ASSIGN(auto out_rb, cursor.GetNextRowBatch({1}));
+    ASSERT_EQ(1, out_rb->num_columns());
+    for (int64_t i = 0; i < out_rb->num_rows(); ++i, ++row) {
+      EXPECT_EQ(latencies[row], types::GetValueFromArrowArray<types::DataType::INT64>(
+                                    out_rb->ColumnAt(0).get(), i));
+    }
+  }
+  EXPECT_EQ(256, row);
+}
+
 struct CursorTestCase {
   std::string name;
   std::vector<std::vector<int64_t>> initial_time_batches;
@@ -737,6 +737,8 @@ class GetDebugTableInfo final : public carnot::udf::UDTF<GetDebugTableInfo> {
                 "The size of this table in bytes"),
         ColInfo("cold_size", types::DataType::INT64, types::PatternType::GENERAL,
                 "The number of bytes in cold storage"),
+        ColInfo("cold_compression_ratio", types::DataType::FLOAT64, types::PatternType::GENERAL,
+                "The ratio of the unencoded size of the cold storage to its size"),
         ColInfo("max_table_size", types::DataType::INT64, types::PatternType::GENERAL,
                 "The maximum size of this table"),
         ColInfo("min_time", types::DataType::TIME64NS, types::PatternType::GENERAL,
@@ -767,6 +769,7 @@ class GetDebugTableInfo final : public carnot::udf::UDTF<GetDebugTableInfo> {
     rw->Append<IndexOf("compacted_batches")>(info.compacted_batches);
     rw->Append<IndexOf("size")>(info.bytes);
     rw->Append<IndexOf("cold_size")>(info.cold_bytes);
+    rw->Append<IndexOf("cold_compression_ratio")>(info.compression_ratio);
     rw->Append<IndexOf("max_table_size")>(info.max_table_size);
     rw->Append<IndexOf("min_time")>(info.min_time);
 